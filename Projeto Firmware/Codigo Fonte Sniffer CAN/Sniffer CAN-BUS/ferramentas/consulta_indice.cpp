@@ -0,0 +1,398 @@
+/**
+ * @file    consulta_indice.cpp
+ * @brief   Ferramenta de linha de comando (computador) que consulta o indice de um registro do
+ *          cartao (LOG-xxxx.idx, formato_indice.h). Mostra o resumo por identificador, lido a
+ *          partir do registro de fim sem percorrer o indice, e os trechos do registro com quadros
+ *          do identificador e do intervalo pedidos. Com o registro e a saida, extrai somente esses
+ *          trechos, posicionando no arquivo em vez de decodifica-lo inteiro. A saida tem o mesmo
+ *          formato do registro (o cabeçalho do formato é repetido antes do primeiro trecho) e pode
+ *          ser aberta pelo decodificador_log, pelo Wireshark ou por um editor de texto.
+ *
+ *          Compilação: g++ -O2 -o consulta_indice consulta_indice.cpp
+ *          Uso:        consulta_indice [-i ID] [-t inicio fim] LOG-0001.idx [LOG-0001.bin saida]
+ *                        -i identificador em hexadecimal: ate 3 digitos padrao, 8 digitos
+ *                           extendido (ex: 7E8 ou 000007E8, como na lista de identificadores)
+ *                        -t intervalo em segundos desde o primeiro quadro do arquivo
+ *
+ *          Retorna 0 se o indice for valido, 1 caso contrario.
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "../src/formato_indice.h"
+
+// Definições importantes (mesmos valores de tipos.h)
+#define MASCARA_ID_EXTENDIDO        0x1FFFFFFFU
+#define FLAG_QUADRO_EXTENDIDO       0x80000000U
+#define FLAG_QUADRO_REMOTO          0x40000000U
+#define MASCARA_ID_PADRAO           0x000007FFU
+#define TAMANHO_ID_PADRAO           3
+#define TAMANHO_ID_EXTENDIDO        8
+#define TAMANHO_PARTE_EXTRACAO      65536
+
+// Consulta pedida na linha de comando
+typedef struct Sconsulta{
+  uint8_t filtraId;
+  uint32_t identificador;
+  uint8_t filtraTempo;
+  double inicio;
+  double fim;
+}Tconsulta;
+
+/**
+ * @brief  Função que copia um trecho do registro para a saida
+ * @param  registro: arquivo de registro
+ * @param  saida: arquivo de saida
+ * @param  posicao: posição do trecho no registro
+ * @param  tamanho: quantidade de bytes
+ * @return 0 ou 1 se o registro terminar antes do trecho
+ */
+static int consulta_copiaTrecho(FILE *registro, FILE *saida, uint32_t posicao, uint32_t tamanho){
+  static uint8_t parte[TAMANHO_PARTE_EXTRACAO];
+  size_t lido;
+
+  if(fseek(registro, (long)posicao, SEEK_SET) != 0){
+    return 1;
+  }
+  while(tamanho > 0){
+    lido = fread(parte, 1, ((tamanho < sizeof(parte)) ? tamanho : sizeof(parte)), registro);
+    if(lido == 0){
+      return 1;
+    }
+    (void)fwrite(parte, 1, lido, saida);
+    tamanho -= (uint32_t)lido;
+  }
+  return 0;
+}
+
+/**
+ * @brief  Função que escreve o identificador como o texto do firmware: 3 digitos padrao, 8 extendido
+ * @param  identificador: identificador com as flags
+ * @return void
+ */
+static void consulta_escreveIdentificador(uint32_t identificador){
+  if(identificador & FLAG_QUADRO_EXTENDIDO){
+    printf("%08X", (unsigned)(identificador & MASCARA_ID_EXTENDIDO));
+  }else{
+    printf("%03X     ", (unsigned)(identificador & MASCARA_ID_EXTENDIDO));
+  }
+  printf("%s", (identificador & FLAG_QUADRO_REMOTO) ? " R" : "  ");
+}
+
+/**
+ * @brief  Função que le o identificador pedido. Como na lista de identificadores do firmware, ate
+ *         3 digitos é padrao e 8 digitos é extendido: 7E8 e 000007E8 sao quadros diferentes
+ * @param  texto: identificador em hexadecimal
+ * @param  identificador: recebe o identificador com FLAG_QUADRO_EXTENDIDO quando extendido
+ * @return 0 ou 1 se o texto nao é um identificador
+ */
+static int consulta_leIdentificador(const char *texto, uint32_t *identificador){
+  char *fim;
+  size_t tamanho = strlen(texto);
+  unsigned long valor = strtoul(texto, &fim, 16);
+
+  if((tamanho == 0) || (*fim != '\0') || (texto[0] == '-') || (texto[0] == '+')){
+    return 1;
+  }
+  if((tamanho <= TAMANHO_ID_PADRAO) && (valor <= MASCARA_ID_PADRAO)){
+    *identificador = (uint32_t)valor;
+    return 0;
+  }
+  if((tamanho == TAMANHO_ID_EXTENDIDO) && (valor <= MASCARA_ID_EXTENDIDO)){
+    *identificador = ((uint32_t)valor | FLAG_QUADRO_EXTENDIDO);
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * @brief  Função que compara duas entradas do resumo pelo identificador (qsort)
+ * @param  a: ponteiro para a primeira entrada
+ * @param  b: ponteiro para a segunda entrada
+ * @return <0, 0 ou >0
+ */
+static int consulta_comparaEntrada(const void *a, const void *b){
+  uint32_t idA = (uint32_t)formatoBinario_leInteiro(*(const uint8_t * const *)a, 4);
+  uint32_t idB = (uint32_t)formatoBinario_leInteiro(*(const uint8_t * const *)b, 4);
+
+  return ((idA > idB) - (idA < idB));
+}
+
+/**
+ * @brief  Função que mostra o resumo por identificador, em ordem de identificador. O registro de
+ *         fim dá a posição do resumo, assim o indice nao é percorrido
+ * @param  dados: indice inteiro
+ * @param  tamanho: bytes do indice
+ * @param  base: hora do primeiro quadro do arquivo (us desde 1970)
+ * @return 0 ou 1 se o indice nao foi finalizado
+ */
+static int consulta_mostraResumo(const uint8_t *dados, uint32_t tamanho, uint64_t base){
+  const uint8_t *fim;
+  const uint8_t *resumo;
+  const uint8_t *entrada;
+  const uint8_t **ordem;
+  uint32_t posicao;
+  uint32_t quantidade;
+  uint32_t i;
+
+  if(tamanho < (TAMANHO_CABECALHO_INDICE + TAMANHO_REGISTRO_FIM_INDICE)){
+    return 1;
+  }
+  fim = &dados[tamanho - TAMANHO_REGISTRO_FIM_INDICE];
+  if((fim[0] != REGISTRO_INDICE_FIM) || (formatoIndice_verificaRegistro(fim, TAMANHO_REGISTRO_FIM_INDICE) == 0)){
+    return 1;
+  }
+  posicao = (uint32_t)formatoBinario_leInteiro(&fim[TAMANHO_INICIO_REGISTRO_INDICE], 4);
+  if((posicao >= tamanho) || (formatoIndice_verificaRegistro(&dados[posicao], (tamanho - posicao)) == 0) ||
+     (dados[posicao] != REGISTRO_INDICE_RESUMO)){
+    return 1;
+  }
+  resumo = &dados[posicao + TAMANHO_INICIO_REGISTRO_INDICE];
+  quantidade = (uint32_t)formatoBinario_leInteiro(&resumo[0], 2);
+
+  // O firmware escreve na ordem da tabela hash
+  ordem = (const uint8_t **)malloc(((quantidade > 0) ? quantidade : 1) * sizeof(const uint8_t *));
+  if(ordem == NULL){
+    return 1;
+  }
+  for(i=0; i<quantidade; i++){
+    ordem[i] = &resumo[TAMANHO_INICIO_RESUMO_INDICE + (i * TAMANHO_ENTRADA_RESUMO_INDICE)];
+  }
+  qsort(ordem, quantidade, sizeof(const uint8_t *), consulta_comparaEntrada);
+
+  printf("identificador   primeiro (s)   ultimo (s)     quadros  baldes\n");
+  for(i=0; i<quantidade; i++){
+    entrada = ordem[i];
+    consulta_escreveIdentificador((uint32_t)formatoBinario_leInteiro(&entrada[0], 4));
+    printf("   %12.6f   %12.6f %9u %7u\n",
+      ((double)(formatoBinario_leInteiro(&entrada[4], 8) - base) / 1000000.0),
+      ((double)(formatoBinario_leInteiro(&entrada[12], 8) - base) / 1000000.0),
+      (unsigned)formatoBinario_leInteiro(&entrada[20], 4),
+      (unsigned)formatoBinario_leInteiro(&entrada[24], 4)
+    );
+  }
+  free(ordem);
+  if(formatoBinario_leInteiro(&resumo[2], 4) > 0){
+    printf("quadros de identificadores fora da tabela: %u\n", (unsigned)formatoBinario_leInteiro(&resumo[2], 4));
+  }
+  return 0;
+}
+
+/**
+ * @brief  Função que verifica se a entrada de um balde atende a consulta
+ * @param  conteudo: conteudo do registro do balde
+ * @param  consulta: consulta pedida
+ * @param  base: hora do primeiro quadro do arquivo (us desde 1970)
+ * @return 1 se o balde tem quadros da consulta
+ */
+static int consulta_selecionaBalde(const uint8_t *conteudo, const Tconsulta *consulta, uint64_t base){
+  double primeiro = ((double)(formatoBinario_leInteiro(&conteudo[8], 8) - base) / 1000000.0);
+  double ultimo = ((double)(formatoBinario_leInteiro(&conteudo[16], 8) - base) / 1000000.0);
+  uint32_t ids = (uint32_t)formatoBinario_leInteiro(&conteudo[29], 2);
+  uint32_t i;
+
+  if(consulta->filtraTempo && ((ultimo < consulta->inicio) || (primeiro > consulta->fim))){
+    return 0;
+  }
+  // Balde com a lista incompleta pode ter o identificador
+  if((!consulta->filtraId) || (conteudo[28] & INDICE_BALDE_INCOMPLETO)){
+    return 1;
+  }
+  for(i=0; i<ids; i++){
+    if(((uint32_t)formatoBinario_leInteiro(&conteudo[TAMANHO_INICIO_BALDE_INDICE + (i * TAMANHO_ID_INDICE)], 4) &
+        (MASCARA_ID_EXTENDIDO | FLAG_QUADRO_EXTENDIDO)) == consulta->identificador){
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int main(int argc, char **argv){
+  Tconsulta consulta;
+  const char *nomeIndice = NULL;
+  const char *nomeRegistro = NULL;
+  const char *nomeSaida = NULL;
+  FILE *arquivo;
+  FILE *registro = NULL;
+  FILE *saida = NULL;
+  uint8_t *dados;
+  uint8_t prefixo[sizeof(PREFIXO_REGISTRO_PREALOCADO) - 1];
+  const uint8_t *conteudo;
+  long tamanhoLido;
+  uint32_t tamanho;
+  uint32_t posicao;
+  uint32_t tamanhoRegistro;
+  uint32_t tamanhoCabecalho;
+  uint32_t inicioArquivo = 0;
+  uint32_t deslocamento;
+  uint32_t fimBalde;
+  uint32_t inicioTrecho = 0;
+  uint32_t fimTrecho = 0;
+  uint32_t baldes = 0;
+  uint32_t selecionados = 0;
+  uint32_t trechos = 0;
+  uint64_t bytesTrechos = 0;
+  uint64_t base = 0;
+  int haTrecho = 0;
+  int resultado = 0;
+  int i;
+
+  (void)memset(&consulta, 0x00, sizeof(Tconsulta));
+
+  for(i=1; i<argc; i++){
+    if((strcmp(argv[i], "-i") == 0) && ((i + 1) < argc)){
+      consulta.filtraId = 1;
+      if(consulta_leIdentificador(argv[++i], &consulta.identificador) != 0){
+        nomeIndice = NULL;
+        break;
+      }
+    }else if((strcmp(argv[i], "-t") == 0) && ((i + 2) < argc)){
+      consulta.filtraTempo = 1;
+      consulta.inicio = atof(argv[++i]);
+      consulta.fim = atof(argv[++i]);
+    }else if(nomeIndice == NULL){
+      nomeIndice = argv[i];
+    }else if(nomeRegistro == NULL){
+      nomeRegistro = argv[i];
+    }else if(nomeSaida == NULL){
+      nomeSaida = argv[i];
+    }else{
+      nomeIndice = NULL;
+      break;
+    }
+  }
+  if((nomeIndice == NULL) || ((nomeRegistro != NULL) && (nomeSaida == NULL))){
+    fprintf(stderr, "uso: %s [-i ID] [-t inicio fim] LOG-xxxx.idx [LOG-xxxx.bin saida]\n"
+                    "  -i identificador em hexadecimal (3 digitos padrao, 8 extendido)\n"
+                    "  -t segundos desde o primeiro quadro\n", argv[0]);
+    return 1;
+  }
+
+  // O indice tem poucos KiB por hora de captura, é lido inteiro
+  arquivo = fopen(nomeIndice, "rb");
+  if(arquivo == NULL){
+    fprintf(stderr, "erro: nao foi possivel abrir %s\n", nomeIndice);
+    return 1;
+  }
+  (void)fseek(arquivo, 0, SEEK_END);
+  tamanhoLido = ftell(arquivo);
+  (void)fseek(arquivo, 0, SEEK_SET);
+  dados = (uint8_t *)malloc((tamanhoLido > 0) ? (size_t)tamanhoLido : 1);
+  if((dados == NULL) || (fread(dados, 1, (size_t)tamanhoLido, arquivo) != (size_t)tamanhoLido)){
+    fprintf(stderr, "erro: nao foi possivel ler %s\n", nomeIndice);
+    fclose(arquivo);
+    free(dados);
+    return 1;
+  }
+  fclose(arquivo);
+  tamanho = (uint32_t)tamanhoLido;
+
+  if((tamanho < TAMANHO_CABECALHO_INDICE) ||
+     (memcmp(dados, MAGICO_FORMATO_INDICE, TAMANHO_MAGICO_FORMATO_INDICE) != 0) ||
+     (formatoBinario_crc32(0, dados, 16) != (uint32_t)formatoBinario_leInteiro(&dados[16], TAMANHO_CRC_BINARIO))){
+    fprintf(stderr, "erro: %s nao é um indice valido\n", nomeIndice);
+    free(dados);
+    return 1;
+  }
+  tamanhoCabecalho = (uint32_t)formatoBinario_leInteiro(&dados[12], 4);
+
+  if(nomeRegistro != NULL){
+    registro = fopen(nomeRegistro, "rb");
+    saida = fopen(nomeSaida, "wb");
+    if((registro == NULL) || (saida == NULL)){
+      fprintf(stderr, "erro: nao foi possivel abrir %s ou criar %s\n", nomeRegistro, nomeSaida);
+      if(registro != NULL){
+        fclose(registro);
+      }
+      if(saida != NULL){
+        fclose(saida);
+      }
+      free(dados);
+      return 1;
+    }
+    // Arquivo prealocado: o conteudo começa depois do setor de cabeçalho
+    if((fread(prefixo, 1, sizeof(prefixo), registro) == sizeof(prefixo)) &&
+       (memcmp(prefixo, PREFIXO_REGISTRO_PREALOCADO, sizeof(prefixo)) == 0)){
+      inicioArquivo = TAMANHO_REGISTRO_PREALOCADO;
+    }
+  }
+
+  // Baldes: na ordem do registro, ate o resumo ou o primeiro registro invalido
+  printf("trechos         deslocamento      tamanho   primeiro (s)     ultimo (s)\n");
+  posicao = TAMANHO_CABECALHO_INDICE;
+  while(posicao < tamanho){
+    tamanhoRegistro = formatoIndice_verificaRegistro(&dados[posicao], (tamanho - posicao));
+    if((tamanhoRegistro == 0) || (dados[posicao] != REGISTRO_INDICE_BALDE)){
+      break;
+    }
+    conteudo = &dados[posicao + TAMANHO_INICIO_REGISTRO_INDICE];
+    posicao += tamanhoRegistro;
+    if(baldes == 0){
+      base = formatoBinario_leInteiro(&conteudo[8], 8);
+    }
+    baldes ++;
+
+    if(!consulta_selecionaBalde(conteudo, &consulta, base)){
+      continue;
+    }
+    selecionados ++;
+    deslocamento = (uint32_t)formatoBinario_leInteiro(&conteudo[0], 4);
+    fimBalde = (deslocamento + (uint32_t)formatoBinario_leInteiro(&conteudo[4], 4));
+    printf("               %12u %12u   %12.6f   %12.6f\n",
+      (unsigned)deslocamento,
+      (unsigned)(fimBalde - deslocamento),
+      ((double)(formatoBinario_leInteiro(&conteudo[8], 8) - base) / 1000000.0),
+      ((double)(formatoBinario_leInteiro(&conteudo[16], 8) - base) / 1000000.0)
+    );
+
+    // Trechos vizinhos sao extraidos como um so
+    if(haTrecho && (deslocamento <= fimTrecho)){
+      if(fimBalde > fimTrecho){
+        fimTrecho = fimBalde;
+      }
+      continue;
+    }
+    if(haTrecho){
+      trechos ++;
+      bytesTrechos += (fimTrecho - inicioTrecho);
+      if(registro != NULL){
+        resultado |= consulta_copiaTrecho(registro, saida, (inicioArquivo + inicioTrecho), (fimTrecho - inicioTrecho));
+      }
+    }else if((registro != NULL) && (deslocamento > 0) && (tamanhoCabecalho > 0)){
+      resultado |= consulta_copiaTrecho(registro, saida, inicioArquivo, tamanhoCabecalho);
+    }
+    inicioTrecho = deslocamento;
+    fimTrecho = fimBalde;
+    haTrecho = 1;
+  }
+  if(haTrecho){
+    trechos ++;
+    bytesTrechos += (fimTrecho - inicioTrecho);
+    if(registro != NULL){
+      resultado |= consulta_copiaTrecho(registro, saida, (inicioArquivo + inicioTrecho), (fimTrecho - inicioTrecho));
+    }
+  }
+  printf("%u de %u baldes, %u trechos, %llu bytes do registro\n\n",
+    (unsigned)selecionados, (unsigned)baldes, (unsigned)trechos, (unsigned long long)bytesTrechos);
+
+  if(consulta_mostraResumo(dados, tamanho, base) != 0){
+    printf("indice nao finalizado (captura interrompida): sem resumo por identificador\n");
+  }
+
+  if(registro != NULL){
+    fclose(registro);
+    fclose(saida);
+    if(resultado != 0){
+      fprintf(stderr, "erro: o registro termina antes de um trecho do indice\n");
+    }
+  }
+  free(dados);
+
+  return resultado;
+}
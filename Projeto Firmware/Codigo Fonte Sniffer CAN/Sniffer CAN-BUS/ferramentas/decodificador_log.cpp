@@ -0,0 +1,641 @@
+/**
+ * @file    decodificador_log.cpp
+ * @brief   Ferramenta de linha de comando (computador) que converte um registro binario do cartao
+ *          (LOG-xxxx.bin, formatos binario e colunar) ou um corpo colunar recebido pelo servidor
+ *          para o texto formatado, o texto simples ou CSV. O texto gerado é identico ao que o
+ *          firmware escreveria com o formato texto. Ao final mostra em stderr a taxa de compressão.
+ *
+ *          Compilação: g++ -O2 -o decodificador_log decodificador_log.cpp ../src/compressor_lz.cpp
+ *          Uso:        decodificador_log [-f | -s | -c] LOG-0001.bin [saida]
+ *                        -f texto formatado (padrao), -s texto simples, -c CSV
+ *
+ *          Blocos com CRC invalido sao descartados com um aviso em stderr e a leitura continua na
+ *          proxima marca de bloco.
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "../src/formato_binario.h"
+#include "../src/compressor_lz.h"
+
+// Definições importantes (mesmos valores de tipos.h e gerenciamento_cartao.cpp)
+#define RESOLUCAO_TEMPO_REGISTRO              100   // us, o texto mostra decimos de milisegundo
+#define TAMANHO_DEFINIDO_ESPACO_ENTRE_TEMPO_ID 20
+#define TAMANHO_MAXIMO_BLOCO_BINARIO          (1024UL * 1024UL)
+
+typedef enum EformatoSaida {
+  eSaidaFormatado,
+  eSaidaSimples,
+  eSaidaCSV
+}TformatoSaida;
+
+// Estado da decodificação de um arquivo
+typedef struct Sdecodificador{
+  FILE *saida;
+  TformatoSaida formato;
+  // Hora (us desde 1970) e instante (esp_timer, us) da primeira mensagem, do cabeçalho
+  uint64_t relogioPrimeira;
+  uint64_t tempoPrimeira;
+  // Instante da ultima mensagem (us) e o mesmo em decimos de ms, base do intervalo do texto
+  uint64_t tempoAnterior;
+  uint64_t decimosAnterior;
+  uint8_t primeiroQuadro;
+  // Contadores
+  uint32_t quadros;
+  uint32_t blocos;
+  uint32_t blocosInvalidos;
+  // Bytes dos blocos colunares antes e depois da compressão
+  uint32_t bytesColunas;
+  uint32_t bytesComprimidos;
+}Tdecodificador;
+
+typedef Tdecodificador *PTdecodificador;
+
+/**
+ * @brief  Função que obtem o nome do estado de erro (saudeBarramento_nomeEstado)
+ * @param  estado: estado de erro
+ * @return nome do estado
+ */
+static const char *decodificador_nomeEstado(uint8_t estado){
+  switch(estado){
+    case 0:  return "ATIVO";
+    case 1:  return "AVISO";
+    case 2:  return "PASSIVO";
+    case 3:  return "BUS-OFF";
+    default: return "?";
+  }
+}
+
+/**
+ * @brief  Função que escreve o marcador de inicio com a hora da primeira mensagem
+ * @param  decodificador: estado da decodificação
+ * @return void
+ */
+static void decodificador_escreveInicio(PTdecodificador decodificador){
+  uint32_t segundos = (uint32_t)(decodificador->relogioPrimeira / 1000000ULL);
+  uint32_t decimos = (uint32_t)((decodificador->relogioPrimeira % 1000000ULL) / RESOLUCAO_TEMPO_REGISTRO);
+
+  switch(decodificador->formato){
+    case eSaidaFormatado:
+      fprintf(decodificador->saida, "# INICIO: %u.%04u s\r\n", segundos, decimos);
+      break;
+    case eSaidaSimples:
+      fprintf(decodificador->saida, "#INICIO;%u.%04u;", segundos, decimos);
+      break;
+    case eSaidaCSV:
+      fprintf(decodificador->saida, "inicio,%llu,,,,,,,\n", (unsigned long long)decodificador->relogioPrimeira);
+      break;
+  }
+}
+
+/**
+ * @brief  Função que escreve um marcador com contador (perdidos ou suprimidos)
+ * @param  decodificador: estado da decodificação
+ * @param  tipo: REGISTRO_BINARIO_PERDIDOS ou REGISTRO_BINARIO_SUPRIMIDOS
+ * @param  valor: quantidade de quadros
+ * @return void
+ */
+static void decodificador_escreveMarcador(PTdecodificador decodificador, uint8_t tipo, uint32_t valor){
+  uint8_t perdidos = (tipo == REGISTRO_BINARIO_PERDIDOS);
+
+  switch(decodificador->formato){
+    case eSaidaFormatado:
+      fprintf(decodificador->saida, (perdidos ? "# QUADROS PERDIDOS NA FILA: %u\r\n" :
+                                                "# QUADROS SEM MUDANCA SUPRIMIDOS: %u\r\n"), valor);
+      break;
+    case eSaidaSimples:
+      fprintf(decodificador->saida, (perdidos ? "#PERDIDOS;%u;" : "#SUPRIMIDOS;%u;"), valor);
+      break;
+    case eSaidaCSV:
+      fprintf(decodificador->saida, (perdidos ? "perdidos,,,,,,,,%u\n" : "suprimidos,,,,,,,,%u\n"), valor);
+      break;
+  }
+}
+
+/**
+ * @brief  Função que escreve o marcador de saude do barramento
+ * @param  decodificador: estado da decodificação
+ * @param  estado, tec, rec, eflg: contadores do MCP2515
+ * @param  valores: estouros RXB0 e RXB1, carga minima e maxima (decimos de %)
+ * @return void
+ */
+static void decodificador_escreveSaude(PTdecodificador decodificador, uint8_t estado, uint8_t tec,
+                                       uint8_t rec, uint8_t eflg, const uint32_t *valores){
+  switch(decodificador->formato){
+    case eSaidaFormatado:
+      fprintf(decodificador->saida, "# SAUDE: %s TEC=%u REC=%u EFLG=%02X ESTOUROS=%u/%u CARGA=%u.%u-%u.%u%%\r\n",
+        decodificador_nomeEstado(estado), tec, rec, eflg, valores[0], valores[1],
+        (valores[2] / 10), (valores[2] % 10), (valores[3] / 10), (valores[3] % 10));
+      break;
+    case eSaidaSimples:
+      fprintf(decodificador->saida, "#SAUDE;%u;%u;%u;%02X;%u;%u;%u;%u;",
+        estado, tec, rec, eflg, valores[0], valores[1], valores[2], valores[3]);
+      break;
+    case eSaidaCSV:
+      fprintf(decodificador->saida, "saude,,,,,,,,%s TEC=%u REC=%u EFLG=%02X ESTOUROS=%u/%u CARGA=%u.%u-%u.%u\n",
+        decodificador_nomeEstado(estado), tec, rec, eflg, valores[0], valores[1],
+        (valores[2] / 10), (valores[2] % 10), (valores[3] / 10), (valores[3] % 10));
+      break;
+  }
+}
+
+/**
+ * @brief  Função que escreve um quadro. O intervalo segue a conta de formatadorQuadro_formataTexto
+ * @param  decodificador: estado da decodificação
+ * @param  flags: primeiro byte do registro do quadro
+ * @param  tempo: instante absoluto do quadro (esp_timer, us)
+ * @param  id: identificador
+ * @param  dados: bytes de dados
+ * @return void
+ */
+static void decodificador_escreveQuadro(PTdecodificador decodificador, uint8_t flags, uint64_t tempo,
+                                        uint32_t id, const uint8_t *dados){
+  FILE *saida = decodificador->saida;
+  uint8_t dlc = (flags & BINARIO_QUADRO_DLC);
+  uint8_t extendido = ((flags & BINARIO_QUADRO_EXTENDIDO) != 0);
+  uint64_t decimos = (tempo / RESOLUCAO_TEMPO_REGISTRO);
+  char intervalo[32];
+  int tamanho;
+  uint8_t i;
+
+  if(decodificador->primeiroQuadro){
+    decodificador->decimosAnterior = decimos;
+    decodificador->primeiroQuadro = 0;
+  }
+  tamanho = sprintf(intervalo, "%0.1f",
+    (float)((float)((decimos - decodificador->decimosAnterior) * RESOLUCAO_TEMPO_REGISTRO)/1000));
+  decodificador->decimosAnterior = decimos;
+
+  switch(decodificador->formato){
+    case eSaidaFormatado:
+      fprintf(saida, "%s%*s", intervalo,
+        ((tamanho < TAMANHO_DEFINIDO_ESPACO_ENTRE_TEMPO_ID) ? (TAMANHO_DEFINIDO_ESPACO_ENTRE_TEMPO_ID - tamanho) : 0), "");
+      fprintf(saida, (extendido ? "%08X      %02X   " : "%03X      %02X   "), id, dlc);
+      for(i=0; i<dlc; i++){
+        fprintf(saida, "%02X ", dados[i]);
+      }
+      fprintf(saida, "\r\n");
+      break;
+    case eSaidaSimples:
+      fprintf(saida, (extendido ? "%s;%08X;%02X;" : "%s;%03X;%02X;"), intervalo, id, dlc);
+      for(i=0; i<dlc; i++){
+        fprintf(saida, "%02X", dados[i]);
+      }
+      fprintf(saida, ";");
+      break;
+    case eSaidaCSV:
+      fprintf(saida, (extendido ? "quadro,%llu,%s,%08X,%u,%u,%u,%u," : "quadro,%llu,%s,%03X,%u,%u,%u,%u,"),
+        (unsigned long long)(decodificador->relogioPrimeira + (tempo - decodificador->tempoPrimeira)),
+        intervalo, id, extendido, ((flags & BINARIO_QUADRO_REMOTO) != 0),
+        ((flags & BINARIO_QUADRO_ERRO) != 0), dlc);
+      for(i=0; i<dlc; i++){
+        fprintf(saida, "%02X", dados[i]);
+      }
+      fprintf(saida, "\n");
+      break;
+  }
+  decodificador->quadros ++;
+}
+
+/**
+ * @brief  Função que decodifica os registros de um bloco com CRC valido
+ * @param  decodificador: estado da decodificação
+ * @param  registros: inicio dos registros
+ * @param  tamanho: bytes dos registros
+ * @return 0 se todos os registros foram lidos, -1 se o bloco terminou no meio de um registro
+ */
+static int decodificador_leBloco(PTdecodificador decodificador, const uint8_t *registros, uint32_t tamanho){
+  uint32_t posicao = 0;
+  uint64_t valor;
+  uint32_t valores[4];
+  const uint8_t *contadores;
+  uint8_t lido;
+  uint8_t tipo;
+  uint8_t tamanhoId;
+  uint8_t dlc;
+  uint32_t id;
+  uint8_t i;
+
+  while(posicao < tamanho){
+    tipo = registros[posicao++];
+
+    if(tipo & REGISTRO_BINARIO_MARCADOR){
+      if((tipo == REGISTRO_BINARIO_PERDIDOS) || (tipo == REGISTRO_BINARIO_SUPRIMIDOS)){
+        lido = formatoBinario_leVarint(&registros[posicao], (tamanho - posicao), &valor);
+        if(lido == 0){
+          return -1;
+        }
+        posicao += lido;
+        decodificador_escreveMarcador(decodificador, tipo, (uint32_t)valor);
+      }else if(tipo == REGISTRO_BINARIO_SAUDE){
+        // Estado, TEC, REC e EFLG, seguidos de 4 varints
+        if((tamanho - posicao) < 4){
+          return -1;
+        }
+        contadores = &registros[posicao];
+        posicao += 4;
+        for(i=0; i<4; i++){
+          lido = formatoBinario_leVarint(&registros[posicao], (tamanho - posicao), &valor);
+          if(lido == 0){
+            return -1;
+          }
+          posicao += lido;
+          valores[i] = (uint32_t)valor;
+        }
+        decodificador_escreveSaude(decodificador, contadores[0], contadores[1], contadores[2], contadores[3], valores);
+      }else{
+        // Tipo desconhecido: uma versao mais nova do formato, o restante do bloco é ignorado
+        fprintf(stderr, "aviso: registro 0x%02X desconhecido, restante do bloco ignorado\n", tipo);
+        return 0;
+      }
+      continue;
+    }
+
+    // Quadro
+    lido = formatoBinario_leVarint(&registros[posicao], (tamanho - posicao), &valor);
+    if(lido == 0){
+      return -1;
+    }
+    posicao += lido;
+    decodificador->tempoAnterior += (uint64_t)ZIGZAG_DECODIFICA(valor);
+
+    tamanhoId = ((tipo & BINARIO_QUADRO_EXTENDIDO) ? 4 : 2);
+    dlc = (tipo & BINARIO_QUADRO_DLC);
+    if((tamanho - posicao) < (uint32_t)(tamanhoId + dlc)){
+      return -1;
+    }
+    id = (uint32_t)formatoBinario_leInteiro(&registros[posicao], tamanhoId);
+    posicao += tamanhoId;
+
+    decodificador_escreveQuadro(decodificador, tipo, decodificador->tempoAnterior, id, &registros[posicao]);
+    posicao += dlc;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief  Função que decodifica as colunas de um bloco colunar ja descomprimido
+ * @param  decodificador: estado da decodificação
+ * @param  colunas: colunas do bloco
+ * @param  tamanho: bytes das colunas
+ * @return 0 ou -1 se as colunas forem inconsistentes
+ */
+static int decodificador_leColunas(PTdecodificador decodificador, const uint8_t *colunas, uint32_t tamanho){
+  uint32_t posicao = 0;
+  uint64_t valor;
+  uint64_t quantidade;
+  uint64_t quantidadeDicionario;
+  uint64_t *tempos = NULL;
+  uint32_t *indices = NULL;
+  uint8_t *flags = NULL;
+  uint32_t *identificadores = NULL;
+  uint8_t (*anterior)[8] = NULL;
+  uint8_t dados[8];
+  uint32_t posicaoByte[8];
+  uint64_t acumulador = 0;
+  uint8_t bitsAcumulados = 0;
+  uint8_t bitsIndice;
+  int64_t intervalo = 0;
+  uint8_t lido;
+  uint8_t dlc;
+  uint32_t i, j;
+  int resultado = -1;
+
+  // Quantidade e marcadores
+  lido = formatoBinario_leVarint(colunas, tamanho, &quantidade);
+  if((lido == 0) || (quantidade > tamanho)){
+    return -1;
+  }
+  posicao += lido;
+  lido = formatoBinario_leVarint(&colunas[posicao], (tamanho - posicao), &valor);
+  if((lido == 0) || (valor > (tamanho - posicao - lido))){
+    return -1;
+  }
+  posicao += lido;
+  if(decodificador_leBloco(decodificador, &colunas[posicao], (uint32_t)valor) != 0){
+    return -1;
+  }
+  posicao += (uint32_t)valor;
+
+  tempos = (uint64_t *)malloc(sizeof(uint64_t) * (quantidade + 1));
+  indices = (uint32_t *)malloc(sizeof(uint32_t) * (quantidade + 1));
+  if((tempos == NULL) || (indices == NULL)){
+    goto fim;
+  }
+
+  // Tempos: delta do delta
+  for(i=0; i<quantidade; i++){
+    lido = formatoBinario_leVarint(&colunas[posicao], (tamanho - posicao), &valor);
+    if(lido == 0){
+      goto fim;
+    }
+    posicao += lido;
+    intervalo += ZIGZAG_DECODIFICA(valor);
+    decodificador->tempoAnterior += (uint64_t)intervalo;
+    tempos[i] = decodificador->tempoAnterior;
+  }
+
+  // Dicionario
+  lido = formatoBinario_leVarint(&colunas[posicao], (tamanho - posicao), &quantidadeDicionario);
+  if((lido == 0) || (quantidadeDicionario > quantidade)){
+    goto fim;
+  }
+  posicao += lido;
+  flags = (uint8_t *)malloc(quantidadeDicionario + 1);
+  identificadores = (uint32_t *)malloc(sizeof(uint32_t) * (quantidadeDicionario + 1));
+  anterior = (uint8_t (*)[8])calloc((quantidadeDicionario + 1), 8);
+  if((flags == NULL) || (identificadores == NULL) || (anterior == NULL)){
+    goto fim;
+  }
+  for(j=0; j<quantidadeDicionario; j++){
+    if(posicao >= tamanho){
+      goto fim;
+    }
+    flags[j] = colunas[posicao++];
+    lido = formatoBinario_leVarint(&colunas[posicao], (tamanho - posicao), &valor);
+    if(lido == 0){
+      goto fim;
+    }
+    posicao += lido;
+    identificadores[j] = (uint32_t)valor;
+  }
+
+  // Indices
+  bitsIndice = formatoBinario_bitsIndice((uint32_t)quantidadeDicionario);
+  for(i=0; i<quantidade; i++){
+    while(bitsAcumulados < bitsIndice){
+      if(posicao >= tamanho){
+        goto fim;
+      }
+      acumulador |= ((uint64_t)colunas[posicao++] << bitsAcumulados);
+      bitsAcumulados += 8;
+    }
+    indices[i] = (uint32_t)(acumulador & ((bitsIndice < 32) ? (((uint64_t)1 << bitsIndice) - 1) : 0xFFFFFFFFULL));
+    acumulador >>= bitsIndice;
+    bitsAcumulados -= bitsIndice;
+    if(indices[i] >= quantidadeDicionario){
+      goto fim;
+    }
+  }
+
+  // DLC, dois por byte, logo depois os dados agrupados pela posição do byte
+  if((tamanho - posicao) < ((quantidade + 1) / 2)){
+    goto fim;
+  }
+  (void)memset(posicaoByte, 0x00, sizeof(posicaoByte));
+  for(i=0; i<quantidade; i++){
+    dlc = ((colunas[posicao + (i / 2)] >> ((i & 1) * 4)) & BINARIO_QUADRO_DLC);
+    if(dlc > 8){
+      goto fim;
+    }
+    for(lido=0; lido<dlc; lido++){
+      posicaoByte[lido] ++;
+    }
+  }
+  j = (uint32_t)(posicao + ((quantidade + 1) / 2));
+  for(lido=0; lido<8; lido++){
+    valor = posicaoByte[lido];
+    posicaoByte[lido] = j;
+    j += (uint32_t)valor;
+  }
+  if(j > tamanho){
+    goto fim;
+  }
+  for(i=0; i<quantidade; i++){
+    dlc = ((colunas[posicao + (i / 2)] >> ((i & 1) * 4)) & BINARIO_QUADRO_DLC);
+    for(lido=0; lido<dlc; lido++){
+      dados[lido] = (colunas[posicaoByte[lido]++] ^ anterior[indices[i]][lido]);
+      anterior[indices[i]][lido] = dados[lido];
+    }
+    decodificador_escreveQuadro(decodificador, (uint8_t)(flags[indices[i]] | dlc), tempos[i], 
+                                identificadores[indices[i]], dados);
+  }
+  resultado = 0;
+
+fim:
+  free(tempos);
+  free(indices);
+  free(flags);
+  free(identificadores);
+  free(anterior);
+  return resultado;
+}
+
+/**
+ * @brief  Função que descomprime e decodifica um bloco colunar com CRC valido
+ * @param  decodificador: estado da decodificação
+ * @param  bloco: bytes apos o tamanho do bloco (tamanho das colunas e colunas comprimidas)
+ * @param  tamanho: bytes do bloco
+ * @return 0 ou -1 se o bloco for inconsistente
+ */
+static int decodificador_leBlocoColunar(PTdecodificador decodificador, const uint8_t *bloco, uint32_t tamanho){
+  uint32_t tamanhoColunas;
+  uint8_t *colunas;
+  int resultado;
+
+  if(tamanho < 4){
+    return -1;
+  }
+  tamanhoColunas = (uint32_t)formatoBinario_leInteiro(bloco, 4);
+  if(tamanhoColunas > TAMANHO_MAXIMO_BLOCO_BINARIO){
+    return -1;
+  }
+  colunas = (uint8_t *)malloc(tamanhoColunas + 1);
+  if(colunas == NULL){
+    return -1;
+  }
+  if(compressorLZ_descomprime(&bloco[4], (tamanho - 4), colunas, tamanhoColunas) != (int32_t)tamanhoColunas){
+    free(colunas);
+    return -1;
+  }
+  decodificador->bytesColunas += tamanhoColunas;
+  decodificador->bytesComprimidos += (TAMANHO_INICIO_BLOCO_BINARIO + tamanho + TAMANHO_CRC_BINARIO);
+
+  resultado = decodificador_leColunas(decodificador, colunas, tamanhoColunas);
+  free(colunas);
+  return resultado;
+}
+
+/**
+ * @brief  Função que decodifica o conteudo de um registro binario
+ * @param  decodificador: estado da decodificação
+ * @param  dados: conteudo do arquivo
+ * @param  tamanho: bytes do arquivo
+ * @return 0 ou -1 se o arquivo nao é um registro binario
+ */
+static int decodificador_decodifica(PTdecodificador decodificador, const uint8_t *dados, uint32_t tamanho){
+  uint32_t posicao = 0;
+  uint32_t tamanhoBloco;
+  uint32_t crc;
+  unsigned long tamanhoLogico;
+  uint8_t colunar;
+
+  // Arquivo prealocado: o cabeçalho de texto indica os bytes validos
+  if((tamanho >= TAMANHO_REGISTRO_PREALOCADO) &&
+     (strncmp((const char *)dados, PREFIXO_REGISTRO_PREALOCADO, strlen(PREFIXO_REGISTRO_PREALOCADO)) == 0)){
+    tamanhoLogico = strtoul((const char *)&dados[strlen(PREFIXO_REGISTRO_PREALOCADO)], NULL, 10);
+    if((tamanhoLogico >= TAMANHO_REGISTRO_PREALOCADO) && (tamanhoLogico < tamanho)){
+      tamanho = (uint32_t)tamanhoLogico;
+    }
+    posicao = TAMANHO_REGISTRO_PREALOCADO;
+  }
+
+  if(((tamanho - posicao) < TAMANHO_CABECALHO_BINARIO) ||
+     (memcmp(&dados[posicao], MAGICO_FORMATO_BINARIO, TAMANHO_MAGICO_FORMATO_BINARIO) != 0)){
+    fprintf(stderr, "erro: o arquivo nao é um registro binario\n");
+    return -1;
+  }
+  if(dados[posicao + 4] != VERSAO_FORMATO_BINARIO){
+    fprintf(stderr, "aviso: versao %u do formato, o decodificador conhece a versao %u\n",
+      dados[posicao + 4], VERSAO_FORMATO_BINARIO);
+  }
+  crc = formatoBinario_crc32(0, &dados[posicao], 24);
+  if(crc != (uint32_t)formatoBinario_leInteiro(&dados[posicao + 24], TAMANHO_CRC_BINARIO)){
+    fprintf(stderr, "aviso: CRC do cabeçalho invalido, a hora das mensagens pode estar errada\n");
+  }
+
+  decodificador->relogioPrimeira = formatoBinario_leInteiro(&dados[posicao + 8], 8);
+  decodificador->tempoPrimeira = formatoBinario_leInteiro(&dados[posicao + 16], 8);
+  decodificador->tempoAnterior = decodificador->tempoPrimeira;
+  decodificador->primeiroQuadro = 1;
+  posicao += dados[posicao + 5];
+
+  if(decodificador->formato == eSaidaCSV){
+    fprintf(decodificador->saida, "tipo,relogio_us,intervalo_ms,id,ext,rtr,err,dlc,dados\n");
+  }
+  decodificador_escreveInicio(decodificador);
+
+  while((tamanho - posicao) >= (TAMANHO_INICIO_BLOCO_BINARIO + TAMANHO_CRC_BINARIO)){
+
+    // Procura a marca do proximo bloco
+    colunar = ((dados[posicao] == MARCA_BLOCO_COLUNAR_0) && (dados[posicao + 1] == MARCA_BLOCO_COLUNAR_1));
+    if(((dados[posicao] != MARCA_BLOCO_BINARIO_0) || (dados[posicao + 1] != MARCA_BLOCO_BINARIO_1)) && (!colunar)){
+      posicao ++;
+      continue;
+    }
+
+    tamanhoBloco = (uint32_t)formatoBinario_leInteiro(&dados[posicao + 2], 4);
+    if((tamanhoBloco <= TAMANHO_MAXIMO_BLOCO_BINARIO) &&
+       (tamanhoBloco <= (tamanho - posicao - TAMANHO_INICIO_BLOCO_BINARIO - TAMANHO_CRC_BINARIO))){
+      crc = formatoBinario_crc32(0, &dados[posicao + 2], (tamanhoBloco + 4));
+      if(crc == (uint32_t)formatoBinario_leInteiro(&dados[posicao + TAMANHO_INICIO_BLOCO_BINARIO + tamanhoBloco], TAMANHO_CRC_BINARIO)){
+        if(colunar){
+          if(decodificador_leBlocoColunar(decodificador, &dados[posicao + TAMANHO_INICIO_BLOCO_BINARIO], tamanhoBloco) != 0){
+            fprintf(stderr, "aviso: bloco colunar em %u inconsistente\n", posicao);
+          }
+        }else if(decodificador_leBloco(decodificador, &dados[posicao + TAMANHO_INICIO_BLOCO_BINARIO], tamanhoBloco) != 0){
+          fprintf(stderr, "aviso: bloco em %u termina no meio de um registro\n", posicao);
+        }
+        decodificador->blocos ++;
+        posicao += (TAMANHO_INICIO_BLOCO_BINARIO + tamanhoBloco + TAMANHO_CRC_BINARIO);
+        continue;
+      }
+    }
+
+    // Bloco corrompido ou incompleto (queda de energia): os intervalos seguintes ficam relativos
+    // ao ultimo quadro valido
+    fprintf(stderr, "aviso: bloco invalido em %u, procurando o proximo\n", posicao);
+    decodificador->blocosInvalidos ++;
+    posicao ++;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief  Função principal da ferramenta
+ * @param  argc, argv: [-f | -s | -c] entrada [saida]
+ * @return 0 ou 1 em caso de erro
+ */
+int main(int argc, char **argv){
+  Tdecodificador decodificador;
+  const char *entrada = NULL;
+  const char *nomeSaida = NULL;
+  FILE *arquivo;
+  uint8_t *dados;
+  long tamanho;
+  int resultado;
+  int i;
+
+  (void)memset(&decodificador, 0x00, sizeof(Tdecodificador));
+  decodificador.formato = eSaidaFormatado;
+
+  for(i=1; i<argc; i++){
+    if(strcmp(argv[i], "-f") == 0){
+      decodificador.formato = eSaidaFormatado;
+    }else if(strcmp(argv[i], "-s") == 0){
+      decodificador.formato = eSaidaSimples;
+    }else if(strcmp(argv[i], "-c") == 0){
+      decodificador.formato = eSaidaCSV;
+    }else if(entrada == NULL){
+      entrada = argv[i];
+    }else if(nomeSaida == NULL){
+      nomeSaida = argv[i];
+    }else{
+      entrada = NULL;
+      break;
+    }
+  }
+  if(entrada == NULL){
+    fprintf(stderr, "uso: %s [-f | -s | -c] LOG-xxxx.bin [saida]\n"
+                    "  -f texto formatado (padrao), -s texto simples, -c CSV\n", argv[0]);
+    return 1;
+  }
+
+  // Le o arquivo inteiro, os registros tem no maximo alguns MiB
+  arquivo = fopen(entrada, "rb");
+  if(arquivo == NULL){
+    fprintf(stderr, "erro: nao foi possivel abrir %s\n", entrada);
+    return 1;
+  }
+  (void)fseek(arquivo, 0, SEEK_END);
+  tamanho = ftell(arquivo);
+  (void)fseek(arquivo, 0, SEEK_SET);
+  dados = (uint8_t *)malloc((tamanho > 0) ? (size_t)tamanho : 1);
+  if((dados == NULL) || (fread(dados, 1, (size_t)tamanho, arquivo) != (size_t)tamanho)){
+    fprintf(stderr, "erro: nao foi possivel ler %s\n", entrada);
+    fclose(arquivo);
+    free(dados);
+    return 1;
+  }
+  fclose(arquivo);
+
+  decodificador.saida = stdout;
+  if(nomeSaida != NULL){
+    // Binario para manter o "\r\n" do texto como no cartao
+    decodificador.saida = fopen(nomeSaida, "wb");
+    if(decodificador.saida == NULL){
+      fprintf(stderr, "erro: nao foi possivel criar %s\n", nomeSaida);
+      free(dados);
+      return 1;
+    }
+  }
+
+  resultado = decodificador_decodifica(&decodificador, dados, (uint32_t)tamanho);
+
+  if(nomeSaida != NULL){
+    fclose(decodificador.saida);
+  }
+  free(dados);
+
+  if(resultado == 0){
+    fprintf(stderr, "%u quadros em %u blocos, %u blocos invalidos\n",
+      decodificador.quadros, decodificador.blocos, decodificador.blocosInvalidos);
+    if(decodificador.quadros > 0){
+      fprintf(stderr, "%ld bytes no arquivo, %.2f bytes/quadro\n", tamanho, ((double)tamanho / decodificador.quadros));
+    }
+    if(decodificador.bytesComprimidos > 0){
+      fprintf(stderr, "colunas: %u bytes, comprimidas: %u bytes (%.2f:1)\n", decodificador.bytesColunas,
+        decodificador.bytesComprimidos, ((double)decodificador.bytesColunas / decodificador.bytesComprimidos));
+    }
+  }
+
+  return ((resultado == 0) ? 0 : 1);
+}
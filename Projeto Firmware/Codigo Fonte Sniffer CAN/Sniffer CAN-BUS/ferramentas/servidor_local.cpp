@@ -0,0 +1,240 @@
+/**
+ * @file    servidor_local.cpp
+ * @brief   Ferramenta de linha de comando (computador) que substitui o servidor do registro durante os
+ *          testes. Aceita os POST do sniffer com keep-alive, responde 200 sem corpo e conta as
+ *          conexões e as requisições de cada uma. Com a sessão persistente, o sniffer deve abrir uma
+ *          conexão e mandar todos os blocos por ela; cada conexão a mais é uma reconexão.
+ *          Para HTTPS, coloque um terminador TLS na frente (por exemplo o stunnel, accept = 8443 e
+ *          connect = 8080): cada handshake TLS chega aqui como uma conexão nova.
+ *
+ *          Compilação: g++ -O2 -o servidor_local servidor_local.cpp
+ *          Uso:        servidor_local [-p porta] [-n requisicoes]
+ *                        -p porta TCP (padrão 8080)
+ *                        -n fecha a conexão depois dessa quantidade de requisições, como um servidor
+ *                           que limita o keep-alive, para testar a reconexão
+ *
+ *          Configure no cartão URL Registros: "http://<ip do computador>:8080/api/Esp32".
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <strings.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// Definições importantes
+#define PORTA_PADRAO               8080
+#define TAMANHO_MAXIMO_CABECALHO   8192
+#define TAMANHO_PARTE_CORPO        65536
+
+// Contagem geral, mostrada ao sair
+static volatile sig_atomic_t executando = 1;
+static uint32_t conexoes = 0;
+static uint64_t requisicoes = 0;
+static uint64_t bytesRecebidos = 0;
+
+/**
+ * @brief  Função que trata o Ctrl+C, interrompendo o accept para mostrar a contagem
+ * @param  sinal: sinal recebido
+ * @return void
+ */
+static void servidor_interrompe(int sinal){
+  (void)sinal;
+  executando = 0;
+}
+
+/**
+ * @brief  Função que procura um campo no cabeçalho HTTP, sem diferenciar maiusculas
+ * @param  cabecalho: cabeçalho terminado em zero
+ * @param  nome: nome do campo seguido de ':'
+ * @return ponteiro para o valor do campo ou NULL
+ */
+static const char *servidor_campo(const char *cabecalho, const char *nome){
+  const char *linha = strstr(cabecalho, "\r\n");
+  size_t tamanho = strlen(nome);
+
+  while((linha != NULL) && (linha[2] != '\r')){
+    linha += 2;
+    if(strncasecmp(linha, nome, tamanho) == 0){
+      linha += tamanho;
+      while(*linha == ' '){
+        linha ++;
+      }
+      return linha;
+    }
+    linha = strstr(linha, "\r\n");
+  }
+  return NULL;
+}
+
+/**
+ * @brief  Função que atende as requisições de uma conexão ate o cliente fechar, um erro ou o limite
+ * @param  conexao: socket da conexão
+ * @param  limite: requisições antes de fechar a conexão, 0 sem limite
+ * @param  quantidade: recebe as requisições atendidas
+ * @param  bytes: recebe os bytes de corpo recebidos
+ * @return void
+ */
+static void servidor_atende(int conexao, uint32_t limite, uint32_t *quantidade, uint64_t *bytes){
+  static char cabecalho[TAMANHO_MAXIMO_CABECALHO + 1];
+  static char corpo[TAMANHO_PARTE_CORPO];
+  const char *campo;
+  const char *fimCabecalho;
+  char resposta[128];
+  size_t ocupado = 0;
+  size_t tamanhoCabecalho;
+  uint64_t restante;
+  ssize_t lido;
+  int fecha;
+  int tamanhoResposta;
+
+  *quantidade = 0;
+  *bytes = 0;
+
+  for(;;){
+    // Le ate o fim do cabeçalho; o que sobrou da leitura anterior ja esta no inicio do buffer
+    cabecalho[ocupado] = '\0';
+    while((fimCabecalho = strstr(cabecalho, "\r\n\r\n")) == NULL){
+      if(ocupado >= TAMANHO_MAXIMO_CABECALHO){
+        return;
+      }
+      lido = recv(conexao, &cabecalho[ocupado], (TAMANHO_MAXIMO_CABECALHO - ocupado), 0);
+      if(lido <= 0){
+        return;
+      }
+      ocupado += (size_t)lido;
+      cabecalho[ocupado] = '\0';
+    }
+    tamanhoCabecalho = (size_t)(fimCabecalho - cabecalho) + 4;
+
+    campo = servidor_campo(cabecalho, "Content-Length:");
+    restante = ((campo != NULL) ? strtoull(campo, NULL, 10) : 0);
+    campo = servidor_campo(cabecalho, "Connection:");
+    fecha = ((campo != NULL) && (strncasecmp(campo, "close", 5) == 0));
+
+    // Descarta o corpo: primeiro o que veio junto com o cabeçalho, depois o resto do socket
+    if((ocupado - tamanhoCabecalho) >= restante){
+      *bytes += restante;
+      tamanhoCabecalho += (size_t)restante;
+      restante = 0;
+    }else{
+      *bytes += (ocupado - tamanhoCabecalho);
+      restante -= (ocupado - tamanhoCabecalho);
+      tamanhoCabecalho = ocupado;
+    }
+    (void)memmove(cabecalho, &cabecalho[tamanhoCabecalho], (ocupado - tamanhoCabecalho));
+    ocupado -= tamanhoCabecalho;
+    while(restante > 0){
+      lido = recv(conexao, corpo, ((restante < sizeof(corpo)) ? (size_t)restante : sizeof(corpo)), 0);
+      if(lido <= 0){
+        return;
+      }
+      *bytes += (uint64_t)lido;
+      restante -= (uint64_t)lido;
+    }
+
+    (*quantidade) ++;
+    if((limite > 0) && (*quantidade >= limite)){
+      fecha = 1;
+    }
+
+    tamanhoResposta = snprintf(resposta, sizeof(resposta),
+      "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nConnection: %s\r\n\r\n", (fecha ? "close" : "keep-alive"));
+    if(send(conexao, resposta, (size_t)tamanhoResposta, MSG_NOSIGNAL) != tamanhoResposta){
+      return;
+    }
+    if(fecha){
+      return;
+    }
+  }
+}
+
+/**
+ * @brief  Função principal da ferramenta
+ * @param  argc: quantidade de argumentos
+ * @param  argv: argumentos
+ * @return 0 ou 1 se nao conseguir abrir a porta
+ */
+int main(int argc, char **argv){
+  struct sockaddr_in endereco;
+  struct sockaddr_in cliente;
+  struct sigaction acao;
+  socklen_t tamanhoEndereco;
+  uint32_t porta = PORTA_PADRAO;
+  uint32_t limite = 0;
+  uint32_t quantidade;
+  uint64_t bytes;
+  int servidor;
+  int conexao;
+  int opcao = 1;
+  int i;
+
+  for(i=1; i<argc; i++){
+    if((strcmp(argv[i], "-p") == 0) && ((i + 1) < argc)){
+      porta = (uint32_t)strtoul(argv[++i], NULL, 10);
+    }else if((strcmp(argv[i], "-n") == 0) && ((i + 1) < argc)){
+      limite = (uint32_t)strtoul(argv[++i], NULL, 10);
+    }else{
+      fprintf(stderr, "Uso: servidor_local [-p porta] [-n requisicoes]\n");
+      return 1;
+    }
+  }
+
+  // Sem SA_RESTART, o Ctrl+C interrompe o accept
+  (void)memset(&acao, 0x00, sizeof(acao));
+  acao.sa_handler = servidor_interrompe;
+  (void)sigaction(SIGINT, &acao, NULL);
+  (void)sigaction(SIGTERM, &acao, NULL);
+
+  servidor = socket(AF_INET, SOCK_STREAM, 0);
+  if(servidor < 0){
+    perror("socket");
+    return 1;
+  }
+  (void)setsockopt(servidor, SOL_SOCKET, SO_REUSEADDR, &opcao, sizeof(opcao));
+  (void)memset(&endereco, 0x00, sizeof(endereco));
+  endereco.sin_family = AF_INET;
+  endereco.sin_addr.s_addr = htonl(INADDR_ANY);
+  endereco.sin_port = htons((uint16_t)porta);
+  if((bind(servidor, (struct sockaddr *)&endereco, sizeof(endereco)) != 0) || (listen(servidor, 4) != 0)){
+    perror("bind");
+    close(servidor);
+    return 1;
+  }
+  printf("Aguardando o sniffer na porta %u\n", porta);
+  fflush(stdout);
+
+  // O sniffer usa uma conexão por vez, entao as conexões sao atendidas em sequencia
+  while(executando){
+    tamanhoEndereco = sizeof(cliente);
+    conexao = accept(servidor, (struct sockaddr *)&cliente, &tamanhoEndereco);
+    if(conexao < 0){
+      continue;
+    }
+    conexoes ++;
+    servidor_atende(conexao, limite, &quantidade, &bytes);
+    close(conexao);
+    requisicoes += quantidade;
+    bytesRecebidos += bytes;
+    printf("Conexao %u de %s: %u requisicoes, %llu bytes\n", conexoes, inet_ntoa(cliente.sin_addr),
+           quantidade, (unsigned long long)bytes);
+    fflush(stdout);
+  }
+
+  close(servidor);
+  printf("\nTotal: %u conexoes, %llu requisicoes, %llu bytes", conexoes, (unsigned long long)requisicoes,
+         (unsigned long long)bytesRecebidos);
+  if(conexoes > 0){
+    printf(", %.1f requisicoes por conexao", ((double)requisicoes / conexoes));
+  }
+  printf("\n");
+  return 0;
+}
@@ -0,0 +1,422 @@
+/**
+ * @file    validador_mf4.cpp
+ * @brief   Ferramenta de linha de comando (computador) que valida um registro MF4 do cartao
+ *          (LOG-xxxx.mf4). O arquivo é lido somente pelos links, sem usar os endereços fixos do
+ *          firmware: identificação, HD, FH, DG, CG, SI, CN (com a composição do CAN_DataFrame),
+ *          CC e DT. Confere o tipo, o tamanho e o alinhamento de cada bloco, se os canais cabem
+ *          no registro e se os ciclos do CG batem com o tamanho do DT. Os quadros sao lidos pelos
+ *          canais encontrados pelo nome, como uma ferramenta de medição faria.
+ *
+ *          Compilação: g++ -O2 -o validador_mf4 validador_mf4.cpp
+ *          Uso:        validador_mf4 [-q] LOG-0001.mf4
+ *                        -q somente o resumo, sem listar os quadros
+ *
+ *          Retorna 0 se o arquivo for valido e finalizado, 1 caso contrario.
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// Definições importantes
+#define TAMANHO_INICIO_BLOCO        24
+#define QUANTIDADE_MAXIMA_CANAIS    32
+#define TAMANHO_MAXIMO_NOME         64
+
+// Canal lido do CN
+typedef struct Scanal{
+  char nome[TAMANHO_MAXIMO_NOME];
+  uint8_t tipo;
+  uint8_t tipoDado;
+  uint8_t bitInicio;
+  uint32_t byteInicio;
+  uint32_t bits;
+  // Conversão linear (valor * fator + deslocamento), fator 1 sem CC
+  double deslocamento;
+  double fator;
+}Tcanal;
+
+// Arquivo carregado e os canais do grupo
+typedef struct Svalidador{
+  const uint8_t *dados;
+  uint64_t tamanho;
+  uint32_t erros;
+  Tcanal canal[QUANTIDADE_MAXIMA_CANAIS];
+  uint32_t quantidadeCanais;
+}Tvalidador;
+
+typedef Tvalidador *PTvalidador;
+
+/**
+ * @brief  Função que le um inteiro little-endian
+ * @param  origem: bytes
+ * @param  tamanho: quantidade de bytes (ate 8)
+ * @return valor lido
+ */
+static uint64_t validador_leInteiro(const uint8_t *origem, uint8_t tamanho){
+  uint64_t valor = 0;
+  uint8_t i;
+
+  for(i=0; i<tamanho; i++){
+    valor |= ((uint64_t)origem[i] << (8 * i));
+  }
+  return valor;
+}
+
+/**
+ * @brief  Função que le um numero real (IEEE 754, 8 bytes)
+ * @param  origem: bytes
+ * @return valor lido
+ */
+static double validador_leReal(const uint8_t *origem){
+  uint64_t bits = validador_leInteiro(origem, 8);
+  double valor;
+
+  (void)memcpy(&valor, &bits, sizeof(valor));
+  return valor;
+}
+
+/**
+ * @brief  Função que registra um erro de validação
+ * @param  validador: estado da validação
+ * @param  mensagem: descrição do erro
+ * @param  endereco: endereço do bloco
+ * @return void
+ */
+static void validador_erro(PTvalidador validador, const char *mensagem, uint64_t endereco){
+  fprintf(stderr, "erro: %s (bloco em %llu)\n", mensagem, (unsigned long long)endereco);
+  validador->erros ++;
+}
+
+/**
+ * @brief  Função que confere o inicio de um bloco: id, alinhamento, tamanho e links
+ * @param  validador: estado da validação
+ * @param  endereco: endereço do bloco
+ * @param  id: id esperado ("##XX")
+ * @param  linksMinimos: quantidade minima de links
+ * @return ponteiro para o bloco, NULL se invalido
+ */
+static const uint8_t *validador_bloco(PTvalidador validador, uint64_t endereco, const char *id, uint64_t linksMinimos){
+  const uint8_t *bloco;
+  uint64_t tamanho;
+  uint64_t links;
+
+  if(((endereco % 8) != 0) || ((endereco + TAMANHO_INICIO_BLOCO) > validador->tamanho)){
+    validador_erro(validador, "endereço fora do arquivo ou desalinhado", endereco);
+    return NULL;
+  }
+  bloco = &validador->dados[endereco];
+  tamanho = validador_leInteiro(&bloco[8], 8);
+  links = validador_leInteiro(&bloco[16], 8);
+  if(memcmp(bloco, id, 4) != 0){
+    validador_erro(validador, id, endereco);
+    return NULL;
+  }
+  if((tamanho < (TAMANHO_INICIO_BLOCO + (8 * links))) || ((endereco + tamanho) > validador->tamanho) ||
+     (links < linksMinimos)){
+    validador_erro(validador, "tamanho ou links do bloco invalidos", endereco);
+    return NULL;
+  }
+  return bloco;
+}
+
+/**
+ * @brief  Função que obtem um link de um bloco
+ * @param  bloco: bloco conferido por validador_bloco
+ * @param  indice: posição do link
+ * @return endereço apontado (0 = nenhum)
+ */
+static uint64_t validador_link(const uint8_t *bloco, uint32_t indice){
+  return validador_leInteiro(&bloco[TAMANHO_INICIO_BLOCO + (8 * indice)], 8);
+}
+
+/**
+ * @brief  Função que le o texto de um bloco TX
+ * @param  validador: estado da validação
+ * @param  endereco: endereço do TX (0 = sem texto)
+ * @param  texto: recebe ate TAMANHO_MAXIMO_NOME caracteres
+ * @return void
+ */
+static void validador_texto(PTvalidador validador, uint64_t endereco, char *texto){
+  const uint8_t *bloco;
+  uint64_t tamanho;
+
+  texto[0] = '\0';
+  if(endereco == 0){
+    return;
+  }
+  bloco = validador_bloco(validador, endereco, "##TX", 0);
+  if(bloco == NULL){
+    return;
+  }
+  tamanho = (validador_leInteiro(&bloco[8], 8) - TAMANHO_INICIO_BLOCO);
+  if(tamanho >= TAMANHO_MAXIMO_NOME){
+    tamanho = (TAMANHO_MAXIMO_NOME - 1);
+  }
+  (void)memcpy(texto, &bloco[TAMANHO_INICIO_BLOCO], tamanho);
+  texto[tamanho] = '\0';
+}
+
+/**
+ * @brief  Função que le uma lista de canais e as suas composições
+ * @param  validador: estado da validação
+ * @param  endereco: primeiro CN da lista
+ * @param  tamanhoRegistro: bytes de dados do registro
+ * @return void
+ */
+static void validador_leCanais(PTvalidador validador, uint64_t endereco, uint32_t tamanhoRegistro){
+  const uint8_t *bloco;
+  const uint8_t *dados;
+  const uint8_t *conversao;
+  Tcanal *canal;
+
+  while(endereco != 0){
+    bloco = validador_bloco(validador, endereco, "##CN", 8);
+    if(bloco == NULL){
+      return;
+    }
+    if(validador->quantidadeCanais == QUANTIDADE_MAXIMA_CANAIS){
+      validador_erro(validador, "canais demais", endereco);
+      return;
+    }
+    canal = &validador->canal[validador->quantidadeCanais++];
+    dados = &bloco[TAMANHO_INICIO_BLOCO + (8 * validador_leInteiro(&bloco[16], 8))];
+    validador_texto(validador, validador_link(bloco, 2), canal->nome);
+    canal->tipo = dados[0];
+    canal->tipoDado = dados[2];
+    canal->bitInicio = dados[3];
+    canal->byteInicio = (uint32_t)validador_leInteiro(&dados[4], 4);
+    canal->bits = (uint32_t)validador_leInteiro(&dados[8], 4);
+    canal->deslocamento = 0.0;
+    canal->fator = 1.0;
+
+    if((canal->byteInicio + ((canal->bitInicio + canal->bits + 7) / 8)) > tamanhoRegistro){
+      validador_erro(validador, "canal fora do registro", endereco);
+    }
+
+    // Conversão linear, a unica usada pelo firmware
+    if(validador_link(bloco, 4) != 0){
+      conversao = validador_bloco(validador, validador_link(bloco, 4), "##CC", 4);
+      if(conversao != NULL){
+        dados = &conversao[TAMANHO_INICIO_BLOCO + (8 * validador_leInteiro(&conversao[16], 8))];
+        if((dados[0] == 1) && (validador_leInteiro(&dados[6], 2) == 2)){
+          canal->deslocamento = validador_leReal(&dados[24]);
+          canal->fator = validador_leReal(&dados[32]);
+        }else{
+          validador_erro(validador, "conversão nao suportada", validador_link(bloco, 4));
+        }
+      }
+    }
+
+    printf("canal %-26s tipo %u dado %2u byte %2u bit %u bits %3u\n", canal->nome, canal->tipo,
+           canal->tipoDado, canal->byteInicio, canal->bitInicio, canal->bits);
+
+    if(validador_link(bloco, 1) != 0){
+      validador_leCanais(validador, validador_link(bloco, 1), tamanhoRegistro);
+    }
+    endereco = validador_link(bloco, 0);
+  }
+}
+
+/**
+ * @brief  Função que busca um canal pelo nome
+ * @param  validador: estado da validação
+ * @param  nome: nome do canal
+ * @return canal, NULL se nao existir
+ */
+static const Tcanal *validador_canal(PTvalidador validador, const char *nome){
+  uint32_t i;
+
+  for(i=0; i<validador->quantidadeCanais; i++){
+    if(strcmp(validador->canal[i].nome, nome) == 0){
+      return &validador->canal[i];
+    }
+  }
+  fprintf(stderr, "erro: canal %s nao encontrado\n", nome);
+  validador->erros ++;
+  return NULL;
+}
+
+/**
+ * @brief  Função que le o valor inteiro de um canal em um registro
+ * @param  registro: inicio do registro
+ * @param  canal: canal
+ * @return valor
+ */
+static uint64_t validador_valor(const uint8_t *registro, const Tcanal *canal){
+  uint64_t valor = validador_leInteiro(&registro[canal->byteInicio], (uint8_t)((canal->bitInicio + canal->bits + 7) / 8));
+
+  valor >>= canal->bitInicio;
+  if(canal->bits < 64){
+    valor &= ((1ULL << canal->bits) - 1);
+  }
+  return valor;
+}
+
+/**
+ * @brief  Função principal da ferramenta
+ */
+int main(int argc, char **argv){
+  Tvalidador validador;
+  FILE *arquivo;
+  uint8_t *dados;
+  const uint8_t *bloco;
+  const uint8_t *registro;
+  uint64_t tamanho;
+  uint64_t enderecoDG, enderecoCG, enderecoDT;
+  uint64_t ciclos, tamanhoDT, i;
+  uint32_t tamanhoRegistro;
+  uint16_t flagsNaoFinalizado;
+  int quieto = 0;
+  int argumento = 1;
+  char nome[TAMANHO_MAXIMO_NOME];
+  const Tcanal *tempo, *id, *ide, *dlc, *comprimento, *bytes, *barramento;
+  uint32_t j;
+
+  if((argc > argumento) && (strcmp(argv[argumento], "-q") == 0)){
+    quieto = 1;
+    argumento ++;
+  }
+  if(argc <= argumento){
+    fprintf(stderr, "uso: %s [-q] LOG-0001.mf4\n", argv[0]);
+    return 1;
+  }
+
+  arquivo = fopen(argv[argumento], "rb");
+  if(arquivo == NULL){
+    perror(argv[argumento]);
+    return 1;
+  }
+  (void)fseek(arquivo, 0, SEEK_END);
+  tamanho = (uint64_t)ftell(arquivo);
+  (void)fseek(arquivo, 0, SEEK_SET);
+  dados = (uint8_t *)malloc((size_t)tamanho + 1);
+  if((dados == NULL) || (fread(dados, 1, (size_t)tamanho, arquivo) != tamanho)){
+    fprintf(stderr, "erro ao ler %s\n", argv[argumento]);
+    fclose(arquivo);
+    return 1;
+  }
+  fclose(arquivo);
+
+  (void)memset(&validador, 0x00, sizeof(validador));
+  validador.dados = dados;
+  validador.tamanho = tamanho;
+
+  // Identificação
+  if(tamanho < 64){
+    fprintf(stderr, "erro: arquivo menor que a identificação\n");
+    return 1;
+  }
+  flagsNaoFinalizado = (uint16_t)validador_leInteiro(&dados[60], 2);
+  printf("identificação \"%.8s\" versao %.8s (%u) programa \"%.8s\"\n", (const char *)dados,
+         (const char *)&dados[8], (unsigned)validador_leInteiro(&dados[28], 2), (const char *)&dados[16]);
+  if(memcmp(dados, "MDF     ", 8) == 0){
+    if(flagsNaoFinalizado != 0){
+      validador_erro(&validador, "arquivo finalizado com flags de nao finalizado", 0);
+    }
+  }else if(memcmp(dados, "UnFinMF ", 8) == 0){
+    fprintf(stderr, "aviso: arquivo nao finalizado (flags 0x%04X)\n", flagsNaoFinalizado);
+    validador.erros ++;
+  }else{
+    fprintf(stderr, "erro: arquivo nao é MDF\n");
+    return 1;
+  }
+  if(validador_leInteiro(&dados[28], 2) < 400){
+    validador_erro(&validador, "versao anterior ao MDF 4", 0);
+  }
+
+  // HD e FH
+  bloco = validador_bloco(&validador, 64, "##HD", 6);
+  if(bloco == NULL){
+    return 1;
+  }
+  printf("inicio %llu ns desde 1970\n", (unsigned long long)validador_leInteiro(&bloco[TAMANHO_INICIO_BLOCO + 48], 8));
+  enderecoDG = validador_link(bloco, 0);
+  if((validador_link(bloco, 1) == 0) || (validador_bloco(&validador, validador_link(bloco, 1), "##FH", 2) == NULL)){
+    validador_erro(&validador, "HD sem FH", 64);
+  }
+
+  // DG com um CG
+  bloco = validador_bloco(&validador, enderecoDG, "##DG", 4);
+  if(bloco == NULL){
+    return 1;
+  }
+  enderecoCG = validador_link(bloco, 1);
+  enderecoDT = validador_link(bloco, 2);
+  if(bloco[TAMANHO_INICIO_BLOCO + 32] != 0){
+    validador_erro(&validador, "DG com identificador de registro (nao ordenado)", enderecoDG);
+  }
+  if(validador_link(bloco, 0) != 0){
+    fprintf(stderr, "aviso: somente o primeiro DG é lido\n");
+  }
+
+  bloco = validador_bloco(&validador, enderecoCG, "##CG", 6);
+  if(bloco == NULL){
+    return 1;
+  }
+  ciclos = validador_leInteiro(&bloco[TAMANHO_INICIO_BLOCO + 48 + 8], 8);
+  tamanhoRegistro = (uint32_t)validador_leInteiro(&bloco[TAMANHO_INICIO_BLOCO + 48 + 24], 4);
+  validador_texto(&validador, validador_link(bloco, 2), nome);
+  printf("grupo \"%s\" flags 0x%04X, %llu ciclos de %u bytes\n", nome,
+         (unsigned)validador_leInteiro(&bloco[TAMANHO_INICIO_BLOCO + 48 + 16], 2), (unsigned long long)ciclos, tamanhoRegistro);
+  if((validador_link(bloco, 3) != 0) && (validador_bloco(&validador, validador_link(bloco, 3), "##SI", 3) != NULL)){
+    registro = &validador.dados[validador_link(bloco, 3) + TAMANHO_INICIO_BLOCO + 24];
+    printf("fonte tipo %u barramento %u\n", registro[0], registro[1]);
+  }
+  validador_leCanais(&validador, validador_link(bloco, 1), tamanhoRegistro);
+
+  // DT
+  bloco = validador_bloco(&validador, enderecoDT, "##DT", 0);
+  if(bloco == NULL){
+    return 1;
+  }
+  tamanhoDT = (validador_leInteiro(&bloco[8], 8) - TAMANHO_INICIO_BLOCO);
+  if((tamanhoRegistro == 0) || ((tamanhoDT % tamanhoRegistro) != 0)){
+    validador_erro(&validador, "DT nao é multiplo do registro", enderecoDT);
+  }else if((tamanhoDT / tamanhoRegistro) != ciclos){
+    validador_erro(&validador, "ciclos do CG diferentes do tamanho do DT", enderecoCG);
+  }
+  if((enderecoDT + TAMANHO_INICIO_BLOCO + tamanhoDT) != tamanho){
+    fprintf(stderr, "aviso: %llu bytes depois do DT\n", (unsigned long long)(tamanho - (enderecoDT + TAMANHO_INICIO_BLOCO + tamanhoDT)));
+  }
+
+  // Quadros pelos canais do padrao de registro de barramento
+  tempo = validador_canal(&validador, "Timestamp");
+  id = validador_canal(&validador, "CAN_DataFrame.ID");
+  ide = validador_canal(&validador, "CAN_DataFrame.IDE");
+  dlc = validador_canal(&validador, "CAN_DataFrame.DLC");
+  comprimento = validador_canal(&validador, "CAN_DataFrame.DataLength");
+  bytes = validador_canal(&validador, "CAN_DataFrame.DataBytes");
+  barramento = validador_canal(&validador, "CAN_DataFrame.BusChannel");
+  if((tempo != NULL) && (id != NULL) && (ide != NULL) && (dlc != NULL) && (comprimento != NULL) &&
+     (bytes != NULL) && (barramento != NULL) && (tamanhoRegistro > 0)){
+    for(i=0; i<(tamanhoDT / tamanhoRegistro); i++){
+      registro = &bloco[TAMANHO_INICIO_BLOCO + (i * tamanhoRegistro)];
+      if((validador_valor(registro, comprimento) > 8) || (validador_valor(registro, barramento) == 0)){
+        validador_erro(&validador, "registro invalido", (enderecoDT + TAMANHO_INICIO_BLOCO + (i * tamanhoRegistro)));
+        break;
+      }
+      if(!quieto){
+        printf("%14.6f CAN%u %8llX%s %u ",
+               ((double)validador_valor(registro, tempo) * tempo->fator) + tempo->deslocamento,
+               (unsigned)validador_valor(registro, barramento),
+               (unsigned long long)validador_valor(registro, id),
+               (validador_valor(registro, ide) ? "x" : " "),
+               (unsigned)validador_valor(registro, dlc));
+        for(j=0; j<validador_valor(registro, comprimento); j++){
+          printf(" %02X", registro[bytes->byteInicio + j]);
+        }
+        printf("\n");
+      }
+    }
+  }
+
+  printf("%llu quadros, %u erros\n", (unsigned long long)(tamanhoDT / ((tamanhoRegistro > 0) ? tamanhoRegistro : 1)), validador.erros);
+  free(dados);
+
+  return ((validador.erros == 0) ? 0 : 1);
+}
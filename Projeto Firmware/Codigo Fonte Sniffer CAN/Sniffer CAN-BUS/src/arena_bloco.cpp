@@ -0,0 +1,87 @@
+/**
+ * @file    arena_bloco.cpp
+ * @brief   Esse arquivo contem a arena dos buffers de cada bloco. É usada somente pelo consumidor,
+ *          por isso nao tem trava
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "arena_bloco.h"
+
+/**
+ * @brief  Função que reserva a memoria da arena. Deve ser chamada uma vez, na inicialização
+ * @param  arena: arena a ser inicializada
+ * @param  tamanho: quantidade de bytes da arena
+ * @return ERRO_ALOCACAO_MEMORIA ou SUCESSO
+ */
+Terro arenaBloco_inicializa(PTarenaBloco arena, Tuint32 tamanho){
+  (void)memset(arena, 0x00, sizeof(TarenaBloco));
+
+  arena->memoria = (Tuint8 *)malloc(tamanho);
+  if(arena->memoria == NULL){
+    return ERRO_ALOCACAO_MEMORIA;
+  }
+  arena->tamanho = tamanho;
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que toma um buffer da arena, alinhado em ALINHAMENTO_ARENA_BLOCO bytes
+ * @param  arena: arena do consumidor
+ * @param  tamanho: quantidade de bytes
+ * @return ponteiro para o buffer ou NULL se nao couber
+ */
+void *arenaBloco_reserva(PTarenaBloco arena, Tuint32 tamanho){
+  Tuint32 inicio = ((arena->ocupado + (ALINHAMENTO_ARENA_BLOCO - 1)) & ~(Tuint32)(ALINHAMENTO_ARENA_BLOCO - 1));
+
+  if((arena->memoria == NULL) || (inicio > arena->tamanho) || (tamanho > (arena->tamanho - inicio))){
+    arena->falhas ++;
+    return NULL;
+  }
+
+  arena->ocupado = (inicio + tamanho);
+  if(arena->ocupado > arena->marcaMaxima){
+    arena->marcaMaxima = arena->ocupado;
+  }
+  arena->reservas ++;
+
+  return &arena->memoria[inicio];
+}
+
+/**
+ * @brief  Função que obtem a posição atual da arena, para devolver depois tudo o que for reservado
+ * @param  arena: arena do consumidor
+ * @return marca a ser passada para arenaBloco_libera
+ */
+Tuint32 arenaBloco_marca(PTarenaBloco arena){
+  return arena->ocupado;
+}
+
+/**
+ * @brief  Função que devolve à arena todos os buffers reservados depois da marca
+ * @param  arena: arena do consumidor
+ * @param  marca: posição obtida com arenaBloco_marca
+ * @return void
+ */
+void arenaBloco_libera(PTarenaBloco arena, Tuint32 marca){
+  arena->ocupado = marca;
+}
+
+/**
+ * @brief  Função que obtem as estatisticas de uso da arena desde a inicialização
+ * @param  arena: arena do consumidor
+ * @param  tamanho: recebe a quantidade de bytes da arena
+ * @param  marcaMaxima: recebe a maior quantidade de bytes ja ocupada ao mesmo tempo
+ * @param  reservas: recebe a quantidade de buffers tomados
+ * @param  falhas: recebe a quantidade de buffers que nao couberam
+ * @return void
+ */
+void arenaBloco_obtemEstatistica(PTarenaBloco arena, Tuint32 *tamanho, Tuint32 *marcaMaxima,
+                                 Tuint32 *reservas, Tuint32 *falhas){
+  *tamanho = arena->tamanho;
+  *marcaMaxima = arena->marcaMaxima;
+  *reservas = arena->reservas;
+  *falhas = arena->falhas;
+}
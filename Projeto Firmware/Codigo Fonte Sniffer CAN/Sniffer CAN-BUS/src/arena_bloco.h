@@ -0,0 +1,29 @@
+/**
+ * @file    arena_bloco.h
+ * @brief   Esse arquivo contem o prototipo das funções da arena dos buffers de cada bloco. A memoria
+ *          é reservada uma vez na inicialização, depois o consumidor toma dela os buffers de
+ *          formatação e os devolve em ordem inversa (marca e libera), sem usar o heap
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef ARENA_BLOCO_H_INCLUDED
+#define ARENA_BLOCO_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Submódulos do sistema
+#include "tipos.h"
+#include "erros.h"
+
+/// Funções exportadas
+Terro arenaBloco_inicializa(PTarenaBloco arena, Tuint32 tamanho);
+void *arenaBloco_reserva(PTarenaBloco arena, Tuint32 tamanho);
+Tuint32 arenaBloco_marca(PTarenaBloco arena);
+void arenaBloco_libera(PTarenaBloco arena, Tuint32 marca);
+void arenaBloco_obtemEstatistica(PTarenaBloco arena, Tuint32 *tamanho, Tuint32 *marcaMaxima,
+                                 Tuint32 *reservas, Tuint32 *falhas);
+
+#endif // ARENA_BLOCO_H_INCLUDED
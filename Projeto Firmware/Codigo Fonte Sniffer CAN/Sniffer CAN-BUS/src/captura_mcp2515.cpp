@@ -0,0 +1,202 @@
+/**
+ * @file    captura_mcp2515.cpp
+ * @brief   Esse arquivo contem as funções da captura dos quadros do MCP2515. A tarefa de captura
+ *          bloqueia ate a borda de descida do INT (ou o tempo maximo, caso a borda tenha sido perdida),
+ *          drena os buffers de recepção enquanto o INT continuar ativo e volta a bloquear
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "captura_mcp2515.h"
+
+/**
+ * @brief  Função que decodifica os 13 bytes de um buffer de recepção do MCP2515
+ *         (SIDH, SIDL, EID8, EID0, DLC, D0..D7) para uma mensagem CAN
+ * @param  buffer: bytes lidos do buffer de recepção
+ * @param  mensagem: Ponteiro para a mensagem que recebera os dados
+ * @return void
+ */
+static void capturaMCP2515_decodificaBufferRX(const Tuint8 *buffer, PTmensagemCAN mensagem){
+  Tuint8 sidl = buffer[1];
+
+  if(sidl & MCP2515_BIT_EXIDE){
+    mensagem->identificador = (
+      FLAG_QUADRO_EXTENDIDO                |
+      ((Tuint32)buffer[0]          << 21) |
+      ((Tuint32)(sidl & 0xE0)      << 13) |
+      ((Tuint32)(sidl & 0x03)      << 16) |
+      ((Tuint32)buffer[2]          <<  8) |
+      ((Tuint32)buffer[3])
+    );
+    // No quadro extendido o RTR fica no registrador DLC
+    if(buffer[4] & MCP2515_BIT_RTR_EXTENDIDO){
+      mensagem->identificador |= FLAG_QUADRO_REMOTO;
+    }
+  }else{
+    mensagem->identificador = (((Tuint32)buffer[0] << 3) | (sidl >> 5));
+    // No quadro padrao o SRR do SIDL indica requisição remota
+    if(sidl & MCP2515_BIT_SRR){
+      mensagem->identificador |= FLAG_QUADRO_REMOTO;
+    }
+  }
+
+  // O DLC pode chegar a 15, mas o quadro carrega no maximo 8 bytes
+  mensagem->tamanho = (((buffer[4] & 0x0F) > TAMANHO_MAX_DADOS_QUADRO_CAN) ?
+                       TAMANHO_MAX_DADOS_QUADRO_CAN : (buffer[4] & 0x0F));
+  (void)memcpy(mensagem->dados, &buffer[5], TAMANHO_MAX_DADOS_QUADRO_CAN);
+}
+
+/**
+ * @brief  Função que soma na carga do barramento o quadro de um buffer de recepção, sem decodifica-lo
+ * @param  saude: saude do barramento
+ * @param  buffer: bytes lidos do buffer de recepção (SIDH, SIDL, EID8, EID0, DLC, D0..D7)
+ * @return void
+ */
+static void capturaMCP2515_contaCargaBufferRX(PTsaudeBarramento saude, const Tuint8 *buffer){
+  Tbool extendido = ((buffer[1] & MCP2515_BIT_EXIDE) != 0);
+  Tbool remoto = (extendido) ? ((buffer[4] & MCP2515_BIT_RTR_EXTENDIDO) != 0) : ((buffer[1] & MCP2515_BIT_SRR) != 0);
+  Tuint8 tamanho = (buffer[4] & 0x0F);
+
+  saudeBarramento_contaQuadro(saude, extendido, remoto,
+    ((tamanho > TAMANHO_MAX_DADOS_QUADRO_CAN) ? TAMANHO_MAX_DADOS_QUADRO_CAN : tamanho));
+}
+
+/**
+ * @brief  Função que le os buffers de recepção cheios do MCP2515.
+ *         Um unico RX STATUS decide a leitura; se os dois buffers estiverem cheios eles sao lidos
+ *         em uma mesma janela de chip select com READ RX BUFFER a partir de RXB0 (o ponteiro de
+ *         endereço segue ate RXB1). O RX0IF é limpo pela propria instrução e o RX1IF por BIT MODIFY.
+ *         Os bytes brutos ficam em buffer, a mensagem i começa em (i * MCP2515_DISTANCIA_RXB0_RXB1)
+ * @param  mcp: acesso ao MCP2515
+ * @param  buffer: array com espaço para MCP2515_TAMANHO_LEITURA_RX bytes
+ * @return quantidade de mensagens lidas (0 a 2)
+ */
+static Tuint8 capturaMCP2515_leBuffersRX(PTinterfaceMCP2515 mcp, Tuint8 *buffer){
+  Tuint8 cheios = (mcp->leStatusRX() & (MCP2515_STATUS_RXB0_CHEIO | MCP2515_STATUS_RXB1_CHEIO));
+
+  if(cheios == 0){
+    return 0;
+  }
+
+  // Os dois buffers cheios: le RXB0, CANSTAT, CANCTRL, RXB1CTRL e RXB1 em sequencia
+  if(cheios == (MCP2515_STATUS_RXB0_CHEIO | MCP2515_STATUS_RXB1_CHEIO)){
+    (void)memset(buffer, 0x00, MCP2515_TAMANHO_LEITURA_RX);
+    mcp->leBufferRX(MCP2515_INSTRUCAO_LE_RXB0, buffer, MCP2515_TAMANHO_LEITURA_RX);
+    mcp->modificaBit(MCP2515_REG_CANINTF, MCP2515_FLAG_RX1IF, 0x00);
+    return 2;
+  }
+
+  // Somente um buffer cheio, a propria instrução limpa o RXnIF correspondente
+  (void)memset(buffer, 0x00, MCP2515_TAMANHO_BUFFER_RX);
+  mcp->leBufferRX(((cheios & MCP2515_STATUS_RXB0_CHEIO) ? MCP2515_INSTRUCAO_LE_RXB0 : MCP2515_INSTRUCAO_LE_RXB1),
+                  buffer, MCP2515_TAMANHO_BUFFER_RX);
+  return 1;
+}
+
+/**
+ * @brief  Função que inicializa o estado da captura
+ * @param  captura: estado da captura
+ * @param  mcp: acesso ao MCP2515
+ * @return void
+ */
+void capturaMCP2515_inicializa(PTcapturaMCP2515 captura, PTinterfaceMCP2515 mcp){
+  captura->mcp = mcp;
+  captura->ultimoTempo = mcp->tempo();
+  captura->quadrosCapturados = 0;
+}
+
+/**
+ * @brief  Função que executa um ciclo da tarefa de captura: aguarda a notificação da borda do INT,
+ *         por no maximo TEMPO_MAXIMO_ESPERA_INTERRUPCAO (cobre uma borda perdida, com o INT ja em
+ *         nivel baixo quando a tarefa voltou a bloquear), e drena os buffers de recepção enquanto o
+ *         INT continuar ativo, decodificando cada quadro direto na celula da fila
+ * @param  captura: estado da captura
+ * @param  desc: descritor do sniffer (fila, saude do barramento e estatistica por identificador)
+ * @param  executando: a drenagem termina quando o sistema sair
+ * @return SUCESSO ou o erro da fila (a captura deve terminar)
+ */
+Terro capturaMCP2515_executa(PTcapturaMCP2515 captura, PTdescritorSniffer desc, const Tbool *executando){
+  PTinterfaceMCP2515 mcp = captura->mcp;
+  Tuint8 buffer[MCP2515_TAMANHO_LEITURA_RX];
+  PTmensagemCAN celula;
+  Terro erro;
+  Tuint8 quantidade, i;
+  Tuint32 notificacoes;
+  Tuint64 tempoBorda = 0;
+  Tuint64 tempoLeitura;
+  Tuint64 tempoQuadro;
+
+  notificacoes = mcp->aguardaInterrupcao(TEMPO_MAXIMO_ESPERA_INTERRUPCAO, &tempoBorda);
+
+  // Drena todos os buffers do MCP2515 enquanto o INT continuar ativo
+  while((*executando) && mcp->interrupcaoAtiva()){
+
+    // Instante antes da leitura: limite superior para a chegada dos quadros que ainda estão nos buffers
+    tempoLeitura = mcp->tempo();
+    quantidade = capturaMCP2515_leBuffersRX(mcp, buffer);
+
+    // INT ativo sem mensagem nos buffers, volta a aguardar a proxima interrupção
+    if(quantidade == 0){
+      break;
+    }
+
+    for(i=0; i<quantidade; i++){
+      // A carga do barramento conta todo quadro lido, mesmo os que a fila descartar
+      capturaMCP2515_contaCargaBufferRX((PTsaudeBarramento)&(desc->saude), &buffer[i * MCP2515_DISTANCIA_RXB0_RXB1]);
+
+      // Decodifica o quadro diretamente na celula da fila de mensagens CAN
+      erro = filaMensagem_reservaCelula((PTfilaMensagem)&(desc->filaMensagem), &celula);
+      if(erro == ERRO_FILA_CHEIA){
+        // Mensagem descartada pela politica da fila (ja contabilizada na fila)
+        continue;
+      }
+      if(erro != SUCESSO){
+        return erro;
+      }
+      capturaMCP2515_decodificaBufferRX(&buffer[i * MCP2515_DISTANCIA_RXB0_RXB1], celula);
+
+      // O primeiro quadro apos a borda recebe o instante da interrupção, os demais o da leitura.
+      // Se a borda foi perdida (espera esgotada) ou ja foi usada, vale o instante da leitura
+      tempoQuadro = tempoLeitura;
+      if((notificacoes > 0) && (tempoBorda > captura->ultimoTempo) && (tempoBorda <= tempoLeitura)){
+        tempoQuadro = tempoBorda;
+      }
+      notificacoes = 0;
+      captura->ultimoTempo = tempoQuadro;
+      celula->tempo = (Tuint32)(tempoQuadro & MASCARA_TEMPO_QUADRO_CAN);
+      estatisticaId_atualiza((PTtabelaEstatistica)&(desc->estatisticaId), celula, tempoQuadro);
+      filaMensagem_confirmaCelula((PTfilaMensagem)&(desc->filaMensagem));
+    }
+    captura->quadrosCapturados += quantidade;
+  }
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que amostra a saude do barramento a cada INTERVALO_AMOSTRA_SAUDE: le o TEC, o REC e o
+ *         EFLG do MCP2515 e limpa os bits de estouro (RX0OVR/RX1OVR), que o MCP2515 so limpa por escrita.
+ *         Chamada pela tarefa de captura entre as drenagens
+ * @param  captura: estado da captura
+ * @param  saude: saude do barramento
+ * @return void
+ */
+void capturaMCP2515_amostraSaude(PTcapturaMCP2515 captura, PTsaudeBarramento saude){
+  PTinterfaceMCP2515 mcp = captura->mcp;
+  Tuint64 agora = mcp->tempo();
+  Tuint8 contadores[2];
+  Tuint8 eflg;
+
+  if(!saudeBarramento_amostraPendente(saude, agora)){
+    return;
+  }
+
+  mcp->leRegistros(MCP2515_REG_TEC, contadores, sizeof(contadores));
+  mcp->leRegistros(MCP2515_REG_EFLG, &eflg, 1);
+  if(eflg & MCP2515_EFLG_ESTOUROS){
+    mcp->modificaBit(MCP2515_REG_EFLG, MCP2515_EFLG_ESTOUROS, 0x00);
+  }
+
+  saudeBarramento_amostra(saude, contadores[0], contadores[1], eflg, agora);
+}
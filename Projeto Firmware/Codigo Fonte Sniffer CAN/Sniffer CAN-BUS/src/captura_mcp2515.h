@@ -0,0 +1,53 @@
+/**
+ * @file    captura_mcp2515.h
+ * @brief   Esse arquivo contem o prototipo das funções da captura dos quadros do MCP2515: espera pela
+ *          borda do INT, drenagem dos buffers de recepção enquanto o INT estiver ativo, decodificação
+ *          direto na fila e amostra dos contadores de erro. O acesso ao MCP2515 é feito pela TinterfaceMCP2515, assim a mesma lógica
+ *          roda na placa e nos testes com um MCP2515 simulado
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef CAPTURA_MCP2515_H_INCLUDED
+#define CAPTURA_MCP2515_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Submódulos do sistema
+#include "tipos.h"
+#include "erros.h"
+#include "fila_mensagem.h"
+#include "estatistica_id.h"
+#include "saude_barramento.h"
+
+/// Instruções SPI e registradores do MCP2515 usados na leitura direta dos buffers de recepção e da saude
+#define MCP2515_INSTRUCAO_LE            0x03
+#define MCP2515_INSTRUCAO_MODIFICA_BIT  0x05
+#define MCP2515_INSTRUCAO_LE_RXB0       0x90      // READ RX BUFFER a partir de RXB0SIDH
+#define MCP2515_INSTRUCAO_LE_RXB1       0x94      // READ RX BUFFER a partir de RXB1SIDH
+#define MCP2515_INSTRUCAO_STATUS_RX     0xB0
+#define MCP2515_REG_TEC                 0x1C      // seguido do REC (0x1D)
+#define MCP2515_REG_CANINTF             0x2C
+#define MCP2515_REG_EFLG                0x2D
+#define MCP2515_BIT_EXIDE               0x08      // identificador extendido em RXBnSIDL
+#define MCP2515_BIT_SRR                 0x10      // requisição remota (quadro padrao) em RXBnSIDL
+#define MCP2515_BIT_RTR_EXTENDIDO       0x40      // requisição remota (quadro extendido) em RXBnDLC
+#define MCP2515_FLAG_RX0IF              0x01
+#define MCP2515_FLAG_RX1IF              0x02
+#define MCP2515_STATUS_RXB0_CHEIO       0x40
+#define MCP2515_STATUS_RXB1_CHEIO       0x80
+#define MCP2515_TAMANHO_BUFFER_RX       13        // SIDH, SIDL, EID8, EID0, DLC, D0..D7
+#define MCP2515_DISTANCIA_RXB0_RXB1     16        // RXB0SIDH (0x61) ate RXB1SIDH (0x71)
+#define MCP2515_TAMANHO_LEITURA_RX      (MCP2515_DISTANCIA_RXB0_RXB1 + MCP2515_TAMANHO_BUFFER_RX)
+
+/// Tempo maximo de espera pela borda do INT (ms), garante a drenagem mesmo se alguma borda for perdida
+#define TEMPO_MAXIMO_ESPERA_INTERRUPCAO 10
+
+/// Funções exportadas
+void capturaMCP2515_inicializa(PTcapturaMCP2515 captura, PTinterfaceMCP2515 mcp);
+Terro capturaMCP2515_executa(PTcapturaMCP2515 captura, PTdescritorSniffer desc, const Tbool *executando);
+void capturaMCP2515_amostraSaude(PTcapturaMCP2515 captura, PTsaudeBarramento saude);
+
+#endif // CAPTURA_MCP2515_H_INCLUDED
@@ -0,0 +1,643 @@
+/**
+ * @file    compilador_filtro.cpp
+ * @brief   Esse arquivo contem o compilador de filtros. A partir da lista de identificadores
+ *          desejados (a mesma do filtro de software) e, se houver, das taxas dos identificadores
+ *          presentes no barramento, calcula as mascaras e filtros do MCP2515 que minimizam o
+ *          trafego aceito pelo hardware e depois descartado pelo filtro de software.
+ *
+ *          O MCP2515 tem a mascara 0 com 2 filtros e a mascara 1 com 4 filtros. Cada mascara é
+ *          usada para um so tipo de quadro, assim padrao e extendido podem ser misturados.
+ *          A busca é gulosa: os identificadores de cada mascara sao agrupados dois a dois,
+ *          sempre unindo o par que menos aumenta o custo, ate caberem nos filtros disponiveis.
+ *          Custo = taxa dos identificadores indesejados conhecidos que passam + peso fixo por
+ *          identificador indesejado sem taxa conhecida que passa.
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "compilador_filtro.h"
+
+// Definições importantes
+#define MAXIMA_QUANTIDADE_GRUPOS_COMPILADOR   512
+#define MAXIMA_QUANTIDADE_TAXAS_COMPILADOR    256
+#define PESO_ID_SEM_TAXA                      1.0f    // sem perfil: cada identificador indesejado pesa igual
+#define PESO_ID_SEM_TAXA_COM_PERFIL           0.01f   // com perfil: identificador fora dele é raro (quadros/s)
+#define BITS_ID_PADRAO                        11
+#define BITS_ID_EXTENDIDO                     29
+#define SEPARADOR_LISTA_IDS                   ';'
+#define SEPARADOR_TAXA_IDENTIFICADOR          '='
+#define BITS_TIPO(extendido)                  ((extendido) ? BITS_ID_EXTENDIDO : BITS_ID_PADRAO)
+#define MASCARA_TIPO(extendido)               ((extendido) ? MASCARA_ID_EXTENDIDO : MASCARA_ID_PADRAO)
+
+// Grupo de identificadores atendido por um filtro
+typedef struct SgrupoCompilador{
+  // Bits comparados do grupo (os demais zerados)
+  Tuint32 valor;
+  // Bits em que todos os identificadores do grupo concordam
+  Tuint32 mascara;
+  // Quantidade de identificadores desejados cobertos pelo grupo
+  Tuint32 desejados;
+  // Custo do grupo sozinho
+  float custo;
+}TgrupoCompilador;
+
+typedef TgrupoCompilador *PTgrupoCompilador;
+
+// Taxa de um identificador presente no barramento
+typedef struct StaxaCompilador{
+  Tuint32 id;
+  Tbool extendido;
+  Tbool desejado;
+  float taxa;
+}TtaxaCompilador;
+
+typedef TtaxaCompilador *PTtaxaCompilador;
+
+// Dados comuns a todas as avaliações
+typedef struct ScontextoCompilador{
+  PTtaxaCompilador taxas;
+  Tuint16 quantidadeTaxas;
+  float pesoSemTaxa;
+}TcontextoCompilador;
+
+typedef TcontextoCompilador *PTcontextoCompilador;
+
+// Programação de uma mascara e seus filtros
+typedef struct SresultadoMascara{
+  Tuint32 mascara;
+  Tuint32 filtro[QUANTIDADE_FILTROS_MASCARA_1];
+  Tuint8 quantidadeFiltros;
+  Tbool extendido;
+  Tuint32 desejados;
+  float idsFalsos;
+  float taxaFalsos;
+  float custo;
+}TresultadoMascara;
+
+typedef TresultadoMascara *PTresultadoMascara;
+
+/**
+ * @brief  Função que avalia um conjunto de filtros que compartilham a mesma mascara
+ * @param  contexto: taxas conhecidas e peso dos identificadores sem taxa
+ * @param  extendido: tipo dos filtros
+ * @param  mascara: mascara comum
+ * @param  valores: valores dos filtros
+ * @param  quantidade: quantidade de filtros
+ * @param  desejados: quantidade de identificadores desejados cobertos (grupos disjuntos)
+ * @param  idsFalsos: recebe a quantidade de identificadores indesejados aceitos
+ * @param  taxaFalsos: recebe a taxa conhecida (quadros/s) dos indesejados aceitos
+ * @return custo
+ */
+static float compiladorFiltro_avalia(PTcontextoCompilador contexto, Tbool extendido, Tuint32 mascara,
+                                     const Tuint32 *valores, Tuint8 quantidade, Tuint32 desejados,
+                                     float *idsFalsos, float *taxaFalsos){
+  Tuint8 i, j, distintos = 0;
+  Tuint16 t;
+  Tuint32 observadosFalsos = 0;
+  Tbool repetido;
+  float aceitos, semTaxa;
+
+  *taxaFalsos = 0;
+
+  // Filtros iguais sob a mascara aceitam o mesmo conjunto
+  for(i=0; i<quantidade; i++){
+    repetido = FALSO;
+    for(j=0; j<i; j++){
+      if((valores[i] & mascara) == (valores[j] & mascara)){
+        repetido = VERDADEIRO;
+        break;
+      }
+    }
+    if(!repetido){
+      distintos ++;
+    }
+  }
+  aceitos = ((float)distintos * ldexpf(1.0f, (BITS_TIPO(extendido) - __builtin_popcount(mascara & MASCARA_TIPO(extendido)))));
+  *idsFalsos = (aceitos > (float)desejados) ? (aceitos - (float)desejados) : 0.0f;
+
+  // Indesejados com taxa conhecida que passam pelos filtros
+  for(t=0; t<contexto->quantidadeTaxas; t++){
+    if((contexto->taxas[t].extendido != extendido) || contexto->taxas[t].desejado){
+      continue;
+    }
+    for(i=0; i<quantidade; i++){
+      if((contexto->taxas[t].id & mascara) == (valores[i] & mascara)){
+        observadosFalsos ++;
+        *taxaFalsos += contexto->taxas[t].taxa;
+        break;
+      }
+    }
+  }
+
+  semTaxa = (*idsFalsos - (float)observadosFalsos);
+  return ((((semTaxa > 0.0f) ? semTaxa : 0.0f) * contexto->pesoSemTaxa) + *taxaFalsos);
+}
+
+/**
+ * @brief  Função que calcula o custo de um grupo sozinho
+ * @param  contexto: taxas conhecidas e peso dos identificadores sem taxa
+ * @param  extendido: tipo do grupo
+ * @param  grupo: grupo avaliado
+ * @return custo
+ */
+static float compiladorFiltro_custoGrupo(PTcontextoCompilador contexto, Tbool extendido, PTgrupoCompilador grupo){
+  float idsFalsos, taxaFalsos;
+
+  return compiladorFiltro_avalia(contexto, extendido, grupo->mascara, &grupo->valor, 1, grupo->desejados,
+                                 &idsFalsos, &taxaFalsos);
+}
+
+/**
+ * @brief  Função que une grupos, sempre o par que menos aumenta o custo, ate restarem "maximo" grupos
+ * @param  contexto: taxas conhecidas e peso dos identificadores sem taxa
+ * @param  extendido: tipo dos grupos
+ * @param  grupos: array de grupos (alterado)
+ * @param  quantidade: quantidade de grupos, atualizada ao final
+ * @param  maximo: quantidade maxima de grupos desejada
+ * @return void
+ */
+static void compiladorFiltro_agrupa(PTcontextoCompilador contexto, Tbool extendido, PTgrupoCompilador grupos,
+                                    Tuint16 *quantidade, Tuint16 maximo){
+  Tuint16 a, b, melhorA, melhorB;
+  TgrupoCompilador unido, melhorUnido;
+  float aumento, menorAumento;
+
+  while(*quantidade > maximo){
+    menorAumento = 0;
+    melhorA = 0;
+    melhorB = 1;
+
+    for(a=0; a<*quantidade; a++){
+      for(b=(a + 1); b<*quantidade; b++){
+        unido.mascara = (grupos[a].mascara & grupos[b].mascara & ~(grupos[a].valor ^ grupos[b].valor));
+        unido.valor = (grupos[a].valor & unido.mascara);
+        unido.desejados = (grupos[a].desejados + grupos[b].desejados);
+        unido.custo = compiladorFiltro_custoGrupo(contexto, extendido, &unido);
+        aumento = (unido.custo - grupos[a].custo - grupos[b].custo);
+
+        if(((a == 0) && (b == 1)) || (aumento < menorAumento)){
+          menorAumento = aumento;
+          melhorA = a;
+          melhorB = b;
+          melhorUnido = unido;
+        }
+      }
+    }
+
+    // O grupo unido fica no lugar de A e o ultimo grupo vai para o lugar de B
+    grupos[melhorA] = melhorUnido;
+    grupos[melhorB] = grupos[*quantidade - 1];
+    (*quantidade) --;
+  }
+}
+
+/**
+ * @brief  Função que monta a programação de uma mascara a partir de alguns grupos
+ * @param  contexto: taxas conhecidas e peso dos identificadores sem taxa
+ * @param  extendido: tipo dos grupos
+ * @param  grupos: array de grupos
+ * @param  indices: indices dos grupos atendidos pela mascara
+ * @param  quantidade: quantidade de indices
+ * @param  resultado: recebe a programação e o custo
+ * @return void
+ */
+static void compiladorFiltro_montaMascara(PTcontextoCompilador contexto, Tbool extendido, PTgrupoCompilador grupos,
+                                          const Tuint8 *indices, Tuint8 quantidade, PTresultadoMascara resultado){
+  Tuint8 i;
+
+  resultado->extendido = extendido;
+  resultado->mascara = MASCARA_TIPO(extendido);
+  resultado->desejados = 0;
+  resultado->quantidadeFiltros = quantidade;
+
+  // A mascara é comum: so compara os bits em que todos os grupos concordam internamente
+  for(i=0; i<quantidade; i++){
+    resultado->mascara &= grupos[indices[i]].mascara;
+    resultado->desejados += grupos[indices[i]].desejados;
+  }
+  for(i=0; i<quantidade; i++){
+    resultado->filtro[i] = (grupos[indices[i]].valor & resultado->mascara);
+  }
+
+  resultado->custo = compiladorFiltro_avalia(contexto, extendido, resultado->mascara, resultado->filtro, quantidade,
+                                             resultado->desejados, &resultado->idsFalsos, &resultado->taxaFalsos);
+}
+
+/**
+ * @brief  Função que calcula a programação de uma mascara para todos os grupos de um tipo
+ * @param  contexto: taxas conhecidas e peso dos identificadores sem taxa
+ * @param  extendido: tipo dos grupos
+ * @param  grupos: array de grupos (alterado)
+ * @param  quantidade: quantidade de grupos
+ * @param  filtros: quantidade de filtros da mascara
+ * @param  resultado: recebe a programação e o custo
+ * @return void
+ */
+static void compiladorFiltro_compilaMascara(PTcontextoCompilador contexto, Tbool extendido, PTgrupoCompilador grupos,
+                                            Tuint16 quantidade, Tuint8 filtros, PTresultadoMascara resultado){
+  Tuint8 indices[QUANTIDADE_FILTROS_MASCARA_1];
+  Tuint8 i;
+
+  compiladorFiltro_agrupa(contexto, extendido, grupos, &quantidade, filtros);
+  for(i=0; i<quantidade; i++){
+    indices[i] = i;
+  }
+  compiladorFiltro_montaMascara(contexto, extendido, grupos, indices, (Tuint8)quantidade, resultado);
+}
+
+/**
+ * @brief  Função que calcula a programação das duas mascaras para grupos de um unico tipo:
+ *         agrupa em ate 6 grupos e testa todas as divisões entre a mascara 0 (2) e a mascara 1 (4)
+ * @param  contexto: taxas conhecidas e peso dos identificadores sem taxa
+ * @param  extendido: tipo dos grupos
+ * @param  grupos: array de grupos (alterado)
+ * @param  quantidade: quantidade de grupos
+ * @param  resultado: recebe a programação das duas mascaras
+ * @return void
+ */
+static void compiladorFiltro_compilaTipoUnico(PTcontextoCompilador contexto, Tbool extendido, PTgrupoCompilador grupos,
+                                              Tuint16 quantidade, PTresultadoMascara resultado){
+  Tuint8 indices0[QUANTIDADE_FILTROS_MASCARA_0];
+  Tuint8 indices1[QUANTIDADE_FILTROS_MASCARA_1];
+  Tuint8 i, j, k, n0, n1;
+  TresultadoMascara tentativa[MAXIMA_QUANTIDADE_MASCARAS];
+  Tbool primeira = VERDADEIRO;
+
+  compiladorFiltro_agrupa(contexto, extendido, grupos, &quantidade, MAXIMA_QUANTIDADE_FILTROS);
+
+  // Mascara 0 recebe o grupo i e, se precisar, o grupo j (j == i significa so um grupo)
+  for(i=0; i<quantidade; i++){
+    for(j=i; j<quantidade; j++){
+      n0 = 0;
+      indices0[n0++] = i;
+      if(j != i){
+        indices0[n0++] = j;
+      }
+      n1 = 0;
+      for(k=0; k<quantidade; k++){
+        if((k != i) && (k != j)){
+          indices1[n1++] = k;
+        }
+      }
+      if(n1 > QUANTIDADE_FILTROS_MASCARA_1){
+        continue;
+      }
+
+      compiladorFiltro_montaMascara(contexto, extendido, grupos, indices0, n0, &tentativa[0]);
+      if(n1 > 0){
+        compiladorFiltro_montaMascara(contexto, extendido, grupos, indices1, n1, &tentativa[1]);
+      }else{
+        // Sem grupos para a mascara 1: repete a mascara 0, nao aceita nada a mais
+        tentativa[1] = tentativa[0];
+        tentativa[1].desejados = 0;
+        tentativa[1].idsFalsos = 0;
+        tentativa[1].taxaFalsos = 0;
+        tentativa[1].custo = 0;
+      }
+
+      if(primeira || ((tentativa[0].custo + tentativa[1].custo) < (resultado[0].custo + resultado[1].custo))){
+        resultado[0] = tentativa[0];
+        resultado[1] = tentativa[1];
+        primeira = FALSO;
+      }
+    }
+  }
+}
+
+/**
+ * @brief  Função que insere um padrao na lista de grupos, descartando padroes cobertos por outros
+ * @param  grupos: array de grupos
+ * @param  quantidade: quantidade de grupos, atualizada ao final
+ * @param  valor: valor do padrao
+ * @param  mascara: mascara do padrao
+ * @return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO se nao houver espaço ou SUCESSO
+ */
+static Terro compiladorFiltro_insereGrupo(PTgrupoCompilador grupos, Tuint16 *quantidade, Tuint32 valor, Tuint32 mascara){
+  Tuint16 i = 0;
+
+  while(i < *quantidade){
+    // Ja coberto por um grupo existente
+    if(((valor & grupos[i].mascara) == grupos[i].valor) && ((mascara & grupos[i].mascara) == grupos[i].mascara)){
+      return SUCESSO;
+    }
+    // Cobre um grupo existente, que é removido
+    if(((grupos[i].valor & mascara) == valor) && ((grupos[i].mascara & mascara) == mascara)){
+      grupos[i] = grupos[*quantidade - 1];
+      (*quantidade) --;
+      continue;
+    }
+    i++;
+  }
+
+  if(*quantidade >= MAXIMA_QUANTIDADE_GRUPOS_COMPILADOR){
+    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+  }
+  grupos[*quantidade].valor = valor;
+  grupos[*quantidade].mascara = mascara;
+  (*quantidade) ++;
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que le a lista de taxas do barramento. Formato: ID=taxa separados por ';'
+ *         (ex: 7E0=10;18DAF110=2.5), taxa em quadros/s
+ * @param  lista: texto com a lista
+ * @param  taxas: array que recebera as taxas
+ * @param  quantidade: recebe a quantidade de taxas lidas
+ * @return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO ou SUCESSO
+ */
+static Terro compiladorFiltro_leTaxas(const char *lista, PTtaxaCompilador taxas, Tuint16 *quantidade){
+  Terro erro;
+  Tuint32 i = 0;
+  Tuint32 valor, mascara;
+  Tbool extendido;
+  char *fim;
+
+  *quantidade = 0;
+  if(!FILTRO_SOFTWARE_CONFIGURADO(lista)){
+    return SUCESSO;
+  }
+
+  while(lista[i] != '\0'){
+    erro = filtroSoftware_leIdentificador(lista, &i, &valor, &mascara, &extendido);
+    if((erro != SUCESSO) || (mascara != MASCARA_TIPO(extendido)) || (lista[i] != SEPARADOR_TAXA_IDENTIFICADOR)){
+      return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+    }
+    if(*quantidade >= MAXIMA_QUANTIDADE_TAXAS_COMPILADOR){
+      return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+    }
+    taxas[*quantidade].id = valor;
+    taxas[*quantidade].extendido = extendido;
+    taxas[*quantidade].desejado = FALSO;
+    taxas[*quantidade].taxa = strtof(&lista[i + 1], &fim);
+    if((fim == &lista[i + 1]) || (taxas[*quantidade].taxa < 0.0f)){
+      return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+    }
+    (*quantidade) ++;
+
+    i = (Tuint32)(fim - lista);
+    while(lista[i] == ' '){
+      i++;
+    }
+    if(lista[i] == SEPARADOR_LISTA_IDS){
+      i++;
+    }else if(lista[i] != '\0'){
+      return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+    }
+  }
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que verifica se a programação aceita um identificador, como o MCP2515: algum filtro
+ *         de uma mascara do mesmo tipo concorda com o identificador nos bits da mascara
+ * @param  programacao: programação calculada
+ * @param  id: identificador
+ * @param  extendido: tipo do quadro
+ * @return VERDADEIRO se o quadro passa pelo hardware
+ */
+static Tbool compiladorFiltro_aceita(PTprogramacaoFiltro programacao, Tuint32 id, Tbool extendido){
+  Tuint8 f, m;
+
+  for(f=0; f<MAXIMA_QUANTIDADE_FILTROS; f++){
+    m = ((f < QUANTIDADE_FILTROS_MASCARA_0) ? 0 : 1);
+    if((programacao->extendido[m] == extendido) &&
+       ((id & programacao->mascara[m]) == (programacao->filtro[f] & programacao->mascara[m]))){
+      return VERDADEIRO;
+    }
+  }
+  return FALSO;
+}
+
+/**
+ * @brief  Função que conta os identificadores de um tipo aceitos pela programação. Os filtros distintos
+ *         de uma mascara aceitam conjuntos disjuntos; se as duas mascaras forem do mesmo tipo, a
+ *         intersecção entre elas é descontada
+ * @param  programacao: programação calculada
+ * @param  extendido: tipo do quadro
+ * @return quantidade de identificadores aceitos
+ */
+static float compiladorFiltro_contaAceitos(PTprogramacaoFiltro programacao, Tbool extendido){
+  Tuint32 valores[MAXIMA_QUANTIDADE_MASCARAS][QUANTIDADE_FILTROS_MASCARA_1];
+  Tuint8 quantidade[MAXIMA_QUANTIDADE_MASCARAS] = {0, 0};
+  Tuint32 valor, comum;
+  Tuint8 f, m, i, j;
+  Tbool repetido;
+  float aceitos = 0;
+
+  for(f=0; f<MAXIMA_QUANTIDADE_FILTROS; f++){
+    m = ((f < QUANTIDADE_FILTROS_MASCARA_0) ? 0 : 1);
+    if(programacao->extendido[m] != extendido){
+      continue;
+    }
+    valor = (programacao->filtro[f] & programacao->mascara[m]);
+    repetido = FALSO;
+    for(i=0; i<quantidade[m]; i++){
+      if(valores[m][i] == valor){
+        repetido = VERDADEIRO;
+        break;
+      }
+    }
+    if(!repetido){
+      valores[m][quantidade[m]++] = valor;
+    }
+  }
+
+  for(m=0; m<MAXIMA_QUANTIDADE_MASCARAS; m++){
+    aceitos += ((float)quantidade[m] * ldexpf(1.0f, (BITS_TIPO(extendido) - __builtin_popcount(programacao->mascara[m] & MASCARA_TIPO(extendido)))));
+  }
+  comum = (programacao->mascara[0] & programacao->mascara[1]);
+  for(i=0; i<quantidade[0]; i++){
+    for(j=0; j<quantidade[1]; j++){
+      if((valores[0][i] & comum) == (valores[1][j] & comum)){
+        aceitos -= ldexpf(1.0f, (BITS_TIPO(extendido) - __builtin_popcount((programacao->mascara[0] | programacao->mascara[1]) & MASCARA_TIPO(extendido))));
+      }
+    }
+  }
+  return aceitos;
+}
+
+/**
+ * @brief  Função que conta os identificadores padrao desejados, sem contar duas vezes os cobertos
+ *         por mais de um padrao da lista (ex: 7X0 e 70X)
+ * @param  grupos: grupos lidos da lista
+ * @param  quantidade: quantidade de grupos
+ * @return quantidade de identificadores desejados
+ */
+static Tuint32 compiladorFiltro_contaDesejadosPadrao(PTgrupoCompilador grupos, Tuint16 quantidade){
+  Tuint32 id, desejados = 0;
+  Tuint16 g;
+
+  for(id=0; id<=MASCARA_ID_PADRAO; id++){
+    for(g=0; g<quantidade; g++){
+      if((id & grupos[g].mascara) == grupos[g].valor){
+        desejados ++;
+        break;
+      }
+    }
+  }
+  return desejados;
+}
+
+/**
+ * @brief  Função que calcula a programação das mascaras e filtros do MCP2515 que aceita todos os
+ *         identificadores da lista com o menor trafego indesejado estimado
+ * @param  listaIds: lista de identificadores desejados (formato do filtro de software)
+ * @param  listaTaxas: lista opcional de taxas dos identificadores do barramento (ID=taxa;...)
+ * @param  programacao: recebe a programação calculada (valida = FALSO se a lista estiver vazia)
+ * @return ERRO_ALOCACAO_MEMORIA, ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO ou SUCESSO
+ */
+Terro compiladorFiltro_compila(const char *listaIds, const char *listaTaxas, PTprogramacaoFiltro programacao){
+  Terro erro = SUCESSO;
+  Tuint32 i = 0;
+  Tuint16 g, t;
+  Tuint32 valor, mascara;
+  Tbool extendido;
+  PTgrupoCompilador padrao = NULL;
+  PTgrupoCompilador extendidos = NULL;
+  PTgrupoCompilador copia = NULL;
+  Tuint16 quantidadePadrao = 0;
+  Tuint16 quantidadeExtendido = 0;
+  TcontextoCompilador contexto;
+  TresultadoMascara resultado[MAXIMA_QUANTIDADE_MASCARAS];
+  TresultadoMascara alternativa[MAXIMA_QUANTIDADE_MASCARAS];
+  float taxaDesejada = 0;
+  Tuint32 desejados;
+  float aceitos;
+
+  (void)memset(programacao, 0x00, sizeof(TprogramacaoFiltro));
+  (void)memset(&contexto, 0x00, sizeof(TcontextoCompilador));
+
+  if(!FILTRO_SOFTWARE_CONFIGURADO(listaIds)){
+    return SUCESSO;
+  }
+
+  padrao = (PTgrupoCompilador)malloc(sizeof(TgrupoCompilador) * MAXIMA_QUANTIDADE_GRUPOS_COMPILADOR);
+  extendidos = (PTgrupoCompilador)malloc(sizeof(TgrupoCompilador) * MAXIMA_QUANTIDADE_GRUPOS_COMPILADOR);
+  copia = (PTgrupoCompilador)malloc(sizeof(TgrupoCompilador) * MAXIMA_QUANTIDADE_GRUPOS_COMPILADOR);
+  contexto.taxas = (PTtaxaCompilador)malloc(sizeof(TtaxaCompilador) * MAXIMA_QUANTIDADE_TAXAS_COMPILADOR);
+  if((padrao == NULL) || (extendidos == NULL) || (copia == NULL) || (contexto.taxas == NULL)){
+    erro = ERRO_ALOCACAO_MEMORIA;
+    goto finaliza;
+  }
+
+  // Le os identificadores desejados, cada um vira um grupo
+  while(listaIds[i] != '\0'){
+    erro = filtroSoftware_leIdentificador(listaIds, &i, &valor, &mascara, &extendido);
+    if(listaIds[i] == SEPARADOR_LISTA_IDS){
+      i++;
+    }else if(listaIds[i] != '\0'){
+      erro = ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+      goto finaliza;
+    }
+    if(erro == ERRO_LISTA_VAZIA){
+      erro = SUCESSO;
+      continue;
+    }
+    if(erro != SUCESSO){
+      goto finaliza;
+    }
+    erro = (extendido) ? compiladorFiltro_insereGrupo(extendidos, &quantidadeExtendido, valor, mascara) :
+                         compiladorFiltro_insereGrupo(padrao, &quantidadePadrao, valor, mascara);
+    if(erro != SUCESSO){
+      goto finaliza;
+    }
+  }
+  if((quantidadePadrao + quantidadeExtendido) == 0){
+    goto finaliza;
+  }
+  // Os grupos sao alterados pela busca, os desejados sao contados antes
+  desejados = (compiladorFiltro_contaDesejadosPadrao(padrao, quantidadePadrao) + quantidadeExtendido);
+
+  // Le as taxas e marca quais identificadores sao desejados
+  erro = compiladorFiltro_leTaxas(listaTaxas, contexto.taxas, &contexto.quantidadeTaxas);
+  if(erro != SUCESSO){
+    goto finaliza;
+  }
+  contexto.pesoSemTaxa = (contexto.quantidadeTaxas > 0) ? PESO_ID_SEM_TAXA_COM_PERFIL : PESO_ID_SEM_TAXA;
+  for(t=0; t<contexto.quantidadeTaxas; t++){
+    PTgrupoCompilador grupos = (contexto.taxas[t].extendido) ? extendidos : padrao;
+    Tuint16 quantidade = (contexto.taxas[t].extendido) ? quantidadeExtendido : quantidadePadrao;
+
+    for(g=0; g<quantidade; g++){
+      if((contexto.taxas[t].id & grupos[g].mascara) == grupos[g].valor){
+        contexto.taxas[t].desejado = VERDADEIRO;
+        taxaDesejada += contexto.taxas[t].taxa;
+        break;
+      }
+    }
+  }
+
+  // Cada grupo inicial cobre 2^(bits livres) identificadores desejados
+  for(g=0; g<quantidadePadrao; g++){
+    padrao[g].desejados = (1UL << (BITS_ID_PADRAO - __builtin_popcount(padrao[g].mascara)));
+    padrao[g].custo = compiladorFiltro_custoGrupo(&contexto, FALSO, &padrao[g]);
+  }
+  for(g=0; g<quantidadeExtendido; g++){
+    extendidos[g].desejados = 1;
+    extendidos[g].custo = 0;
+  }
+
+  if(quantidadeExtendido == 0){
+    compiladorFiltro_compilaTipoUnico(&contexto, FALSO, padrao, quantidadePadrao, resultado);
+  }
+  else if(quantidadePadrao == 0){
+    compiladorFiltro_compilaTipoUnico(&contexto, VERDADEIRO, extendidos, quantidadeExtendido, resultado);
+  }
+  else{
+    // Um tipo por mascara: testa padrao na mascara 0 e extendido na 1, e o contrario
+    (void)memcpy(copia, padrao, (sizeof(TgrupoCompilador) * quantidadePadrao));
+    compiladorFiltro_compilaMascara(&contexto, FALSO, copia, quantidadePadrao, QUANTIDADE_FILTROS_MASCARA_0, &resultado[0]);
+    (void)memcpy(copia, extendidos, (sizeof(TgrupoCompilador) * quantidadeExtendido));
+    compiladorFiltro_compilaMascara(&contexto, VERDADEIRO, copia, quantidadeExtendido, QUANTIDADE_FILTROS_MASCARA_1, &resultado[1]);
+
+    compiladorFiltro_compilaMascara(&contexto, VERDADEIRO, extendidos, quantidadeExtendido, QUANTIDADE_FILTROS_MASCARA_0, &alternativa[0]);
+    compiladorFiltro_compilaMascara(&contexto, FALSO, padrao, quantidadePadrao, QUANTIDADE_FILTROS_MASCARA_1, &alternativa[1]);
+
+    if((alternativa[0].custo + alternativa[1].custo) < (resultado[0].custo + resultado[1].custo)){
+      resultado[0] = alternativa[0];
+      resultado[1] = alternativa[1];
+    }
+  }
+
+  // Monta a programação, os filtros nao usados repetem um filtro da mesma mascara
+  for(g=0; g<MAXIMA_QUANTIDADE_MASCARAS; g++){
+    programacao->mascara[g] = resultado[g].mascara;
+    programacao->extendido[g] = resultado[g].extendido;
+  }
+  for(g=0; g<QUANTIDADE_FILTROS_MASCARA_0; g++){
+    programacao->filtro[g] = resultado[0].filtro[g % resultado[0].quantidadeFiltros];
+  }
+  for(g=0; g<QUANTIDADE_FILTROS_MASCARA_1; g++){
+    programacao->filtro[QUANTIDADE_FILTROS_MASCARA_0 + g] = resultado[1].filtro[g % resultado[1].quantidadeFiltros];
+  }
+
+  // Estimativas da programação final. O custo da busca soma as mascaras separadas, mas com as duas
+  // no mesmo tipo os conjuntos se sobrepõem: os aceitos sao contados pela união das duas mascaras.
+  // Com taxas a razao é sobre o trafego, sem taxas é sobre a quantidade de identificadores
+  aceitos = compiladorFiltro_contaAceitos(programacao, FALSO);
+  if(programacao->extendido[0] || programacao->extendido[1]){
+    aceitos += compiladorFiltro_contaAceitos(programacao, VERDADEIRO);
+  }
+  programacao->idsFalsosAceitos = (aceitos - (float)desejados);
+  programacao->taxaFalsosAceitos = 0;
+  for(t=0; t<contexto.quantidadeTaxas; t++){
+    if(!contexto.taxas[t].desejado && compiladorFiltro_aceita(programacao, contexto.taxas[t].id, contexto.taxas[t].extendido)){
+      programacao->taxaFalsosAceitos += contexto.taxas[t].taxa;
+    }
+  }
+  if((contexto.quantidadeTaxas > 0) && ((programacao->taxaFalsosAceitos + taxaDesejada) > 0.0f)){
+    programacao->razaoFalsosAceitos = (programacao->taxaFalsosAceitos / (programacao->taxaFalsosAceitos + taxaDesejada));
+  }else{
+    programacao->razaoFalsosAceitos = (programacao->idsFalsosAceitos / (programacao->idsFalsosAceitos + (float)desejados));
+  }
+  programacao->valida = VERDADEIRO;
+
+finaliza:
+  free(padrao);
+  free(extendidos);
+  free(copia);
+  free(contexto.taxas);
+  return erro;
+}
@@ -0,0 +1,25 @@
+/**
+ * @file    compilador_filtro.h
+ * @brief   Esse arquivo contem o prototipo das funções do compilador de filtros, que calcula a
+ *          programação das mascaras e filtros do MCP2515 a partir de uma lista de identificadores
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef COMPILADOR_FILTRO_H_INCLUDED
+#define COMPILADOR_FILTRO_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Submódulos do sistema
+#include "tipos.h"
+#include "erros.h"
+#include "filtro_software.h"
+
+/// Funções exportadas
+Terro compiladorFiltro_compila(const char *listaIds, const char *listaTaxas, PTprogramacaoFiltro programacao);
+
+#endif // COMPILADOR_FILTRO_H_INCLUDED
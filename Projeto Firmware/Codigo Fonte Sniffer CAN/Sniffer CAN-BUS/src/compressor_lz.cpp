@@ -0,0 +1,217 @@
+/**
+ * @file    compressor_lz.cpp
+ * @brief   Esse arquivo contem o compressor LZ dos blocos colunares. A busca usa uma tabela hash de
+ *          TAMANHO_TABELA_COMPRESSOR_LZ posições com a ultima ocorrencia de cada sequencia de 4 bytes,
+ *          sem cadeia, o que mantem a memória e o tempo por byte constantes
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "compressor_lz.h"
+
+// Definições importantes (restrições do formato de bloco do LZ4)
+#define TAMANHO_MINIMO_COPIA        4
+#define LITERAIS_FINAIS             5     // a ultima copia termina 5 bytes antes do fim
+#define MARGEM_ULTIMA_COPIA         12    // a ultima copia começa 12 bytes antes do fim
+#define DISTANCIA_MAXIMA_COPIA      0xFFFF
+#define COMPRIMENTO_TOKEN           15
+
+/**
+ * @brief  Função que le 4 bytes sem exigir alinhamento
+ * @param  origem: bytes
+ * @return valor lido
+ */
+static inline uint32_t compressorLZ_le32(const uint8_t *origem){
+  return ((uint32_t)origem[0] | ((uint32_t)origem[1] << 8) | ((uint32_t)origem[2] << 16) | ((uint32_t)origem[3] << 24));
+}
+
+/**
+ * @brief  Função que calcula a posição da sequencia na tabela (hash multiplicativo)
+ * @param  valor: 4 bytes da sequencia
+ * @return posição na tabela
+ */
+static inline uint32_t compressorLZ_hash(uint32_t valor){
+  return ((valor * 2654435761U) >> (32 - BITS_TABELA_COMPRESSOR_LZ));
+}
+
+/**
+ * @brief  Função que escreve o restante de um comprimento maior que o campo do token
+ * @param  destino: recebe os bytes
+ * @param  resto: comprimento menos COMPRIMENTO_TOKEN
+ * @return posição seguinte em destino
+ */
+static uint8_t *compressorLZ_escreveComprimento(uint8_t *destino, uint32_t resto){
+  while(resto >= 255){
+    *destino++ = 255;
+    resto -= 255;
+  }
+  *destino++ = (uint8_t)resto;
+  return destino;
+}
+
+/**
+ * @brief  Função que escreve uma sequencia: token, literais e, se houver, a copia
+ * @param  destino: recebe a sequencia
+ * @param  literais: inicio dos literais
+ * @param  quantidadeLiterais: quantidade de literais
+ * @param  distancia: distancia da copia (0 = sequencia final, somente literais)
+ * @param  comprimento: comprimento da copia
+ * @return posição seguinte em destino
+ */
+static uint8_t *compressorLZ_escreveSequencia(uint8_t *destino, const uint8_t *literais, uint32_t quantidadeLiterais,
+                                              uint32_t distancia, uint32_t comprimento){
+  uint8_t *token = destino++;
+
+  *token = (uint8_t)(((quantidadeLiterais < COMPRIMENTO_TOKEN) ? quantidadeLiterais : COMPRIMENTO_TOKEN) << 4);
+  if(quantidadeLiterais >= COMPRIMENTO_TOKEN){
+    destino = compressorLZ_escreveComprimento(destino, (quantidadeLiterais - COMPRIMENTO_TOKEN));
+  }
+  (void)memcpy(destino, literais, quantidadeLiterais);
+  destino += quantidadeLiterais;
+
+  if(distancia == 0){
+    return destino;
+  }
+
+  *destino++ = (uint8_t)(distancia);
+  *destino++ = (uint8_t)(distancia >> 8);
+  comprimento -= TAMANHO_MINIMO_COPIA;
+  *token |= (uint8_t)((comprimento < COMPRIMENTO_TOKEN) ? comprimento : COMPRIMENTO_TOKEN);
+  if(comprimento >= COMPRIMENTO_TOKEN){
+    destino = compressorLZ_escreveComprimento(destino, (comprimento - COMPRIMENTO_TOKEN));
+  }
+
+  return destino;
+}
+
+/**
+ * @brief  Função que comprime um bloco
+ * @param  origem: bytes que serão comprimidos
+ * @param  tamanho: quantidade de bytes
+ * @param  destino: recebe ate TAMANHO_MAXIMO_COMPRESSOR_LZ(tamanho) bytes
+ * @param  tabela: TAMANHO_TABELA_COMPRESSOR_LZ posições de trabalho
+ * @return quantidade de bytes escritos em destino
+ */
+uint32_t compressorLZ_comprime(const uint8_t *origem, uint32_t tamanho, uint8_t *destino, uint32_t *tabela){
+  uint8_t *saida = destino;
+  uint32_t ancora = 0;
+  uint32_t posicao = 0;
+  uint32_t valor;
+  uint32_t indice;
+  uint32_t candidato;
+  uint32_t comprimento;
+  uint32_t comprimentoMaximo;
+
+  // Blocos menores que a margem sao somente literais
+  if(tamanho > MARGEM_ULTIMA_COPIA){
+
+    // Posições guardadas somadas de 1, 0 indica posição vazia
+    (void)memset(tabela, 0x00, (sizeof(uint32_t) * TAMANHO_TABELA_COMPRESSOR_LZ));
+
+    while(posicao < (tamanho - MARGEM_ULTIMA_COPIA)){
+      valor = compressorLZ_le32(&origem[posicao]);
+      indice = compressorLZ_hash(valor);
+      candidato = tabela[indice];
+      tabela[indice] = (posicao + 1);
+
+      if((candidato == 0) || ((posicao - (candidato - 1)) > DISTANCIA_MAXIMA_COPIA) ||
+         (compressorLZ_le32(&origem[candidato - 1]) != valor)){
+        posicao ++;
+        continue;
+      }
+      candidato --;
+
+      // Estende a copia ate o limite dos literais finais
+      comprimento = TAMANHO_MINIMO_COPIA;
+      comprimentoMaximo = ((tamanho - LITERAIS_FINAIS) - posicao);
+      while((comprimento < comprimentoMaximo) && (origem[candidato + comprimento] == origem[posicao + comprimento])){
+        comprimento ++;
+      }
+
+      saida = compressorLZ_escreveSequencia(saida, &origem[ancora], (posicao - ancora), (posicao - candidato), comprimento);
+      posicao += comprimento;
+      ancora = posicao;
+    }
+  }
+
+  saida = compressorLZ_escreveSequencia(saida, &origem[ancora], (tamanho - ancora), 0, 0);
+
+  return (uint32_t)(saida - destino);
+}
+
+/**
+ * @brief  Função que descomprime um bloco
+ * @param  origem: bloco comprimido
+ * @param  tamanho: bytes do bloco comprimido
+ * @param  destino: recebe os bytes descomprimidos
+ * @param  capacidade: bytes disponiveis em destino
+ * @return quantidade de bytes descomprimidos, -1 se o bloco for invalido
+ */
+int32_t compressorLZ_descomprime(const uint8_t *origem, uint32_t tamanho, uint8_t *destino, uint32_t capacidade){
+  uint32_t entrada = 0;
+  uint32_t saida = 0;
+  uint32_t quantidade;
+  uint32_t distancia;
+  uint8_t token;
+  uint8_t byte;
+
+  while(entrada < tamanho){
+    token = origem[entrada++];
+
+    // Literais
+    quantidade = (token >> 4);
+    if(quantidade == COMPRIMENTO_TOKEN){
+      do{
+        if(entrada >= tamanho){
+          return -1;
+        }
+        byte = origem[entrada++];
+        quantidade += byte;
+      }while(byte == 255);
+    }
+    if((quantidade > (tamanho - entrada)) || (quantidade > (capacidade - saida))){
+      return -1;
+    }
+    (void)memcpy(&destino[saida], &origem[entrada], quantidade);
+    entrada += quantidade;
+    saida += quantidade;
+
+    // A sequencia final tem somente literais
+    if(entrada == tamanho){
+      break;
+    }
+
+    // Copia
+    if((tamanho - entrada) < 2){
+      return -1;
+    }
+    distancia = ((uint32_t)origem[entrada] | ((uint32_t)origem[entrada + 1] << 8));
+    entrada += 2;
+    if((distancia == 0) || (distancia > saida)){
+      return -1;
+    }
+    quantidade = (token & COMPRIMENTO_TOKEN);
+    if(quantidade == COMPRIMENTO_TOKEN){
+      do{
+        if(entrada >= tamanho){
+          return -1;
+        }
+        byte = origem[entrada++];
+        quantidade += byte;
+      }while(byte == 255);
+    }
+    quantidade += TAMANHO_MINIMO_COPIA;
+    if(quantidade > (capacidade - saida)){
+      return -1;
+    }
+    // Byte a byte: a copia pode sobrepor o proprio destino (sequencias repetidas)
+    while(quantidade > 0){
+      destino[saida] = destino[saida - distancia];
+      saida ++;
+      quantidade --;
+    }
+  }
+
+  return (int32_t)saida;
+}
@@ -0,0 +1,26 @@
+/**
+ * @file    compressor_lz.h
+ * @brief   Esse arquivo contem o prototipo das funções do compressor LZ dos blocos colunares.
+ *          A saida segue o formato de bloco do LZ4 (sequencias de literais e copias com distancia
+ *          de ate 64 KiB).
+ *          Nao depende do Arduino, é compilado tambem pelo decodificador (ferramentas/)
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef COMPRESSOR_LZ_H_INCLUDED
+#define COMPRESSOR_LZ_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdint.h>
+#include <string.h>
+
+/// Definições importantes
+#define BITS_TABELA_COMPRESSOR_LZ           10
+#define TAMANHO_TABELA_COMPRESSOR_LZ        (1 << BITS_TABELA_COMPRESSOR_LZ)  // 4 KiB de memória
+#define TAMANHO_MAXIMO_COMPRESSOR_LZ(tamanho) ((tamanho) + ((tamanho) / 255) + 16)
+
+/// Funções exportadas
+uint32_t compressorLZ_comprime(const uint8_t *origem, uint32_t tamanho, uint8_t *destino, uint32_t *tabela);
+int32_t compressorLZ_descomprime(const uint8_t *origem, uint32_t tamanho, uint8_t *destino, uint32_t capacidade);
+
+#endif // COMPRESSOR_LZ_H_INCLUDED
@@ -0,0 +1,310 @@
+/**
+ * @file    enviador_servidor.cpp
+ * @brief   Esse arquivo contem as funções do estagio de envio ao servidor. O consumidor formata cada
+ *          bloco direto no buffer aberto e o entrega se a tarefa de envio estiver livre. Com a tarefa
+ *          atrasada os blocos seguintes se juntam no mesmo buffer e saem em uma so requisição, e sem
+ *          buffer livre o bloco nao vai ao servidor. O consumidor nunca espera pela rede
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "esp_timer.h"
+#include "enviador_servidor.h"
+
+// Definições importantes
+#define TENTATIVAS_ENVIO_SERVIDOR       2
+#define TEMPO_ESPERA_ENVIADOR           10    // ms, espera na finalização
+#define TEMPO_MAXIMO_FINALIZA_ENVIADOR  5000  // ms, espera pelo envio dos buffers na finalização
+
+// Referencia para a tarefa
+TaskHandle_t enviaServidor;
+
+/**
+ * @brief  Função que inicializa o enviador, alocando os buffers e as filas de indices. Se faltar
+ *         memoria, o que ja foi alocado é liberado
+ * @param  enviador: enviador que será inicializado
+ * @param  tamanhoBuffer: bytes de cada buffer, ao menos um bloco maximo formatado
+ * @param  wifi: configuração do wifi para reconexão
+ * @param  url: endereço do servidor
+ * @param  binario: define o tipo do conteudo (application/octet-stream ou text/plain)
+ * @return ERRO_ALOCACAO_MEMORIA ou SUCESSO
+ */
+Terro enviadorServidor_inicializa(PTenviadorServidor enviador, Tuint32 tamanhoBuffer, TwifiConfig wifi,
+                                  char *url, Tbool binario){
+  Tuint8 i;
+
+  (void)memset(enviador, 0x00, sizeof(TenviadorServidor));
+  enviador->atual = BUFFER_ENVIO_NENHUM;
+  enviador->tamanhoBuffer = tamanhoBuffer;
+  enviador->wifi = wifi;
+  enviador->url = url;
+  enviador->binario = binario;
+  enviador->ativo = VERDADEIRO;
+
+  // Uma posição a mais para o pedido de finalização (BUFFER_ENVIO_NENHUM)
+  enviador->cheios = xQueueCreate(QUANTIDADE_BUFFERS_ENVIO + 1, sizeof(Tuint8));
+  enviador->livres = xQueueCreate(QUANTIDADE_BUFFERS_ENVIO + 1, sizeof(Tuint8));
+  if((enviador->cheios == NULL) || (enviador->livres == NULL)){
+    enviadorServidor_libera(enviador);
+    return ERRO_ALOCACAO_MEMORIA;
+  }
+
+  for(i=0; i<QUANTIDADE_BUFFERS_ENVIO; i++){
+    enviador->buffer[i].dados = (Tuint8 *)malloc(tamanhoBuffer);
+    if(enviador->buffer[i].dados == NULL){
+      enviadorServidor_libera(enviador);
+      return ERRO_ALOCACAO_MEMORIA;
+    }
+    (void)xQueueSend(enviador->livres, &i, 0);
+  }
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que devolve a memoria do enviador. Usada somente antes da tarefa de envio começar
+ * @param  enviador: enviador do servidor
+ * @return void
+ */
+void enviadorServidor_libera(PTenviadorServidor enviador){
+  Tuint8 i;
+
+  for(i=0; i<QUANTIDADE_BUFFERS_ENVIO; i++){
+    free(enviador->buffer[i].dados);
+    enviador->buffer[i].dados = NULL;
+  }
+  if(enviador->cheios != NULL){
+    vQueueDelete(enviador->cheios);
+    enviador->cheios = NULL;
+  }
+  if(enviador->livres != NULL){
+    vQueueDelete(enviador->livres);
+    enviador->livres = NULL;
+  }
+  enviador->ativo = FALSO;
+}
+
+/**
+ * @brief  Função que informa se o enviador ainda envia ao servidor. Depois que o wifi é perdido os
+ *         blocos deixam de ser formatados para o servidor
+ * @param  enviador: enviador do servidor
+ * @return VERDADEIRO ou FALSO
+ */
+Tbool enviadorServidor_ativo(PTenviadorServidor enviador){
+  return __atomic_load_n(&(enviador->ativo), __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief  Função que entrega o buffer atual à tarefa de envio. A fila de cheios tem uma posição para
+ *         cada buffer, entao a entrega nunca espera
+ * @param  enviador: enviador do servidor
+ * @return void
+ */
+static void enviadorServidor_entregaBuffer(PTenviadorServidor enviador){
+  if(enviador->atual == BUFFER_ENVIO_NENHUM){
+    return;
+  }
+  if(enviador->buffer[enviador->atual].tamanho == 0){
+    (void)xQueueSend(enviador->livres, &enviador->atual, portMAX_DELAY);
+  }else{
+    (void)xQueueSend(enviador->cheios, &enviador->atual, portMAX_DELAY);
+  }
+  enviador->atual = BUFFER_ENVIO_NENHUM;
+}
+
+/**
+ * @brief  Função que obtem o espaço para um bloco formatado no buffer aberto. Se o bloco nao couber,
+ *         o buffer aberto é entregue e outro é tomado dos livres sem esperar
+ * @param  enviador: enviador do servidor
+ * @param  tamanho: maior quantidade de bytes do bloco formatado
+ * @param  inicio: recebe VERDADEIRO se o bloco for o primeiro do buffer
+ * @return ponteiro para o espaço ou NULL se todos os buffers estiverem ocupados (bloco descartado)
+ */
+Tuint8 *enviadorServidor_reserva(PTenviadorServidor enviador, Tuint32 tamanho, Tbool *inicio){
+  PTbufferEnvio buffer;
+  Tuint8 indice;
+
+  if((!enviadorServidor_ativo(enviador)) || (tamanho > enviador->tamanhoBuffer)){
+    enviador->descartados ++;
+    return NULL;
+  }
+
+  if((enviador->atual != BUFFER_ENVIO_NENHUM) &&
+     (tamanho > (enviador->tamanhoBuffer - enviador->buffer[enviador->atual].tamanho))){
+    enviadorServidor_entregaBuffer(enviador);
+  }
+
+  if(enviador->atual == BUFFER_ENVIO_NENHUM){
+    // Rede mais lenta que o barramento: o bloco fica somente no cartao
+    if(xQueueReceive(enviador->livres, &indice, 0) != pdTRUE){
+      enviador->descartados ++;
+      return NULL;
+    }
+    enviador->buffer[indice].tamanho = 0;
+    enviador->buffer[indice].blocos = 0;
+    enviador->atual = indice;
+  }
+  buffer = &enviador->buffer[enviador->atual];
+
+  *inicio = (buffer->tamanho == 0);
+  return &buffer->dados[buffer->tamanho];
+}
+
+/**
+ * @brief  Função que confirma os bytes do bloco formatado no espaço obtido com enviadorServidor_reserva
+ * @param  enviador: enviador do servidor
+ * @param  tamanho: quantidade de bytes do bloco formatado
+ * @param  fechamento: instante do fechamento do bloco (esp_timer, us)
+ * @return void
+ */
+void enviadorServidor_confirma(PTenviadorServidor enviador, Tuint32 tamanho, Tuint64 fechamento){
+  PTbufferEnvio buffer = &enviador->buffer[enviador->atual];
+
+  if(buffer->blocos == 0){
+    buffer->inicio = fechamento;
+  }
+  buffer->tamanho += tamanho;
+  buffer->blocos ++;
+}
+
+/**
+ * @brief  Função que entrega o buffer aberto se a tarefa de envio estiver livre. Com a tarefa ocupada
+ *         o buffer continua aberto e recebe os proximos blocos
+ * @param  enviador: enviador do servidor
+ * @return void
+ */
+void enviadorServidor_verificaEntrega(PTenviadorServidor enviador){
+  if((enviador->atual == BUFFER_ENVIO_NENHUM) || (enviador->buffer[enviador->atual].tamanho == 0)){
+    return;
+  }
+  if((!__atomic_load_n(&(enviador->ocupado), __ATOMIC_ACQUIRE)) && (uxQueueMessagesWaiting(enviador->cheios) == 0)){
+    enviadorServidor_entregaBuffer(enviador);
+  }
+}
+
+/**
+ * @brief  Função que será executada em um loop infinito dentro de um processo. Envia ao servidor os
+ *         buffers entregues pelo consumidor, com uma requisição por buffer, todas pela mesma conexão
+ * @param  enviador: Ponteiro para o enviador do servidor
+ * @return void
+ */
+void enviadorServidor_tarefa(void *parametro){
+  PTenviadorServidor enviador = (PTenviadorServidor)parametro;
+  PTbufferEnvio buffer;
+  Terro erro;
+  Tuint8 indice;
+  Tuint8 tentativas;
+  Tuint32 atraso;
+  Tuint32 espera;
+
+  // Abre a sessão com o servidor, mantida ate a finalização. Sem resposta agora, as requisições
+  // tentam de novo com espera crescente; somente um endereço invalido desativa o envio
+  erro = sniferCanServidor_conecta(enviador->url);
+  if(erro == ERRO_INICIALIZACAO_SERVIDOR){
+    __atomic_store_n(&(enviador->ativo), FALSO, __ATOMIC_RELEASE);
+  }
+
+  for(;;){
+
+    (void)xQueueReceive(enviador->cheios, &indice, portMAX_DELAY);
+
+    // Pedido de finalização: todos os buffers anteriores ja foram enviados
+    if(indice == BUFFER_ENVIO_NENHUM){
+      sniferCanServidor_desconecta();
+      (void)xQueueSend(enviador->livres, &indice, portMAX_DELAY);
+      vTaskDelete(NULL);
+      return;
+    }
+
+    __atomic_store_n(&(enviador->ocupado), VERDADEIRO, __ATOMIC_RELEASE);
+    buffer = &enviador->buffer[indice];
+
+    if(enviadorServidor_ativo(enviador)){
+      tentativas = 0;
+      do{
+        // Depois de falhas seguidas a reconexão espera; enquanto isso os blocos se juntam nos buffers
+        espera = snifferCanServidor_tempoReconexao();
+        if(espera > 0){
+          vTaskDelay(pdMS_TO_TICKS(espera));
+        }
+        erro = snifferCanServidor_envia((const char *)buffer->dados, buffer->tamanho, enviador->binario,
+                                        enviador->wifi, enviador->url);
+        if(erro != SUCESSO){
+          PRINTF("ERRO NA TENTATIVA DE ENVIO AO SERVIDOR %d\r\n", tentativas);
+        }
+        tentativas ++;
+      }while((erro != SUCESSO) && (tentativas < TENTATIVAS_ENVIO_SERVIDOR));
+
+      if(erro != SUCESSO){
+        if(erro == ERRO_CONEXAO_WIFI){
+          __atomic_store_n(&(enviador->ativo), FALSO, __ATOMIC_RELEASE);
+        }
+        // Se ocorreu algum erro, então acender led do servidor
+        digitalWrite(LED_ERRO_SERVIDOR,HIGH);
+        PRINTLN("ERRO NO ENVIO DOS DADOS AO SERVIDOR!!!");
+        __atomic_fetch_add(&(enviador->falhas), 1, __ATOMIC_RELAXED);
+      }else{
+        atraso = (Tuint32)(((Tuint64)esp_timer_get_time() - buffer->inicio) / 1000);
+        __atomic_fetch_add(&(enviador->requisicoes), 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&(enviador->blocosEnviados), buffer->blocos, __ATOMIC_RELAXED);
+        if(atraso > __atomic_load_n(&(enviador->atrasoMaximo), __ATOMIC_RELAXED)){
+          __atomic_store_n(&(enviador->atrasoMaximo), atraso, __ATOMIC_RELAXED);
+        }
+      }
+    }
+
+    buffer->tamanho = 0;
+    buffer->blocos = 0;
+    __atomic_store_n(&(enviador->ocupado), FALSO, __ATOMIC_RELEASE);
+    (void)xQueueSend(enviador->livres, &indice, portMAX_DELAY);
+  }
+}
+
+/**
+ * @brief  Função que entrega o restante dos blocos e espera a tarefa de envio terminar os buffers e
+ *         desconectar do servidor. Chamada pelo consumidor antes de finalizar
+ * @param  enviador: enviador do servidor
+ * @return void
+ */
+void enviadorServidor_finaliza(PTenviadorServidor enviador){
+  Tuint8 finaliza = BUFFER_ENVIO_NENHUM;
+  Tempo inicio = millis();
+
+  enviadorServidor_entregaBuffer(enviador);
+  (void)xQueueSend(enviador->cheios, &finaliza, portMAX_DELAY);
+
+  // Todos os buffers e o pedido de finalização voltam para os livres
+  while((uxQueueMessagesWaiting(enviador->livres) < (QUANTIDADE_BUFFERS_ENVIO + 1)) &&
+        ((millis() - inicio) < TEMPO_MAXIMO_FINALIZA_ENVIADOR)){
+    vTaskDelay(pdMS_TO_TICKS(TEMPO_ESPERA_ENVIADOR));
+  }
+}
+
+/**
+ * @brief  Função que obtem as estatisticas do enviador desde a ultima leitura e reinicia a contagem
+ * @param  enviador: enviador do servidor
+ * @param  requisicoes: recebe a quantidade de requisições enviadas
+ * @param  blocos: recebe a quantidade de blocos enviados, maior que as requisições se houve atraso
+ * @param  descartados: recebe a quantidade de blocos que nao encontraram buffer livre
+ * @param  falhas: recebe a quantidade de requisições que falharam em todas as tentativas
+ * @param  atrasoMaximo: recebe o maior tempo entre o fechamento de um bloco e o fim do seu envio (ms)
+ * @param  pendentes: recebe a quantidade de buffers na fila ou em envio
+ * @param  conexoes: recebe a quantidade de conexões abertas com o servidor (handshakes)
+ * @return void
+ */
+void enviadorServidor_obtemEstatistica(PTenviadorServidor enviador, Tuint32 *requisicoes, Tuint32 *blocos,
+                                       Tuint32 *descartados, Tuint32 *falhas, Tuint32 *atrasoMaximo,
+                                       Tuint32 *pendentes, Tuint32 *conexoes){
+  *requisicoes = __atomic_exchange_n(&(enviador->requisicoes), 0, __ATOMIC_RELAXED);
+  *blocos = __atomic_exchange_n(&(enviador->blocosEnviados), 0, __ATOMIC_RELAXED);
+  *falhas = __atomic_exchange_n(&(enviador->falhas), 0, __ATOMIC_RELAXED);
+  *atrasoMaximo = __atomic_exchange_n(&(enviador->atrasoMaximo), 0, __ATOMIC_RELAXED);
+  *descartados = enviador->descartados;
+  enviador->descartados = 0;
+  *conexoes = snifferCanServidor_obtemConexoes();
+  *pendentes = (Tuint32)uxQueueMessagesWaiting(enviador->cheios);
+  if(__atomic_load_n(&(enviador->ocupado), __ATOMIC_ACQUIRE)){
+    (*pendentes) ++;
+  }
+}
@@ -0,0 +1,38 @@
+/**
+ * @file    enviador_servidor.h
+ * @brief   Esse arquivo contem o prototipo das funções do estagio de envio ao servidor. O consumidor
+ *          formata os blocos nos buffers do enviador enquanto uma tarefa dedicada faz as requisições
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef ENVIADOR_SERVIDOR_H_INCLUDED
+#define ENVIADOR_SERVIDOR_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Submódulos do sistema
+#include "tipos.h"
+#include "erros.h"
+#include "snifferCan_servidor.h"
+
+/// Funções exportadas
+Terro enviadorServidor_inicializa(PTenviadorServidor enviador, Tuint32 tamanhoBuffer, TwifiConfig wifi,
+                                  char *url, Tbool binario);
+void enviadorServidor_libera(PTenviadorServidor enviador);
+void enviadorServidor_tarefa(void *enviador);
+Tbool enviadorServidor_ativo(PTenviadorServidor enviador);
+Tuint8 *enviadorServidor_reserva(PTenviadorServidor enviador, Tuint32 tamanho, Tbool *inicio);
+void enviadorServidor_confirma(PTenviadorServidor enviador, Tuint32 tamanho, Tuint64 fechamento);
+void enviadorServidor_verificaEntrega(PTenviadorServidor enviador);
+void enviadorServidor_finaliza(PTenviadorServidor enviador);
+void enviadorServidor_obtemEstatistica(PTenviadorServidor enviador, Tuint32 *requisicoes, Tuint32 *blocos,
+                                       Tuint32 *descartados, Tuint32 *falhas, Tuint32 *atrasoMaximo,
+                                       Tuint32 *pendentes, Tuint32 *conexoes);
+
+// Referencia para a tarefa
+extern TaskHandle_t enviaServidor;
+
+#endif // ENVIADOR_SERVIDOR_H_INCLUDED
@@ -1,35 +1,37 @@
-/**
- * @file    erros.h
- * @brief   Esse arquivo contem as definições dos identificadores de erros do sistema
- * @author  Emanoel Gomes Santos
- * @date    Data de Criação: 30/03/2020
-**/
-#ifndef ERROS_H_INCLUDED
-#define ERROS_H_INCLUDED
-
-/// Definições dos tipos de erros
-#define SUCESSO                    0
-#define ERRO_GERAL                 1
-#define ERRO_ALOCACAO_MEMORIA      2
-#define ERRO_LISTA_VAZIA           3
-#define ERRO_CODIGO_NAO_ENCONTRADO 4
-#define ERRO_FILA_VAZIA            5
-#define ERRO_CONEXAO_WIFI          6
-#define ERRO_CRIACAO_SEMAFORO      7
-#define ERRO_ENVIO_DADOS_SERVIDOR  8
-#define ERRO_CARTAO_NAO_ENCONTRADO 9
-#define ERRO_ESCRITA_CARTAO        10
-#define ERRO_LEITURA_CARTAO        11
-#define ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO  12
-#define ERRO_LIMITE_EXCEDIDO_CARTAO_MEMORIA   13
-#define ERRO_AO_CRIAR_DIRETORIO_CARTAO        14
-#define ERRO_ABRIR_CARTAO_PARA_ESCRITA        15
-#define ERRO_ABRIR_CARTAO_PARA_LEITURA        16
-#define ERRO_REMOVER_ARQUIVO_CARTAO           17
-#define ERRO_INICIALIZACAO_CAN                18
-#define ERRO_FILA_MENSAGEM_DESALOCADA         19
-#define ERRO_INICIALIZACAO_SERVIDOR           20
-#define ERRO_TAXA_DESCONHECIDA                21
-#define ERRO_CONEXAO_SERVIDOR                 22
-
+/**
+ * @file    erros.h
+ * @brief   Esse arquivo contem as definições dos identificadores de erros do sistema
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 30/03/2020
+**/
+#ifndef ERROS_H_INCLUDED
+#define ERROS_H_INCLUDED
+
+/// Definições dos tipos de erros
+#define SUCESSO                    0
+#define ERRO_GERAL                 1
+#define ERRO_ALOCACAO_MEMORIA      2
+#define ERRO_LISTA_VAZIA           3
+#define ERRO_CODIGO_NAO_ENCONTRADO 4
+#define ERRO_FILA_VAZIA            5
+#define ERRO_CONEXAO_WIFI          6
+#define ERRO_CRIACAO_SEMAFORO      7
+#define ERRO_ENVIO_DADOS_SERVIDOR  8
+#define ERRO_CARTAO_NAO_ENCONTRADO 9
+#define ERRO_ESCRITA_CARTAO        10
+#define ERRO_LEITURA_CARTAO        11
+#define ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO  12
+#define ERRO_LIMITE_EXCEDIDO_CARTAO_MEMORIA   13
+#define ERRO_AO_CRIAR_DIRETORIO_CARTAO        14
+#define ERRO_ABRIR_CARTAO_PARA_ESCRITA        15
+#define ERRO_ABRIR_CARTAO_PARA_LEITURA        16
+#define ERRO_REMOVER_ARQUIVO_CARTAO           17
+#define ERRO_INICIALIZACAO_CAN                18
+#define ERRO_FILA_MENSAGEM_DESALOCADA         19
+#define ERRO_INICIALIZACAO_SERVIDOR           20
+#define ERRO_TAXA_DESCONHECIDA                21
+#define ERRO_CONEXAO_SERVIDOR                 22
+#define ERRO_FILA_CHEIA                       24
+#define ERRO_TEMPO_ESGOTADO                   25
+
 #endif // ERROS_H_INCLUDED
\ No newline at end of file
@@ -0,0 +1,349 @@
+/**
+ * @file    escritor_cartao.cpp
+ * @brief   Esse arquivo contem as funções do estagio de escrita no cartao. O consumidor copia o texto
+ *          formatado para um buffer e segue desenfileirando, enquanto a tarefa de escrita grava o
+ *          buffer anterior. Uma parada do cartao é absorvida pelos buffers e nao chega à fila de captura
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "escritor_cartao.h"
+
+// Definições importantes
+#define TEMPO_ESPERA_ESCRITOR           10    // ms, espera da tarefa de escrita por um buffer cheio
+#define TEMPO_MAXIMO_FINALIZA_ESCRITOR  5000  // ms, espera pela gravação dos buffers na finalização
+#define TENTATIVAS_ESCRITA_BUFFER       2
+
+// Referencia para a tarefa
+TaskHandle_t escreveCartao;
+
+/**
+ * @brief  Função que inicializa o escritor, alocando os buffers e as filas de indices
+ * @param  escritor: escritor que será inicializado
+ * @param  tempoMaximo: tempo maximo que um dado pode ficar no buffer (ms)
+ * @return ERRO_ALOCACAO_MEMORIA ou SUCESSO
+ */
+Terro escritorCartao_inicializa(PTescritorCartao escritor, Tuint32 tempoMaximo){
+  Tuint8 i;
+
+  (void)memset(escritor, 0x00, sizeof(TescritorCartao));
+  escritor->atual = BUFFER_ESCRITA_NENHUM;
+  escritor->tempoMaximo = tempoMaximo;
+  escritor->erro = SUCESSO;
+
+  // Uma posição a mais para o pedido de finalização (BUFFER_ESCRITA_NENHUM)
+  escritor->cheios = xQueueCreate(QUANTIDADE_BUFFERS_ESCRITA + 1, sizeof(Tuint8));
+  escritor->livres = xQueueCreate(QUANTIDADE_BUFFERS_ESCRITA + 1, sizeof(Tuint8));
+  if((escritor->cheios == NULL) || (escritor->livres == NULL)){
+    escritorCartao_libera(escritor);
+    return ERRO_ALOCACAO_MEMORIA;
+  }
+
+  for(i=0; i<QUANTIDADE_BUFFERS_ESCRITA; i++){
+    escritor->buffer[i].dados = (Tuint8 *)malloc(TAMANHO_BUFFER_ESCRITA);
+    escritor->buffer[i].indice = (Tuint8 *)malloc(TAMANHO_BUFFER_INDICE);
+    if((escritor->buffer[i].dados == NULL) || (escritor->buffer[i].indice == NULL)){
+      escritorCartao_libera(escritor);
+      return ERRO_ALOCACAO_MEMORIA;
+    }
+    (void)xQueueSend(escritor->livres, &i, 0);
+  }
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que devolve a memoria do escritor. Usada somente antes da tarefa de escrita começar
+ * @param  escritor: escritor do cartao
+ * @return void
+ */
+void escritorCartao_libera(PTescritorCartao escritor){
+  Tuint8 i;
+
+  for(i=0; i<QUANTIDADE_BUFFERS_ESCRITA; i++){
+    free(escritor->buffer[i].dados);
+    escritor->buffer[i].dados = NULL;
+    free(escritor->buffer[i].indice);
+    escritor->buffer[i].indice = NULL;
+  }
+  if(escritor->cheios != NULL){
+    vQueueDelete(escritor->cheios);
+    escritor->cheios = NULL;
+  }
+  if(escritor->livres != NULL){
+    vQueueDelete(escritor->livres);
+    escritor->livres = NULL;
+  }
+}
+
+/**
+ * @brief  Função que obtem um buffer livre para o consumidor. O limite do buffer é ajustado para
+ *         que, cheio, ele termine no fim de um setor do arquivo
+ * @param  escritor: escritor do cartao
+ * @return void
+ */
+static void escritorCartao_obtemBufferLivre(PTescritorCartao escritor){
+  Tuint8 indice;
+  PTbufferEscrita buffer;
+
+  if(xQueueReceive(escritor->livres, &indice, 0) != pdTRUE){
+    // Cartao mais lento que o barramento: espera a tarefa de escrita devolver um buffer
+    escritor->esperas ++;
+    (void)xQueueReceive(escritor->livres, &indice, portMAX_DELAY);
+  }
+
+  buffer = &escritor->buffer[indice];
+  buffer->tamanho = 0;
+  buffer->tamanhoIndice = 0;
+  buffer->limite = (TAMANHO_BUFFER_ESCRITA - escritor->desalinhamento);
+  (void)strcpy(buffer->caminho, escritor->caminho);
+  buffer->inicio = millis();
+
+  escritor->atual = indice;
+}
+
+/**
+ * @brief  Função que entrega o buffer atual à tarefa de escrita. Um buffer vazio volta para os livres,
+ *         um buffer somente com bytes do indice tambem é entregue
+ * @param  escritor: escritor do cartao
+ * @return void
+ */
+static void escritorCartao_entregaBuffer(PTescritorCartao escritor){
+  PTbufferEscrita buffer;
+
+  if(escritor->atual == BUFFER_ESCRITA_NENHUM){
+    return;
+  }
+  buffer = &escritor->buffer[escritor->atual];
+
+  if((buffer->tamanho == 0) && (buffer->tamanhoIndice == 0)){
+    (void)xQueueSend(escritor->livres, &escritor->atual, portMAX_DELAY);
+  }else{
+    escritor->desalinhamento = ((escritor->desalinhamento + buffer->tamanho) % TAMANHO_SETOR_CARTAO);
+    (void)xQueueSend(escritor->cheios, &escritor->atual, portMAX_DELAY);
+  }
+  escritor->atual = BUFFER_ESCRITA_NENHUM;
+}
+
+/**
+ * @brief  Função que copia o texto para os buffers de escrita. Os buffers cheios sao entregues à
+ *         tarefa de escrita, o consumidor so espera se todos estiverem sendo gravados.
+ *         As novas tentativas de gravação sao feitas pela tarefa de escrita: um buffer que falhou em
+ *         todas (TENTATIVAS_ESCRITA_BUFFER) foi perdido e o erro volta em toda chamada seguinte,
+ *         para o consumidor terminar a captura. Repetir a chamada nao grava o buffer perdido
+ * @param  escritor: escritor do cartao
+ * @param  texto: texto que será escrito
+ * @param  tamanho: quantidade de bytes do texto
+ * @param  caminho: arquivo de registro de destino
+ * @return erro da tarefa de escrita em um buffer anterior, ERRO_ABRIR_CARTAO_PARA_ESCRITA ou SUCESSO
+ */
+Terro escritorCartao_escreve(PTescritorCartao escritor, const char *texto, Tuint32 tamanho, const char *caminho){
+  Terro erro = __atomic_load_n(&(escritor->erro), __ATOMIC_ACQUIRE);
+  PTbufferEscrita buffer;
+  Tuint32 copia;
+
+  // A gravação de um buffer anterior falhou em todas as tentativas, a captura deve terminar
+  if(erro != SUCESSO){
+    return erro;
+  }
+  if(strlen(caminho) >= TAMANHO_MAXIMO_NOME_ARQUIVO){
+    return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
+  }
+
+  // Troca de arquivo: o que ficou do arquivo anterior é entregue e o novo começa no inicio de um setor
+  if(strcmp(escritor->caminho, caminho) != 0){
+    escritorCartao_entregaBuffer(escritor);
+    (void)strcpy(escritor->caminho, caminho);
+    escritor->desalinhamento = 0;
+  }
+
+  while(tamanho > 0){
+
+    if(escritor->atual == BUFFER_ESCRITA_NENHUM){
+      escritorCartao_obtemBufferLivre(escritor);
+    }
+    buffer = &escritor->buffer[escritor->atual];
+
+    copia = (buffer->limite - buffer->tamanho);
+    if(copia > tamanho){
+      copia = tamanho;
+    }
+    (void)memcpy(&buffer->dados[buffer->tamanho], texto, copia);
+    buffer->tamanho += copia;
+    texto += copia;
+    tamanho -= copia;
+
+    if(buffer->tamanho == buffer->limite){
+      escritorCartao_entregaBuffer(escritor);
+    }
+  }
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que copia bytes do indice do arquivo atual para a area de indice dos buffers. A
+ *         tarefa de escrita grava o indice depois dos dados do mesmo buffer, assim o indice nunca
+ *         referencia dados que ainda nao estao no cartao
+ * @param  escritor: escritor do cartao
+ * @param  dados: bytes do indice
+ * @param  tamanho: quantidade de bytes
+ * @return erro da tarefa de escrita em um buffer anterior ou SUCESSO
+ */
+Terro escritorCartao_escreveIndice(PTescritorCartao escritor, const Tuint8 *dados, Tuint32 tamanho){
+  Terro erro = __atomic_load_n(&(escritor->erro), __ATOMIC_ACQUIRE);
+  PTbufferEscrita buffer;
+  Tuint32 copia;
+
+  if(erro != SUCESSO){
+    return erro;
+  }
+
+  while(tamanho > 0){
+
+    if(escritor->atual == BUFFER_ESCRITA_NENHUM){
+      escritorCartao_obtemBufferLivre(escritor);
+    }
+    buffer = &escritor->buffer[escritor->atual];
+
+    copia = (TAMANHO_BUFFER_INDICE - buffer->tamanhoIndice);
+    if(copia > tamanho){
+      copia = tamanho;
+    }
+    (void)memcpy(&buffer->indice[buffer->tamanhoIndice], dados, copia);
+    buffer->tamanhoIndice += copia;
+    dados += copia;
+    tamanho -= copia;
+
+    if(buffer->tamanhoIndice == TAMANHO_BUFFER_INDICE){
+      escritorCartao_entregaBuffer(escritor);
+    }
+  }
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que entrega o buffer atual se o dado mais antigo dele passou do tempo maximo, para
+ *         que o final do registro nao fique na memoria com o barramento parado
+ * @param  escritor: escritor do cartao
+ * @return void
+ */
+void escritorCartao_verificaTempo(PTescritorCartao escritor){
+  PTbufferEscrita buffer;
+
+  if(escritor->atual == BUFFER_ESCRITA_NENHUM){
+    return;
+  }
+  buffer = &escritor->buffer[escritor->atual];
+
+  if(((buffer->tamanho > 0) || (buffer->tamanhoIndice > 0)) && ((millis() - buffer->inicio) >= escritor->tempoMaximo)){
+    escritorCartao_entregaBuffer(escritor);
+  }
+}
+
+/**
+ * @brief  Função que será executada em um loop infinito dentro de um processo. Grava no cartao os
+ *         buffers entregues pelo consumidor e faz o flush por tempo do arquivo de registro
+ * @param  escritor: Ponteiro para o escritor do cartao
+ * @return void
+ */
+void escritorCartao_tarefa(void *parametro){
+  PTescritorCartao escritor = (PTescritorCartao)parametro;
+  PTbufferEscrita buffer;
+  Terro erro;
+  Tuint8 indice;
+  Tuint8 tentativas;
+  Tuint32 inicio;
+  Tuint32 latencia;
+
+  for(;;){
+
+    if(xQueueReceive(escritor->cheios, &indice, pdMS_TO_TICKS(TEMPO_ESPERA_ESCRITOR)) != pdTRUE){
+      gerenciamentoCartao_descarregaRegistro(FALSO);
+      continue;
+    }
+
+    // Pedido de finalização: todos os buffers anteriores ja foram gravados
+    if(indice == BUFFER_ESCRITA_NENHUM){
+      gerenciamentoCartao_fechaRegistro();
+      (void)xQueueSend(escritor->livres, &indice, portMAX_DELAY);
+      vTaskDelete(NULL);
+      return;
+    }
+
+    buffer = &escritor->buffer[indice];
+
+    inicio = micros();
+    tentativas = 0;
+    erro = SUCESSO;
+    if(buffer->tamanho > 0){
+      do{
+        erro = gerenciamentoCartao_escreveRegistro(buffer->dados, buffer->tamanho, buffer->caminho);
+        tentativas ++;
+      }while((erro != SUCESSO) && (tentativas < TENTATIVAS_ESCRITA_BUFFER));
+    }
+    // O indice é auxiliar: uma falha nele nao interrompe a captura, o leitor para no ultimo registro valido
+    if((erro == SUCESSO) && (buffer->tamanhoIndice > 0)){
+      (void)gerenciamentoCartao_escreveIndice(buffer->indice, buffer->tamanhoIndice, buffer->caminho);
+    }
+    latencia = (micros() - inicio);
+
+    if(erro != SUCESSO){
+      __atomic_store_n(&(escritor->erro), erro, __ATOMIC_RELEASE);
+    }else{
+      __atomic_fetch_add(&(escritor->buffersEscritos), 1, __ATOMIC_RELAXED);
+      if(latencia > __atomic_load_n(&(escritor->latenciaMaxima), __ATOMIC_RELAXED)){
+        __atomic_store_n(&(escritor->latenciaMaxima), latencia, __ATOMIC_RELAXED);
+      }
+    }
+
+    buffer->tamanho = 0;
+    buffer->tamanhoIndice = 0;
+    (void)xQueueSend(escritor->livres, &indice, portMAX_DELAY);
+  }
+}
+
+/**
+ * @brief  Função que entrega o restante dos dados e espera a tarefa de escrita gravar todos os
+ *         buffers e fechar o arquivo de registro. Chamada pelo consumidor antes de finalizar o cartao
+ * @param  escritor: escritor do cartao
+ * @return SUCESSO se a tarefa de escrita confirmou o fim ou ERRO_TEMPO_ESGOTADO, quando ela ainda
+ *         pode estar gravando e o cartao nao deve ser desmontado
+ */
+Terro escritorCartao_finaliza(PTescritorCartao escritor){
+  Tuint8 finaliza = BUFFER_ESCRITA_NENHUM;
+  Tempo inicio = millis();
+
+  escritorCartao_entregaBuffer(escritor);
+  (void)xQueueSend(escritor->cheios, &finaliza, portMAX_DELAY);
+
+  // Todos os buffers e o pedido de finalização voltam para os livres
+  while((uxQueueMessagesWaiting(escritor->livres) < (QUANTIDADE_BUFFERS_ESCRITA + 1)) &&
+        ((millis() - inicio) < TEMPO_MAXIMO_FINALIZA_ESCRITOR)){
+    vTaskDelay(pdMS_TO_TICKS(TEMPO_ESPERA_ESCRITOR));
+  }
+
+  // O pedido de finalização so volta depois do arquivo de registro ser fechado
+  if(uxQueueMessagesWaiting(escritor->livres) < (QUANTIDADE_BUFFERS_ESCRITA + 1)){
+    return ERRO_TEMPO_ESGOTADO;
+  }
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que obtem as estatisticas do escritor desde a ultima leitura e reinicia a contagem
+ * @param  escritor: escritor do cartao
+ * @param  buffersEscritos: recebe a quantidade de buffers gravados
+ * @param  latenciaMaxima: recebe o maior tempo de gravação de um buffer (us)
+ * @param  esperas: recebe quantas vezes o consumidor esperou por um buffer livre
+ * @return void
+ */
+void escritorCartao_obtemEstatistica(PTescritorCartao escritor, Tuint32 *buffersEscritos,
+                                     Tuint32 *latenciaMaxima, Tuint32 *esperas){
+  *buffersEscritos = __atomic_exchange_n(&(escritor->buffersEscritos), 0, __ATOMIC_RELAXED);
+  *latenciaMaxima = __atomic_exchange_n(&(escritor->latenciaMaxima), 0, __ATOMIC_RELAXED);
+  *esperas = escritor->esperas;
+  escritor->esperas = 0;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file    escritor_cartao.h
+ * @brief   Esse arquivo contem o prototipo das funções do estagio de escrita no cartao. O consumidor
+ *          preenche um buffer enquanto uma tarefa dedicada grava o outro no cartao micro SD
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef ESCRITOR_CARTAO_H_INCLUDED
+#define ESCRITOR_CARTAO_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Submódulos do sistema
+#include "tipos.h"
+#include "erros.h"
+#include "gerenciamento_cartao.h"
+
+/// Funções exportadas
+Terro escritorCartao_inicializa(PTescritorCartao escritor, Tuint32 tempoMaximo);
+void escritorCartao_libera(PTescritorCartao escritor);
+void escritorCartao_tarefa(void *escritor);
+Terro escritorCartao_escreve(PTescritorCartao escritor, const char *texto, Tuint32 tamanho, const char *caminho);
+Terro escritorCartao_escreveIndice(PTescritorCartao escritor, const Tuint8 *dados, Tuint32 tamanho);
+void escritorCartao_verificaTempo(PTescritorCartao escritor);
+Terro escritorCartao_finaliza(PTescritorCartao escritor);
+void escritorCartao_obtemEstatistica(PTescritorCartao escritor, Tuint32 *buffersEscritos,
+                                     Tuint32 *latenciaMaxima, Tuint32 *esperas);
+
+// Referencia para a tarefa
+extern TaskHandle_t escreveCartao;
+
+#endif // ESCRITOR_CARTAO_H_INCLUDED
@@ -0,0 +1,216 @@
+/**
+ * @file    estatistica_id.cpp
+ * @brief   Esse arquivo contem as funções da tabela de estatisticas por identificador: quantidade,
+ *          taxa, intervalos entre quadros e o ultimo conteudo de cada identificador do barramento.
+ *          A tarefa de captura é a unica escritora, as leituras usam a sequencia de cada posição
+ *          (seqlock) e repetem a copia se ela foi escrita no meio, sem nunca bloquear a captura
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "estatistica_id.h"
+
+// Definições importantes
+#define CONSTANTE_HASH_ESTATISTICA          2654435761U   // hash multiplicativo de Knuth
+#define POSICAO_TABELA_ESTATISTICA(chave)   (((Tuint32)(chave) * CONSTANTE_HASH_ESTATISTICA) >> (32 - BITS_TABELA_ESTATISTICA))
+#define MASCARA_TABELA_ESTATISTICA          (TAMANHO_TABELA_ESTATISTICA - 1)
+#define CHAVE_ESTATISTICA(mensagem)         ((mensagem).identificador & (MASCARA_ID_EXTENDIDO | FLAG_QUADRO_EXTENDIDO | FLAG_QUADRO_REMOTO))
+#define TENTATIVAS_LEITURA_ESTATISTICA      8
+#define SEQUENCIA_EM_ESCRITA(sequencia)     (((sequencia) & 1U) != 0)
+// Sem quadros por duas janelas a taxa é considerada zero
+#define IDENTIFICADOR_PARADO(e, agora)      (((agora) - (e)->ultimo) > (2 * JANELA_TAXA_ESTATISTICA))
+
+/**
+ * @brief  Função que inicializa a tabela de estatisticas
+ * @param  tabela: tabela que será inicializada
+ * @return ERRO_ALOCACAO_MEMORIA ou SUCESSO
+ */
+Terro estatisticaId_inicializa(PTtabelaEstatistica tabela){
+
+  (void)memset(tabela, 0x00, sizeof(TtabelaEstatistica));
+  tabela->entrada = (PTestatisticaId)calloc(TAMANHO_TABELA_ESTATISTICA, sizeof(TestatisticaId));
+  if(tabela->entrada == NULL){
+    return ERRO_ALOCACAO_MEMORIA;
+  }
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que libera a tabela de estatisticas
+ * @param  tabela: tabela que será finalizada
+ * @return void
+ */
+void estatisticaId_finaliza(PTtabelaEstatistica tabela){
+  free(tabela->entrada);
+  tabela->entrada = NULL;
+}
+
+/**
+ * @brief  Função que atualiza a estatistica do identificador da mensagem. Chamada somente pela 
+ *         tarefa de captura, logo apos o quadro receber o instante de chegada
+ * @param  tabela: tabela de estatisticas
+ * @param  mensagem: mensagem recebida
+ * @param  tempo: instante de chegada (esp_timer, us)
+ * @return void
+ */
+void estatisticaId_atualiza(PTtabelaEstatistica tabela, PTmensagemCAN mensagem, Tuint64 tempo){
+  Tuint32 chave = CHAVE_ESTATISTICA(*mensagem);
+  Tuint32 posicao = POSICAO_TABELA_ESTATISTICA(chave);
+  PTestatisticaId e;
+  Tuint32 sequencia;
+  Tuint32 intervalo;
+
+  if((tabela->entrada == NULL) || QUADRO_ERRO(*mensagem)){
+    return;
+  }
+
+  while(tabela->entrada[posicao].ocupada && (tabela->entrada[posicao].identificador != chave)){
+    posicao = ((posicao + 1) & MASCARA_TABELA_ESTATISTICA);
+  }
+  e = &tabela->entrada[posicao];
+
+  // Mantem a ocupação em no maximo 50% para que as sondagens continuem curtas
+  if((!e->ocupada) && (tabela->quantidade >= MAXIMA_QUANTIDADE_IDS_ESTATISTICA)){
+    tabela->quadrosForaTabela ++;
+    return;
+  }
+
+  // Inicio da escrita: sequencia impar
+  sequencia = e->sequencia;
+  __atomic_store_n(&e->sequencia, (sequencia + 1), __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  if(!e->ocupada){
+    e->identificador = chave;
+    e->intervaloMinimo = 0xFFFFFFFF;
+    e->inicioJanela = tempo;
+    e->ocupada = VERDADEIRO;
+    tabela->quantidade ++;
+  }else{
+    intervalo = (Tuint32)(((tempo - e->ultimo) > 0xFFFFFFFFULL) ? 0xFFFFFFFFULL : (tempo - e->ultimo));
+    e->somaIntervalos += intervalo;
+    if(intervalo < e->intervaloMinimo){
+      e->intervaloMinimo = intervalo;
+    }
+    if(intervalo > e->intervaloMaximo){
+      e->intervaloMaximo = intervalo;
+    }
+  }
+  e->quantidade ++;
+  e->quantidadeJanela ++;
+  if((tempo - e->inicioJanela) >= JANELA_TAXA_ESTATISTICA){
+    e->taxa = (Tuint32)(((Tuint64)e->quantidadeJanela * 1000000000ULL) / (tempo - e->inicioJanela));
+    e->quantidadeJanela = 0;
+    e->inicioJanela = tempo;
+  }
+  e->ultimo = tempo;
+  e->tamanho = mensagem->tamanho;
+  (void)memcpy(e->dados, mensagem->dados, TAMANHO_MAX_DADOS_QUADRO_CAN);
+
+  // Fim da escrita: sequencia par
+  __atomic_store_n(&e->sequencia, (sequencia + 2), __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief  Função que copia a estatistica de uma posição da tabela sem bloquear a captura
+ * @param  tabela: tabela de estatisticas
+ * @param  posicao: posição da tabela (0 a TAMANHO_TABELA_ESTATISTICA - 1)
+ * @param  copia: recebe a estatistica
+ * @return VERDADEIRO se a posição esta ocupada e a copia é consistente
+ */
+Tbool estatisticaId_le(PTtabelaEstatistica tabela, Tuint16 posicao, PTestatisticaId copia){
+  PTestatisticaId e;
+  Tuint32 inicio, fim;
+  Tuint8 tentativas;
+
+  if((tabela->entrada == NULL) || (posicao >= TAMANHO_TABELA_ESTATISTICA)){
+    return FALSO;
+  }
+  e = &tabela->entrada[posicao];
+
+  for(tentativas=0; tentativas<TENTATIVAS_LEITURA_ESTATISTICA; tentativas++){
+    inicio = __atomic_load_n(&e->sequencia, __ATOMIC_ACQUIRE);
+    if(SEQUENCIA_EM_ESCRITA(inicio)){
+      continue;
+    }
+    (void)memcpy(copia, e, sizeof(TestatisticaId));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    fim = __atomic_load_n(&e->sequencia, __ATOMIC_RELAXED);
+    if(inicio == fim){
+      return copia->ocupada;
+    }
+  }
+  // A captura escreveu em todas as tentativas, a posição fica de fora desta leitura
+  return FALSO;
+}
+
+/**
+ * @brief  Função que escreve a estatistica de um identificador em JSON compacto:
+ *         {"id":"7E8","x":0,"r":0,"n":1520,"hz":10.0,"min":99870,"max":100140,"med":100002,"dlc":8,"d":"0241..."}
+ *         x = extendido, r = remoto, intervalos em us, hz = taxa da ultima janela de 1 s
+ * @param  texto: ponteiro para a string que irá receber o JSON (TAMANHO_MAXIMO_JSON_ESTATISTICA)
+ * @param  estatistica: estatistica lida com estatisticaId_le
+ * @param  agora: instante atual (esp_timer, us), para zerar a taxa dos identificadores parados
+ * @return quantidade de caracteres escritos
+ */
+Tuint16 estatisticaId_formataJSON(char *texto, PTestatisticaId estatistica, Tuint64 agora){
+  int tamanho;
+  Tuint8 i;
+  Tuint32 taxa = (IDENTIFICADOR_PARADO(estatistica, agora)) ? 0 : estatistica->taxa;
+  Tuint32 media = (estatistica->quantidade > 1) ? 
+                  (Tuint32)(estatistica->somaIntervalos / (estatistica->quantidade - 1)) : 0;
+  Tuint32 minimo = (estatistica->quantidade > 1) ? estatistica->intervaloMinimo : 0;
+  Tbool extendido = ((estatistica->identificador & FLAG_QUADRO_EXTENDIDO) != 0);
+
+  tamanho = sprintf(texto, (extendido) ? "{\"id\":\"%08X\",\"x\":%u,\"r\":%u,\"n\":%u,\"hz\":%u.%u,"
+                                       : "{\"id\":\"%03X\",\"x\":%u,\"r\":%u,\"n\":%u,\"hz\":%u.%u,",
+    (estatistica->identificador & MASCARA_ID_EXTENDIDO), 
+    extendido,
+    ((estatistica->identificador & FLAG_QUADRO_REMOTO) != 0),
+    estatistica->quantidade, 
+    (taxa / 1000), ((taxa % 1000) / 100)
+  );
+  tamanho += sprintf(&texto[tamanho], "\"min\":%u,\"max\":%u,\"med\":%u,\"dlc\":%u,\"d\":\"",
+    minimo, estatistica->intervaloMaximo, media, estatistica->tamanho);
+
+  for(i=0; (i<estatistica->tamanho) && (i<TAMANHO_MAX_DADOS_QUADRO_CAN); i++){
+    tamanho += sprintf(&texto[tamanho], "%02X", estatistica->dados[i]);
+  }
+  tamanho += sprintf(&texto[tamanho], "\"}");
+
+  return (Tuint16)tamanho;
+}
+
+/**
+ * @brief  Função que escreve a tabela inteira em JSON, um identificador por vez, sem montar o texto 
+ *         completo na memória: {"t":<ms>,"fora":<quadros fora da tabela>,"ids":[{...},{...}]}
+ * @param  tabela: tabela de estatisticas
+ * @param  agora: instante atual (esp_timer, us)
+ * @param  escreve: função que recebe cada trecho do texto
+ * @return void
+ */
+void estatisticaId_escreveTabelaJSON(PTtabelaEstatistica tabela, Tuint64 agora, TescreveJSON escreve){
+  char texto[TAMANHO_MAXIMO_JSON_ESTATISTICA];
+  TestatisticaId copia;
+  Tuint16 posicao;
+  Tuint16 tamanho;
+  Tbool primeiro = VERDADEIRO;
+
+  tamanho = (Tuint16)sprintf(texto, "{\"t\":%llu,\"fora\":%u,\"ids\":[", 
+    (unsigned long long)(agora / 1000ULL), tabela->quadrosForaTabela);
+  escreve(texto, tamanho);
+
+  for(posicao=0; posicao<TAMANHO_TABELA_ESTATISTICA; posicao++){
+    if(!estatisticaId_le(tabela, posicao, &copia)){
+      continue;
+    }
+    if(!primeiro){
+      escreve(",", 1);
+    }
+    tamanho = estatisticaId_formataJSON(texto, &copia, agora);
+    escreve(texto, tamanho);
+    primeiro = FALSO;
+  }
+  escreve("]}", 2);
+}
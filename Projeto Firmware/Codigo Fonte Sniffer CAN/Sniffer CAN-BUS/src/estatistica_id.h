@@ -0,0 +1,34 @@
+/**
+ * @file    estatistica_id.h
+ * @brief   Esse arquivo contem o prototipo das funções da tabela de estatisticas por identificador,
+ *          atualizada pela tarefa de captura e lida sem bloqueá-la
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef ESTATISTICA_ID_H_INCLUDED
+#define ESTATISTICA_ID_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Submódulos do sistema
+#include "tipos.h"
+#include "erros.h"
+
+/// Tamanho maximo do texto JSON de um identificador (ver estatisticaId_formataJSON)
+#define TAMANHO_MAXIMO_JSON_ESTATISTICA   160
+
+/// Função que recebe cada trecho do JSON da tabela (monitor serial, servidor HTTP...)
+typedef void (*TescreveJSON)(const char *texto, Tuint16 tamanho);
+
+/// Funções exportadas
+Terro estatisticaId_inicializa(PTtabelaEstatistica tabela);
+void estatisticaId_finaliza(PTtabelaEstatistica tabela);
+void estatisticaId_atualiza(PTtabelaEstatistica tabela, PTmensagemCAN mensagem, Tuint64 tempo);
+Tbool estatisticaId_le(PTtabelaEstatistica tabela, Tuint16 posicao, PTestatisticaId copia);
+Tuint16 estatisticaId_formataJSON(char *texto, PTestatisticaId estatistica, Tuint64 agora);
+void estatisticaId_escreveTabelaJSON(PTtabelaEstatistica tabela, Tuint64 agora, TescreveJSON escreve);
+
+#endif // ESTATISTICA_ID_H_INCLUDED
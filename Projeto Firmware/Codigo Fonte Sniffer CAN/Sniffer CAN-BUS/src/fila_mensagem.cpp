@@ -1,190 +1,374 @@
-/**
- * @file    fila_mensagem.cpp
- * @brief   Esse arquivo contem a implementação das funções relativas a implementação da estrutura de dados fila
- * @author  Emanoel Gomes Santos
- * @date    Data de Criação: 30/03/2020
-**/
-
-/// Inclusções de bibliotecas importantes
-#include "fila_mensagem.h"
-
-// Criação do semaforo
-SemaphoreHandle_t mutex;
-SemaphoreHandle_t sistema;
-
-/**
- * @brief  Funçãoo que inicializa a fila , criando os ponteiros para o inicio e fim da fila
- *         Alem disso, cria-se o semaforo mutex para controle de região crítica
- * @param  fila: Ponteiro para fila que será criada
- * @param  tamanho: Tamanho da fila que deseja-se criar  
- * @return erro ou SUCESSO
- */
-Terro filaMensagem_inicializaFila(PTfilaMensagem fila, Tuint32 tamanho){
-  Tuint16 tentativas = 0;
-  
-  // Cria semaforo
-  do{    
-    mutex = xSemaphoreCreateMutex();
-    tentativas ++;
-  }while((mutex == NULL) && (tentativas < 100));
-  if(mutex == NULL){
-    return ERRO_CRIACAO_SEMAFORO;
-  }
-
-  do{    
-    sistema = xSemaphoreCreateMutex();
-    tentativas ++;
-  }while((sistema == NULL) && (tentativas < 100));
-  if(sistema == NULL){
-    return ERRO_CRIACAO_SEMAFORO;
-  }
-
-  
-  // Armazena o tamanho maximo da lista
-  fila->capacidadeMax = tamanho;
-  // Aloca a quantidade de dados maxima
-  fila->mensagem = (PTmensagemCAN)malloc(sizeof(TmensagemCAN) * fila->capacidadeMax); // 13*5
-  if(!(fila->mensagem)){
-    return ERRO_ALOCACAO_MEMORIA;
-  }
-  // Definições iniciais dos ponteiros e tamanho
-  fila->primeiro = 0;
-	fila->ultimo =  0;
-	fila->tamanhoAtual = 0; 
-
-  return SUCESSO;
-}
-
-/**
- * @brief  Funçãoo que finaliza a fila, apenas desaloca ponteiro da fila da memória
- * @param  fila: Ponteiro para fila que será destruída 
- * @return erro ou SUCESSO
- */
-void filaMensagem_finalizaFila(PTfilaMensagem fila){
-  xSemaphoreTake(mutex,portMAX_DELAY);
-  if(fila->mensagem != NULL){
-    fila->primeiro = 0;
-    fila->ultimo =  0;
-    fila->tamanhoAtual = 0;     
-    free((PTmensagemCAN)(fila->mensagem));
-  }  
-  xSemaphoreGive(mutex);
-}
-
-/**
- * @brief  Função verifica o tamanho da fila
- * @param  fila: Ponteiro para fila que sera criada
- * @return tamanho da fila
- */
-Tuint32 filaMensagem_tamanhoFila(PTfilaMensagem fila){
-  Tuint32 tamanho;
-
-  // Aguarda semaforo esta liberado para entao mecher na fila
-  xSemaphoreTake(mutex,portMAX_DELAY);
-  tamanho = fila->tamanhoAtual;
-  xSemaphoreGive(mutex);
-
-  return tamanho;
-}
-
-/**
- * @brief  Função que verifica se a fila esta vazia
- * @param  fila: Ponteiro para fila que sera criada
- * @return VERDADEIR ou FALSO
- */
-static Tbool verificaSeFilaEstaVazia(PTfilaMensagem fila){  
-  Tbool filaVazia;
-  
-  // Aguarda semaforo esta liberado para entao mecher na fila
-  xSemaphoreTake(mutex,portMAX_DELAY);  
-  filaVazia = (fila->tamanhoAtual == 0);
-  xSemaphoreGive(mutex);
-  
-  return filaVazia;
-}
-
-/**
- * @brief  Função que insere uma celula do tipo TmensagemCAN no fim da fila
- * @param  fila: Ponteiro para fila que sera atualizada
- * @param  mensagem: Dado do tipo TmensagemCAN que será armazenado
- * @return ERRO ou SUCESSO
- */
-Terro filaMensagem_enfileirar(PTfilaMensagem fila, TmensagemCAN mensagem){
-
-  // Aguarda semaforo esta liberado para entao mecher na fila
-  xSemaphoreTake(mutex,portMAX_DELAY);
-
-  if((fila->mensagem) == NULL){
-    return ERRO_FILA_MENSAGEM_DESALOCADA;
-  }
-  
-  // Armazena dado recebido na fila
-  fila->mensagem[fila->ultimo] = mensagem;  
- 
-  // Se o ultimo lugar livre for a capacidade, então deverá rodar a roleta
-  // exemplo: roleta tamanho 3 (0 a 2), se estiver na posição 2 devera ir para posição 0
-  if((fila->ultimo + 1) == fila->capacidadeMax){
-    fila->ultimo = 0;
-  }else{
-    // Incrementa ultimo que foi adicionado na fila
-    fila->ultimo++;
-  }   
-
-  // Atualiza tamanho da fila +1
-  fila->tamanhoAtual ++;
-  
-  // Verifica se esta na capacidade maxima, se estiver deverá incrementar o primeiro e o tamanho
-  // da fila recebera capacidade maxima
-  if(fila->tamanhoAtual == fila->capacidadeMax){
-    fila->primeiro ++;
-    fila->primeiro %= fila->capacidadeMax;
-    fila->tamanhoAtual = (fila->capacidadeMax-1);
-  }
-  
-  // Libera semaforo
-  xSemaphoreGive(mutex);
-
-  return SUCESSO;
-
-}
-
-/**
- * @brief  Função que insere uma celula do tipo TmensagemCAN no inicio da fila
- * @param  fila: Ponteiro para fila que sera atualizada
- * @param  mensagem: Ponteiro para receber o dado removido
- * @return ERRO ou SUCESSO
- */
-Terro filaMensagem_desenfileirar(PTfilaMensagem fila, PTmensagemCAN mensagem){
-  
-  // Verifica se há itens na fila
-  if(verificaSeFilaEstaVazia(fila)){
-    return ERRO_FILA_VAZIA;
-  }
-
-  // Aguarda semaforo esta liberado para entao mecher na fila
-  xSemaphoreTake(mutex,portMAX_DELAY);
-
-  if((fila->mensagem) == NULL){
-    return ERRO_FILA_MENSAGEM_DESALOCADA;
-  }
-  
-  // Retira dados da fila e armazena na estrutura can
-  (void)memcpy(mensagem, &fila->mensagem[fila->primeiro], sizeof(TmensagemCAN));
-
-  // incrementa posição do primeiro da fila
-  fila->primeiro ++;
-
-  // Verifica se ultrapassou os limites da fila
-  if(fila->primeiro == fila->capacidadeMax){
-    fila->primeiro = 0;
-  }
-  
-  // Atualiza tamanho atual da fila
-  fila->tamanhoAtual --;
-
-  // Libera semaforo
-  xSemaphoreGive(mutex);
-  
-  return SUCESSO;
-}
-
+/**
+ * @file    fila_mensagem.cpp
+ * @brief   Esse arquivo contem a implementação das funções relativas a implementação da estrutura de dados fila
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 30/03/2020
+**/
+
+/// Inclusções de bibliotecas importantes
+#include "fila_mensagem.h"
+
+/*
+  A fila possui um unico produtor (tarefa de captura, núcleo 0) e um unico consumidor 
+  (tarefa de envio, núcleo 1), por isso nao precisa de semaforo:
+  - "ultimo" so é escrito pelo produtor, publicado com release após a celula ser preenchida
+  - "primeiro" é avançado pelo consumidor com compare-and-swap após copiar a celula. Quando a fila 
+    esta cheia o produtor descarta a mensagem mais antiga avançando "primeiro" com o mesmo 
+    compare-and-swap; se isso acontecer durante uma copia, o CAS do consumidor falha e ele le de novo.
+*/
+#define CARREGA_ADQUIRE(variavel)          __atomic_load_n(&(variavel), __ATOMIC_ACQUIRE)
+#define ARMAZENA_LIBERA(variavel, valor)   __atomic_store_n(&(variavel), (valor), __ATOMIC_RELEASE)
+#define TROCA_SE_IGUAL(variavel, esperado, novo)  \
+  __atomic_compare_exchange_n(&(variavel), &(esperado), (novo), FALSO, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+
+// Criação do semaforo
+SemaphoreHandle_t sistema;
+
+/**
+ * @brief  Funçãoo que inicializa a fila , criando os ponteiros para o inicio e fim da fila
+ *         Alem disso, cria-se o semaforo do sistema
+ * @param  fila: Ponteiro para fila que será criada
+ * @param  tamanho: Tamanho da fila que deseja-se criar (potencia de 2)
+ * @return erro ou SUCESSO
+ */
+Terro filaMensagem_inicializaFila(PTfilaMensagem fila, Tuint32 tamanho){
+  Tuint16 tentativas = 0;
+
+  // O indice é convertido em posição por mascara, entao o tamanho deve ser potencia de 2
+  if((tamanho == 0) || ((tamanho & (tamanho - 1)) != 0)){
+    return ERRO_GERAL;
+  }
+
+  do{    
+    sistema = xSemaphoreCreateMutex();
+    tentativas ++;
+  }while((sistema == NULL) && (tentativas < 100));
+  if(sistema == NULL){
+    return ERRO_CRIACAO_SEMAFORO;
+  }
+
+  
+  // Armazena o tamanho maximo da lista
+  fila->capacidadeMax = tamanho;
+  fila->mascara = (tamanho - 1);
+  // Aloca a quantidade de dados maxima
+  fila->mensagem = (PTmensagemCAN)malloc(sizeof(TmensagemCAN) * fila->capacidadeMax);
+  if(!(fila->mensagem)){
+    return ERRO_ALOCACAO_MEMORIA;
+  }
+  // Definições iniciais dos indices
+  fila->primeiro = 0;
+  fila->ultimo =  0;
+  fila->emEstouro = FALSO;
+  fila->politica = eDescartaMaisAntiga;
+  fila->tempoBloqueio = 0;
+  (void)memset((void *)&(fila->estatistica), 0x00, sizeof(TestatisticaFila));
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que amplia a fila, trocando o array de mensagens por um maior. Deve ser chamada
+ *         antes do produtor começar a usar a fila, com ela vazia. Sem memoria a fila atual é mantida
+ * @param  fila: Ponteiro para fila que será ampliada
+ * @param  tamanho: Novo tamanho da fila (potencia de 2, maior que o atual)
+ * @return ERRO_GERAL, ERRO_ALOCACAO_MEMORIA ou SUCESSO
+ */
+Terro filaMensagem_ampliaFila(PTfilaMensagem fila, Tuint32 tamanho){
+  PTmensagemCAN mensagem;
+
+  if((tamanho <= fila->capacidadeMax) || ((tamanho & (tamanho - 1)) != 0) ||
+     (fila->mensagem == NULL) || (filaMensagem_tamanhoFila(fila) != 0)){
+    return ERRO_GERAL;
+  }
+
+  // O array novo é alocado antes de liberar o atual, entao so cresce com heap sobrando
+  mensagem = (PTmensagemCAN)malloc(sizeof(TmensagemCAN) * tamanho);
+  if(mensagem == NULL){
+    return ERRO_ALOCACAO_MEMORIA;
+  }
+  free(fila->mensagem);
+  fila->mensagem = mensagem;
+  fila->capacidadeMax = tamanho;
+  fila->mascara = (tamanho - 1);
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Funçãoo que finaliza a fila, apenas desaloca ponteiro da fila da memória.
+ *         Deve ser chamada pelo consumidor, depois do produtor ter parado de usar a fila
+ * @param  fila: Ponteiro para fila que será destruída 
+ * @return erro ou SUCESSO
+ */
+void filaMensagem_finalizaFila(PTfilaMensagem fila){
+  PTmensagemCAN mensagem = fila->mensagem;
+
+  if(mensagem != NULL){
+    fila->mensagem = NULL;
+    ARMAZENA_LIBERA(fila->primeiro, fila->ultimo);
+    free(mensagem);
+  }  
+}
+
+/**
+ * @brief  Função verifica o tamanho da fila
+ * @param  fila: Ponteiro para fila que sera criada
+ * @return tamanho da fila
+ */
+Tuint32 filaMensagem_tamanhoFila(PTfilaMensagem fila){
+  Tuint32 primeiro = CARREGA_ADQUIRE(fila->primeiro);
+  Tuint32 ultimo = CARREGA_ADQUIRE(fila->ultimo);
+
+  return (ultimo - primeiro);
+}
+
+/**
+ * @brief  Função que configura a politica adotada quando a fila estiver cheia
+ * @param  fila: Ponteiro para fila
+ * @param  politica: politica de estouro
+ * @param  tempoBloqueio: tempo maximo de espera por espaço em ms (somente eBloqueia)
+ * @return void
+ */
+void filaMensagem_configuraPolitica(PTfilaMensagem fila, TpoliticaEstouroFila politica, Tuint32 tempoBloqueio){
+  fila->politica = politica;
+  fila->tempoBloqueio = tempoBloqueio;
+}
+
+/**
+ * @brief  Função que trata a fila cheia de acordo com a politica configurada
+ * @param  fila: Ponteiro para fila
+ * @param  ultimo: indice ultimo do produtor
+ * @return SUCESSO se ha espaço para a nova mensagem ou ERRO_FILA_CHEIA se ela deve ser descartada
+ */
+static Terro filaMensagem_trataFilaCheia(PTfilaMensagem fila, Tuint32 ultimo){
+  Tuint32 primeiro = CARREGA_ADQUIRE(fila->primeiro);
+  Tempo inicio;
+
+  if((ultimo - primeiro) < fila->capacidadeMax){
+    fila->emEstouro = FALSO;
+    return SUCESSO;
+  }
+
+  // Conta somente a transição para cheia
+  if(!fila->emEstouro){
+    fila->emEstouro = VERDADEIRO;
+    fila->estatistica.eventosEstouro ++;
+  }
+
+  switch(fila->politica){
+    case eBloqueia:
+      inicio = millis();
+      while((millis() - inicio) < fila->tempoBloqueio){
+        vTaskDelay(1);
+        if((ultimo - CARREGA_ADQUIRE(fila->primeiro)) < fila->capacidadeMax){
+          return SUCESSO;
+        }
+      }
+      fila->estatistica.descartadas ++;
+      return ERRO_FILA_CHEIA;
+
+    case eDescartaMaisNova:
+      fila->estatistica.descartadas ++;
+      return ERRO_FILA_CHEIA;
+
+    case eDescartaMaisAntiga:
+    default:
+      // Avança o primeiro, descartando a mensagem mais antiga. Se o CAS falhar o 
+      // consumidor acabou de retirar uma mensagem, entao ja existe espaço
+      if(TROCA_SE_IGUAL(fila->primeiro, primeiro, (primeiro + 1))){
+        fila->estatistica.sobrescritas ++;
+      }
+      return SUCESSO;
+  }
+}
+
+/**
+ * @brief  Função que reserva a celula do fim da fila para o produtor escrever diretamente nela.
+ *         Se a fila estiver cheia, aplica a politica de estouro configurada
+ * @param  fila: Ponteiro para fila que sera atualizada
+ * @param  celula: recebe o ponteiro para celula reservada
+ * @return SUCESSO, ERRO_FILA_CHEIA (mensagem deve ser descartada) ou ERRO_FILA_MENSAGEM_DESALOCADA
+ */
+Terro filaMensagem_reservaCelula(PTfilaMensagem fila, PTmensagemCAN *celula){
+  Terro erro;
+  Tuint32 ultimo = fila->ultimo;
+
+  if((fila->mensagem) == NULL){
+    return ERRO_FILA_MENSAGEM_DESALOCADA;
+  }
+
+  erro = filaMensagem_trataFilaCheia(fila, ultimo);
+  if(erro != SUCESSO){
+    return erro;
+  }
+
+  *celula = &(fila->mensagem[ultimo & fila->mascara]);
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que publica para o consumidor a celula reservada em filaMensagem_reservaCelula
+ * @param  fila: Ponteiro para fila que sera atualizada
+ * @return void
+ */
+void filaMensagem_confirmaCelula(PTfilaMensagem fila){
+  Tuint32 ultimo = (fila->ultimo + 1);
+  Tuint32 ocupacao;
+
+  ARMAZENA_LIBERA(fila->ultimo, ultimo);
+
+  fila->estatistica.enfileiradas ++;
+  ocupacao = (ultimo - CARREGA_ADQUIRE(fila->primeiro));
+  if(ocupacao > fila->estatistica.marcaMaxima){
+    fila->estatistica.marcaMaxima = ocupacao;
+  }
+}
+
+/**
+ * @brief  Função que copia os contadores da fila
+ * @param  fila: Ponteiro para fila
+ * @param  estatistica: estrutura que recebera os contadores
+ * @return void
+ */
+void filaMensagem_obtemEstatistica(PTfilaMensagem fila, PTestatisticaFila estatistica){
+  estatistica->enfileiradas   = fila->estatistica.enfileiradas;
+  estatistica->sobrescritas   = fila->estatistica.sobrescritas;
+  estatistica->descartadas    = fila->estatistica.descartadas;
+  estatistica->marcaMaxima    = fila->estatistica.marcaMaxima;
+  estatistica->eventosEstouro = fila->estatistica.eventosEstouro;
+}
+
+/**
+ * @brief  Função que retorna o total de mensagens perdidas pela fila (sobrescritas + descartadas)
+ * @param  fila: Ponteiro para fila
+ * @return quantidade de mensagens perdidas desde a inicialização
+ */
+Tuint32 filaMensagem_quantidadePerdida(PTfilaMensagem fila){
+  return (fila->estatistica.sobrescritas + fila->estatistica.descartadas);
+}
+
+/**
+ * @brief  Função que insere uma celula do tipo TmensagemCAN no fim da fila
+ * @param  fila: Ponteiro para fila que sera atualizada
+ * @param  mensagem: Dado do tipo TmensagemCAN que será armazenado
+ * @return SUCESSO, ERRO_FILA_CHEIA (mensagem descartada pela politica) ou ERRO_FILA_MENSAGEM_DESALOCADA
+ */
+Terro filaMensagem_enfileirar(PTfilaMensagem fila, TmensagemCAN mensagem){
+  Terro erro;
+  PTmensagemCAN celula;
+
+  erro = filaMensagem_reservaCelula(fila, &celula);
+  if(erro != SUCESSO){
+    return erro;
+  }
+  
+  // Armazena dado recebido na fila e publica
+  *celula = mensagem;
+  filaMensagem_confirmaCelula(fila);
+
+  return SUCESSO;
+
+}
+
+/**
+ * @brief  Função que retira uma celula do tipo TmensagemCAN do inicio da fila
+ * @param  fila: Ponteiro para fila que sera atualizada
+ * @param  mensagem: Ponteiro para receber o dado removido
+ * @return ERRO ou SUCESSO
+ */
+Terro filaMensagem_desenfileirar(PTfilaMensagem fila, PTmensagemCAN mensagem){
+  Tuint32 primeiro;
+  Tuint32 ultimo;
+  PTmensagemCAN celulas;
+
+  do{
+    celulas = fila->mensagem;
+    if(celulas == NULL){
+      return ERRO_FILA_MENSAGEM_DESALOCADA;
+    }
+
+    primeiro = CARREGA_ADQUIRE(fila->primeiro);
+    ultimo = CARREGA_ADQUIRE(fila->ultimo);
+
+    // Verifica se há itens na fila
+    if(primeiro == ultimo){
+      return ERRO_FILA_VAZIA;
+    }
+  
+    // Retira dados da fila e armazena na estrutura can
+    (void)memcpy(mensagem, &celulas[primeiro & fila->mascara], sizeof(TmensagemCAN));
+
+    // Se o produtor sobrescreveu essa celula durante a copia, o CAS falha e a leitura é refeita
+  }while(!TROCA_SE_IGUAL(fila->primeiro, primeiro, (primeiro + 1)));
+  
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que calcula o lote contiguo disponivel a partir do primeiro da fila. 
+ *         O lote pode dar a volta no array, por isso é dividido em ate dois trechos
+ * @param  fila: Ponteiro para fila
+ * @param  celulas: array de mensagens da fila
+ * @param  maximo: quantidade maxima de mensagens do lote
+ * @param  lote: lote que recebera os trechos
+ * @return quantidade total de mensagens do lote
+ */
+static Tuint32 filaMensagem_calculaLote(PTfilaMensagem fila, PTmensagemCAN celulas, Tuint32 maximo, PTloteFila lote){
+  Tuint32 ultimo;
+  Tuint32 quantidade;
+  Tuint32 posicao;
+
+  lote->primeiro = CARREGA_ADQUIRE(fila->primeiro);
+  ultimo = CARREGA_ADQUIRE(fila->ultimo);
+
+  quantidade = (ultimo - lote->primeiro);
+  if(quantidade > maximo){
+    quantidade = maximo;
+  }
+
+  posicao = (lote->primeiro & fila->mascara);
+  lote->trecho[0] = &celulas[posicao];
+  lote->quantidade[0] = (((fila->capacidadeMax - posicao) < quantidade) ? (fila->capacidadeMax - posicao) : quantidade);
+  lote->trecho[1] = &celulas[0];
+  lote->quantidade[1] = (quantidade - lote->quantidade[0]);
+
+  return quantidade;
+}
+
+/**
+ * @brief  Função que retira ate "maximo" celulas do inicio da fila de uma vez. 
+ *         A copia é feita em no maximo dois memcpy e confirmada com um unico CAS
+ * @param  fila: Ponteiro para fila que sera atualizada
+ * @param  destino: array que recebera as mensagens
+ * @param  maximo: quantidade maxima de mensagens que cabem no destino
+ * @param  quantidade: quantidade de mensagens retiradas
+ * @return ERRO ou SUCESSO
+ */
+Terro filaMensagem_desenfileirarLote(PTfilaMensagem fila, PTmensagemCAN destino, 
+                                     Tuint32 maximo, Tuint32 *quantidade){
+  TloteFila lote;
+  PTmensagemCAN celulas;
+
+  *quantidade = 0;
+  do{
+    celulas = fila->mensagem;
+    if(celulas == NULL){
+      return ERRO_FILA_MENSAGEM_DESALOCADA;
+    }
+
+    *quantidade = filaMensagem_calculaLote(fila, celulas, maximo, &lote);
+    if(*quantidade == 0){
+      return ERRO_FILA_VAZIA;
+    }
+
+    (void)memcpy(destino, lote.trecho[0], (sizeof(TmensagemCAN) * lote.quantidade[0]));
+    if(lote.quantidade[1] > 0){
+      (void)memcpy(&destino[lote.quantidade[0]], lote.trecho[1], (sizeof(TmensagemCAN) * lote.quantidade[1]));
+    }
+
+    // Se o produtor sobrescreveu alguma celula durante a copia, o CAS falha e o lote é relido
+  }while(!TROCA_SE_IGUAL(fila->primeiro, lote.primeiro, (lote.primeiro + *quantidade)));
+
+  return SUCESSO;
+}
@@ -1,37 +1,52 @@
-/**
- * @file    fila_mensagem.h
- * @brief   Esse arquivo contem o prototipo das funções relativas a implementação da estrutura de dados fila
- * @author  Emanoel Gomes Santos
- * @date    Data de Criação: 30/03/2020
-**/
-#ifndef FILA_MENSAGEM_H_INCLUDED
-#define FILA_MENSAGEM_H_INCLUDED
-
-/// Inclusões importantes
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-
-// Inclusões de bibliotecas do módulo
-#include "tipos.h"
-#include "erros.h"
-
-/**
- * Prototipos de funções exportadas
- */
-/// Função que inializa uma fila
-Terro filaMensagem_inicializaFila(PTfilaMensagem fila, Tuint32 tamanho);
-/// Função que retorna o tamanho da fila
-Tuint32 filaMensagem_tamanhoFila(PTfilaMensagem fila);
-/// Função que enfilera uma celula na lista
-Terro filaMensagem_enfileirar(PTfilaMensagem fila, TmensagemCAN mensagem);
-/// Função que desinfilera uma celula da fila
-Terro filaMensagem_desenfileirar(PTfilaMensagem fila, PTmensagemCAN mensagem);
-/// Função que finaliza a fila desalocando a fila da memória
-void filaMensagem_finalizaFila(PTfilaMensagem fila);
-
-extern SemaphoreHandle_t sistema;
-
-
-
-#endif // FILA_MENSAGEM_H_INCLUDED
+/**
+ * @file    fila_mensagem.h
+ * @brief   Esse arquivo contem o prototipo das funções relativas a implementação da estrutura de dados fila
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 30/03/2020
+**/
+#ifndef FILA_MENSAGEM_H_INCLUDED
+#define FILA_MENSAGEM_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Inclusões de bibliotecas do módulo
+#include "tipos.h"
+#include "erros.h"
+
+/**
+ * Prototipos de funções exportadas
+ */
+/// Função que inializa uma fila
+Terro filaMensagem_inicializaFila(PTfilaMensagem fila, Tuint32 tamanho);
+/// Função que amplia a fila antes do produtor começar a usa-la
+Terro filaMensagem_ampliaFila(PTfilaMensagem fila, Tuint32 tamanho);
+/// Função que retorna o tamanho da fila
+Tuint32 filaMensagem_tamanhoFila(PTfilaMensagem fila);
+/// Função que enfilera uma celula na lista
+Terro filaMensagem_enfileirar(PTfilaMensagem fila, TmensagemCAN mensagem);
+/// Função que configura a politica adotada quando a fila estiver cheia
+void filaMensagem_configuraPolitica(PTfilaMensagem fila, TpoliticaEstouroFila politica, Tuint32 tempoBloqueio);
+/// Função que reserva a proxima celula da fila para ser escrita diretamente pelo produtor
+Terro filaMensagem_reservaCelula(PTfilaMensagem fila, PTmensagemCAN *celula);
+/// Função que publica a celula reservada para o consumidor
+void filaMensagem_confirmaCelula(PTfilaMensagem fila);
+/// Função que desinfilera uma celula da fila
+Terro filaMensagem_desenfileirar(PTfilaMensagem fila, PTmensagemCAN mensagem);
+/// Função que desinfilera ate "maximo" celulas da fila de uma vez
+Terro filaMensagem_desenfileirarLote(PTfilaMensagem fila, PTmensagemCAN destino, 
+                                     Tuint32 maximo, Tuint32 *quantidade);
+/// Função que copia os contadores da fila
+void filaMensagem_obtemEstatistica(PTfilaMensagem fila, PTestatisticaFila estatistica);
+/// Função que retorna o total de mensagens perdidas pela fila
+Tuint32 filaMensagem_quantidadePerdida(PTfilaMensagem fila);
+/// Função que finaliza a fila desalocando a fila da memória
+void filaMensagem_finalizaFila(PTfilaMensagem fila);
+
+extern SemaphoreHandle_t sistema;
+
+
+
+#endif // FILA_MENSAGEM_H_INCLUDED
@@ -0,0 +1,256 @@
+/**
+ * @file    filtro_software.cpp
+ * @brief   Esse arquivo contem as funções do filtro de software. Os filtros do MCP2515 (2 mascaras
+ *          e 6 filtros) apenas reduzem o trafego, a decisão exata é feita aqui, depois da fila
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "filtro_software.h"
+
+// Definições importantes
+#define SEPARADOR_LISTA_IDS             ';'
+#define SEPARADOR_TAXA_ID               '='
+#define TAMANHO_ID_PADRAO               3
+#define TAMANHO_ID_EXTENDIDO            8
+#define CONSTANTE_HASH_FILTRO           2654435761U   // hash multiplicativo de Knuth
+#define POSICAO_TABELA_FILTRO(chave)    (((Tuint32)(chave) * CONSTANTE_HASH_FILTRO) >> (32 - BITS_TABELA_FILTRO_EXTENDIDO))
+#define MASCARA_TABELA_FILTRO           (TAMANHO_TABELA_FILTRO_EXTENDIDO - 1)
+
+/**
+ * @brief  Função que converte um caracter hexa (ou 'X') em valor e mascara do nibble
+ * @param  caracter: caracter lido da lista
+ * @param  valor: recebe o valor do nibble
+ * @param  mascara: recebe 0xF se o nibble deve ser comparado ou 0x0 se for 'X'
+ * @return VERDADEIRO se o caracter é valido
+ */
+static Tbool filtroSoftware_converteNibble(char caracter, Tuint32 *valor, Tuint32 *mascara){
+  if((caracter == 'x') || (caracter == 'X')){
+    *valor = 0;
+    *mascara = 0;
+    return VERDADEIRO;
+  }
+  if((caracter >= 'a') && (caracter <= 'f')){
+    caracter -= 0x20;
+  }
+  if(((caracter >= '0') && (caracter <= '9')) || ((caracter >= 'A') && (caracter <= 'F'))){
+    *valor = ASCII_TO_HEXA(caracter);
+    *mascara = 0x0F;
+    return VERDADEIRO;
+  }
+  return FALSO;
+}
+
+/**
+ * @brief  Função que insere um identificador padrao (com 'X' como coringa) no mapa de bits
+ * @param  filtro: filtro sendo compilado
+ * @param  valor: identificador com os nibbles coringa zerados
+ * @param  mascara: bits que devem ser comparados
+ * @return void
+ */
+static void filtroSoftware_inserePadrao(PTfiltroSoftware filtro, Tuint32 valor, Tuint32 mascara){
+  Tuint32 id;
+
+  for(id=0; id<QUANTIDADE_IDS_PADRAO; id++){
+    if(((id & mascara) == valor) &&
+       ((filtro->padrao[id / BITS_POR_PALAVRA_FILTRO] & (1U << (id % BITS_POR_PALAVRA_FILTRO))) == 0)){
+      filtro->padrao[id / BITS_POR_PALAVRA_FILTRO] |= (1U << (id % BITS_POR_PALAVRA_FILTRO));
+      filtro->quantidadePadrao ++;
+    }
+  }
+}
+
+/**
+ * @brief  Função que insere um identificador extendido na tabela hash
+ * @param  filtro: filtro sendo compilado
+ * @param  id: identificador extendido de 29 bits
+ * @return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO se a tabela estiver cheia ou SUCESSO
+ */
+static Terro filtroSoftware_insereExtendido(PTfiltroSoftware filtro, Tuint32 id){
+  Tuint32 chave = (id | FLAG_QUADRO_EXTENDIDO);
+  Tuint32 posicao = POSICAO_TABELA_FILTRO(chave);
+  Tuint16 sondagem = 0;
+
+  while(filtro->extendido[posicao] != 0){
+    // Identificador repetido na lista
+    if(filtro->extendido[posicao] == chave){
+      return SUCESSO;
+    }
+    posicao = ((posicao + 1) & MASCARA_TABELA_FILTRO);
+    sondagem ++;
+  }
+
+  // Mantem a ocupação em no maximo 50% para que as sondagens continuem curtas
+  if(filtro->quantidadeExtendido >= MAXIMA_QUANTIDADE_IDS_EXTENDIDOS){
+    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+  }
+
+  filtro->extendido[posicao] = chave;
+  filtro->quantidadeExtendido ++;
+  if(sondagem > filtro->sondagemMaxima){
+    filtro->sondagemMaxima = sondagem;
+  }
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que le um identificador da lista. Com 3 caracteres ou menos é padrao e aceita 'X'
+ *         como coringa (ex: 7XX), com 8 caracteres é extendido (ex: 18DAF110).
+ *         A leitura para no ';', no '=' ou no fim do texto, sem consumi-los
+ * @param  lista: texto com a lista de identificadores
+ * @param  posicao: posição atual na lista, atualizada ao final
+ * @param  valor: recebe o identificador com os coringas zerados
+ * @param  mascara: recebe os bits que devem ser comparados
+ * @param  extendido: recebe VERDADEIRO se o identificador for extendido
+ * @return ERRO_LISTA_VAZIA (nenhum caracter lido), ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO ou SUCESSO
+ */
+Terro filtroSoftware_leIdentificador(const char *lista, Tuint32 *posicao, Tuint32 *valor, 
+                                     Tuint32 *mascara, Tbool *extendido){
+  Tuint32 i = *posicao;
+  Tuint8 tamanho = 0;
+  Tuint32 valorNibble, mascaraNibble;
+
+  *valor = 0;
+  *mascara = 0;
+
+  while((lista[i] != SEPARADOR_LISTA_IDS) && (lista[i] != SEPARADOR_TAXA_ID) && (lista[i] != '\0')){
+    if(lista[i] != ' '){
+      if(!filtroSoftware_converteNibble(lista[i], &valorNibble, &mascaraNibble)){
+        return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+      }
+      *valor = ((*valor << 4) | valorNibble);
+      *mascara = ((*mascara << 4) | mascaraNibble);
+      tamanho ++;
+      if(tamanho > TAMANHO_ID_EXTENDIDO){
+        return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+      }
+    }
+    i++;
+  }
+  *posicao = i;
+
+  if(tamanho == 0){
+    return ERRO_LISTA_VAZIA;
+  }
+
+  if((tamanho <= TAMANHO_ID_PADRAO) && (*valor <= MASCARA_ID_PADRAO)){
+    *mascara &= MASCARA_ID_PADRAO;
+    *extendido = FALSO;
+    return SUCESSO;
+  }
+  // Coringa em extendido exigiria expandir ate 2^29 identificadores, nao é suportado
+  if((tamanho == TAMANHO_ID_EXTENDIDO) && (*mascara == 0xFFFFFFFF) && (*valor <= MASCARA_ID_EXTENDIDO)){
+    *mascara = MASCARA_ID_EXTENDIDO;
+    *extendido = VERDADEIRO;
+    return SUCESSO;
+  }
+  return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+}
+
+/**
+ * @brief  Função que compila a lista de identificadores da configuração no filtro de software.
+ *         Formato: identificadores separados por ';' (ver filtroSoftware_leIdentificador).
+ *         "XXX" desativa o filtro.
+ * @param  filtro: filtro que será compilado
+ * @param  lista: texto com a lista de identificadores
+ * @return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO ou SUCESSO
+ */
+Terro filtroSoftware_compila(PTfiltroSoftware filtro, const char *lista){
+  Terro erro = SUCESSO;
+  Tuint32 i = 0;
+  Tuint32 valor, mascara;
+  Tbool extendido;
+
+  (void)memset(filtro, 0x00, sizeof(TfiltroSoftware));
+
+  // Sem lista ou filtro aberto: todas as mensagens sao aceitas
+  if(!FILTRO_SOFTWARE_CONFIGURADO(lista)){
+    return SUCESSO;
+  }
+
+  while(lista[i] != '\0'){
+
+    erro = filtroSoftware_leIdentificador(lista, &i, &valor, &mascara, &extendido);
+    if(lista[i] == SEPARADOR_LISTA_IDS){
+      i++;
+    }else if(lista[i] != '\0'){
+      return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+    }
+
+    if(erro == ERRO_LISTA_VAZIA){
+      continue;
+    }
+    if(erro != SUCESSO){
+      return erro;
+    }
+
+    if(!extendido){
+      filtroSoftware_inserePadrao(filtro, valor, mascara);
+    }else{
+      erro = filtroSoftware_insereExtendido(filtro, valor);
+      if(erro != SUCESSO){
+        return erro;
+      }
+    }
+  }
+
+  filtro->ativo = ((filtro->quantidadePadrao + filtro->quantidadeExtendido) > 0);
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que decide se a mensagem passa pelo filtro de software. Mensagens de erro/evento
+ *         (FLAG_QUADRO_ERRO) sempre passam
+ * @param  filtro: filtro compilado
+ * @param  mensagem: mensagem CAN
+ * @return VERDADEIRO se a mensagem deve ser registrada
+ */
+Tbool filtroSoftware_aceita(PTfiltroSoftware filtro, PTmensagemCAN mensagem){
+  Tuint32 id = ID_QUADRO(*mensagem);
+  Tuint32 chave, posicao;
+  Tuint16 sondagem;
+
+  if((!filtro->ativo) || QUADRO_ERRO(*mensagem)){
+    return VERDADEIRO;
+  }
+
+  if(!QUADRO_EXTENDIDO(*mensagem)){
+    return ((filtro->padrao[(id & MASCARA_ID_PADRAO) / BITS_POR_PALAVRA_FILTRO] >> (id % BITS_POR_PALAVRA_FILTRO)) & 1U);
+  }
+
+  // Sondagem limitada pela maior distancia registrada na compilação
+  chave = (id | FLAG_QUADRO_EXTENDIDO);
+  posicao = POSICAO_TABELA_FILTRO(chave);
+  for(sondagem=0; sondagem<=filtro->sondagemMaxima; sondagem++){
+    if(filtro->extendido[posicao] == chave){
+      return VERDADEIRO;
+    }
+    posicao = ((posicao + 1) & MASCARA_TABELA_FILTRO);
+  }
+  return FALSO;
+}
+
+/**
+ * @brief  Função que remove do array as mensagens rejeitadas pelo filtro, mantendo a ordem.
+ *         Cada mensagem é copiada sempre e o destino so avança se ela for aceita, sem desvio
+ * @param  filtro: filtro compilado
+ * @param  mensagem: array de mensagens (compactado no proprio lugar)
+ * @param  quantidade: quantidade de mensagens do array
+ * @return quantidade de mensagens aceitas
+ */
+Tuint32 filtroSoftware_compacta(PTfiltroSoftware filtro, PTmensagemCAN mensagem, Tuint32 quantidade){
+  Tuint32 i;
+  Tuint32 aceitas = 0;
+
+  if(!filtro->ativo){
+    return quantidade;
+  }
+
+  for(i=0; i<quantidade; i++){
+    mensagem[aceitas] = mensagem[i];
+    aceitas += (Tuint32)filtroSoftware_aceita(filtro, &mensagem[i]);
+  }
+  return aceitas;
+}
@@ -0,0 +1,31 @@
+/**
+ * @file    filtro_software.h
+ * @brief   Esse arquivo contem o prototipo das funções do filtro de software, aplicado às
+ *          mensagens depois da fila para completar os filtros do MCP2515
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef FILTRO_SOFTWARE_H_INCLUDED
+#define FILTRO_SOFTWARE_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Submódulos do sistema
+#include "tipos.h"
+#include "erros.h"
+
+/// Lista de identificadores configurada? ("XXX" ou vazio deixa o filtro aberto)
+#define FILTRO_SOFTWARE_CONFIGURADO(lista) \
+  (((lista) != NULL) && ((lista)[0] != '\0') && (strcmp((lista), "XXX") != 0) && (strcmp((lista), "---") != 0))
+
+/// Funções exportadas
+Terro filtroSoftware_leIdentificador(const char *lista, Tuint32 *posicao, Tuint32 *valor, 
+                                     Tuint32 *mascara, Tbool *extendido);
+Terro filtroSoftware_compila(PTfiltroSoftware filtro, const char *lista);
+Tbool filtroSoftware_aceita(PTfiltroSoftware filtro, PTmensagemCAN mensagem);
+Tuint32 filtroSoftware_compacta(PTfiltroSoftware filtro, PTmensagemCAN mensagem, Tuint32 quantidade);
+
+#endif // FILTRO_SOFTWARE_H_INCLUDED
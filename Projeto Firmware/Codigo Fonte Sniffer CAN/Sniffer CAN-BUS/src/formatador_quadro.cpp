@@ -0,0 +1,174 @@
+/**
+ * @file    formatador_quadro.cpp
+ * @brief   Esse arquivo contem o formatador de texto dos quadros CAN. Cada linha é escrita com um
+ *          cursor direto no buffer do chamador: os bytes em hexadecimal saem de uma tabela de 256
+ *          entradas e o intervalo é escrito com conta inteira, com o mesmo texto do "%0.1f"
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "formatador_quadro.h"
+
+/// Os dois caracteres hexadecimais de cada byte, o byte b ocupa as posições 2b e 2b + 1
+#define LINHA_TABELA_HEXA(alto) \
+  alto "0" alto "1" alto "2" alto "3" alto "4" alto "5" alto "6" alto "7" \
+  alto "8" alto "9" alto "A" alto "B" alto "C" alto "D" alto "E" alto "F"
+
+static const char tabelaHexa[] =
+  LINHA_TABELA_HEXA("0") LINHA_TABELA_HEXA("1") LINHA_TABELA_HEXA("2") LINHA_TABELA_HEXA("3")
+  LINHA_TABELA_HEXA("4") LINHA_TABELA_HEXA("5") LINHA_TABELA_HEXA("6") LINHA_TABELA_HEXA("7")
+  LINHA_TABELA_HEXA("8") LINHA_TABELA_HEXA("9") LINHA_TABELA_HEXA("A") LINHA_TABELA_HEXA("B")
+  LINHA_TABELA_HEXA("C") LINHA_TABELA_HEXA("D") LINHA_TABELA_HEXA("E") LINHA_TABELA_HEXA("F");
+
+/**
+ * @brief  Função que escreve um byte em hexadecimal (dois caracteres)
+ * @param  cursor: posição do texto
+ * @param  valor: byte a ser escrito
+ * @return posição seguinte do texto
+ */
+static inline char *formatadorQuadro_escreveByte(char *cursor, Tuint8 valor){
+  cursor[0] = tabelaHexa[(2 * valor) + 0];
+  cursor[1] = tabelaHexa[(2 * valor) + 1];
+  return (cursor + 2);
+}
+
+/**
+ * @brief  Função que escreve o intervalo desde a mensagem anterior em ms, com uma casa decimal
+ * @param  cursor: posição do texto
+ * @param  intervalo: intervalo em decimos de ms
+ * @return posição seguinte do texto
+ */
+static inline char *formatadorQuadro_escreveIntervalo(char *cursor, Tuint64 intervalo){
+  char digitos[8];
+  Tuint8 quantidade = 0;
+  Tuint32 inteiro;
+
+  // Intervalos longos passam do que o float representa com uma casa decimal, o texto precisa
+  // continuar identico ao que sempre foi escrito
+  if(intervalo >= LIMITE_INTERVALO_INTEIRO_TEXTO){
+    return (cursor + sprintf(cursor, "%0.1f", (float)((float)(intervalo * RESOLUCAO_TEMPO_REGISTRO)/1000)));
+  }
+
+  // Parte inteira (ms), os digitos saem do menos significativo para o mais significativo
+  inteiro = (Tuint32)(intervalo / 10);
+  do{
+    digitos[quantidade++] = (char)('0' + (inteiro % 10));
+    inteiro /= 10;
+  }while(inteiro > 0);
+  do{
+    *cursor++ = digitos[--quantidade];
+  }while(quantidade > 0);
+
+  // Decimos de ms
+  *cursor++ = '.';
+  *cursor++ = (char)('0' + (Tuint32)(intervalo % 10));
+  return cursor;
+}
+
+/**
+ * @brief  Função que formata as linhas de texto dos quadros. É expandida uma vez para o texto
+ *         formatado e outra para o simples, cada versao sem os testes de estilo dentro do laço
+ * @param  texto: buffer que recebe o texto, TAMANHO_MAXIMO_LINHA_TEXTO(formatado) por mensagem + 1
+ * @param  mensagem: Ponteiro para o array com as mensagens CANs
+ * @param  quantidade: quantidade de mensagens can presentes no array
+ * @param  formatado: constante que define o estilo das linhas
+ * @param  tempoReferencia: instante (esp_timer, us) posterior a todas as mensagens do array
+ * @param  tempoAnterior: instante da mensagem anterior (decimos de ms), atualizado ao final. 0 se nao houver
+ * @return quantidade de caracteres escritos, sem o terminador
+ */
+static inline __attribute__((always_inline)) Tuint32 formatadorQuadro_formataLinhas(char *texto, PTmensagemCAN mensagem,
+                                                                                     Tuint32 quantidade, const Tbool formatado,
+                                                                                     Tuint64 tempoReferencia, Tuint64 *tempoAnterior){
+  char *cursor = texto;
+  char *inicioLinha;
+  Tuint64 tempoQuadro;
+  Tuint32 identificador;
+  Tuint32 i;
+  Tuint8 j;
+
+  for(i=0; i<quantidade; i++){
+    inicioLinha = cursor;
+
+    // Intervalo desde a mensagem anterior, calculado sobre o instante absoluto ja arredondado para a
+    // resolução do registro. Assim a soma dos intervalos nao acumula erro de arredondamento
+    tempoQuadro = (TEMPO_ABSOLUTO_QUADRO(mensagem[i], tempoReferencia) / RESOLUCAO_TEMPO_REGISTRO);
+    if(*tempoAnterior == 0){
+      *tempoAnterior = tempoQuadro;
+    }
+    cursor = formatadorQuadro_escreveIntervalo(cursor, (tempoQuadro - *tempoAnterior));
+    *tempoAnterior = tempoQuadro;
+
+    // No texto formatado o identificador começa na coluna TAMANHO_DEFINIDO_ESPACO_ENTRE_TEMPO_ID
+    if(formatado){
+      while(cursor < (inicioLinha + TAMANHO_DEFINIDO_ESPACO_ENTRE_TEMPO_ID)){
+        *cursor++ = ' ';
+      }
+    }else{
+      *cursor++ = ';';
+    }
+
+    // Identificador com 8 digitos se for extendido, 3 se for o padrao
+    identificador = ID_QUADRO(mensagem[i]);
+    if(QUADRO_EXTENDIDO(mensagem[i])){
+      cursor = formatadorQuadro_escreveByte(cursor, (Tuint8)(identificador >> 24));
+      cursor = formatadorQuadro_escreveByte(cursor, (Tuint8)(identificador >> 16));
+      cursor = formatadorQuadro_escreveByte(cursor, (Tuint8)(identificador >> 8));
+    }else{
+      *cursor++ = tabelaHexa[(2 * ((identificador >> 8) & 0x0F)) + 1];
+    }
+    cursor = formatadorQuadro_escreveByte(cursor, (Tuint8)(identificador >> 0));
+
+    // Tamanho de dados do frame CAN entre os separadores
+    if(formatado){
+      (void)memcpy(cursor, "      ", 6);
+      cursor += 6;
+    }else{
+      *cursor++ = ';';
+    }
+    cursor = formatadorQuadro_escreveByte(cursor, (Tuint8)mensagem[i].tamanho);
+    if(formatado){
+      (void)memcpy(cursor, "   ", 3);
+      cursor += 3;
+    }else{
+      *cursor++ = ';';
+    }
+
+    // Dados, no texto formatado com espaço depois de cada byte
+    for(j=0; j<mensagem[i].tamanho; j++){
+      cursor = formatadorQuadro_escreveByte(cursor, mensagem[i].dados[j]);
+      if(formatado){
+        *cursor++ = ' ';
+      }
+    }
+
+    // Fim da linha no texto formatado, do contrario apenas ';'
+    if(formatado){
+      *cursor++ = '\r';
+      *cursor++ = '\n';
+    }else{
+      *cursor++ = ';';
+    }
+  }
+  *cursor = '\0';
+
+  return (Tuint32)(cursor - texto);
+}
+
+/**
+ * @brief  Função que formata uma quantidade x de quadro CAN para uma string
+ * @param  texto: buffer que recebe o texto, TAMANHO_MAXIMO_LINHA_TEXTO(formatado) por mensagem + 1
+ * @param  mensagem: Ponteiro para o array com as mensagens CANs
+ * @param  quantidade: quantidade de mensagens can presentes no array
+ * @param  formatado: boleano que define se o quadro será formatado
+ * @param  tempoReferencia: instante (esp_timer, us) posterior a todas as mensagens do array
+ * @param  tempoAnterior: instante da mensagem anterior (decimos de ms), atualizado ao final. 0 se nao houver
+ * @return quantidade de caracteres escritos, sem o terminador
+ */
+Tuint32 formatadorQuadro_formataTexto(char *texto, PTmensagemCAN mensagem, Tuint32 quantidade, Tbool formatado,
+                                      Tuint64 tempoReferencia, Tuint64 *tempoAnterior){
+  if(formatado){
+    return formatadorQuadro_formataLinhas(texto, mensagem, quantidade, VERDADEIRO, tempoReferencia, tempoAnterior);
+  }
+  return formatadorQuadro_formataLinhas(texto, mensagem, quantidade, FALSO, tempoReferencia, tempoAnterior);
+}
@@ -0,0 +1,25 @@
+/**
+ * @file    formatador_quadro.h
+ * @brief   Esse arquivo contem o prototipo do formatador de texto dos quadros CAN, compartilhado
+ *          pelo registro no cartao (texto formatado ou simples) e pelo envio ao servidor (sempre
+ *          simples). O texto é escrito direto no buffer do chamador, sem buffer intermediario
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef FORMATADOR_QUADRO_H_INCLUDED
+#define FORMATADOR_QUADRO_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Submódulos do sistema
+#include "tipos.h"
+#include "erros.h"
+
+/// Funções exportadas
+Tuint32 formatadorQuadro_formataTexto(char *texto, PTmensagemCAN mensagem, Tuint32 quantidade, Tbool formatado,
+                                      Tuint64 tempoReferencia, Tuint64 *tempoAnterior);
+
+#endif // FORMATADOR_QUADRO_H_INCLUDED
@@ -0,0 +1,223 @@
+/**
+ * @file    formato_binario.h
+ * @brief   Esse arquivo contem a definição do formato binario do registro no cartao. É compartilhado
+ *          pelo firmware e pelo decodificador (ferramentas/decodificador_log.cpp), por isso nao
+ *          depende do Arduino.
+ *
+ *          Inteiros de tamanho fixo sao little-endian. Varint: 7 bits por byte, o bit 7 indica que
+ *          ha mais bytes. Valores com sinal usam zigzag.
+ *
+ *          Arquivo prealocado (qualquer formato): o primeiro setor (TAMANHO_REGISTRO_PREALOCADO bytes)
+ *          é uma linha de texto com PREFIXO_REGISTRO_PREALOCADO e o tamanho logico do arquivo em
+ *          decimal (10 digitos, incluindo o setor), completada com espaços e terminada em "\r\n".
+ *          O registro começa depois dele.
+ *
+ *          Cabeçalho do arquivo, escrito antes do primeiro bloco (TAMANHO_CABECALHO_BINARIO bytes):
+ *            0  MAGICO_FORMATO_BINARIO ("SCNB")
+ *            4  versao (VERSAO_FORMATO_BINARIO)
+ *            5  tamanho do cabeçalho
+ *            6  reservado (2 bytes, zero)
+ *            8  relogio da primeira mensagem (us desde 1970, 8 bytes)
+ *            16 instante da primeira mensagem (esp_timer, us, 8 bytes)
+ *            24 CRC-32 dos 24 bytes anteriores
+ *
+ *          Bloco, um por bloco de mensagens do consumidor:
+ *            0  MARCA_BLOCO_BINARIO (2 bytes)
+ *            2  tamanho dos registros (4 bytes)
+ *            6  registros
+ *            6+n CRC-32 do tamanho e dos registros
+ *
+ *          Registros, identificados pelo primeiro byte:
+ *            0x00..0x7F quadro: bit 6 extendido, bit 5 remoto, bit 4 erro, bits 3..0 DLC. Seguem o
+ *                       intervalo desde o quadro anterior (us, varint zigzag), o identificador
+ *                       (2 bytes padrao ou 4 bytes extendido) e DLC bytes de dados. O primeiro
+ *                       quadro do arquivo conta a partir do instante do cabeçalho
+ *            REGISTRO_BINARIO_PERDIDOS   quadros perdidos na fila (varint)
+ *            REGISTRO_BINARIO_SUPRIMIDOS quadros suprimidos pelo registro de mudanças (varint)
+ *            REGISTRO_BINARIO_SAUDE      estado, TEC, REC, EFLG (1 byte cada), estouros RXB0 e RXB1,
+ *                                        carga minima e maxima em decimos de % (varint cada)
+ *
+ *          Bloco colunar (formato "colunar"), no lugar do bloco acima:
+ *            0  MARCA_BLOCO_COLUNAR (2 bytes)
+ *            2  tamanho do restante do bloco, sem o CRC (4 bytes)
+ *            6  tamanho das colunas descomprimidas (4 bytes)
+ *            10 colunas comprimidas (compressor_lz.h)
+ *            6+n CRC-32 do tamanho, do tamanho das colunas e das colunas comprimidas
+ *
+ *          Colunas, depois de descomprimidas:
+ *            quantidade N de quadros (varint)
+ *            tamanho dos marcadores (varint) e os marcadores, codificados como os registros acima
+ *            tempos: N varints zigzag. O primeiro é o intervalo desde o quadro anterior (us), os
+ *                    seguintes a diferença entre intervalos consecutivos (delta do delta), que
+ *                    em trafego periodico é quase sempre 0
+ *            dicionario: quantidade D (varint) e D entradas com as flags do quadro (bits 6..4 do
+ *                        quadro acima) e o identificador (varint)
+ *            indices: N indices do dicionario com formatoBinario_bitsIndice(D) bits cada, a partir
+ *                     do bit menos significativo do primeiro byte
+ *            DLC: N valores de 4 bits, dois por byte, o primeiro no nibble baixo
+ *            dados: DLC bytes de cada quadro, XOR com os ultimos dados do mesmo identificador no
+ *                   bloco (zero na primeira ocorrencia). Os bytes sao agrupados pela posição: os
+ *                   bytes 0 de todos os quadros, depois os bytes 1 dos quadros com DLC > 1, e assim
+ *                   por diante. Dados que nao mudam viram sequencias longas de zeros
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef FORMATO_BINARIO_H_INCLUDED
+#define FORMATO_BINARIO_H_INCLUDED
+
+#include <stdint.h>
+
+/// Cabeçalho do arquivo prealocado, um setor do cartao
+#define PREFIXO_REGISTRO_PREALOCADO         "# TAMANHO REGISTRO: "
+#define TAMANHO_REGISTRO_PREALOCADO         512
+
+/// Cabeçalho do arquivo
+#define MAGICO_FORMATO_BINARIO              "SCNB"
+#define TAMANHO_MAGICO_FORMATO_BINARIO      4
+#define VERSAO_FORMATO_BINARIO              1
+#define TAMANHO_CABECALHO_BINARIO           28
+
+/// Bloco
+#define MARCA_BLOCO_BINARIO_0               0xB5
+#define MARCA_BLOCO_BINARIO_1               0x5B
+#define TAMANHO_INICIO_BLOCO_BINARIO        6
+#define TAMANHO_CRC_BINARIO                 4
+#define MARCA_BLOCO_COLUNAR_0               0xB5
+#define MARCA_BLOCO_COLUNAR_1               0x5C
+#define TAMANHO_INICIO_BLOCO_COLUNAR        (TAMANHO_INICIO_BLOCO_BINARIO + 4)
+
+/// Registros
+#define REGISTRO_BINARIO_MARCADOR           0x80  // bit 7 separa os marcadores dos quadros
+#define REGISTRO_BINARIO_PERDIDOS           0x80
+#define REGISTRO_BINARIO_SUPRIMIDOS         0x81
+#define REGISTRO_BINARIO_SAUDE              0x82
+#define BINARIO_QUADRO_EXTENDIDO            0x40
+#define BINARIO_QUADRO_REMOTO               0x20
+#define BINARIO_QUADRO_ERRO                 0x10
+#define BINARIO_QUADRO_DLC                  0x0F
+
+/// Tamanhos maximos, usados na reserva de memoria
+#define TAMANHO_MAXIMO_VARINT_32            5
+#define TAMANHO_MAXIMO_VARINT_64            10
+#define TAMANHO_MAXIMO_QUADRO_BINARIO       (1 + TAMANHO_MAXIMO_VARINT_64 + 4 + 8)
+#define TAMANHO_MAXIMO_MARCADOR_BINARIO     (1 + TAMANHO_MAXIMO_VARINT_32)
+#define TAMANHO_MAXIMO_SAUDE_BINARIO        (1 + 4 + (4 * TAMANHO_MAXIMO_VARINT_32))
+#define TAMANHO_MAXIMO_MARCADORES_BINARIO   ((2 * TAMANHO_MAXIMO_MARCADOR_BINARIO) + TAMANHO_MAXIMO_SAUDE_BINARIO)
+// Por quadro: tempo, entrada do dicionario, indice de ate 32 bits, DLC e dados
+#define TAMANHO_MAXIMO_COLUNAS_BINARIO(quantidade) \
+  ((3 * TAMANHO_MAXIMO_VARINT_32) + TAMANHO_MAXIMO_MARCADORES_BINARIO + \
+   ((quantidade) * (TAMANHO_MAXIMO_VARINT_64 + 1 + TAMANHO_MAXIMO_VARINT_32 + 4 + 1 + 8)))
+
+/// Zigzag: inteiros pequenos com ou sem sinal viram varints curtos
+#define ZIGZAG_CODIFICA(valor)              ((((uint64_t)(valor)) << 1) ^ (uint64_t)(((int64_t)(valor)) >> 63))
+#define ZIGZAG_DECODIFICA(valor)            ((int64_t)(((valor) >> 1) ^ (~((valor) & 1) + 1)))
+
+/**
+ * @brief  Função que escreve um inteiro sem sinal como varint
+ * @param  destino: recebe ate TAMANHO_MAXIMO_VARINT_64 bytes
+ * @param  valor: valor que será escrito
+ * @return quantidade de bytes escritos
+ */
+static inline uint8_t formatoBinario_escreveVarint(uint8_t *destino, uint64_t valor){
+  uint8_t tamanho = 0;
+
+  while(valor >= 0x80){
+    destino[tamanho++] = (uint8_t)(valor | 0x80);
+    valor >>= 7;
+  }
+  destino[tamanho++] = (uint8_t)valor;
+  return tamanho;
+}
+
+/**
+ * @brief  Função que le um varint
+ * @param  origem: bytes do registro
+ * @param  limite: bytes disponiveis em origem
+ * @param  valor: recebe o valor lido
+ * @return quantidade de bytes lidos, 0 se o varint estiver incompleto ou for maior que 64 bits
+ */
+static inline uint8_t formatoBinario_leVarint(const uint8_t *origem, uint32_t limite, uint64_t *valor){
+  uint8_t tamanho = 0;
+  uint8_t deslocamento = 0;
+
+  *valor = 0;
+  while((tamanho < limite) && (tamanho < TAMANHO_MAXIMO_VARINT_64)){
+    *valor |= ((uint64_t)(origem[tamanho] & 0x7F) << deslocamento);
+    if((origem[tamanho++] & 0x80) == 0){
+      return tamanho;
+    }
+    deslocamento += 7;
+  }
+  return 0;
+}
+
+/**
+ * @brief  Função que escreve um inteiro little-endian de tamanho fixo
+ * @param  destino: recebe os bytes
+ * @param  valor: valor que será escrito
+ * @param  tamanho: quantidade de bytes
+ * @return void
+ */
+static inline void formatoBinario_escreveInteiro(uint8_t *destino, uint64_t valor, uint8_t tamanho){
+  uint8_t i;
+
+  for(i=0; i<tamanho; i++){
+    destino[i] = (uint8_t)(valor >> (8 * i));
+  }
+}
+
+/**
+ * @brief  Função que le um inteiro little-endian de tamanho fixo
+ * @param  origem: bytes do inteiro
+ * @param  tamanho: quantidade de bytes
+ * @return valor lido
+ */
+static inline uint64_t formatoBinario_leInteiro(const uint8_t *origem, uint8_t tamanho){
+  uint64_t valor = 0;
+  uint8_t i;
+
+  for(i=0; i<tamanho; i++){
+    valor |= ((uint64_t)origem[i] << (8 * i));
+  }
+  return valor;
+}
+
+/**
+ * @brief  Função que obtem a quantidade de bits de cada indice do dicionario colunar
+ * @param  quantidade: quantidade de entradas do dicionario
+ * @return bits por indice (0 se houver uma so entrada)
+ */
+static inline uint8_t formatoBinario_bitsIndice(uint32_t quantidade){
+  uint8_t bits = 0;
+
+  while((bits < 32) && (((uint32_t)1 << bits) < quantidade)){
+    bits ++;
+  }
+  return bits;
+}
+
+/**
+ * @brief  Função que calcula o CRC-32 (IEEE 802.3, o mesmo do zip) com uma tabela de 16 posições,
+ *         processando meio byte por vez
+ * @param  crc: CRC acumulado (0 no inicio)
+ * @param  dados: bytes que serão acumulados
+ * @param  tamanho: quantidade de bytes
+ * @return CRC acumulado
+ */
+static inline uint32_t formatoBinario_crc32(uint32_t crc, const uint8_t *dados, uint32_t tamanho){
+  static const uint32_t tabela[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+  };
+
+  crc = ~crc;
+  while(tamanho > 0){
+    crc ^= *dados++;
+    crc = ((crc >> 4) ^ tabela[crc & 0x0F]);
+    crc = ((crc >> 4) ^ tabela[crc & 0x0F]);
+    tamanho --;
+  }
+  return ~crc;
+}
+
+#endif // FORMATO_BINARIO_H_INCLUDED
@@ -0,0 +1,125 @@
+/**
+ * @file    formato_indice.h
+ * @brief   Esse arquivo contem a definição do indice esparso gravado ao lado de cada arquivo de
+ *          registro (LOG-xxxx.idx junto de LOG-xxxx.txt, .bin, .pcap ou .mf4). É compartilhado
+ *          pelo firmware e pelas ferramentas (ferramentas/consulta_indice.cpp), por isso nao
+ *          depende do Arduino.
+ *
+ *          O indice é escrito aos poucos, sempre depois dos dados que ele referencia, e é
+ *          finalizado na troca de arquivo e no fim da captura com o resumo por identificador.
+ *          Um indice sem o registro de fim (queda de energia) continua valido ate o ultimo
+ *          registro com CRC correto. Inteiros de tamanho fixo sao little-endian.
+ *
+ *          Deslocamentos sao bytes do conteudo do registro, sem o setor de cabeçalho do arquivo
+ *          prealocado: se o registro começa com PREFIXO_REGISTRO_PREALOCADO (formato_binario.h),
+ *          some TAMANHO_REGISTRO_PREALOCADO para obter a posição no arquivo.
+ *
+ *          Cabeçalho (TAMANHO_CABECALHO_INDICE bytes):
+ *            0  MAGICO_FORMATO_INDICE ("SCNI")
+ *            4  versao (VERSAO_FORMATO_INDICE)
+ *            5  tamanho do cabeçalho
+ *            6  reservado (2 bytes, zero)
+ *            8  largura do balde de tempo (us, 4 bytes)
+ *            12 bytes do inicio do registro que precedem qualquer trecho extraido (cabeçalho do
+ *               formato: binario e pcap; 0 no texto e no MF4, 4 bytes)
+ *            16 CRC-32 dos 16 bytes anteriores
+ *
+ *          Registros, em sequencia ate o fim do arquivo:
+ *            0  tipo (1 byte)
+ *            1  tamanho do conteudo (2 bytes)
+ *            3  conteudo
+ *            3+n CRC-32 do tipo, do tamanho e do conteudo
+ *
+ *          REGISTRO_INDICE_BALDE, um por balde de tempo com quadros, na ordem do registro:
+ *            0  deslocamento do primeiro bloco com quadros do balde (4 bytes)
+ *            4  bytes ate o fim do ultimo bloco com quadros do balde (4 bytes). Um bloco que
+ *               atravessa a fronteira pertence aos dois baldes
+ *            8  hora do primeiro e do ultimo quadro do balde (us desde 1970, 8 bytes cada)
+ *            24 quadros do balde (4 bytes)
+ *            28 flags: INDICE_BALDE_INCOMPLETO se algum identificador nao coube na tabela
+ *            29 quantidade N de identificadores (2 bytes)
+ *            31 N identificadores (4 bytes cada, bit 31 extendido e bit 30 remoto)
+ *
+ *          REGISTRO_INDICE_RESUMO, na finalização:
+ *            0  quantidade N de identificadores (2 bytes)
+ *            2  quadros de identificadores que nao couberam na tabela (4 bytes)
+ *            6  N entradas de TAMANHO_ENTRADA_RESUMO_INDICE bytes: identificador (4), hora do
+ *               primeiro e do ultimo quadro (8 cada), quadros (4) e baldes em que aparece (4)
+ *
+ *          REGISTRO_INDICE_FIM, o ultimo do arquivo (TAMANHO_REGISTRO_FIM_INDICE bytes):
+ *            0  posição do registro de resumo no indice (4 bytes)
+ *
+ *          Quadros de erro contam nos quadros do balde mas nao tem identificador. Nos formatos
+ *          texto e binario o intervalo do primeiro quadro de um trecho conta a partir do quadro
+ *          anterior do registro, a hora do primeiro quadro do balde permite reposicionar
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef FORMATO_INDICE_H_INCLUDED
+#define FORMATO_INDICE_H_INCLUDED
+
+#include <stdint.h>
+
+#include "formato_binario.h"
+
+/// Arquivo
+#define EXTENSAO_ARQUIVO_INDICE             ".idx"
+
+/// Cabeçalho
+#define MAGICO_FORMATO_INDICE               "SCNI"
+#define TAMANHO_MAGICO_FORMATO_INDICE       4
+#define VERSAO_FORMATO_INDICE               1
+#define TAMANHO_CABECALHO_INDICE            20
+#define LARGURA_BALDE_INDICE                1000000UL  // us
+
+/// Registros
+#define REGISTRO_INDICE_BALDE               0x01
+#define REGISTRO_INDICE_RESUMO              0x02
+#define REGISTRO_INDICE_FIM                 0x03
+#define INDICE_BALDE_INCOMPLETO             0x01
+#define TAMANHO_INICIO_REGISTRO_INDICE      3
+#define TAMANHO_FIXO_REGISTRO_INDICE        (TAMANHO_INICIO_REGISTRO_INDICE + TAMANHO_CRC_BINARIO)
+#define TAMANHO_INICIO_BALDE_INDICE         31
+#define TAMANHO_ID_INDICE                   4
+#define TAMANHO_INICIO_RESUMO_INDICE        6
+#define TAMANHO_ENTRADA_RESUMO_INDICE       28
+#define TAMANHO_REGISTRO_FIM_INDICE         (TAMANHO_FIXO_REGISTRO_INDICE + 4)
+#define TAMANHO_BALDE_INDICE(ids)           (TAMANHO_FIXO_REGISTRO_INDICE + TAMANHO_INICIO_BALDE_INDICE + ((ids) * TAMANHO_ID_INDICE))
+
+/**
+ * @brief  Função que escreve o inicio de um registro do indice
+ * @param  destino: recebe TAMANHO_INICIO_REGISTRO_INDICE bytes
+ * @param  tipo: tipo do registro
+ * @param  tamanho: tamanho do conteudo
+ * @return quantidade de bytes escritos
+ */
+static inline uint32_t formatoIndice_iniciaRegistro(uint8_t *destino, uint8_t tipo, uint16_t tamanho){
+  destino[0] = tipo;
+  formatoBinario_escreveInteiro(&destino[1], tamanho, 2);
+  return TAMANHO_INICIO_REGISTRO_INDICE;
+}
+
+/**
+ * @brief  Função que verifica um registro do indice
+ * @param  registro: inicio do registro
+ * @param  disponivel: bytes disponiveis a partir do inicio
+ * @return tamanho total do registro, 0 se estiver incompleto ou com CRC invalido
+ */
+static inline uint32_t formatoIndice_verificaRegistro(const uint8_t *registro, uint32_t disponivel){
+  uint32_t tamanho;
+
+  if(disponivel < TAMANHO_FIXO_REGISTRO_INDICE){
+    return 0;
+  }
+  tamanho = (uint32_t)formatoBinario_leInteiro(&registro[1], 2);
+  if(disponivel < (TAMANHO_FIXO_REGISTRO_INDICE + tamanho)){
+    return 0;
+  }
+  if(formatoBinario_crc32(0, registro, (TAMANHO_INICIO_REGISTRO_INDICE + tamanho)) !=
+     (uint32_t)formatoBinario_leInteiro(&registro[TAMANHO_INICIO_REGISTRO_INDICE + tamanho], TAMANHO_CRC_BINARIO)){
+    return 0;
+  }
+  return (TAMANHO_FIXO_REGISTRO_INDICE + tamanho);
+}
+
+#endif // FORMATO_INDICE_H_INCLUDED
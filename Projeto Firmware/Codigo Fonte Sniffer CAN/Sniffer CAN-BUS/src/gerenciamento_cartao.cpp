@@ -1,1122 +1,2091 @@
-/**
- * @file    gerenciamento_cartao.cpp
- * @brief   Esse arquivo contem a implementação das funções relativas ao gerenciamento
- *          do cartao micro SD
- * @author  Emanoel Gomes Santos
- * @date    Data de Criação: 10/04/2020
-**/
-
-/// Inclusões de bibliotecas importantes
-#include "gerenciamento_cartao.h"
-
-/// String com o arquivo padrão de configurações
-static const String conteudo_file_configuracoes = 
-(
-  "------------------------\nConfiguracoes do WIFI\n------------------------\nLogin: \"snifferCAN\"\nSenha: \"123456789\"\n\n------------------------\nLista de identificadores\n------------------------\nIdentificadores: \"7E0;7E8\"\n\n------------------------\nTaxa de Comunicacao\n------------------------\nTaxa: \"500KBPS\"\n\n------------------------\nURL Servidor\n------------------------\nURL Registros: \"---\"\nURL Taxa: \"---\"\nURL Filtros: \"---\"\n\n------------------------\nDeseja log formatado?\n------------------------\nLog Formatado: \"sim\"\n------------------------\nDeseja ativar monitor serial?\n------------------------\nMonitor Serial: \"sim\""
-);
-/// String com o arquivo padrão de system
-static const String conteudo_file_system = 
-(
-  "Sniffer CAN / Versão 1.0 / EMANOEL GOMES SANTOS\nLast File: \"0\""
-);
-
-#define QUANTIDADE_TAXAS_CONHECIDAS   15
-#define POS_TAXA_DEFAULT_500_KBPS     13
-
-static const TtabelaTaxas tabela_taxas_conhecidas[QUANTIDADE_TAXAS_CONHECIDAS] = {
-  {("4K096BPS"),TAXA_4K096BPS},
-  {("5KBPS"   ),TAXA_5KBPS},
-  {("10KBPS"  ),TAXA_10KBPS},
-  {("20KBPS"  ),TAXA_20KBPS},
-  {("31K25BPS"),TAXA_31K25BPS},
-  {("33K3BPS" ),TAXA_33K3BPS},
-  {("40KBPS"  ),TAXA_40KBPS},
-  {("50KBPS"  ),TAXA_50KBPS},
-  {("80KBPS"  ),TAXA_80KBPS},
-  {("100KBPS" ),TAXA_100KBPS},
-  {("125KBPS" ),TAXA_125KBPS},
-  {("200KBPS" ),TAXA_200KBPS},
-  {("250KBPS" ),TAXA_250KBPS},
-  {("500KBPS" ),TAXA_500KBPS},
-  {("1000KBPS"),TAXA_1000KBPS},
-};
-
-char * getStringTaxa(TaxaComunicacao taxa){
-  return (char *)tabela_taxas_conhecidas[taxa].descricao;
-}
-
-/**
- * @brief  Função que escreve mensagem de erro no cartão para log de erros 
- * @param  msgErro: string com a mensagem de erro
- * @return erro ou SUCESSO
- */
-Terro gerenciamentoCartao_escreveMensagemERRO(char *msgErro){
-  Terro erro = SUCESSO;
-  File arquivo;
-
-  if(!SD.exists("/ERRO")){
-    SD.mkdir("/ERRO");
-    
-    if(!SD.exists("/ERRO")){
-      return ERRO_AO_CRIAR_DIRETORIO_CARTAO;
-    }
-  }
-
-  arquivo = SD.open("/ERRO/log.txt", FILE_APPEND);
-  if(!arquivo){
-    return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
-  }
-
-  arquivo.print(erro);
-
-  arquivo.close();
-
-  return erro;
-}
-
-/**
- * @brief  Função que inicializa o micro sd definido por um cs (pino do SPI)
- * @param  CS: pino de comunicação do SPI
- * @return ERRO ou SUCESSO
- */
-static Terro inicializaCartaoMicroSD(Tuint8 cs){
-  return ((SD.begin(cs)) ? SUCESSO : ERRO_CARTAO_NAO_ENCONTRADO);
-}
-/**
- * @brief  Função que finaliza o micro sd  
- * @return ERRO ou SUCESSO
- */
-void gerenciamentoCartao_finaliza(void){
-  SD.end();
-}
-/**
- * @brief  Função que inicializa o micro sd definido por um cs (pino do SPI)
- * @param  CS: pino de comunicação do SPI
- * @return ERRO ou SUCESSO
- */
-Terro gerenciamentoCartao_inicializa(Tuint8 cs){
-  Terro erro = SUCESSO;
-  Tuint8 tentativas = 0;
-  File arquivo;
-  String info;
-  
-  PRINTLN();
-  PRINTLN("------Inicializando cartao------");
-  PRINT("Aguarde");
-
-  tentativas = 0;
-  do{
-  
-    erro = inicializaCartaoMicroSD(CS_PIN_MODULO_MICRO_SD);
-    if(erro != SUCESSO){
-      PRINT(".");
-      delay(1000); // somente aceita acima de 1 segundo
-      tentativas ++;
-    }      
-    
-  }while((erro != SUCESSO) && (tentativas < MAX_TENTATIVAS_CARTAO));
-  
-  if(erro != SUCESSO){
-    return erro;     
-  } 
-
-  // Verifica se existe a pasta SETUP
-  if(!SD.exists("/SETUP")){
-    // Cria diretório
-    SD.mkdir("/SETUP");
-    // Confere novamente após criação
-    if(!SD.exists("/SETUP")){
-      return ERRO_AO_CRIAR_DIRETORIO_CARTAO;
-    }
-  }
-  // Confere se existe arquivo de configuração
-  if(!SD.exists(NOME_ARQUIVO_CONFIGURACAO)){
-    
-    arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_WRITE);
-    if(!arquivo){
-      return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
-    } 
-
-    // Escreve conteúdo padrao
-    arquivo.print(conteudo_file_configuracoes);
-    arquivo.close();       
-
-  }  
-  // Confere se existe arquivo de configuração
-  if(!SD.exists(NOME_ARQUIVO_REGISTRO_INTERNO)){
-    
-    arquivo = SD.open(NOME_ARQUIVO_REGISTRO_INTERNO, FILE_WRITE);
-    if(!arquivo){
-      return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
-    } 
-    
-    // Escreve conteúdo padrao
-    arquivo.print(conteudo_file_system);
-    arquivo.close();       
-
-  }
-
-  // Confere se existe pasta REGISTROS
-  if(!SD.exists("/REGISTROS")){
-    // Cria diretório
-    SD.mkdir("/REGISTROS");
-    // Confere novamente após criação
-    if(!SD.exists("/REGISTROS")){
-      return ERRO_AO_CRIAR_DIRETORIO_CARTAO;
-    }
-
-    arquivo = SD.open(NOME_ARQUIVO_REGISTRO_INTERNO,FILE_WRITE);
-    if(!arquivo){
-      return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
-    } 
-    
-    // Escreve conteúdo padrao
-    arquivo.print(conteudo_file_system);
-    arquivo.close();  
-  } 
-  // Após o sucesso da conexão mostrar detalhes
-  PRINTLN("\n");
-  PRINTLN("Cartão encontrado e pronto para ser utilizado!!!\r\n");
-
-  return erro;
-}
-
-/**
- * @brief  Funçãoo que recupera o tamanho do arquivo desejado 
- * @param  caminho: Caminho do arquivo que se deseja obter o tamanho 
- * @return erro ou SUCESSO
- */
-Terro gerenciamentoCartao_tamanhoArquivo(char *caminho, Tuint32 *tamanho){
-  File arquivo;
-
-  arquivo = SD.open(caminho,FILE_READ);
-  if(!arquivo){
-    return ERRO_ABRIR_CARTAO_PARA_LEITURA;
-  }
-  *tamanho = arquivo.size();
-
-  arquivo.close();
-
-  return SUCESSO;
-}
-
-/**
- * @brief  Funçãoo que cria um arquivo de acordo com caminho especificado
- * @param  caminho: Caminho do arquivo que se deseja obter o tamanho 
- * @return erro ou SUCESSO
- */
-Terro gerenciamentoCartao_criaArquivo(char *caminho){  
-  File arquivo;
-
-  arquivo = SD.open(caminho,FILE_WRITE);
-  if(!arquivo){
-    return ERRO_ABRIR_CARTAO_PARA_LEITURA;
-  }
-
-  arquivo.close();
-
-  // Se chegou até aqui entao tudo ok
-  return SUCESSO;
-}
-
-/**
- * @brief  Funçãoo que verifica se ha espaço livre para provavel escrita no cartao
- * @return VERDADEIRO OU FALSO
- */
-Tbool gerencimanentoCartao_haEspacoLivre(void){
-  return ((SD.totalBytes() - SD.usedBytes()) > TAMANHO_BUFFER_10M);
-}
-
-/**
- * @brief  Função que escreve uma string no caminho especificado
- * @param  caminho: Caminho do arquivo que se deseja obter o tamanho 
- * @return erro ou SUCESSO
- */
-Terro gerenciamentoCartao_escreve(char *texto, const char *caminho, TmodoEscrita modo){
-  File arquivo;
-  size_t tamanho;
-  
-  /// Somente se couber no cartao pode ser atualizado
-  if(gerencimanentoCartao_haEspacoLivre()){ 
-
-    arquivo = SD.open(caminho,((modo==eModoAppend) ? FILE_APPEND : FILE_WRITE));
-    if(!arquivo){
-      return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
-    }  
-
-    tamanho = arquivo.print(texto);
-    if(tamanho == 0){
-      return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
-    }
-
-    arquivo.close();   
-    
-    return SUCESSO;
-  }
-  
-  return ERRO_LIMITE_EXCEDIDO_CARTAO_MEMORIA; 
-
-}
-
-/**
- * @brief  Função que escreve o ultimo arquivo de registro criado no diretorio system,
- *         para controle do sistema
- * @param  id: identificador do ultimo arquivo
- * @return erro ou SUCESSO
- */
-Terro gerenciamentoCartao_atualizaLastFile(Tuint32 id){
-  Terro erro = SUCESSO;
-  File arquivo;
-  char buffer[100];
-
-  arquivo = SD.open(NOME_ARQUIVO_REGISTRO_INTERNO, FILE_WRITE);
-  if(!arquivo){
-    return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
-  }
-
-  (void)sprintf(
-    buffer, 
-    "Sniffer CAN / Versão 1.0 / EMANOEL GOMES SANTOS\nLast File: \"%d\"",
-    id
-  );
-
-  arquivo.print(buffer);
-
-  arquivo.close();
- 
-  return erro;
-}
-
-/**
- * @brief  Função que busca uma informação no dump completo do arquivo de configuração,
- * @param  texto: dump completo do arquivo de configuração
- * @param  indice: indice que se deseja encontrar ex: "login:"
- * @param  infoEncontrada: Informação encontrada
- * @return erro ou SUCESSO
- */
-Terro gerenciamentoCartao_escreveInformacao(String texto, const char *indice, String informacao){
-  Tuint32 i;
-  char buffer[500];
-  
-  i = 0;
-
-  // Busca string indice
-  while(texto[i] != '\0'){
-    if(memcmp(&texto[i], indice, strlen(indice)) == 0 ){
-      i += strlen(indice);
-      break;
-    }
-    i++;
-  }
-  // Se o laço chegou até o final significa que nao encontrou indice
-  if(texto[i]  == '\0'){
-    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
-  }
-
-  texto[i] = ' ';
-  i++;
-  texto[i] = '\"';
-  i++;
-
-  (void)memcpy(&texto[i],&informacao[0], informacao.length());
-  texto[i+informacao.length()+0] = '\"';
-  texto[i+informacao.length()+1] = '\r';
-  texto[i+informacao.length()+2] = '\n';
-
-  texto.toCharArray(buffer,500);
-  
-
-  return gerenciamentoCartao_escreve(buffer,NOME_ARQUIVO_CONFIGURACAO, eModoWrite);
-
-}
-
-/**
- * @brief  Função que busca uma informação no dump completo do arquivo de configuração,
- * @param  texto: dump completo do arquivo de configuração
- * @param  indice: indice que se deseja encontrar ex: "login:"
- * @param  infoEncontrada: Informação encontrada
- * @return erro ou SUCESSO
- */
-Terro gerenciamentoCartao_buscaInformacao(String texto, const char *indice, String *infoEncontrada){
-  Terro erro = SUCESSO;
-  Tuint32 i, posicao;
-  char buffer[500];
-  
-  i = 0;
-  posicao = 0;
-
-  // Busca string Login
-  while(texto[i] != '\0'){
-    if(memcmp(&texto[i], indice, strlen(indice)) == 0 ){
-      i += strlen(indice);
-      break;
-    }
-    i++;
-  }
-  // Se o laço chegou até o final significa que nao encontrou "Login"
-  if(texto[i]  == '\0'){
-    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
-  }
-  // Tenta encontrar primeiras aspas
-  while(texto[i] != '\0'){
-    if(texto[i] == '\"'){ 
-      i++;
-      break; 
-    }
-    i++;
-  }
-  
-  // Se o laço chegou até o final significa que nao encontrou as primeiras aspas obrigatória
-  if(texto[i]  == '\0'){
-    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
-  }
-  
-  posicao = 0;
-  // Armazena informação completa entre as aspas
-  while((texto[i] != '\"') && (texto[i] != '\0')){
-    buffer[posicao] = texto[i];
-    i++;
-    posicao ++;
-  }
-
-
-  if(texto[i] == '\"'){ 
-    if(posicao == 0){
-      (void)strcpy(buffer,"---");      
-    }else{
-      buffer[posicao] = '\0';    
-    }
-  }else{
-    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
-  }
-
-  // SALVA INFORMAÇÃO ENCONTRADA
-  *infoEncontrada = buffer;
-    
-  return erro;
-}
-
-/**
- * @brief  Função que obtem o id do ultimo arquivo registrado no dump
- * @param  idArquivo: variável que receberá o ultimo ID
- * @return erro ou SUCESSO
- */
-Terro gerenciamentoCartao_obtemUltimoIdArquivoRegistro(Tuint16 *idArquivo){   
-  Terro erro = SUCESSO;  
-  File arquivo;
-  String buffer;  
-  String valor;
-  const char lastString [] {"Last File:"};
-  
-  // Abre arquivo para leitura
-  arquivo = SD.open(NOME_ARQUIVO_REGISTRO_INTERNO, FILE_READ);
-  if(!arquivo){
-    return ERRO_LEITURA_CARTAO;
-  }
-
-  buffer = arquivo.readString();
-    
-  // Busca informação do arquivo system Last File:
-  erro = gerenciamentoCartao_buscaInformacao(buffer,lastString,&valor);
-  if(erro != SUCESSO){
-    return erro;
-  }
-  
-  *idArquivo = ((Tuint32)valor.toInt());
-
-  // Se chegou até aqui então tudo ocorreu bem
-  return SUCESSO;
-}
-
-/**
- * @brief  Função que obtem o login e a senha recuperados do arquivo de configuração
- * @param  configuracaoWifi: Estrutura que armazenará a informação
- * @return erro ou SUCESSO
- */
-Terro gerenciamentoCartao_obtemLoginSenha(PTwifiConfig configuracaoWifi){
-  Terro erro = SUCESSO;
-  File arquivo;
-  String texto;
-  const char login[] = {"Login:"};
-  const char senha[] = {"Senha:"};
-  String buffer;
-
-  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
-  if(!arquivo){
-    return ERRO_LEITURA_CARTAO;
-  }
-  texto = arquivo.readString();
-  arquivo.close(); 
-
-  // Busca informação do login
-  erro = gerenciamentoCartao_buscaInformacao(texto,login,&buffer);
-  if(erro != SUCESSO){
-    return erro;
-  }
-  
-
-  buffer.toCharArray(configuracaoWifi->login, TAMANHO_MAXIMO_LOGIN);
-  
-  // Busca informação da senha
-  erro = gerenciamentoCartao_buscaInformacao(texto,senha,&buffer);
-  if(erro != SUCESSO){
-    return erro;
-  }
-  buffer.toCharArray(configuracaoWifi->senha, TAMANHO_MAXIMO_SENHA);
-
-  return erro;
-}
-/**
- * @brief  Função que obtem a URL do servidor recuperadoa do arquivo de configuração
- * @param  servidor: Estrutura que armazenará a informação
- * @return erro ou SUCESSO
- */
-Terro gerenciamentoCartao_obtemURLServidor(PTservidor servidor){
-  Terro erro = SUCESSO;
-  File arquivo;
-  String texto;
-  const char url_registro[] = {"URL Registros:"};
-  const char url_taxa[]     = {"URL Taxa:"};
-  const char url_filtros[]  = {"URL Filtros:"};
-  String buffer;
-  char userAndPassword[TAMANHO_SENHA_E_SERIAL];
-
-    // Cria string de user and password
-  (void)sprintf(userAndPassword, "&%s&%s", SERIAL_SNIFFER_CAN,SENHA_SNIFFER_CAN);
-
-  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
-  if(!arquivo){
-    return ERRO_LEITURA_CARTAO;
-  }
-  texto = arquivo.readString();
-  arquivo.close(); 
-
-  // Busca informação do login
-  erro = gerenciamentoCartao_buscaInformacao(texto,url_registro,&buffer);
-  if(erro != SUCESSO){
-    return erro;
-  } 
-  buffer.toCharArray(servidor->reg, TAMANHO_MAXIMO_URL);
-
-  (void)strcat(servidor->reg,userAndPassword);
-
-  // Busca informação do login
-  erro = gerenciamentoCartao_buscaInformacao(texto,url_taxa,&buffer);
-  if(erro != SUCESSO){
-    return erro;
-  } 
-  buffer.toCharArray(servidor->taxa, TAMANHO_MAXIMO_URL); 
-  
-  (void)strcat(servidor->taxa,userAndPassword);   
-
-  // Busca informação do login
-  erro = gerenciamentoCartao_buscaInformacao(texto,url_filtros,&buffer);
-  if(erro != SUCESSO){
-    return erro;
-  } 
-  buffer.toCharArray(servidor->filtro, TAMANHO_MAXIMO_URL);
-
-  
-  (void)strcat(servidor->filtro,userAndPassword);     
-
-  return erro;
-}
-
-
-/**
- * @brief  Função que valida se a informação inserida no arquivo de configuração 
- *         é de fato um identificador válido
- * @param  id: identificador
- * @return VERDADEIRO OU FALSO
- */
-static Tbool ehIdentificador(char *id){
-  if((*id >= '0') && (*id <= '9') ){
-    return VERDADEIRO;
-  }
-  if((*id >= 'A') && (*id <= 'F')){
-    return VERDADEIRO;
-  }
-  if((*id == 'x') || (*id == 'X')){
-    if(*id == 'x')*id -= 0x20; 
-    return VERDADEIRO;
-  }
-  if((*id >= 'a') && (*id <= 'f')){
-    *id -= 0x20;  
-    return VERDADEIRO;
-  }
-
-  return FALSO;
-}
-
-/**
- * @brief  Função que verifica se o filtro é de mascará ou padrão 
- * @param  filtroString: string com filtro
- * @return VERDADEIRO OU FALSO
- */
-static Tbool filtroMascarado(char *filtroString){
-  Tuint8 i;
-
-  for(i=0; i<strlen(filtroString); i++){
-    // Se for x entao é mascarado
-    if(filtroString[i] == 'X'){      
-      return VERDADEIRO;
-    }
-  }
-
-  return FALSO;  
-}
-/**
- * @brief  Função que converte uma string em um filtro 
- * @param  filtroString: string com filtro
- * @return filtro convertido em hexa
- */
-static Tuint32 converteFiltroASCIItoHex(char *filtroString){
-  Tuint8 i;
-  Tuint32 filtro = 0;
-  Tuint8 tamanho = strlen(filtroString);
-  char buffer[TAMANHO_MAX_STRING_FILTRO];
-
-  // Copio informação para buffer local para não alterar os dados.
-  (void)strcpy(buffer,filtroString);
-
-  for(i=0; i<tamanho; i++){
-    // Se for x entao é mascarado
-    if(buffer[i] == 'X'){
-      buffer[i] = '0';
-    }
-    filtro |=  (Tuint32)(((Tuint32)(ASCII_TO_HEXA(buffer[i])) << ((4*(tamanho-1)) - (4 * i))));
-  }
-  return filtro;
-  
-}
-
-Terro gerenciamentoCartao_formataListaFiltrosAndMascaras(PTlistaFiltrosAndMascaras lista, 
-                                                         String listaPossiveisFiltros){
-  Terro erro = SUCESSO;
-  Tuint32 pos;
-  Tuint32 i;
-  char filtro[TAMANHO_MAX_STRING_FILTRO];
-  Tuint8 quantFiltrosAndMask = 0;
-  char buffer[QUANTIDADE_FILTROS_E_MASCARAS][TAMANHO_MAX_STRING_FILTRO];  
-  Tuint8 quantidadeFiltrosPadrao = 0 ;
-  Tuint8 quantidadeFiltrosExtendidos = 0;
-
- // Tratamento para situação de nenhum identificador configurado
-  if(listaPossiveisFiltros.compareTo("XXX") == 0){
-    lista->quantidade = 0;
-    return SUCESSO; 
-  }
-  if(listaPossiveisFiltros.compareTo("") == 0){
-    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
-  }
-
-  // Se nao houver o ponto na ultima posição entao significa que o arquivo esta corrompido
-  /*
-  if(listaPossiveisFiltros[listaPossiveisFiltros.length() - 1] != '.'){
-    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
-  }*/
-  
-  i = 0;
-  pos = 0;
-  while(listaPossiveisFiltros[i] != '\0'){
-     
-    if(listaPossiveisFiltros[i] != ';'){
-
-      // Valida se realmente é um identificador  
-      if(ehIdentificador(&listaPossiveisFiltros[i])){
-
-        filtro[pos] = (char)listaPossiveisFiltros[i];    
-        pos++;
-        i++;
-        
-        // Trata situações: filtro de 29 bits so tem 8 caracteres
-        // se for um filro de 29 bits entao o primeiro caracter devera ser obrigatoriamente menor que 2
-        // se for um filro de 11 bits entao o primeiro caracter devera ser obrigatoriamente menor que 7
-        if( (pos >= 8)                                               || 
-            ((pos == 8) && ((filtro[0] > '1') || (filtro[0] < '0'))) ||
-            ((pos == 3) && ((filtro[0] > '7') || (filtro[0] < '0')))
-          ){
-          return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
-        }
-
-      }else{
-        return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;      
-      } 
-
-      // Se o proximo byte é '\0' entao tratar e sair      
-      if(listaPossiveisFiltros[i] == '\0'){
-        
-        // Finaliza filtro string
-        filtro[pos] = '\0';
-        // Verifica se algum filtro recebido é do tipo aberto, se sim apenas retornar
-        if(strcmp(filtro,"XXX") == 0){
-          lista->quantidade = 0;
-          return SUCESSO; 
-        }       
-
-        // Copia para array de filtros
-        (void)strcpy(buffer[quantFiltrosAndMask],filtro);
-        quantFiltrosAndMask ++;
-      }
-
-      
-    }
-    // Se for terminador ou separador, finaliza string
-    else {
-       // Finaliza filtro string
-       filtro[pos] = '\0';
-
-      // Verifica se algum filtro recebido é do tipo aberto, se sim apenas retornar
-       if(strcmp(filtro,"XXX") == 0){
-        lista->quantidade = 0;
-        return SUCESSO; 
-       }       
-
-       // Copia para array de filtros
-       (void)strcpy(buffer[quantFiltrosAndMask],filtro);
-
-       quantFiltrosAndMask++;
-       
-      
-      // Verifica se ultrapassou quantidade maximas de identificadores 
-      if(quantFiltrosAndMask == QUANTIDADE_FILTROS_E_MASCARAS){
-         // Sair do laço
-         break;
-      }else {
-        pos = 0;
-        i++;
-      }
-    }
-  }
-  
-  // Verifica se todos os filtros são extendido
-  for(i=0; i<quantFiltrosAndMask; i++){
-    if(strlen(buffer[i]) == (TAMANHO_MAX_STRING_FILTRO-1)){
-      quantidadeFiltrosExtendidos ++;
-    }
-  }  
-  // Verifica se todos os filtros são extendido
-  for(i=0; i<quantFiltrosAndMask; i++){
-    if(strlen(buffer[i]) == (TAMANHO_MAX_STRING_FILTRO-1)){
-      quantidadeFiltrosPadrao ++;
-    }
-  }  
-
-  // DEVERÁ TER SOMENTE filtros extendidos ou somente filtros padrao
-  if((quantidadeFiltrosExtendidos != quantFiltrosAndMask) && (quantidadeFiltrosExtendidos != 0)){
-    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
-  }
-  // DEVERÁ TER SOMENTE filtros extendidos ou somente filtros padrao
-  if((quantidadeFiltrosPadrao != quantFiltrosAndMask) && (quantidadeFiltrosPadrao != 0)){
-    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
-  }  
-  
-  // Tratar filtros extendidos
-  if(quantidadeFiltrosExtendidos == quantFiltrosAndMask){
-
-    lista->tipo = eExtendido;
-
-    // Encontra a mascara
-    for(i=0; i<quantFiltrosAndMask; i++){ 
-
-      if(filtroMascarado(buffer[i])){
-          lista->mascara_1 = converteFiltroASCIItoHex(buffer[i]);
-          lista->mask_1 = VERDADEIRO;     
-          return SUCESSO; 
-      }    
-    }
-    // Encontra os filtros
-    for(i=0; i<quantFiltrosAndMask; i++){ 
-
-      lista->filtros[lista->quantidade].valor = converteFiltroASCIItoHex(buffer[i]);      
-      lista->quantidade ++;
-      if(lista->quantidade == QUANTIDADE_FILTROS_MASCARA_1){
-        return SUCESSO;
-      }
-    }
-  }
-  // Tratar filtros padrao
-  else{
-
-    lista->tipo = ePadrao;
-    
-    // Encontra a mascara
-    for(i=0; i<quantFiltrosAndMask; i++){ 
-
-      if(filtroMascarado(buffer[i])){
-          lista->mascara_0 = converteFiltroASCIItoHex(buffer[i]);
-          lista->mask_0 = VERDADEIRO;     
-      }    
-    }
-
-    // Encontra os filtros
-    for(i=0; i<quantFiltrosAndMask; i++){ 
-      
-      if(!filtroMascarado(buffer[i])){
-        lista->filtros[lista->quantidade].valor = converteFiltroASCIItoHex(buffer[i]);        
-        lista->quantidade ++;
-        if(lista->quantidade == ((lista->mask_0) ? QUANTIDADE_FILTROS_MASCARA_1 : MAXIMA_QUANTIDADE_FILTROS)){
-          return SUCESSO;
-        }
-      }
-    }    
-
-  } 
-
-  return erro;  
-}
-
-/**
- * @brief  Função que obtem uma lista de filtros e mascaras
- * @param  lista: estrutura que irá armazenar os filtros e mascaras
- * @return erro ou SUCESSO
- */
-Terro gerenciamentoCartao_obtemListaFiltrosAndMascaras(PTlistaFiltrosAndMascaras lista){
-  Terro erro = SUCESSO;
-  File arquivo;
-  String texto;
-  const char identificadores[] = {"Identificadores:"};
-  String listaPossiveisFiltros;
-
-  
-  // Zera quantidade da lista
-  lista->quantidade = 0;
-  
-  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
-  if(!arquivo){
-    return ERRO_LEITURA_CARTAO;
-  }
-  texto = arquivo.readString();
-  arquivo.close(); 
-
-  // Busca informação dos identificadores
-  // exemplo: 7xX.
-  erro = gerenciamentoCartao_buscaInformacao(texto,identificadores,&listaPossiveisFiltros);
-  if(erro != SUCESSO){
-    return erro;
-  }
-
-  // Formata a lista de identificadores de acordo com texto recebido
-  erro = gerenciamentoCartao_formataListaFiltrosAndMascaras(lista,listaPossiveisFiltros);
-  if(erro != SUCESSO){
-    return erro;
-  }
-  
-  return erro;
-}
-
-/**
- * @brief  Função que obtem uma lista de filtros e mascaras
- * @param  lista: estrutura que irá armazenar os filtros e mascaras
- * @return erro ou SUCESSO
- */
-Terro gerenciamentoCartao_escreveListaFiltrosAndMascaras(String listaFiltrosAndMascaras){
-  Terro erro = SUCESSO;
-  File arquivo;
-  String texto;
-  const char identificadores[] = {"Identificadores:"};
-
-  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
-  if(!arquivo){
-    return ERRO_LEITURA_CARTAO;
-  }
-  texto = arquivo.readString();
-  arquivo.close(); 
-
-  // Escreve informação de filtro e mascara
-  erro = gerenciamentoCartao_escreveInformacao(texto,identificadores,listaFiltrosAndMascaras);
-  if(erro != SUCESSO){
-    return erro;
-  }
-  return erro;
-}
-
-Terro gerenciamentoCartao_verificaTaxa(PTaxaComunicacao taxa, String taxaTexto){
-  Tuint16 i;
-
-  for(i=0; i<QUANTIDADE_TAXAS_CONHECIDAS; i++){
-    if( taxaTexto.toInt() == tabela_taxas_conhecidas[i].taxa){
-      *taxa = tabela_taxas_conhecidas[i].taxa;
-      break;
-    }
-  }
-  // Significa que nao encontrou nenhuma taxa conhecida
-  if(i == QUANTIDADE_TAXAS_CONHECIDAS){
-    return ERRO_TAXA_DESCONHECIDA;
-  }
-
-  return SUCESSO;
-}
-
-/**
- * @brief  Função que formata a taxa de comunicação
- * @param  taxa: estrutura que irá armazenar a taxa de comunicação
- * @param  textoTaxa: texto com a taxa de comunicação
- * @return erro ou SUCESSO
- */
-Terro gerenciamentoCartao_formataTaxa(PTaxaComunicacao taxa, String textoTaxa){
-  Terro erro = SUCESSO;
-  Tuint16 i;
-
-  // Se for enviado texto erroneamente
-  if(textoTaxa.compareTo("") == 0){
-    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
-  }
-
-
-  for(i=0; i<QUANTIDADE_TAXAS_CONHECIDAS; i++){
-    if(textoTaxa.compareTo(tabela_taxas_conhecidas[i].descricao) == 0){
-      *taxa = tabela_taxas_conhecidas[i].taxa;
-      break;
-    }
-  }
-  // Significa que nao encontrou nenhuma taxa conhecida
-  if(i == QUANTIDADE_TAXAS_CONHECIDAS){
-    return ERRO_TAXA_DESCONHECIDA;
-  }
-
-  return erro;
-
-}
-/**
- * @brief  Função que obtem a taxa de comunicação apartir do arquivo de configuração
- * @param  taxa: estrutura que irá armazenar a taxa de comunicação
- * @return erro ou SUCESSO
- */
-Terro gerenciamentoCartao_obtemTaxaComunicacao(PTaxaComunicacao taxa){
-  Terro erro = SUCESSO;
-  File arquivo;
-  String texto;
-  const char taxaComunicacao[] = {"Taxa:"};
-  String buffer;
-  
-  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
-  if(!arquivo){
-    return ERRO_LEITURA_CARTAO;
-  }
-  texto = arquivo.readString();
-  arquivo.close(); 
-
-  // Busca informação do login
-  erro = gerenciamentoCartao_buscaInformacao(texto,taxaComunicacao,&buffer);
-  if(erro != SUCESSO){
-    return erro;
-  }   
-  // Formata texto da taxa, se nao estiver na lista de taxas conhecidas entao atribuii taxa padrao
-  erro = gerenciamentoCartao_formataTaxa(taxa, buffer);
-  if(erro != SUCESSO){
-    *taxa = TAXA_500KBPS;
-  }
-
-  return erro;
-}
-/**
- * @brief  Função que obtem a taxa de comunicação apartir do arquivo de configuração
- * @param  taxa: estrutura que irá armazenar a taxa de comunicação
- * @return erro ou SUCESSO
- */
-Terro gerenciamentoCartao_escreveTaxaComunicacao(String taxa){
-  Terro erro = SUCESSO;
-  File arquivo;
-  String texto;
-  const char taxaComunicacao[] = {"Taxa:"};
-  String buffer;
-  Tuint8 i;
-  
-  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
-  if(!arquivo){
-    return ERRO_LEITURA_CARTAO;
-  }
-  texto = arquivo.readString();
-  arquivo.close();   
-
-  for(i=0; i<QUANTIDADE_TAXAS_CONHECIDAS; i++){
-    if(taxa.toInt() == tabela_taxas_conhecidas[i].taxa){
-      buffer = tabela_taxas_conhecidas[i].descricao;
-      break;
-    }
-  }
-  // Se chegou até o final e não encontrou, atribui taxa padrao
-  if(i==QUANTIDADE_TAXAS_CONHECIDAS){
-    buffer = tabela_taxas_conhecidas[POS_TAXA_DEFAULT_500_KBPS].descricao;
-  }
-
-  // Busca informação do login
-  erro = gerenciamentoCartao_escreveInformacao(texto,taxaComunicacao,buffer);
-  if(erro != SUCESSO){
-    return erro;
-  }   
-  return erro;
-}
-
-/**
- * @brief  Função que obtem a informação se usuário deseja um log sem formatação 
- *         ou com formatação.
- * @param  formatado: variável que receberá se sera formatado ou nao
- * @return erro ou SUCESSO
- */
-Terro gerenciamentoCartao_obtemDesejaFormatarLog(Tbool *formatado){
-  Terro erro = SUCESSO;
-  File arquivo;
-  String texto;
-  const char logFormatado[] = {"Log Formatado:"};
-  String buffer;
-  
-  // Abre arquivo para leitura
-  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
-  if(!arquivo){
-    return ERRO_LEITURA_CARTAO;
-  }
-  // Le arquivo inteiro e armazena em texto
-  texto = arquivo.readString();
-  // Fecha arquivo
-  arquivo.close(); 
-
-  // Busca informação do login
-  erro = gerenciamentoCartao_buscaInformacao(texto,logFormatado,&buffer);
-  if(erro != SUCESSO){
-    return erro;
-  }   
-  
-  // Somente podera ter 3 letras a resposta
-  if(buffer.length() < 3){
-    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
-  }
-
-  if( ((buffer[0] == 's') || (buffer[0] == 'S')) && 
-      ((buffer[1] == 'i') || (buffer[1] == 'I')) && 
-      ((buffer[2] == 'm') || (buffer[1] == 'M'))
-    ){
-      *formatado = VERDADEIRO;
-    }else{
-      *formatado = FALSO;
-    }
-
-  return erro;
-
-}
-
-/**
- * @brief  Função que obtem a informação se usuário deseja um log sem formatação 
- *         ou com formatação.
- * @param  formatado: variável que receberá se sera formatado ou nao
- * @return erro ou SUCESSO
- */
-Terro gerenciamentoCartao_obtemDesejaMonitorSerial(Tbool *monitorSerial){
-  Terro erro = SUCESSO;
-  File arquivo;
-  String texto;
-  const char strMonitorSerial[] = {"Monitor Serial:"};
-  String buffer;
-  
-  // Abre arquivo para leitura
-  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
-  if(!arquivo){
-    return ERRO_LEITURA_CARTAO;
-  }
-  // Le arquivo inteiro e armazena em texto
-  texto = arquivo.readString();
-  // Fecha arquivo
-  arquivo.close(); 
-
-  // Busca informação do login
-  erro = gerenciamentoCartao_buscaInformacao(texto,strMonitorSerial,&buffer);
-  if(erro != SUCESSO){
-    return erro;
-  }   
-  
-  // Somente podera ter 3 letras a resposta
-  if(buffer.length() < 3){
-    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
-  }
-
-  if( ((buffer[0] == 's') || (buffer[0] == 'S')) && 
-      ((buffer[1] == 'i') || (buffer[1] == 'I')) && 
-      ((buffer[2] == 'm') || (buffer[1] == 'M'))
-    ){
-      *monitorSerial = VERDADEIRO;
-    }else{
-      *monitorSerial = FALSO;
-    }
-
-  return erro;
-
-}
-/**
- * @brief  Função que obtem as informações de configuração no cartao de memória
- * @param  configuracao: Estrutura com os definidores das configurações
- * @return ERRO ou SUCESSO
- */
-Terro gerenciamentoCartao_obtemConfiguracao(PTconfiguracao configuracao){
-  Terro erro = SUCESSO;
-
-  // Obtem login e senha do wifi
-  erro = gerenciamentoCartao_obtemLoginSenha(&(configuracao->wifi));
-  if(erro != SUCESSO){
-    return erro;
-  }
-  PRINTF("LOGIN: %s\r\n", configuracao->wifi.login);
-  PRINTF("SENHA: %s\r\n", configuracao->wifi.senha);
-
-  // Obtem a taxa de comunicação 
-  erro = gerenciamentoCartao_obtemTaxaComunicacao(&(configuracao->taxa));
-  if(erro != SUCESSO){
-    return erro;
-  }  
-  PRINTF("TAXA: %d\r\n", configuracao->taxa);
-
-  // Obtem a lista de identificadores para filtro 
-  erro = gerenciamentoCartao_obtemListaFiltrosAndMascaras(&(configuracao->filtAndMask));
-  if(erro != SUCESSO){
-    return erro;
-  }  
-  if(configuracao->filtAndMask.mask_0){
-    PRINTF("MASCARA 0: 0x%08X\r\n",configuracao->filtAndMask.mascara_0);
-  }
-  if(configuracao->filtAndMask.mask_1){
-    PRINTF("MASCARA 0: 0x%08X\r\n",configuracao->filtAndMask.mascara_1);
-  }  
-  
-  for(int i=0; i<configuracao->filtAndMask.quantidade; i++){
-    PRINTF("IDENTIFICADORES %02d: 0x%08X\r\n", (i+1),configuracao->filtAndMask.filtros[i].valor);
-  }
-  // Obtem a lista de identificadores para filtro 
-  erro = gerenciamentoCartao_obtemDesejaFormatarLog(&(configuracao->logFormatado));
-  if(erro != SUCESSO){
-    return erro;
-  }     
-
-  PRINTF("Log formatado? %d\r\n", configuracao->logFormatado);
-
-  // Obtem a lista de identificadores para filtro 
-  erro = gerenciamentoCartao_obtemDesejaMonitorSerial(&(configuracao->monitorSerial));
-  if(erro != SUCESSO){
-    return erro;
-  }     
-
-  PRINTF("Monitor Serial? %d\r\n", configuracao->monitorSerial);
-  
-
-  // Obtem id do ultimo arquivo armazenado no cartao de memória
-  erro = gerenciamentoCartao_obtemUltimoIdArquivoRegistro(&(configuracao->idArquivo));
-  if(erro != SUCESSO){
-    return erro;
-  }  
-
-  PRINTF("Ultimo arquivo: %d\r\n", configuracao->idArquivo);
-
-  erro = gerenciamentoCartao_obtemURLServidor(&(configuracao->servidor));
-  if(erro != SUCESSO){
-    return erro;
-  }  
-
-  PRINTF("URL Registros: %s\r\n", configuracao->servidor.reg);
-
-  PRINTF("URL Filtros: %s\r\n", configuracao->servidor.filtro);
-
-  PRINTF("URL Taxa: %s\r\n", configuracao->servidor.taxa);
-
-
-  return erro;
-}
-
+/**
+ * @file    gerenciamento_cartao.cpp
+ * @brief   Esse arquivo contem a implementação das funções relativas ao gerenciamento
+ *          do cartao micro SD
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 10/04/2020
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "gerenciamento_cartao.h"
+
+/// String com o arquivo padrão de configurações
+static const String conteudo_file_configuracoes = 
+(
+  "------------------------\nConfiguracoes do WIFI\n------------------------\nLogin: \"snifferCAN\"\nSenha: \"123456789\"\n\n------------------------\nLista de identificadores\n------------------------\nIdentificadores: \"7E0;7E8\"\n\n------------------------\nTaxa de Comunicacao\n------------------------\nTaxa: \"500KBPS\"\n\n------------------------\nURL Servidor\n------------------------\nURL Registros: \"---\"\nURL Taxa: \"---\"\nURL Filtros: \"---\"\n\n------------------------\nDeseja log formatado?\n------------------------\nLog Formatado: \"sim\"\n------------------------\nDeseja ativar monitor serial?\n------------------------\nMonitor Serial: \"sim\"\n------------------------\nFila de mensagens (antiga/nova/bloqueia)\n------------------------\nPolitica Fila: \"antiga\"\nTempo Bloqueio Fila (ms): \"5\"\n\n------------------------\nFiltro de software (XXX = desativado)\n------------------------\nFiltro Software: \"XXX\"\n\n------------------------\nTaxas do barramento para o compilador de filtros (ID=quadros/s;...)\n------------------------\nTaxas Barramento: \"---\"\n\n------------------------\nRegistrar somente mudancas nos dados? (quadro chave 0 = nunca)\n------------------------\nRegistro Mudancas: \"nao\"\nQuadro Chave (ms): \"1000\"\nResumo Suprimidos: \"nao\"\n\n------------------------\nFlush do arquivo de registro (bytes pendentes / tempo maximo)\n------------------------\nDescarga Cartao (bytes): \"16384\"\nDescarga Cartao (ms): \"1000\"\n\n------------------------\nPrealocacao de cada arquivo de registro (0 = desativada)\n------------------------\nPrealocacao Registro (MiB): \"" TEXTO_MACRO(PREALOCACAO_REGISTRO_PADRAO) "\"\n\n------------------------\nFormato do arquivo de registro (texto/binario/colunar/pcap/mf4) e do envio ao servidor (texto/colunar)\n------------------------\nFormato Registro: \"texto\"\nFormato Servidor: \"texto\"\n\n------------------------\nBloco de mensagens (latencia maxima ate o envio / maximo de mensagens)\n------------------------\nLatencia Bloco (ms): \"500\"\nMaximo Mensagens Bloco: \"1024\""
+);
+/// String com o arquivo padrão de system
+static const String conteudo_file_system = 
+(
+  "Sniffer CAN / Versão 1.0 / EMANOEL GOMES SANTOS\nLast File: \"0\""
+);
+
+/// Arquivo de registro aberto, usado somente pela tarefa de escrita no cartao
+static TescritorRegistro escritorRegistro;
+
+/// Cabeçalho do arquivo de registro prealocado (formato_binario.h e gerenciamentoCartao_formataCabecalho)
+#define TAMANHO_LEITURA_CABECALHO    (sizeof(PREFIXO_REGISTRO_PREALOCADO) - 1 + 10 + 1)
+static_assert(TAMANHO_REGISTRO_PREALOCADO == TAMANHO_SETOR_CARTAO, "cabeçalho prealocado deve ocupar um setor");
+
+#define QUANTIDADE_TAXAS_CONHECIDAS   15
+#define POS_TAXA_DEFAULT_500_KBPS     13
+
+static const TtabelaTaxas tabela_taxas_conhecidas[QUANTIDADE_TAXAS_CONHECIDAS] = {
+  {("4K096BPS"),TAXA_4K096BPS,4096},
+  {("5KBPS"   ),TAXA_5KBPS,5000},
+  {("10KBPS"  ),TAXA_10KBPS,10000},
+  {("20KBPS"  ),TAXA_20KBPS,20000},
+  {("31K25BPS"),TAXA_31K25BPS,31250},
+  {("33K3BPS" ),TAXA_33K3BPS,33333},
+  {("40KBPS"  ),TAXA_40KBPS,40000},
+  {("50KBPS"  ),TAXA_50KBPS,50000},
+  {("80KBPS"  ),TAXA_80KBPS,80000},
+  {("100KBPS" ),TAXA_100KBPS,100000},
+  {("125KBPS" ),TAXA_125KBPS,125000},
+  {("200KBPS" ),TAXA_200KBPS,200000},
+  {("250KBPS" ),TAXA_250KBPS,250000},
+  {("500KBPS" ),TAXA_500KBPS,500000},
+  {("1000KBPS"),TAXA_1000KBPS,1000000},
+};
+
+char * getStringTaxa(TaxaComunicacao taxa){
+  return (char *)tabela_taxas_conhecidas[taxa].descricao;
+}
+
+Tuint32 getBitsPorSegundoTaxa(TaxaComunicacao taxa){
+  if(taxa >= QUANTIDADE_TAXAS_CONHECIDAS){
+    return tabela_taxas_conhecidas[POS_TAXA_DEFAULT_500_KBPS].bitsPorSegundo;
+  }
+  return tabela_taxas_conhecidas[taxa].bitsPorSegundo;
+}
+
+/**
+ * @brief  Função que escreve mensagem de erro no cartão para log de erros 
+ * @param  msgErro: string com a mensagem de erro
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_escreveMensagemERRO(char *msgErro){
+  Terro erro = SUCESSO;
+  File arquivo;
+
+  if(!SD.exists("/ERRO")){
+    SD.mkdir("/ERRO");
+    
+    if(!SD.exists("/ERRO")){
+      return ERRO_AO_CRIAR_DIRETORIO_CARTAO;
+    }
+  }
+
+  arquivo = SD.open("/ERRO/log.txt", FILE_APPEND);
+  if(!arquivo){
+    return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
+  }
+
+  arquivo.print(erro);
+
+  arquivo.close();
+
+  return erro;
+}
+
+/**
+ * @brief  Função que inicializa o micro sd definido por um cs (pino do SPI)
+ * @param  CS: pino de comunicação do SPI
+ * @return ERRO ou SUCESSO
+ */
+static Terro inicializaCartaoMicroSD(Tuint8 cs){
+  return ((SD.begin(cs)) ? SUCESSO : ERRO_CARTAO_NAO_ENCONTRADO);
+}
+/**
+ * @brief  Função que finaliza o micro sd  
+ * @return ERRO ou SUCESSO
+ */
+void gerenciamentoCartao_finaliza(void){
+  gerenciamentoCartao_fechaRegistro();
+  SD.end();
+}
+/**
+ * @brief  Função que inicializa o micro sd definido por um cs (pino do SPI)
+ * @param  CS: pino de comunicação do SPI
+ * @return ERRO ou SUCESSO
+ */
+Terro gerenciamentoCartao_inicializa(Tuint8 cs){
+  Terro erro = SUCESSO;
+  Tuint8 tentativas = 0;
+  File arquivo;
+  String info;
+  
+  PRINTLN();
+  PRINTLN("------Inicializando cartao------");
+  PRINT("Aguarde");
+
+  tentativas = 0;
+  do{
+  
+    erro = inicializaCartaoMicroSD(CS_PIN_MODULO_MICRO_SD);
+    if(erro != SUCESSO){
+      PRINT(".");
+      delay(1000); // somente aceita acima de 1 segundo
+      tentativas ++;
+    }      
+    
+  }while((erro != SUCESSO) && (tentativas < MAX_TENTATIVAS_CARTAO));
+  
+  if(erro != SUCESSO){
+    return erro;     
+  } 
+
+  // Verifica se existe a pasta SETUP
+  if(!SD.exists("/SETUP")){
+    // Cria diretório
+    SD.mkdir("/SETUP");
+    // Confere novamente após criação
+    if(!SD.exists("/SETUP")){
+      return ERRO_AO_CRIAR_DIRETORIO_CARTAO;
+    }
+  }
+  // Confere se existe arquivo de configuração
+  if(!SD.exists(NOME_ARQUIVO_CONFIGURACAO)){
+    
+    arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_WRITE);
+    if(!arquivo){
+      return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
+    } 
+
+    // Escreve conteúdo padrao
+    arquivo.print(conteudo_file_configuracoes);
+    arquivo.close();       
+
+  }  
+  // Confere se existe arquivo de configuração
+  if(!SD.exists(NOME_ARQUIVO_REGISTRO_INTERNO)){
+    
+    arquivo = SD.open(NOME_ARQUIVO_REGISTRO_INTERNO, FILE_WRITE);
+    if(!arquivo){
+      return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
+    } 
+    
+    // Escreve conteúdo padrao
+    arquivo.print(conteudo_file_system);
+    arquivo.close();       
+
+  }
+
+  // Confere se existe pasta REGISTROS
+  if(!SD.exists("/REGISTROS")){
+    // Cria diretório
+    SD.mkdir("/REGISTROS");
+    // Confere novamente após criação
+    if(!SD.exists("/REGISTROS")){
+      return ERRO_AO_CRIAR_DIRETORIO_CARTAO;
+    }
+
+    arquivo = SD.open(NOME_ARQUIVO_REGISTRO_INTERNO,FILE_WRITE);
+    if(!arquivo){
+      return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
+    } 
+    
+    // Escreve conteúdo padrao
+    arquivo.print(conteudo_file_system);
+    arquivo.close();  
+  } 
+  // Espaço livre calculado uma unica vez, depois é descontado a cada escrita. Percorrer a FAT
+  // para obter os bytes usados a cada bloco dominava o tempo de escrita
+  (void)memset(escritorRegistro.caminho, 0x00, sizeof(escritorRegistro.caminho));
+  escritorRegistro.bytesPendentes = 0;
+  escritorRegistro.ultimaDescarga = millis();
+  escritorRegistro.limiteBytes = DESCARGA_CARTAO_BYTES_PADRAO;
+  escritorRegistro.limiteTempo = DESCARGA_CARTAO_TEMPO_PADRAO;
+  escritorRegistro.espacoLivre = (Tuint64)(SD.totalBytes() - SD.usedBytes());
+  escritorRegistro.tamanhoPrealocacao = 0;
+  escritorRegistro.prealocado = FALSO;
+  escritorRegistro.mdf = FALSO;
+
+  // Após o sucesso da conexão mostrar detalhes
+  PRINTLN("\n");
+  PRINTLN("Cartão encontrado e pronto para ser utilizado!!!\r\n");
+
+  return erro;
+}
+
+/**
+ * @brief  Funçãoo que recupera o tamanho do arquivo desejado 
+ * @param  caminho: Caminho do arquivo que se deseja obter o tamanho 
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_tamanhoArquivo(char *caminho, Tuint32 *tamanho){
+  File arquivo;
+
+  arquivo = SD.open(caminho,FILE_READ);
+  if(!arquivo){
+    return ERRO_ABRIR_CARTAO_PARA_LEITURA;
+  }
+  *tamanho = arquivo.size();
+
+  arquivo.close();
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que obtem o caminho do indice de um arquivo de registro: o mesmo nome com a
+ *         extensão EXTENSAO_ARQUIVO_INDICE
+ * @param  destino: recebe o caminho do indice (TAMANHO_MAXIMO_NOME_ARQUIVO bytes)
+ * @param  caminho: Caminho do arquivo de registro
+ * @return void
+ */
+void gerenciamentoCartao_caminhoIndice(char *destino, const char *caminho){
+  char *extensao;
+
+  (void)strncpy(destino, caminho, (TAMANHO_MAXIMO_NOME_ARQUIVO - 1));
+  destino[TAMANHO_MAXIMO_NOME_ARQUIVO - 1] = '\0';
+  extensao = strrchr(destino, '.');
+  if((extensao == NULL) || (strchr(extensao, '/') != NULL)){
+    extensao = &destino[strlen(destino)];
+  }
+  // A extensão do indice nunca é maior que a dos registros (.txt, .bin, .pcap e .mf4)
+  if((Tuint32)((extensao - destino) + strlen(EXTENSAO_ARQUIVO_INDICE)) < TAMANHO_MAXIMO_NOME_ARQUIVO){
+    (void)strcpy(extensao, EXTENSAO_ARQUIVO_INDICE);
+  }
+}
+
+/**
+ * @brief  Funçãoo que cria um arquivo de acordo com caminho especificado
+ * @param  caminho: Caminho do arquivo que se deseja obter o tamanho 
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_criaArquivo(char *caminho){  
+  File arquivo;
+  char caminhoIndice[TAMANHO_MAXIMO_NOME_ARQUIVO];
+
+  arquivo = SD.open(caminho,FILE_WRITE);
+  if(!arquivo){
+    return ERRO_ABRIR_CARTAO_PARA_LEITURA;
+  }
+
+  arquivo.close();
+
+  // O indice é acrescentado ao longo da captura, um indice antigo com o mesmo nome é descartado
+  gerenciamentoCartao_caminhoIndice(caminhoIndice, caminho);
+  if(SD.exists(caminhoIndice)){
+    (void)SD.remove(caminhoIndice);
+  }
+
+  // Se chegou até aqui entao tudo ok
+  return SUCESSO;
+}
+
+/**
+ * @brief  Funçãoo que verifica se ha espaço livre para provavel escrita no cartao. Usa o espaço
+ *         calculado na montagem menos o que foi escrito depois dela. A alocação por cluster da FAT
+ *         fica dentro da margem de TAMANHO_BUFFER_10M
+ * @param  tamanho: quantidade de bytes que se deseja escrever
+ * @return VERDADEIRO OU FALSO
+ */
+static Tbool gerencimanentoCartao_haEspacoLivre(Tuint32 tamanho){
+  return (escritorRegistro.espacoLivre > ((Tuint64)TAMANHO_BUFFER_10M + tamanho));
+}
+
+/**
+ * @brief  Função que configura a politica de flush do arquivo de registro
+ * @param  limiteBytes: bytes pendentes que forçam o flush (0 = a cada escrita)
+ * @param  limiteTempo: tempo maximo sem flush (ms)
+ * @return void
+ */
+void gerenciamentoCartao_configuraDescarga(Tuint32 limiteBytes, Tuint32 limiteTempo){
+  escritorRegistro.limiteBytes = limiteBytes;
+  escritorRegistro.limiteTempo = limiteTempo;
+}
+
+/**
+ * @brief  Função que configura a prealocação dos arquivos de registro novos
+ * @param  tamanho: tamanho prealocado de cada arquivo (bytes), 0 desativa
+ * @return void
+ */
+void gerenciamentoCartao_configuraPrealocacao(Tuint32 tamanho){
+  escritorRegistro.tamanhoPrealocacao = tamanho;
+}
+
+/**
+ * @brief  Função que formata o cabeçalho do arquivo prealocado: uma linha com o tamanho logico,
+ *         completada com espaços até ocupar exatamente um setor
+ * @param  cabecalho: recebe TAMANHO_REGISTRO_PREALOCADO bytes (sem terminador)
+ * @param  tamanhoLogico: bytes validos do arquivo, incluindo o cabeçalho
+ * @return void
+ */
+static void gerenciamentoCartao_formataCabecalho(char *cabecalho, Tuint32 tamanhoLogico){
+  int tamanho;
+
+  (void)memset(cabecalho, ' ', TAMANHO_REGISTRO_PREALOCADO);
+  tamanho = sprintf(cabecalho, PREFIXO_REGISTRO_PREALOCADO "%010u", tamanhoLogico);
+  cabecalho[tamanho] = ' ';
+  cabecalho[TAMANHO_REGISTRO_PREALOCADO - 2] = '\r';
+  cabecalho[TAMANHO_REGISTRO_PREALOCADO - 1] = '\n';
+}
+
+/**
+ * @brief  Função que le o tamanho logico do cabeçalho de um arquivo prealocado
+ * @param  arquivo: arquivo aberto para leitura
+ * @param  tamanhoLogico: recebe os bytes validos do arquivo
+ * @return VERDADEIRO se o arquivo tem um cabeçalho valido
+ */
+static Tbool gerenciamentoCartao_leCabecalho(File *arquivo, Tuint32 *tamanhoLogico){
+  char cabecalho[TAMANHO_LEITURA_CABECALHO + 1];
+  char *fim;
+
+  if((!arquivo->seek(0)) || 
+     (arquivo->read((Tuint8 *)cabecalho, TAMANHO_LEITURA_CABECALHO) != TAMANHO_LEITURA_CABECALHO)){
+    return FALSO;
+  }
+  cabecalho[TAMANHO_LEITURA_CABECALHO] = '\0';
+
+  if(strncmp(cabecalho, PREFIXO_REGISTRO_PREALOCADO, strlen(PREFIXO_REGISTRO_PREALOCADO)) != 0){
+    return FALSO;
+  }
+  *tamanhoLogico = (Tuint32)strtoul(&cabecalho[strlen(PREFIXO_REGISTRO_PREALOCADO)], &fim, 10);
+
+  return ((*fim == ' ') && (*tamanhoLogico >= TAMANHO_REGISTRO_PREALOCADO));
+}
+
+/**
+ * @brief  Função que verifica pela extensão se o arquivo de registro é MF4
+ * @param  caminho: Caminho do arquivo de registro
+ * @return VERDADEIRO OU FALSO
+ */
+static Tbool gerenciamentoCartao_registroMdf(const char *caminho){
+  size_t tamanho = strlen(caminho);
+
+  return ((tamanho >= strlen(EXTENSAO_ARQUIVO_MDF)) && 
+          (strcmp(&caminho[tamanho - strlen(EXTENSAO_ARQUIVO_MDF)], EXTENSAO_ARQUIVO_MDF) == 0));
+}
+
+/**
+ * @brief  Função que corrige os campos do MF4 que dependem da quantidade de registros: o tamanho
+ *         do DT e, na finalização, os ciclos do CG e a identificação do arquivo
+ * @param  arquivo: arquivo MF4 aberto para escrita
+ * @param  tamanhoLogico: bytes validos do arquivo (a partir de TAMANHO_CABECALHO_MDF)
+ * @param  finalizado: VERDADEIRO para finalizar o arquivo
+ * @return void
+ */
+static void gerenciamentoCartao_atualizaMdf(File *arquivo, Tuint32 tamanhoLogico, Tbool finalizado){
+  Tuint8 campo[TAMANHO_IDENTIFICACAO_MDF];
+
+  formatoBinario_escreveInteiro(campo, (tamanhoLogico - ENDERECO_DT_MDF), 8);
+  (void)arquivo->seek(ENDERECO_TAMANHO_DT_MDF);
+  (void)arquivo->write(campo, 8);
+  if(finalizado){
+    formatoBinario_escreveInteiro(campo, ((tamanhoLogico - TAMANHO_CABECALHO_MDF) / TAMANHO_REGISTRO_MDF), 8);
+    (void)arquivo->seek(ENDERECO_CICLOS_CG_MDF);
+    (void)arquivo->write(campo, 8);
+    registroMdf_formataIdentificacao(campo, VERDADEIRO);
+    (void)arquivo->seek(0);
+    (void)arquivo->write(campo, TAMANHO_IDENTIFICACAO_MDF);
+  }
+}
+
+/**
+ * @brief  Função que atualiza o cabeçalho do arquivo de registro aberto com o tamanho logico atual.
+ *         No MF4 o tamanho fica no proprio DT, o arquivo nao tem o setor de cabeçalho
+ * @return void
+ */
+static void gerenciamentoCartao_escreveCabecalho(void){
+  char cabecalho[TAMANHO_REGISTRO_PREALOCADO];
+
+  if(escritorRegistro.mdf){
+    // Os blocos de descrição chegam no primeiro buffer, antes deles nao ha o que corrigir
+    if(escritorRegistro.tamanhoLogico >= TAMANHO_CABECALHO_MDF){
+      gerenciamentoCartao_atualizaMdf(&(escritorRegistro.arquivo), escritorRegistro.tamanhoLogico, FALSO);
+    }
+  }else{
+    gerenciamentoCartao_formataCabecalho(cabecalho, escritorRegistro.tamanhoLogico);
+    (void)escritorRegistro.arquivo.seek(0);
+    (void)escritorRegistro.arquivo.write((const Tuint8 *)cabecalho, TAMANHO_REGISTRO_PREALOCADO);
+  }
+  (void)escritorRegistro.arquivo.seek(escritorRegistro.tamanhoLogico);
+}
+
+/**
+ * @brief  Função que reduz o arquivo ao tamanho logico, devolvendo ao cartao a parte prealocada
+ *         que nao foi usada. A API de arquivos do Arduino nao tem truncate, o VFS do ESP-IDF tem
+ * @param  caminho: Caminho do arquivo (fechado)
+ * @param  tamanho: novo tamanho do arquivo
+ * @return ERRO_ABRIR_CARTAO_PARA_ESCRITA ou SUCESSO
+ */
+static Terro gerenciamentoCartao_truncaArquivo(const char *caminho, Tuint32 tamanho){
+  char caminhoVFS[sizeof(PONTO_MONTAGEM_CARTAO) + TAMANHO_MAXIMO_NOME_ARQUIVO];
+
+  (void)sprintf(caminhoVFS, "%s%s", PONTO_MONTAGEM_CARTAO, caminho);
+
+  return ((truncate(caminhoVFS, (off_t)tamanho) == 0) ? SUCESSO : ERRO_ABRIR_CARTAO_PARA_ESCRITA);
+}
+
+/**
+ * @brief  Função que prealoca o arquivo de registro aberto (vazio). Posicionar alem do fim e 
+ *         escrever um byte faz a FAT alocar todos os clusters de uma vez, na troca de arquivo,
+ *         e nao um cluster a cada escrita
+ * @return ERRO_ABRIR_CARTAO_PARA_ESCRITA ou SUCESSO (sem espaço o arquivo cresce normalmente)
+ */
+static Terro gerenciamentoCartao_prealoca(void){
+  Tuint32 tamanho = escritorRegistro.tamanhoPrealocacao;
+  Tuint8 ultimoByte = 0;
+
+  if((tamanho <= TAMANHO_REGISTRO_PREALOCADO) || (!gerencimanentoCartao_haEspacoLivre(tamanho))){
+    return SUCESSO;
+  }
+
+  // O MF4 começa pela identificação, os dados validos sao marcados pelo tamanho do DT
+  if(escritorRegistro.mdf){
+    escritorRegistro.tamanhoLogico = 0;
+  }else{
+    escritorRegistro.tamanhoLogico = TAMANHO_REGISTRO_PREALOCADO;
+    gerenciamentoCartao_escreveCabecalho();
+  }
+  if((!escritorRegistro.arquivo.seek(tamanho - 1)) || (escritorRegistro.arquivo.write(ultimoByte) != 1)){
+    return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
+  }
+  escritorRegistro.arquivo.flush();
+  (void)escritorRegistro.arquivo.seek(escritorRegistro.tamanhoLogico);
+
+  escritorRegistro.prealocado = VERDADEIRO;
+  escritorRegistro.tamanhoFisico = tamanho;
+  escritorRegistro.espacoLivre -= tamanho;
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que faz o flush do arquivo de registro aberto se a politica exigir. No arquivo
+ *         prealocado e no MF4 o cabeçalho é atualizado junto, para que o tamanho logico sobreviva
+ *         a uma queda de energia
+ * @param  forcado: VERDADEIRO para fazer o flush independente da politica
+ * @return void
+ */
+void gerenciamentoCartao_descarregaRegistro(Tbool forcado){
+  if((!escritorRegistro.arquivo) || (escritorRegistro.bytesPendentes == 0)){
+    escritorRegistro.ultimaDescarga = millis();
+    return;
+  }
+  if(forcado || 
+     (escritorRegistro.bytesPendentes >= escritorRegistro.limiteBytes) ||
+     ((millis() - escritorRegistro.ultimaDescarga) >= escritorRegistro.limiteTempo)){
+    escritorRegistro.arquivo.flush();
+    if(escritorRegistro.prealocado || escritorRegistro.mdf){
+      gerenciamentoCartao_escreveCabecalho();
+      escritorRegistro.arquivo.flush();
+    }
+    if(escritorRegistro.indice){
+      escritorRegistro.indice.flush();
+    }
+    escritorRegistro.bytesPendentes = 0;
+    escritorRegistro.ultimaDescarga = millis();
+  }
+}
+
+/**
+ * @brief  Função que faz o flush e fecha o arquivo de registro aberto e o seu indice. O arquivo
+ *         prealocado recebe o tamanho logico final e é reduzido a ele. O MF4 é finalizado, na troca
+ *         de arquivo ou no fim da captura
+ * @return void
+ */
+void gerenciamentoCartao_fechaRegistro(void){
+  if(escritorRegistro.indice){
+    escritorRegistro.indice.flush();
+    escritorRegistro.indice.close();
+  }
+  escritorRegistro.caminhoIndice[0] = '\0';
+
+  if(escritorRegistro.arquivo){
+    if(escritorRegistro.mdf){
+      if(escritorRegistro.tamanhoLogico >= TAMANHO_CABECALHO_MDF){
+        gerenciamentoCartao_atualizaMdf(&(escritorRegistro.arquivo), escritorRegistro.tamanhoLogico, VERDADEIRO);
+      }
+    }else if(escritorRegistro.prealocado){
+      gerenciamentoCartao_escreveCabecalho();
+    }
+    escritorRegistro.arquivo.flush();
+    escritorRegistro.arquivo.close();
+
+    if(escritorRegistro.prealocado && (escritorRegistro.tamanhoLogico < escritorRegistro.tamanhoFisico)){
+      // Se falhar o cabeçalho continua indicando onde terminam os dados
+      if(gerenciamentoCartao_truncaArquivo(escritorRegistro.caminho, escritorRegistro.tamanhoLogico) == SUCESSO){
+        escritorRegistro.espacoLivre += (escritorRegistro.tamanhoFisico - escritorRegistro.tamanhoLogico);
+      }
+    }
+  }
+  escritorRegistro.caminho[0] = '\0';
+  escritorRegistro.bytesPendentes = 0;
+  escritorRegistro.prealocado = FALSO;
+  escritorRegistro.mdf = FALSO;
+}
+
+/**
+ * @brief  Função que abre (ou cria) o arquivo de registro e o mantem aberto para as proximas
+ *         escritas. O arquivo aberto anteriormente é fechado, usado tambem na troca de arquivo.
+ *         Com a prealocação ativa um arquivo vazio é prealocado e um arquivo com cabeçalho
+ *         continua depois do tamanho logico. O MF4 sempre é aberto para escrita no meio do
+ *         arquivo, os seus campos sao corrigidos durante a gravação
+ * @param  caminho: Caminho do arquivo de registro
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_abreRegistro(const char *caminho){
+  Terro erro = SUCESSO;
+  File arquivo;
+  Tuint32 tamanhoArquivo;
+  Tuint32 tamanhoLogico;
+  Tuint8 campo[TAMANHO_IDENTIFICACAO_MDF];
+
+  gerenciamentoCartao_fechaRegistro();
+
+  if(strlen(caminho) >= TAMANHO_MAXIMO_NOME_ARQUIVO){
+    return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
+  }
+  escritorRegistro.mdf = gerenciamentoCartao_registroMdf(caminho);
+
+  if((escritorRegistro.tamanhoPrealocacao == 0) && (!escritorRegistro.mdf)){
+    escritorRegistro.arquivo = SD.open(caminho, FILE_APPEND);
+    if(!escritorRegistro.arquivo){
+      return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
+    }
+  }else{
+    // "r+" escreve dentro da região prealocada, o FILE_APPEND sempre escreveria depois dela
+    if(!SD.exists(caminho)){
+      arquivo = SD.open(caminho, FILE_WRITE);
+      if(!arquivo){
+        return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
+      }
+      arquivo.close();
+    }
+    escritorRegistro.arquivo = SD.open(caminho, "r+");
+    if(!escritorRegistro.arquivo){
+      return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
+    }
+
+    tamanhoArquivo = escritorRegistro.arquivo.size();
+    if(tamanhoArquivo == 0){
+      escritorRegistro.tamanhoLogico = 0;
+      erro = gerenciamentoCartao_prealoca();
+    }else if(escritorRegistro.mdf){
+      // MF4 reaberto (erro de escrita anterior): continua depois do ultimo registro do DT e
+      // volta a ser um arquivo nao finalizado
+      tamanhoLogico = 0;
+      if(escritorRegistro.arquivo.seek(ENDERECO_TAMANHO_DT_MDF) && 
+         (escritorRegistro.arquivo.read(campo, 8) == 8)){
+        tamanhoLogico = registroMdf_tamanhoLogico(formatoBinario_leInteiro(campo, 8), tamanhoArquivo);
+      }
+      if(tamanhoLogico == 0){
+        tamanhoLogico = tamanhoArquivo;
+      }else{
+        registroMdf_formataIdentificacao(campo, FALSO);
+        (void)escritorRegistro.arquivo.seek(0);
+        (void)escritorRegistro.arquivo.write(campo, TAMANHO_IDENTIFICACAO_MDF);
+      }
+      escritorRegistro.prealocado = (tamanhoLogico < tamanhoArquivo);
+      escritorRegistro.tamanhoLogico = tamanhoLogico;
+      escritorRegistro.tamanhoFisico = tamanhoArquivo;
+      (void)escritorRegistro.arquivo.seek(tamanhoLogico);
+    }else if(gerenciamentoCartao_leCabecalho(&(escritorRegistro.arquivo), &tamanhoLogico) && 
+             (tamanhoLogico <= tamanhoArquivo)){
+      escritorRegistro.prealocado = VERDADEIRO;
+      escritorRegistro.tamanhoLogico = tamanhoLogico;
+      escritorRegistro.tamanhoFisico = tamanhoArquivo;
+      (void)escritorRegistro.arquivo.seek(tamanhoLogico);
+    }else{
+      // Arquivo sem cabeçalho, criado sem prealocação: continua no fim
+      (void)escritorRegistro.arquivo.seek(tamanhoArquivo);
+    }
+    if(erro != SUCESSO){
+      escritorRegistro.arquivo.close();
+      escritorRegistro.prealocado = FALSO;
+      escritorRegistro.mdf = FALSO;
+      return erro;
+    }
+  }
+
+  (void)strcpy(escritorRegistro.caminho, caminho);
+  escritorRegistro.ultimaDescarga = millis();
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que finaliza um MF4 que nao foi fechado (queda de energia): o arquivo termina no
+ *         ultimo registro completo do DT gravado no ultimo flush e recebe os ciclos do CG
+ * @param  caminho: Caminho do arquivo de registro
+ * @param  tamanhoLogico: recebe os bytes validos do arquivo, 0 se nao houver o que finalizar
+ * @return VERDADEIRO se o arquivo foi finalizado
+ */
+static Tbool gerenciamentoCartao_finalizaMdf(char *caminho, Tuint32 *tamanhoLogico){
+  File arquivo;
+  Tuint8 campo[8];
+  Tbool finalizado = FALSO;
+
+  *tamanhoLogico = 0;
+  arquivo = SD.open(caminho, "r+");
+  if(!arquivo){
+    return FALSO;
+  }
+  if((arquivo.read(campo, 8) == 8) && (!registroMdf_finalizado(campo)) &&
+     arquivo.seek(ENDERECO_TAMANHO_DT_MDF) && (arquivo.read(campo, 8) == 8)){
+    *tamanhoLogico = registroMdf_tamanhoLogico(formatoBinario_leInteiro(campo, 8), arquivo.size());
+    if(*tamanhoLogico > 0){
+      gerenciamentoCartao_atualizaMdf(&arquivo, *tamanhoLogico, VERDADEIRO);
+      finalizado = VERDADEIRO;
+    }
+  }
+  arquivo.close();
+
+  return finalizado;
+}
+
+/**
+ * @brief  Função que finaliza um arquivo prealocado que nao foi fechado (queda de energia),
+ *         reduzindo-o ao tamanho logico do cabeçalho. Arquivos sem cabeçalho nao sao alterados.
+ *         O MF4 nao finalizado recebe os campos que dependem da quantidade de registros
+ * @param  caminho: Caminho do arquivo de registro
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_recuperaRegistro(char *caminho){
+  Terro erro = SUCESSO;
+  File arquivo;
+  Tuint32 tamanhoArquivo;
+  Tuint32 tamanhoLogico;
+  Tbool valido;
+
+  arquivo = SD.open(caminho, FILE_READ);
+  if(!arquivo){
+    return ERRO_ABRIR_CARTAO_PARA_LEITURA;
+  }
+  tamanhoArquivo = arquivo.size();
+  valido = ((!gerenciamentoCartao_registroMdf(caminho)) && gerenciamentoCartao_leCabecalho(&arquivo, &tamanhoLogico));
+  arquivo.close();
+
+  if(gerenciamentoCartao_registroMdf(caminho)){
+    valido = gerenciamentoCartao_finalizaMdf(caminho, &tamanhoLogico);
+  }
+
+  if(valido && (tamanhoLogico < tamanhoArquivo)){
+    erro = gerenciamentoCartao_truncaArquivo(caminho, tamanhoLogico);
+    if(erro == SUCESSO){
+      escritorRegistro.espacoLivre += (tamanhoArquivo - tamanhoLogico);
+    }
+  }
+
+  return erro;
+}
+
+/**
+ * @brief  Função que acrescenta dados ao arquivo de registro. O arquivo é mantido aberto entre as 
+ *         escritas e o flush segue a politica configurada
+ * @param  dados: dados que serão escritos
+ * @param  tamanho: quantidade de bytes
+ * @param  caminho: Caminho do arquivo de registro
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_escreveRegistro(const Tuint8 *dados, Tuint32 tamanho, const char *caminho){
+  Terro erro = SUCESSO;
+  size_t escrito;
+
+  // Reabre somente se o arquivo mudou ou se foi fechado por um erro anterior
+  if((!escritorRegistro.arquivo) || (strcmp(escritorRegistro.caminho, caminho) != 0)){
+    erro = gerenciamentoCartao_abreRegistro(caminho);
+    if(erro != SUCESSO){
+      return erro;
+    }
+  }
+
+  /// Somente se couber no cartao pode ser atualizado. Dentro da região prealocada o espaço ja foi descontado
+  if((!escritorRegistro.prealocado || ((escritorRegistro.tamanhoLogico + tamanho) > escritorRegistro.tamanhoFisico)) &&
+     (!gerencimanentoCartao_haEspacoLivre(tamanho))){ 
+    return ERRO_LIMITE_EXCEDIDO_CARTAO_MEMORIA; 
+  }
+
+  escrito = escritorRegistro.arquivo.write(dados, tamanho);
+  if(escritorRegistro.prealocado){
+    escritorRegistro.tamanhoLogico += escrito;
+    if(escritorRegistro.tamanhoLogico > escritorRegistro.tamanhoFisico){
+      escritorRegistro.espacoLivre -= (escritorRegistro.tamanhoLogico - escritorRegistro.tamanhoFisico);
+      escritorRegistro.tamanhoFisico = escritorRegistro.tamanhoLogico;
+    }
+  }else{
+    escritorRegistro.espacoLivre -= escrito;
+    if(escritorRegistro.mdf){
+      escritorRegistro.tamanhoLogico += escrito;
+    }
+  }
+  if(escrito != tamanho){
+    // Fecha para que a proxima tentativa reabra o arquivo
+    gerenciamentoCartao_fechaRegistro();
+    return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
+  }
+
+  escritorRegistro.bytesPendentes += escrito;
+  gerenciamentoCartao_descarregaRegistro(FALSO);
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que acrescenta bytes ao indice do arquivo de registro (formato_indice.h). O indice
+ *         fica aberto junto do registro e é fechado com ele
+ * @param  dados: bytes do indice
+ * @param  tamanho: quantidade de bytes
+ * @param  caminho: Caminho do arquivo de registro indexado
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_escreveIndice(const Tuint8 *dados, Tuint32 tamanho, const char *caminho){
+  char caminhoIndice[TAMANHO_MAXIMO_NOME_ARQUIVO];
+  size_t escrito;
+
+  gerenciamentoCartao_caminhoIndice(caminhoIndice, caminho);
+  if((!escritorRegistro.indice) || (strcmp(escritorRegistro.caminhoIndice, caminhoIndice) != 0)){
+    if(escritorRegistro.indice){
+      escritorRegistro.indice.close();
+    }
+    escritorRegistro.indice = SD.open(caminhoIndice, FILE_APPEND);
+    if(!escritorRegistro.indice){
+      escritorRegistro.caminhoIndice[0] = '\0';
+      return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
+    }
+    (void)strcpy(escritorRegistro.caminhoIndice, caminhoIndice);
+  }
+
+  if(!gerencimanentoCartao_haEspacoLivre(tamanho)){
+    return ERRO_LIMITE_EXCEDIDO_CARTAO_MEMORIA;
+  }
+
+  escrito = escritorRegistro.indice.write(dados, tamanho);
+  escritorRegistro.espacoLivre -= escrito;
+  if(escrito != tamanho){
+    escritorRegistro.indice.close();
+    escritorRegistro.caminhoIndice[0] = '\0';
+    return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
+  }
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que escreve uma string no caminho especificado. No modo append o texto vai para
+ *         o arquivo de registro aberto (ver gerenciamentoCartao_escreveRegistro)
+ * @param  texto: string que será escrita
+ * @param  caminho: Caminho do arquivo
+ * @param  modo: eModoWrite (sobrescreve) ou eModoAppend (acrescenta)
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_escreve(char *texto, const char *caminho, TmodoEscrita modo){
+  File arquivo;
+  size_t tamanho = strlen(texto);
+  size_t escrito;
+
+  if(modo == eModoAppend){
+    return gerenciamentoCartao_escreveRegistro((const Tuint8 *)texto, tamanho, caminho);
+  }
+  
+  /// Somente se couber no cartao pode ser atualizado
+  if(!gerencimanentoCartao_haEspacoLivre(tamanho)){ 
+    return ERRO_LIMITE_EXCEDIDO_CARTAO_MEMORIA; 
+  }
+
+  arquivo = SD.open(caminho,FILE_WRITE);
+  if(!arquivo){
+    return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
+  }  
+
+  escrito = arquivo.print(texto);
+  arquivo.close();   
+  if(escrito == 0){
+    return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
+  }
+  escritorRegistro.espacoLivre -= escrito;
+  
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que escreve o ultimo arquivo de registro criado no diretorio system,
+ *         para controle do sistema
+ * @param  id: identificador do ultimo arquivo
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_atualizaLastFile(Tuint32 id){
+  Terro erro = SUCESSO;
+  File arquivo;
+  char buffer[100];
+
+  arquivo = SD.open(NOME_ARQUIVO_REGISTRO_INTERNO, FILE_WRITE);
+  if(!arquivo){
+    return ERRO_ABRIR_CARTAO_PARA_ESCRITA;
+  }
+
+  (void)sprintf(
+    buffer, 
+    "Sniffer CAN / Versão 1.0 / EMANOEL GOMES SANTOS\nLast File: \"%d\"",
+    id
+  );
+
+  arquivo.print(buffer);
+
+  arquivo.close();
+ 
+  return erro;
+}
+
+/**
+ * @brief  Função que busca uma informação no dump completo do arquivo de configuração,
+ * @param  texto: dump completo do arquivo de configuração
+ * @param  indice: indice que se deseja encontrar ex: "login:"
+ * @param  infoEncontrada: Informação encontrada
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_escreveInformacao(String texto, const char *indice, String informacao){
+  Tuint32 i;
+  char buffer[500];
+  
+  i = 0;
+
+  // Busca string indice
+  while(texto[i] != '\0'){
+    if(memcmp(&texto[i], indice, strlen(indice)) == 0 ){
+      i += strlen(indice);
+      break;
+    }
+    i++;
+  }
+  // Se o laço chegou até o final significa que nao encontrou indice
+  if(texto[i]  == '\0'){
+    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+  }
+
+  texto[i] = ' ';
+  i++;
+  texto[i] = '\"';
+  i++;
+
+  (void)memcpy(&texto[i],&informacao[0], informacao.length());
+  texto[i+informacao.length()+0] = '\"';
+  texto[i+informacao.length()+1] = '\r';
+  texto[i+informacao.length()+2] = '\n';
+
+  texto.toCharArray(buffer,500);
+  
+
+  return gerenciamentoCartao_escreve(buffer,NOME_ARQUIVO_CONFIGURACAO, eModoWrite);
+
+}
+
+/**
+ * @brief  Função que busca uma informação no dump completo do arquivo de configuração,
+ * @param  texto: dump completo do arquivo de configuração
+ * @param  indice: indice que se deseja encontrar ex: "login:"
+ * @param  infoEncontrada: Informação encontrada
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_buscaInformacao(String texto, const char *indice, String *infoEncontrada){
+  Terro erro = SUCESSO;
+  Tuint32 i, posicao;
+  char buffer[TAMANHO_MAXIMO_INFORMACAO_CONFIG];
+  
+  i = 0;
+  posicao = 0;
+
+  // Busca string Login
+  while(texto[i] != '\0'){
+    if(memcmp(&texto[i], indice, strlen(indice)) == 0 ){
+      i += strlen(indice);
+      break;
+    }
+    i++;
+  }
+  // Se o laço chegou até o final significa que nao encontrou "Login"
+  if(texto[i]  == '\0'){
+    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+  }
+  // Tenta encontrar primeiras aspas
+  while(texto[i] != '\0'){
+    if(texto[i] == '\"'){ 
+      i++;
+      break; 
+    }
+    i++;
+  }
+  
+  // Se o laço chegou até o final significa que nao encontrou as primeiras aspas obrigatória
+  if(texto[i]  == '\0'){
+    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+  }
+  
+  posicao = 0;
+  // Armazena informação completa entre as aspas
+  while((texto[i] != '\"') && (texto[i] != '\0')){
+    if(posicao >= (TAMANHO_MAXIMO_INFORMACAO_CONFIG - 1)){
+      return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+    }
+    buffer[posicao] = texto[i];
+    i++;
+    posicao ++;
+  }
+
+
+  if(texto[i] == '\"'){ 
+    if(posicao == 0){
+      (void)strcpy(buffer,"---");      
+    }else{
+      buffer[posicao] = '\0';    
+    }
+  }else{
+    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+  }
+
+  // SALVA INFORMAÇÃO ENCONTRADA
+  *infoEncontrada = buffer;
+    
+  return erro;
+}
+
+/**
+ * @brief  Função que obtem o id do ultimo arquivo registrado no dump
+ * @param  idArquivo: variável que receberá o ultimo ID
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_obtemUltimoIdArquivoRegistro(Tuint16 *idArquivo){   
+  Terro erro = SUCESSO;  
+  File arquivo;
+  String buffer;  
+  String valor;
+  const char lastString [] {"Last File:"};
+  
+  // Abre arquivo para leitura
+  arquivo = SD.open(NOME_ARQUIVO_REGISTRO_INTERNO, FILE_READ);
+  if(!arquivo){
+    return ERRO_LEITURA_CARTAO;
+  }
+
+  buffer = arquivo.readString();
+    
+  // Busca informação do arquivo system Last File:
+  erro = gerenciamentoCartao_buscaInformacao(buffer,lastString,&valor);
+  if(erro != SUCESSO){
+    return erro;
+  }
+  
+  *idArquivo = ((Tuint32)valor.toInt());
+
+  // Se chegou até aqui então tudo ocorreu bem
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que obtem o login e a senha recuperados do arquivo de configuração
+ * @param  configuracaoWifi: Estrutura que armazenará a informação
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_obtemLoginSenha(PTwifiConfig configuracaoWifi){
+  Terro erro = SUCESSO;
+  File arquivo;
+  String texto;
+  const char login[] = {"Login:"};
+  const char senha[] = {"Senha:"};
+  String buffer;
+
+  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
+  if(!arquivo){
+    return ERRO_LEITURA_CARTAO;
+  }
+  texto = arquivo.readString();
+  arquivo.close(); 
+
+  // Busca informação do login
+  erro = gerenciamentoCartao_buscaInformacao(texto,login,&buffer);
+  if(erro != SUCESSO){
+    return erro;
+  }
+  
+
+  buffer.toCharArray(configuracaoWifi->login, TAMANHO_MAXIMO_LOGIN);
+  
+  // Busca informação da senha
+  erro = gerenciamentoCartao_buscaInformacao(texto,senha,&buffer);
+  if(erro != SUCESSO){
+    return erro;
+  }
+  buffer.toCharArray(configuracaoWifi->senha, TAMANHO_MAXIMO_SENHA);
+
+  return erro;
+}
+/**
+ * @brief  Função que obtem a URL do servidor recuperadoa do arquivo de configuração
+ * @param  servidor: Estrutura que armazenará a informação
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_obtemURLServidor(PTservidor servidor){
+  Terro erro = SUCESSO;
+  File arquivo;
+  String texto;
+  const char url_registro[] = {"URL Registros:"};
+  const char url_taxa[]     = {"URL Taxa:"};
+  const char url_filtros[]  = {"URL Filtros:"};
+  String buffer;
+  char userAndPassword[TAMANHO_SENHA_E_SERIAL];
+
+    // Cria string de user and password
+  (void)sprintf(userAndPassword, "&%s&%s", SERIAL_SNIFFER_CAN,SENHA_SNIFFER_CAN);
+
+  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
+  if(!arquivo){
+    return ERRO_LEITURA_CARTAO;
+  }
+  texto = arquivo.readString();
+  arquivo.close(); 
+
+  // Busca informação do login
+  erro = gerenciamentoCartao_buscaInformacao(texto,url_registro,&buffer);
+  if(erro != SUCESSO){
+    return erro;
+  } 
+  buffer.toCharArray(servidor->reg, TAMANHO_MAXIMO_URL);
+
+  (void)strcat(servidor->reg,userAndPassword);
+
+  // Busca informação do login
+  erro = gerenciamentoCartao_buscaInformacao(texto,url_taxa,&buffer);
+  if(erro != SUCESSO){
+    return erro;
+  } 
+  buffer.toCharArray(servidor->taxa, TAMANHO_MAXIMO_URL); 
+  
+  (void)strcat(servidor->taxa,userAndPassword);   
+
+  // Busca informação do login
+  erro = gerenciamentoCartao_buscaInformacao(texto,url_filtros,&buffer);
+  if(erro != SUCESSO){
+    return erro;
+  } 
+  buffer.toCharArray(servidor->filtro, TAMANHO_MAXIMO_URL);
+
+  
+  (void)strcat(servidor->filtro,userAndPassword);     
+
+  return erro;
+}
+
+
+/**
+ * @brief  Função que valida se a informação inserida no arquivo de configuração 
+ *         é de fato um identificador válido
+ * @param  id: identificador
+ * @return VERDADEIRO OU FALSO
+ */
+static Tbool ehIdentificador(char *id){
+  if((*id >= '0') && (*id <= '9') ){
+    return VERDADEIRO;
+  }
+  if((*id >= 'A') && (*id <= 'F')){
+    return VERDADEIRO;
+  }
+  if((*id == 'x') || (*id == 'X')){
+    if(*id == 'x')*id -= 0x20; 
+    return VERDADEIRO;
+  }
+  if((*id >= 'a') && (*id <= 'f')){
+    *id -= 0x20;  
+    return VERDADEIRO;
+  }
+
+  return FALSO;
+}
+
+/**
+ * @brief  Função que verifica se o filtro é de mascará ou padrão 
+ * @param  filtroString: string com filtro
+ * @return VERDADEIRO OU FALSO
+ */
+static Tbool filtroMascarado(char *filtroString){
+  Tuint8 i;
+
+  for(i=0; i<strlen(filtroString); i++){
+    // Se for x entao é mascarado
+    if(filtroString[i] == 'X'){      
+      return VERDADEIRO;
+    }
+  }
+
+  return FALSO;  
+}
+/**
+ * @brief  Função que converte uma string em um filtro 
+ * @param  filtroString: string com filtro
+ * @return filtro convertido em hexa
+ */
+static Tuint32 converteFiltroASCIItoHex(char *filtroString){
+  Tuint8 i;
+  Tuint32 filtro = 0;
+  Tuint8 tamanho = strlen(filtroString);
+  char buffer[TAMANHO_MAX_STRING_FILTRO];
+
+  // Copio informação para buffer local para não alterar os dados.
+  (void)strcpy(buffer,filtroString);
+
+  for(i=0; i<tamanho; i++){
+    // Se for x entao é mascarado
+    if(buffer[i] == 'X'){
+      buffer[i] = '0';
+    }
+    filtro |=  (Tuint32)(((Tuint32)(ASCII_TO_HEXA(buffer[i])) << ((4*(tamanho-1)) - (4 * i))));
+  }
+  return filtro;
+  
+}
+
+Terro gerenciamentoCartao_formataListaFiltrosAndMascaras(PTlistaFiltrosAndMascaras lista, 
+                                                         String listaPossiveisFiltros){
+  Terro erro = SUCESSO;
+  Tuint32 pos;
+  Tuint32 i;
+  char filtro[TAMANHO_MAX_STRING_FILTRO];
+  Tuint8 quantFiltrosAndMask = 0;
+  char buffer[QUANTIDADE_FILTROS_E_MASCARAS][TAMANHO_MAX_STRING_FILTRO];  
+  Tuint8 quantidadeFiltrosPadrao = 0 ;
+  Tuint8 quantidadeFiltrosExtendidos = 0;
+
+ // Tratamento para situação de nenhum identificador configurado
+  if(listaPossiveisFiltros.compareTo("XXX") == 0){
+    lista->quantidade = 0;
+    return SUCESSO; 
+  }
+  if(listaPossiveisFiltros.compareTo("") == 0){
+    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+  }
+
+  // Se nao houver o ponto na ultima posição entao significa que o arquivo esta corrompido
+  /*
+  if(listaPossiveisFiltros[listaPossiveisFiltros.length() - 1] != '.'){
+    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+  }*/
+  
+  i = 0;
+  pos = 0;
+  while(listaPossiveisFiltros[i] != '\0'){
+     
+    if(listaPossiveisFiltros[i] != ';'){
+
+      // Valida se realmente é um identificador  
+      if(ehIdentificador(&listaPossiveisFiltros[i])){
+
+        filtro[pos] = (char)listaPossiveisFiltros[i];    
+        pos++;
+        i++;
+        
+        // Trata situações: filtro de 29 bits so tem 8 caracteres
+        // se for um filro de 29 bits entao o primeiro caracter devera ser obrigatoriamente menor que 2
+        // se for um filro de 11 bits entao o primeiro caracter devera ser obrigatoriamente menor que 7
+        if( (pos >= 8)                                               || 
+            ((pos == 8) && ((filtro[0] > '1') || (filtro[0] < '0'))) ||
+            ((pos == 3) && ((filtro[0] > '7') || (filtro[0] < '0')))
+          ){
+          return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+        }
+
+      }else{
+        return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;      
+      } 
+
+      // Se o proximo byte é '\0' entao tratar e sair      
+      if(listaPossiveisFiltros[i] == '\0'){
+        
+        // Finaliza filtro string
+        filtro[pos] = '\0';
+        // Verifica se algum filtro recebido é do tipo aberto, se sim apenas retornar
+        if(strcmp(filtro,"XXX") == 0){
+          lista->quantidade = 0;
+          return SUCESSO; 
+        }       
+
+        // Copia para array de filtros
+        (void)strcpy(buffer[quantFiltrosAndMask],filtro);
+        quantFiltrosAndMask ++;
+      }
+
+      
+    }
+    // Se for terminador ou separador, finaliza string
+    else {
+       // Finaliza filtro string
+       filtro[pos] = '\0';
+
+      // Verifica se algum filtro recebido é do tipo aberto, se sim apenas retornar
+       if(strcmp(filtro,"XXX") == 0){
+        lista->quantidade = 0;
+        return SUCESSO; 
+       }       
+
+       // Copia para array de filtros
+       (void)strcpy(buffer[quantFiltrosAndMask],filtro);
+
+       quantFiltrosAndMask++;
+       
+      
+      // Verifica se ultrapassou quantidade maximas de identificadores 
+      if(quantFiltrosAndMask == QUANTIDADE_FILTROS_E_MASCARAS){
+         // Sair do laço
+         break;
+      }else {
+        pos = 0;
+        i++;
+      }
+    }
+  }
+  
+  // Verifica se todos os filtros são extendido
+  for(i=0; i<quantFiltrosAndMask; i++){
+    if(strlen(buffer[i]) == (TAMANHO_MAX_STRING_FILTRO-1)){
+      quantidadeFiltrosExtendidos ++;
+    }
+  }  
+  // Verifica se todos os filtros são extendido
+  for(i=0; i<quantFiltrosAndMask; i++){
+    if(strlen(buffer[i]) == (TAMANHO_MAX_STRING_FILTRO-1)){
+      quantidadeFiltrosPadrao ++;
+    }
+  }  
+
+  // DEVERÁ TER SOMENTE filtros extendidos ou somente filtros padrao
+  if((quantidadeFiltrosExtendidos != quantFiltrosAndMask) && (quantidadeFiltrosExtendidos != 0)){
+    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+  }
+  // DEVERÁ TER SOMENTE filtros extendidos ou somente filtros padrao
+  if((quantidadeFiltrosPadrao != quantFiltrosAndMask) && (quantidadeFiltrosPadrao != 0)){
+    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+  }  
+  
+  // Tratar filtros extendidos
+  if(quantidadeFiltrosExtendidos == quantFiltrosAndMask){
+
+    lista->tipo = eExtendido;
+
+    // Encontra a mascara
+    for(i=0; i<quantFiltrosAndMask; i++){ 
+
+      if(filtroMascarado(buffer[i])){
+          lista->mascara_1 = converteFiltroASCIItoHex(buffer[i]);
+          lista->mask_1 = VERDADEIRO;     
+          return SUCESSO; 
+      }    
+    }
+    // Encontra os filtros
+    for(i=0; i<quantFiltrosAndMask; i++){ 
+
+      lista->filtros[lista->quantidade].valor = converteFiltroASCIItoHex(buffer[i]);      
+      lista->quantidade ++;
+      if(lista->quantidade == QUANTIDADE_FILTROS_MASCARA_1){
+        return SUCESSO;
+      }
+    }
+  }
+  // Tratar filtros padrao
+  else{
+
+    lista->tipo = ePadrao;
+    
+    // Encontra a mascara
+    for(i=0; i<quantFiltrosAndMask; i++){ 
+
+      if(filtroMascarado(buffer[i])){
+          lista->mascara_0 = converteFiltroASCIItoHex(buffer[i]);
+          lista->mask_0 = VERDADEIRO;     
+      }    
+    }
+
+    // Encontra os filtros
+    for(i=0; i<quantFiltrosAndMask; i++){ 
+      
+      if(!filtroMascarado(buffer[i])){
+        lista->filtros[lista->quantidade].valor = converteFiltroASCIItoHex(buffer[i]);        
+        lista->quantidade ++;
+        if(lista->quantidade == ((lista->mask_0) ? QUANTIDADE_FILTROS_MASCARA_1 : MAXIMA_QUANTIDADE_FILTROS)){
+          return SUCESSO;
+        }
+      }
+    }    
+
+  } 
+
+  return erro;  
+}
+
+/**
+ * @brief  Função que obtem uma lista de filtros e mascaras
+ * @param  lista: estrutura que irá armazenar os filtros e mascaras
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_obtemListaFiltrosAndMascaras(PTlistaFiltrosAndMascaras lista){
+  Terro erro = SUCESSO;
+  File arquivo;
+  String texto;
+  const char identificadores[] = {"Identificadores:"};
+  String listaPossiveisFiltros;
+
+  
+  // Zera quantidade da lista
+  lista->quantidade = 0;
+  
+  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
+  if(!arquivo){
+    return ERRO_LEITURA_CARTAO;
+  }
+  texto = arquivo.readString();
+  arquivo.close(); 
+
+  // Busca informação dos identificadores
+  // exemplo: 7xX.
+  erro = gerenciamentoCartao_buscaInformacao(texto,identificadores,&listaPossiveisFiltros);
+  if(erro != SUCESSO){
+    return erro;
+  }
+
+  // Formata a lista de identificadores de acordo com texto recebido
+  erro = gerenciamentoCartao_formataListaFiltrosAndMascaras(lista,listaPossiveisFiltros);
+  if(erro != SUCESSO){
+    return erro;
+  }
+  
+  return erro;
+}
+
+/**
+ * @brief  Função que obtem uma lista de filtros e mascaras
+ * @param  lista: estrutura que irá armazenar os filtros e mascaras
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_escreveListaFiltrosAndMascaras(String listaFiltrosAndMascaras){
+  Terro erro = SUCESSO;
+  File arquivo;
+  String texto;
+  const char identificadores[] = {"Identificadores:"};
+
+  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
+  if(!arquivo){
+    return ERRO_LEITURA_CARTAO;
+  }
+  texto = arquivo.readString();
+  arquivo.close(); 
+
+  // Escreve informação de filtro e mascara
+  erro = gerenciamentoCartao_escreveInformacao(texto,identificadores,listaFiltrosAndMascaras);
+  if(erro != SUCESSO){
+    return erro;
+  }
+  return erro;
+}
+
+Terro gerenciamentoCartao_verificaTaxa(PTaxaComunicacao taxa, String taxaTexto){
+  Tuint16 i;
+
+  for(i=0; i<QUANTIDADE_TAXAS_CONHECIDAS; i++){
+    if( taxaTexto.toInt() == tabela_taxas_conhecidas[i].taxa){
+      *taxa = tabela_taxas_conhecidas[i].taxa;
+      break;
+    }
+  }
+  // Significa que nao encontrou nenhuma taxa conhecida
+  if(i == QUANTIDADE_TAXAS_CONHECIDAS){
+    return ERRO_TAXA_DESCONHECIDA;
+  }
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que formata a taxa de comunicação
+ * @param  taxa: estrutura que irá armazenar a taxa de comunicação
+ * @param  textoTaxa: texto com a taxa de comunicação
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_formataTaxa(PTaxaComunicacao taxa, String textoTaxa){
+  Terro erro = SUCESSO;
+  Tuint16 i;
+
+  // Se for enviado texto erroneamente
+  if(textoTaxa.compareTo("") == 0){
+    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+  }
+
+
+  for(i=0; i<QUANTIDADE_TAXAS_CONHECIDAS; i++){
+    if(textoTaxa.compareTo(tabela_taxas_conhecidas[i].descricao) == 0){
+      *taxa = tabela_taxas_conhecidas[i].taxa;
+      break;
+    }
+  }
+  // Significa que nao encontrou nenhuma taxa conhecida
+  if(i == QUANTIDADE_TAXAS_CONHECIDAS){
+    return ERRO_TAXA_DESCONHECIDA;
+  }
+
+  return erro;
+
+}
+/**
+ * @brief  Função que obtem a taxa de comunicação apartir do arquivo de configuração
+ * @param  taxa: estrutura que irá armazenar a taxa de comunicação
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_obtemTaxaComunicacao(PTaxaComunicacao taxa){
+  Terro erro = SUCESSO;
+  File arquivo;
+  String texto;
+  const char taxaComunicacao[] = {"Taxa:"};
+  String buffer;
+  
+  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
+  if(!arquivo){
+    return ERRO_LEITURA_CARTAO;
+  }
+  texto = arquivo.readString();
+  arquivo.close(); 
+
+  // Busca informação do login
+  erro = gerenciamentoCartao_buscaInformacao(texto,taxaComunicacao,&buffer);
+  if(erro != SUCESSO){
+    return erro;
+  }   
+  // Formata texto da taxa, se nao estiver na lista de taxas conhecidas entao atribuii taxa padrao
+  erro = gerenciamentoCartao_formataTaxa(taxa, buffer);
+  if(erro != SUCESSO){
+    *taxa = TAXA_500KBPS;
+  }
+
+  return erro;
+}
+/**
+ * @brief  Função que obtem a taxa de comunicação apartir do arquivo de configuração
+ * @param  taxa: estrutura que irá armazenar a taxa de comunicação
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_escreveTaxaComunicacao(String taxa){
+  Terro erro = SUCESSO;
+  File arquivo;
+  String texto;
+  const char taxaComunicacao[] = {"Taxa:"};
+  String buffer;
+  Tuint8 i;
+  
+  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
+  if(!arquivo){
+    return ERRO_LEITURA_CARTAO;
+  }
+  texto = arquivo.readString();
+  arquivo.close();   
+
+  for(i=0; i<QUANTIDADE_TAXAS_CONHECIDAS; i++){
+    if(taxa.toInt() == tabela_taxas_conhecidas[i].taxa){
+      buffer = tabela_taxas_conhecidas[i].descricao;
+      break;
+    }
+  }
+  // Se chegou até o final e não encontrou, atribui taxa padrao
+  if(i==QUANTIDADE_TAXAS_CONHECIDAS){
+    buffer = tabela_taxas_conhecidas[POS_TAXA_DEFAULT_500_KBPS].descricao;
+  }
+
+  // Busca informação do login
+  erro = gerenciamentoCartao_escreveInformacao(texto,taxaComunicacao,buffer);
+  if(erro != SUCESSO){
+    return erro;
+  }   
+  return erro;
+}
+
+/**
+ * @brief  Função que obtem a informação se usuário deseja um log sem formatação 
+ *         ou com formatação.
+ * @param  formatado: variável que receberá se sera formatado ou nao
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_obtemDesejaFormatarLog(Tbool *formatado){
+  Terro erro = SUCESSO;
+  File arquivo;
+  String texto;
+  const char logFormatado[] = {"Log Formatado:"};
+  String buffer;
+  
+  // Abre arquivo para leitura
+  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
+  if(!arquivo){
+    return ERRO_LEITURA_CARTAO;
+  }
+  // Le arquivo inteiro e armazena em texto
+  texto = arquivo.readString();
+  // Fecha arquivo
+  arquivo.close(); 
+
+  // Busca informação do login
+  erro = gerenciamentoCartao_buscaInformacao(texto,logFormatado,&buffer);
+  if(erro != SUCESSO){
+    return erro;
+  }   
+  
+  // Somente podera ter 3 letras a resposta
+  if(buffer.length() < 3){
+    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+  }
+
+  if( ((buffer[0] == 's') || (buffer[0] == 'S')) && 
+      ((buffer[1] == 'i') || (buffer[1] == 'I')) && 
+      ((buffer[2] == 'm') || (buffer[1] == 'M'))
+    ){
+      *formatado = VERDADEIRO;
+    }else{
+      *formatado = FALSO;
+    }
+
+  return erro;
+
+}
+
+/**
+ * @brief  Função que obtem a informação se usuário deseja um log sem formatação 
+ *         ou com formatação.
+ * @param  formatado: variável que receberá se sera formatado ou nao
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_obtemDesejaMonitorSerial(Tbool *monitorSerial){
+  Terro erro = SUCESSO;
+  File arquivo;
+  String texto;
+  const char strMonitorSerial[] = {"Monitor Serial:"};
+  String buffer;
+  
+  // Abre arquivo para leitura
+  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
+  if(!arquivo){
+    return ERRO_LEITURA_CARTAO;
+  }
+  // Le arquivo inteiro e armazena em texto
+  texto = arquivo.readString();
+  // Fecha arquivo
+  arquivo.close(); 
+
+  // Busca informação do login
+  erro = gerenciamentoCartao_buscaInformacao(texto,strMonitorSerial,&buffer);
+  if(erro != SUCESSO){
+    return erro;
+  }   
+  
+  // Somente podera ter 3 letras a resposta
+  if(buffer.length() < 3){
+    return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+  }
+
+  if( ((buffer[0] == 's') || (buffer[0] == 'S')) && 
+      ((buffer[1] == 'i') || (buffer[1] == 'I')) && 
+      ((buffer[2] == 'm') || (buffer[1] == 'M'))
+    ){
+      *monitorSerial = VERDADEIRO;
+    }else{
+      *monitorSerial = FALSO;
+    }
+
+  return erro;
+
+}
+/**
+ * @brief  Função que obtem a politica da fila de mensagens quando ela estiver cheia.
+ *         Cartões gravados antes dessa opção nao possuem as chaves, nesse caso usa o padrao
+ * @param  politica: variável que receberá a politica
+ * @param  tempoBloqueio: variável que receberá o tempo maximo de espera (ms) da politica bloqueia
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_obtemPoliticaFila(PTpoliticaEstouroFila politica, Tuint32 *tempoBloqueio){
+  Terro erro = SUCESSO;
+  File arquivo;
+  String texto;
+  const char strPoliticaFila[] = {"Politica Fila:"};
+  const char strTempoBloqueio[] = {"Tempo Bloqueio Fila (ms):"};
+  String buffer;
+
+  *politica = POLITICA_FILA_PADRAO;
+  *tempoBloqueio = TEMPO_BLOQUEIO_FILA_PADRAO;
+  
+  // Abre arquivo para leitura
+  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
+  if(!arquivo){
+    return ERRO_LEITURA_CARTAO;
+  }
+  // Le arquivo inteiro e armazena em texto
+  texto = arquivo.readString();
+  // Fecha arquivo
+  arquivo.close(); 
+
+  // Busca a politica, se nao existir mantem o padrao
+  erro = gerenciamentoCartao_buscaInformacao(texto,strPoliticaFila,&buffer);
+  if(erro == SUCESSO){
+    buffer.toLowerCase();
+    if(buffer == "nova"){
+      *politica = eDescartaMaisNova;
+    }else if(buffer == "bloqueia"){
+      *politica = eBloqueia;
+    }else if(buffer == "antiga"){
+      *politica = eDescartaMaisAntiga;
+    }else{
+      return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+    }
+  }
+
+  // Busca o tempo de bloqueio, se nao existir mantem o padrao
+  erro = gerenciamentoCartao_buscaInformacao(texto,strTempoBloqueio,&buffer);
+  if(erro == SUCESSO){
+    *tempoBloqueio = (Tuint32)buffer.toInt();
+  }
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que obtem as opções do registro somente de mudanças.
+ *         Cartões gravados antes dessa opção nao possuem as chaves, nesse caso o registro fica desativado
+ * @param  ativo: variável que receberá se o registro de mudanças esta ativo
+ * @param  intervaloQuadroChave: variável que receberá o intervalo do quadro chave (ms)
+ * @param  resumo: variável que receberá se o resumo dos suprimidos deve ser escrito
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_obtemRegistroMudancas(Tbool *ativo, Tuint32 *intervaloQuadroChave, Tbool *resumo){
+  Terro erro = SUCESSO;
+  File arquivo;
+  String texto;
+  const char strRegistroMudancas[] = {"Registro Mudancas:"};
+  const char strQuadroChave[] = {"Quadro Chave (ms):"};
+  const char strResumoSuprimidos[] = {"Resumo Suprimidos:"};
+  String buffer;
+
+  *ativo = FALSO;
+  *intervaloQuadroChave = INTERVALO_QUADRO_CHAVE_PADRAO;
+  *resumo = FALSO;
+  
+  // Abre arquivo para leitura
+  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
+  if(!arquivo){
+    return ERRO_LEITURA_CARTAO;
+  }
+  // Le arquivo inteiro e armazena em texto
+  texto = arquivo.readString();
+  // Fecha arquivo
+  arquivo.close(); 
+
+  // Busca as opções, as que nao existirem mantem o padrao
+  erro = gerenciamentoCartao_buscaInformacao(texto,strRegistroMudancas,&buffer);
+  if(erro == SUCESSO){
+    buffer.toLowerCase();
+    *ativo = (buffer == "sim");
+  }
+
+  erro = gerenciamentoCartao_buscaInformacao(texto,strQuadroChave,&buffer);
+  if(erro == SUCESSO){
+    *intervaloQuadroChave = (Tuint32)buffer.toInt();
+  }
+
+  erro = gerenciamentoCartao_buscaInformacao(texto,strResumoSuprimidos,&buffer);
+  if(erro == SUCESSO){
+    buffer.toLowerCase();
+    *resumo = (buffer == "sim");
+  }
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que obtem a politica de flush do arquivo de registro. As opções que nao
+ *         existirem no arquivo de configuração mantem o padrao
+ * @param  limiteBytes: bytes pendentes que forçam o flush
+ * @param  limiteTempo: tempo maximo sem flush (ms)
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_obtemDescargaCartao(Tuint32 *limiteBytes, Tuint32 *limiteTempo){
+  Terro erro = SUCESSO;
+  File arquivo;
+  String texto;
+  const char strDescargaBytes[] = {"Descarga Cartao (bytes):"};
+  const char strDescargaTempo[] = {"Descarga Cartao (ms):"};
+  String buffer;
+
+  *limiteBytes = DESCARGA_CARTAO_BYTES_PADRAO;
+  *limiteTempo = DESCARGA_CARTAO_TEMPO_PADRAO;
+  
+  // Abre arquivo para leitura
+  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
+  if(!arquivo){
+    return ERRO_LEITURA_CARTAO;
+  }
+  // Le arquivo inteiro e armazena em texto
+  texto = arquivo.readString();
+  // Fecha arquivo
+  arquivo.close(); 
+
+  erro = gerenciamentoCartao_buscaInformacao(texto,strDescargaBytes,&buffer);
+  if(erro == SUCESSO){
+    *limiteBytes = (Tuint32)buffer.toInt();
+  }
+
+  erro = gerenciamentoCartao_buscaInformacao(texto,strDescargaTempo,&buffer);
+  if(erro == SUCESSO){
+    *limiteTempo = (Tuint32)buffer.toInt();
+  }
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que obtem o tamanho da prealocação dos arquivos de registro. Sem a opção no
+ *         arquivo de configuração a prealocação fica desativada
+ * @param  tamanho: recebe o tamanho prealocado de cada arquivo (MiB)
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_obtemPrealocacaoRegistro(Tuint32 *tamanho){
+  Terro erro = SUCESSO;
+  File arquivo;
+  String texto;
+  const char strPrealocacao[] = {"Prealocacao Registro (MiB):"};
+  String buffer;
+
+  *tamanho = PREALOCACAO_REGISTRO_PADRAO;
+  
+  // Abre arquivo para leitura
+  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
+  if(!arquivo){
+    return ERRO_LEITURA_CARTAO;
+  }
+  // Le arquivo inteiro e armazena em texto
+  texto = arquivo.readString();
+  // Fecha arquivo
+  arquivo.close(); 
+
+  erro = gerenciamentoCartao_buscaInformacao(texto,strPrealocacao,&buffer);
+  if(erro == SUCESSO){
+    *tamanho = (Tuint32)buffer.toInt();
+    if(*tamanho > PREALOCACAO_MAXIMA_REGISTRO){
+      *tamanho = PREALOCACAO_MAXIMA_REGISTRO;
+    }
+  }
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que obtem os limites do tamanho do bloco entregue ao cartao e ao servidor. As
+ *         opções que nao existirem no arquivo de configuração mantem o padrao
+ * @param  latencia: recebe o tempo maximo de um quadro ate o fim do envio do seu bloco (ms)
+ * @param  maximo: recebe a maior quantidade de mensagens de um bloco
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_obtemTamanhoBloco(Tuint32 *latencia, Tuint32 *maximo){
+  Terro erro = SUCESSO;
+  File arquivo;
+  String texto;
+  const char strLatencia[] = {"Latencia Bloco (ms):"};
+  const char strMaximo[] = {"Maximo Mensagens Bloco:"};
+  String buffer;
+
+  *latencia = LATENCIA_BLOCO_PADRAO;
+  *maximo = QUANTIDADE_MAXIMA_MENSAGENS_POR_BLOCO;
+  
+  // Abre arquivo para leitura
+  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
+  if(!arquivo){
+    return ERRO_LEITURA_CARTAO;
+  }
+  // Le arquivo inteiro e armazena em texto
+  texto = arquivo.readString();
+  // Fecha arquivo
+  arquivo.close(); 
+
+  erro = gerenciamentoCartao_buscaInformacao(texto,strLatencia,&buffer);
+  if(erro == SUCESSO){
+    *latencia = (Tuint32)buffer.toInt();
+    if(*latencia < LATENCIA_MINIMA_BLOCO){
+      *latencia = LATENCIA_MINIMA_BLOCO;
+    }else if(*latencia > LATENCIA_MAXIMA_BLOCO){
+      *latencia = LATENCIA_MAXIMA_BLOCO;
+    }
+  }
+
+  erro = gerenciamentoCartao_buscaInformacao(texto,strMaximo,&buffer);
+  if(erro == SUCESSO){
+    *maximo = (Tuint32)buffer.toInt();
+    if(*maximo < QUANTIDADE_MINIMA_MENSAGENS_POR_BLOCO){
+      *maximo = QUANTIDADE_MINIMA_MENSAGENS_POR_BLOCO;
+    }else if(*maximo > QUANTIDADE_LIMITE_MENSAGENS_POR_BLOCO){
+      *maximo = QUANTIDADE_LIMITE_MENSAGENS_POR_BLOCO;
+    }
+  }
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que obtem o formato dos arquivos de registro e dos envios ao servidor. Sem as
+ *         opções no arquivo de configuração os dois continuam em texto
+ * @param  formato: variável que receberá o formato do registro
+ * @param  formatoServidor: variável que receberá o formato do envio ao servidor
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_obtemFormatoRegistro(PTformatoRegistro formato, PTformatoRegistro formatoServidor){
+  Terro erro = SUCESSO;
+  File arquivo;
+  String texto;
+  const char strFormato[] = {"Formato Registro:"};
+  const char strFormatoServidor[] = {"Formato Servidor:"};
+  String buffer;
+
+  *formato = FORMATO_REGISTRO_PADRAO;
+  *formatoServidor = FORMATO_REGISTRO_PADRAO;
+  
+  // Abre arquivo para leitura
+  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
+  if(!arquivo){
+    return ERRO_LEITURA_CARTAO;
+  }
+  // Le arquivo inteiro e armazena em texto
+  texto = arquivo.readString();
+  // Fecha arquivo
+  arquivo.close(); 
+
+  erro = gerenciamentoCartao_buscaInformacao(texto,strFormato,&buffer);
+  if(erro == SUCESSO){
+    buffer.toLowerCase();
+    if(buffer == "binario"){
+      *formato = eFormatoBinario;
+    }else if(buffer == "colunar"){
+      *formato = eFormatoColunar;
+    }else if(buffer == "pcap"){
+      *formato = eFormatoPcap;
+    }else if(buffer == "mf4"){
+      *formato = eFormatoMdf;
+    }else if(buffer == "texto"){
+      *formato = eFormatoTexto;
+    }else{
+      return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+    }
+  }
+
+  // O servidor recebe texto simples ou blocos colunares
+  erro = gerenciamentoCartao_buscaInformacao(texto,strFormatoServidor,&buffer);
+  if(erro == SUCESSO){
+    buffer.toLowerCase();
+    if(buffer == "colunar"){
+      *formatoServidor = eFormatoColunar;
+    }else if(buffer == "texto"){
+      *formatoServidor = eFormatoTexto;
+    }else{
+      return ERRO_ARQUIVO_CONFIGURACAO_CORROMPIDO;
+    }
+  }
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que obtem a lista de identificadores do filtro de software e a compila.
+ *         Sem a chave no arquivo de configuração o filtro fica desativado
+ * @param  filtro: filtro que será compilado
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_obtemFiltroSoftware(PTfiltroSoftware filtro){
+  Terro erro = SUCESSO;
+  File arquivo;
+  String texto;
+  const char strFiltroSoftware[] = {"Filtro Software:"};
+  String buffer;
+  
+  // Abre arquivo para leitura
+  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
+  if(!arquivo){
+    return ERRO_LEITURA_CARTAO;
+  }
+  // Le arquivo inteiro e armazena em texto
+  texto = arquivo.readString();
+  // Fecha arquivo
+  arquivo.close(); 
+
+  // Busca a lista, se nao existir o filtro fica desativado
+  erro = gerenciamentoCartao_buscaInformacao(texto,strFiltroSoftware,&buffer);
+  if(erro != SUCESSO){
+    return filtroSoftware_compila(filtro, NULL);
+  }
+
+  return filtroSoftware_compila(filtro, buffer.c_str());
+}
+
+/**
+ * @brief  Função que calcula a programação das mascaras e filtros do MCP2515 a partir da lista
+ *         do filtro de software. As taxas do barramento sao opcionais e melhoram a escolha
+ * @param  programacao: recebe a programação (valida = FALSO se o filtro de software estiver desativado)
+ * @return erro ou SUCESSO
+ */
+Terro gerenciamentoCartao_obtemProgramacaoFiltro(PTprogramacaoFiltro programacao){
+  Terro erro = SUCESSO;
+  File arquivo;
+  String texto;
+  const char strFiltroSoftware[] = {"Filtro Software:"};
+  const char strTaxasBarramento[] = {"Taxas Barramento:"};
+  String lista;
+  String taxas;
+  
+  // Abre arquivo para leitura
+  arquivo = SD.open(NOME_ARQUIVO_CONFIGURACAO, FILE_READ);
+  if(!arquivo){
+    return ERRO_LEITURA_CARTAO;
+  }
+  // Le arquivo inteiro e armazena em texto
+  texto = arquivo.readString();
+  // Fecha arquivo
+  arquivo.close(); 
+
+  // Sem lista nao ha o que compilar
+  erro = gerenciamentoCartao_buscaInformacao(texto,strFiltroSoftware,&lista);
+  if(erro != SUCESSO){
+    return compiladorFiltro_compila(NULL, NULL, programacao);
+  }
+
+  // Taxas sao opcionais
+  erro = gerenciamentoCartao_buscaInformacao(texto,strTaxasBarramento,&taxas);
+  if(erro != SUCESSO){
+    return compiladorFiltro_compila(lista.c_str(), NULL, programacao);
+  }
+
+  return compiladorFiltro_compila(lista.c_str(), taxas.c_str(), programacao);
+}
+
+/**
+ * @brief  Função que obtem as informações de configuração no cartao de memória
+ * @param  configuracao: Estrutura com os definidores das configurações
+ * @return ERRO ou SUCESSO
+ */
+Terro gerenciamentoCartao_obtemConfiguracao(PTconfiguracao configuracao){
+  Terro erro = SUCESSO;
+
+  // Obtem login e senha do wifi
+  erro = gerenciamentoCartao_obtemLoginSenha(&(configuracao->wifi));
+  if(erro != SUCESSO){
+    return erro;
+  }
+  PRINTF("LOGIN: %s\r\n", configuracao->wifi.login);
+  PRINTF("SENHA: %s\r\n", configuracao->wifi.senha);
+
+  // Obtem a taxa de comunicação 
+  erro = gerenciamentoCartao_obtemTaxaComunicacao(&(configuracao->taxa));
+  if(erro != SUCESSO){
+    return erro;
+  }  
+  PRINTF("TAXA: %d\r\n", configuracao->taxa);
+
+  // Obtem a lista de identificadores para filtro 
+  erro = gerenciamentoCartao_obtemListaFiltrosAndMascaras(&(configuracao->filtAndMask));
+  if(erro != SUCESSO){
+    return erro;
+  }  
+  if(configuracao->filtAndMask.mask_0){
+    PRINTF("MASCARA 0: 0x%08X\r\n",configuracao->filtAndMask.mascara_0);
+  }
+  if(configuracao->filtAndMask.mask_1){
+    PRINTF("MASCARA 0: 0x%08X\r\n",configuracao->filtAndMask.mascara_1);
+  }  
+  
+  for(int i=0; i<configuracao->filtAndMask.quantidade; i++){
+    PRINTF("IDENTIFICADORES %02d: 0x%08X\r\n", (i+1),configuracao->filtAndMask.filtros[i].valor);
+  }
+  // Obtem a lista de identificadores para filtro 
+  erro = gerenciamentoCartao_obtemDesejaFormatarLog(&(configuracao->logFormatado));
+  if(erro != SUCESSO){
+    return erro;
+  }     
+
+  PRINTF("Log formatado? %d\r\n", configuracao->logFormatado);
+
+  // Obtem a lista de identificadores para filtro 
+  erro = gerenciamentoCartao_obtemDesejaMonitorSerial(&(configuracao->monitorSerial));
+  if(erro != SUCESSO){
+    return erro;
+  }     
+
+  PRINTF("Monitor Serial? %d\r\n", configuracao->monitorSerial);
+
+  // Obtem a politica da fila de mensagens
+  erro = gerenciamentoCartao_obtemPoliticaFila(&(configuracao->politicaFila), &(configuracao->tempoBloqueioFila));
+  if(erro != SUCESSO){
+    return erro;
+  }     
+
+  PRINTF("Politica fila: %d (bloqueio %u ms)\r\n", configuracao->politicaFila, configuracao->tempoBloqueioFila);
+
+  // Obtem as opções do registro somente de mudanças
+  erro = gerenciamentoCartao_obtemRegistroMudancas(
+    &(configuracao->registroMudancas), 
+    &(configuracao->intervaloQuadroChave), 
+    &(configuracao->resumoSuprimidos)
+  );
+  if(erro != SUCESSO){
+    return erro;
+  }     
+
+  PRINTF("Registro de mudancas? %d (quadro chave %u ms, resumo %d)\r\n", configuracao->registroMudancas, 
+    configuracao->intervaloQuadroChave, configuracao->resumoSuprimidos);
+
+  erro = gerenciamentoCartao_obtemDescargaCartao(
+    &(configuracao->bytesDescargaCartao), 
+    &(configuracao->tempoDescargaCartao)
+  );
+  if(erro != SUCESSO){
+    return erro;
+  }     
+
+  PRINTF("Flush do registro: %u bytes ou %u ms\r\n", configuracao->bytesDescargaCartao, 
+    configuracao->tempoDescargaCartao);
+
+  erro = gerenciamentoCartao_obtemPrealocacaoRegistro(&(configuracao->prealocacaoRegistro));
+  if(erro != SUCESSO){
+    return erro;
+  }     
+
+  PRINTF("Prealocacao do registro: %u MiB\r\n", configuracao->prealocacaoRegistro);
+
+  erro = gerenciamentoCartao_obtemFormatoRegistro(&(configuracao->formatoRegistro), &(configuracao->formatoServidor));
+  if(erro != SUCESSO){
+    return erro;
+  }     
+
+  PRINTF("Formato do registro: %d (servidor %d)\r\n", configuracao->formatoRegistro, configuracao->formatoServidor);
+
+  erro = gerenciamentoCartao_obtemTamanhoBloco(
+    &(configuracao->latenciaBloco), 
+    &(configuracao->maximoMensagensBloco)
+  );
+  if(erro != SUCESSO){
+    return erro;
+  }     
+
+  PRINTF("Bloco de mensagens: latencia %u ms, maximo %u mensagens\r\n", configuracao->latenciaBloco, 
+    configuracao->maximoMensagensBloco);
+  
+
+  // Obtem id do ultimo arquivo armazenado no cartao de memória
+  erro = gerenciamentoCartao_obtemUltimoIdArquivoRegistro(&(configuracao->idArquivo));
+  if(erro != SUCESSO){
+    return erro;
+  }  
+
+  PRINTF("Ultimo arquivo: %d\r\n", configuracao->idArquivo);
+
+  erro = gerenciamentoCartao_obtemURLServidor(&(configuracao->servidor));
+  if(erro != SUCESSO){
+    return erro;
+  }  
+
+  PRINTF("URL Registros: %s\r\n", configuracao->servidor.reg);
+
+  PRINTF("URL Filtros: %s\r\n", configuracao->servidor.filtro);
+
+  PRINTF("URL Taxa: %s\r\n", configuracao->servidor.taxa);
+
+
+  return erro;
+}
+
@@ -0,0 +1,292 @@
+/**
+ * @file    indice_registro.cpp
+ * @brief   Esse arquivo contem as funções que montam o indice esparso do arquivo de registro aberto.
+ *          Cada balde de tempo com quadros gera uma entrada com os limites dos seus blocos no
+ *          registro e os identificadores presentes, a finalização acrescenta o resumo por
+ *          identificador. Os bytes do indice seguem pelo escritor do cartao logo depois dos dados,
+ *          assim o consumidor nunca acessa o cartao
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "indice_registro.h"
+
+// Definições importantes
+#define CONSTANTE_HASH_INDICE          2654435761U   // hash multiplicativo de Knuth
+#define POSICAO_TABELA_INDICE(chave)   (((Tuint32)(chave) * CONSTANTE_HASH_INDICE) >> (32 - BITS_TABELA_INDICE))
+#define MASCARA_TABELA_INDICE          (TAMANHO_TABELA_INDICE - 1)
+#define CHAVE_INDICE(mensagem)         ((mensagem).identificador & (MASCARA_ID_EXTENDIDO | FLAG_QUADRO_EXTENDIDO | FLAG_QUADRO_REMOTO))
+#define IDS_POR_PARTE_INDICE           16
+
+/**
+ * @brief  Função que inicializa o indice. Sem memoria os arquivos ficam sem indice
+ * @param  indice: indice que será inicializado
+ * @return ERRO_ALOCACAO_MEMORIA ou SUCESSO
+ */
+Terro indiceRegistro_inicializa(PTindiceRegistro indice){
+
+  (void)memset(indice, 0x00, sizeof(TindiceRegistro));
+  indice->entrada = (PTentradaIndice)calloc(TAMANHO_TABELA_INDICE, sizeof(TentradaIndice));
+  indice->idsBalde = (Tuint16 *)malloc(MAXIMA_QUANTIDADE_IDS_INDICE * sizeof(Tuint16));
+  if((indice->entrada == NULL) || (indice->idsBalde == NULL)){
+    free(indice->entrada);
+    free(indice->idsBalde);
+    indice->entrada = NULL;
+    indice->idsBalde = NULL;
+    return ERRO_ALOCACAO_MEMORIA;
+  }
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que entrega uma parte de um registro do indice ao escritor, acumulando o CRC.
+ *         Um erro do escritor aparece tambem no proximo bloco, por isso é ignorado aqui
+ * @param  indice: indice do arquivo
+ * @param  escritor: escritor do cartao
+ * @param  crc: CRC acumulado do registro
+ * @param  dados: bytes da parte
+ * @param  tamanho: quantidade de bytes
+ * @return CRC acumulado
+ */
+static Tuint32 indiceRegistro_enviaParte(PTindiceRegistro indice, PTescritorCartao escritor, Tuint32 crc,
+                                         const Tuint8 *dados, Tuint32 tamanho){
+  (void)escritorCartao_escreveIndice(escritor, dados, tamanho);
+  indice->tamanhoIndice += tamanho;
+  return formatoBinario_crc32(crc, dados, tamanho);
+}
+
+/**
+ * @brief  Função que entrega o CRC que encerra um registro do indice
+ * @param  indice: indice do arquivo
+ * @param  escritor: escritor do cartao
+ * @param  crc: CRC acumulado do registro
+ * @return void
+ */
+static void indiceRegistro_encerraRegistro(PTindiceRegistro indice, PTescritorCartao escritor, Tuint32 crc){
+  Tuint8 campo[TAMANHO_CRC_BINARIO];
+
+  formatoBinario_escreveInteiro(campo, crc, TAMANHO_CRC_BINARIO);
+  (void)indiceRegistro_enviaParte(indice, escritor, 0, campo, TAMANHO_CRC_BINARIO);
+}
+
+/**
+ * @brief  Função que começa o indice de um arquivo de registro novo: limpa a tabela e entrega o
+ *         cabeçalho do indice
+ * @param  indice: indice
+ * @param  escritor: escritor do cartao
+ * @param  caminho: arquivo de registro indexado
+ * @param  tamanhoCabecalho: bytes do cabeçalho do formato no inicio do registro
+ * @return void
+ */
+static void indiceRegistro_iniciaArquivo(PTindiceRegistro indice, PTescritorCartao escritor,
+                                         const char *caminho, Tuint32 tamanhoCabecalho){
+  Tuint8 cabecalho[TAMANHO_CABECALHO_INDICE];
+
+  (void)memset(indice->entrada, 0x00, (TAMANHO_TABELA_INDICE * sizeof(TentradaIndice)));
+  indice->quantidade = 0;
+  indice->quadrosForaTabela = 0;
+  indice->deslocamento = 0;
+  indice->tamanhoIndice = 0;
+  indice->sequenciaBalde = 0;
+  indice->quantidadeIdsBalde = 0;
+  (void)strncpy(indice->caminho, caminho, (TAMANHO_MAXIMO_NOME_ARQUIVO - 1));
+
+  (void)memset(cabecalho, 0x00, TAMANHO_CABECALHO_INDICE);
+  (void)memcpy(cabecalho, MAGICO_FORMATO_INDICE, TAMANHO_MAGICO_FORMATO_INDICE);
+  cabecalho[4] = VERSAO_FORMATO_INDICE;
+  cabecalho[5] = TAMANHO_CABECALHO_INDICE;
+  formatoBinario_escreveInteiro(&cabecalho[8], LARGURA_BALDE_INDICE, 4);
+  formatoBinario_escreveInteiro(&cabecalho[12], tamanhoCabecalho, 4);
+  formatoBinario_escreveInteiro(&cabecalho[16], formatoBinario_crc32(0, cabecalho, 16), TAMANHO_CRC_BINARIO);
+
+  (void)indiceRegistro_enviaParte(indice, escritor, 0, cabecalho, TAMANHO_CABECALHO_INDICE);
+}
+
+/**
+ * @brief  Função que entrega a entrada do balde aberto. Os identificadores seguem em partes para
+ *         nao reservar o registro inteiro na pilha do consumidor
+ * @param  indice: indice
+ * @param  escritor: escritor do cartao
+ * @return void
+ */
+static void indiceRegistro_fechaBalde(PTindiceRegistro indice, PTescritorCartao escritor){
+  Tuint8 inicio[TAMANHO_INICIO_REGISTRO_INDICE + TAMANHO_INICIO_BALDE_INDICE];
+  Tuint8 ids[IDS_POR_PARTE_INDICE * TAMANHO_ID_INDICE];
+  Tuint32 crc;
+  Tuint16 i;
+  Tuint16 parte = 0;
+
+  if((indice->sequenciaBalde == 0) || (indice->quadrosBalde == 0)){
+    return;
+  }
+
+  (void)formatoIndice_iniciaRegistro(
+    inicio,
+    REGISTRO_INDICE_BALDE,
+    (Tuint16)(TAMANHO_INICIO_BALDE_INDICE + (indice->quantidadeIdsBalde * TAMANHO_ID_INDICE))
+  );
+  formatoBinario_escreveInteiro(&inicio[3], indice->inicioBalde, 4);
+  formatoBinario_escreveInteiro(&inicio[7], (indice->fimBalde - indice->inicioBalde), 4);
+  formatoBinario_escreveInteiro(&inicio[11], indice->primeiroBalde, 8);
+  formatoBinario_escreveInteiro(&inicio[19], indice->ultimoBalde, 8);
+  formatoBinario_escreveInteiro(&inicio[27], indice->quadrosBalde, 4);
+  inicio[31] = indice->flagsBalde;
+  formatoBinario_escreveInteiro(&inicio[32], indice->quantidadeIdsBalde, 2);
+  crc = indiceRegistro_enviaParte(indice, escritor, 0, inicio, sizeof(inicio));
+
+  for(i=0; i<indice->quantidadeIdsBalde; i++){
+    formatoBinario_escreveInteiro(&ids[parte * TAMANHO_ID_INDICE], indice->entrada[indice->idsBalde[i]].identificador, 4);
+    parte ++;
+    if((parte == IDS_POR_PARTE_INDICE) || ((i + 1) == indice->quantidadeIdsBalde)){
+      crc = indiceRegistro_enviaParte(indice, escritor, crc, ids, (parte * TAMANHO_ID_INDICE));
+      parte = 0;
+    }
+  }
+  indiceRegistro_encerraRegistro(indice, escritor, crc);
+
+  indice->quadrosBalde = 0;
+  indice->quantidadeIdsBalde = 0;
+}
+
+/**
+ * @brief  Função que registra no indice um bloco ja entregue ao escritor do cartao. Chamada pelo
+ *         consumidor logo depois do envio, assim as entradas vao para o cartao depois dos dados
+ * @param  indice: indice
+ * @param  escritor: escritor do cartao
+ * @param  bloco: bloco de mensagens enviado
+ * @param  caminho: arquivo de registro que recebeu o bloco
+ * @param  tamanhoCabecalho: bytes do cabeçalho do formato no inicio do registro
+ * @param  tamanhoBloco: bytes do bloco no registro
+ * @return void
+ */
+void indiceRegistro_registraBloco(PTindiceRegistro indice, PTescritorCartao escritor, PTblocoMensagens bloco,
+                                  const char *caminho, Tuint32 tamanhoCabecalho, Tuint32 tamanhoBloco){
+  PTentradaIndice e;
+  Tuint32 inicioBloco;
+  Tuint32 fimBloco;
+  Tuint32 chave;
+  Tuint32 posicao;
+  Tuint64 relogio;
+  Tuint64 numero;
+  Tuint32 i;
+
+  if(indice->entrada == NULL){
+    return;
+  }
+  if(strcmp(indice->caminho, caminho) != 0){
+    indiceRegistro_iniciaArquivo(indice, escritor, caminho, tamanhoCabecalho);
+  }
+
+  inicioBloco = indice->deslocamento;
+  fimBloco = (inicioBloco + tamanhoBloco);
+  indice->deslocamento = fimBloco;
+
+  for(i=0; i<bloco->quantidade; i++){
+    relogio = (bloco->relogioReferencia -
+              (bloco->tempoReferencia - TEMPO_ABSOLUTO_QUADRO(bloco->mensagem[i], bloco->tempoReferencia)));
+    numero = (relogio / LARGURA_BALDE_INDICE);
+
+    // Novo balde: a entrada do anterior ja pode ser entregue
+    if((indice->sequenciaBalde == 0) || (numero != indice->numeroBalde)){
+      indiceRegistro_fechaBalde(indice, escritor);
+      indice->sequenciaBalde ++;
+      indice->numeroBalde = numero;
+      indice->inicioBalde = inicioBloco;
+      indice->primeiroBalde = relogio;
+      indice->flagsBalde = 0;
+    }
+    indice->fimBalde = fimBloco;
+    indice->ultimoBalde = relogio;
+    indice->quadrosBalde ++;
+
+    if(QUADRO_ERRO(bloco->mensagem[i])){
+      continue;
+    }
+
+    chave = CHAVE_INDICE(bloco->mensagem[i]);
+    posicao = POSICAO_TABELA_INDICE(chave);
+    while(indice->entrada[posicao].ocupada && (indice->entrada[posicao].identificador != chave)){
+      posicao = ((posicao + 1) & MASCARA_TABELA_INDICE);
+    }
+    e = &indice->entrada[posicao];
+
+    // Mantem a ocupação em no maximo 50%, o balde indica que a lista de identificadores esta incompleta
+    if(!e->ocupada){
+      if(indice->quantidade >= MAXIMA_QUANTIDADE_IDS_INDICE){
+        indice->quadrosForaTabela ++;
+        indice->flagsBalde |= INDICE_BALDE_INCOMPLETO;
+        continue;
+      }
+      e->identificador = chave;
+      e->primeiro = relogio;
+      e->ocupada = VERDADEIRO;
+      indice->quantidade ++;
+    }
+    e->ultimo = relogio;
+    e->quadros ++;
+    if(e->sequenciaBalde != indice->sequenciaBalde){
+      e->sequenciaBalde = indice->sequenciaBalde;
+      e->baldes ++;
+      indice->idsBalde[indice->quantidadeIdsBalde ++] = (Tuint16)posicao;
+    }
+  }
+}
+
+/**
+ * @brief  Função que finaliza o indice do arquivo de registro atual: entrega o balde aberto, o
+ *         resumo por identificador e o registro de fim. Chamada antes do primeiro bloco do
+ *         proximo arquivo e no fim da captura
+ * @param  indice: indice
+ * @param  escritor: escritor do cartao
+ * @return void
+ */
+void indiceRegistro_finaliza(PTindiceRegistro indice, PTescritorCartao escritor){
+  Tuint8 inicio[TAMANHO_INICIO_REGISTRO_INDICE + TAMANHO_INICIO_RESUMO_INDICE];
+  Tuint8 entrada[TAMANHO_ENTRADA_RESUMO_INDICE];
+  Tuint8 fim[TAMANHO_INICIO_REGISTRO_INDICE + 4];
+  Tuint32 posicaoResumo;
+  Tuint32 crc;
+  Tuint32 posicao;
+  PTentradaIndice e;
+
+  if((indice->entrada == NULL) || (indice->caminho[0] == '\0')){
+    return;
+  }
+
+  indiceRegistro_fechaBalde(indice, escritor);
+
+  // Resumo: uma entrada por identificador, na ordem da tabela
+  posicaoResumo = indice->tamanhoIndice;
+  (void)formatoIndice_iniciaRegistro(
+    inicio,
+    REGISTRO_INDICE_RESUMO,
+    (Tuint16)(TAMANHO_INICIO_RESUMO_INDICE + (indice->quantidade * TAMANHO_ENTRADA_RESUMO_INDICE))
+  );
+  formatoBinario_escreveInteiro(&inicio[3], indice->quantidade, 2);
+  formatoBinario_escreveInteiro(&inicio[5], indice->quadrosForaTabela, 4);
+  crc = indiceRegistro_enviaParte(indice, escritor, 0, inicio, sizeof(inicio));
+
+  for(posicao=0; posicao<TAMANHO_TABELA_INDICE; posicao++){
+    e = &indice->entrada[posicao];
+    if(!e->ocupada){
+      continue;
+    }
+    formatoBinario_escreveInteiro(&entrada[0], e->identificador, 4);
+    formatoBinario_escreveInteiro(&entrada[4], e->primeiro, 8);
+    formatoBinario_escreveInteiro(&entrada[12], e->ultimo, 8);
+    formatoBinario_escreveInteiro(&entrada[20], e->quadros, 4);
+    formatoBinario_escreveInteiro(&entrada[24], e->baldes, 4);
+    crc = indiceRegistro_enviaParte(indice, escritor, crc, entrada, TAMANHO_ENTRADA_RESUMO_INDICE);
+  }
+  indiceRegistro_encerraRegistro(indice, escritor, crc);
+
+  // Fim: permite ao leitor ir direto ao resumo a partir do fim do indice
+  (void)formatoIndice_iniciaRegistro(fim, REGISTRO_INDICE_FIM, 4);
+  formatoBinario_escreveInteiro(&fim[3], posicaoResumo, 4);
+  crc = indiceRegistro_enviaParte(indice, escritor, 0, fim, sizeof(fim));
+  indiceRegistro_encerraRegistro(indice, escritor, crc);
+
+  indice->caminho[0] = '\0';
+  indice->sequenciaBalde = 0;
+}
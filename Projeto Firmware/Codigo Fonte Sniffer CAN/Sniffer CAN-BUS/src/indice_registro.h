@@ -0,0 +1,30 @@
+/**
+ * @file    indice_registro.h
+ * @brief   Esse arquivo contem o prototipo das funções que montam o indice esparso de tempo e de
+ *          identificadores de cada arquivo de registro (formato_indice.h). O consumidor registra
+ *          cada bloco depois de entregá-lo ao escritor do cartao e finaliza o indice na troca de
+ *          arquivo e no fim da captura
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef INDICE_REGISTRO_H_INCLUDED
+#define INDICE_REGISTRO_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Submódulos do sistema
+#include "tipos.h"
+#include "erros.h"
+#include "formato_indice.h"
+#include "escritor_cartao.h"
+
+/// Funções exportadas
+Terro indiceRegistro_inicializa(PTindiceRegistro indice);
+void indiceRegistro_registraBloco(PTindiceRegistro indice, PTescritorCartao escritor, PTblocoMensagens bloco,
+                                  const char *caminho, Tuint32 tamanhoCabecalho, Tuint32 tamanhoBloco);
+void indiceRegistro_finaliza(PTindiceRegistro indice, PTescritorCartao escritor);
+
+#endif // INDICE_REGISTRO_H_INCLUDED
@@ -1,327 +1,534 @@
-/**
- * @file    main.cpp
- * @brief   Esse arquivo contem as funções principais e de configuração do sistema
- * @author  Emanoel Gomes Santos
- * @date    Data de Criação: 30/03/2020
-**/
-
-/// Bibliotecas do esp32
-#include <mcp_can.h>
-#include <SPI.h>
-#include <pthread.h>
-#include <Wire.h>
-#include "time.h"
-
-#include "soc/timer_group_struct.h"
-#include "soc/timer_group_reg.h"
-
-/// Bibliotecas do módulo Snnifer CAN/BUS
-#include "erros.h"
-#include "tipos.h"
-#include "fila_mensagem.h"
-#include "protocolo_can.h"
-#include "gerenciamento_cartao.h"
-
-// Definições importantes
-#define TENTATIVAS_INICIALIZA_CONEXAO_WIFI  10
-
-// Variáveis globais
-TmensagemCAN mensagem;
-Terro erro;
-TdescritorSniffer descritor;
-struct tm data;
-
-
-/**
- * @brief  Função que executa as configurações iniciais do sistema
- * @return void
- */
-void setup(){
-  // ------------------------------------------------------------------------------------------//
-  //                        CONFIGURAÇÕES INICIAIS NECESSÁRIAS                                 //
-  // ------------------------------------------------------------------------------------------// 
-
-  // Configura porta serial para debug
-  Serial.begin(TAXA_TRANSFERENCIA_SERIAL_ESP32);
-  
-  //Cria a estrutura temporaria para funcao abaixo.
-  timeval tv;
-  // Encontrar uma forma de obter a hora exata
-  tv.tv_sec = 1587141960;
-  settimeofday(&tv, NULL);
-
-  // Define pino 2 como saída para utilizar o LED interno
-  pinMode(PINO_LED_INTERNO, OUTPUT);
-
-  pinMode(LED_ERRO_CARTAO_MEMORIA, OUTPUT);
-  pinMode(LED_ERRO_WIFI,           OUTPUT);
-  pinMode(LED_ERRO_SERVIDOR,       OUTPUT);
-  pinMode(LED_ERRO_CAN,            OUTPUT);
-  pinMode(LED_SISTEMA_PRONTO,      OUTPUT);
- 
-  // Garante que todos os leds estão apagados
-  digitalWrite(LED_ERRO_CARTAO_MEMORIA, LOW);
-  digitalWrite(LED_ERRO_WIFI,           LOW);
-  digitalWrite(LED_ERRO_SERVIDOR,       LOW);
-  digitalWrite(LED_ERRO_CAN,            LOW);
-  digitalWrite(LED_SISTEMA_PRONTO,      LOW);
-  
-
-  // ------------------------------------------------------------------------------------------//
-  //                    OBTEM INFORMAÇÕES DE CONFIGURAÇÃO NO CARTAO                            //
-  // ------------------------------------------------------------------------------------------// 
-  
-  // Inicializa cartão micro SD
-  erro = gerenciamentoCartao_inicializa(CS_PIN_MODULO_MICRO_SD);
-  if(erro != SUCESSO){
-    // Se ocorreu algum erro, então acender led de cartão de memória e sai do sistema
-    digitalWrite(LED_ERRO_CARTAO_MEMORIA,HIGH);
-    PRINTLN("CARTÃO INVALIDO OU NAO ENCONTRADO"); 
-    return;
-  }  
-
-  PRINTLN("----DADOS DO CARTAO DE MEMORIA---");
-
-  // Limpa todo buffer de configuração
-  (void)memset((Tuint8*)&(descritor.configuracao), 0x00, sizeof(Tconfiguracao));
-
-  // Obtem todas as informações necessárias para inicializar sistema
-  erro = gerenciamentoCartao_obtemConfiguracao((PTconfiguracao)&(descritor.configuracao));
-  if(erro != SUCESSO){
-    // Se ocorreu algum erro, então acender led de cartão de memória e sai do sistema
-    digitalWrite(LED_ERRO_CARTAO_MEMORIA,HIGH);
-    PRINTLN("DADOS DO CARTÃO CORROMPIDOS OU CARTÃO INVALIDO"); 
-    return;
-  } 
-
-  
-  // ------------------------------------------------------------------------------------------//
-  //                                  REALIZA CONEXÃO COM WIFI                                 //
-  // ------------------------------------------------------------------------------------------//  
-  erro = snifferCANWiFi_conecta(
-    descritor.configuracao.wifi.login, 
-    descritor.configuracao.wifi.senha,
-    TENTATIVAS_INICIALIZA_CONEXAO_WIFI
-  );
-  if(erro != SUCESSO){
-    // Se ocorreu algum erro, então acender led do wifi. não sai do sistema, pois funciona
-    // mesmo se wifi nao estiver funcionando
-    digitalWrite(LED_ERRO_WIFI,HIGH);  
-    PRINTLN("FALHA AO CONECTAR AO WIFI");  
-    digitalWrite(LED_ERRO_SERVIDOR,HIGH);  
-    PRINTLN("FALHA AO CONECTAR AO SERVIDOR");      
-    descritor.configuracao.wifi.conectado = FALSO;    
-  }
-
-  // ------------------------------------------------------------------------------------------//
-  //            LE DADOS DO SERVIDOR SE CONSEGUIR SE CONECTAR AO WIFI                          //
-  // ------------------------------------------------------------------------------------------//   
-  // Se conseguiu conectar a internet, tenta conectar ao servidor
-  else{
-    String buffer;
-    String url;
-    descritor.configuracao.wifi.conectado = VERDADEIRO;
-
-    PRINTLN("\n----DADOS DO SERVIDOR---");
-
-    PRINTLN("Aguarde...\r\n");    
-
-    // LER FILTROS DO SERVIDOR --------------------
-    erro = sniferCanServidor_conecta(descritor.configuracao.servidor.filtro);
-    if(erro == SUCESSO){
-
-      // Le filtro servidor
-      erro = snifferCanServidor_le(
-        url,
-        descritor.configuracao.wifi,
-        &buffer
-      );
-      // Se ocorreu algum erro, mostrar erro
-      if(erro != SUCESSO){
-          digitalWrite(LED_ERRO_SERVIDOR,HIGH);  
-          PRINTLN("FALHA AO CONECTAR AO SERVIDOR");  
-          descritor.configuracao.wifi.conectado = FALSO;
-      }
-      // Se ocorreu tudo bem, salvar filtros
-      else{
-        
-        PRINT("FILTROS:");
-        PRINTLN(buffer);
-
-        // Recupera informação de filtros e mascaras do servidor e configura descritor de configuração
-        erro = gerenciamentoCartao_formataListaFiltrosAndMascaras(
-          (PTlistaFiltrosAndMascaras)&(descritor.configuracao.filtAndMask),
-          buffer
-        );
-        if(erro != SUCESSO){
-          digitalWrite(LED_ERRO_SERVIDOR,HIGH);  
-          PRINTLN("FALHA AO CONECTAR AO SERVIDOR");  
-          descritor.configuracao.wifi.conectado = FALSO;  
-        }
-        /*
-        // Atualiza cartão com a informação recebida pelo servidor
-        erro = gerenciamentoCartao_escreveListaFiltrosAndMascaras(buffer);
-        if(erro != SUCESSO){
-          PRINTLN("FALHA AO ESCREVER INFORMACAO DO SERVIDOR NO CARTAO DE MEMORIA");  
-        }*/
-      }
-
-      /// TENTA LER TAXA DO SERVIDOR -----------
-      erro = sniferCanServidor_conecta(descritor.configuracao.servidor.taxa);
-      if(erro == SUCESSO){
-          
-        // Le taxa no servidor
-        erro = snifferCanServidor_le(
-          url,
-          descritor.configuracao.wifi,
-          &buffer
-        );
-        // Se ocorreu algum erro mostrar e acender led
-        if(erro != SUCESSO){
-          digitalWrite(LED_ERRO_SERVIDOR,HIGH);  
-          PRINTLN("FALHA AO CONECTAR AO SERVIDOR");  
-          descritor.configuracao.wifi.conectado = FALSO;           
-        }
-        // Se ocorreu tudo bem, entao salvar taxa lida do servidor
-        else{
-            
-          PRINTF("TAXA: %s\r\n", getStringTaxa((TaxaComunicacao)(buffer.toInt())));
-          //PRINTLN(buffer);
-
-          // Recupera informação de filtros e mascaras do servidor e configura descritor de configuração
-          erro = gerenciamentoCartao_verificaTaxa(
-            (PTaxaComunicacao)&(descritor.configuracao.taxa),
-            buffer
-          );
-          if(erro != SUCESSO){
-            descritor.configuracao.taxa = TAXA_500KBPS; // recebe taxa default
-            digitalWrite(LED_ERRO_SERVIDOR,HIGH);
-            delay(1000);
-            digitalWrite(LED_ERRO_SERVIDOR,LOW);  
-            delay(1000);
-            digitalWrite(LED_ERRO_SERVIDOR,HIGH);  
-            delay(1000);
-            digitalWrite(LED_ERRO_SERVIDOR,LOW);           
-            PRINTLN("TAXA INVALIDA RECEBIDA DO SERVIDOR!");
-          }
-          /*
-          
-          // Atualiza cartão com a informação recebida pelo servidor
-          erro = gerenciamentoCartao_escreveTaxaComunicacao(buffer);
-          if(erro != SUCESSO){
-            PRINTLN("FALHA AO ESCREVER INFORMACAO DO SERVIDOR NO CARTAO DE MEMORIA");  
-          } */     
-        }
-      }else{
-        digitalWrite(LED_ERRO_SERVIDOR,HIGH);  
-        PRINTLN("FALHA AO CONECTAR AO SERVIDOR");
-      }
-
-    }else{
-      digitalWrite(LED_ERRO_SERVIDOR,HIGH);  
-      PRINTLN("FALHA AO CONECTAR AO SERVIDOR");  
-    }
-   
-
-   
-
-  }
-
-  // ------------------------------------------------------------------------------------------//
-  //                            INICIALIZAÇÃO DO PROTOCOLO CAN                                 //
-  // ------------------------------------------------------------------------------------------//
-  erro = protocoloCAN_inicializa(
-    descritor.configuracao.taxa, 
-    descritor.configuracao.filtAndMask, 
-    (PTfilaMensagem)&(descritor.filaMensagem),
-    TAMANHO_MAXIMO_BUFFER_FILA
-);
-  if(erro != SUCESSO){
-    // Se ocorreu algum erro, então acender led da can. Sai do sistema, pois sem a CAN inicialziada com uscesso
-    // nada funciona
-    digitalWrite(LED_ERRO_CAN,HIGH);      
-    return;    
-    PRINTLN("FALHA NA INICIALIZAÇÃO DO PROTOCOLO CAN");
-  }
-  // SE CHEGOU AQUI ENTÃO OCORREU TUDO BEM
-
-  // Se chegou até aqui então esta tudo correto. apenas sinaliza com LED INTERNO do ESP32 
-  PRINTLN("\n\n\nExecutando...");
-
-  digitalWrite(PINO_LED_INTERNO,HIGH);   
-  digitalWrite(LED_SISTEMA_PRONTO,HIGH);   
-
-  // Ativa flag das funções principais
-  protocoloCan_entrarNoSistema();  
-  
-  /*
-    Cria uma tarefa que será executada na função protocoloCAN_salvaRegistroCANFila, com prioridade 2
-    e execução no núcleo 0.
-    salvaRegistroCANFila: Captura os dados da linha CAN via SPI (MCP2515) e salva em uma fila de mensagens CAN
-  */
-  xTaskCreatePinnedToCore(
-    // Função que implementa a tarefa
-    protocoloCAN_salvaRegistroCANFila,
-    // Nome da tarefa
-    "salvaRegistroCANFila", 
-    // Numero de bytes a serem alocados para uso com a pilha da tarefa
-    // Fazendo teste com a função uxHighWaterMark = uxTaskGetStackHighWaterMark( NULL );
-    // percebe-se que a quantidade maxima de palavras usadas da pilha é de 1324.
-    // Com isso, 4KB (4096) é mais do que suficiente
-    TAMANHO_BUFFER_4K, // 
-    // Parametro de entrada da tarefa, nesse caso sera justamente um ponteiro para fila de mensagem
-    (PTdescritorSniffer)&descritor,       
-    // Prioridade da tarefa(0 à N)
-    2,
-    // Referencia para a tarefa (não é utilizado entao null)
-    &salvaRegistroCANFila,       
-    // Nucleo que estará sendo executado o proceso = 0
-    NUCLEO_ZERO
-  ); 
-                    
-  delay(500); //tempo para a tarefa iniciar
-  /*
-    Cria uma tarefa que será executada na função protocoloCAN_enviaRegistroCANFila, com prioridade 1
-    e execução no núcleo 1.
-    enviaRegistroCANFila: Envia os dados armazenados na estrutura de fila para cartão de memória ou servidor
-  */
-  xTaskCreatePinnedToCore(
-    // Função que implementa a tarefa
-    protocoloCAN_enviaRegistroCANFila, 
-    // Nome da tarefa
-    "enviaRegistroCANFila", 
-    // Numero de bytes a serem alocados para uso com a pilha da tarefa
-    (TAMANHO_BUFFER_20K),      
-    // Parametro de entrada da tarefa, nesse caso sera justamente um ponteiro para fila de mensagem
-    (PTdescritorSniffer)&descritor,       
-    // Prioridade da tarefa(0 à N)
-    1,
-    // Referencia para a tarefa (não é utilizado entao null)
-    &enviaRegistroCANFila,    
-    // Nucleo que estará sendo executado o proceso = 1   
-    NUCLEO_UM
-  );
-
-  delay(500); //tempo para a tarefa iniciar  
-  
-}
-
-
-/**
- * @brief  Função que executa o loop infinito do esp32. Nesse caso não será usado pois o programa 
- *         está sendo rodado nas tarefas definidas no setup
- * @return void
- */
-
-void loop(){
-
-/*
-TIMERG0.wdt_wprotect=TIMG_WDT_WKEY_VALUE;
-TIMERG0.wdt_feed=1;
-TIMERG0.wdt_wprotect=0;
-*/
-}
-
-/*********************************************************************************************************
-  END FILE
+/**
+ * @file    main.cpp
+ * @brief   Esse arquivo contem as funções principais e de configuração do sistema
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 30/03/2020
+**/
+
+/// Bibliotecas do esp32
+#include <mcp_can.h>
+#include <SPI.h>
+#include <pthread.h>
+#include <Wire.h>
+#include "time.h"
+
+#include "soc/timer_group_struct.h"
+#include "soc/timer_group_reg.h"
+
+/// Bibliotecas do módulo Snnifer CAN/BUS
+#include "erros.h"
+#include "tipos.h"
+#include "fila_mensagem.h"
+#include "protocolo_can.h"
+#include "gerenciamento_cartao.h"
+#include "servidor_estatistica.h"
+
+// Definições importantes
+#define TENTATIVAS_INICIALIZA_CONEXAO_WIFI  10
+#define SERVIDOR_NTP                        "pool.ntp.org"
+#define TEMPO_MAXIMO_SINCRONIZACAO_NTP      5000   // ms
+#define TEMPO_ENTRE_ATENDIMENTOS_HTTP       10     // ms, o loop divide o nucleo 1 com a tarefa de envio
+
+// Variáveis globais
+TmensagemCAN mensagem;
+Terro erro;
+TdescritorSniffer descritor;
+struct tm data;
+
+
+/**
+ * @brief  Função que executa as configurações iniciais do sistema
+ * @return void
+ */
+void setup(){
+  // ------------------------------------------------------------------------------------------//
+  //                        CONFIGURAÇÕES INICIAIS NECESSÁRIAS                                 //
+  // ------------------------------------------------------------------------------------------// 
+
+  // Configura porta serial para debug
+  Serial.begin(TAXA_TRANSFERENCIA_SERIAL_ESP32);
+  
+  //Cria a estrutura temporaria para funcao abaixo.
+  timeval tv;
+  // Encontrar uma forma de obter a hora exata
+  tv.tv_sec = 1587141960;
+  settimeofday(&tv, NULL);
+
+  // Define pino 2 como saída para utilizar o LED interno
+  pinMode(PINO_LED_INTERNO, OUTPUT);
+
+  pinMode(LED_ERRO_CARTAO_MEMORIA, OUTPUT);
+  pinMode(LED_ERRO_WIFI,           OUTPUT);
+  pinMode(LED_ERRO_SERVIDOR,       OUTPUT);
+  pinMode(LED_ERRO_CAN,            OUTPUT);
+  pinMode(LED_SISTEMA_PRONTO,      OUTPUT);
+ 
+  // Garante que todos os leds estão apagados
+  digitalWrite(LED_ERRO_CARTAO_MEMORIA, LOW);
+  digitalWrite(LED_ERRO_WIFI,           LOW);
+  digitalWrite(LED_ERRO_SERVIDOR,       LOW);
+  digitalWrite(LED_ERRO_CAN,            LOW);
+  digitalWrite(LED_SISTEMA_PRONTO,      LOW);
+  
+
+  // ------------------------------------------------------------------------------------------//
+  //                    OBTEM INFORMAÇÕES DE CONFIGURAÇÃO NO CARTAO                            //
+  // ------------------------------------------------------------------------------------------// 
+  
+  // Inicializa cartão micro SD
+  erro = gerenciamentoCartao_inicializa(CS_PIN_MODULO_MICRO_SD);
+  if(erro != SUCESSO){
+    // Se ocorreu algum erro, então acender led de cartão de memória e sai do sistema
+    digitalWrite(LED_ERRO_CARTAO_MEMORIA,HIGH);
+    PRINTLN("CARTÃO INVALIDO OU NAO ENCONTRADO"); 
+    return;
+  }  
+
+  PRINTLN("----DADOS DO CARTAO DE MEMORIA---");
+
+  // Limpa todo buffer de configuração
+  (void)memset((Tuint8*)&(descritor.configuracao), 0x00, sizeof(Tconfiguracao));
+
+  // Obtem todas as informações necessárias para inicializar sistema
+  erro = gerenciamentoCartao_obtemConfiguracao((PTconfiguracao)&(descritor.configuracao));
+  if(erro != SUCESSO){
+    // Se ocorreu algum erro, então acender led de cartão de memória e sai do sistema
+    digitalWrite(LED_ERRO_CARTAO_MEMORIA,HIGH);
+    PRINTLN("DADOS DO CARTÃO CORROMPIDOS OU CARTÃO INVALIDO"); 
+    return;
+  } 
+
+  // Compila o filtro de software, aplicado depois da fila sobre o que os filtros do MCP2515 deixaram passar
+  erro = gerenciamentoCartao_obtemFiltroSoftware((PTfiltroSoftware)&(descritor.filtroSoftware));
+  if(erro != SUCESSO){
+    digitalWrite(LED_ERRO_CARTAO_MEMORIA,HIGH);
+    PRINTLN("LISTA DO FILTRO DE SOFTWARE INVALIDA"); 
+    return;
+  } 
+  PRINTF("FILTRO SOFTWARE: %u padrao, %u extendidos\r\n", 
+    descritor.filtroSoftware.quantidadePadrao, descritor.filtroSoftware.quantidadeExtendido);
+
+  // Calcula as mascaras e filtros do MCP2515 a partir da mesma lista, substituindo os filtros manuais
+  erro = gerenciamentoCartao_obtemProgramacaoFiltro((PTprogramacaoFiltro)&(descritor.configuracao.programacaoFiltro));
+  if(erro != SUCESSO){
+    digitalWrite(LED_ERRO_CARTAO_MEMORIA,HIGH);
+    PRINTLN("TAXAS DO BARRAMENTO INVALIDAS"); 
+    return;
+  } 
+  if(descritor.configuracao.programacaoFiltro.valida){
+    PRINTF("FILTROS MCP2515: %.0f ids indesejados aceitos (%.1f quadros/s), razao %.3f\r\n",
+      descritor.configuracao.programacaoFiltro.idsFalsosAceitos,
+      descritor.configuracao.programacaoFiltro.taxaFalsosAceitos,
+      descritor.configuracao.programacaoFiltro.razaoFalsosAceitos);
+  }
+
+  
+  // ------------------------------------------------------------------------------------------//
+  //                                  REALIZA CONEXÃO COM WIFI                                 //
+  // ------------------------------------------------------------------------------------------//  
+  erro = snifferCANWiFi_conecta(
+    descritor.configuracao.wifi.login, 
+    descritor.configuracao.wifi.senha,
+    TENTATIVAS_INICIALIZA_CONEXAO_WIFI
+  );
+  if(erro != SUCESSO){
+    // Se ocorreu algum erro, então acender led do wifi. não sai do sistema, pois funciona
+    // mesmo se wifi nao estiver funcionando
+    digitalWrite(LED_ERRO_WIFI,HIGH);  
+    PRINTLN("FALHA AO CONECTAR AO WIFI");  
+    digitalWrite(LED_ERRO_SERVIDOR,HIGH);  
+    PRINTLN("FALHA AO CONECTAR AO SERVIDOR");      
+    descritor.configuracao.wifi.conectado = FALSO;    
+  }
+
+  // ------------------------------------------------------------------------------------------//
+  //            LE DADOS DO SERVIDOR SE CONSEGUIR SE CONECTAR AO WIFI                          //
+  // ------------------------------------------------------------------------------------------//   
+  // Se conseguiu conectar a internet, tenta conectar ao servidor
+  else{
+    String buffer;
+    String url;
+    descritor.configuracao.wifi.conectado = VERDADEIRO;
+
+    // Acerta o relogio por NTP. A captura ancora o tempo das mensagens nele uma unica vez
+    configTime(0, 0, SERVIDOR_NTP);
+    if(getLocalTime(&data, TEMPO_MAXIMO_SINCRONIZACAO_NTP)){
+      PRINTF("RELOGIO SINCRONIZADO: %04d-%02d-%02d %02d:%02d:%02d UTC\r\n", (data.tm_year + 1900), 
+        (data.tm_mon + 1), data.tm_mday, data.tm_hour, data.tm_min, data.tm_sec);
+    }else{
+      PRINTLN("FALHA AO SINCRONIZAR O RELOGIO");
+    }
+
+    PRINTLN("\n----DADOS DO SERVIDOR---");
+
+    PRINTLN("Aguarde...\r\n");    
+
+    // LER FILTROS DO SERVIDOR --------------------
+    erro = sniferCanServidor_conecta(descritor.configuracao.servidor.filtro);
+    if(erro == SUCESSO){
+
+      // Le filtro servidor
+      erro = snifferCanServidor_le(
+        url,
+        descritor.configuracao.wifi,
+        &buffer
+      );
+      // Se ocorreu algum erro, mostrar erro
+      if(erro != SUCESSO){
+          digitalWrite(LED_ERRO_SERVIDOR,HIGH);  
+          PRINTLN("FALHA AO CONECTAR AO SERVIDOR");  
+          descritor.configuracao.wifi.conectado = FALSO;
+      }
+      // Se ocorreu tudo bem, salvar filtros
+      else{
+        
+        PRINT("FILTROS:");
+        PRINTLN(buffer);
+
+        // Recupera informação de filtros e mascaras do servidor e configura descritor de configuração
+        erro = gerenciamentoCartao_formataListaFiltrosAndMascaras(
+          (PTlistaFiltrosAndMascaras)&(descritor.configuracao.filtAndMask),
+          buffer
+        );
+        if(erro != SUCESSO){
+          digitalWrite(LED_ERRO_SERVIDOR,HIGH);  
+          PRINTLN("FALHA AO CONECTAR AO SERVIDOR");  
+          descritor.configuracao.wifi.conectado = FALSO;  
+        }
+        /*
+        // Atualiza cartão com a informação recebida pelo servidor
+        erro = gerenciamentoCartao_escreveListaFiltrosAndMascaras(buffer);
+        if(erro != SUCESSO){
+          PRINTLN("FALHA AO ESCREVER INFORMACAO DO SERVIDOR NO CARTAO DE MEMORIA");  
+        }*/
+      }
+
+      /// TENTA LER TAXA DO SERVIDOR -----------
+      erro = sniferCanServidor_conecta(descritor.configuracao.servidor.taxa);
+      if(erro == SUCESSO){
+          
+        // Le taxa no servidor
+        erro = snifferCanServidor_le(
+          url,
+          descritor.configuracao.wifi,
+          &buffer
+        );
+        // Se ocorreu algum erro mostrar e acender led
+        if(erro != SUCESSO){
+          digitalWrite(LED_ERRO_SERVIDOR,HIGH);  
+          PRINTLN("FALHA AO CONECTAR AO SERVIDOR");  
+          descritor.configuracao.wifi.conectado = FALSO;           
+        }
+        // Se ocorreu tudo bem, entao salvar taxa lida do servidor
+        else{
+            
+          PRINTF("TAXA: %s\r\n", getStringTaxa((TaxaComunicacao)(buffer.toInt())));
+          //PRINTLN(buffer);
+
+          // Recupera informação de filtros e mascaras do servidor e configura descritor de configuração
+          erro = gerenciamentoCartao_verificaTaxa(
+            (PTaxaComunicacao)&(descritor.configuracao.taxa),
+            buffer
+          );
+          if(erro != SUCESSO){
+            descritor.configuracao.taxa = TAXA_500KBPS; // recebe taxa default
+            digitalWrite(LED_ERRO_SERVIDOR,HIGH);
+            delay(1000);
+            digitalWrite(LED_ERRO_SERVIDOR,LOW);  
+            delay(1000);
+            digitalWrite(LED_ERRO_SERVIDOR,HIGH);  
+            delay(1000);
+            digitalWrite(LED_ERRO_SERVIDOR,LOW);           
+            PRINTLN("TAXA INVALIDA RECEBIDA DO SERVIDOR!");
+          }
+          /*
+          
+          // Atualiza cartão com a informação recebida pelo servidor
+          erro = gerenciamentoCartao_escreveTaxaComunicacao(buffer);
+          if(erro != SUCESSO){
+            PRINTLN("FALHA AO ESCREVER INFORMACAO DO SERVIDOR NO CARTAO DE MEMORIA");  
+          } */     
+        }
+      }else{
+        digitalWrite(LED_ERRO_SERVIDOR,HIGH);  
+        PRINTLN("FALHA AO CONECTAR AO SERVIDOR");
+      }
+
+    }else{
+      digitalWrite(LED_ERRO_SERVIDOR,HIGH);  
+      PRINTLN("FALHA AO CONECTAR AO SERVIDOR");  
+    }
+   
+
+   
+
+  }
+
+  // ------------------------------------------------------------------------------------------//
+  //                            INICIALIZAÇÃO DO PROTOCOLO CAN                                 //
+  // ------------------------------------------------------------------------------------------//
+  erro = protocoloCAN_inicializa(
+    descritor.configuracao.taxa, 
+    descritor.configuracao.filtAndMask, 
+    (PTprogramacaoFiltro)&(descritor.configuracao.programacaoFiltro),
+    (PTfilaMensagem)&(descritor.filaMensagem),
+    TAMANHO_INICIAL_BUFFER_FILA
+);
+  if(erro != SUCESSO){
+    // Se ocorreu algum erro, então acender led da can. Sai do sistema, pois sem a CAN inicialziada com uscesso
+    // nada funciona
+    digitalWrite(LED_ERRO_CAN,HIGH);      
+    return;    
+    PRINTLN("FALHA NA INICIALIZAÇÃO DO PROTOCOLO CAN");
+  }
+  // SE CHEGOU AQUI ENTÃO OCORREU TUDO BEM
+
+  // Define o que a captura faz quando a fila de mensagens estiver cheia
+  filaMensagem_configuraPolitica(
+    (PTfilaMensagem)&(descritor.filaMensagem),
+    descritor.configuracao.politicaFila,
+    descritor.configuracao.tempoBloqueioFila
+  );
+
+  // Politica de flush do arquivo de registro, que fica aberto entre os blocos
+  gerenciamentoCartao_configuraDescarga(
+    descritor.configuracao.bytesDescargaCartao,
+    descritor.configuracao.tempoDescargaCartao
+  );
+  // Cada arquivo de registro novo ocupa de uma vez a região configurada. O pcap precisa começar
+  // pelo proprio cabeçalho, nao comporta o setor com o tamanho logico, e cresce a cada cluster
+  if(descritor.configuracao.formatoRegistro == eFormatoPcap){
+    gerenciamentoCartao_configuraPrealocacao(0);
+  }else{
+    gerenciamentoCartao_configuraPrealocacao(descritor.configuracao.prealocacaoRegistro * 1024UL * 1024UL);
+  }
+
+  // Buffers da tarefa de escrita no cartao. O mesmo tempo limita quanto um dado fica na memoria
+  erro = escritorCartao_inicializa(
+    (PTescritorCartao)&(descritor.escritorCartao),
+    descritor.configuracao.tempoDescargaCartao
+  );
+  if(erro != SUCESSO){
+    digitalWrite(LED_ERRO_CARTAO_MEMORIA,HIGH);
+    PRINTLN("MEMORIA INSUFICIENTE PARA OS BUFFERS DE ESCRITA NO CARTAO");
+    return;
+  }
+
+  // Buffers da tarefa de envio ao servidor, buffer de mensagens e buffers de formatação do maior
+  // bloco, reservados uma vez. Depois daqui o registro nao usa o heap. Sem memoria para o maximo
+  // configurado, o maior bloco cai pela metade
+  do{
+    if(erro != SUCESSO){
+      descritor.configuracao.maximoMensagensBloco /= 2;
+      if(descritor.configuracao.maximoMensagensBloco < QUANTIDADE_MINIMA_MENSAGENS_POR_BLOCO){
+        descritor.configuracao.maximoMensagensBloco = QUANTIDADE_MINIMA_MENSAGENS_POR_BLOCO;
+      }
+      PRINTF("MEMORIA INSUFICIENTE PARA O BLOCO! MAXIMO REDUZIDO PARA %u MENSAGENS\r\n", 
+        descritor.configuracao.maximoMensagensBloco);
+    }
+    if(descritor.configuracao.wifi.conectado){
+      erro = enviadorServidor_inicializa(
+        (PTenviadorServidor)&(descritor.enviadorServidor),
+        snifferCanRegistro_tamanhoEnvio(descritor.configuracao.maximoMensagensBloco, descritor.configuracao.formatoServidor),
+        descritor.configuracao.wifi,
+        descritor.configuracao.servidor.reg,
+        (descritor.configuracao.formatoServidor == eFormatoColunar)
+      );
+      if(erro != SUCESSO){
+        if(descritor.configuracao.maximoMensagensBloco > QUANTIDADE_MINIMA_MENSAGENS_POR_BLOCO){
+          continue;
+        }
+        // Mesmo com o menor bloco nao coube: registra somente no cartao
+        digitalWrite(LED_ERRO_SERVIDOR,HIGH);
+        PRINTLN("MEMORIA INSUFICIENTE PARA O ENVIO AO SERVIDOR");
+        descritor.configuracao.wifi.conectado = FALSO;
+      }
+    }
+    erro = arenaBloco_inicializa(
+      (PTarenaBloco)&(descritor.arenaBloco),
+      ((sizeof(TmensagemCAN) * descritor.configuracao.maximoMensagensBloco) + ALINHAMENTO_ARENA_BLOCO +
+       snifferCanRegistro_tamanhoArena(
+         descritor.configuracao.maximoMensagensBloco,
+         descritor.configuracao.formatoRegistro,
+         descritor.configuracao.formatoServidor
+       ))
+    );
+    if((erro != SUCESSO) && (descritor.configuracao.wifi.conectado)){
+      enviadorServidor_libera((PTenviadorServidor)&(descritor.enviadorServidor));
+    }
+  }while((erro != SUCESSO) && (descritor.configuracao.maximoMensagensBloco > QUANTIDADE_MINIMA_MENSAGENS_POR_BLOCO));
+  if(erro != SUCESSO){
+    digitalWrite(LED_ERRO_CARTAO_MEMORIA,HIGH);
+    PRINTLN("MEMORIA INSUFICIENTE PARA A ARENA DOS BLOCOS");
+    return;
+  }
+
+  // Tabela do registro somente de mudanças. Sem memoria registra todos os quadros
+  erro = registroMudanca_inicializa(
+    (PTregistroMudanca)&(descritor.registroMudanca),
+    descritor.configuracao.registroMudancas,
+    descritor.configuracao.intervaloQuadroChave,
+    descritor.configuracao.resumoSuprimidos
+  );
+  if(erro != SUCESSO){
+    PRINTLN("MEMORIA INSUFICIENTE PARA O REGISTRO DE MUDANCAS! REGISTRANDO TODOS OS QUADROS");
+  }
+
+  // Tabela de estatisticas por identificador, atualizada pela captura. Sem memoria fica desativada
+  erro = estatisticaId_inicializa((PTtabelaEstatistica)&(descritor.estatisticaId));
+  if(erro != SUCESSO){
+    PRINTLN("MEMORIA INSUFICIENTE PARA A TABELA DE ESTATISTICAS!");
+  }
+  // Indice de tempo e de identificadores ao lado de cada arquivo de registro. Sem memoria os arquivos ficam sem indice
+  erro = indiceRegistro_inicializa((PTindiceRegistro)&(descritor.indiceRegistro));
+  if(erro != SUCESSO){
+    PRINTLN("MEMORIA INSUFICIENTE PARA O INDICE DOS REGISTROS!");
+  }
+  // Todos os buffers ja foram reservados: a fila cresce somente com o heap que sobrou
+  protocoloCAN_ampliaFila((PTfilaMensagem)&(descritor.filaMensagem), TAMANHO_MAXIMO_BUFFER_FILA);
+
+  // Saude do barramento: a carga é calculada sobre a taxa configurada
+  saudeBarramento_inicializa((PTsaudeBarramento)&(descritor.saude), getBitsPorSegundoTaxa(descritor.configuracao.taxa));
+
+  // Publica a tabela e a saude na rede local
+  if(descritor.configuracao.wifi.conectado){
+    servidorEstatistica_inicializa((PTtabelaEstatistica)&(descritor.estatisticaId), (PTsaudeBarramento)&(descritor.saude));
+    PRINT("ESTATISTICAS EM http://");
+    PRINT(WiFi.localIP().toString());
+    PRINTLN(CAMINHO_SERVIDOR_ESTATISTICA);
+    PRINT("REGISTROS EM http://");
+    PRINT(WiFi.localIP().toString());
+    PRINTLN(CAMINHO_SERVIDOR_REGISTRO "?arquivo=N&id=7E8&inicio=0&fim=10");
+  }
+
+  // Se chegou até aqui então esta tudo correto. apenas sinaliza com LED INTERNO do ESP32 
+  PRINTLN("\n\n\nExecutando...");
+
+  digitalWrite(PINO_LED_INTERNO,HIGH);   
+  digitalWrite(LED_SISTEMA_PRONTO,HIGH);   
+
+  // Ativa flag das funções principais
+  protocoloCan_entrarNoSistema();  
+  
+  /*
+    Cria uma tarefa que será executada na função protocoloCAN_salvaRegistroCANFila, com prioridade 2
+    e execução no núcleo 0.
+    salvaRegistroCANFila: Captura os dados da linha CAN via SPI (MCP2515) e salva em uma fila de mensagens CAN
+  */
+  xTaskCreatePinnedToCore(
+    // Função que implementa a tarefa
+    protocoloCAN_salvaRegistroCANFila,
+    // Nome da tarefa
+    "salvaRegistroCANFila", 
+    // Numero de bytes a serem alocados para uso com a pilha da tarefa
+    // Fazendo teste com a função uxHighWaterMark = uxTaskGetStackHighWaterMark( NULL );
+    // percebe-se que a quantidade maxima de palavras usadas da pilha é de 1324.
+    // Com isso, 4KB (4096) é mais do que suficiente
+    TAMANHO_BUFFER_4K, // 
+    // Parametro de entrada da tarefa, nesse caso sera justamente um ponteiro para fila de mensagem
+    (PTdescritorSniffer)&descritor,       
+    // Prioridade da tarefa(0 à N)
+    2,
+    // Referencia para a tarefa (não é utilizado entao null)
+    &salvaRegistroCANFila,       
+    // Nucleo que estará sendo executado o proceso = 0
+    NUCLEO_ZERO
+  ); 
+                    
+  delay(500); //tempo para a tarefa iniciar
+  /*
+    Cria uma tarefa que será executada na função escritorCartao_tarefa, com prioridade 1
+    e execução no núcleo 0, abaixo da captura.
+    escreveCartao: Grava no cartão micro SD os buffers preenchidos pela tarefa de envio, assim uma
+    escrita lenta no cartão nao atrasa o desenfileiramento
+  */
+  xTaskCreatePinnedToCore(
+    // Função que implementa a tarefa
+    escritorCartao_tarefa, 
+    // Nome da tarefa
+    "escreveCartao", 
+    // Numero de bytes a serem alocados para uso com a pilha da tarefa
+    (TAMANHO_BUFFER_8K),      
+    // Parametro de entrada da tarefa, nesse caso o escritor do cartao
+    (PTescritorCartao)&(descritor.escritorCartao),       
+    // Prioridade da tarefa(0 à N)
+    1,
+    // Referencia para a tarefa
+    &escreveCartao,    
+    // Nucleo que estará sendo executado o proceso = 0   
+    NUCLEO_ZERO
+  );
+
+  /*
+    Cria uma tarefa que será executada na função enviadorServidor_tarefa, com prioridade 1
+    e execução no núcleo 1, ao lado da tarefa de envio.
+    enviaServidor: Envia ao servidor os blocos formatados pela tarefa de envio, assim uma rede lenta
+    ou fora do ar nao atrasa o desenfileiramento nem o registro no cartão
+  */
+  if(descritor.configuracao.wifi.conectado){
+    xTaskCreatePinnedToCore(
+      // Função que implementa a tarefa
+      enviadorServidor_tarefa, 
+      // Nome da tarefa
+      "enviaServidor", 
+      // Numero de bytes a serem alocados para uso com a pilha da tarefa (cliente HTTP)
+      (TAMANHO_BUFFER_10K),      
+      // Parametro de entrada da tarefa, nesse caso o enviador do servidor
+      (PTenviadorServidor)&(descritor.enviadorServidor),       
+      // Prioridade da tarefa(0 à N)
+      1,
+      // Referencia para a tarefa
+      &enviaServidor,    
+      // Nucleo que estará sendo executado o proceso = 1   
+      NUCLEO_UM
+    );
+  }
+
+  /*
+    Cria uma tarefa que será executada na função protocoloCAN_enviaRegistroCANFila, com prioridade 1
+    e execução no núcleo 1.
+    enviaRegistroCANFila: Envia os dados armazenados na estrutura de fila para cartão de memória ou servidor
+  */
+  xTaskCreatePinnedToCore(
+    // Função que implementa a tarefa
+    protocoloCAN_enviaRegistroCANFila, 
+    // Nome da tarefa
+    "enviaRegistroCANFila", 
+    // Numero de bytes a serem alocados para uso com a pilha da tarefa
+    (TAMANHO_BUFFER_20K),      
+    // Parametro de entrada da tarefa, nesse caso sera justamente um ponteiro para fila de mensagem
+    (PTdescritorSniffer)&descritor,       
+    // Prioridade da tarefa(0 à N)
+    1,
+    // Referencia para a tarefa (não é utilizado entao null)
+    &enviaRegistroCANFila,    
+    // Nucleo que estará sendo executado o proceso = 1   
+    NUCLEO_UM
+  );
+
+  delay(500); //tempo para a tarefa iniciar  
+  
+}
+
+
+/**
+ * @brief  Função que executa o loop infinito do esp32. O programa roda nas tarefas definidas no 
+ *         setup, aqui somente o servidor HTTP de estatisticas é atendido
+ * @return void
+ */
+
+void loop(){
+
+  servidorEstatistica_atende();
+  delay(TEMPO_ENTRE_ATENDIMENTOS_HTTP);
+
+/*
+TIMERG0.wdt_wprotect=TIMG_WDT_WKEY_VALUE;
+TIMERG0.wdt_feed=1;
+TIMERG0.wdt_wprotect=0;
+*/
+}
+
+/*********************************************************************************************************
+  END FILE
 *********************************************************************************************************/
\ No newline at end of file
@@ -1,565 +1,966 @@
-/**
- * @file    protocolo_can.cpp
- * @brief   Esse arquivo contem as funções relativas ao tratamento das mensagens CAN
- * @author  Emanoel Gomes Santos
- * @date    Data de Criação: 31/03/2020
-**/
-
-// Inclusões de bibliotecas do arduino
-#include <mcp_can.h>
-#include <SPI.h>
-#include "soc/timer_group_struct.h"
-#include "soc/timer_group_reg.h"
-//#include "esp_int_wdt.h"
-
-/// Inclusões de bibliotecas importantes
-#include "protocolo_can.h"
-
-// Definições de tamanho
-#define QUANTIDADE_MENSAGENS_POR_BLOCO  50   // nao alterar (suporta so 200 mensagens)
-#define TEMPO_ENTRE_ENVIOS_REQUISICOES  500  // pode ser alterado na faixa de 200 a 1000 (por segurança)
-#define TENTATIVAS_ENVIO_BLOCO_MENSAGEM 2       
-#define HA_MENSAGEM_NO_BUFFER(x)        (x>0)
-#define TAMANHO_MAXIMO_ARQUIVO          20000 
-#define TENTATIVAS_INICIALIZAR_CAN      5
-#define TEMPO_ENTRE_PISCA_LED           50
-
-// Declarações de variáveis
-#define CAN_INT           4                              // Set INT to pin 4
-#define CS_PIN_MCP_2515   15
-
-MCP_CAN CAN(CS_PIN_MCP_2515);                                     // Set CS to pin 5
-
-Tbool executando = VERDADEIRO;
-// Referenia para a tarefa
-TaskHandle_t salvaRegistroCANFila;
-TaskHandle_t enviaRegistroCANFila;
-
-/**
- * @brief  Função que desativa flag para entrar no sistema
- * @return void
- */
-void protocoloCan_sairDoSistema(void){
-  xSemaphoreTake(sistema,portMAX_DELAY);
-  // Apenas se esta executando que atualiza variavel executando, e finaliza fila
-  if(executando){
-    executando = FALSO;  
-  }
-  xSemaphoreGive(sistema);
-
-}
-/**
- * @brief  Função que ativa flag para entrar no sistema
- * @return void
- */
-void protocoloCan_entrarNoSistema(void){
-  executando = VERDADEIRO;  
-}
-
-/**
- * @brief  Função que configura os filtros escolhidos pelo usuário
- * @param  lista: Estrutura com a lista de filtros
- * @return void
- */
-void protocoloCAN_configuraFiltro(TlistaFiltrosAndMascaras lista){  
-  Tuint8 i;
-  Tuint32 filtroDefault;
-
-  // Se não existe nenhum filtro e nenhuma mascara, entao retornar e nao configurar nada
-  if((lista.quantidade == 0) && (!lista.mask_0) && (!lista.mask_1)){
-    return;
-  }
-  // Verifica qual tipo de filtro
-  if(lista.tipo == ePadrao){
-    filtroDefault = 0x7FF; 
-  }else{
-    filtroDefault = 0xFFFF;     
-  }
- 
-  // Trata situação que não ha mascaras
-  if((!lista.mask_0) && (!lista.mask_1)){
-    
-    // Se for padrao ativa primeira mascara
-    if(lista.tipo == ePadrao){
-      CAN.init_Mask(0,lista.tipo,filtroDefault);
-      CAN.init_Mask(1,lista.tipo,filtroDefault);
-
-        
-      // Insere os filtros
-      for(i=0; i<lista.quantidade; i++){
-        CAN.init_Filt(i,lista.tipo,lista.filtros[i].valor);
-      }
-      for(i=lista.quantidade; i<MAXIMA_QUANTIDADE_FILTROS; i++){
-        CAN.init_Filt(i, lista.tipo, lista.filtros[i%lista.quantidade].valor);
-      }         
-    }
-
-    else{
-      CAN.init_Mask(1,lista.tipo,filtroDefault);
-        
-      // Insere os filtros
-      for(i=2; i<lista.quantidade; i++){
-        CAN.init_Filt(i,lista.tipo,lista.filtros[(i-2)].valor);
-      }
-      for(i=(lista.quantidade+2); i<MAXIMA_QUANTIDADE_FILTROS; i++){
-        CAN.init_Filt(i,lista.tipo,0x00000000);
-      }  
-
-    }
-    
-  }
-
-  //////////////////////////////////////////////////////////////////////////////////////
-  // Trata situação que so existe uma mascara
-  else if(((!lista.mask_0) && (lista.mask_1)) || ((lista.mask_0) && (!lista.mask_1))){    
-    
-
-    // Tratas situação de filtro padrao com mascara 0
-    if(lista.mask_0){
-
-      CAN.init_Mask(0 , lista.tipo, 0x700);
-      for(i=0; i<QUANTIDADE_FILTROS_MASCARA_0; i++){
-        CAN.init_Filt(i,lista.tipo,lista.mascara_0);
-      } 
-
-      // Se existe filtro setado
-      if(lista.quantidade > 0){
-        CAN.init_Mask(1,lista.tipo,filtroDefault);
-
-        for(i=0; i<lista.quantidade; i++){          
-          CAN.init_Filt((i+2),lista.tipo,lista.filtros[i].valor);          
-        }     
-
-        // Restante das mascaras sao zeradas
-        for(i=(lista.quantidade+2); i<MAXIMA_QUANTIDADE_FILTROS; i++){
-          // (i+2), pois os slots da mascara zero (slot 0 e 1)  considera-se utilizados
-          CAN.init_Filt(i,lista.tipo,0x00000000);  
-        }        
-      }
-      else{
-        // Mascara 1 recebe filtro default 0x7FF
-        CAN.init_Mask(1,lista.tipo,filtroDefault);
-        
-        // Restante das mascaras sao zeradas
-        for(i=2; i<MAXIMA_QUANTIDADE_FILTROS; i++){
-          CAN.init_Filt(i,lista.tipo,0x00000000);
-        }      
-      }
-    }
-
-
-    else{ // lista.mask_1
-
-      CAN.init_Mask(1 , lista.tipo, 0x1FFF0000);
-      for(i=2; i<QUANTIDADE_FILTROS_MASCARA_1; i++){
-        CAN.init_Filt(i,lista.tipo,lista.mascara_1);
-      } 
-      
-    }
-    
-
-  }
- 
-}
-
-/**
- * @brief  Função que inicializa o protocolo CAN, inicializando a fila de mensagens
- * @param  taxa: taxa de comunicação CAN
- * @param  filtros: Ponteiro os filtros que se deseja configurar
- * @param  fila: Ponteiro para fila que sera criada
- * @param  tamanhoFila: Tamanho da fila de mensagens
- * @return ERRO ou SUCESSO
- */
-Terro protocoloCAN_inicializa(TaxaComunicacao taxa, TlistaFiltrosAndMascaras filtros, PTfilaMensagem filaMensagem, Tuint32 tamanhoFila){
-  Terro erro = SUCESSO;
-  Tuint16 tentativas = 0;
-
-  PRINT("\n------Protocolo CAN------\r\n\n");
-  PRINT("Inicializando CAN...\r\n");
-
-  // Initialize MCP2515 trabalhnado em 8MHZ com taxa de 500KBS e mascara e filtros desabilitados
-  while(CAN.begin(MCP_STDEXT, taxa, MCP_20MHZ) != CAN_OK){
-    PRINTLN(".");
-    delay(500);
-  }
-  // Configura os filtros 
-  protocoloCAN_configuraFiltro(filtros);
-  
-  // Seta can como normal para executar processo
-  CAN.setMode(MCP_LISTENONLY);
-
-  // Configura pino 4 como entrada de dados (interrupção)
-  pinMode(CAN_INT, INPUT);                            
-  
-  // Inicializa fila
-  do{
-    
-    erro = filaMensagem_inicializaFila(filaMensagem, tamanhoFila);
-    if(erro != SUCESSO){
-      PRINTLN("ERRO AO INICIALIZAR A FILA! TENTANDO NOVAMENTE...");
-      tentativas ++;
-    }
-  }while((erro != SUCESSO) && (tentativas < TENTATIVAS_INICIALIZAR_CAN)) ;
-
-  if(erro != SUCESSO){
-    return ERRO_INICIALIZACAO_CAN;
-  }
-
-  /*
-  heap_caps_print_heap_info(MALLOC_CAP_DEFAULT);
-  */
-  // Se chegou até aqui então mostrar sucesso 
-  PRINT("CAN inicializada com sucesso!\r\n\n");
-
-  return SUCESSO;
-
-}
-
-/**
- * @brief  Função que recupera a informação do ultimo arquivo escrito no cartao
- *         Isso será usado para controle dos nomes dos arquivos
- * @param  idArquivo: id do ultimo registro armazenado
- * @param  nomeArquivo: Nome do proximo registro
- * @return ERRO ou SUCESSO
- */
-Terro protocoloCAN_recuperaInformacaoUltimoArquivo(Tuint32 *idArquivo, char *nomeArquivo){
-  Terro erro = SUCESSO;
-  Tuint32 tamanhoArquivo = 0;
-  
-  // Se for a primeira utilização do produto, entao encrementa idArquivo e salva ultimo criado
-  if(*idArquivo == 0){
-
-    (*idArquivo)++;
-
-    (void)sprintf(nomeArquivo, ((char *)"/REGISTROS/LOG-%04d.txt"), *idArquivo);
-
-    // Abre apenas para criar
-    erro = gerenciamentoCartao_criaArquivo(nomeArquivo);
-    if(erro != SUCESSO){
-      PRINTLN("ERRO AO CRIAR CARTAO");
-    }
-
-    // Atualiza last file
-    erro = gerenciamentoCartao_atualizaLastFile(*idArquivo);
-    if(erro != SUCESSO){ 
-      PRINTLN("ERRO NO ENVIO DOS DADOS!!!");
-    }
-
-    // Criou novo arquivo e retornou
-    return SUCESSO;
-
-  }
-  // Atribui nome do arquivo com identificador recebido do cartao
-  (void)sprintf(nomeArquivo, ((char *)"/REGISTROS/LOG-%04d.txt"), (*idArquivo)); 
-
-  // Verifica-se o tamanho do arquivo com nome "nomeArquivo"
-  erro = gerenciamentoCartao_tamanhoArquivo(nomeArquivo, &tamanhoArquivo);
-  if(erro != SUCESSO){
-    return erro;
-  }
-
-  // Somente se o arquivo for maior que tamanho 0 que iremos criar um novo arquivo
-  if(tamanhoArquivo > 0){
-
-    (*idArquivo)++;
-    
-    // Cria path com id do arquivo incrementado, ou seja, proximo arquivo.
-    (void)sprintf(nomeArquivo, ((char *)"/REGISTROS/LOG-%04d.txt"), (*idArquivo));
-
-    // Abre apenas para criar
-    erro = gerenciamentoCartao_criaArquivo(nomeArquivo);
-    if(erro != SUCESSO){
-      PRINTLN("ERRO AO CRIAR CARTAO");
-    }
-    // Atualiza last file
-    erro = gerenciamentoCartao_atualizaLastFile((*idArquivo));
-    if(erro != SUCESSO){
-      PRINTLN("ERRO NO ENVIO DOS DADOS!!!");
-    }
-  }
-
-  // Se chegou aqui entao tudo ocorreu bem
-  return SUCESSO;
-}
-
-/**
- * @brief  Função que será executada em um loop infinito dentro de um processo.
- *         Essa função irá identificar se existe uma mensagem no buffer do MCP2515,
- *         se houver irá salvar a mensagem na fila de mensagens CAN
- * @param  filaMensagem: Ponteiro para a estrutura de fila da mensagem CAN
- * @return void
- */
-void protocoloCAN_salvaRegistroCANFila(void * descritor ){
-  Terro erro = SUCESSO;
-  TmensagemCAN mensagem;
-  Tempo inicio;
-  PTdescritorSniffer desc = (PTdescritorSniffer)descritor;
-  //Tempo teste_inicial, teste_final;
-
-
-  inicio = micros();
-  
-  // Loop infinito   
-  while(executando){
-
-    // Alimenta cao de guarda na mao. Tive que fazer isso para nao parar a função so pra alimenta-lo
-    TIMERG0.wdt_wprotect=TIMG_WDT_WKEY_VALUE;
-    TIMERG0.wdt_feed=1;
-    TIMERG0.wdt_wprotect=0;    
-
-    // Verifica se chegou alguma mensagens no buffer do MCP2515
-        
-    erro = (Terro)CAN.readMsgBuf_2(
-      (INT32U*)&mensagem.identificador.extendido,         
-      (INT8U*)&mensagem.tamanho, 
-      (INT8U*)&(mensagem.dados[0])      
-    );      
-
-    // Recebeu mensagem, entao colocar na fila
-    if(erro == CAN_OK){
-
-
-      //teste_inicial = micros();
-      mensagem.intervalo = (micros() - inicio);
-
-      // Insere dado recebido na fila de mensagens CAN
-      erro = filaMensagem_enfileirar(
-        (PTfilaMensagem)&(desc->filaMensagem), 
-        mensagem
-      );
-      if(erro != SUCESSO){
-        // Se ocorreu algum erro, então acender led de CAN e sai do sistema
-        digitalWrite(LED_ERRO_CAN,HIGH);                      
-        PRINTLN("FALHA AO ENFILEIRAR!");
-        protocoloCan_sairDoSistema();
-        continue;
-      }
-
-      //teste_final = micros();
-      //PRINTF("tempo enfileiramento: %d\r\n", (teste_final - teste_inicial));
-
-      // Define um novo inicio para o intervalo de tempo para a proxima interação
-      inicio = micros(); 
-
-
-
-    }
-  }  
-
-  filaMensagem_finalizaFila((PTfilaMensagem)&(desc->filaMensagem));
-  vTaskDelete(salvaRegistroCANFila);
-}
-
-
-/**
- * @brief  Função que será executada em um loop infinito dentro de um processo.
- *         Essa função irá retirar dados da fila e os enviar para os armazenadores, 
- *         sendo eles: servidor ou cartão de memória
- * @param  filaMensagem: Ponteiro para a estrutura de fila da mensagem CAN
- * @return void
- */
-void protocoloCAN_enviaRegistroCANFila(void * descritor){  
-  Terro erro = SUCESSO;
-  Tuint16 controleMensagemBloco = 0;
-  Tuint32 controleTamanhoArquivo = 0;  
-  Tempo inicio;  
-  Tuint16 tentativasEnvio = 0;     
-  PTmensagemCAN mensagemTx;
-  Tuint32 idArquivo = 0;
-  char nomeArquivo[TAMANHO_BUFFER_MENSAGEM_REGISTRO];
-  PTdescritorSniffer desc = (PTdescritorSniffer)descritor;
-  /*
-  UBaseType_t uxHighWaterMark;
-
-  uxHighWaterMark = uxTaskGetStackHighWaterMark (NULL);
-  PRINTF("PRIMEIRA CHAMADA: %d\r\n", uxHighWaterMark);
-  */
-
-  //Tempo teste_1,teste_2,total;
-
-  // Recebe id do ultimo arquivo e incrementa 1 para gerar o proximo arquivo
-  idArquivo = desc->configuracao.idArquivo;
-
-  // Verifica qual o ultimo arquivo do sistema para que possa decidir-se:
-  // Se o ultimo arquivo esta com tamanho zero, significa que ele apenas foi criado
-  // mas nao foi escrito, nesse caso devo escrever os novos frames nesse mesmo arquivo
-  // Caso contrario, o arquivo ja esta com um tamanho maior que zero, sigifnica que devo
-  // criar um novo arquivo.
-  erro = protocoloCAN_recuperaInformacaoUltimoArquivo(&idArquivo,nomeArquivo); 
-  if(erro != SUCESSO){
-    digitalWrite(LED_ERRO_CARTAO_MEMORIA,HIGH);  
-    // Sair do sistema
-    protocoloCan_sairDoSistema(); 
-  }
- 
-  // ================ aloca espaço para buffer de mensagem ===================   
-  mensagemTx = (PTmensagemCAN)malloc(sizeof(TmensagemCAN) * QUANTIDADE_MENSAGENS_POR_BLOCO);
-
-  // Define tempo inicial para ser usado posteriormente  
-  inicio = millis();
-
-  // Conecta ao servidor
-  if(desc->configuracao.wifi.conectado == VERDADEIRO){
-    erro = sniferCanServidor_conecta(desc->configuracao.servidor.reg);
-    if(erro != SUCESSO){
-      desc->configuracao.wifi.conectado = FALSO;
-    }
-  }
-
-  while(executando){    
-
-    // Alimenta cao de guarda na mao. Tive que fazer isso para nao parar a função so pra alimenta-lo
-    TIMERG1.wdt_wprotect=TIMG_WDT_WKEY_VALUE;
-    TIMERG1.wdt_feed=1;
-    TIMERG1.wdt_wprotect=0;  
-    
-    // Se nao houver mensagem
-    if(controleMensagemBloco == 0){
-      digitalWrite(LED_SISTEMA_PRONTO,  HIGH);
-    }
-
-    // Verifica se há mensagens a serem desenfileiradas ou se ha mensagens a serem enviadas
-    if((filaMensagem_tamanhoFila((PTfilaMensagem)&(desc->filaMensagem)) > 0) || (controleMensagemBloco > 0)){           
-
-      // Desenfileira a mensagem e insere em um buffer local      
-      erro =  filaMensagem_desenfileirar((PTfilaMensagem)&(desc->filaMensagem), &mensagemTx[controleMensagemBloco]);      
-      if(erro == SUCESSO){
-        // Se deu sucesso no enfileiramento da mensagem entao encrementa o contador
-        controleMensagemBloco ++;        
-        controleTamanhoArquivo ++;        
-      }
-
-      // Pisca led para indicar funcionamento do sistema
-      if(((millis() - inicio) % TEMPO_ENTRE_PISCA_LED) == 0){
-        digitalWrite(LED_SISTEMA_PRONTO,      !digitalRead(LED_SISTEMA_PRONTO));
-      }
-            
-      /*   
-      Verifica se o contador de mensagens ultrapassou o limite de mensagens suportadas pelo buffer local
-      ou se tempo limite entre envios foi estourado. Alem disso, são enviadas mensagens se somente se
-      houver mensagem no buffer local
-      */     
-      if( ((controleMensagemBloco == QUANTIDADE_MENSAGENS_POR_BLOCO)    || 
-          ((millis() - inicio) > TEMPO_ENTRE_ENVIOS_REQUISICOES) ) &&  
-           (HA_MENSAGEM_NO_BUFFER(controleMensagemBloco))
-        ){ 
-
-        if(controleTamanhoArquivo > TAMANHO_MAXIMO_ARQUIVO){
-          controleTamanhoArquivo = 0;
-          idArquivo ++;
-
-          (void)sprintf(nomeArquivo, ((char *)"/REGISTROS/LOG-%04d.txt"), idArquivo);
-
-          // Abre apenas para criar
-          erro = gerenciamentoCartao_criaArquivo(nomeArquivo);
-          if(erro != SUCESSO){
-            // Se ocorreu algum erro, então acender led de cartão de memória e sai do sistema
-            digitalWrite(LED_ERRO_CARTAO_MEMORIA,HIGH);            
-            PRINTLN("ERRO NO ENVIO DOS DADOS!!!");         
-            // Sair do sistema
-            protocoloCan_sairDoSistema();
-            continue;
-          }
-          
-          // Atualiza last file
-          erro = gerenciamentoCartao_atualizaLastFile(idArquivo);
-          if(erro != SUCESSO){
-
-            // Se ocorreu algum erro, então acender led de cartão de memória e sai do sistema
-            digitalWrite(LED_ERRO_CARTAO_MEMORIA,HIGH);              
-            PRINTLN("ERRO NO ENVIO DOS DADOS!!!");         
-            // Sair do sistema
-            protocoloCan_sairDoSistema();
-            continue;
-          }
-
-        }
-        
-        //total = millis();
-        //teste_1 = millis();
-
-        tentativasEnvio = 0;
-        // Envia dados para cartao micro SD
-        do{
-
-          erro = snifferCanRegistro_enviaDadosCartao(
-            (PTmensagemCAN)&mensagemTx[0],
-            controleMensagemBloco, 
-            nomeArquivo,
-            desc->configuracao.logFormatado,
-            desc->configuracao.monitorSerial
-          );
-          if(erro != SUCESSO){
-            PRINTF("ERRO NA TENTATIVA DE ENVIO AO CARTAO %d\r\n", tentativasEnvio);             
-          }          
-          tentativasEnvio ++;
-          
-        }while((erro != SUCESSO) && (tentativasEnvio < TENTATIVAS_ENVIO_BLOCO_MENSAGEM));        
-        
-        if(erro != SUCESSO){
-          // Se ocorreu algum erro, então acender led de cartão de memória e sai do sistema
-          digitalWrite(LED_ERRO_CARTAO_MEMORIA,HIGH);
-          digitalWrite(LED_SISTEMA_PRONTO,LOW);
-          PRINTLN("ERRO NO ENVIO DOS DADOS AO CARTAO DE MEMORIA!!!");  
-          // Desconectar do servidor
-          sniferCanServidor_desconecta();        
-          protocoloCan_sairDoSistema();  
-          continue; 
-        }
-
-        //PRINTF("TEMPO CARTAO: %d\r\n",(millis() - teste_1));
-        //teste_2 = millis();        
-        
-        // Somente se foi conectado ao wifi, tenta enviar ao servidor
-        if(desc->configuracao.wifi.conectado == VERDADEIRO){
-          
-          tentativasEnvio = 0;
-          // Envia dados para servidor via http
-          do{
-            erro = snifferCanRegistro_enviaDadosServidor(
-              (PTmensagemCAN)&mensagemTx[0],
-              controleMensagemBloco,
-              desc->configuracao.wifi,
-              desc->configuracao.servidor.reg
-            );
-            if(erro != SUCESSO){
-              PRINTF("ERRO NA TENTATIVA DE ENVIO AO SERVIDOR%d\r\n", tentativasEnvio);          
-            }          
-            tentativasEnvio ++;
-            
-          }while((erro != SUCESSO) && (tentativasEnvio < TENTATIVAS_ENVIO_BLOCO_MENSAGEM));        
-          if(erro != SUCESSO){
-            if(erro == ERRO_CONEXAO_WIFI){
-              desc->configuracao.wifi.conectado = FALSO;              
-            }
-            // Se ocorreu algum erro, então acender led do servidor sai do sistema
-            digitalWrite(LED_ERRO_SERVIDOR,HIGH);                                   
-            PRINTLN("ERRO NO ENVIO DOS DADOS AO SERVIDOR!!!");          
-          }
-        }
-
-        //PRINTF("TEMPO SERVIDOR: %d\r\n",(millis() - teste_2));
-        //PRINTF("TEMPO TOTAL: %d\r\n",(millis() - total));
-       
-        // Inicializa novamente o contador de tempo        
-        inicio = millis();
-
-        // Zera contador de mensagens recebidas
-        controleMensagemBloco = 0;      
-
-      }
-    }
-    /*
-    uxHighWaterMark = uxTaskGetStackHighWaterMark( NULL );
-    PRINTF("SEGUNDA CHAMADA: %d\r\n", uxHighWaterMark);  
-    */  
-  }
-
-  // Desconectar do servidor
-  sniferCanServidor_desconecta(); 
-  gerenciamentoCartao_finaliza();
- 
-  free(mensagemTx);
-  vTaskDelete(enviaRegistroCANFila);
-  
+/**
+ * @file    protocolo_can.cpp
+ * @brief   Esse arquivo contem as funções relativas ao tratamento das mensagens CAN
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 31/03/2020
+**/
+
+// Inclusões de bibliotecas do arduino
+#include <mcp_can.h>
+#include <SPI.h>
+#include <sys/time.h>
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "soc/timer_group_struct.h"
+#include "soc/timer_group_reg.h"
+//#include "esp_int_wdt.h"
+
+/// Inclusões de bibliotecas importantes
+#include "protocolo_can.h"
+
+// Definições de tamanho
+#define HA_MENSAGEM_NO_BUFFER(x)        (x>0)
+#define TAMANHO_MAXIMO_ARQUIVO          20000 
+#define TENTATIVAS_INICIALIZAR_CAN      5
+#define TEMPO_ENTRE_PISCA_LED           50
+#define TEMPO_MAXIMO_FINALIZA_CAPTURA   1000  // ms, espera da tarefa de envio pelo fim da captura
+
+// Declarações de variáveis
+#define CAN_INT           4                              // Set INT to pin 4
+#define CS_PIN_MCP_2515   15
+#define INTERRUPCAO_CAN_ATIVA  (digitalRead(CAN_INT) == LOW)   // INT do MCP2515 é ativo em nivel baixo
+
+// Instruções SPI e registradores do MCP2515 usados fora da leitura dos buffers de recepção
+#define MCP2515_FREQUENCIA_SPI          10000000  // maximo suportado pelo MCP2515
+#define MCP2515_REG_RXB0CTRL            0x60
+#define MCP2515_BIT_BUKT                0x04      // rolagem de RXB0 para RXB1 quando RXB0 estiver cheio
+#define DESLOCAMENTO_ID_PADRAO_MCP      16        // mcp_can em MCP_STDEXT: mascara/filtro padrao = ID << 16
+#define TEMPO_ENTRE_RELATORIOS_VAZAO    5000      // ms
+
+MCP_CAN CAN(CS_PIN_MCP_2515);                                     // Set CS to pin 5
+
+// Configuração do barramento SPI para o MCP2515
+static const SPISettings configuracaoSPIMCP2515(MCP2515_FREQUENCIA_SPI, MSBFIRST, SPI_MODE0);
+// Vazão de captura, atualizada somente pela tarefa de captura
+static volatile Tuint32 quadrosPorSegundo = 0;
+// Estado da captura (quadros capturados e instante do ultimo quadro)
+static TcapturaMCP2515 captura;
+
+Tbool executando = VERDADEIRO;
+// Referenia para a tarefa
+TaskHandle_t salvaRegistroCANFila;
+TaskHandle_t enviaRegistroCANFila;
+// Tarefa que sera acordada pela interrupção do MCP2515
+static TaskHandle_t tarefaCaptura = NULL;
+// Instante (esp_timer, us) da ultima borda do INT, escrito pela interrupção
+static volatile Tuint64 tempoInterrupcao = 0;
+static portMUX_TYPE travaTempoInterrupcao = portMUX_INITIALIZER_UNLOCKED;
+// Ancora entre o esp_timer e o relogio, obtida uma unica vez no inicio da captura
+static Tuint64 tempoInicioCaptura = 0;
+static Tuint64 relogioInicioCaptura = 0;
+
+/**
+ * @brief  Rotina de interrupção da borda de descida do pino INT do MCP2515.
+ *         Apenas marca o instante da borda e notifica a tarefa de captura, toda leitura SPI 
+ *         é feita fora da interrupção
+ * @return void
+ */
+static void IRAM_ATTR protocoloCAN_interrupcaoMCP2515(void){
+  BaseType_t tarefaAcordada = pdFALSE;
+
+  // Marca o instante da borda antes de qualquer outra coisa
+  portENTER_CRITICAL_ISR(&travaTempoInterrupcao);
+  tempoInterrupcao = (Tuint64)esp_timer_get_time();
+  portEXIT_CRITICAL_ISR(&travaTempoInterrupcao);
+
+  vTaskNotifyGiveFromISR(tarefaCaptura, &tarefaAcordada);
+  if(tarefaAcordada == pdTRUE){
+    portYIELD_FROM_ISR();
+  }
+}
+
+/**
+ * @brief  Função que executa a instrução RX STATUS do MCP2515
+ * @return byte de status (bits 7:6 indicam quais buffers de recepção estão cheios)
+ */
+static Tuint8 protocoloCAN_leStatusRX(void){
+  Tuint8 status;
+
+  SPI.beginTransaction(configuracaoSPIMCP2515);
+  digitalWrite(CS_PIN_MCP_2515, LOW);
+  (void)SPI.transfer(MCP2515_INSTRUCAO_STATUS_RX);
+  status = SPI.transfer(0x00);
+  digitalWrite(CS_PIN_MCP_2515, HIGH);
+  SPI.endTransaction();
+
+  return status;
+}
+
+/**
+ * @brief  Função que executa a instrução READ RX BUFFER e le os bytes seguintes em uma mesma janela
+ *         de chip select. Ao subir o chip select o MCP2515 limpa o RXnIF do buffer endereçado
+ * @param  instrucao: MCP2515_INSTRUCAO_LE_RXB0 ou MCP2515_INSTRUCAO_LE_RXB1
+ * @param  buffer: recebe os bytes lidos
+ * @param  tamanho: quantidade de bytes
+ * @return void
+ */
+static void protocoloCAN_leBufferRX(Tuint8 instrucao, Tuint8 *buffer, Tuint8 tamanho){
+  SPI.beginTransaction(configuracaoSPIMCP2515);
+  digitalWrite(CS_PIN_MCP_2515, LOW);
+  (void)SPI.transfer(instrucao);
+  SPI.transfer(buffer, tamanho);
+  digitalWrite(CS_PIN_MCP_2515, HIGH);
+  SPI.endTransaction();
+}
+
+/**
+ * @brief  Função que executa a instrução BIT MODIFY
+ * @param  registrador: endereço do registrador
+ * @param  mascara: bits que serão alterados
+ * @param  valor: novo valor dos bits da mascara
+ * @return void
+ */
+static void protocoloCAN_modificaBit(Tuint8 registrador, Tuint8 mascara, Tuint8 valor){
+  SPI.beginTransaction(configuracaoSPIMCP2515);
+  digitalWrite(CS_PIN_MCP_2515, LOW);
+  (void)SPI.transfer(MCP2515_INSTRUCAO_MODIFICA_BIT);
+  (void)SPI.transfer(registrador);
+  (void)SPI.transfer(mascara);
+  (void)SPI.transfer(valor);
+  digitalWrite(CS_PIN_MCP_2515, HIGH);
+  SPI.endTransaction();
+}
+
+/**
+ * @brief  Função que executa a instrução READ, lendo registradores seguidos em uma janela de chip select
+ * @param  registrador: endereço do primeiro registrador
+ * @param  dados: recebe os valores lidos
+ * @param  tamanho: quantidade de registradores
+ * @return void
+ */
+static void protocoloCAN_leRegistros(Tuint8 registrador, Tuint8 *dados, Tuint8 tamanho){
+  SPI.beginTransaction(configuracaoSPIMCP2515);
+  digitalWrite(CS_PIN_MCP_2515, LOW);
+  (void)SPI.transfer(MCP2515_INSTRUCAO_LE);
+  (void)SPI.transfer(registrador);
+  (void)memset(dados, 0x00, tamanho);
+  SPI.transfer(dados, tamanho);
+  digitalWrite(CS_PIN_MCP_2515, HIGH);
+  SPI.endTransaction();
+}
+
+/**
+ * @brief  Função que verifica o pino INT do MCP2515
+ * @return VERDADEIRO se o INT estiver ativo (nivel baixo)
+ */
+static Tbool protocoloCAN_interrupcaoAtiva(void){
+  return INTERRUPCAO_CAN_ATIVA;
+}
+
+/**
+ * @brief  Função que bloqueia a tarefa de captura ate a notificação da interrupção do MCP2515
+ * @param  tempoMaximo: espera maxima (ms)
+ * @param  tempoBorda: recebe o instante da ultima borda do INT
+ * @return quantidade de notificações recebidas, 0 se a espera esgotou
+ */
+static Tuint32 protocoloCAN_aguardaInterrupcao(Tuint32 tempoMaximo, Tuint64 *tempoBorda){
+  Tuint32 notificacoes = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(tempoMaximo));
+
+  portENTER_CRITICAL(&travaTempoInterrupcao);
+  *tempoBorda = tempoInterrupcao;
+  portEXIT_CRITICAL(&travaTempoInterrupcao);
+
+  return notificacoes;
+}
+
+/**
+ * @brief  Função que obtem o relogio da captura
+ * @return instante atual (esp_timer, us)
+ */
+static Tuint64 protocoloCAN_tempo(void){
+  return (Tuint64)esp_timer_get_time();
+}
+
+// Acesso da captura ao MCP2515 da placa
+static const TinterfaceMCP2515 interfaceMCP2515 = {
+  protocoloCAN_leStatusRX,
+  protocoloCAN_leBufferRX,
+  protocoloCAN_modificaBit,
+  protocoloCAN_leRegistros,
+  protocoloCAN_interrupcaoAtiva,
+  protocoloCAN_aguardaInterrupcao,
+  protocoloCAN_tempo
+};
+
+/**
+ * @brief  Função que habilita a rolagem (BUKT) de RXB0 para RXB1, assim um quadro que chega com 
+ *         RXB0 ainda cheio vai para RXB1 em vez de ser perdido
+ * @return void
+ */
+static void protocoloCAN_habilitaRolagemRX(void){
+  SPI.beginTransaction(configuracaoSPIMCP2515);
+  digitalWrite(CS_PIN_MCP_2515, LOW);
+  (void)SPI.transfer(MCP2515_INSTRUCAO_MODIFICA_BIT);
+  (void)SPI.transfer(MCP2515_REG_RXB0CTRL);
+  (void)SPI.transfer(MCP2515_BIT_BUKT);
+  (void)SPI.transfer(MCP2515_BIT_BUKT);
+  digitalWrite(CS_PIN_MCP_2515, HIGH);
+  SPI.endTransaction();
+}
+
+/**
+ * @brief  Função que retorna a vazão de captura medida no ultimo segundo
+ * @return quantidade de quadros por segundo
+ */
+Tuint32 protocoloCAN_obtemQuadrosPorSegundo(void){
+  return quadrosPorSegundo;
+}
+
+/**
+ * @brief  Função que desativa flag para entrar no sistema
+ * @return void
+ */
+void protocoloCan_sairDoSistema(void){
+  xSemaphoreTake(sistema,portMAX_DELAY);
+  // Apenas se esta executando que atualiza variavel executando, e finaliza fila
+  if(executando){
+    executando = FALSO;  
+  }
+  xSemaphoreGive(sistema);
+
+}
+/**
+ * @brief  Função que ativa flag para entrar no sistema
+ * @return void
+ */
+void protocoloCan_entrarNoSistema(void){
+  executando = VERDADEIRO;  
+}
+
+/**
+ * @brief  Função que configura os filtros escolhidos pelo usuário
+ * @param  lista: Estrutura com a lista de filtros
+ * @return void
+ */
+void protocoloCAN_configuraFiltro(TlistaFiltrosAndMascaras lista){  
+  Tuint8 i;
+  Tuint32 filtroDefault;
+
+  // Se não existe nenhum filtro e nenhuma mascara, entao retornar e nao configurar nada
+  if((lista.quantidade == 0) && (!lista.mask_0) && (!lista.mask_1)){
+    return;
+  }
+  // Verifica qual tipo de filtro
+  if(lista.tipo == ePadrao){
+    filtroDefault = 0x7FF; 
+  }else{
+    filtroDefault = 0xFFFF;     
+  }
+ 
+  // Trata situação que não ha mascaras
+  if((!lista.mask_0) && (!lista.mask_1)){
+    
+    // Se for padrao ativa primeira mascara
+    if(lista.tipo == ePadrao){
+      CAN.init_Mask(0,lista.tipo,filtroDefault);
+      CAN.init_Mask(1,lista.tipo,filtroDefault);
+
+        
+      // Insere os filtros
+      for(i=0; i<lista.quantidade; i++){
+        CAN.init_Filt(i,lista.tipo,lista.filtros[i].valor);
+      }
+      for(i=lista.quantidade; i<MAXIMA_QUANTIDADE_FILTROS; i++){
+        CAN.init_Filt(i, lista.tipo, lista.filtros[i%lista.quantidade].valor);
+      }         
+    }
+
+    else{
+      CAN.init_Mask(1,lista.tipo,filtroDefault);
+        
+      // Insere os filtros
+      for(i=2; i<lista.quantidade; i++){
+        CAN.init_Filt(i,lista.tipo,lista.filtros[(i-2)].valor);
+      }
+      for(i=(lista.quantidade+2); i<MAXIMA_QUANTIDADE_FILTROS; i++){
+        CAN.init_Filt(i,lista.tipo,0x00000000);
+      }  
+
+    }
+    
+  }
+
+  //////////////////////////////////////////////////////////////////////////////////////
+  // Trata situação que so existe uma mascara
+  else if(((!lista.mask_0) && (lista.mask_1)) || ((lista.mask_0) && (!lista.mask_1))){    
+    
+
+    // Tratas situação de filtro padrao com mascara 0
+    if(lista.mask_0){
+
+      CAN.init_Mask(0 , lista.tipo, 0x700);
+      for(i=0; i<QUANTIDADE_FILTROS_MASCARA_0; i++){
+        CAN.init_Filt(i,lista.tipo,lista.mascara_0);
+      } 
+
+      // Se existe filtro setado
+      if(lista.quantidade > 0){
+        CAN.init_Mask(1,lista.tipo,filtroDefault);
+
+        for(i=0; i<lista.quantidade; i++){          
+          CAN.init_Filt((i+2),lista.tipo,lista.filtros[i].valor);          
+        }     
+
+        // Restante das mascaras sao zeradas
+        for(i=(lista.quantidade+2); i<MAXIMA_QUANTIDADE_FILTROS; i++){
+          // (i+2), pois os slots da mascara zero (slot 0 e 1)  considera-se utilizados
+          CAN.init_Filt(i,lista.tipo,0x00000000);  
+        }        
+      }
+      else{
+        // Mascara 1 recebe filtro default 0x7FF
+        CAN.init_Mask(1,lista.tipo,filtroDefault);
+        
+        // Restante das mascaras sao zeradas
+        for(i=2; i<MAXIMA_QUANTIDADE_FILTROS; i++){
+          CAN.init_Filt(i,lista.tipo,0x00000000);
+        }      
+      }
+    }
+
+
+    else{ // lista.mask_1
+
+      CAN.init_Mask(1 , lista.tipo, 0x1FFF0000);
+      for(i=2; i<QUANTIDADE_FILTROS_MASCARA_1; i++){
+        CAN.init_Filt(i,lista.tipo,lista.mascara_1);
+      } 
+      
+    }
+    
+
+  }
+ 
+}
+
+/**
+ * @brief  Função que grava nas mascaras e filtros do MCP2515 a programação calculada pelo compilador
+ *         de filtros. Na biblioteca em MCP_STDEXT o identificador padrao ocupa os bits 26..16 
+ *         (os bits 15..0 sao os 2 primeiros bytes de dados, ignorados aqui)
+ * @param  programacao: programação calculada
+ * @return void
+ */
+void protocoloCAN_programaFiltros(PTprogramacaoFiltro programacao){
+  Tuint8 i;
+  Tuint8 mascara;
+
+  for(i=0; i<MAXIMA_QUANTIDADE_MASCARAS; i++){
+    CAN.init_Mask(i, programacao->extendido[i], 
+      (programacao->extendido[i]) ? programacao->mascara[i] : (programacao->mascara[i] << DESLOCAMENTO_ID_PADRAO_MCP));
+  }
+  for(i=0; i<MAXIMA_QUANTIDADE_FILTROS; i++){
+    mascara = (i < QUANTIDADE_FILTROS_MASCARA_0) ? 0 : 1;
+    CAN.init_Filt(i, programacao->extendido[mascara], 
+      (programacao->extendido[mascara]) ? programacao->filtro[i] : (programacao->filtro[i] << DESLOCAMENTO_ID_PADRAO_MCP));
+  }
+}
+
+/**
+ * @brief  Função que inicializa o protocolo CAN, inicializando a fila de mensagens
+ * @param  taxa: taxa de comunicação CAN
+ * @param  filtros: Ponteiro os filtros que se deseja configurar
+ * @param  programacao: programação calculada pelo compilador de filtros (usada se valida)
+ * @param  fila: Ponteiro para fila que sera criada
+ * @param  tamanhoFila: Tamanho da fila de mensagens
+ * @return ERRO ou SUCESSO
+ */
+Terro protocoloCAN_inicializa(TaxaComunicacao taxa, TlistaFiltrosAndMascaras filtros, PTprogramacaoFiltro programacao,
+                              PTfilaMensagem filaMensagem, Tuint32 tamanhoFila){
+  Terro erro = SUCESSO;
+  Tuint16 tentativas = 0;
+
+  PRINT("\n------Protocolo CAN------\r\n\n");
+  PRINT("Inicializando CAN...\r\n");
+
+  // Initialize MCP2515 trabalhnado em 8MHZ com taxa de 500KBS e mascara e filtros desabilitados
+  while(CAN.begin(MCP_STDEXT, taxa, MCP_20MHZ) != CAN_OK){
+    PRINTLN(".");
+    delay(500);
+  }
+  // Configura os filtros: a programação compilada tem prioridade sobre a lista manual
+  if(programacao->valida){
+    protocoloCAN_programaFiltros(programacao);
+  }else{
+    protocoloCAN_configuraFiltro(filtros);
+  }
+
+  // Habilita rolagem RXB0 -> RXB1 para absorver rajadas
+  protocoloCAN_habilitaRolagemRX();
+  
+  // Seta can como normal para executar processo
+  CAN.setMode(MCP_LISTENONLY);
+
+  // Configura pino 4 como entrada de dados (interrupção)
+  pinMode(CAN_INT, INPUT);                            
+  
+  // Inicializa fila
+  do{
+    
+    erro = filaMensagem_inicializaFila(filaMensagem, tamanhoFila);
+    if((erro == ERRO_ALOCACAO_MEMORIA) && (tamanhoFila > TAMANHO_MINIMO_BUFFER_FILA)){
+      // Nao ha bloco livre do tamanho pedido, tenta a metade
+      tamanhoFila /= 2;
+      PRINTF("MEMORIA INSUFICIENTE PARA A FILA! TENTANDO %u MENSAGENS...\r\n", tamanhoFila);
+    }else if(erro != SUCESSO){
+      PRINTLN("ERRO AO INICIALIZAR A FILA! TENTANDO NOVAMENTE...");
+      tentativas ++;
+    }
+  }while((erro != SUCESSO) && (tentativas < TENTATIVAS_INICIALIZAR_CAN)) ;
+
+  if(erro != SUCESSO){
+    return ERRO_INICIALIZACAO_CAN;
+  }
+
+  /*
+  heap_caps_print_heap_info(MALLOC_CAP_DEFAULT);
+  */
+  // Se chegou até aqui então mostrar sucesso 
+  PRINTF("FILA: %u mensagens de %u bytes\r\n", tamanhoFila, (Tuint32)sizeof(TmensagemCAN));
+  PRINT("CAN inicializada com sucesso!\r\n\n");
+
+  return SUCESSO;
+
+}
+
+/**
+ * @brief  Função que amplia a fila de mensagens com o heap que sobrou depois de todos os buffers da
+ *         inicialização, mantendo RESERVA_HEAP_AMPLIA_FILA livre. Chamada antes de criar as tarefas
+ * @param  filaMensagem: fila de mensagens, ainda sem produtor
+ * @param  tamanhoMaximo: maior tamanho da fila (potencia de 2)
+ * @return void
+ */
+void protocoloCAN_ampliaFila(PTfilaMensagem filaMensagem, Tuint32 tamanhoMaximo){
+  Tuint32 tamanho = tamanhoMaximo;
+  Tuint32 livre = (Tuint32)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+
+  // O array atual so é liberado depois do novo ser alocado
+  while((tamanho > filaMensagem->capacidadeMax) && 
+        (((sizeof(TmensagemCAN) * tamanho) + RESERVA_HEAP_AMPLIA_FILA) > livre)){
+    tamanho /= 2;
+  }
+  if(tamanho <= filaMensagem->capacidadeMax){
+    return;
+  }
+
+  if(filaMensagem_ampliaFila(filaMensagem, tamanho) == SUCESSO){
+    PRINTF("FILA AMPLIADA: %u mensagens de %u bytes\r\n", tamanho, (Tuint32)sizeof(TmensagemCAN));
+  }
+}
+
+/**
+ * @brief  Função que recupera a informação do ultimo arquivo escrito no cartao
+ *         Isso será usado para controle dos nomes dos arquivos
+ * @param  idArquivo: id do ultimo registro armazenado
+ * @param  nomeArquivo: Nome do proximo registro
+ * @param  formato: formato dos arquivos de registro, define a extensão
+ * @return ERRO ou SUCESSO
+ */
+Terro protocoloCAN_recuperaInformacaoUltimoArquivo(Tuint32 *idArquivo, char *nomeArquivo, TformatoRegistro formato){
+  Terro erro = SUCESSO;
+  Tuint32 tamanhoArquivo = 0;
+  
+  // Se for a primeira utilização do produto, entao encrementa idArquivo e salva ultimo criado
+  if(*idArquivo == 0){
+
+    (*idArquivo)++;
+
+    (void)sprintf(nomeArquivo, NOME_ARQUIVO_REGISTRO(formato), *idArquivo);
+
+    // Abre apenas para criar
+    erro = gerenciamentoCartao_criaArquivo(nomeArquivo);
+    if(erro != SUCESSO){
+      PRINTLN("ERRO AO CRIAR CARTAO");
+    }
+
+    // Atualiza last file
+    erro = gerenciamentoCartao_atualizaLastFile(*idArquivo);
+    if(erro != SUCESSO){ 
+      PRINTLN("ERRO NO ENVIO DOS DADOS!!!");
+    }
+
+    // Criou novo arquivo e retornou
+    return SUCESSO;
+
+  }
+  // Atribui nome do arquivo com identificador recebido do cartao
+  (void)sprintf(nomeArquivo, NOME_ARQUIVO_REGISTRO(formato), (*idArquivo)); 
+
+  // Arquivo prealocado que nao foi fechado (queda de energia) volta ao tamanho logico
+  erro = gerenciamentoCartao_recuperaRegistro(nomeArquivo);
+  if(erro == ERRO_ABRIR_CARTAO_PARA_ESCRITA){
+    PRINTLN("ERRO AO FINALIZAR O ULTIMO REGISTRO PREALOCADO");
+  }
+
+  // Verifica-se o tamanho do arquivo com nome "nomeArquivo". Se ele nao existe, o ultimo registro
+  // foi escrito no outro formato e o proximo identificador é usado
+  erro = gerenciamentoCartao_tamanhoArquivo(nomeArquivo, &tamanhoArquivo);
+  if(erro == ERRO_ABRIR_CARTAO_PARA_LEITURA){
+    tamanhoArquivo = 1;
+  }else if(erro != SUCESSO){
+    return erro;
+  }
+
+  // Somente se o arquivo for maior que tamanho 0 que iremos criar um novo arquivo
+  if(tamanhoArquivo > 0){
+
+    (*idArquivo)++;
+    
+    // Cria path com id do arquivo incrementado, ou seja, proximo arquivo.
+    (void)sprintf(nomeArquivo, NOME_ARQUIVO_REGISTRO(formato), (*idArquivo));
+
+    // Abre apenas para criar
+    erro = gerenciamentoCartao_criaArquivo(nomeArquivo);
+    if(erro != SUCESSO){
+      PRINTLN("ERRO AO CRIAR CARTAO");
+    }
+    // Atualiza last file
+    erro = gerenciamentoCartao_atualizaLastFile((*idArquivo));
+    if(erro != SUCESSO){
+      PRINTLN("ERRO NO ENVIO DOS DADOS!!!");
+    }
+  }
+
+  // Se chegou aqui entao tudo ocorreu bem
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que será executada em um loop infinito dentro de um processo.
+ *         A tarefa fica bloqueada até a interrupção do MCP2515 (borda de descida no INT) notificá-la,
+ *         então drena todos os buffers de recepção pendentes, salvando as mensagens na fila de 
+ *         mensagens CAN, e volta a bloquear. Assim o núcleo fica livre enquanto não há quadros.
+ * @param  filaMensagem: Ponteiro para a estrutura de fila da mensagem CAN
+ * @return void
+ */
+void protocoloCAN_salvaRegistroCANFila(void * descritor ){
+  Terro erro;
+  struct timeval relogio;
+  Tempo inicioVazao;
+  Tuint32 quadrosInicioVazao = 0;
+  PTdescritorSniffer desc = (PTdescritorSniffer)descritor;
+
+  // A interrupção é registrada aqui para que seja atendida no mesmo núcleo da tarefa de captura
+  tarefaCaptura = xTaskGetCurrentTaskHandle();
+  attachInterrupt(digitalPinToInterrupt(CAN_INT), protocoloCAN_interrupcaoMCP2515, FALLING);
+
+  // Ancora o esp_timer ao relogio (ajustado por NTP se houve conexão)
+  (void)gettimeofday(&relogio, NULL);
+  capturaMCP2515_inicializa(&captura, &interfaceMCP2515);
+  tempoInicioCaptura = captura.ultimoTempo;
+  relogioInicioCaptura = (((Tuint64)relogio.tv_sec * 1000000ULL) + (Tuint64)relogio.tv_usec);
+
+  inicioVazao = millis();
+  
+  // Loop infinito   
+  while(executando){
+
+    // Aguarda a borda do INT e drena os buffers do MCP2515 direto na fila
+    erro = capturaMCP2515_executa(&captura, desc, &executando);
+    if(erro != SUCESSO){
+      // Se ocorreu algum erro, então acender led de CAN e sai do sistema
+      digitalWrite(LED_ERRO_CAN,HIGH);                      
+      PRINTLN("FALHA AO ENFILEIRAR!");
+      protocoloCan_sairDoSistema();
+      break;
+    }
+
+    // Le os contadores de erro e os estouros do MCP2515 periodicamente
+    capturaMCP2515_amostraSaude(&captura, (PTsaudeBarramento)&(desc->saude));
+
+    // Atualiza a vazão a cada segundo
+    if((millis() - inicioVazao) >= 1000){
+      quadrosPorSegundo = (captura.quadrosCapturados - quadrosInicioVazao);
+      quadrosInicioVazao = captura.quadrosCapturados;
+      inicioVazao = millis();
+    }
+  }  
+
+  detachInterrupt(digitalPinToInterrupt(CAN_INT));
+  // A fila é liberada pela tarefa de envio, que pode estar copiando um lote neste momento.
+  // A notificação avisa que a captura nao toca mais na fila
+  if(enviaRegistroCANFila != NULL){
+    xTaskNotifyGive(enviaRegistroCANFila);
+  }
+  vTaskDelete(salvaRegistroCANFila);
+}
+
+
+/**
+ * @brief  Função que escreve um trecho de texto no monitor serial
+ * @param  texto: trecho do texto
+ * @param  tamanho: quantidade de caracteres
+ * @return void
+ */
+static void protocoloCAN_escreveSerial(const char *texto, Tuint16 tamanho){
+  Serial.write((const uint8_t *)texto, tamanho);
+}
+
+/**
+ * @brief  Função que será executada em um loop infinito dentro de um processo.
+ *         Essa função irá retirar dados da fila e os enviar para os armazenadores, 
+ *         sendo eles: servidor ou cartão de memória
+ * @param  filaMensagem: Ponteiro para a estrutura de fila da mensagem CAN
+ * @return void
+ */
+void protocoloCAN_enviaRegistroCANFila(void * descritor){  
+  Terro erro = SUCESSO;
+  Tuint32 controleMensagemBloco = 0;
+  Tuint32 controleTamanhoArquivo = 0;  
+  Tuint32 quantidadeLote = 0;
+  Tuint32 perdidosFila = 0;
+  Tuint32 perdidosRegistrados = 0;
+  Tuint32 eventosSaude = 0;
+  Tuint32 eventosSaudeRegistrados = 0;
+  Tbool forcaEnvio = FALSO;
+  TblocoMensagens bloco;
+  TestatisticaFila estatistica;
+  TamostraSaude amostraSaude;
+  char textoSaude[TAMANHO_MAXIMO_JSON_SAUDE];
+  Tuint32 blocosCartao, latenciaMedia, latenciaMaxima;
+  Tuint32 buffersCartao, esperasCartao;
+  Tuint32 quadrosColunar, bytesColunas, bytesColunar, tempoColunar;
+  Tuint32 tamanhoArena, maximoArena, reservasArena, falhasArena;
+  Tuint32 requisicoesServidor, blocosServidor, descartadosServidor, falhasServidor, atrasoServidor, pendentesServidor;
+  Tuint32 conexoesServidor;
+  TtamanhoBloco tamanhoBloco;
+  Tuint64 inicioBloco = 0;
+  Tuint64 fechamentoBloco;
+  Tuint64 fechamentoAnterior;
+  Tempo inicio;  
+  Tempo inicioRelatorio;
+  PTmensagemCAN mensagemTx;
+  Tuint32 idArquivo = 0;
+  char nomeArquivo[TAMANHO_BUFFER_MENSAGEM_REGISTRO];
+  PTdescritorSniffer desc = (PTdescritorSniffer)descritor;
+  /*
+  UBaseType_t uxHighWaterMark;
+
+  uxHighWaterMark = uxTaskGetStackHighWaterMark (NULL);
+  PRINTF("PRIMEIRA CHAMADA: %d\r\n", uxHighWaterMark);
+  */
+
+  //Tempo teste_1,teste_2,total;
+
+  // Recebe id do ultimo arquivo e incrementa 1 para gerar o proximo arquivo
+  idArquivo = desc->configuracao.idArquivo;
+
+  // Verifica qual o ultimo arquivo do sistema para que possa decidir-se:
+  // Se o ultimo arquivo esta com tamanho zero, significa que ele apenas foi criado
+  // mas nao foi escrito, nesse caso devo escrever os novos frames nesse mesmo arquivo
+  // Caso contrario, o arquivo ja esta com um tamanho maior que zero, sigifnica que devo
+  // criar um novo arquivo.
+  erro = protocoloCAN_recuperaInformacaoUltimoArquivo(&idArquivo,nomeArquivo,desc->configuracao.formatoRegistro); 
+  if(erro != SUCESSO){
+    digitalWrite(LED_ERRO_CARTAO_MEMORIA,HIGH);  
+    // Sair do sistema
+    protocoloCan_sairDoSistema(); 
+  }
+ 
+  // ================ toma da arena o buffer de mensagem ===================   
+  // Reserva permanente, feita antes de qualquer marca. O main dimensiona a arena para o maior bloco
+  mensagemTx = (PTmensagemCAN)arenaBloco_reserva(
+    (PTarenaBloco)&(desc->arenaBloco), 
+    (sizeof(TmensagemCAN) * desc->configuracao.maximoMensagensBloco)
+  );
+  if(mensagemTx == NULL){
+    digitalWrite(LED_ERRO_CARTAO_MEMORIA,HIGH);  
+    PRINTLN("MEMORIA INSUFICIENTE PARA O BUFFER DE MENSAGENS!!!");
+    protocoloCan_sairDoSistema(); 
+  }
+  bloco.mensagem = mensagemTx;
+  bloco.quantidade = 0;
+  bloco.quadrosPerdidos = 0;
+  bloco.quadrosSuprimidos = 0;
+  bloco.eventoSaude = FALSO;
+
+  // O bloco começa com QUANTIDADE_INICIAL_MENSAGENS_POR_BLOCO e se ajusta a cada envio
+  tamanhoBloco_inicializa(&tamanhoBloco, desc->configuracao.maximoMensagensBloco, desc->configuracao.latenciaBloco);
+
+  // Define tempo inicial para ser usado posteriormente  
+  inicio = millis();
+  inicioRelatorio = millis();
+  fechamentoAnterior = (Tuint64)esp_timer_get_time();
+
+  while(executando){    
+
+    // Alimenta cao de guarda na mao. Tive que fazer isso para nao parar a função so pra alimenta-lo
+    TIMERG1.wdt_wprotect=TIMG_WDT_WKEY_VALUE;
+    TIMERG1.wdt_feed=1;
+    TIMERG1.wdt_wprotect=0;  
+    
+    // Mostra a vazão de captura no monitor serial
+    if(desc->configuracao.monitorSerial && ((millis() - inicioRelatorio) > TEMPO_ENTRE_RELATORIOS_VAZAO)){
+      filaMensagem_obtemEstatistica((PTfilaMensagem)&(desc->filaMensagem), &estatistica);
+      PRINTF("VAZAO CAPTURA: %u quadros/s\r\n", protocoloCAN_obtemQuadrosPorSegundo());
+      PRINTF("FILA: %u enfileiradas, %u sobrescritas, %u descartadas, maximo %u, %u estouros\r\n",
+        estatistica.enfileiradas, estatistica.sobrescritas, estatistica.descartadas, 
+        estatistica.marcaMaxima, estatistica.eventosEstouro);
+      saudeBarramento_le((PTsaudeBarramento)&(desc->saude), &amostraSaude);
+      (void)saudeBarramento_formataJSON(textoSaude, &amostraSaude);
+      PRINTF("SAUDE: %s\r\n", textoSaude);
+      blocosCartao = snifferCanCartao_obtemLatencia(&latenciaMedia, &latenciaMaxima);
+      PRINTF("LATENCIA CARTAO: %u blocos, media %u us, maximo %u us\r\n", blocosCartao, latenciaMedia, latenciaMaxima);
+      escritorCartao_obtemEstatistica((PTescritorCartao)&(desc->escritorCartao), &buffersCartao, &latenciaMaxima, &esperasCartao);
+      PRINTF("ESCRITOR CARTAO: %u buffers, maximo %u us, %u esperas por buffer livre\r\n", buffersCartao, latenciaMaxima, esperasCartao);
+      registroColunar_obtemEstatistica(&quadrosColunar, &bytesColunas, &bytesColunar, &tempoColunar);
+      if(quadrosColunar > 0){
+        PRINTF("COLUNAR: %u quadros, %u bytes em colunas, %u bytes comprimidos (%u.%02u bytes/quadro), %u ns/quadro\r\n",
+          quadrosColunar, bytesColunas, bytesColunar, (bytesColunar / quadrosColunar), 
+          (((bytesColunar % quadrosColunar) * 100) / quadrosColunar), 
+          (Tuint32)(((Tuint64)tempoColunar * 1000ULL) / quadrosColunar));
+      }
+      arenaBloco_obtemEstatistica((PTarenaBloco)&(desc->arenaBloco), &tamanhoArena, &maximoArena, &reservasArena, &falhasArena);
+      PRINTF("ARENA BLOCO: %u bytes, maximo %u, %u reservas, %u falhas. HEAP: %u livres, maior bloco %u\r\n",
+        tamanhoArena, maximoArena, reservasArena, falhasArena, 
+        (Tuint32)heap_caps_get_free_size(MALLOC_CAP_8BIT), (Tuint32)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+      PRINTF("BLOCO: alvo %u mensagens, enchimento %u ms, envio medio %u us, vazao %u quadros/s\r\n",
+        tamanhoBloco_alvo(&tamanhoBloco), (tamanhoBloco_tempoEnchimento(&tamanhoBloco) / 1000), 
+        tamanhoBloco.tempoEnvio, tamanhoBloco.quadrosPorSegundo);
+      if(desc->configuracao.wifi.conectado == VERDADEIRO){
+        enviadorServidor_obtemEstatistica((PTenviadorServidor)&(desc->enviadorServidor), &requisicoesServidor, &blocosServidor,
+                                          &descartadosServidor, &falhasServidor, &atrasoServidor, &pendentesServidor,
+                                          &conexoesServidor);
+        PRINTF("ENVIADOR SERVIDOR: %u requisicoes, %u blocos, %u descartados, %u falhas, atraso maximo %u ms, %u pendentes, %u conexoes\r\n",
+          requisicoesServidor, blocosServidor, descartadosServidor, falhasServidor, atrasoServidor, pendentesServidor,
+          conexoesServidor);
+      }
+      PRINT("ESTATISTICA IDS: ");
+      estatisticaId_escreveTabelaJSON((PTtabelaEstatistica)&(desc->estatisticaId), (Tuint64)esp_timer_get_time(), 
+                                      protocoloCAN_escreveSerial);
+      PRINTLN();
+      inicioRelatorio = millis();
+    }
+
+    // Se nao houver mensagem
+    if(controleMensagemBloco == 0){
+      digitalWrite(LED_SISTEMA_PRONTO,  HIGH);
+    }
+
+    // Entrega à tarefa de escrita o buffer que passou do tempo maximo, mesmo sem novos blocos
+    escritorCartao_verificaTempo((PTescritorCartao)&(desc->escritorCartao));
+    // Entrega à tarefa de envio os blocos que se juntaram enquanto ela estava ocupada
+    if(desc->configuracao.wifi.conectado == VERDADEIRO){
+      enviadorServidor_verificaEntrega((PTenviadorServidor)&(desc->enviadorServidor));
+    }
+
+    // Verifica se há mensagens a serem desenfileiradas ou se ha mensagens a serem enviadas
+    if((filaMensagem_tamanhoFila((PTfilaMensagem)&(desc->filaMensagem)) > 0) || (controleMensagemBloco > 0)){           
+
+      // Verifica se a fila perdeu mensagens desde o ultimo desenfileiramento. A lacuna fica antes
+      // das mensagens que ainda estao na fila, entao o bloco atual é enviado primeiro e o marcador
+      // vai no inicio do proximo bloco
+      perdidosFila = filaMensagem_quantidadePerdida((PTfilaMensagem)&(desc->filaMensagem));
+      if(perdidosFila != perdidosRegistrados){
+        if(HA_MENSAGEM_NO_BUFFER(controleMensagemBloco)){
+          forcaEnvio = VERDADEIRO;
+        }else{
+          bloco.quadrosPerdidos += (perdidosFila - perdidosRegistrados);
+          perdidosRegistrados = perdidosFila;
+        }
+      }
+
+      // O mesmo para os eventos de saude do barramento (mudança de estado de erro ou estouro no MCP2515)
+      eventosSaude = __atomic_load_n(&(desc->saude.eventos), __ATOMIC_ACQUIRE);
+      if(eventosSaude != eventosSaudeRegistrados){
+        if(HA_MENSAGEM_NO_BUFFER(controleMensagemBloco)){
+          forcaEnvio = VERDADEIRO;
+        }else{
+          saudeBarramento_le((PTsaudeBarramento)&(desc->saude), &bloco.saude);
+          bloco.eventoSaude = VERDADEIRO;
+          eventosSaudeRegistrados = eventosSaude;
+        }
+      }
+
+      if(!forcaEnvio){
+        // Desenfileira de uma vez todas as mensagens que cabem no restante do buffer local
+        erro = filaMensagem_desenfileirarLote(
+          (PTfilaMensagem)&(desc->filaMensagem), 
+          &mensagemTx[controleMensagemBloco],
+          (tamanhoBloco_alvo(&tamanhoBloco) - controleMensagemBloco),
+          &quantidadeLote
+        );      
+        if(erro == SUCESSO){
+          // Segundo estagio de filtro: mantem somente as mensagens aceitas pelo filtro de software
+          quantidadeLote = filtroSoftware_compacta(
+            (PTfiltroSoftware)&(desc->filtroSoftware),
+            &mensagemTx[controleMensagemBloco],
+            quantidadeLote
+          );
+          // Terceiro estagio: no registro de mudanças remove os quadros com os mesmos dados do ultimo registro
+          quantidadeLote = registroMudanca_compacta(
+            (PTregistroMudanca)&(desc->registroMudanca),
+            &mensagemTx[controleMensagemBloco],
+            quantidadeLote,
+            (Tuint64)esp_timer_get_time(),
+            &bloco.quadrosSuprimidos
+          );
+          // A latencia do bloco conta a partir da sua primeira mensagem
+          if((controleMensagemBloco == 0) && (quantidadeLote > 0)){
+            inicioBloco = (Tuint64)esp_timer_get_time();
+          }
+          // Se deu sucesso no desenfileiramento das mensagens entao encrementa os contadores
+          controleMensagemBloco += quantidadeLote;        
+          controleTamanhoArquivo += quantidadeLote;        
+        }
+      }
+
+      // Pisca led para indicar funcionamento do sistema
+      if(((millis() - inicio) % TEMPO_ENTRE_PISCA_LED) == 0){
+        digitalWrite(LED_SISTEMA_PRONTO,      !digitalRead(LED_SISTEMA_PRONTO));
+      }
+            
+      /*   
+      Verifica se o contador de mensagens chegou ao tamanho atual do bloco ou se a primeira mensagem
+      do bloco ja esperou o tempo de enchimento. Alem disso, são enviadas mensagens se somente se
+      houver mensagem no buffer local
+      */     
+      if( ((controleMensagemBloco >= tamanhoBloco_alvo(&tamanhoBloco))                                          || 
+          (((Tuint64)esp_timer_get_time() - inicioBloco) >= tamanhoBloco_tempoEnchimento(&tamanhoBloco))     ||
+           (forcaEnvio)) &&  
+           (HA_MENSAGEM_NO_BUFFER(controleMensagemBloco))
+        ){ 
+
+        if(controleTamanhoArquivo > TAMANHO_MAXIMO_ARQUIVO){
+          controleTamanhoArquivo = 0;
+          idArquivo ++;
+
+          (void)sprintf(nomeArquivo, NOME_ARQUIVO_REGISTRO(desc->configuracao.formatoRegistro), idArquivo);
+
+          // Abre apenas para criar. A tarefa de escrita troca o arquivo aberto ao receber o
+          // primeiro buffer com o novo caminho
+          erro = gerenciamentoCartao_criaArquivo(nomeArquivo);
+          if(erro != SUCESSO){
+            // Se ocorreu algum erro, então acender led de cartão de memória e sai do sistema
+            digitalWrite(LED_ERRO_CARTAO_MEMORIA,HIGH);            
+            PRINTLN("ERRO NO ENVIO DOS DADOS!!!");         
+            // Sair do sistema
+            protocoloCan_sairDoSistema();
+            continue;
+          }
+          
+          // Atualiza last file
+          erro = gerenciamentoCartao_atualizaLastFile(idArquivo);
+          if(erro != SUCESSO){
+
+            // Se ocorreu algum erro, então acender led de cartão de memória e sai do sistema
+            digitalWrite(LED_ERRO_CARTAO_MEMORIA,HIGH);              
+            PRINTLN("ERRO NO ENVIO DOS DADOS!!!");         
+            // Sair do sistema
+            protocoloCan_sairDoSistema();
+            continue;
+          }
+
+        }
+        
+        //total = millis();
+        //teste_1 = millis();
+
+        bloco.mensagem = (PTmensagemCAN)&mensagemTx[0];
+        bloco.quantidade = controleMensagemBloco;
+        // Referencia posterior a todas as mensagens do bloco para reconstruir o tempo de 64 bits
+        bloco.tempoReferencia = (Tuint64)esp_timer_get_time();
+        fechamentoBloco = bloco.tempoReferencia;
+        bloco.relogioReferencia = (relogioInicioCaptura + (bloco.tempoReferencia - tempoInicioCaptura));
+
+        // Envia dados para cartao micro SD. As novas tentativas de gravação sao da tarefa de escrita:
+        // um erro aqui é de um buffer ja perdido (ou da formatação) e repetir o bloco nao o recupera
+        erro = snifferCanRegistro_enviaDadosCartao(
+          (PTescritorCartao)&(desc->escritorCartao),
+          (PTindiceRegistro)&(desc->indiceRegistro),
+          (PTarenaBloco)&(desc->arenaBloco),
+          &bloco,
+          nomeArquivo,
+          desc->configuracao.formatoRegistro,
+          desc->configuracao.logFormatado,
+          desc->configuracao.monitorSerial
+        );
+        if(erro != SUCESSO){
+          // Se ocorreu algum erro, então acender led de cartão de memória e sai do sistema
+          digitalWrite(LED_ERRO_CARTAO_MEMORIA,HIGH);
+          digitalWrite(LED_SISTEMA_PRONTO,LOW);
+          PRINTLN("ERRO NO ENVIO DOS DADOS AO CARTAO DE MEMORIA!!!");  
+          protocoloCan_sairDoSistema();  
+          continue; 
+        }
+
+        //PRINTF("TEMPO CARTAO: %d\r\n",(millis() - teste_1));
+        //teste_2 = millis();        
+        
+        // Somente se foi conectado ao wifi, entrega o bloco à tarefa de envio ao servidor. A
+        // requisição nao acontece aqui, uma rede lenta nao atrasa o desenfileiramento
+        if(desc->configuracao.wifi.conectado == VERDADEIRO){
+          erro = snifferCanRegistro_enviaDadosServidor(
+            (PTenviadorServidor)&(desc->enviadorServidor),
+            (PTarenaBloco)&(desc->arenaBloco),
+            &bloco,
+            desc->configuracao.formatoServidor
+          );
+          if(erro != SUCESSO){
+            PRINTLN("ERRO NA FORMATACAO DOS DADOS AO SERVIDOR!!!");          
+          }
+        }
+
+        //PRINTF("TEMPO SERVIDOR: %d\r\n",(millis() - teste_2));
+        //PRINTF("TEMPO TOTAL: %d\r\n",(millis() - total));
+
+        // Recalcula o tamanho do proximo bloco com a vazão e o tempo de envio deste
+        tamanhoBloco_registraEnvio(
+          &tamanhoBloco,
+          controleMensagemBloco,
+          (Tuint32)(fechamentoBloco - fechamentoAnterior),
+          (Tuint32)((Tuint64)esp_timer_get_time() - fechamentoBloco)
+        );
+        fechamentoAnterior = fechamentoBloco;
+       
+        // Inicializa novamente o contador de tempo        
+        inicio = millis();
+
+        // Zera contador de mensagens recebidas e a lacuna ja registrada
+        controleMensagemBloco = 0;      
+        bloco.quadrosPerdidos = 0;
+        bloco.quadrosSuprimidos = 0;
+        bloco.eventoSaude = FALSO;
+        forcaEnvio = FALSO;
+
+      }
+    }
+    /*
+    uxHighWaterMark = uxTaskGetStackHighWaterMark( NULL );
+    PRINTF("SEGUNDA CHAMADA: %d\r\n", uxHighWaterMark);  
+    */  
+  }
+
+  // A tarefa de envio termina os buffers pendentes e desconecta do servidor
+  if(desc->configuracao.wifi.conectado == VERDADEIRO){
+    enviadorServidor_finaliza((PTenviadorServidor)&(desc->enviadorServidor));
+  }
+  // O indice do ultimo arquivo é finalizado antes dos buffers serem gravados
+  indiceRegistro_finaliza((PTindiceRegistro)&(desc->indiceRegistro), (PTescritorCartao)&(desc->escritorCartao));
+  // Se a tarefa de escrita nao confirmar o fim ela ainda pode estar no cartao: nao desmonta
+  if(escritorCartao_finaliza((PTescritorCartao)&(desc->escritorCartao)) == SUCESSO){
+    gerenciamentoCartao_finaliza();
+  }else{
+    PRINTLN("ESCRITA NO CARTAO NAO FINALIZOU, CARTAO NAO DESMONTADO!");
+  }
+
+  // Libera a fila somente depois da captura avisar que terminou. Se o aviso nao chegar, a fila
+  // fica alocada: perder a memoria é melhor que a captura escrever em memoria liberada
+  if(ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(TEMPO_MAXIMO_FINALIZA_CAPTURA)) > 0){
+    filaMensagem_finalizaFila((PTfilaMensagem)&(desc->filaMensagem));
+  }else{
+    PRINTLN("CAPTURA NAO FINALIZOU, FILA NAO LIBERADA!");
+  }
+ 
+  vTaskDelete(enviaRegistroCANFila);
+  
 }
\ No newline at end of file
@@ -1,38 +1,49 @@
-/**
- * @file    protocolo_can.h
- * @brief   Esse arquivo contem o prototipo das funções relativas a implementação 
- *          interface do cartao de memória micro SD
- * @author  Emanoel Gomes Santos
- * @date    Data de Criação: 30/03/2020
-**/
-#ifndef PROTOCOLO_CAN_H_INCLUDED
-#define PROTOCOLO_CAN_H_INCLUDED
-
-/// Inclusões importantes
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-
-/// Submódulos do sistema
-#include "tipos.h"
-#include "erros.h"
-#include "fila_mensagem.h"
-#include "snifferCan_registro.h"
-#include "snifferCan_wifi.h"
-
-
-/// Funções exportadass
-void  protocoloCAN_salvaRegistroCANFila(void * filaMensagem );
-void  protocoloCAN_enviaRegistroCANFila(void * filaMensagem );
-Terro protocoloCAN_inicializa(TaxaComunicacao taxa, 
-                              TlistaFiltrosAndMascaras filtros, 
-                              PTfilaMensagem filaMensagem, 
-                              Tuint32 tamanhoFila);
-void protocoloCan_entrarNoSistema(void);
-
-// Referenia para a tarefa
-extern TaskHandle_t salvaRegistroCANFila;
-extern TaskHandle_t enviaRegistroCANFila;
-
-
-#endif // PROTOCOLO_CAN_H_INCLUDED
+/**
+ * @file    protocolo_can.h
+ * @brief   Esse arquivo contem o prototipo das funções relativas a implementação 
+ *          interface do cartao de memória micro SD
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 30/03/2020
+**/
+#ifndef PROTOCOLO_CAN_H_INCLUDED
+#define PROTOCOLO_CAN_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Submódulos do sistema
+#include "tipos.h"
+#include "erros.h"
+#include "fila_mensagem.h"
+#include "captura_mcp2515.h"
+#include "filtro_software.h"
+#include "registro_mudanca.h"
+#include "estatistica_id.h"
+#include "saude_barramento.h"
+#include "snifferCan_registro.h"
+#include "escritor_cartao.h"
+#include "enviador_servidor.h"
+#include "tamanho_bloco.h"
+#include "snifferCan_wifi.h"
+
+
+/// Funções exportadass
+void  protocoloCAN_salvaRegistroCANFila(void * filaMensagem );
+void  protocoloCAN_enviaRegistroCANFila(void * filaMensagem );
+Terro protocoloCAN_inicializa(TaxaComunicacao taxa, 
+                              TlistaFiltrosAndMascaras filtros, 
+                              PTprogramacaoFiltro programacao,
+                              PTfilaMensagem filaMensagem, 
+                              Tuint32 tamanhoFila);
+void protocoloCAN_ampliaFila(PTfilaMensagem filaMensagem, Tuint32 tamanhoMaximo);
+void protocoloCan_entrarNoSistema(void);
+Tuint32 protocoloCAN_obtemQuadrosPorSegundo(void);
+
+// Referenia para a tarefa
+extern TaskHandle_t salvaRegistroCANFila;
+extern TaskHandle_t enviaRegistroCANFila;
+
+
+#endif // PROTOCOLO_CAN_H_INCLUDED
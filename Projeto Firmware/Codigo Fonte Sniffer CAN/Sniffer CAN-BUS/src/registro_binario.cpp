@@ -0,0 +1,140 @@
+/**
+ * @file    registro_binario.cpp
+ * @brief   Esse arquivo contem as funções que codificam os blocos de mensagens no formato binario
+ *          do cartao. Cada quadro ocupa de 4 a 23 bytes, contra 40 a 70 caracteres no texto, e nao
+ *          passa por sprintf
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "registro_binario.h"
+
+/**
+ * @brief  Função que escreve o cabeçalho do arquivo binario
+ * @param  destino: recebe TAMANHO_CABECALHO_BINARIO bytes
+ * @param  relogioPrimeira: hora da primeira mensagem do arquivo (us desde 1970)
+ * @param  tempoPrimeira: instante da primeira mensagem do arquivo (esp_timer, us)
+ * @return quantidade de bytes escritos
+ */
+Tuint32 registroBinario_formataCabecalho(Tuint8 *destino, Tuint64 relogioPrimeira, Tuint64 tempoPrimeira){
+
+  (void)memcpy(destino, MAGICO_FORMATO_BINARIO, TAMANHO_MAGICO_FORMATO_BINARIO);
+  destino[4] = VERSAO_FORMATO_BINARIO;
+  destino[5] = TAMANHO_CABECALHO_BINARIO;
+  destino[6] = 0;
+  destino[7] = 0;
+  formatoBinario_escreveInteiro(&destino[8], relogioPrimeira, 8);
+  formatoBinario_escreveInteiro(&destino[16], tempoPrimeira, 8);
+  formatoBinario_escreveInteiro(&destino[24], formatoBinario_crc32(0, destino, 24), TAMANHO_CRC_BINARIO);
+
+  return TAMANHO_CABECALHO_BINARIO;
+}
+
+/**
+ * @brief  Função que escreve o inicio do bloco. O tamanho é preenchido em registroBinario_finalizaBloco
+ * @param  destino: recebe TAMANHO_INICIO_BLOCO_BINARIO bytes
+ * @return quantidade de bytes escritos
+ */
+Tuint32 registroBinario_iniciaBloco(Tuint8 *destino){
+  destino[0] = MARCA_BLOCO_BINARIO_0;
+  destino[1] = MARCA_BLOCO_BINARIO_1;
+  return TAMANHO_INICIO_BLOCO_BINARIO;
+}
+
+/**
+ * @brief  Função que escreve um marcador com um contador (REGISTRO_BINARIO_PERDIDOS ou
+ *         REGISTRO_BINARIO_SUPRIMIDOS)
+ * @param  destino: recebe ate TAMANHO_MAXIMO_MARCADOR_BINARIO bytes
+ * @param  tipo: tipo do registro
+ * @param  valor: quantidade de quadros
+ * @return quantidade de bytes escritos
+ */
+Tuint32 registroBinario_formataMarcador(Tuint8 *destino, Tuint8 tipo, Tuint32 valor){
+  destino[0] = tipo;
+  return (1 + formatoBinario_escreveVarint(&destino[1], valor));
+}
+
+/**
+ * @brief  Função que escreve o marcador de evento de saude do barramento
+ * @param  destino: recebe ate TAMANHO_MAXIMO_SAUDE_BINARIO bytes
+ * @param  saude: amostra da saude do barramento
+ * @return quantidade de bytes escritos
+ */
+Tuint32 registroBinario_formataSaude(Tuint8 *destino, PTamostraSaude saude){
+  Tuint32 tamanho = 0;
+
+  destino[tamanho++] = REGISTRO_BINARIO_SAUDE;
+  destino[tamanho++] = (Tuint8)saude->estado;
+  destino[tamanho++] = saude->tec;
+  destino[tamanho++] = saude->rec;
+  destino[tamanho++] = saude->eflg;
+  tamanho += formatoBinario_escreveVarint(&destino[tamanho], saude->estourosRXB0);
+  tamanho += formatoBinario_escreveVarint(&destino[tamanho], saude->estourosRXB1);
+  tamanho += formatoBinario_escreveVarint(&destino[tamanho], saude->cargaMinima);
+  tamanho += formatoBinario_escreveVarint(&destino[tamanho], saude->cargaMaxima);
+
+  return tamanho;
+}
+
+/**
+ * @brief  Função que codifica uma quantidade x de quadros CAN
+ * @param  destino: recebe ate TAMANHO_MAXIMO_QUADRO_BINARIO bytes por quadro
+ * @param  mensagem: Ponteiro para o array com as mensagens CANs
+ * @param  quantidade: quantidade de mensagens can presentes no array
+ * @param  tempoReferencia: instante (esp_timer, us) posterior a todas as mensagens do array
+ * @param  tempoAnterior: instante da mensagem anterior (esp_timer, us), atualizado ao final
+ * @return quantidade de bytes escritos
+ */
+Tuint32 registroBinario_formataQuadros(Tuint8 *destino, PTmensagemCAN mensagem, Tuint32 quantidade,
+                                       Tuint64 tempoReferencia, Tuint64 *tempoAnterior){
+  Tuint32 tamanho = 0;
+  Tuint64 tempoQuadro;
+  Tuint32 id;
+  Tuint32 i;
+
+  for(i=0; i<quantidade; i++){
+    id = ID_QUADRO(mensagem[i]);
+
+    destino[tamanho++] = (
+      (QUADRO_EXTENDIDO(mensagem[i]) ? BINARIO_QUADRO_EXTENDIDO : 0) |
+      (QUADRO_REMOTO(mensagem[i])    ? BINARIO_QUADRO_REMOTO    : 0) |
+      (QUADRO_ERRO(mensagem[i])      ? BINARIO_QUADRO_ERRO      : 0) |
+      (mensagem[i].tamanho & BINARIO_QUADRO_DLC)
+    );
+
+    // Intervalo em us sobre o instante absoluto, o decodificador reconstroi o tempo de cada quadro
+    tempoQuadro = TEMPO_ABSOLUTO_QUADRO(mensagem[i], tempoReferencia);
+    tamanho += formatoBinario_escreveVarint(&destino[tamanho], ZIGZAG_CODIFICA((int64_t)(tempoQuadro - *tempoAnterior)));
+    *tempoAnterior = tempoQuadro;
+
+    if(QUADRO_EXTENDIDO(mensagem[i])){
+      formatoBinario_escreveInteiro(&destino[tamanho], id, 4);
+      tamanho += 4;
+    }else{
+      formatoBinario_escreveInteiro(&destino[tamanho], id, 2);
+      tamanho += 2;
+    }
+
+    (void)memcpy(&destino[tamanho], mensagem[i].dados, mensagem[i].tamanho);
+    tamanho += mensagem[i].tamanho;
+  }
+
+  return tamanho;
+}
+
+/**
+ * @brief  Função que preenche o tamanho do bloco e acrescenta o CRC
+ * @param  bloco: bloco iniciado com registroBinario_iniciaBloco, com TAMANHO_CRC_BINARIO bytes livres no fim
+ * @param  tamanho: bytes escritos no bloco, incluindo o inicio
+ * @return tamanho total do bloco
+ */
+Tuint32 registroBinario_finalizaBloco(Tuint8 *bloco, Tuint32 tamanho){
+  Tuint32 crc;
+
+  formatoBinario_escreveInteiro(&bloco[2], (tamanho - TAMANHO_INICIO_BLOCO_BINARIO), 4);
+  crc = formatoBinario_crc32(0, &bloco[2], (tamanho - 2));
+  formatoBinario_escreveInteiro(&bloco[tamanho], crc, TAMANHO_CRC_BINARIO);
+
+  return (tamanho + TAMANHO_CRC_BINARIO);
+}
@@ -0,0 +1,30 @@
+/**
+ * @file    registro_binario.h
+ * @brief   Esse arquivo contem o prototipo das funções que codificam os blocos de mensagens no
+ *          formato binario do cartao (ver formato_binario.h)
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef REGISTRO_BINARIO_H_INCLUDED
+#define REGISTRO_BINARIO_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Submódulos do sistema
+#include "tipos.h"
+#include "erros.h"
+#include "formato_binario.h"
+
+/// Funções exportadas
+Tuint32 registroBinario_formataCabecalho(Tuint8 *destino, Tuint64 relogioPrimeira, Tuint64 tempoPrimeira);
+Tuint32 registroBinario_iniciaBloco(Tuint8 *destino);
+Tuint32 registroBinario_formataMarcador(Tuint8 *destino, Tuint8 tipo, Tuint32 valor);
+Tuint32 registroBinario_formataSaude(Tuint8 *destino, PTamostraSaude saude);
+Tuint32 registroBinario_formataQuadros(Tuint8 *destino, PTmensagemCAN mensagem, Tuint32 quantidade,
+                                       Tuint64 tempoReferencia, Tuint64 *tempoAnterior);
+Tuint32 registroBinario_finalizaBloco(Tuint8 *bloco, Tuint32 tamanho);
+
+#endif // REGISTRO_BINARIO_H_INCLUDED
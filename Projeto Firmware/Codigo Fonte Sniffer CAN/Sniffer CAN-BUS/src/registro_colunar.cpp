@@ -0,0 +1,220 @@
+/**
+ * @file    registro_colunar.cpp
+ * @brief   Esse arquivo contem as funções que codificam os blocos de mensagens em colunas: tempos em
+ *          delta do delta, identificadores por dicionario, DLC em 4 bits e dados em XOR com o ultimo
+ *          quadro do mesmo identificador. Em trafego periodico as colunas ficam quase todas em zero e
+ *          o compressor LZ as reduz bem mais que as linhas de texto
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "registro_colunar.h"
+
+// Estatistica da codificação, usada somente pela tarefa consumidora
+static Tuint32 quadrosCodificados = 0;
+static Tuint32 bytesColunasCodificadas = 0;
+static Tuint32 bytesComprimidosCodificados = 0;
+static Tuint32 tempoTotalCodificacao = 0;
+
+/**
+ * @brief  Função que escreve as colunas de um bloco de mensagens, sem compressão
+ * @param  colunas: recebe ate TAMANHO_MAXIMO_COLUNAS_BINARIO(bloco->quantidade) bytes
+ * @param  bloco: bloco com as mensagens e os marcadores
+ * @param  dicionario: bloco->quantidade entradas de trabalho
+ * @param  indices: bloco->quantidade posições de trabalho
+ * @param  tempoAnterior: instante da mensagem anterior (esp_timer, us), atualizado ao final
+ * @return quantidade de bytes escritos
+ */
+static Tuint32 registroColunar_formataColunas(Tuint8 *colunas, PTblocoMensagens bloco, PTentradaColunar dicionario,
+                                              Tuint32 *indices, Tuint64 *tempoAnterior){
+  Tuint8 marcadores[TAMANHO_MAXIMO_MARCADORES_BINARIO];
+  Tuint32 tamanhoMarcadores = 0;
+  Tuint32 tamanho = 0;
+  Tuint32 quantidadeDicionario = 0;
+  Tuint64 tempoQuadro;
+  Tint64 intervalo;
+  Tint64 intervaloAnterior = 0;
+  Tuint64 acumulador = 0;
+  Tuint8 bitsAcumulados = 0;
+  Tuint8 bitsIndice;
+  Tuint32 posicaoByte[TAMANHO_MAX_DADOS_QUADRO_CAN];
+  PTmensagemCAN mensagem = bloco->mensagem;
+  PTentradaColunar entrada;
+  Tuint32 i, j;
+
+  tamanho += formatoBinario_escreveVarint(&colunas[tamanho], bloco->quantidade);
+
+  // Marcadores na mesma ordem do texto
+  if(bloco->quadrosPerdidos > 0){
+    tamanhoMarcadores += registroBinario_formataMarcador(&marcadores[tamanhoMarcadores], REGISTRO_BINARIO_PERDIDOS, bloco->quadrosPerdidos);
+  }
+  if(bloco->eventoSaude){
+    tamanhoMarcadores += registroBinario_formataSaude(&marcadores[tamanhoMarcadores], &bloco->saude);
+  }
+  if(bloco->quadrosSuprimidos > 0){
+    tamanhoMarcadores += registroBinario_formataMarcador(&marcadores[tamanhoMarcadores], REGISTRO_BINARIO_SUPRIMIDOS, bloco->quadrosSuprimidos);
+  }
+  tamanho += formatoBinario_escreveVarint(&colunas[tamanho], tamanhoMarcadores);
+  (void)memcpy(&colunas[tamanho], marcadores, tamanhoMarcadores);
+  tamanho += tamanhoMarcadores;
+
+  // Tempos: delta do delta sobre o instante absoluto
+  for(i=0; i<bloco->quantidade; i++){
+    tempoQuadro = TEMPO_ABSOLUTO_QUADRO(mensagem[i], bloco->tempoReferencia);
+    intervalo = (Tint64)(tempoQuadro - *tempoAnterior);
+    tamanho += formatoBinario_escreveVarint(&colunas[tamanho], ZIGZAG_CODIFICA(intervalo - intervaloAnterior));
+    intervaloAnterior = intervalo;
+    *tempoAnterior = tempoQuadro;
+  }
+
+  // Dicionario do bloco. Poucos identificadores por bloco, a busca linear basta
+  for(i=0; i<bloco->quantidade; i++){
+    for(j=0; j<quantidadeDicionario; j++){
+      if(dicionario[j].identificador == mensagem[i].identificador){
+        break;
+      }
+    }
+    if(j == quantidadeDicionario){
+      dicionario[j].identificador = mensagem[i].identificador;
+      (void)memset(dicionario[j].anterior, 0x00, TAMANHO_MAX_DADOS_QUADRO_CAN);
+      quantidadeDicionario ++;
+    }
+    indices[i] = j;
+  }
+
+  tamanho += formatoBinario_escreveVarint(&colunas[tamanho], quantidadeDicionario);
+  for(j=0; j<quantidadeDicionario; j++){
+    colunas[tamanho++] = (
+      ((dicionario[j].identificador & FLAG_QUADRO_EXTENDIDO) ? BINARIO_QUADRO_EXTENDIDO : 0) |
+      ((dicionario[j].identificador & FLAG_QUADRO_REMOTO)    ? BINARIO_QUADRO_REMOTO    : 0) |
+      ((dicionario[j].identificador & FLAG_QUADRO_ERRO)      ? BINARIO_QUADRO_ERRO      : 0)
+    );
+    tamanho += formatoBinario_escreveVarint(&colunas[tamanho], (dicionario[j].identificador & MASCARA_ID_EXTENDIDO));
+  }
+
+  // Indices com o minimo de bits
+  bitsIndice = formatoBinario_bitsIndice(quantidadeDicionario);
+  if(bitsIndice > 0){
+    for(i=0; i<bloco->quantidade; i++){
+      acumulador |= ((Tuint64)indices[i] << bitsAcumulados);
+      bitsAcumulados += bitsIndice;
+      while(bitsAcumulados >= 8){
+        colunas[tamanho++] = (Tuint8)acumulador;
+        acumulador >>= 8;
+        bitsAcumulados -= 8;
+      }
+    }
+    if(bitsAcumulados > 0){
+      colunas[tamanho++] = (Tuint8)acumulador;
+    }
+  }
+
+  // DLC, dois por byte. Conta tambem os quadros com cada posição de byte
+  (void)memset(posicaoByte, 0x00, sizeof(posicaoByte));
+  for(i=0; i<bloco->quantidade; i++){
+    for(j=0; j<mensagem[i].tamanho; j++){
+      posicaoByte[j] ++;
+    }
+  }
+  for(i=0; i<bloco->quantidade; i+=2){
+    colunas[tamanho] = (mensagem[i].tamanho & BINARIO_QUADRO_DLC);
+    if((i + 1) < bloco->quantidade){
+      colunas[tamanho] |= ((mensagem[i + 1].tamanho & BINARIO_QUADRO_DLC) << 4);
+    }
+    tamanho ++;
+  }
+
+  // Inicio de cada posição de byte na coluna de dados
+  for(j=0; j<TAMANHO_MAX_DADOS_QUADRO_CAN; j++){
+    intervalo = posicaoByte[j];
+    posicaoByte[j] = tamanho;
+    tamanho += (Tuint32)intervalo;
+  }
+
+  // Dados em XOR com o ultimo quadro do mesmo identificador, agrupados pela posição do byte
+  for(i=0; i<bloco->quantidade; i++){
+    entrada = &dicionario[indices[i]];
+    for(j=0; j<mensagem[i].tamanho; j++){
+      colunas[posicaoByte[j]++] = (mensagem[i].dados[j] ^ entrada->anterior[j]);
+      entrada->anterior[j] = mensagem[i].dados[j];
+    }
+  }
+
+  return tamanho;
+}
+
+/**
+ * @brief  Função que codifica um bloco de mensagens em colunas comprimidas
+ * @param  destino: recebe ate TAMANHO_MAXIMO_BLOCO_COLUNAR(bloco->quantidade) bytes
+ * @param  tamanho: recebe o tamanho do bloco, incluindo a marca e o CRC
+ * @param  bloco: bloco com as mensagens e os marcadores
+ * @param  tempoAnterior: instante da mensagem anterior (esp_timer, us), atualizado ao final
+ * @param  arena: arena do consumidor, fornece a memoria de trabalho (TAMANHO_TRABALHO_COLUNAR bytes)
+ * @return ERRO_ALOCACAO_MEMORIA ou SUCESSO
+ */
+Terro registroColunar_formataBloco(Tuint8 *destino, Tuint32 *tamanho, PTblocoMensagens bloco, Tuint64 *tempoAnterior,
+                                   PTarenaBloco arena){
+  Tuint32 inicio = micros();
+  Tuint32 quantidade = ((bloco->quantidade > 0) ? bloco->quantidade : 1);
+  Tuint32 marca = arenaBloco_marca(arena);
+  Tuint8 *memoria;
+  Tuint32 *tabela;
+  Tuint32 *indices;
+  PTentradaColunar dicionario;
+  Tuint8 *colunas;
+  Tuint32 tamanhoColunas;
+  Tuint32 tamanhoComprimido;
+  Tuint32 crc;
+
+  // Um buffer da arena para a tabela do compressor, os indices, o dicionario e as colunas
+  memoria = (Tuint8 *)arenaBloco_reserva(arena, TAMANHO_TRABALHO_COLUNAR(quantidade));
+  if(memoria == NULL){
+    return ERRO_ALOCACAO_MEMORIA;
+  }
+  tabela = (Tuint32 *)memoria;
+  indices = &tabela[TAMANHO_TABELA_COMPRESSOR_LZ];
+  dicionario = (PTentradaColunar)&indices[quantidade];
+  colunas = (Tuint8 *)&dicionario[quantidade];
+
+  tamanhoColunas = registroColunar_formataColunas(colunas, bloco, dicionario, indices, tempoAnterior);
+  tamanhoComprimido = compressorLZ_comprime(colunas, tamanhoColunas, &destino[TAMANHO_INICIO_BLOCO_COLUNAR], tabela);
+  arenaBloco_libera(arena, marca);
+
+  destino[0] = MARCA_BLOCO_COLUNAR_0;
+  destino[1] = MARCA_BLOCO_COLUNAR_1;
+  formatoBinario_escreveInteiro(&destino[2], (4 + tamanhoComprimido), 4);
+  formatoBinario_escreveInteiro(&destino[6], tamanhoColunas, 4);
+  *tamanho = (TAMANHO_INICIO_BLOCO_COLUNAR + tamanhoComprimido);
+  crc = formatoBinario_crc32(0, &destino[2], (*tamanho - 2));
+  formatoBinario_escreveInteiro(&destino[*tamanho], crc, TAMANHO_CRC_BINARIO);
+  *tamanho += TAMANHO_CRC_BINARIO;
+
+  quadrosCodificados += bloco->quantidade;
+  bytesColunasCodificadas += tamanhoColunas;
+  bytesComprimidosCodificados += *tamanho;
+  tempoTotalCodificacao += (micros() - inicio);
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que obtem a estatistica da codificação desde a ultima leitura e reinicia a contagem
+ * @param  quadros: recebe a quantidade de quadros codificados
+ * @param  bytesColunas: recebe os bytes das colunas antes da compressão
+ * @param  bytesComprimidos: recebe os bytes dos blocos gerados
+ * @param  tempoCodificacao: recebe o tempo total de codificação (us)
+ * @return void
+ */
+void registroColunar_obtemEstatistica(Tuint32 *quadros, Tuint32 *bytesColunas, Tuint32 *bytesComprimidos,
+                                      Tuint32 *tempoCodificacao){
+  *quadros = quadrosCodificados;
+  *bytesColunas = bytesColunasCodificadas;
+  *bytesComprimidos = bytesComprimidosCodificados;
+  *tempoCodificacao = tempoTotalCodificacao;
+
+  quadrosCodificados = 0;
+  bytesColunasCodificadas = 0;
+  bytesComprimidosCodificados = 0;
+  tempoTotalCodificacao = 0;
+}
@@ -0,0 +1,38 @@
+/**
+ * @file    registro_colunar.h
+ * @brief   Esse arquivo contem o prototipo das funções que codificam os blocos de mensagens em
+ *          colunas comprimidas (ver formato_binario.h)
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef REGISTRO_COLUNAR_H_INCLUDED
+#define REGISTRO_COLUNAR_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Submódulos do sistema
+#include "tipos.h"
+#include "erros.h"
+#include "formato_binario.h"
+#include "compressor_lz.h"
+#include "registro_binario.h"
+#include "arena_bloco.h"
+
+/// Definições importantes
+#define TAMANHO_MAXIMO_BLOCO_COLUNAR(quantidade) \
+  (TAMANHO_INICIO_BLOCO_COLUNAR + TAMANHO_MAXIMO_COMPRESSOR_LZ(TAMANHO_MAXIMO_COLUNAS_BINARIO(quantidade)) + TAMANHO_CRC_BINARIO)
+// Memoria de trabalho: tabela do compressor, indices, dicionario e colunas
+#define TAMANHO_TRABALHO_COLUNAR(quantidade) \
+  ((sizeof(Tuint32) * TAMANHO_TABELA_COMPRESSOR_LZ) + (sizeof(Tuint32) * (quantidade)) + \
+   (sizeof(TentradaColunar) * (quantidade)) + TAMANHO_MAXIMO_COLUNAS_BINARIO(quantidade))
+
+/// Funções exportadas
+Terro registroColunar_formataBloco(Tuint8 *destino, Tuint32 *tamanho, PTblocoMensagens bloco, Tuint64 *tempoAnterior,
+                                   PTarenaBloco arena);
+void registroColunar_obtemEstatistica(Tuint32 *quadros, Tuint32 *bytesColunas, Tuint32 *bytesComprimidos,
+                                      Tuint32 *tempoCodificacao);
+
+#endif // REGISTRO_COLUNAR_H_INCLUDED
@@ -0,0 +1,305 @@
+/**
+ * @file    registro_mdf.cpp
+ * @brief   Esse arquivo contem as funções que codificam os blocos de mensagens no formato
+ *          ASAM MDF 4.10 (ver registro_mdf.h). Os campos corrigidos durante a gravação e no
+ *          fechamento sao escritos pelo gerenciamento do cartao (gerenciamento_cartao.cpp)
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "registro_mdf.h"
+
+// Definições importantes
+#define LINK_MDF(bloco, indice)       ((bloco) + TAMANHO_INICIO_BLOCO_MDF + (8 * (indice)))
+#define DADOS_MDF(bloco, links)       ((bloco) + TAMANHO_INICIO_BLOCO_MDF + (8 * (links)))
+#define VERSAO_MDF                    410
+#define NAO_FINALIZADO_CICLOS_CG      0x0001
+#define NAO_FINALIZADO_TAMANHO_DT     0x0004
+#define CG_EVENTO_BARRAMENTO          0x0006  // evento de barramento simples
+#define CN_EVENTO_BARRAMENTO          0x0400
+#define CN_TIPO_DADO                  0
+#define CN_TIPO_MESTRE                2
+#define CN_SINCRONISMO_TEMPO          1
+#define CN_INTEIRO_SEM_SINAL          0
+#define CN_VETOR_BYTES                10
+#define SI_TIPO_BARRAMENTO            2
+#define SI_BARRAMENTO_CAN             2
+#define CC_LINEAR                     1
+#define COMENTARIO_HISTORICO_MDF      "<FHcomment><TX>Registro do barramento CAN</TX><tool_id>SnifferCAN</tool_id>" \
+                                      "<tool_vendor>SnifferCAN</tool_vendor><tool_version>1.0</tool_version></FHcomment>"
+
+/**
+ * @brief  Função que inicia um bloco: id, tamanho (multiplo de 8) e quantidade de links. Os links
+ *         e os dados começam zerados
+ * @param  destino: inicio do bloco
+ * @param  id: identificador de 4 caracteres ("##XX")
+ * @param  links: quantidade de links
+ * @param  tamanhoDados: bytes de dados depois dos links
+ * @return tamanho do bloco
+ */
+static Tuint32 registroMdf_iniciaBloco(Tuint8 *destino, const char *id, Tuint32 links, Tuint32 tamanhoDados){
+  Tuint32 tamanho = ((TAMANHO_INICIO_BLOCO_MDF + (8 * links) + tamanhoDados + 7) & ~7U);
+
+  (void)memset(destino, 0x00, tamanho);
+  (void)memcpy(destino, id, 4);
+  formatoBinario_escreveInteiro(&destino[8], tamanho, 8);
+  formatoBinario_escreveInteiro(&destino[16], links, 8);
+
+  return tamanho;
+}
+
+/**
+ * @brief  Função que escreve um link de um bloco
+ * @param  cabecalho: inicio do arquivo
+ * @param  bloco: endereço do bloco
+ * @param  indice: posição do link no bloco
+ * @param  alvo: endereço do bloco apontado
+ * @return void
+ */
+static void registroMdf_escreveLink(Tuint8 *cabecalho, Tuint32 bloco, Tuint32 indice, Tuint32 alvo){
+  formatoBinario_escreveInteiro(&cabecalho[LINK_MDF(bloco, indice)], alvo, 8);
+}
+
+/**
+ * @brief  Função que escreve um numero real (IEEE 754, 8 bytes)
+ * @param  destino: recebe 8 bytes
+ * @param  valor: numero
+ * @return void
+ */
+static void registroMdf_escreveReal(Tuint8 *destino, double valor){
+  Tuint64 bits;
+
+  (void)memcpy(&bits, &valor, sizeof(bits));
+  formatoBinario_escreveInteiro(destino, bits, 8);
+}
+
+/**
+ * @brief  Função que acrescenta um bloco de texto (TX) ou de metadados (MD)
+ * @param  cabecalho: inicio do arquivo
+ * @param  posicao: proximo endereço livre, atualizado
+ * @param  id: "##TX" ou "##MD"
+ * @param  texto: conteudo, escrito com o terminador
+ * @return endereço do bloco
+ */
+static Tuint32 registroMdf_formataTexto(Tuint8 *cabecalho, Tuint32 *posicao, const char *id, const char *texto){
+  Tuint32 endereco = *posicao;
+  Tuint32 tamanhoTexto = (strlen(texto) + 1);
+
+  *posicao += registroMdf_iniciaBloco(&cabecalho[endereco], id, 0, tamanhoTexto);
+  (void)memcpy(&cabecalho[DADOS_MDF(endereco, 0)], texto, tamanhoTexto);
+
+  return endereco;
+}
+
+/**
+ * @brief  Função que acrescenta um canal (CN) e o seu nome
+ * @param  cabecalho: inicio do arquivo
+ * @param  posicao: proximo endereço livre, atualizado
+ * @param  nome: nome do canal
+ * @param  tipo: CN_TIPO_DADO ou CN_TIPO_MESTRE
+ * @param  tipoDado: CN_INTEIRO_SEM_SINAL ou CN_VETOR_BYTES
+ * @param  byteInicio: byte do registro onde o valor começa
+ * @param  bitInicio: bit do primeiro byte onde o valor começa
+ * @param  bits: quantidade de bits do valor
+ * @param  flags: flags do canal
+ * @return endereço do canal
+ */
+static Tuint32 registroMdf_formataCanal(Tuint8 *cabecalho, Tuint32 *posicao, const char *nome, Tuint8 tipo,
+                                        Tuint8 tipoDado, Tuint32 byteInicio, Tuint8 bitInicio, Tuint32 bits,
+                                        Tuint32 flags){
+  Tuint32 endereco = *posicao;
+  Tuint8 *dados = &cabecalho[DADOS_MDF(endereco, 8)];
+
+  *posicao += registroMdf_iniciaBloco(&cabecalho[endereco], "##CN", 8, 72);
+  dados[0] = tipo;
+  dados[1] = ((tipo == CN_TIPO_MESTRE) ? CN_SINCRONISMO_TEMPO : 0);
+  dados[2] = tipoDado;
+  dados[3] = bitInicio;
+  formatoBinario_escreveInteiro(&dados[4], byteInicio, 4);
+  formatoBinario_escreveInteiro(&dados[8], bits, 4);
+  formatoBinario_escreveInteiro(&dados[12], flags, 4);
+  registroMdf_escreveLink(cabecalho, endereco, 2, registroMdf_formataTexto(cabecalho, posicao, "##TX", nome));
+
+  return endereco;
+}
+
+/**
+ * @brief  Função que escreve o bloco de identificação
+ * @param  destino: recebe TAMANHO_IDENTIFICACAO_MDF bytes
+ * @param  finalizado: VERDADEIRO depois que o tamanho do DT e os ciclos do CG foram corrigidos
+ * @return void
+ */
+void registroMdf_formataIdentificacao(Tuint8 *destino, Tbool finalizado){
+  (void)memset(destino, 0x00, TAMANHO_IDENTIFICACAO_MDF);
+  (void)memcpy(&destino[0], ((finalizado) ? "MDF     " : "UnFinMF "), 8);
+  (void)memcpy(&destino[8], "4.10    ", 8);
+  (void)memcpy(&destino[16], "SnifCAN ", 8);
+  formatoBinario_escreveInteiro(&destino[28], VERSAO_MDF, 2);
+  formatoBinario_escreveInteiro(&destino[60], ((finalizado) ? 0 : (NAO_FINALIZADO_CICLOS_CG | NAO_FINALIZADO_TAMANHO_DT)), 2);
+}
+
+/**
+ * @brief  Função que verifica se o bloco de identificação é de um arquivo finalizado
+ * @param  identificacao: primeiros 8 bytes do arquivo
+ * @return VERDADEIRO se finalizado
+ */
+Tbool registroMdf_finalizado(const Tuint8 *identificacao){
+  return (memcmp(identificacao, "MDF     ", 8) == 0);
+}
+
+/**
+ * @brief  Função que obtem o tamanho valido do arquivo a partir do tamanho do DT gravado nele,
+ *         descartando um registro incompleto no fim
+ * @param  tamanhoDT: tamanho do DT, incluindo o inicio do bloco
+ * @param  tamanhoArquivo: tamanho do arquivo no cartao
+ * @return tamanho valido, 0 se o DT for invalido
+ */
+Tuint32 registroMdf_tamanhoLogico(Tuint64 tamanhoDT, Tuint32 tamanhoArquivo){
+  Tuint64 tamanho;
+
+  if((tamanhoDT < TAMANHO_INICIO_BLOCO_MDF) || (tamanhoArquivo < TAMANHO_CABECALHO_MDF)){
+    return 0;
+  }
+  tamanho = (TAMANHO_CABECALHO_MDF + (((tamanhoDT - TAMANHO_INICIO_BLOCO_MDF) / TAMANHO_REGISTRO_MDF) * TAMANHO_REGISTRO_MDF));
+  if(tamanho > tamanhoArquivo){
+    return 0;
+  }
+
+  return (Tuint32)tamanho;
+}
+
+/**
+ * @brief  Função que escreve os blocos de descrição do arquivo e o inicio do DT vazio. O arquivo
+ *         fica marcado como nao finalizado ate o fechamento
+ * @param  destino: recebe TAMANHO_CABECALHO_MDF bytes
+ * @param  relogioInicio: hora da primeira mensagem (us desde 1970), base do Timestamp
+ * @return quantidade de bytes escritos
+ */
+Tuint32 registroMdf_formataCabecalho(Tuint8 *destino, Tuint64 relogioInicio){
+  Tuint32 posicao = (ENDERECO_CG_MDF + 104);
+  Tuint32 historico;
+  Tuint32 fonte;
+  Tuint32 tempo;
+  Tuint32 conversao;
+  Tuint32 quadro;
+  Tuint32 filho;
+  Tuint32 anterior;
+  Tuint8 *dados;
+
+  (void)memset(destino, 0x00, TAMANHO_CABECALHO_MDF);
+  registroMdf_formataIdentificacao(destino, FALSO);
+
+  // HD: hora de inicio em UTC
+  (void)registroMdf_iniciaBloco(&destino[ENDERECO_HD_MDF], "##HD", 6, 32);
+  registroMdf_escreveLink(destino, ENDERECO_HD_MDF, 0, ENDERECO_DG_MDF);
+  formatoBinario_escreveInteiro(&destino[DADOS_MDF(ENDERECO_HD_MDF, 6)], (relogioInicio * 1000ULL), 8);
+
+  // DG ordenado, sem identificador de registro
+  (void)registroMdf_iniciaBloco(&destino[ENDERECO_DG_MDF], "##DG", 4, 8);
+  registroMdf_escreveLink(destino, ENDERECO_DG_MDF, 1, ENDERECO_CG_MDF);
+  registroMdf_escreveLink(destino, ENDERECO_DG_MDF, 2, ENDERECO_DT_MDF);
+
+  // CG do evento de barramento. Os ciclos sao corrigidos no fechamento
+  (void)registroMdf_iniciaBloco(&destino[ENDERECO_CG_MDF], "##CG", 6, 32);
+  dados = &destino[DADOS_MDF(ENDERECO_CG_MDF, 6)];
+  formatoBinario_escreveInteiro(&dados[16], CG_EVENTO_BARRAMENTO, 2);
+  formatoBinario_escreveInteiro(&dados[18], '.', 2);
+  formatoBinario_escreveInteiro(&dados[24], TAMANHO_REGISTRO_MDF, 4);
+
+  // FH obrigatorio, com a ferramenta que gravou o arquivo
+  historico = posicao;
+  posicao += registroMdf_iniciaBloco(&destino[historico], "##FH", 2, 16);
+  formatoBinario_escreveInteiro(&destino[DADOS_MDF(historico, 2)], (relogioInicio * 1000ULL), 8);
+  registroMdf_escreveLink(destino, historico, 1, registroMdf_formataTexto(destino, &posicao, "##MD", COMENTARIO_HISTORICO_MDF));
+  registroMdf_escreveLink(destino, ENDERECO_HD_MDF, 1, historico);
+
+  // Fonte da aquisição: barramento CAN
+  fonte = posicao;
+  posicao += registroMdf_iniciaBloco(&destino[fonte], "##SI", 3, 8);
+  destino[DADOS_MDF(fonte, 3)] = SI_TIPO_BARRAMENTO;
+  destino[DADOS_MDF(fonte, 3) + 1] = SI_BARRAMENTO_CAN;
+  registroMdf_escreveLink(destino, fonte, 0, registroMdf_formataTexto(destino, &posicao, "##TX", "CAN1"));
+  registroMdf_escreveLink(destino, ENDERECO_CG_MDF, 2, registroMdf_formataTexto(destino, &posicao, "##TX", "CAN_DataFrame"));
+  registroMdf_escreveLink(destino, ENDERECO_CG_MDF, 3, fonte);
+
+  // Canal mestre: us desde a primeira mensagem, convertido para s
+  tempo = registroMdf_formataCanal(destino, &posicao, "Timestamp", CN_TIPO_MESTRE, CN_INTEIRO_SEM_SINAL, 0, 0, 64, 0);
+  conversao = posicao;
+  posicao += registroMdf_iniciaBloco(&destino[conversao], "##CC", 4, 40);
+  dados = &destino[DADOS_MDF(conversao, 4)];
+  dados[0] = CC_LINEAR;
+  formatoBinario_escreveInteiro(&dados[6], 2, 2);
+  registroMdf_escreveReal(&dados[24], 0.0);
+  registroMdf_escreveReal(&dados[32], 0.000001);
+  registroMdf_escreveLink(destino, conversao, 1, registroMdf_formataTexto(destino, &posicao, "##TX", "s"));
+  registroMdf_escreveLink(destino, tempo, 4, conversao);
+  registroMdf_escreveLink(destino, ENDERECO_CG_MDF, 1, tempo);
+
+  // CAN_DataFrame e os sinais que o compoem
+  quadro = registroMdf_formataCanal(destino, &posicao, "CAN_DataFrame", CN_TIPO_DADO, CN_VETOR_BYTES, 8, 0, 128, CN_EVENTO_BARRAMENTO);
+  registroMdf_escreveLink(destino, tempo, 0, quadro);
+
+  filho = registroMdf_formataCanal(destino, &posicao, "CAN_DataFrame.BusChannel", CN_TIPO_DADO, CN_INTEIRO_SEM_SINAL, 14, 0, 8, 0);
+  registroMdf_escreveLink(destino, quadro, 1, filho);
+  anterior = filho;
+  filho = registroMdf_formataCanal(destino, &posicao, "CAN_DataFrame.ID", CN_TIPO_DADO, CN_INTEIRO_SEM_SINAL, 8, 0, 29, 0);
+  registroMdf_escreveLink(destino, anterior, 0, filho);
+  anterior = filho;
+  filho = registroMdf_formataCanal(destino, &posicao, "CAN_DataFrame.IDE", CN_TIPO_DADO, CN_INTEIRO_SEM_SINAL, 11, 7, 1, 0);
+  registroMdf_escreveLink(destino, anterior, 0, filho);
+  anterior = filho;
+  filho = registroMdf_formataCanal(destino, &posicao, "CAN_DataFrame.DLC", CN_TIPO_DADO, CN_INTEIRO_SEM_SINAL, 12, 0, 4, 0);
+  registroMdf_escreveLink(destino, anterior, 0, filho);
+  anterior = filho;
+  filho = registroMdf_formataCanal(destino, &posicao, "CAN_DataFrame.DataLength", CN_TIPO_DADO, CN_INTEIRO_SEM_SINAL, 13, 0, 8, 0);
+  registroMdf_escreveLink(destino, anterior, 0, filho);
+  anterior = filho;
+  filho = registroMdf_formataCanal(destino, &posicao, "CAN_DataFrame.DataBytes", CN_TIPO_DADO, CN_VETOR_BYTES, 16, 0, 64, 0);
+  registroMdf_escreveLink(destino, anterior, 0, filho);
+
+  // DT vazio no fim da região, o tamanho acompanha os registros gravados
+  (void)registroMdf_iniciaBloco(&destino[ENDERECO_DT_MDF], "##DT", 0, 0);
+
+  return TAMANHO_CABECALHO_MDF;
+}
+
+/**
+ * @brief  Função que codifica uma quantidade x de quadros CAN como registros do CAN_DataFrame.
+ *         Quadros remotos e de erro sao ignorados
+ * @param  destino: recebe ate TAMANHO_REGISTRO_MDF bytes por quadro
+ * @param  mensagem: Ponteiro para o array com as mensagens CANs
+ * @param  quantidade: quantidade de mensagens can presentes no array
+ * @param  tempoReferencia: instante (esp_timer, us) posterior a todas as mensagens do array
+ * @param  relogioReferencia: hora (us desde 1970) correspondente a tempoReferencia
+ * @param  relogioInicio: hora da primeira mensagem do arquivo (us desde 1970)
+ * @return quantidade de bytes escritos
+ */
+Tuint32 registroMdf_formataQuadros(Tuint8 *destino, PTmensagemCAN mensagem, Tuint32 quantidade,
+                                   Tuint64 tempoReferencia, Tuint64 relogioReferencia, Tuint64 relogioInicio){
+  Tuint32 tamanho = 0;
+  Tuint8 *registro;
+  Tuint64 relogioQuadro;
+  Tuint32 i;
+
+  for(i=0; i<quantidade; i++){
+    if(QUADRO_REMOTO(mensagem[i]) || QUADRO_ERRO(mensagem[i])){
+      continue;
+    }
+    registro = &destino[tamanho];
+    relogioQuadro = (relogioReferencia - (tempoReferencia - TEMPO_ABSOLUTO_QUADRO(mensagem[i], tempoReferencia)));
+
+    formatoBinario_escreveInteiro(&registro[0], (relogioQuadro - relogioInicio), 8);
+    formatoBinario_escreveInteiro(&registro[8], (ID_QUADRO(mensagem[i]) | (QUADRO_EXTENDIDO(mensagem[i]) ? 0x80000000U : 0)), 4);
+    registro[12] = mensagem[i].tamanho;
+    registro[13] = mensagem[i].tamanho;
+    registro[14] = CANAL_BARRAMENTO_MDF;
+    registro[15] = 0;
+    (void)memset(&registro[16], 0x00, TAMANHO_MAX_DADOS_QUADRO_CAN);
+    (void)memcpy(&registro[16], mensagem[i].dados, mensagem[i].tamanho);
+
+    tamanho += TAMANHO_REGISTRO_MDF;
+  }
+
+  return tamanho;
+}
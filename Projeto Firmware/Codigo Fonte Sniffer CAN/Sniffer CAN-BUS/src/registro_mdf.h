@@ -0,0 +1,67 @@
+/**
+ * @file    registro_mdf.h
+ * @brief   Esse arquivo contem o prototipo das funções que codificam os blocos de mensagens no
+ *          formato ASAM MDF 4.10 (MF4), no padrao de registro de barramento (CAN_DataFrame).
+ *
+ *          O arquivo tem um unico grupo de dados ordenado, com um grupo de canais e um bloco DT
+ *          continuo que cresce ate o fechamento. Os blocos de descrição ocupam os primeiros
+ *          TAMANHO_CABECALHO_MDF bytes, em endereços fixos, e o DT começa logo antes do fim dessa
+ *          região, assim os registros ficam alinhados ao setor e os campos corrigidos durante a
+ *          gravação (tamanho do DT, ciclos do CG e identificação) tem endereço conhecido:
+ *            0                   ID  "UnFinMF " durante a gravação, "MDF     " depois de finalizado
+ *            ENDERECO_HD_MDF     HD  hora da primeira mensagem
+ *            ENDERECO_DG_MDF     DG  sem identificador de registro
+ *            ENDERECO_CG_MDF     CG  evento de barramento, TAMANHO_REGISTRO_MDF bytes por registro
+ *            ...                 FH, MD, SI, TX, CC e CN (Timestamp e CAN_DataFrame com os filhos)
+ *            ENDERECO_DT_MDF     DT  registros
+ *
+ *          Registro (little-endian):
+ *            0  Timestamp: us desde a primeira mensagem (8 bytes, conversão linear para s)
+ *            8  CAN_DataFrame.ID (bits 0..28) e CAN_DataFrame.IDE (bit 31)
+ *            12 CAN_DataFrame.DLC
+ *            13 CAN_DataFrame.DataLength
+ *            14 CAN_DataFrame.BusChannel
+ *            15 reservado
+ *            16 CAN_DataFrame.DataBytes (8 bytes)
+ *
+ *          Quadros remotos e de erro pertencem a outros grupos do padrao (CAN_RemoteFrame e
+ *          CAN_ErrorFrame) e nao sao registrados neste formato, assim como os marcadores
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef REGISTRO_MDF_H_INCLUDED
+#define REGISTRO_MDF_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Submódulos do sistema
+#include "tipos.h"
+#include "erros.h"
+#include "formato_binario.h"
+
+/// Definições importantes
+#define EXTENSAO_ARQUIVO_MDF          ".mf4"
+#define TAMANHO_CABECALHO_MDF         4096  // blocos de descrição e inicio do DT, oito setores
+#define TAMANHO_INICIO_BLOCO_MDF      24    // id, reservado, tamanho e quantidade de links
+#define TAMANHO_IDENTIFICACAO_MDF     64
+#define TAMANHO_REGISTRO_MDF          24
+#define CANAL_BARRAMENTO_MDF          1
+#define ENDERECO_HD_MDF               64
+#define ENDERECO_DG_MDF               168
+#define ENDERECO_CG_MDF               232
+#define ENDERECO_CICLOS_CG_MDF        (ENDERECO_CG_MDF + TAMANHO_INICIO_BLOCO_MDF + (6 * 8) + 8)  // cg_cycle_count
+#define ENDERECO_DT_MDF               (TAMANHO_CABECALHO_MDF - TAMANHO_INICIO_BLOCO_MDF)
+#define ENDERECO_TAMANHO_DT_MDF       (ENDERECO_DT_MDF + 8)
+
+/// Funções exportadas
+Tuint32 registroMdf_formataCabecalho(Tuint8 *destino, Tuint64 relogioInicio);
+Tuint32 registroMdf_formataQuadros(Tuint8 *destino, PTmensagemCAN mensagem, Tuint32 quantidade,
+                                   Tuint64 tempoReferencia, Tuint64 relogioReferencia, Tuint64 relogioInicio);
+void registroMdf_formataIdentificacao(Tuint8 *destino, Tbool finalizado);
+Tbool registroMdf_finalizado(const Tuint8 *identificacao);
+Tuint32 registroMdf_tamanhoLogico(Tuint64 tamanhoDT, Tuint32 tamanhoArquivo);
+
+#endif // REGISTRO_MDF_H_INCLUDED
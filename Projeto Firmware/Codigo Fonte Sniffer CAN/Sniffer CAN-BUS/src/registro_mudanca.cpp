@@ -0,0 +1,137 @@
+/**
+ * @file    registro_mudanca.cpp
+ * @brief   Esse arquivo contem as funções do registro somente de mudanças. Para cada identificador
+ *          guarda-se o ultimo conteudo registrado, um quadro igual a ele é suprimido, a menos que
+ *          tenha passado o intervalo do quadro chave, que limita a idade do ultimo valor no registro
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "registro_mudanca.h"
+
+// Definições importantes
+#define CONSTANTE_HASH_MUDANCA          2654435761U   // hash multiplicativo de Knuth
+#define POSICAO_TABELA_MUDANCA(chave)   (((Tuint32)(chave) * CONSTANTE_HASH_MUDANCA) >> (32 - BITS_TABELA_MUDANCA))
+#define MASCARA_TABELA_MUDANCA          (TAMANHO_TABELA_MUDANCA - 1)
+#define CHAVE_MUDANCA(mensagem)         ((mensagem).identificador & (MASCARA_ID_EXTENDIDO | FLAG_QUADRO_EXTENDIDO | FLAG_QUADRO_REMOTO))
+
+/**
+ * @brief  Função que inicializa o registro de mudanças, alocando a tabela de identificadores
+ * @param  registro: registro que será inicializado
+ * @param  ativo: registrar somente as mudanças? Se nao, nada é alocado
+ * @param  intervaloQuadroChave: intervalo maximo (ms) sem registrar um identificador, 0 = sem quadro chave
+ * @param  resumo: contar os quadros suprimidos em cada bloco
+ * @return ERRO_ALOCACAO_MEMORIA ou SUCESSO
+ */
+Terro registroMudanca_inicializa(PTregistroMudanca registro, Tbool ativo, Tuint32 intervaloQuadroChave, Tbool resumo){
+
+  (void)memset(registro, 0x00, sizeof(TregistroMudanca));
+  if(!ativo){
+    return SUCESSO;
+  }
+
+  registro->tabela = (PTentradaMudanca)calloc(TAMANHO_TABELA_MUDANCA, sizeof(TentradaMudanca));
+  if(registro->tabela == NULL){
+    return ERRO_ALOCACAO_MEMORIA;
+  }
+  registro->intervaloQuadroChave = ((Tuint64)intervaloQuadroChave * 1000ULL);
+  registro->resumo = resumo;
+  registro->ativo = VERDADEIRO;
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que libera a tabela do registro de mudanças
+ * @param  registro: registro que será finalizado
+ * @return void
+ */
+void registroMudanca_finaliza(PTregistroMudanca registro){
+  free(registro->tabela);
+  (void)memset(registro, 0x00, sizeof(TregistroMudanca));
+}
+
+/**
+ * @brief  Função que busca a entrada do identificador, inserindo-o se ainda nao estiver na tabela
+ * @param  registro: registro de mudanças
+ * @param  chave: identificador com as flags de tipo
+ * @param  nova: recebe VERDADEIRO se a entrada acabou de ser criada
+ * @return entrada ou NULL se a tabela estiver cheia
+ */
+static PTentradaMudanca registroMudanca_buscaEntrada(PTregistroMudanca registro, Tuint32 chave, Tbool *nova){
+  Tuint32 posicao = POSICAO_TABELA_MUDANCA(chave);
+
+  *nova = FALSO;
+  while(registro->tabela[posicao].ocupada){
+    if(registro->tabela[posicao].identificador == chave){
+      return &registro->tabela[posicao];
+    }
+    posicao = ((posicao + 1) & MASCARA_TABELA_MUDANCA);
+  }
+
+  // Mantem a ocupação em no maximo 50% para que as sondagens continuem curtas
+  if(registro->quantidade >= MAXIMA_QUANTIDADE_IDS_MUDANCA){
+    return NULL;
+  }
+  registro->tabela[posicao].ocupada = VERDADEIRO;
+  registro->tabela[posicao].identificador = chave;
+  registro->quantidade ++;
+  *nova = VERDADEIRO;
+  return &registro->tabela[posicao];
+}
+
+/**
+ * @brief  Função que remove do array as mensagens cujos dados nao mudaram, mantendo a ordem.
+ *         Mensagens de erro/evento e identificadores que nao cabem na tabela sempre passam
+ * @param  registro: registro de mudanças
+ * @param  mensagem: array de mensagens (compactado no proprio lugar)
+ * @param  quantidade: quantidade de mensagens do array
+ * @param  tempoReferencia: instante (esp_timer, us) posterior a todas as mensagens do array
+ * @param  suprimidos: acumula a quantidade de mensagens suprimidas se o resumo estiver ativo
+ * @return quantidade de mensagens mantidas
+ */
+Tuint32 registroMudanca_compacta(PTregistroMudanca registro, PTmensagemCAN mensagem, Tuint32 quantidade, 
+                                 Tuint64 tempoReferencia, Tuint32 *suprimidos){
+  Tuint32 i;
+  Tuint32 mantidas = 0;
+  PTentradaMudanca entrada;
+  Tuint64 tempo;
+  Tbool nova;
+
+  if(!registro->ativo){
+    return quantidade;
+  }
+
+  for(i=0; i<quantidade; i++){
+    mensagem[mantidas] = mensagem[i];
+    if(QUADRO_ERRO(mensagem[i])){
+      mantidas ++;
+      continue;
+    }
+
+    entrada = registroMudanca_buscaEntrada(registro, CHAVE_MUDANCA(mensagem[i]), &nova);
+    if(entrada == NULL){
+      mantidas ++;
+      continue;
+    }
+
+    tempo = TEMPO_ABSOLUTO_QUADRO(mensagem[i], tempoReferencia);
+    if((!nova) && 
+       (entrada->tamanho == mensagem[i].tamanho) &&
+       (memcmp(entrada->dados, mensagem[i].dados, mensagem[i].tamanho) == 0) &&
+       ((registro->intervaloQuadroChave == 0) || ((tempo - entrada->ultimoRegistro) < registro->intervaloQuadroChave))){
+      registro->suprimidos ++;
+      if(registro->resumo){
+        (*suprimidos) ++;
+      }
+      continue;
+    }
+
+    entrada->tamanho = mensagem[i].tamanho;
+    (void)memcpy(entrada->dados, mensagem[i].dados, TAMANHO_MAX_DADOS_QUADRO_CAN);
+    entrada->ultimoRegistro = tempo;
+    mantidas ++;
+  }
+  return mantidas;
+}
@@ -0,0 +1,26 @@
+/**
+ * @file    registro_mudanca.h
+ * @brief   Esse arquivo contem o prototipo das funções do registro somente de mudanças, que
+ *          suprime os quadros cujos dados se repetem desde o ultimo registro do identificador
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef REGISTRO_MUDANCA_H_INCLUDED
+#define REGISTRO_MUDANCA_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Submódulos do sistema
+#include "tipos.h"
+#include "erros.h"
+
+/// Funções exportadas
+Terro registroMudanca_inicializa(PTregistroMudanca registro, Tbool ativo, Tuint32 intervaloQuadroChave, Tbool resumo);
+void registroMudanca_finaliza(PTregistroMudanca registro);
+Tuint32 registroMudanca_compacta(PTregistroMudanca registro, PTmensagemCAN mensagem, Tuint32 quantidade, 
+                                 Tuint64 tempoReferencia, Tuint32 *suprimidos);
+
+#endif // REGISTRO_MUDANCA_H_INCLUDED
@@ -0,0 +1,72 @@
+/**
+ * @file    registro_pcap.cpp
+ * @brief   Esse arquivo contem as funções que codificam os blocos de mensagens no formato pcap
+ *          com o tipo de enlace LINKTYPE_CAN_SOCKETCAN (ver registro_pcap.h)
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "registro_pcap.h"
+
+/**
+ * @brief  Função que escreve o cabeçalho do arquivo pcap, uma vez no inicio de cada arquivo
+ * @param  destino: recebe TAMANHO_CABECALHO_PCAP bytes
+ * @return quantidade de bytes escritos
+ */
+Tuint32 registroPcap_formataCabecalho(Tuint8 *destino){
+
+  formatoBinario_escreveInteiro(&destino[0], MAGICO_PCAP, 4);
+  formatoBinario_escreveInteiro(&destino[4], VERSAO_MAIOR_PCAP, 2);
+  formatoBinario_escreveInteiro(&destino[6], VERSAO_MENOR_PCAP, 2);
+  formatoBinario_escreveInteiro(&destino[8], 0, 4);   // fuso, o tempo ja esta em UTC
+  formatoBinario_escreveInteiro(&destino[12], 0, 4);  // precisao
+  formatoBinario_escreveInteiro(&destino[16], TAMANHO_QUADRO_SOCKETCAN, 4);
+  formatoBinario_escreveInteiro(&destino[20], LINKTYPE_CAN_SOCKETCAN, 4);
+
+  return TAMANHO_CABECALHO_PCAP;
+}
+
+/**
+ * @brief  Função que codifica uma quantidade x de quadros CAN como pacotes pcap
+ * @param  destino: recebe TAMANHO_REGISTRO_PCAP bytes por quadro
+ * @param  mensagem: Ponteiro para o array com as mensagens CANs
+ * @param  quantidade: quantidade de mensagens can presentes no array
+ * @param  tempoReferencia: instante (esp_timer, us) posterior a todas as mensagens do array
+ * @param  relogioReferencia: hora (us desde 1970) correspondente a tempoReferencia
+ * @return quantidade de bytes escritos
+ */
+Tuint32 registroPcap_formataQuadros(Tuint8 *destino, PTmensagemCAN mensagem, Tuint32 quantidade,
+                                    Tuint64 tempoReferencia, Tuint64 relogioReferencia){
+  Tuint8 *pacote;
+  Tuint64 relogioQuadro;
+  Tuint32 i;
+
+  for(i=0; i<quantidade; i++){
+    pacote = &destino[(Tuint32)i * TAMANHO_REGISTRO_PCAP];
+    relogioQuadro = (relogioReferencia - (tempoReferencia - TEMPO_ABSOLUTO_QUADRO(mensagem[i], tempoReferencia)));
+
+    formatoBinario_escreveInteiro(&pacote[0], (relogioQuadro / 1000000ULL), 4);
+    formatoBinario_escreveInteiro(&pacote[4], (relogioQuadro % 1000000ULL), 4);
+    formatoBinario_escreveInteiro(&pacote[8], TAMANHO_QUADRO_SOCKETCAN, 4);
+    formatoBinario_escreveInteiro(&pacote[12], TAMANHO_QUADRO_SOCKETCAN, 4);
+
+    // O identificador ja segue o layout do can_id, so a ordem dos bytes muda
+    pacote[16] = (Tuint8)(mensagem[i].identificador >> 24);
+    pacote[17] = (Tuint8)(mensagem[i].identificador >> 16);
+    pacote[18] = (Tuint8)(mensagem[i].identificador >> 8);
+    pacote[19] = (Tuint8)(mensagem[i].identificador);
+    pacote[20] = mensagem[i].tamanho;
+    pacote[21] = 0;
+    pacote[22] = 0;
+    pacote[23] = 0;
+
+    // Quadro remoto tem DLC mas nao tem dados
+    (void)memset(&pacote[24], 0x00, TAMANHO_MAX_DADOS_QUADRO_CAN);
+    if(!QUADRO_REMOTO(mensagem[i])){
+      (void)memcpy(&pacote[24], mensagem[i].dados, mensagem[i].tamanho);
+    }
+  }
+
+  return ((Tuint32)quantidade * TAMANHO_REGISTRO_PCAP);
+}
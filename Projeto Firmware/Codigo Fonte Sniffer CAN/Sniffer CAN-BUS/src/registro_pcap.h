@@ -0,0 +1,47 @@
+/**
+ * @file    registro_pcap.h
+ * @brief   Esse arquivo contem o prototipo das funções que codificam os blocos de mensagens no
+ *          formato pcap, aberto diretamente pelo Wireshark e pelo tshark.
+ *
+ *          Cabeçalho do arquivo (TAMANHO_CABECALHO_PCAP bytes, little-endian): magico 0xA1B2C3D4
+ *          (tempo em us), versao 2.4, fuso e precisao zerados, snaplen e tipo de enlace
+ *          LINKTYPE_CAN_SOCKETCAN.
+ *
+ *          Cada quadro ocupa TAMANHO_REGISTRO_PCAP bytes: o cabeçalho do pacote (segundos e us
+ *          desde 1970, tamanho capturado e tamanho original) e a struct can_frame do SocketCAN
+ *          (can_id big-endian, DLC, 3 bytes reservados e 8 bytes de dados).
+ *
+ *          O pcap nao tem onde guardar os marcadores de perda, de quadros suprimidos e de saude
+ *          do barramento, eles ficam somente nos formatos texto e binario
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef REGISTRO_PCAP_H_INCLUDED
+#define REGISTRO_PCAP_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Submódulos do sistema
+#include "tipos.h"
+#include "erros.h"
+#include "formato_binario.h"
+
+/// Definições importantes
+#define MAGICO_PCAP                 0xA1B2C3D4U
+#define VERSAO_MAIOR_PCAP           2
+#define VERSAO_MENOR_PCAP           4
+#define LINKTYPE_CAN_SOCKETCAN      227
+#define TAMANHO_CABECALHO_PCAP      24
+#define TAMANHO_CABECALHO_PACOTE_PCAP 16
+#define TAMANHO_QUADRO_SOCKETCAN    16    // sizeof(struct can_frame)
+#define TAMANHO_REGISTRO_PCAP       (TAMANHO_CABECALHO_PACOTE_PCAP + TAMANHO_QUADRO_SOCKETCAN)
+
+/// Funções exportadas
+Tuint32 registroPcap_formataCabecalho(Tuint8 *destino);
+Tuint32 registroPcap_formataQuadros(Tuint8 *destino, PTmensagemCAN mensagem, Tuint32 quantidade,
+                                    Tuint64 tempoReferencia, Tuint64 relogioReferencia);
+
+#endif // REGISTRO_PCAP_H_INCLUDED
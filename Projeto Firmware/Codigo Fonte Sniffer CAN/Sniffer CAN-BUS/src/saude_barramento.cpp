@@ -0,0 +1,200 @@
+/**
+ * @file    saude_barramento.cpp
+ * @brief   Esse arquivo contem as funções da saude do barramento. A tarefa de captura le os
+ *          contadores de erro (TEC/REC) e o EFLG do MCP2515 periodicamente e soma os bits de cada
+ *          quadro recebido para estimar a carga do barramento. Assim é possivel separar os quadros
+ *          perdidos no MCP2515 (RX0OVR/RX1OVR) dos perdidos na fila de mensagens
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "saude_barramento.h"
+
+// Definições importantes
+// Bits de um quadro sem dados, do SOF ao espaço entre quadros (IFS): padrao 47, extendido 67
+#define BITS_QUADRO_PADRAO            47
+#define BITS_QUADRO_EXTENDIDO         67
+// Bits sujeitos ao stuffing (SOF ate o fim do CRC) de um quadro sem dados
+#define BITS_STUFFING_PADRAO          34
+#define BITS_STUFFING_EXTENDIDO       54
+// Pior caso de stuffing: um bit a cada 4 depois do primeiro
+#define PIOR_CASO_STUFFING(bits)      (((bits) - 1) / 4)
+
+// Bits por quadro de acordo com o DLC, calculados uma vez na inicialização
+static Tuint8 bitsMinimosQuadro[2][TAMANHO_MAX_DADOS_QUADRO_CAN + 1];
+static Tuint8 bitsMaximosQuadro[2][TAMANHO_MAX_DADOS_QUADRO_CAN + 1];
+
+/**
+ * @brief  Função que inicializa a saude do barramento e a tabela de bits por DLC
+ * @param  saude: saude que será inicializada
+ * @param  bitsPorSegundo: taxa do barramento
+ * @return void
+ */
+void saudeBarramento_inicializa(PTsaudeBarramento saude, Tuint32 bitsPorSegundo){
+  Tuint8 dlc;
+
+  (void)memset(saude, 0x00, sizeof(TsaudeBarramento));
+  saude->bitsPorSegundo = bitsPorSegundo;
+
+  for(dlc=0; dlc<=TAMANHO_MAX_DADOS_QUADRO_CAN; dlc++){
+    bitsMinimosQuadro[0][dlc] = (BITS_QUADRO_PADRAO + (8 * dlc));
+    bitsMinimosQuadro[1][dlc] = (BITS_QUADRO_EXTENDIDO + (8 * dlc));
+    bitsMaximosQuadro[0][dlc] = (bitsMinimosQuadro[0][dlc] + PIOR_CASO_STUFFING(BITS_STUFFING_PADRAO + (8 * dlc)));
+    bitsMaximosQuadro[1][dlc] = (bitsMinimosQuadro[1][dlc] + PIOR_CASO_STUFFING(BITS_STUFFING_EXTENDIDO + (8 * dlc)));
+  }
+}
+
+/**
+ * @brief  Função que soma os bits de um quadro recebido na janela de carga. Chamada pela tarefa de
+ *         captura para todo quadro lido do MCP2515, mesmo os que a fila descartar
+ * @param  saude: saude do barramento
+ * @param  extendido: quadro extendido?
+ * @param  remoto: requisição remota? (sem campo de dados)
+ * @param  tamanho: DLC do quadro (0 a 8)
+ * @return void
+ */
+void saudeBarramento_contaQuadro(PTsaudeBarramento saude, Tbool extendido, Tbool remoto, Tuint8 tamanho){
+  Tuint8 dlc = (remoto) ? 0 : tamanho;
+
+  saude->bitsMinimosJanela += bitsMinimosQuadro[(extendido) ? 1 : 0][dlc];
+  saude->bitsMaximosJanela += bitsMaximosQuadro[(extendido) ? 1 : 0][dlc];
+}
+
+/**
+ * @brief  Função que informa se ja é hora de ler os contadores do MCP2515
+ * @param  saude: saude do barramento
+ * @param  agora: instante atual (esp_timer, us)
+ * @return VERDADEIRO se passou INTERVALO_AMOSTRA_SAUDE desde a ultima amostra
+ */
+Tbool saudeBarramento_amostraPendente(PTsaudeBarramento saude, Tuint64 agora){
+  return ((agora - saude->ultimaAmostra) >= INTERVALO_AMOSTRA_SAUDE);
+}
+
+/**
+ * @brief  Função que obtem o estado de erro a partir do EFLG
+ * @param  eflg: registrador EFLG
+ * @return estado
+ */
+static TestadoBarramento saudeBarramento_estado(Tuint8 eflg){
+  if(eflg & MCP2515_EFLG_TXBO){
+    return eBusOff;
+  }
+  if(eflg & (MCP2515_EFLG_TXEP | MCP2515_EFLG_RXEP)){
+    return eErroPassivo;
+  }
+  if(eflg & MCP2515_EFLG_EWARN){
+    return eErroAviso;
+  }
+  return eErroAtivo;
+}
+
+/**
+ * @brief  Função que registra uma leitura dos contadores do MCP2515 e, ao fim de cada janela,
+ *         a carga do barramento. Chamada somente pela tarefa de captura
+ * @param  saude: saude do barramento
+ * @param  tec: contador de erros de transmissão
+ * @param  rec: contador de erros de recepção
+ * @param  eflg: registrador EFLG lido antes de limpar RX0OVR/RX1OVR
+ * @param  agora: instante da leitura (esp_timer, us)
+ * @return void
+ */
+void saudeBarramento_amostra(PTsaudeBarramento saude, Tuint8 tec, Tuint8 rec, Tuint8 eflg, Tuint64 agora){
+  TestadoBarramento estado = saudeBarramento_estado(eflg);
+  Tuint32 sequencia = saude->sequencia;
+  Tuint64 bitsJanela;
+  Tbool evento = FALSO;
+
+  // Inicio da escrita: sequencia impar
+  __atomic_store_n(&saude->sequencia, (sequencia + 1), __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  saude->amostra.tec = tec;
+  saude->amostra.rec = rec;
+  saude->amostra.eflg = eflg;
+  if(estado != saude->amostra.estado){
+    saude->amostra.estado = estado;
+    saude->amostra.transicoes ++;
+    evento = VERDADEIRO;
+  }
+  if(eflg & MCP2515_EFLG_RX0OVR){
+    saude->amostra.estourosRXB0 ++;
+    evento = VERDADEIRO;
+  }
+  if(eflg & MCP2515_EFLG_RX1OVR){
+    saude->amostra.estourosRXB1 ++;
+    evento = VERDADEIRO;
+  }
+
+  // Carga = bits observados / bits possiveis na janela (decimos de %)
+  if(saude->inicioJanela == 0){
+    saude->inicioJanela = agora;
+  }else if(((agora - saude->inicioJanela) >= JANELA_CARGA_BARRAMENTO) && (saude->bitsPorSegundo > 0)){
+    bitsJanela = (((Tuint64)saude->bitsPorSegundo * (agora - saude->inicioJanela)) / 1000000ULL);
+    saude->amostra.cargaMinima = (Tuint16)((saude->bitsMinimosJanela * 1000ULL) / bitsJanela);
+    saude->amostra.cargaMaxima = (Tuint16)((saude->bitsMaximosJanela * 1000ULL) / bitsJanela);
+    saude->bitsMinimosJanela = 0;
+    saude->bitsMaximosJanela = 0;
+    saude->inicioJanela = agora;
+  }
+  saude->ultimaAmostra = agora;
+
+  // Fim da escrita: sequencia par
+  __atomic_store_n(&saude->sequencia, (sequencia + 2), __ATOMIC_RELEASE);
+
+  if(evento){
+    __atomic_store_n(&saude->eventos, (saude->eventos + 1), __ATOMIC_RELEASE);
+  }
+}
+
+/**
+ * @brief  Função que copia a ultima amostra sem bloquear a captura
+ * @param  saude: saude do barramento
+ * @param  amostra: recebe a amostra
+ * @return void
+ */
+void saudeBarramento_le(PTsaudeBarramento saude, PTamostraSaude amostra){
+  Tuint32 inicio, fim;
+
+  do{
+    inicio = __atomic_load_n(&saude->sequencia, __ATOMIC_ACQUIRE);
+    (void)memcpy(amostra, &saude->amostra, sizeof(TamostraSaude));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    fim = __atomic_load_n(&saude->sequencia, __ATOMIC_RELAXED);
+  }while((inicio & 1U) || (inicio != fim));
+}
+
+/**
+ * @brief  Função que retorna o nome do estado de erro
+ * @param  estado: estado de erro
+ * @return nome do estado
+ */
+const char *saudeBarramento_nomeEstado(TestadoBarramento estado){
+  switch(estado){
+    case eErroAviso:   return "AVISO";
+    case eErroPassivo: return "PASSIVO";
+    case eBusOff:      return "BUS-OFF";
+    default:           return "ATIVO";
+  }
+}
+
+/**
+ * @brief  Função que escreve a amostra em JSON compacto:
+ *         {"estado":"ATIVO","tec":0,"rec":0,"eflg":0,"ovr0":0,"ovr1":0,"trans":0,"carga":[31.2,36.8]}
+ *         carga em %, sem stuffing e com o pior caso de stuffing
+ * @param  texto: ponteiro para a string que irá receber o JSON (TAMANHO_MAXIMO_JSON_SAUDE)
+ * @param  amostra: amostra lida com saudeBarramento_le
+ * @return quantidade de caracteres escritos
+ */
+Tuint16 saudeBarramento_formataJSON(char *texto, PTamostraSaude amostra){
+  int tamanho;
+
+  tamanho = sprintf(texto, 
+    "{\"estado\":\"%s\",\"tec\":%u,\"rec\":%u,\"eflg\":%u,\"ovr0\":%u,\"ovr1\":%u,\"trans\":%u,\"carga\":[%u.%u,%u.%u]}",
+    saudeBarramento_nomeEstado(amostra->estado), amostra->tec, amostra->rec, amostra->eflg,
+    amostra->estourosRXB0, amostra->estourosRXB1, amostra->transicoes,
+    (amostra->cargaMinima / 10), (amostra->cargaMinima % 10),
+    (amostra->cargaMaxima / 10), (amostra->cargaMaxima % 10)
+  );
+  return ((tamanho > 0) ? (Tuint16)tamanho : 0);
+}
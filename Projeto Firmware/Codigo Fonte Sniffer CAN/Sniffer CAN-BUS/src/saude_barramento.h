@@ -0,0 +1,43 @@
+/**
+ * @file    saude_barramento.h
+ * @brief   Esse arquivo contem o prototipo das funções da saude do barramento: contadores de erro
+ *          e estouros do MCP2515 e carga estimada do barramento
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef SAUDE_BARRAMENTO_H_INCLUDED
+#define SAUDE_BARRAMENTO_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Submódulos do sistema
+#include "tipos.h"
+#include "erros.h"
+
+/// Bits do registrador EFLG do MCP2515
+#define MCP2515_EFLG_EWARN     0x01
+#define MCP2515_EFLG_RXWAR     0x02
+#define MCP2515_EFLG_TXWAR     0x04
+#define MCP2515_EFLG_RXEP      0x08
+#define MCP2515_EFLG_TXEP      0x10
+#define MCP2515_EFLG_TXBO      0x20
+#define MCP2515_EFLG_RX0OVR    0x40
+#define MCP2515_EFLG_RX1OVR    0x80
+#define MCP2515_EFLG_ESTOUROS  (MCP2515_EFLG_RX0OVR | MCP2515_EFLG_RX1OVR)
+
+/// Tamanho maximo do texto JSON da saude (ver saudeBarramento_formataJSON)
+#define TAMANHO_MAXIMO_JSON_SAUDE   160
+
+/// Funções exportadas
+void saudeBarramento_inicializa(PTsaudeBarramento saude, Tuint32 bitsPorSegundo);
+void saudeBarramento_contaQuadro(PTsaudeBarramento saude, Tbool extendido, Tbool remoto, Tuint8 tamanho);
+Tbool saudeBarramento_amostraPendente(PTsaudeBarramento saude, Tuint64 agora);
+void saudeBarramento_amostra(PTsaudeBarramento saude, Tuint8 tec, Tuint8 rec, Tuint8 eflg, Tuint64 agora);
+void saudeBarramento_le(PTsaudeBarramento saude, PTamostraSaude amostra);
+const char *saudeBarramento_nomeEstado(TestadoBarramento estado);
+Tuint16 saudeBarramento_formataJSON(char *texto, PTamostraSaude amostra);
+
+#endif // SAUDE_BARRAMENTO_H_INCLUDED
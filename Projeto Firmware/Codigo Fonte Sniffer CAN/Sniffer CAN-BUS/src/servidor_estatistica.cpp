@@ -0,0 +1,297 @@
+/**
+ * @file    servidor_estatistica.cpp
+ * @brief   Esse arquivo contem o servidor HTTP local: GET /estatistica responde com a tabela de 
+ *          estatisticas por identificador em JSON, enviada em partes para nao alocar o texto inteiro,
+ *          GET /saude com os contadores de erro do MCP2515 e a carga do barramento e GET /registro
+ *          com os trechos de um arquivo de registro selecionados pelo indice (formato_indice.h)
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "esp_timer.h"
+#include "servidor_estatistica.h"
+
+// Definições importantes
+#define TAMANHO_PARTE_REGISTRO_SERVIDOR  512  // bytes do registro lidos e enviados por vez
+
+// Variaveis do modulo
+static WebServer servidorEstatistica(PORTA_SERVIDOR_ESTATISTICA);
+static PTtabelaEstatistica tabelaServidor = NULL;
+static PTsaudeBarramento saudeServidor = NULL;
+static Tbool servidorIniciado = FALSO;
+// Registro do indice lido por GET /registro. O servidor atende uma requisição por vez
+static Tuint8 entradaIndiceServidor[TAMANHO_BALDE_INDICE(MAXIMA_QUANTIDADE_IDS_INDICE)];
+
+/**
+ * @brief  Função que envia um trecho do JSON ao cliente
+ * @param  texto: trecho do JSON
+ * @param  tamanho: quantidade de caracteres
+ * @return void
+ */
+static void servidorEstatistica_escreve(const char *texto, Tuint16 tamanho){
+  servidorEstatistica.sendContent(texto, tamanho);
+}
+
+/**
+ * @brief  Função que responde GET /estatistica
+ * @param  void
+ * @return void
+ */
+static void servidorEstatistica_trataEstatistica(void){
+  servidorEstatistica.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  servidorEstatistica.send(200, "application/json", "");
+  estatisticaId_escreveTabelaJSON(tabelaServidor, (Tuint64)esp_timer_get_time(), servidorEstatistica_escreve);
+  // Trecho vazio encerra a resposta em partes
+  servidorEstatistica.sendContent("", 0);
+}
+
+/**
+ * @brief  Função que responde GET /saude
+ * @param  void
+ * @return void
+ */
+static void servidorEstatistica_trataSaude(void){
+  TamostraSaude amostra;
+  char texto[TAMANHO_MAXIMO_JSON_SAUDE];
+
+  saudeBarramento_le(saudeServidor, &amostra);
+  (void)saudeBarramento_formataJSON(texto, &amostra);
+  servidorEstatistica.send(200, "application/json", texto);
+}
+
+/**
+ * @brief  Função que abre o arquivo de registro pelo identificador, em qualquer um dos formatos
+ * @param  id: identificador do arquivo (LOG-xxxx)
+ * @param  caminho: recebe o caminho do arquivo (TAMANHO_MAXIMO_NOME_ARQUIVO bytes)
+ * @param  registro: recebe o arquivo aberto para leitura
+ * @return VERDADEIRO se o arquivo existe
+ */
+static Tbool servidorEstatistica_abreRegistro(Tuint32 id, char *caminho, File *registro){
+  static const TformatoRegistro formatos[] = {eFormatoTexto, eFormatoBinario, eFormatoPcap, eFormatoMdf};
+  Tuint8 i;
+
+  for(i=0; i<(sizeof(formatos) / sizeof(formatos[0])); i++){
+    (void)snprintf(caminho, TAMANHO_MAXIMO_NOME_ARQUIVO, NOME_ARQUIVO_REGISTRO(formatos[i]), (int)id);
+    if(SD.exists(caminho)){
+      *registro = SD.open(caminho, FILE_READ);
+      return (*registro) ? VERDADEIRO : FALSO;
+    }
+  }
+  return FALSO;
+}
+
+/**
+ * @brief  Função que envia ao cliente um trecho do arquivo de registro
+ * @param  registro: arquivo de registro aberto para leitura
+ * @param  posicao: posição do trecho no arquivo
+ * @param  tamanho: quantidade de bytes do trecho
+ * @return void
+ */
+static void servidorEstatistica_enviaTrecho(File *registro, Tuint32 posicao, Tuint32 tamanho){
+  Tuint8 parte[TAMANHO_PARTE_REGISTRO_SERVIDOR];
+  size_t lido;
+
+  if(!registro->seek(posicao)){
+    return;
+  }
+  while(tamanho > 0){
+    lido = registro->read(parte, ((tamanho < sizeof(parte)) ? tamanho : sizeof(parte)));
+    if(lido == 0){
+      break;
+    }
+    servidorEstatistica.sendContent((const char *)parte, lido);
+    tamanho -= lido;
+  }
+}
+
+/**
+ * @brief  Função que responde GET /registro?arquivo=N[&id=7E8][&inicio=s][&fim=s]. Percorre somente
+ *         o indice e envia os trechos do registro com quadros do identificador no intervalo
+ *         (segundos desde o primeiro quadro do arquivo), precedidos do cabeçalho do formato.
+ *         O id segue a lista de identificadores: ate 3 digitos é padrao, 8 digitos é extendido
+ *         (ex: 000007E8), sem coringas. Trechos vizinhos sao enviados como um so
+ * @param  void
+ * @return void
+ */
+static void servidorEstatistica_trataRegistro(void){
+  File registro;
+  File indice;
+  char caminho[TAMANHO_MAXIMO_NOME_ARQUIVO];
+  char caminhoIndice[TAMANHO_MAXIMO_NOME_ARQUIVO];
+  char prefixo[sizeof(PREFIXO_REGISTRO_PREALOCADO)];
+  Tuint8 cabecalho[TAMANHO_CABECALHO_INDICE];
+  Tuint8 *entrada = entradaIndiceServidor;
+  Tuint8 *conteudo = &entradaIndiceServidor[TAMANHO_INICIO_REGISTRO_INDICE];
+  Tuint32 tamanhoMaximo = sizeof(entradaIndiceServidor);
+  Tuint32 inicioArquivo = 0;
+  Tuint32 tamanhoCabecalho;
+  Tuint32 tamanho;
+  Tuint32 deslocamento;
+  Tuint32 fimBalde;
+  Tuint32 inicioTrecho = 0;
+  Tuint32 fimTrecho = 0;
+  Tuint32 identificador = 0;
+  Tuint32 mascara;
+  Tuint32 i;
+  Tuint16 ids;
+  Tuint64 primeiro;
+  Tuint64 ultimo;
+  Tuint64 inicio = 0;
+  Tuint64 fim = 0xFFFFFFFFFFFFFFFFULL;
+  Tbool filtraId = servidorEstatistica.hasArg("id");
+  Tbool haTrecho = FALSO;
+  Tbool primeiroBalde = VERDADEIRO;
+  Tbool seleciona;
+  Tbool extendido;
+
+  if(!servidorEstatistica.hasArg("arquivo")){
+    servidorEstatistica.send(400, "text/plain", "Parametro arquivo obrigatorio");
+    return;
+  }
+  if(filtraId){
+    // A chave do indice guarda o tipo do quadro: 7E8 padrao e 000007E8 extendido sao diferentes
+    i = 0;
+    if((filtroSoftware_leIdentificador(servidorEstatistica.arg("id").c_str(), &i, &identificador, &mascara, &extendido) != SUCESSO) ||
+       (servidorEstatistica.arg("id")[i] != '\0') ||
+       (mascara != (extendido ? MASCARA_ID_EXTENDIDO : MASCARA_ID_PADRAO))){
+      servidorEstatistica.send(400, "text/plain", "Parametro id invalido (3 digitos padrao, 8 extendido)");
+      return;
+    }
+    if(extendido){
+      identificador |= FLAG_QUADRO_EXTENDIDO;
+    }
+  }
+  if(!servidorEstatistica_abreRegistro((Tuint32)servidorEstatistica.arg("arquivo").toInt(), caminho, &registro)){
+    servidorEstatistica.send(404, "text/plain", "Registro nao encontrado");
+    return;
+  }
+
+  gerenciamentoCartao_caminhoIndice(caminhoIndice, caminho);
+  indice = SD.open(caminhoIndice, FILE_READ);
+  if((!indice) || 
+     (indice.read(cabecalho, TAMANHO_CABECALHO_INDICE) != TAMANHO_CABECALHO_INDICE) ||
+     (memcmp(cabecalho, MAGICO_FORMATO_INDICE, TAMANHO_MAGICO_FORMATO_INDICE) != 0) ||
+     (formatoBinario_crc32(0, cabecalho, 16) != (Tuint32)formatoBinario_leInteiro(&cabecalho[16], TAMANHO_CRC_BINARIO))){
+    if(indice){
+      indice.close();
+    }
+    registro.close();
+    servidorEstatistica.send(404, "text/plain", "Indice nao encontrado");
+    return;
+  }
+  tamanhoCabecalho = (Tuint32)formatoBinario_leInteiro(&cabecalho[12], 4);
+
+  // Arquivo prealocado: o conteudo começa depois do setor de cabeçalho
+  if((registro.read((Tuint8 *)prefixo, (sizeof(prefixo) - 1)) == (sizeof(prefixo) - 1)) &&
+     (memcmp(prefixo, PREFIXO_REGISTRO_PREALOCADO, (sizeof(prefixo) - 1)) == 0)){
+    inicioArquivo = TAMANHO_REGISTRO_PREALOCADO;
+  }
+
+  servidorEstatistica.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  servidorEstatistica.send(200, (strstr(caminho, ".txt") != NULL) ? "text/plain" : "application/octet-stream", "");
+
+  // As entradas dos baldes vem antes do resumo, a leitura para no primeiro registro de outro tipo
+  while(indice.read(entrada, TAMANHO_INICIO_REGISTRO_INDICE) == TAMANHO_INICIO_REGISTRO_INDICE){
+    tamanho = (Tuint32)formatoBinario_leInteiro(&entrada[1], 2);
+    if((entrada[0] != REGISTRO_INDICE_BALDE) || 
+       ((TAMANHO_FIXO_REGISTRO_INDICE + tamanho) > tamanhoMaximo) ||
+       (tamanho < TAMANHO_INICIO_BALDE_INDICE)){
+      break;
+    }
+    if((indice.read(conteudo, (tamanho + TAMANHO_CRC_BINARIO)) != (tamanho + TAMANHO_CRC_BINARIO)) ||
+       (formatoIndice_verificaRegistro(entrada, (TAMANHO_FIXO_REGISTRO_INDICE + tamanho)) == 0)){
+      break;
+    }
+
+    deslocamento = (Tuint32)formatoBinario_leInteiro(&conteudo[0], 4);
+    fimBalde = (deslocamento + (Tuint32)formatoBinario_leInteiro(&conteudo[4], 4));
+    primeiro = formatoBinario_leInteiro(&conteudo[8], 8);
+    ultimo = formatoBinario_leInteiro(&conteudo[16], 8);
+    ids = (Tuint16)formatoBinario_leInteiro(&conteudo[29], 2);
+
+    // Os tempos pedidos contam a partir do primeiro quadro do arquivo
+    if(primeiroBalde){
+      if(servidorEstatistica.hasArg("inicio")){
+        inicio = (primeiro + (Tuint64)(atof(servidorEstatistica.arg("inicio").c_str()) * 1000000.0));
+      }
+      if(servidorEstatistica.hasArg("fim")){
+        fim = (primeiro + (Tuint64)(atof(servidorEstatistica.arg("fim").c_str()) * 1000000.0));
+      }
+      primeiroBalde = FALSO;
+    }
+
+    seleciona = ((ultimo >= inicio) && (primeiro <= fim));
+    // Balde com a lista incompleta pode ter o identificador
+    if(seleciona && filtraId && ((conteudo[28] & INDICE_BALDE_INCOMPLETO) == 0)){
+      seleciona = FALSO;
+      for(i=0; (i<ids) && (!seleciona); i++){
+        seleciona = (((Tuint32)formatoBinario_leInteiro(&conteudo[TAMANHO_INICIO_BALDE_INDICE + (i * TAMANHO_ID_INDICE)], 4) & 
+                     (MASCARA_ID_EXTENDIDO | FLAG_QUADRO_EXTENDIDO)) == identificador);
+      }
+    }
+    if(!seleciona){
+      continue;
+    }
+
+    if(haTrecho && (deslocamento <= fimTrecho)){
+      if(fimBalde > fimTrecho){
+        fimTrecho = fimBalde;
+      }
+      continue;
+    }
+    if(haTrecho){
+      servidorEstatistica_enviaTrecho(&registro, (inicioArquivo + inicioTrecho), (fimTrecho - inicioTrecho));
+    }else if((deslocamento > 0) && (tamanhoCabecalho > 0)){
+      servidorEstatistica_enviaTrecho(&registro, inicioArquivo, tamanhoCabecalho);
+    }
+    inicioTrecho = deslocamento;
+    fimTrecho = fimBalde;
+    haTrecho = VERDADEIRO;
+  }
+  if(haTrecho){
+    servidorEstatistica_enviaTrecho(&registro, (inicioArquivo + inicioTrecho), (fimTrecho - inicioTrecho));
+  }
+
+  indice.close();
+  registro.close();
+  // Trecho vazio encerra a resposta em partes
+  servidorEstatistica.sendContent("", 0);
+}
+
+/**
+ * @brief  Função que responde os caminhos desconhecidos
+ * @param  void
+ * @return void
+ */
+static void servidorEstatistica_trataDesconhecido(void){
+  servidorEstatistica.send(404, "text/plain", "Nao encontrado");
+}
+
+/**
+ * @brief  Função que inicia o servidor HTTP local. Deve ser chamada com o wifi conectado
+ * @param  tabela: tabela de estatisticas publicada
+ * @param  saude: saude do barramento publicada
+ * @return void
+ */
+void servidorEstatistica_inicializa(PTtabelaEstatistica tabela, PTsaudeBarramento saude){
+  tabelaServidor = tabela;
+  saudeServidor = saude;
+  servidorEstatistica.on(CAMINHO_SERVIDOR_ESTATISTICA, HTTP_GET, servidorEstatistica_trataEstatistica);
+  servidorEstatistica.on(CAMINHO_SERVIDOR_SAUDE, HTTP_GET, servidorEstatistica_trataSaude);
+  servidorEstatistica.on(CAMINHO_SERVIDOR_REGISTRO, HTTP_GET, servidorEstatistica_trataRegistro);
+  servidorEstatistica.onNotFound(servidorEstatistica_trataDesconhecido);
+  servidorEstatistica.begin();
+  servidorIniciado = VERDADEIRO;
+}
+
+/**
+ * @brief  Função que atende os clientes pendentes, chamada periodicamente fora da captura
+ * @param  void
+ * @return void
+ */
+void servidorEstatistica_atende(void){
+  if(servidorIniciado){
+    servidorEstatistica.handleClient();
+  }
+}
@@ -0,0 +1,31 @@
+/**
+ * @file    servidor_estatistica.h
+ * @brief   Esse arquivo contem o prototipo das funções do servidor HTTP local que publica a 
+ *          tabela de estatisticas por identificador, a saude do barramento e os trechos dos registros
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef SERVIDOR_ESTATISTICA_H_INCLUDED
+#define SERVIDOR_ESTATISTICA_H_INCLUDED
+
+/// Inclusões importantes
+#include <WebServer.h>
+
+// Submódulos do sistema
+#include "tipos.h"
+#include "erros.h"
+#include "estatistica_id.h"
+#include "saude_barramento.h"
+#include "gerenciamento_cartao.h"
+
+/// Porta e caminho do servidor HTTP local
+#define PORTA_SERVIDOR_ESTATISTICA     80
+#define CAMINHO_SERVIDOR_ESTATISTICA   "/estatistica"
+#define CAMINHO_SERVIDOR_SAUDE         "/saude"
+#define CAMINHO_SERVIDOR_REGISTRO      "/registro"
+
+/// Funções exportadas
+void servidorEstatistica_inicializa(PTtabelaEstatistica tabela, PTsaudeBarramento saude);
+void servidorEstatistica_atende(void);
+
+#endif // SERVIDOR_ESTATISTICA_H_INCLUDED
@@ -1,166 +1,157 @@
-/**
- * @file    snifferCan_cartao.cpp
- * @brief   Esse arquivo contem as funções relativas ao envio de dados ao cartão de memória
- * @author  Emanoel Gomes Santos
- * @date    Data de Criação: 08/04/2020
-**/
-
-/// Inclusões de bibliotecas importantes
-#include "snifferCan_cartao.h"
-
-/**
- * @brief  Função que formata uma quantidade x de quadro CAN para uma string
- * @param  texto: ponteiro para a string que irá ser formatado
- * @param  mensagem: Ponteiro para o array com as mensagens CANs
- * @param  quantidade: quantidade de mensagens can presentes no array
- * @param  formatado: boleano que define se o quadro será formatado
- * @return ERRO ou SUCESSO
- */
-Terro snifferCanCartao_formataQuadroCANToString(char *texto, PTmensagemCAN mensagem, 
-                                               Tuint16 quantidade, Tbool formatado){
-  Tuint16 i,j;
-  Tuint16 ultimaPos;  
-  char *buffer;
-  Tuint16 tamanhoBuffer = (
-    (sizeof(char) * (sizeof(TmensagemCAN) * 2))  + 
-    ((formatado) ? QUANTIDADE_ESPACO_TEXTO_FORMATADO : QUANTIDADE_SEPARADORES_TEXTO) + 
-    1 + 1
-  );
-
-
-  // Reserva espaço de uma mensagem
-  buffer = (char*)malloc(tamanhoBuffer);
-  if(buffer == NULL){
-    PRINTLN("aqui");
-    return ERRO_ALOCACAO_MEMORIA;
-  }    
-
- 
-
-  for(i=0; i<quantidade; i++){
-    ultimaPos = 0;
-    
-    // Salva texto o tipo float
-    (void)sprintf(buffer,"%0.1f", (float)((float)(mensagem[i].intervalo)/1000));
-    
-    // Recupera ultima posição do texto gerado
-    ultimaPos = strlen(buffer);
-    
-    // Se deseja texto formatdo, então inserir os espaço, modulagem de acordo com tamanho 
-    if(formatado){
-      for(j=ultimaPos; j< TAMANHO_DEFINIDO_ESPACO_ENTRE_TEMPO_ID; j++){
-        buffer[ultimaPos++] = ' ';
-      }      
-    }
-    // Do contrario, apenas insere ';'
-    else{
-      buffer[ultimaPos++] = ';';  
-    }      
-    
-    // Insere identificadores verificando se é o extendido ou o padrao
-    if((mensagem[i].identificador.extendido & 0xFFFF0000) != 0){
-      
-      buffer[ultimaPos++] = HEX_TO_ASCII(((mensagem[i].identificador.extendido >> 28) & 0x0F));
-      buffer[ultimaPos++] = HEX_TO_ASCII(((mensagem[i].identificador.extendido >> 24) & 0x0F));
-      buffer[ultimaPos++] = HEX_TO_ASCII(((mensagem[i].identificador.extendido >> 20) & 0x0F));
-      buffer[ultimaPos++] = HEX_TO_ASCII(((mensagem[i].identificador.extendido >> 16) & 0x0F));
-      buffer[ultimaPos++] = HEX_TO_ASCII(((mensagem[i].identificador.extendido >> 12) & 0x0F));
-      buffer[ultimaPos++] = HEX_TO_ASCII(((mensagem[i].identificador.extendido >>  8) & 0x0F));
-      buffer[ultimaPos++] = HEX_TO_ASCII(((mensagem[i].identificador.extendido >>  4) & 0x0F));
-      buffer[ultimaPos++] = HEX_TO_ASCII(((mensagem[i].identificador.extendido >>  0) & 0x0F));
-      
-    }
-    else{      
-      buffer[ultimaPos++] = HEX_TO_ASCII(((mensagem[i].identificador.padrao >>  8) & 0x0F));
-      buffer[ultimaPos++] = HEX_TO_ASCII(((mensagem[i].identificador.padrao >>  4) & 0x0F));
-      buffer[ultimaPos++] = HEX_TO_ASCII(((mensagem[i].identificador.padrao >>  0) & 0x0F));
-    }
-    
-    // Se for o log formatado, inseri espaços, do contrario apenas inserir ';'
-    if(formatado){
-      buffer[ultimaPos++] = ' ';
-      buffer[ultimaPos++] = ' ';
-      buffer[ultimaPos++] = ' ';
-      buffer[ultimaPos++] = ' '; 
-      buffer[ultimaPos++] = ' '; 
-      buffer[ultimaPos++] = ' ';
-    }else{
-      buffer[ultimaPos++] = ';';  
-    }
-
-    // Insere tamanho de dados do frame CAN
-    buffer[ultimaPos++] = HEX_TO_ASCII(((mensagem[i].tamanho >> 4) & 0x0F));
-    buffer[ultimaPos++] = HEX_TO_ASCII(((mensagem[i].tamanho >> 0) & 0x0F));
-    
-    // Se for o log formatado, inseri espaços, do contrario apenas inserir ';' 
-    if(formatado){
-      buffer[ultimaPos++] = ' ';
-      buffer[ultimaPos++] = ' ';
-      buffer[ultimaPos++] = ' ';
-    }else{
-      buffer[ultimaPos++] = ';';       
-    }
-     
-    // Insere as mensagens de acordo com tamanho de dados do frame.  
-    for(j=0; j<mensagem[i].tamanho; j++){
-      // Se for o estilo formatado, então inserir espaço entre os bytes
-      if(formatado){
-        buffer[(3*j)+ultimaPos+0] = HEX_TO_ASCII(((mensagem[i].dados[j] >> 4) & 0x0F));
-        buffer[(3*j)+ultimaPos+1] = HEX_TO_ASCII(((mensagem[i].dados[j] >> 0) & 0x0F));
-        buffer[(3*j)+ultimaPos+2] = ' '; 
-      }else{
-        buffer[(2*j)+ultimaPos+0] = HEX_TO_ASCII(((mensagem[i].dados[j] >> 4) & 0x0F));
-        buffer[(2*j)+ultimaPos+1] = HEX_TO_ASCII(((mensagem[i].dados[j] >> 0) & 0x0F));
-      }
-    }
-
-    if(formatado){
-      // Se for formatado, então inserir nova linha, do contrario inserir apenas ';'
-      buffer[(3 *j)+ultimaPos+0] = '\r';
-      buffer[(3 *j)+ultimaPos+1] = '\n';
-      buffer[(3 *j)+ultimaPos+2] = '\0';      
-    }else{
-      // Se for formatado, então inserir nova linha, do contrario inserir apenas ';'
-      buffer[(2*j)+ultimaPos+0] = ';';
-    }
-
-    // Verifica se é a primeira interação, se for então apenas copia buffer para texto.
-    // Do contrario concatena buffer com texto existente
-    if(PRIMEIRA_INTERACAO){
-      (void)strcpy(texto,buffer);
-    }else{
-      (void)strcat(texto,buffer);
-    }
-  }
-  // Libera buffer da memória, pois foi alocado dinamicamente
-  free(buffer);
-
-  return SUCESSO;
-  
-}
-
-/**
- * @brief  Função que envia o texto para o cartão de memória
- * @param  texto: ponteiro para a string que irá ser enviado
- * @return ERRO ou SUCESSO
- */
-Terro snifferCanCartao_envia(char *texto, char *nomeArquivo){
-  Terro erro = SUCESSO;
-  
-  digitalWrite(LED_SISTEMA_PRONTO, HIGH);
-
-  // Envia dados ao cartao
-  erro = gerenciamentoCartao_escreve(texto,nomeArquivo,eModoAppend);
-  if(erro != SUCESSO){
-    return erro;
-  }  
-  
-  
-
-  // Se chegou até aqui entao tudo ocorreu com sucesso
-  return erro;
-}
-
-
-
-
+/**
+ * @file    snifferCan_cartao.cpp
+ * @brief   Esse arquivo contem as funções relativas ao envio de dados ao cartão de memória
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 08/04/2020
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "snifferCan_cartao.h"
+
+/// Latencia de escrita dos blocos no cartao, acumulada ate a proxima leitura (somente o consumidor)
+static Tuint64 somaLatenciaEscrita = 0;
+static Tuint32 latenciaMaximaEscrita = 0;
+static Tuint32 blocosEscritos = 0;
+
+/**
+ * @brief  Função que escreve o marcador de mensagens perdidas na fila antes do bloco
+ * @param  texto: ponteiro para a string que irá receber o marcador (TAMANHO_MAXIMO_MARCADOR_TEXTO)
+ * @param  quadrosPerdidos: quantidade de mensagens perdidas antes do bloco
+ * @param  formatado: boleano que define se o marcador será formatado
+ * @return quantidade de caracteres escritos
+ */
+Tuint16 snifferCanCartao_formataMarcadorPerda(char *texto, Tuint32 quadrosPerdidos, Tbool formatado){
+  int tamanho;
+
+  if(formatado){
+    tamanho = sprintf(texto, "# QUADROS PERDIDOS NA FILA: %u\r\n", quadrosPerdidos);
+  }else{
+    tamanho = sprintf(texto, "#PERDIDOS;%u;", quadrosPerdidos);
+  }
+
+  return ((tamanho > 0) ? (Tuint16)tamanho : 0);
+}
+
+/**
+ * @brief  Função que escreve o resumo dos quadros suprimidos pelo registro de mudanças enquanto
+ *         o bloco era montado
+ * @param  texto: ponteiro para a string que irá receber o marcador (TAMANHO_MAXIMO_MARCADOR_SUPRIMIDOS)
+ * @param  quadrosSuprimidos: quantidade de mensagens suprimidas
+ * @param  formatado: boleano que define se o marcador será formatado
+ * @return quantidade de caracteres escritos
+ */
+Tuint16 snifferCanCartao_formataMarcadorSuprimidos(char *texto, Tuint32 quadrosSuprimidos, Tbool formatado){
+  int tamanho;
+
+  if(formatado){
+    tamanho = sprintf(texto, "# QUADROS SEM MUDANCA SUPRIMIDOS: %u\r\n", quadrosSuprimidos);
+  }else{
+    tamanho = sprintf(texto, "#SUPRIMIDOS;%u;", quadrosSuprimidos);
+  }
+
+  return ((tamanho > 0) ? (Tuint16)tamanho : 0);
+}
+
+/**
+ * @brief  Função que escreve o marcador de evento de saude do barramento (mudança de estado de erro
+ *         ou quadro perdido no MCP2515) com os contadores e a carga no momento do evento
+ * @param  texto: ponteiro para a string que irá receber o marcador (TAMANHO_MAXIMO_MARCADOR_SAUDE)
+ * @param  saude: amostra da saude do barramento
+ * @param  formatado: boleano que define se o marcador será formatado
+ * @return quantidade de caracteres escritos
+ */
+Tuint16 snifferCanCartao_formataMarcadorSaude(char *texto, PTamostraSaude saude, Tbool formatado){
+  int tamanho;
+
+  if(formatado){
+    tamanho = sprintf(texto, "# SAUDE: %s TEC=%u REC=%u EFLG=%02X ESTOUROS=%u/%u CARGA=%u.%u-%u.%u%%\r\n",
+      saudeBarramento_nomeEstado(saude->estado), saude->tec, saude->rec, saude->eflg,
+      saude->estourosRXB0, saude->estourosRXB1,
+      (saude->cargaMinima / 10), (saude->cargaMinima % 10), (saude->cargaMaxima / 10), (saude->cargaMaxima % 10));
+  }else{
+    tamanho = sprintf(texto, "#SAUDE;%u;%u;%u;%02X;%u;%u;%u;%u;",
+      saude->estado, saude->tec, saude->rec, saude->eflg,
+      saude->estourosRXB0, saude->estourosRXB1, saude->cargaMinima, saude->cargaMaxima);
+  }
+
+  return ((tamanho > 0) ? (Tuint16)tamanho : 0);
+}
+
+/**
+ * @brief  Função que escreve o marcador de inicio de arquivo com a hora da primeira mensagem.
+ *         Somando a ela os intervalos das linhas seguintes obtem-se a hora de cada mensagem
+ * @param  texto: ponteiro para a string que irá receber o marcador (TAMANHO_MAXIMO_MARCADOR_INICIO)
+ * @param  relogio: hora da primeira mensagem do arquivo (us desde 1970)
+ * @param  formatado: boleano que define se o marcador será formatado
+ * @return quantidade de caracteres escritos
+ */
+Tuint16 snifferCanCartao_formataMarcadorInicio(char *texto, Tuint64 relogio, Tbool formatado){
+  int tamanho;
+  Tuint32 segundos = (Tuint32)(relogio / 1000000ULL);
+  Tuint32 decimos = (Tuint32)((relogio % 1000000ULL) / RESOLUCAO_TEMPO_REGISTRO);
+
+  if(formatado){
+    tamanho = sprintf(texto, "# INICIO: %u.%04u s\r\n", segundos, decimos);
+  }else{
+    tamanho = sprintf(texto, "#INICIO;%u.%04u;", segundos, decimos);
+  }
+
+  return ((tamanho > 0) ? (Tuint16)tamanho : 0);
+}
+
+/**
+ * @brief  Função que envia o texto para o cartão de memória, medindo a latencia de escrita do bloco.
+ *         O texto é copiado para o buffer do escritor, a gravação é feita pela tarefa de escrita
+ * @param  escritor: escritor do cartao
+ * @param  texto: ponteiro para os dados que irão ser enviados (texto ou blocos binarios)
+ * @param  tamanho: quantidade de bytes
+ * @param  nomeArquivo: arquivo de registro atual
+ * @return ERRO ou SUCESSO
+ */
+Terro snifferCanCartao_envia(PTescritorCartao escritor, const char *texto, Tuint32 tamanho, char *nomeArquivo){
+  Terro erro = SUCESSO;
+  Tuint32 inicio;
+  Tuint32 latencia;
+  
+  digitalWrite(LED_SISTEMA_PRONTO, HIGH);
+
+  // Envia dados ao cartao
+  inicio = micros();
+  erro = escritorCartao_escreve(escritor,texto,tamanho,nomeArquivo);
+  latencia = (micros() - inicio);
+  if(erro != SUCESSO){
+    return erro;
+  }  
+  
+  somaLatenciaEscrita += latencia;
+  blocosEscritos ++;
+  if(latencia > latenciaMaximaEscrita){
+    latenciaMaximaEscrita = latencia;
+  }
+
+  // Se chegou até aqui entao tudo ocorreu com sucesso
+  return erro;
+}
+
+/**
+ * @brief  Função que obtem a latencia de escrita por bloco desde a ultima leitura e reinicia a contagem
+ * @param  media: recebe a latencia media (us)
+ * @param  maxima: recebe a maior latencia (us)
+ * @return quantidade de blocos escritos no periodo
+ */
+Tuint32 snifferCanCartao_obtemLatencia(Tuint32 *media, Tuint32 *maxima){
+  Tuint32 blocos = blocosEscritos;
+
+  *media = ((blocos > 0) ? (Tuint32)(somaLatenciaEscrita / blocos) : 0);
+  *maxima = latenciaMaximaEscrita;
+
+  somaLatenciaEscrita = 0;
+  blocosEscritos = 0;
+  latenciaMaximaEscrita = 0;
+
+  return blocos;
+}
+
+
+
+
@@ -1,28 +1,33 @@
-/**
- * @file    snifferCan_cartao.h
- * @brief   Esse arquivo contem o prototipo das funções relativas ao envio de dados ao servidor
- * @author  Emanoel Gomes Santos
- * @date    Data de Criação: 31/03/2020
-**/
-#ifndef SNIFFER_CAN_CARTAO_H_INCLUDED
-#define SNIFFER_CAN_CARTAO_H_INCLUDED
-
-/// Inclusões importantes
-#include <stdio.h>
-#include <stdlib.h>
-#include <HTTPClient.h>
-#include <SD.h>
-
-// Submódulos do sistema
-#include "tipos.h"
-#include "erros.h"
-#include <string.h>
-#include "fila_mensagem.h"
-#include "gerenciamento_cartao.h"
-
-// Funções exportadass
-Terro snifferCanCartao_inicializa(void);
-Terro snifferCanCartao_envia(char *texto, char *nomeArquivo);
-Terro snifferCanCartao_formataQuadroCANToString(char *texto, PTmensagemCAN mensagem, 
-                                               Tuint16 quantidade, Tbool formatado);
-#endif // SNIFFER_CAN_CARTAO_H_INCLUDED
+/**
+ * @file    snifferCan_cartao.h
+ * @brief   Esse arquivo contem o prototipo das funções relativas ao envio de dados ao servidor
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 31/03/2020
+**/
+#ifndef SNIFFER_CAN_CARTAO_H_INCLUDED
+#define SNIFFER_CAN_CARTAO_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <HTTPClient.h>
+#include <SD.h>
+
+// Submódulos do sistema
+#include "tipos.h"
+#include "erros.h"
+#include <string.h>
+#include "fila_mensagem.h"
+#include "gerenciamento_cartao.h"
+#include "escritor_cartao.h"
+#include "saude_barramento.h"
+
+// Funções exportadass
+Terro snifferCanCartao_inicializa(void);
+Terro snifferCanCartao_envia(PTescritorCartao escritor, const char *texto, Tuint32 tamanho, char *nomeArquivo);
+Tuint32 snifferCanCartao_obtemLatencia(Tuint32 *media, Tuint32 *maxima);
+Tuint16 snifferCanCartao_formataMarcadorPerda(char *texto, Tuint32 quadrosPerdidos, Tbool formatado);
+Tuint16 snifferCanCartao_formataMarcadorInicio(char *texto, Tuint64 relogio, Tbool formatado);
+Tuint16 snifferCanCartao_formataMarcadorSuprimidos(char *texto, Tuint32 quadrosSuprimidos, Tbool formatado);
+Tuint16 snifferCanCartao_formataMarcadorSaude(char *texto, PTamostraSaude saude, Tbool formatado);
+#endif // SNIFFER_CAN_CARTAO_H_INCLUDED
@@ -1,151 +1,643 @@
-/**
- * @file    snifferCan_registro.cpp
- * @brief   Esse arquivo contem as funções relativas ao envio do registro para 
- *          os "armazenadores", sendo: servidor ou cartão de memória
- * @author  Emanoel Gomes Santos
- * @date    Data de Criação: 08/04/2020
-**/
-
-/// Inclusões de bibliotecas importantes
-#include "snifferCAN_registro.h"
-
-// Definições importantes
-#define PRIMEIRA_INTERACAO       (i==0)
-
-// Variavel global 
-char *textoEnvia; 
-
-/**
- * @brief  Função que obtem o ponteiro para o tipo char * do texto 
- * @param  void
- * @return ponteiro para textoEnvia
- */
-char *snifferCanRegistro_obtemPonteiroTexto(void){
-  return textoEnvia;
-}
-
-/**
- * @brief  Função que formata os dados e os envia ao servidor
- * @param  mensagem: Ponteiro para o array com as mensagens CANs
- * @param  quantidade: quantidade de mensagens can presentes no array
- * @return ERRO ou SUCESSO
- */
-Terro snifferCanRegistro_enviaDadosServidor(PTmensagemCAN mensagem, Tuint16 quantidade, 
-                                            TwifiConfig wifi, char *url){
-  Terro erro = SUCESSO;
-  char *texto = snifferCanRegistro_obtemPonteiroTexto();
-  Tuint16 tamanhoTexto;
-
-  /*
-  1 - aloca quantidade de bytes da estrutura TmensagemCAN -> sizeof(TmensagemCAN)
-  2 -  Como cada neeble irá gerar um byte de texto, entao deverá ser multiplicado por 2 -> (sizeof(TmensagemCAN) * 2)
-  3 - O contexto acima será pra uma mensagem can, mas estamos trabalhando com array de mensagens. por esse motivo,
-      será mutiplicado pela quantidade -> (sizeof(TmensagemCAN) * 2) * quantidade)
-  4 - Haverá um separador para cada mensagen, que sera o caracter ";", por esse motivo somado a quantidade de mensagens
-      sendo -> (sizeof(TmensagemCAN) * 2) * quantidade) + quantidade
-  5 - Deverá ser considerado o terminador do tipo texto "\0", que consome 1 byte. Por esse motivo a soma final 
-      sendo -> ((sizeof(char) * (sizeof(TmensagemCAN) * 2) * quantidade) + quantidade + 1)
-  */
-  tamanhoTexto = (
-    (sizeof(char) * (sizeof(TmensagemCAN) * 2) * quantidade) + 
-    ( QUANTIDADE_SEPARADORES_TEXTO * quantidade) + 
-    1
-  );
-
-  // Aloca espaço para texto  
-  texto = (char*)malloc(tamanhoTexto);
-  if(texto == NULL){
-    return ERRO_ALOCACAO_MEMORIA;
-  }
-  
-  // Formata o texto   
-  erro = snifferCanServidor_formataQuadroCANToString(
-    texto,
-    mensagem,
-    quantidade,
-    FALSO // sempre falso, quem formata é o software do servidor
-  );
-  if(erro != SUCESSO){
-    free(texto);
-    return erro;
-  }  
-
-  // Envia dados formatados
-  erro = snifferCanServidor_envia(texto, wifi, url);
-  if(erro != SUCESSO){
-    free(texto);
-    return erro;
-  }
-
-  free(texto);
-
-  return erro;
-}
-
-/**
- * @brief  Função que formata os dados e os envia ao cartão de memória
- * @param  mensagem: Ponteiro para o array com as mensagens CANs
- * @param  quantidade: quantidade de mensagens can presentes no array
- * @param  formatado: Flag que define se o log deverá ou nao ser formatado
- * @return ERRO ou SUCESSO
- */
-Terro snifferCanRegistro_enviaDadosCartao(PTmensagemCAN mensagem, Tuint16 quantidade, 
-                                          char *nomeArquivo, Tbool logFormatado, Tbool monitorSerial){
-  Terro erro = SUCESSO;
-  char *texto = snifferCanRegistro_obtemPonteiroTexto();
-  Tuint16 tamanhoTexto;    
-  /*
-  1 - aloca quantidade de bytes da estrutura TmensagemCAN -> sizeof(TmensagemCAN)
-  2 -  Como cada neeble irá gerar um byte de texto, entao deverá ser multiplicado por 2 -> (sizeof(TmensagemCAN) * 2)
-  3 - O contexto acima será pra uma mensagem can, mas estamos trabalhando com array de mensagens. por esse motivo,
-      será mutiplicado pela quantidade -> (sizeof(TmensagemCAN) * 2) * quantidade)
-  4 - Haverá espaços para o texto formatado que esta definido em QUANTIDADE_ESPAÇO_TEXTO_FORMATADO
-      sendo -> (sizeof(TmensagemCAN) * 2) * quantidade) + quantidade
-  5 - Deverá ser considerado o terminador do tipo texto "\0", que consome 1 byte. Por esse motivo a soma final 
-      sendo -> ((sizeof(char) * (sizeof(TmensagemCAN) * 2) * quantidade) + quantidade + 1)
-  */
-  tamanhoTexto = (
-    (sizeof(char) * (sizeof(TmensagemCAN) * 2) * quantidade) + 
-    (((logFormatado) ? QUANTIDADE_ESPACO_TEXTO_FORMATADO : QUANTIDADE_SEPARADORES_TEXTO) * quantidade) + 
-    1
-  );
- 
-  // Aloca espaço na memória para o texto
-  texto = (char*)malloc(tamanhoTexto);
-  if(texto == NULL){
-    PRINTLN("texto = (char*)malloc(tamanhoTexto);");
-    return ERRO_ALOCACAO_MEMORIA;
-  }  
-  
-  // Formata o texto
-  erro = snifferCanCartao_formataQuadroCANToString(
-    texto,
-    mensagem, 
-    quantidade, 
-    logFormatado
-  );
-  if(erro != SUCESSO){
-    free(texto);
-    return erro;
-  }
-     
-
-  // Envia dados formatados ao cartão
-  erro = snifferCanCartao_envia(texto,nomeArquivo);
-  if(erro != SUCESSO){
-    free(texto);
-    return erro;
-  }
-
-
-  // Imprime log na tela do monitor serial
-  if(monitorSerial){
-    PRINT(texto);
-  }
-
-  // Se houve sucesso entao desalocar texto.
-  free(texto);
-  
-  // Se chegou até aqui então houve sucesso
-  return SUCESSO;
-}
\ No newline at end of file
+/**
+ * @file    snifferCan_registro.cpp
+ * @brief   Esse arquivo contem as funções relativas ao envio do registro para 
+ *          os "armazenadores", sendo: servidor ou cartão de memória
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 08/04/2020
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "snifferCAN_registro.h"
+
+// Definições importantes
+#define PRIMEIRA_INTERACAO       (i==0)
+
+// Variavel global 
+char *textoEnvia; 
+// Instante da ultima mensagem entregue a cada armazenador (decimos de ms), base dos intervalos
+static Tuint64 tempoAnteriorServidor = 0;
+// Instante da ultima mensagem colunar entregue ao servidor (esp_timer, us)
+static Tuint64 tempoAnteriorColunarServidor = 0;
+static Tuint64 tempoAnteriorCartao = 0;
+// Instante da ultima mensagem do registro binario (esp_timer, us)
+static Tuint64 tempoAnteriorBinario = 0;
+// Hora da primeira mensagem do MF4 aberto (us desde 1970), base do Timestamp
+static Tuint64 relogioInicioMdf = 0;
+// Arquivo que recebeu o ultimo bloco, ao mudar escreve-se o marcador de inicio
+static char ultimoArquivoCartao[TAMANHO_MAXIMO_NOME_ARQUIVO] = {'\0'};
+// Bytes entregues ao escritor do cartao, a diferença antes e depois de um bloco é o tamanho dele no registro
+static Tuint32 bytesEnviadosCartao = 0;
+
+/**
+ * @brief  Função que obtem o ponteiro para o tipo char * do texto 
+ * @param  void
+ * @return ponteiro para textoEnvia
+ */
+char *snifferCanRegistro_obtemPonteiroTexto(void){
+  return textoEnvia;
+}
+
+/**
+ * @brief  Função que codifica o bloco em colunas comprimidas no buffer do enviador. O primeiro
+ *         bloco de cada buffer recebe o cabeçalho do formato binario, assim o corpo de cada
+ *         requisição é um registro completo que o decodificador abre sem depender das anteriores
+ * @param  enviador: enviador do servidor
+ * @param  arena: arena do consumidor, fornece a memoria de trabalho do codificador
+ * @param  bloco: Ponteiro para o bloco com as mensagens CANs
+ * @return ERRO ou SUCESSO
+ */
+static Terro snifferCanRegistro_enviaColunarServidor(PTenviadorServidor enviador, PTarenaBloco arena, PTblocoMensagens bloco){
+  Terro erro = SUCESSO;
+  Tuint8 *dados;
+  Tuint32 tamanho = 0;
+  Tuint32 tamanhoBloco;
+  Tuint64 tempoAnterior;
+  Tbool inicio;
+
+  if(bloco->quantidade == 0){
+    return SUCESSO;
+  }
+
+  dados = enviadorServidor_reserva(enviador, (TAMANHO_CABECALHO_BINARIO + TAMANHO_MAXIMO_BLOCO_COLUNAR(bloco->quantidade)), &inicio);
+  if(dados == NULL){
+    return SUCESSO;
+  }
+
+  // Os blocos seguintes do mesmo buffer continuam os intervalos do anterior
+  tempoAnterior = tempoAnteriorColunarServidor;
+  if(inicio){
+    tempoAnterior = TEMPO_ABSOLUTO_QUADRO(bloco->mensagem[0], bloco->tempoReferencia);
+    tamanho = registroBinario_formataCabecalho(
+      dados,
+      (bloco->relogioReferencia - (bloco->tempoReferencia - tempoAnterior)),
+      tempoAnterior
+    );
+  }
+  erro = registroColunar_formataBloco(&dados[tamanho], &tamanhoBloco, bloco, &tempoAnterior, arena);
+  if(erro != SUCESSO){
+    return erro;
+  }
+  tamanho += tamanhoBloco;
+
+  enviadorServidor_confirma(enviador, tamanho, bloco->tempoReferencia);
+  tempoAnteriorColunarServidor = tempoAnterior;
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que formata o bloco e o entrega ao enviador do servidor. A requisição é feita pela
+ *         tarefa de envio, sem buffer livre o bloco fica somente no cartao
+ * @param  enviador: enviador do servidor
+ * @param  arena: arena do consumidor, fornece a memoria de trabalho do formato colunar
+ * @param  bloco: Ponteiro para o bloco com as mensagens CANs
+ * @param  formato: formato do envio (texto ou colunar)
+ * @return ERRO ou SUCESSO
+ */
+Terro snifferCanRegistro_enviaDadosServidor(PTenviadorServidor enviador, PTarenaBloco arena, PTblocoMensagens bloco, 
+                                            TformatoRegistro formato){
+  Terro erro = SUCESSO;
+  char *texto = snifferCanRegistro_obtemPonteiroTexto();
+  Tuint32 tamanhoTexto;
+  Tuint32 tamanhoFormatado;
+  Tuint64 tempoAnterior;
+  Tbool inicio;
+
+  if(!enviadorServidor_ativo(enviador)){
+    return SUCESSO;
+  }
+
+  if(formato == eFormatoColunar){
+    erro = snifferCanRegistro_enviaColunarServidor(enviador, arena, bloco);
+  }else{
+    /*
+    Cada mensagem gera no maximo uma linha de TAMANHO_MAXIMO_LINHA_SIMPLES caracteres (o servidor 
+    sempre recebe o texto sem formatação), mais o terminador "\0"
+    */
+    tamanhoTexto = ((sizeof(char) * TAMANHO_MAXIMO_LINHA_SIMPLES * bloco->quantidade) + 1);
+
+    // Formata o texto direto no buffer do enviador
+    texto = (char *)enviadorServidor_reserva(enviador, tamanhoTexto, &inicio);
+    if(texto == NULL){
+      return SUCESSO;
+    }
+    tempoAnterior = tempoAnteriorServidor;
+    tamanhoFormatado = formatadorQuadro_formataTexto(
+      texto,
+      bloco->mensagem,
+      bloco->quantidade,
+      FALSO, // sempre falso, quem formata é o software do servidor
+      bloco->tempoReferencia,
+      &tempoAnterior
+    );
+    enviadorServidor_confirma(enviador, tamanhoFormatado, bloco->tempoReferencia);
+    tempoAnteriorServidor = tempoAnterior;
+  }
+
+  // Com a tarefa de envio livre o buffer sai agora, do contrario junta os proximos blocos
+  enviadorServidor_verificaEntrega(enviador);
+
+  return erro;
+}
+
+/**
+ * @brief  Função que entrega dados do registro ao cartão de memória e conta os bytes entregues
+ * @param  escritor: escritor do cartao
+ * @param  dados: dados do registro
+ * @param  tamanho: quantidade de bytes
+ * @param  nomeArquivo: arquivo de registro que recebera os dados
+ * @return ERRO ou SUCESSO
+ */
+static Terro snifferCanRegistro_enviaCartao(PTescritorCartao escritor, const char *dados, Tuint32 tamanho, char *nomeArquivo){
+  Terro erro = snifferCanCartao_envia(escritor, dados, tamanho, nomeArquivo);
+
+  if(erro == SUCESSO){
+    bytesEnviadosCartao += tamanho;
+  }
+  return erro;
+}
+
+/**
+ * @brief  Função que codifica o bloco no formato binario e o envia ao cartão de memória. O primeiro
+ *         bloco do arquivo é precedido pelo cabeçalho, os marcadores seguem a ordem do texto
+ * @param  escritor: escritor do cartao que recebera o bloco codificado
+ * @param  arena: arena do consumidor, fornece o buffer do bloco
+ * @param  bloco: Ponteiro para o bloco com as mensagens CANs e a quantidade perdida antes dele
+ * @param  nomeArquivo: arquivo de registro que recebera o bloco
+ * @param  colunar: Flag que define se o bloco sera codificado em colunas comprimidas
+ * @param  monitorSerial: Flag que define se o resumo do bloco sera impresso no monitor serial
+ * @return ERRO ou SUCESSO
+ */
+static Terro snifferCanRegistro_enviaBinarioCartao(PTescritorCartao escritor, PTarenaBloco arena, PTblocoMensagens bloco, 
+                                                  char *nomeArquivo, Tbool colunar, Tbool monitorSerial){
+  Terro erro = SUCESSO;
+  Tuint32 marca = arenaBloco_marca(arena);
+  Tuint8 *dados;
+  Tuint32 tamanhoDados;
+  Tuint32 tamanho = 0;
+  Tuint32 tamanhoBloco;
+  Tuint32 inicioBloco;
+  Tuint64 tempoAnterior;
+  Tuint64 relogioPrimeira;
+  Tbool novoArquivo = (strcmp(ultimoArquivoCartao, nomeArquivo) != 0);
+
+  // Reserva o pior caso: cabeçalho, inicio do bloco, marcadores, quadros com 8 bytes e CRC
+  if(colunar){
+    tamanhoBloco = TAMANHO_MAXIMO_BLOCO_COLUNAR(bloco->quantidade);
+  }else{
+    tamanhoBloco = (
+      TAMANHO_INICIO_BLOCO_BINARIO +
+      TAMANHO_MAXIMO_MARCADORES_BINARIO +
+      (TAMANHO_MAXIMO_QUADRO_BINARIO * bloco->quantidade) +
+      TAMANHO_CRC_BINARIO
+    );
+  }
+  tamanhoDados = (((novoArquivo) ? TAMANHO_CABECALHO_BINARIO : 0) + tamanhoBloco);
+
+  dados = (Tuint8*)arenaBloco_reserva(arena, tamanhoDados);
+  if(dados == NULL){
+    PRINTLN("ARENA DO BLOCO SEM ESPACO");
+    return ERRO_ALOCACAO_MEMORIA;
+  }
+
+  // Primeiro bloco do arquivo: o cabeçalho guarda a hora e o instante da primeira mensagem,
+  // o intervalo do primeiro quadro conta a partir dele
+  tempoAnterior = tempoAnteriorBinario;
+  if(novoArquivo && (bloco->quantidade > 0)){
+    tempoAnterior = TEMPO_ABSOLUTO_QUADRO(bloco->mensagem[0], bloco->tempoReferencia);
+    relogioPrimeira = (bloco->relogioReferencia - (bloco->tempoReferencia - tempoAnterior));
+    tamanho += registroBinario_formataCabecalho(&dados[tamanho], relogioPrimeira, tempoAnterior);
+  }
+
+  inicioBloco = tamanho;
+  if(colunar){
+    erro = registroColunar_formataBloco(&dados[inicioBloco], &tamanhoBloco, bloco, &tempoAnterior, arena);
+    if(erro != SUCESSO){
+      arenaBloco_libera(arena, marca);
+      return erro;
+    }
+    tamanho += tamanhoBloco;
+  }else{
+    tamanho += registroBinario_iniciaBloco(&dados[tamanho]);
+
+    if(bloco->quadrosPerdidos > 0){
+      tamanho += registroBinario_formataMarcador(&dados[tamanho], REGISTRO_BINARIO_PERDIDOS, bloco->quadrosPerdidos);
+    }
+    if(bloco->eventoSaude){
+      tamanho += registroBinario_formataSaude(&dados[tamanho], &bloco->saude);
+    }
+    if(bloco->quadrosSuprimidos > 0){
+      tamanho += registroBinario_formataMarcador(&dados[tamanho], REGISTRO_BINARIO_SUPRIMIDOS, bloco->quadrosSuprimidos);
+    }
+
+    tamanho += registroBinario_formataQuadros(
+      &dados[tamanho],
+      bloco->mensagem,
+      bloco->quantidade,
+      bloco->tempoReferencia,
+      &tempoAnterior
+    );
+    tamanho = (inicioBloco + registroBinario_finalizaBloco(&dados[inicioBloco], (tamanho - inicioBloco)));
+  }
+
+  // Envia o bloco ao cartão
+  erro = snifferCanRegistro_enviaCartao(escritor,(const char *)dados,tamanho,nomeArquivo);
+  if(erro != SUCESSO){
+    arenaBloco_libera(arena, marca);
+    return erro;
+  }
+  tempoAnteriorBinario = tempoAnterior;
+  (void)strncpy(ultimoArquivoCartao, nomeArquivo, (TAMANHO_MAXIMO_NOME_ARQUIVO - 1));
+
+  // O bloco binario nao é legivel no monitor serial, imprime somente o resumo
+  if(monitorSerial){
+    PRINTF("BLOCO BINARIO: %u quadros, %u bytes\r\n", bloco->quantidade, tamanho);
+  }
+
+  arenaBloco_libera(arena, marca);
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que codifica o bloco como pacotes pcap (LINKTYPE_CAN_SOCKETCAN) e o envia ao
+ *         cartão de memória. O primeiro bloco do arquivo é precedido pelo cabeçalho pcap. Os
+ *         marcadores do bloco nao tem registro no pcap e sao descartados
+ * @param  escritor: escritor do cartao que recebera o bloco codificado
+ * @param  arena: arena do consumidor, fornece o buffer do bloco
+ * @param  bloco: Ponteiro para o bloco com as mensagens CANs
+ * @param  nomeArquivo: arquivo de registro que recebera o bloco
+ * @param  monitorSerial: Flag que define se o resumo do bloco sera impresso no monitor serial
+ * @return ERRO ou SUCESSO
+ */
+static Terro snifferCanRegistro_enviaPcapCartao(PTescritorCartao escritor, PTarenaBloco arena, PTblocoMensagens bloco, 
+                                               char *nomeArquivo, Tbool monitorSerial){
+  Terro erro = SUCESSO;
+  Tuint32 marca = arenaBloco_marca(arena);
+  Tuint8 *dados;
+  Tuint32 tamanhoDados;
+  Tuint32 tamanho = 0;
+  Tbool novoArquivo = (strcmp(ultimoArquivoCartao, nomeArquivo) != 0);
+
+  // Tamanho fixo por quadro, mais o cabeçalho no primeiro bloco do arquivo
+  tamanhoDados = (((novoArquivo) ? TAMANHO_CABECALHO_PCAP : 0) + (TAMANHO_REGISTRO_PCAP * bloco->quantidade));
+
+  dados = (Tuint8*)arenaBloco_reserva(arena, tamanhoDados);
+  if(dados == NULL){
+    PRINTLN("ARENA DO BLOCO SEM ESPACO");
+    return ERRO_ALOCACAO_MEMORIA;
+  }
+
+  if(novoArquivo){
+    tamanho += registroPcap_formataCabecalho(&dados[tamanho]);
+  }
+  tamanho += registroPcap_formataQuadros(
+    &dados[tamanho],
+    bloco->mensagem,
+    bloco->quantidade,
+    bloco->tempoReferencia,
+    bloco->relogioReferencia
+  );
+
+  // Envia o bloco ao cartão
+  erro = snifferCanRegistro_enviaCartao(escritor,(const char *)dados,tamanho,nomeArquivo);
+  if(erro != SUCESSO){
+    arenaBloco_libera(arena, marca);
+    return erro;
+  }
+  (void)strncpy(ultimoArquivoCartao, nomeArquivo, (TAMANHO_MAXIMO_NOME_ARQUIVO - 1));
+
+  if(monitorSerial){
+    PRINTF("BLOCO PCAP: %u quadros, %u bytes\r\n", bloco->quantidade, tamanho);
+  }
+
+  arenaBloco_libera(arena, marca);
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que codifica o bloco como registros CAN_DataFrame do MF4 e o envia ao cartão de
+ *         memória. O primeiro bloco do arquivo é precedido pelos blocos de descrição. O tamanho
+ *         do DT e a finalização ficam com o gerenciamento do cartao
+ * @param  escritor: escritor do cartao que recebera o bloco codificado
+ * @param  arena: arena do consumidor, fornece o buffer do bloco
+ * @param  bloco: Ponteiro para o bloco com as mensagens CANs
+ * @param  nomeArquivo: arquivo de registro que recebera o bloco
+ * @param  monitorSerial: Flag que define se o resumo do bloco sera impresso no monitor serial
+ * @return ERRO ou SUCESSO
+ */
+static Terro snifferCanRegistro_enviaMdfCartao(PTescritorCartao escritor, PTarenaBloco arena, PTblocoMensagens bloco, 
+                                              char *nomeArquivo, Tbool monitorSerial){
+  Terro erro = SUCESSO;
+  Tuint32 marca = arenaBloco_marca(arena);
+  Tuint8 *dados;
+  Tuint32 tamanhoDados;
+  Tuint32 tamanho = 0;
+  Tuint64 relogioInicio = relogioInicioMdf;
+  Tbool novoArquivo = (strcmp(ultimoArquivoCartao, nomeArquivo) != 0);
+
+  if(novoArquivo && (bloco->quantidade == 0)){
+    return SUCESSO;
+  }
+
+  tamanhoDados = (((novoArquivo) ? TAMANHO_CABECALHO_MDF : 0) + (TAMANHO_REGISTRO_MDF * bloco->quantidade));
+
+  dados = (Tuint8*)arenaBloco_reserva(arena, tamanhoDados);
+  if(dados == NULL){
+    PRINTLN("ARENA DO BLOCO SEM ESPACO");
+    return ERRO_ALOCACAO_MEMORIA;
+  }
+
+  // Primeiro bloco do arquivo: o HD guarda a hora da primeira mensagem, base do Timestamp
+  if(novoArquivo){
+    relogioInicio = (
+      bloco->relogioReferencia - 
+      (bloco->tempoReferencia - TEMPO_ABSOLUTO_QUADRO(bloco->mensagem[0], bloco->tempoReferencia))
+    );
+    tamanho += registroMdf_formataCabecalho(&dados[tamanho], relogioInicio);
+  }
+  tamanho += registroMdf_formataQuadros(
+    &dados[tamanho],
+    bloco->mensagem,
+    bloco->quantidade,
+    bloco->tempoReferencia,
+    bloco->relogioReferencia,
+    relogioInicio
+  );
+
+  // Envia o bloco ao cartão
+  if(tamanho > 0){
+    erro = snifferCanRegistro_enviaCartao(escritor,(const char *)dados,tamanho,nomeArquivo);
+    if(erro != SUCESSO){
+      arenaBloco_libera(arena, marca);
+      return erro;
+    }
+  }
+  relogioInicioMdf = relogioInicio;
+  (void)strncpy(ultimoArquivoCartao, nomeArquivo, (TAMANHO_MAXIMO_NOME_ARQUIVO - 1));
+
+  if(monitorSerial){
+    PRINTF("BLOCO MF4: %u quadros, %u bytes\r\n", bloco->quantidade, tamanho);
+  }
+
+  arenaBloco_libera(arena, marca);
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que formata os dados e os envia ao cartão de memória.
+ *         Se houve perda de mensagens na fila antes do bloco, um marcador é escrito antes dele,
+ *         assim como o resumo dos quadros suprimidos pelo registro de mudanças e os eventos de 
+ *         saude do barramento
+ * @param  escritor: escritor do cartao que recebera o texto formatado
+ * @param  arena: arena do consumidor, fornece o buffer do bloco
+ * @param  bloco: Ponteiro para o bloco com as mensagens CANs e a quantidade perdida antes dele
+ * @param  nomeArquivo: arquivo de registro que recebera o bloco
+ * @param  formato: formato do arquivo de registro (texto, binario, colunar, pcap ou mf4)
+ * @param  logFormatado: Flag que define se o log deverá ou nao ser formatado
+ * @param  monitorSerial: Flag que define se o log sera impresso no monitor serial
+ * @return ERRO ou SUCESSO
+ */
+static Terro snifferCanRegistro_formataDadosCartao(PTescritorCartao escritor, PTarenaBloco arena, PTblocoMensagens bloco, 
+                                                  char *nomeArquivo, TformatoRegistro formato, Tbool logFormatado, 
+                                                  Tbool monitorSerial){
+  Terro erro = SUCESSO;
+  Tuint32 marca = arenaBloco_marca(arena);
+  char *texto = snifferCanRegistro_obtemPonteiroTexto();
+  Tuint32 tamanhoTexto;
+  Tuint32 tamanhoMarcador = 0;
+  Tuint32 tamanhoFormatado;
+  Tuint64 tempoAnterior;
+  Tuint64 relogioPrimeira;
+  Tbool novoArquivo = (strcmp(ultimoArquivoCartao, nomeArquivo) != 0);
+
+  if(formato == eFormatoPcap){
+    return snifferCanRegistro_enviaPcapCartao(escritor, arena, bloco, nomeArquivo, monitorSerial);
+  }
+  if(formato == eFormatoMdf){
+    return snifferCanRegistro_enviaMdfCartao(escritor, arena, bloco, nomeArquivo, monitorSerial);
+  }
+  if(formato != eFormatoTexto){
+    return snifferCanRegistro_enviaBinarioCartao(escritor, arena, bloco, nomeArquivo, (formato == eFormatoColunar), monitorSerial);
+  }
+
+  /*
+  1 - Cada mensagem gera no maximo uma linha de TAMANHO_MAXIMO_LINHA_TEXTO(logFormatado) caracteres
+  2 - Se houve perda antes do bloco, reserva tambem o marcador -> TAMANHO_MAXIMO_MARCADOR_TEXTO
+  3 - Se é o primeiro bloco do arquivo, reserva o marcador de inicio -> TAMANHO_MAXIMO_MARCADOR_INICIO
+  4 - Se houve quadros suprimidos, reserva o resumo -> TAMANHO_MAXIMO_MARCADOR_SUPRIMIDOS
+  5 - Se houve evento de saude do barramento, reserva o marcador -> TAMANHO_MAXIMO_MARCADOR_SAUDE
+  6 - Deverá ser considerado o terminador do tipo texto "\0", que consome 1 byte
+  */
+  tamanhoTexto = (
+    (sizeof(char) * TAMANHO_MAXIMO_LINHA_TEXTO(logFormatado) * bloco->quantidade) + 
+    ((bloco->quadrosPerdidos > 0) ? TAMANHO_MAXIMO_MARCADOR_TEXTO : 0) +
+    ((novoArquivo) ? TAMANHO_MAXIMO_MARCADOR_INICIO : 0) +
+    ((bloco->quadrosSuprimidos > 0) ? TAMANHO_MAXIMO_MARCADOR_SUPRIMIDOS : 0) +
+    ((bloco->eventoSaude) ? TAMANHO_MAXIMO_MARCADOR_SAUDE : 0) +
+    1
+  );
+ 
+  // Toma da arena o espaço para o texto
+  texto = (char*)arenaBloco_reserva(arena, tamanhoTexto);
+  if(texto == NULL){
+    PRINTLN("ARENA DO BLOCO SEM ESPACO");
+    return ERRO_ALOCACAO_MEMORIA;
+  }  
+
+  // Primeiro bloco do arquivo: escreve a hora da primeira mensagem, a partir dela os intervalos
+  // permitem obter a hora de todas as mensagens do arquivo
+  tempoAnterior = tempoAnteriorCartao;
+  if(novoArquivo && (bloco->quantidade > 0)){
+    relogioPrimeira = (
+      bloco->relogioReferencia - 
+      (bloco->tempoReferencia - TEMPO_ABSOLUTO_QUADRO(bloco->mensagem[0], bloco->tempoReferencia))
+    );
+    tamanhoMarcador += snifferCanCartao_formataMarcadorInicio(&texto[tamanhoMarcador], relogioPrimeira, logFormatado);
+    tempoAnterior = 0;
+  }
+
+  // Marca no registro a lacuna deixada pela fila
+  if(bloco->quadrosPerdidos > 0){
+    tamanhoMarcador += snifferCanCartao_formataMarcadorPerda(&texto[tamanhoMarcador], bloco->quadrosPerdidos, logFormatado);
+  }
+
+  // Contadores do MCP2515 no momento do evento de saude
+  if(bloco->eventoSaude){
+    tamanhoMarcador += snifferCanCartao_formataMarcadorSaude(&texto[tamanhoMarcador], &bloco->saude, logFormatado);
+  }
+
+  // Resumo dos quadros repetidos que nao foram registrados
+  if(bloco->quadrosSuprimidos > 0){
+    tamanhoMarcador += snifferCanCartao_formataMarcadorSuprimidos(&texto[tamanhoMarcador], bloco->quadrosSuprimidos, logFormatado);
+  }
+  
+  // Formata o texto logo apos os marcadores
+  tamanhoFormatado = formatadorQuadro_formataTexto(
+    &texto[tamanhoMarcador],
+    bloco->mensagem, 
+    bloco->quantidade, 
+    logFormatado,
+    bloco->tempoReferencia,
+    &tempoAnterior
+  );
+
+  // Envia dados formatados ao cartão
+  erro = snifferCanRegistro_enviaCartao(escritor,texto,(tamanhoMarcador + tamanhoFormatado),nomeArquivo);
+  if(erro != SUCESSO){
+    arenaBloco_libera(arena, marca);
+    return erro;
+  }
+  tempoAnteriorCartao = tempoAnterior;
+  (void)strncpy(ultimoArquivoCartao, nomeArquivo, (TAMANHO_MAXIMO_NOME_ARQUIVO - 1));
+
+
+  // Imprime log na tela do monitor serial
+  if(monitorSerial){
+    PRINT(texto);
+  }
+
+  // Se houve sucesso entao devolve o texto à arena
+  arenaBloco_libera(arena, marca);
+  
+  // Se chegou até aqui então houve sucesso
+  return SUCESSO;
+}
+/**
+ * @brief  Função que obtem os bytes do cabeçalho do formato no inicio de cada arquivo de registro,
+ *         repetidos antes dos trechos extraidos pelo indice. No texto o marcador de inicio faz parte
+ *         do primeiro bloco e o cabeçalho do MF4 descreve o arquivo inteiro, nos dois nao ha prefixo
+ * @param  formato: formato do arquivo de registro
+ * @return quantidade de bytes
+ */
+static Tuint32 snifferCanRegistro_tamanhoCabecalho(TformatoRegistro formato){
+  switch(formato){
+    case eFormatoBinario:
+    case eFormatoColunar:
+      return TAMANHO_CABECALHO_BINARIO;
+    case eFormatoPcap:
+      return TAMANHO_CABECALHO_PCAP;
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @brief  Função que formata os dados, os envia ao cartão de memória e atualiza o indice do 
+ *         arquivo de registro. Na troca de arquivo o indice do anterior é finalizado antes do
+ *         primeiro bloco do novo
+ * @param  escritor: escritor do cartao que recebera o bloco e o indice
+ * @param  indice: indice do arquivo de registro
+ * @param  arena: arena do consumidor, fornece os buffers do bloco
+ * @param  bloco: Ponteiro para o bloco com as mensagens CANs e a quantidade perdida antes dele
+ * @param  nomeArquivo: arquivo de registro que recebera o bloco
+ * @param  formato: formato do arquivo de registro (texto, binario, colunar, pcap ou mf4)
+ * @param  logFormatado: Flag que define se o log deverá ou nao ser formatado
+ * @param  monitorSerial: Flag que define se o log sera impresso no monitor serial
+ * @return ERRO ou SUCESSO
+ */
+Terro snifferCanRegistro_enviaDadosCartao(PTescritorCartao escritor, PTindiceRegistro indice, PTarenaBloco arena, 
+                                          PTblocoMensagens bloco, char *nomeArquivo, TformatoRegistro formato, 
+                                          Tbool logFormatado, Tbool monitorSerial){
+  Terro erro = SUCESSO;
+  Tuint32 enviados = bytesEnviadosCartao;
+
+  if(strcmp(ultimoArquivoCartao, nomeArquivo) != 0){
+    indiceRegistro_finaliza(indice, escritor);
+  }
+
+  erro = snifferCanRegistro_formataDadosCartao(escritor, arena, bloco, nomeArquivo, formato, logFormatado, monitorSerial);
+  if(erro != SUCESSO){
+    return erro;
+  }
+
+  // O bloco ja esta no escritor: um erro no indice nao repete o envio
+  if(strcmp(ultimoArquivoCartao, nomeArquivo) == 0){
+    indiceRegistro_registraBloco(
+      indice,
+      escritor,
+      bloco,
+      nomeArquivo,
+      snifferCanRegistro_tamanhoCabecalho(formato),
+      (bytesEnviadosCartao - enviados)
+    );
+  }
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que obtem o maior buffer de um bloco em um formato
+ * @param  quantidade: maior quantidade de mensagens de um bloco
+ * @param  formato: formato do bloco
+ * @return quantidade de bytes
+ */
+static Tuint32 snifferCanRegistro_tamanhoFormato(Tuint32 quantidade, TformatoRegistro formato){
+  switch(formato){
+    case eFormatoBinario:
+      // Binario com o cabeçalho do arquivo
+      return (
+        TAMANHO_CABECALHO_BINARIO + TAMANHO_INICIO_BLOCO_BINARIO + TAMANHO_MAXIMO_MARCADORES_BINARIO +
+        (TAMANHO_MAXIMO_QUADRO_BINARIO * quantidade) + TAMANHO_CRC_BINARIO
+      );
+    case eFormatoColunar:
+      // Colunar: o bloco codificado e, ao mesmo tempo, a memoria de trabalho do codificador
+      return (
+        TAMANHO_CABECALHO_BINARIO + TAMANHO_MAXIMO_BLOCO_COLUNAR(quantidade) + 
+        ALINHAMENTO_ARENA_BLOCO + TAMANHO_TRABALHO_COLUNAR(quantidade)
+      );
+    case eFormatoPcap:
+      return (TAMANHO_CABECALHO_PCAP + (TAMANHO_REGISTRO_PCAP * quantidade));
+    case eFormatoMdf:
+      return (TAMANHO_CABECALHO_MDF + (TAMANHO_REGISTRO_MDF * quantidade));
+    default:
+      // Texto formatado com todos os marcadores e o terminador
+      return (
+        (TAMANHO_MAXIMO_LINHA_FORMATADA * quantidade) + TAMANHO_MAXIMO_MARCADOR_TEXTO + 
+        TAMANHO_MAXIMO_MARCADOR_INICIO + TAMANHO_MAXIMO_MARCADOR_SUPRIMIDOS + TAMANHO_MAXIMO_MARCADOR_SAUDE + 1
+      );
+  }
+}
+
+/**
+ * @brief  Função que obtem o tamanho da arena do consumidor: o maior buffer de um bloco no formato
+ *         do cartao ou a memoria de trabalho do colunar do servidor. O cartao e o servidor recebem o
+ *         bloco um depois do outro e cada um devolve o que tomou antes de retornar, por isso nao se
+ *         somam. O texto enviado ao servidor é formatado direto no buffer do enviador
+ * @param  quantidade: maior quantidade de mensagens de um bloco
+ * @param  formatoCartao: formato do registro no cartao
+ * @param  formatoServidor: formato dos blocos enviados ao servidor
+ * @return quantidade de bytes
+ */
+Tuint32 snifferCanRegistro_tamanhoArena(Tuint32 quantidade, TformatoRegistro formatoCartao, 
+                                        TformatoRegistro formatoServidor){
+  Tuint32 cartao = snifferCanRegistro_tamanhoFormato(quantidade, formatoCartao);
+  Tuint32 servidor = 0;
+
+  if(formatoServidor == eFormatoColunar){
+    servidor = (ALINHAMENTO_ARENA_BLOCO + TAMANHO_TRABALHO_COLUNAR(quantidade));
+  }
+
+  return ((cartao > servidor) ? cartao : servidor);
+}
+
+/**
+ * @brief  Função que obtem o tamanho de cada buffer do enviador do servidor: um bloco maximo
+ *         formatado, com o cabeçalho no colunar, e ao menos TAMANHO_MINIMO_BUFFER_ENVIO
+ * @param  quantidade: maior quantidade de mensagens de um bloco
+ * @param  formatoServidor: formato dos blocos enviados ao servidor
+ * @return quantidade de bytes
+ */
+Tuint32 snifferCanRegistro_tamanhoEnvio(Tuint32 quantidade, TformatoRegistro formatoServidor){
+  Tuint32 tamanho;
+
+  if(formatoServidor == eFormatoColunar){
+    tamanho = (TAMANHO_CABECALHO_BINARIO + TAMANHO_MAXIMO_BLOCO_COLUNAR(quantidade));
+  }else{
+    tamanho = ((TAMANHO_MAXIMO_LINHA_SIMPLES * quantidade) + 1);
+  }
+
+  return ((tamanho > TAMANHO_MINIMO_BUFFER_ENVIO) ? tamanho : TAMANHO_MINIMO_BUFFER_ENVIO);
+}
@@ -1,40 +1,54 @@
-/**
- * @file    snifferCan_registro.h
- * @brief   Esse arquivo contem o prototipo das funções relativas ao envio de dados ao servidor
- * @author  Emanoel Gomes Santos
- * @date    Data de Criação: 31/03/2020
-**/
-#ifndef SNIFFER_CAN_REGISTRO_INCLUDED
-#define SNIFFER_CAN_REGISTRO_INCLUDED
-
-/// Inclusões importantes
-#include <stdio.h>
-#include <stdlib.h>
-#include <HTTPClient.h>
-#include <string.h>
-
-/// Submódulos do sistema
-#include "tipos.h"
-#include "erros.h"
-#include "fila_mensagem.h"
-#include "snifferCan_cartao.h"
-#include "snifferCan_servidor.h"
-#include "snifferCan_wifi.h"
-
-/// Funções exportadas
-char *snifferCan_obtemPonteiroTexto(void);
-Terro snifferCanRegistro_enviaDadosServidor(
-    PTmensagemCAN mensagem, 
-    Tuint16 quantidade,
-    TwifiConfig wifi,
-    char *url
-);
-Terro snifferCanRegistro_enviaDadosCartao(
-    PTmensagemCAN mensagem, 
-    Tuint16 quantidade, 
-    char *nomeArquivo, 
-    Tbool logFormatado,
-    Tbool monitorSerial
-);
-
-#endif // SNIFFER_CAN_REGISTRO_INCLUDED
+/**
+ * @file    snifferCan_registro.h
+ * @brief   Esse arquivo contem o prototipo das funções relativas ao envio de dados ao servidor
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 31/03/2020
+**/
+#ifndef SNIFFER_CAN_REGISTRO_INCLUDED
+#define SNIFFER_CAN_REGISTRO_INCLUDED
+
+/// Inclusões importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <HTTPClient.h>
+#include <string.h>
+
+/// Submódulos do sistema
+#include "tipos.h"
+#include "erros.h"
+#include "fila_mensagem.h"
+#include "snifferCan_cartao.h"
+#include "registro_binario.h"
+#include "registro_colunar.h"
+#include "registro_pcap.h"
+#include "registro_mdf.h"
+#include "indice_registro.h"
+#include "formatador_quadro.h"
+#include "arena_bloco.h"
+#include "snifferCan_servidor.h"
+#include "enviador_servidor.h"
+#include "snifferCan_wifi.h"
+
+/// Funções exportadas
+char *snifferCan_obtemPonteiroTexto(void);
+Terro snifferCanRegistro_enviaDadosServidor(
+    PTenviadorServidor enviador,
+    PTarenaBloco arena,
+    PTblocoMensagens bloco, 
+    TformatoRegistro formato
+);
+Terro snifferCanRegistro_enviaDadosCartao(
+    PTescritorCartao escritor,
+    PTindiceRegistro indice,
+    PTarenaBloco arena,
+    PTblocoMensagens bloco, 
+    char *nomeArquivo, 
+    TformatoRegistro formato,
+    Tbool logFormatado,
+    Tbool monitorSerial
+);
+Tuint32 snifferCanRegistro_tamanhoArena(Tuint32 quantidade, TformatoRegistro formatoCartao, 
+                                        TformatoRegistro formatoServidor);
+Tuint32 snifferCanRegistro_tamanhoEnvio(Tuint32 quantidade, TformatoRegistro formatoServidor);
+
+#endif // SNIFFER_CAN_REGISTRO_INCLUDED
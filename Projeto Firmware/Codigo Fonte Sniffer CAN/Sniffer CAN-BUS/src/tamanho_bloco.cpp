@@ -0,0 +1,111 @@
+/**
+ * @file    tamanho_bloco.cpp
+ * @brief   Esse arquivo contem o calculo do tamanho do bloco. Em regime um bloco de n mensagens
+ *          chega a cada ciclo (enchimento + envio), entao o bloco precisa de pelo menos
+ *          vazão * envio mensagens para o consumidor acompanhar a captura, e no maximo
+ *          vazão * (latencia - envio) para o primeiro quadro do bloco nao esperar mais que a latencia
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include "tamanho_bloco.h"
+
+#define MICROSSEGUNDOS_POR_SEGUNDO   1000000ULL
+
+/**
+ * @brief  Função que atualiza uma media movel exponencial com peso 1/2^DESLOCAMENTO_MEDIA_BLOCO
+ * @param  media: media atual, 0 se ainda nao houver amostra
+ * @param  amostra: nova amostra
+ * @return nova media
+ */
+static inline Tuint32 tamanhoBloco_media(Tuint32 media, Tuint32 amostra){
+  if(media == 0){
+    return amostra;
+  }
+  return ((media - (media >> DESLOCAMENTO_MEDIA_BLOCO)) + (amostra >> DESLOCAMENTO_MEDIA_BLOCO));
+}
+
+/**
+ * @brief  Função que inicializa o tamanho do bloco, começando em QUANTIDADE_INICIAL_MENSAGENS_POR_BLOCO
+ * @param  tamanho: estado do tamanho do bloco
+ * @param  maximo: maior quantidade de mensagens de um bloco (tamanho do buffer do consumidor)
+ * @param  latencia: tempo maximo de um quadro ate o fim do envio do seu bloco (ms)
+ * @return void
+ */
+void tamanhoBloco_inicializa(PTtamanhoBloco tamanho, Tuint32 maximo, Tuint32 latencia){
+  (void)memset(tamanho, 0x00, sizeof(TtamanhoBloco));
+
+  tamanho->maximo = maximo;
+  tamanho->latencia = (latencia * 1000UL);
+  tamanho->alvo = ((maximo < QUANTIDADE_INICIAL_MENSAGENS_POR_BLOCO) ? maximo : QUANTIDADE_INICIAL_MENSAGENS_POR_BLOCO);
+  tamanho->enchimento = tamanho->latencia;
+}
+
+/**
+ * @brief  Função que registra um bloco entregue e recalcula o alvo e o tempo de enchimento do proximo
+ * @param  tamanho: estado do tamanho do bloco
+ * @param  quantidade: mensagens do bloco entregue
+ * @param  ciclo: tempo desde o fechamento do bloco anterior ate o fechamento deste (us)
+ * @param  envio: tempo gasto pelo cartao e pelo servidor com este bloco (us)
+ * @return void
+ */
+void tamanhoBloco_registraEnvio(PTtamanhoBloco tamanho, Tuint32 quantidade, Tuint32 ciclo, Tuint32 envio){
+  Tuint64 amostra;
+  Tuint64 alvoLatencia;
+  Tuint64 alvoVazao;
+
+  if(ciclo == 0){
+    ciclo = 1;
+  }
+  amostra = (((Tuint64)quantidade * MICROSSEGUNDOS_POR_SEGUNDO) / ciclo);
+  if(amostra > 0xFFFFFFFFULL){
+    amostra = 0xFFFFFFFFULL;
+  }
+  tamanho->quadrosPorSegundo = tamanhoBloco_media(tamanho->quadrosPorSegundo, (Tuint32)amostra);
+  tamanho->tempoEnvio = tamanhoBloco_media(tamanho->tempoEnvio, envio);
+
+  // Tempo que sobra da latencia para encher o bloco. Se o envio tomar quase toda a latencia, o
+  // bloco ainda enche por 1/4 dela para nao virar uma requisição por quadro
+  if(tamanho->tempoEnvio < (tamanho->latencia - (tamanho->latencia >> 2))){
+    tamanho->enchimento = (tamanho->latencia - tamanho->tempoEnvio);
+  }else{
+    tamanho->enchimento = (tamanho->latencia >> 2);
+  }
+
+  // O que chega durante o enchimento, limitado pela latencia, e o que chega durante um envio mais
+  // 1/4 de folga. O segundo vence quando os armazenadores ficam lentos: a latencia passa do
+  // configurado, mas o consumidor continua acompanhando a captura e a fila nao perde quadros
+  alvoLatencia = (((Tuint64)tamanho->quadrosPorSegundo * tamanho->enchimento) / MICROSSEGUNDOS_POR_SEGUNDO);
+  alvoVazao = (((Tuint64)tamanho->quadrosPorSegundo * (tamanho->tempoEnvio + (tamanho->tempoEnvio >> 2))) /
+               MICROSSEGUNDOS_POR_SEGUNDO);
+  if(alvoVazao > alvoLatencia){
+    alvoLatencia = alvoVazao;
+  }
+
+  if(alvoLatencia < QUANTIDADE_MINIMA_MENSAGENS_POR_BLOCO){
+    alvoLatencia = QUANTIDADE_MINIMA_MENSAGENS_POR_BLOCO;
+  }
+  if(alvoLatencia > tamanho->maximo){
+    alvoLatencia = tamanho->maximo;
+  }
+  tamanho->alvo = (Tuint32)alvoLatencia;
+}
+
+/**
+ * @brief  Função que obtem a quantidade de mensagens que fecha o bloco atual
+ * @param  tamanho: estado do tamanho do bloco
+ * @return quantidade de mensagens
+ */
+Tuint32 tamanhoBloco_alvo(PTtamanhoBloco tamanho){
+  return tamanho->alvo;
+}
+
+/**
+ * @brief  Função que obtem o tempo maximo desde a primeira mensagem do bloco atual ate o seu envio
+ * @param  tamanho: estado do tamanho do bloco
+ * @return tempo em us
+ */
+Tuint32 tamanhoBloco_tempoEnchimento(PTtamanhoBloco tamanho){
+  return tamanho->enchimento;
+}
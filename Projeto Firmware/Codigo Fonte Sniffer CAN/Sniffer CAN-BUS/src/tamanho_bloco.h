@@ -0,0 +1,27 @@
+/**
+ * @file    tamanho_bloco.h
+ * @brief   Esse arquivo contem o prototipo das funções do tamanho do bloco entregue aos
+ *          armazenadores. O bloco cresce com a vazão e com o tempo de envio medidos, para diluir o
+ *          custo de cada escrita e requisição, e encolhe para respeitar a latencia configurada
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef TAMANHO_BLOCO_H_INCLUDED
+#define TAMANHO_BLOCO_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Submódulos do sistema
+#include "tipos.h"
+#include "erros.h"
+
+/// Funções exportadas
+void tamanhoBloco_inicializa(PTtamanhoBloco tamanho, Tuint32 maximo, Tuint32 latencia);
+void tamanhoBloco_registraEnvio(PTtamanhoBloco tamanho, Tuint32 quantidade, Tuint32 ciclo, Tuint32 envio);
+Tuint32 tamanhoBloco_alvo(PTtamanhoBloco tamanho);
+Tuint32 tamanhoBloco_tempoEnchimento(PTtamanhoBloco tamanho);
+
+#endif // TAMANHO_BLOCO_H_INCLUDED
@@ -1,262 +1,901 @@
-/**
- * @file    tipos.h
- * @brief   Esse arquivo contem as definições dos tipos proprios utilizado no sistema
- * @author  Emanoel Gomes Santos
- * @date    Data de Criação: 30/03/2020
-**/
-
-#ifndef TIPO_H_INCLUDED
-#define TIPO_H_INCLUDED
-
-#include <Arduino.h>
-#include <mcp_can.h>
-#include <SD.h>
-
-#define SERIAL_SNIFFER_CAN  "User=EA12345678"
-#define SENHA_SNIFFER_CAN   "Password=AE123456"
-#define TAMANHO_SENHA_E_SERIAL (sizeof(SERIAL_SNIFFER_CAN) + sizeof(SENHA_SNIFFER_CAN) + 2 + 1) 
-//  mais 2 por causa de dois "&" comercials e +1 por causa do \0
-
-#define TAXA_TRANSFERENCIA_SERIAL_ESP32  115200
-
-/// Definição boleana
-#define VERDADEIRO true
-#define FALSO      false
-/// Definições de escrita na tela serial
-#define PRINTLN       Serial.println
-#define PRINTF        Serial.printf
-#define PRINT         Serial.print
-
-// Definições de taxas CAN
-#define TAXA_4K096BPS  CAN_4K096BPS
-#define TAXA_5KBPS     CAN_5KBPS
-#define TAXA_10KBPS    CAN_10KBPS
-#define TAXA_20KBPS    CAN_20KBPS
-#define TAXA_31K25BPS  CAN_31K25BPS
-#define TAXA_33K3BPS   CAN_33K3BPS
-#define TAXA_40KBPS    CAN_40KBPS
-#define TAXA_50KBPS    CAN_50KBPS
-#define TAXA_80KBPS    CAN_80KBPS
-#define TAXA_100KBPS   CAN_100KBPS
-#define TAXA_125KBPS   CAN_125KBPS
-#define TAXA_200KBPS   CAN_200KBPS
-#define TAXA_250KBPS   CAN_250KBPS
-#define TAXA_500KBPS   CAN_500KBPS
-#define TAXA_1000KBPS  CAN_1000KBPS
-
-
-#define MAX_MASCARA_FILTRO_SUPORTADA   2
-
-/// Definiçoes gerais
-#define TAMANHO_BUFFER_10M                (10*1024*1024)
-#define TAMANHO_BUFFER_200K               (200*1024)
-#define TAMANHO_BUFFER_100K               (100*1024)
-#define TAMANHO_BUFFER_120K               (120*1024)
-#define TAMANHO_BUFFER_80K                (80*1024)
-#define TAMANHO_BUFFER_60K                (60*1024)
-#define TAMANHO_BUFFER_40K                (40*1024)
-#define TAMANHO_BUFFER_20K                (20*1024)
-#define TAMANHO_BUFFER_10K                (10*1024)
-#define TAMANHO_BUFFER_8K                 (8*1024)
-#define TAMANHO_BUFFER_4K                 (4*1024)
-#define TAMANHO_BUFFER_2K                 (2*1024)
-#define TAMANHO_BUFFER_1K                 (1*1024)
-#define TAMANHO_MAXIMO_BUFFER_FILA        TAMANHO_BUFFER_4K// nao modificar tamanho maximo suportado 4k (4096 * 17)
-#define NUCLEO_ZERO                       0
-#define NUCLEO_UM                         1
-#define PINO_LED_INTERNO                  2
-
-#define TAMANHO_MAX_DADOS_QUADRO_CAN      8
-
-// Servidor
-#define URL_HTTP_SERVIDOR_SNNIFER_CAN  \
-  "https://tcc-eng-comp-webapp.azurewebsites.net/api/Esp32?Authorization=XiREf7U5HdmxMwHcyLKdwdEDLqvkv2PSFKBnUaFDE94CYRVygjggtVrfxJz5kYeB"
-#define TAMANHO_MAXIMO_URL    1000
-/// WIFI
-#define SSID_WIFI      ((const char*)"Emanoel")
-#define PASSWORD_WIFI  ((const char*)"147852369")
-#define TAMANHO_MAXIMO_SENHA   (64+1)
-#define TAMANHO_MAXIMO_LOGIN   (32+1)
-
-/// Cartão
-#define CS_PIN_MODULO_MICRO_SD     5
-#define MAX_TENTATIVAS_CARTAO      5
-#define TENTATIVAS_ESCRITA_CARTAO  10
-
-#define MAXIMA_QUANTIDADE_IDENTIFICADORES  6
-#define MAXIMA_QUANTIDADE_MASCARAS         2
-#define QUANTIDADE_FILTROS_MASCARA_0       2
-#define QUANTIDADE_FILTROS_MASCARA_1       4
-#define MAXIMA_QUANTIDADE_FILTROS          (QUANTIDADE_FILTROS_MASCARA_0+QUANTIDADE_FILTROS_MASCARA_1)
-#define QUANTIDADE_FILTROS_E_MASCARAS      (MAXIMA_QUANTIDADE_MASCARAS+MAXIMA_QUANTIDADE_FILTROS)
-#define TAMANHO_MAX_STRING_FILTRO          (8+1)
-#define TAMANHO_MAX_BUFFER_FILTRO          (TAMANHO_MAX_STRING_FILTRO*MAXIMA_QUANTIDADE_FILTROS)
-#define NOME_ARQUIVO_CONFIGURACAO          ("/SETUP/configuracao.txt")
-#define NOME_ARQUIVO_REGISTRO_INTERNO      ("/SETUP/system.nel")
-#define NOME_ARQUIVO_REGISTRO_PADRAO       ("/REGISTROS/LOG-0000.txt")
-#define TAMANHO_BUFFER_MENSAGEM_REGISTRO   ((strlen(NOME_ARQUIVO_REGISTRO_PADRAO)) + 1)
-#define QUANTIDADE_MAXIMA_REGISTROS_CARTAO (0xFFFF)
-
-/// Definidores de formatação do texto a serem enviados
-#define TAMANHO_DEFINIDO_ESPACO_ENTRE_TEMPO_ID   20
-#define QUANTIDADE_ESPACO_TEXTO_FORMATADO       (17 + TAMANHO_DEFINIDO_ESPACO_ENTRE_TEMPO_ID)
-#define QUANTIDADE_SEPARADORES_TEXTO             4
-
-/// Definições de funções
-#define HEX_TO_ASCII(hexa)      ((hexa <= 0x09)  ? (hexa + '0') : ((hexa - 0x0A) + 'A'))
-#define ASCII_TO_HEXA(ascii)    ((ascii >= 'A') ? (ascii - 0x37) : (ascii - 0x30))
-
-// Definições importantes
-#define PRIMEIRA_INTERACAO       (i==0) 
-
-// Definições de erro
-#define  LED_ERRO_CAN              26
-#define  LED_ERRO_CARTAO_MEMORIA   27
-#define  LED_ERRO_WIFI             32
-#define  LED_ERRO_SERVIDOR         33
-
-// Definição do led para sistema pronto
-#define  LED_SISTEMA_PRONTO        25
-
-/// Tipo inteiro  de 64 bits sem sinal
-typedef unsigned long long int Tuint64;
-/// Tipo inteiro  de 32 bits sem sinal
-typedef unsigned int Tuint32;
-/// Tipo inteiro de 16 bits sem sinal
-typedef unsigned short int  Tuint16;
-/// Tipo inteiro de 8 bits sem sinal
-typedef unsigned char Tuint8;
-/// Tipo erro
-typedef Tuint8 Terro;
-/// Tipo boleano
-typedef bool Tbool;
-
-typedef unsigned long Tempo;
-
-typedef enum EmodoEscritaCartao {
-  eModoWrite,
-  eModoAppend
-}TmodoEscrita;
-
-typedef TmodoEscrita *PTmodoEscrita;
-
-// Tipo de mensagem can
-typedef union Uidentificador {
-  Tuint16 padrao;
-  Tuint32 extendido;
-}Tidentificador;
-
-typedef Tidentificador *PTidentificador;
-
-typedef struct SmensagemCAN {
-  Tidentificador identificador;
-  Tuint8 dados[TAMANHO_MAX_DADOS_QUADRO_CAN];
-  Tuint8 tamanho;
-  Tempo intervalo;
-}TmensagemCAN;
-
-typedef TmensagemCAN * PTmensagemCAN;
-
-typedef struct SwifiConfig {
-  char login[TAMANHO_MAXIMO_LOGIN];
-  char senha[TAMANHO_MAXIMO_SENHA];
-  Tbool conectado;
-}TwifiConfig;
-
-typedef TwifiConfig *PTwifiConfig; 
-
-
-// Tipo taxa de comunicação
-typedef Tuint8 TaxaComunicacao;
-typedef TaxaComunicacao *PTaxaComunicacao;
-
-typedef enum EtipoFiltro {
-  ePadrao,
-  eExtendido,  
-}TtipoFiltro;
-
-typedef struct Sfiltro{
-  Tuint32 valor;  
-}Tfiltro;
-
-typedef struct SlistaFiltrosAndMascaras {
-  // Definidor da mascara 0
-  Tuint32 mascara_0;
-  // Existe mascara 0 configurada?
-  Tbool mask_0;  
-  // Definidor da mascara 1
-  Tuint32 mascara_1;
-  // Existe mascara 0 configurada?
-  Tbool mask_1;
-  // Lista de filtros possiveis
-  Tfiltro filtros[MAXIMA_QUANTIDADE_FILTROS];
-  // Quantidade de filtros configurados
-  Tuint16 quantidade;
-  // Tipo do filtro
-  TtipoFiltro tipo;
-}TlistaFiltrosAndMascaras;
-
-typedef TlistaFiltrosAndMascaras *PTlistaFiltrosAndMascaras;
-
-typedef struct Sservidor {
-  char reg[TAMANHO_MAXIMO_URL];
-  char taxa[TAMANHO_MAXIMO_URL];
-  char filtro[TAMANHO_MAXIMO_URL];  
-}Tservidor;
-
-typedef Tservidor *PTservidor;
-
-typedef struct Sconfiguracao{
-  // Lista de identificadores que se deseja filtrar
-  TlistaFiltrosAndMascaras filtAndMask;
-  // Taxa de comunicação do módulo
-  TaxaComunicacao taxa;
-  // Login e senha do wifi
-  TwifiConfig wifi;
-  // Deseja log formatado?
-  Tbool logFormatado;
-  // Deseja monitor serial?
-  Tbool monitorSerial;
-  // identificador do ultimo arquivo
-  Tuint16 idArquivo;
-  // URL do servidor
-  Tservidor servidor;
-}Tconfiguracao;
-
-typedef Tconfiguracao *PTconfiguracao;
-
-// Estrutura de dados para a fila de mensagem CAN
-typedef struct SfilaMensagem{
-  /// Ponteiro para frente celula ta fila
-  Tuint32 capacidadeMax;
-  /// Ponteiro para o tipo mensagem CAN
-  PTmensagemCAN mensagem;
-  // Posição primeiro
-  Tuint32  primeiro;
-  // Posição ultimo
-  Tuint32 ultimo;
-  // Tamanho lista
-  Tuint32 tamanhoAtual;
-
-}TfilaMensagem;
-
-// Definição do ponteiro
-typedef TfilaMensagem* PTfilaMensagem;
-
-
-typedef struct SdescritorSniffer{
-  Tconfiguracao configuracao;
-  TfilaMensagem filaMensagem;
-}TdescritorSniffer;
-
-typedef TdescritorSniffer *PTdescritorSniffer;
-
-
-typedef struct StabelaTaxas{
-  char descricao[50];
-  TaxaComunicacao taxa;  
-}TtabelaTaxas;
-
-typedef TtabelaTaxas *PTtabelaTaxas;
-
+/**
+ * @file    tipos.h
+ * @brief   Esse arquivo contem as definições dos tipos proprios utilizado no sistema
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 30/03/2020
+**/
+
+#ifndef TIPO_H_INCLUDED
+#define TIPO_H_INCLUDED
+
+#include <Arduino.h>
+#include <mcp_can.h>
+#include <SD.h>
+
+#define SERIAL_SNIFFER_CAN  "User=EA12345678"
+#define SENHA_SNIFFER_CAN   "Password=AE123456"
+#define TAMANHO_SENHA_E_SERIAL (sizeof(SERIAL_SNIFFER_CAN) + sizeof(SENHA_SNIFFER_CAN) + 2 + 1) 
+//  mais 2 por causa de dois "&" comercials e +1 por causa do \0
+
+#define TAXA_TRANSFERENCIA_SERIAL_ESP32  115200
+
+/// Definição boleana
+#define VERDADEIRO true
+#define FALSO      false
+/// Definições de escrita na tela serial
+#define PRINTLN       Serial.println
+#define PRINTF        Serial.printf
+#define PRINT         Serial.print
+/// Valor de uma definição como texto (usado no arquivo de configuração padrão)
+#define TEXTO_MACRO_(valor)  #valor
+#define TEXTO_MACRO(valor)   TEXTO_MACRO_(valor)
+
+// Definições de taxas CAN
+#define TAXA_4K096BPS  CAN_4K096BPS
+#define TAXA_5KBPS     CAN_5KBPS
+#define TAXA_10KBPS    CAN_10KBPS
+#define TAXA_20KBPS    CAN_20KBPS
+#define TAXA_31K25BPS  CAN_31K25BPS
+#define TAXA_33K3BPS   CAN_33K3BPS
+#define TAXA_40KBPS    CAN_40KBPS
+#define TAXA_50KBPS    CAN_50KBPS
+#define TAXA_80KBPS    CAN_80KBPS
+#define TAXA_100KBPS   CAN_100KBPS
+#define TAXA_125KBPS   CAN_125KBPS
+#define TAXA_200KBPS   CAN_200KBPS
+#define TAXA_250KBPS   CAN_250KBPS
+#define TAXA_500KBPS   CAN_500KBPS
+#define TAXA_1000KBPS  CAN_1000KBPS
+
+
+#define MAX_MASCARA_FILTRO_SUPORTADA   2
+
+/// Definiçoes gerais
+#define TAMANHO_BUFFER_10M                (10*1024*1024)
+#define TAMANHO_BUFFER_200K               (200*1024)
+#define TAMANHO_BUFFER_100K               (100*1024)
+#define TAMANHO_BUFFER_120K               (120*1024)
+#define TAMANHO_BUFFER_80K                (80*1024)
+#define TAMANHO_BUFFER_60K                (60*1024)
+#define TAMANHO_BUFFER_40K                (40*1024)
+#define TAMANHO_BUFFER_20K                (20*1024)
+#define TAMANHO_BUFFER_10K                (10*1024)
+#define TAMANHO_BUFFER_8K                 (8*1024)
+#define TAMANHO_BUFFER_4K                 (4*1024)
+#define TAMANHO_BUFFER_2K                 (2*1024)
+#define TAMANHO_BUFFER_1K                 (1*1024)
+#define TAMANHO_INICIAL_BUFFER_FILA       TAMANHO_BUFFER_4K// 4096 * 16 bytes = 64 KiB, dentro dos 80 KiB da fila anterior (4096 * 20 bytes)
+#define TAMANHO_MAXIMO_BUFFER_FILA        TAMANHO_BUFFER_8K// 8192 * 16 bytes = 128 KiB, so com o heap que sobra depois de todos os buffers
+#define RESERVA_HEAP_AMPLIA_FILA          TAMANHO_BUFFER_60K// heap mantido livre para as pilhas das tarefas (42 KiB), WiFi e HTTP
+#define TAMANHO_MINIMO_BUFFER_FILA        TAMANHO_BUFFER_1K
+#define TAMANHO_LINHA_CACHE               32  // separa os indices da fila escritos por nucleos diferentes
+#define NUCLEO_ZERO                       0
+#define NUCLEO_UM                         1
+#define PINO_LED_INTERNO                  2
+
+#define TAMANHO_MAX_DADOS_QUADRO_CAN      8
+
+/// Bits do identificador da mensagem CAN
+#define FLAG_QUADRO_EXTENDIDO             0x80000000U
+#define FLAG_QUADRO_REMOTO                0x40000000U
+#define FLAG_QUADRO_ERRO                  0x20000000U
+#define MASCARA_ID_EXTENDIDO              0x1FFFFFFFU
+#define MASCARA_ID_PADRAO                 0x000007FFU
+#define QUADRO_EXTENDIDO(mensagem)        (((mensagem).identificador & FLAG_QUADRO_EXTENDIDO) != 0)
+#define QUADRO_REMOTO(mensagem)           (((mensagem).identificador & FLAG_QUADRO_REMOTO) != 0)
+#define QUADRO_ERRO(mensagem)             (((mensagem).identificador & FLAG_QUADRO_ERRO) != 0)
+#define ID_QUADRO(mensagem)               ((mensagem).identificador & MASCARA_ID_EXTENDIDO)
+/// Bits baixos do instante de captura (us) guardados na mensagem, da a volta a cada ~268 s
+#define BITS_TEMPO_QUADRO_CAN             28
+#define MASCARA_TEMPO_QUADRO_CAN          ((1ULL << BITS_TEMPO_QUADRO_CAN) - 1)
+/// Reconstroi o instante de 64 bits de uma mensagem a partir de um instante de referencia posterior
+/// a ela (menos de ~268 s depois), por exemplo o instante em que o bloco foi montado
+#define TEMPO_ABSOLUTO_QUADRO(mensagem, referencia) \
+  ((referencia) - (((referencia) - (Tuint64)(mensagem).tempo) & MASCARA_TEMPO_QUADRO_CAN))
+/// Resolução do tempo escrito nos registros (us), o texto mostra decimos de milisegundo
+#define RESOLUCAO_TEMPO_REGISTRO          100
+
+// Servidor
+#define URL_HTTP_SERVIDOR_SNNIFER_CAN  \
+  "https://tcc-eng-comp-webapp.azurewebsites.net/api/Esp32?Authorization=XiREf7U5HdmxMwHcyLKdwdEDLqvkv2PSFKBnUaFDE94CYRVygjggtVrfxJz5kYeB"
+#define TAMANHO_MAXIMO_URL    1000
+/// WIFI
+#define SSID_WIFI      ((const char*)"Emanoel")
+#define PASSWORD_WIFI  ((const char*)"147852369")
+#define TAMANHO_MAXIMO_SENHA   (64+1)
+#define TAMANHO_MAXIMO_LOGIN   (32+1)
+
+/// Cartão
+#define CS_PIN_MODULO_MICRO_SD     5
+#define MAX_TENTATIVAS_CARTAO      5
+#define TENTATIVAS_ESCRITA_CARTAO  10
+
+#define MAXIMA_QUANTIDADE_IDENTIFICADORES  6
+#define MAXIMA_QUANTIDADE_MASCARAS         2
+#define QUANTIDADE_FILTROS_MASCARA_0       2
+#define QUANTIDADE_FILTROS_MASCARA_1       4
+#define MAXIMA_QUANTIDADE_FILTROS          (QUANTIDADE_FILTROS_MASCARA_0+QUANTIDADE_FILTROS_MASCARA_1)
+#define QUANTIDADE_FILTROS_E_MASCARAS      (MAXIMA_QUANTIDADE_MASCARAS+MAXIMA_QUANTIDADE_FILTROS)
+#define TAMANHO_MAX_STRING_FILTRO          (8+1)
+#define TAMANHO_MAX_BUFFER_FILTRO          (TAMANHO_MAX_STRING_FILTRO*MAXIMA_QUANTIDADE_FILTROS)
+/// Definições do filtro de software (segundo estagio, aplicado depois da fila)
+#define QUANTIDADE_IDS_PADRAO              2048
+#define BITS_POR_PALAVRA_FILTRO            32
+#define QUANTIDADE_PALAVRAS_FILTRO_PADRAO  (QUANTIDADE_IDS_PADRAO / BITS_POR_PALAVRA_FILTRO)
+#define BITS_TABELA_FILTRO_EXTENDIDO       9
+#define TAMANHO_TABELA_FILTRO_EXTENDIDO    (1 << BITS_TABELA_FILTRO_EXTENDIDO)  // ocupação maxima de 50%
+#define MAXIMA_QUANTIDADE_IDS_EXTENDIDOS   (TAMANHO_TABELA_FILTRO_EXTENDIDO / 2)
+#define BITS_TABELA_MUDANCA                9
+#define TAMANHO_TABELA_MUDANCA             (1 << BITS_TABELA_MUDANCA)  // ocupação maxima de 50%
+#define MAXIMA_QUANTIDADE_IDS_MUDANCA      (TAMANHO_TABELA_MUDANCA / 2)
+#define INTERVALO_QUADRO_CHAVE_PADRAO      1000  // ms, 0 = somente mudanças
+#define BITS_TABELA_ESTATISTICA            9
+#define TAMANHO_TABELA_ESTATISTICA         (1 << BITS_TABELA_ESTATISTICA)  // ocupação maxima de 50%
+#define MAXIMA_QUANTIDADE_IDS_ESTATISTICA  (TAMANHO_TABELA_ESTATISTICA / 2)
+#define BITS_TABELA_INDICE                 9
+#define TAMANHO_TABELA_INDICE              (1 << BITS_TABELA_INDICE)  // ocupação maxima de 50%
+#define MAXIMA_QUANTIDADE_IDS_INDICE       (TAMANHO_TABELA_INDICE / 2)
+#define JANELA_TAXA_ESTATISTICA            1000000ULL  // us, janela do calculo da taxa de cada identificador
+#define INTERVALO_AMOSTRA_SAUDE            100000ULL   // us, leitura dos contadores de erro do MCP2515
+#define JANELA_CARGA_BARRAMENTO            1000000ULL  // us, janela do calculo da carga do barramento
+#define TAMANHO_MAXIMO_INFORMACAO_CONFIG   2048  // 200 identificadores extendidos separados por ';'
+#define NOME_ARQUIVO_CONFIGURACAO          ("/SETUP/configuracao.txt")
+#define NOME_ARQUIVO_REGISTRO_INTERNO      ("/SETUP/system.nel")
+#define NOME_ARQUIVO_REGISTRO_PADRAO       ("/REGISTROS/LOG-0000.txt")
+#define NOME_ARQUIVO_REGISTRO(formato)     (((formato) == eFormatoTexto) ? "/REGISTROS/LOG-%04d.txt" : \
+                                            ((formato) == eFormatoPcap)  ? "/REGISTROS/LOG-%04d.pcap" : \
+                                            ((formato) == eFormatoMdf)   ? "/REGISTROS/LOG-%04d.mf4"  : "/REGISTROS/LOG-%04d.bin")
+#define FORMATO_REGISTRO_PADRAO            eFormatoTexto
+#define TAMANHO_BUFFER_MENSAGEM_REGISTRO   TAMANHO_MAXIMO_NOME_ARQUIVO  // comporta a extensão .pcap e ids de 5 digitos
+#define TAMANHO_MAXIMO_NOME_ARQUIVO        32
+#define DESCARGA_CARTAO_BYTES_PADRAO       16384  // bytes pendentes no arquivo de registro antes do flush
+#define DESCARGA_CARTAO_TEMPO_PADRAO       1000   // ms, tempo maximo sem flush do arquivo de registro
+#define TAMANHO_SETOR_CARTAO               512
+#define QUANTIDADE_BUFFERS_ESCRITA         2
+#define TAMANHO_BUFFER_ESCRITA             (32 * TAMANHO_SETOR_CARTAO)  // 16 KiB, multiplo do setor
+#define BUFFER_ESCRITA_NENHUM              0xFF
+#define TAMANHO_BUFFER_INDICE              1024   // bytes do indice que acompanham cada buffer de escrita
+/// Buffers da tarefa de envio ao servidor: um em envio, um na fila e um sendo preenchido pelo consumidor
+#define QUANTIDADE_BUFFERS_ENVIO           3
+#define TAMANHO_MINIMO_BUFFER_ENVIO        TAMANHO_BUFFER_8K  // cada buffer comporta ao menos um bloco maximo
+#define BUFFER_ENVIO_NENHUM                0xFF
+/// Sessão HTTP com o servidor: a conexão fica aberta entre as requisições e, depois de uma falha,
+/// a reconexão espera ESPERA_INICIAL_RECONEXAO dobrando ate ESPERA_MAXIMA_RECONEXAO
+#define ESPERA_INICIAL_RECONEXAO           500    // ms
+#define ESPERA_MAXIMA_RECONEXAO            30000  // ms
+#define TEMPO_MAXIMO_RESPOSTA_SERVIDOR     5000   // ms, uma conexão meio aberta vira erro de leitura
+/// Alinhamento dos buffers da arena do bloco
+#define ALINHAMENTO_ARENA_BLOCO            8
+
+/// Tamanho do bloco entregue aos armazenadores, ajustado à vazão e ao tempo de envio (tamanho_bloco.h)
+#define QUANTIDADE_MINIMA_MENSAGENS_POR_BLOCO   16
+#define QUANTIDADE_INICIAL_MENSAGENS_POR_BLOCO  50
+#define QUANTIDADE_MAXIMA_MENSAGENS_POR_BLOCO   1024   // padrao do arquivo de configuração
+#define QUANTIDADE_LIMITE_MENSAGENS_POR_BLOCO   8192
+#define LATENCIA_BLOCO_PADRAO                   500    // ms, do recebimento do quadro ate o fim do envio
+#define LATENCIA_MINIMA_BLOCO                   50     // ms
+#define LATENCIA_MAXIMA_BLOCO                   10000  // ms
+/// Peso das novas amostras nas medias do tamanho do bloco (1/2^n)
+#define DESLOCAMENTO_MEDIA_BLOCO                2
+#define PREALOCACAO_REGISTRO_PADRAO        16     // MiB, tambem no arquivo de configuração padrão
+#define PREALOCACAO_MAXIMA_REGISTRO        1024   // MiB
+#define PONTO_MONTAGEM_CARTAO              "/sd"  // ponto de montagem do SD no VFS do ESP32
+#define QUANTIDADE_MAXIMA_REGISTROS_CARTAO (0xFFFF)
+
+/// Definidores de formatação do texto a serem enviados
+#define TAMANHO_DEFINIDO_ESPACO_ENTRE_TEMPO_ID   20
+#define TAMANHO_MAXIMO_MARCADOR_TEXTO           48
+/// Tamanho maximo do marcador de resumo dos quadros suprimidos pelo registro de mudanças
+#define TAMANHO_MAXIMO_MARCADOR_SUPRIMIDOS      48
+/// Tamanho maximo do marcador de saude do barramento
+#define TAMANHO_MAXIMO_MARCADOR_SAUDE           96
+/// Tamanho maximo do marcador de inicio de arquivo, com a hora da primeira mensagem
+#define TAMANHO_MAXIMO_MARCADOR_INICIO          48
+/// Tamanho maximo do texto do intervalo ("%0.1f" em ms)
+#define TAMANHO_MAXIMO_TEXTO_TEMPO              16
+/// Maior intervalo (decimos de ms) escrito com conta inteira, ate ele o texto é identico ao
+/// "%0.1f" do float. Acima dele (~7 min sem quadros) o intervalo volta a ser escrito pelo sprintf
+#define LIMITE_INTERVALO_INTEIRO_TEXTO          (1UL << 22)
+/// Tamanho maximo de uma linha de texto por mensagem (tempo, id, dlc, dados, separadores e "\r\n")
+#define TAMANHO_MAXIMO_LINHA_FORMATADA          (TAMANHO_DEFINIDO_ESPACO_ENTRE_TEMPO_ID + 8 + 6 + 2 + 3 + (3 * TAMANHO_MAX_DADOS_QUADRO_CAN) + 2)
+#define TAMANHO_MAXIMO_LINHA_SIMPLES            (TAMANHO_MAXIMO_TEXTO_TEMPO + 1 + 8 + 1 + 2 + 1 + (2 * TAMANHO_MAX_DADOS_QUADRO_CAN) + 1)
+#define TAMANHO_MAXIMO_LINHA_TEXTO(formatado)   ((formatado) ? TAMANHO_MAXIMO_LINHA_FORMATADA : TAMANHO_MAXIMO_LINHA_SIMPLES)
+
+/// Padrões da fila de mensagens quando o arquivo de configuração nao define a politica
+#define POLITICA_FILA_PADRAO                    eDescartaMaisAntiga
+#define TEMPO_BLOQUEIO_FILA_PADRAO              5
+
+/// Definições de funções
+#define HEX_TO_ASCII(hexa)      ((hexa <= 0x09)  ? (hexa + '0') : ((hexa - 0x0A) + 'A'))
+#define ASCII_TO_HEXA(ascii)    ((ascii >= 'A') ? (ascii - 0x37) : (ascii - 0x30))
+
+// Definições importantes
+#define PRIMEIRA_INTERACAO       (i==0) 
+
+// Definições de erro
+#define  LED_ERRO_CAN              26
+#define  LED_ERRO_CARTAO_MEMORIA   27
+#define  LED_ERRO_WIFI             32
+#define  LED_ERRO_SERVIDOR         33
+
+// Definição do led para sistema pronto
+#define  LED_SISTEMA_PRONTO        25
+
+/// Tipo inteiro  de 64 bits sem sinal
+typedef unsigned long long int Tuint64;
+/// Tipo inteiro  de 64 bits com sinal
+typedef long long int Tint64;
+/// Tipo inteiro  de 32 bits sem sinal
+typedef unsigned int Tuint32;
+/// Tipo inteiro  de 32 bits com sinal
+typedef int Tint32;
+/// Tipo inteiro de 16 bits sem sinal
+typedef unsigned short int  Tuint16;
+/// Tipo inteiro de 8 bits sem sinal
+typedef unsigned char Tuint8;
+/// Tipo erro
+typedef Tuint8 Terro;
+/// Tipo boleano
+typedef bool Tbool;
+
+typedef unsigned long Tempo;
+
+typedef enum EmodoEscritaCartao {
+  eModoWrite,
+  eModoAppend
+}TmodoEscrita;
+
+typedef TmodoEscrita *PTmodoEscrita;
+
+// Tipo de mensagem can
+// Registro compacto de 16 bytes: a fila inicial guarda as mesmas 4096 mensagens em 64 KiB (antes 80 KiB) e so cresce
+// para 8192 (128 KiB, +48 KiB sobre a fila anterior) com o heap que sobra no fim da inicialização. O identificador segue o layout do can_id
+// do SocketCAN: bits 28..0 identificador, bit 29 erro, bit 30 remoto e bit 31 extendido.
+// O tamanho (DLC) e os bits baixos do instante de captura (esp_timer, us) dividem a mesma palavra.
+typedef struct SmensagemCAN {
+  Tuint32 identificador;
+  Tuint32 tamanho   : 4;
+  Tuint32 tempo     : BITS_TEMPO_QUADRO_CAN;
+  Tuint8 dados[TAMANHO_MAX_DADOS_QUADRO_CAN];
+}__attribute__((packed, aligned(4))) TmensagemCAN;
+
+static_assert(sizeof(TmensagemCAN) == 16, "TmensagemCAN deve ocupar 16 bytes");
+
+typedef TmensagemCAN * PTmensagemCAN;
+
+typedef struct SwifiConfig {
+  char login[TAMANHO_MAXIMO_LOGIN];
+  char senha[TAMANHO_MAXIMO_SENHA];
+  Tbool conectado;
+}TwifiConfig;
+
+typedef TwifiConfig *PTwifiConfig; 
+
+
+// Tipo taxa de comunicação
+typedef Tuint8 TaxaComunicacao;
+typedef TaxaComunicacao *PTaxaComunicacao;
+
+typedef enum EtipoFiltro {
+  ePadrao,
+  eExtendido,  
+}TtipoFiltro;
+
+typedef struct Sfiltro{
+  Tuint32 valor;  
+}Tfiltro;
+
+typedef struct SlistaFiltrosAndMascaras {
+  // Definidor da mascara 0
+  Tuint32 mascara_0;
+  // Existe mascara 0 configurada?
+  Tbool mask_0;  
+  // Definidor da mascara 1
+  Tuint32 mascara_1;
+  // Existe mascara 0 configurada?
+  Tbool mask_1;
+  // Lista de filtros possiveis
+  Tfiltro filtros[MAXIMA_QUANTIDADE_FILTROS];
+  // Quantidade de filtros configurados
+  Tuint16 quantidade;
+  // Tipo do filtro
+  TtipoFiltro tipo;
+}TlistaFiltrosAndMascaras;
+
+typedef TlistaFiltrosAndMascaras *PTlistaFiltrosAndMascaras;
+
+// Filtro de software compilado a partir da lista de identificadores da configuração.
+// Identificadores padrao ficam em um mapa de 2048 bits e os extendidos em uma tabela hash
+// de endereçamento aberto (sondagem linear), cada decisão é O(1)
+typedef struct SfiltroSoftware{
+  // Filtro configurado? Se nao, todas as mensagens sao aceitas
+  Tbool ativo;
+  // Um bit por identificador padrao
+  Tuint32 padrao[QUANTIDADE_PALAVRAS_FILTRO_PADRAO];
+  // Identificador extendido com FLAG_QUADRO_EXTENDIDO (0 = posição vazia)
+  Tuint32 extendido[TAMANHO_TABELA_FILTRO_EXTENDIDO];
+  // Maior quantidade de sondagens necessaria para encontrar um identificador da tabela
+  Tuint16 sondagemMaxima;
+  // Quantidades de identificadores compilados
+  Tuint16 quantidadePadrao;
+  Tuint16 quantidadeExtendido;
+}TfiltroSoftware;
+
+typedef TfiltroSoftware *PTfiltroSoftware;
+
+// Programação dos filtros do MCP2515 calculada pelo compilador de filtros. Cada mascara atende 
+// somente um tipo de quadro (padrao ou extendido): mascara 0 com os filtros 0 e 1 (RXB0) e 
+// mascara 1 com os filtros 2 a 5 (RXB1)
+typedef struct SprogramacaoFiltro{
+  // Programação calculada? Se nao, vale a lista "Identificadores" do arquivo de configuração
+  Tbool valida;
+  // Mascaras e tipo de cada uma
+  Tuint32 mascara[MAXIMA_QUANTIDADE_MASCARAS];
+  Tbool extendido[MAXIMA_QUANTIDADE_MASCARAS];
+  // Filtros, os filtros nao usados repetem um filtro da mesma mascara
+  Tuint32 filtro[MAXIMA_QUANTIDADE_FILTROS];
+  // Estimativas dos quadros aceitos pelo hardware e descartados pelo filtro de software
+  float idsFalsosAceitos;
+  float taxaFalsosAceitos;
+  float razaoFalsosAceitos;
+}TprogramacaoFiltro;
+
+typedef TprogramacaoFiltro *PTprogramacaoFiltro;
+
+// Ultimo conteudo registrado de um identificador, usado pelo registro somente de mudanças
+typedef struct SentradaMudanca{
+  // Identificador com as flags de tipo (FLAG_QUADRO_EXTENDIDO e FLAG_QUADRO_REMOTO)
+  Tuint32 identificador;
+  // Posição ocupada?
+  Tuint8 ocupada;
+  // Tamanho e dados do ultimo quadro registrado
+  Tuint8 tamanho;
+  Tuint8 dados[TAMANHO_MAX_DADOS_QUADRO_CAN];
+  // Instante (esp_timer, us) do ultimo quadro registrado
+  Tuint64 ultimoRegistro;
+}TentradaMudanca;
+
+typedef TentradaMudanca *PTentradaMudanca;
+
+// Registro somente de mudanças: um quadro so é registrado se os dados mudaram desde o ultimo
+// registro do mesmo identificador, ou se passou o intervalo do quadro chave
+typedef struct SregistroMudanca{
+  // Registro de mudanças ativo? Se nao, todas as mensagens sao registradas
+  Tbool ativo;
+  // Intervalo maximo (us) sem registrar um identificador, 0 = somente mudanças
+  Tuint64 intervaloQuadroChave;
+  // Contar os quadros suprimidos para o marcador de resumo?
+  Tbool resumo;
+  // Tabela hash de endereçamento aberto (sondagem linear) com TAMANHO_TABELA_MUDANCA posições
+  PTentradaMudanca tabela;
+  // Identificadores na tabela
+  Tuint16 quantidade;
+  // Quadros suprimidos desde o inicio
+  Tuint32 suprimidos;
+}TregistroMudanca;
+
+typedef TregistroMudanca *PTregistroMudanca;
+
+typedef struct Sservidor {
+  char reg[TAMANHO_MAXIMO_URL];
+  char taxa[TAMANHO_MAXIMO_URL];
+  char filtro[TAMANHO_MAXIMO_URL];  
+}Tservidor;
+
+typedef Tservidor *PTservidor;
+
+// Politica adotada quando a fila de mensagens CAN esta cheia
+typedef enum EpoliticaEstouroFila {
+  eDescartaMaisAntiga,  // sobrescreve a mensagem mais antiga (padrao)
+  eDescartaMaisNova,    // descarta a mensagem recebida
+  eBloqueia             // aguarda espaço ate o tempo limite, depois descarta a mensagem recebida
+}TpoliticaEstouroFila;
+
+typedef TpoliticaEstouroFila *PTpoliticaEstouroFila;
+
+// Formato dos arquivos de registro no cartao
+typedef enum EformatoRegistro {
+  eFormatoTexto,    // linhas de texto, formatadas ou simples (padrao)
+  eFormatoBinario,  // registros binarios com CRC por bloco (formato_binario.h)
+  eFormatoColunar,  // blocos binarios em colunas comprimidos (formato_binario.h)
+  eFormatoPcap,     // pcap com LINKTYPE_CAN_SOCKETCAN, aberto pelo Wireshark (registro_pcap.h)
+  eFormatoMdf       // ASAM MDF 4.10 com CAN_DataFrame, aberto pelas ferramentas de calibração (registro_mdf.h)
+}TformatoRegistro;
+
+typedef TformatoRegistro *PTformatoRegistro;
+
+typedef struct Sconfiguracao{
+  // Lista de identificadores que se deseja filtrar
+  TlistaFiltrosAndMascaras filtAndMask;
+  // Taxa de comunicação do módulo
+  TaxaComunicacao taxa;
+  // Login e senha do wifi
+  TwifiConfig wifi;
+  // Deseja log formatado?
+  Tbool logFormatado;
+  // Deseja monitor serial?
+  Tbool monitorSerial;
+  // identificador do ultimo arquivo
+  Tuint16 idArquivo;
+  // URL do servidor
+  Tservidor servidor;
+  // Politica da fila de mensagens quando estiver cheia
+  TpoliticaEstouroFila politicaFila;
+  // Tempo maximo de espera por espaço na fila (ms), usado com eBloqueia
+  Tuint32 tempoBloqueioFila;
+  // Filtros do MCP2515 calculados a partir da lista do filtro de software
+  TprogramacaoFiltro programacaoFiltro;
+  // Registrar somente quando os dados mudarem?
+  Tbool registroMudancas;
+  // Intervalo do quadro chave do registro de mudanças (ms)
+  Tuint32 intervaloQuadroChave;
+  // Escrever o resumo dos quadros suprimidos?
+  Tbool resumoSuprimidos;
+  // Bytes pendentes no arquivo de registro que forçam o flush (0 = a cada escrita)
+  Tuint32 bytesDescargaCartao;
+  // Tempo maximo sem flush do arquivo de registro (ms)
+  Tuint32 tempoDescargaCartao;
+  // Prealocação de cada arquivo de registro (MiB), 0 = desativada
+  Tuint32 prealocacaoRegistro;
+  // Formato dos arquivos de registro
+  TformatoRegistro formatoRegistro;
+  // Formato dos blocos enviados ao servidor (texto ou colunar)
+  TformatoRegistro formatoServidor;
+  // Latencia maxima de um quadro ate o fim do envio do bloco (ms)
+  Tuint32 latenciaBloco;
+  // Maior quantidade de mensagens de um bloco
+  Tuint32 maximoMensagensBloco;
+}Tconfiguracao;
+
+typedef Tconfiguracao *PTconfiguracao;
+
+// Contadores da fila de mensagens, escritos somente pelo produtor
+typedef struct SestatisticaFila{
+  // Mensagens inseridas na fila
+  Tuint32 enfileiradas;
+  // Mensagens antigas sobrescritas (eDescartaMaisAntiga)
+  Tuint32 sobrescritas;
+  // Mensagens recebidas descartadas (eDescartaMaisNova ou tempo de eBloqueia esgotado)
+  Tuint32 descartadas;
+  // Maior ocupação ja observada
+  Tuint32 marcaMaxima;
+  // Quantidade de vezes que a fila ficou cheia
+  Tuint32 eventosEstouro;
+}TestatisticaFila;
+
+typedef TestatisticaFila *PTestatisticaFila;
+
+// Estrutura de dados para a fila de mensagem CAN
+// Fila circular sem trava de um produtor (tarefa de captura) e um consumidor (tarefa de envio).
+// Os indices sao contadores livres, a posição no array é (indice & mascara)
+typedef struct SfilaMensagem{
+  /// Capacidade maxima da fila (potencia de 2)
+  Tuint32 capacidadeMax;
+  /// Mascara para converter indice em posição do array
+  Tuint32 mascara;
+  /// Ponteiro para o tipo mensagem CAN
+  PTmensagemCAN mensagem;
+  // Posição primeiro, avançada pelo consumidor (e pelo produtor ao sobrescrever o mais antigo)
+  volatile Tuint32 primeiro __attribute__((aligned(TAMANHO_LINHA_CACHE)));
+  // Posição ultimo, escrita somente pelo produtor
+  volatile Tuint32 ultimo __attribute__((aligned(TAMANHO_LINHA_CACHE)));
+  // Contadores da fila (mesma linha do ultimo, pois tambem sao escritos so pelo produtor)
+  volatile TestatisticaFila estatistica;
+  // A fila estava cheia na ultima inserção?
+  Tbool emEstouro;
+  // Politica adotada quando a fila esta cheia
+  TpoliticaEstouroFila politica;
+  // Tempo maximo de espera por espaço (ms), usado com eBloqueia
+  Tuint32 tempoBloqueio;
+
+}TfilaMensagem;
+
+// Definição do ponteiro
+typedef TfilaMensagem* PTfilaMensagem;
+
+// Estatistica de um identificador, escrita somente pela tarefa de captura. A leitura por outra tarefa 
+// usa a sequencia (seqlock): impar durante a escrita, a copia so vale se a sequencia nao mudou
+typedef struct SestatisticaId{
+  // Sequencia da ultima escrita
+  volatile Tuint32 sequencia;
+  // Identificador com as flags de tipo (FLAG_QUADRO_EXTENDIDO e FLAG_QUADRO_REMOTO)
+  Tuint32 identificador;
+  // Quadros recebidos
+  Tuint32 quantidade;
+  // Quadros recebidos na janela atual e taxa da ultima janela completa (mili quadros/s)
+  Tuint32 quantidadeJanela;
+  Tuint32 taxa;
+  // Menor e maior intervalo entre quadros (us)
+  Tuint32 intervaloMinimo;
+  Tuint32 intervaloMaximo;
+  // Soma dos intervalos (us), a media é soma / (quantidade - 1)
+  Tuint64 somaIntervalos;
+  // Inicio da janela atual e instante do ultimo quadro (esp_timer, us)
+  Tuint64 inicioJanela;
+  Tuint64 ultimo;
+  // Posição ocupada?
+  Tuint8 ocupada;
+  // Tamanho e dados do ultimo quadro
+  Tuint8 tamanho;
+  Tuint8 dados[TAMANHO_MAX_DADOS_QUADRO_CAN];
+}TestatisticaId;
+
+typedef TestatisticaId *PTestatisticaId;
+
+// Tabela de estatisticas por identificador: hash de endereçamento aberto (sondagem linear) com 
+// TAMANHO_TABELA_ESTATISTICA posições, um unico escritor (tarefa de captura)
+typedef struct StabelaEstatistica{
+  // Posições da tabela (NULL se nao foi possivel alocar)
+  PTestatisticaId entrada;
+  // Identificadores na tabela
+  volatile Tuint16 quantidade;
+  // Quadros de identificadores que nao couberam na tabela
+  volatile Tuint32 quadrosForaTabela;
+}TtabelaEstatistica;
+
+typedef TtabelaEstatistica *PTtabelaEstatistica;
+
+// Estado de erro do controlador, obtido do EFLG do MCP2515
+typedef enum EestadoBarramento {
+  eErroAtivo,     // contadores abaixo de 96
+  eErroAviso,     // TEC ou REC >= 96 (EWARN)
+  eErroPassivo,   // TEC ou REC >= 128 (TXEP/RXEP)
+  eBusOff         // TEC >= 256 (TXBO)
+}TestadoBarramento;
+
+// Amostra da saude do barramento: contadores do MCP2515 e carga estimada
+typedef struct SamostraSaude{
+  // Contadores de erro de transmissão e recepção (no modo somente escuta o TEC nao muda)
+  Tuint8 tec;
+  Tuint8 rec;
+  // Ultimo EFLG lido
+  Tuint8 eflg;
+  // Estado de erro
+  TestadoBarramento estado;
+  // Amostras em que o MCP2515 indicou quadro perdido por buffer cheio (RX0OVR/RX1OVR)
+  Tuint32 estourosRXB0;
+  Tuint32 estourosRXB1;
+  // Mudanças de estado de erro
+  Tuint32 transicoes;
+  // Carga do barramento na ultima janela (decimos de %): sem stuffing e com o pior caso de stuffing
+  Tuint16 cargaMinima;
+  Tuint16 cargaMaxima;
+}TamostraSaude;
+
+typedef TamostraSaude *PTamostraSaude;
+
+// Saude do barramento, escrita somente pela tarefa de captura. A leitura usa a sequencia (seqlock)
+typedef struct SsaudeBarramento{
+  // Sequencia da ultima escrita da amostra
+  volatile Tuint32 sequencia;
+  // Ultima amostra
+  TamostraSaude amostra;
+  // Eventos (mudança de estado ou estouro) desde o inicio, usado para escrever o marcador no registro
+  volatile Tuint32 eventos;
+  // Taxa do barramento (bits/s)
+  Tuint32 bitsPorSegundo;
+  // Bits observados na janela atual, sem stuffing e com o pior caso de stuffing
+  Tuint64 bitsMinimosJanela;
+  Tuint64 bitsMaximosJanela;
+  // Inicio da janela de carga e instante da ultima leitura dos contadores (esp_timer, us)
+  Tuint64 inicioJanela;
+  Tuint64 ultimaAmostra;
+}TsaudeBarramento;
+
+typedef TsaudeBarramento *PTsaudeBarramento;
+
+// Acesso da captura ao MCP2515. Na placa sao as leituras SPI, o pino INT e a notificação da tarefa
+// de protocolo_can.cpp; nos testes no computador, um MCP2515 simulado
+typedef struct SinterfaceMCP2515{
+  // Instrução RX STATUS
+  Tuint8 (*leStatusRX)(void);
+  // Instrução READ RX BUFFER (RXB0 ou RXB1) seguida da leitura de "tamanho" bytes, em uma janela de
+  // chip select. O RXnIF do buffer endereçado é limpo ao fim da janela
+  void (*leBufferRX)(Tuint8 instrucao, Tuint8 *buffer, Tuint8 tamanho);
+  // Instrução BIT MODIFY
+  void (*modificaBit)(Tuint8 registrador, Tuint8 mascara, Tuint8 valor);
+  // Instrução READ a partir de "registrador", lendo "tamanho" registradores seguidos
+  void (*leRegistros)(Tuint8 registrador, Tuint8 *dados, Tuint8 tamanho);
+  // Pino INT em nivel baixo?
+  Tbool (*interrupcaoAtiva)(void);
+  // Espera a notificação da borda do INT por no maximo "tempoMaximo" ms. Retorna as notificações
+  // recebidas (0 se a espera esgotou) e o instante da ultima borda
+  Tuint32 (*aguardaInterrupcao)(Tuint32 tempoMaximo, Tuint64 *tempoBorda);
+  // Relogio da captura (esp_timer, us)
+  Tuint64 (*tempo)(void);
+}TinterfaceMCP2515;
+
+typedef const TinterfaceMCP2515 *PTinterfaceMCP2515;
+
+// Estado da tarefa de captura
+typedef struct ScapturaMCP2515{
+  PTinterfaceMCP2515 mcp;
+  // Instante atribuido ao ultimo quadro: uma borda so vale para o primeiro quadro depois dela
+  Tuint64 ultimoTempo;
+  // Quadros lidos do MCP2515, escrito somente pela tarefa de captura
+  volatile Tuint32 quadrosCapturados;
+}TcapturaMCP2515;
+
+typedef TcapturaMCP2515 *PTcapturaMCP2515;
+
+// Lote de mensagens retirado de uma vez: ate dois trechos contiguos dentro do array da fila
+typedef struct SloteFila{
+  // Inicio de cada trecho (o segundo existe somente quando o lote da a volta no array)
+  PTmensagemCAN trecho[2];
+  // Quantidade de mensagens em cada trecho
+  Tuint32 quantidade[2];
+  // Indice do primeiro da fila quando o lote foi obtido
+  Tuint32 primeiro;
+}TloteFila;
+
+typedef TloteFila* PTloteFila;
+
+// Bloco de mensagens entregue aos armazenadores (cartao de memória e servidor)
+typedef struct SblocoMensagens{
+  // Mensagens do bloco
+  PTmensagemCAN mensagem;
+  // Quantidade de mensagens do bloco
+  Tuint32 quantidade;
+  // Mensagens perdidas na fila imediatamente antes da primeira mensagem do bloco
+  Tuint32 quadrosPerdidos;
+  // Mensagens suprimidas pelo registro de mudanças enquanto o bloco era montado
+  Tuint32 quadrosSuprimidos;
+  // Houve evento de saude do barramento antes da primeira mensagem do bloco? Se sim, vale a amostra
+  Tbool eventoSaude;
+  TamostraSaude saude;
+  // Instante (esp_timer, us) usado para reconstruir o tempo de 64 bits das mensagens
+  Tuint64 tempoReferencia;
+  // Hora do relogio (us desde 1970) correspondente a tempoReferencia
+  Tuint64 relogioReferencia;
+}TblocoMensagens;
+
+typedef TblocoMensagens* PTblocoMensagens;
+
+// Entrada do dicionario de identificadores de um bloco colunar
+typedef struct SentradaColunar{
+  // Identificador com as flags (extendido, remoto e erro)
+  Tuint32 identificador;
+  // Ultimos dados do identificador no bloco, base do XOR dos dados
+  Tuint8 anterior[TAMANHO_MAX_DADOS_QUADRO_CAN];
+}TentradaColunar;
+
+typedef TentradaColunar* PTentradaColunar;
+
+
+// Arquivo de registro mantido aberto entre os blocos, com flush por quantidade de bytes ou por tempo
+typedef struct SescritorRegistro{
+  // Arquivo de registro aberto (LOG-xxxx.txt)
+  File arquivo;
+  // Caminho do arquivo aberto, vazio se nao houver arquivo aberto
+  char caminho[TAMANHO_MAXIMO_NOME_ARQUIVO];
+  // Bytes escritos desde o ultimo flush
+  Tuint32 bytesPendentes;
+  // Instante do ultimo flush (ms)
+  Tempo ultimaDescarga;
+  // Politica de flush: bytes pendentes e tempo maximo (ms)
+  Tuint32 limiteBytes;
+  Tuint32 limiteTempo;
+  // Espaço livre no cartao, calculado na montagem e descontado a cada escrita
+  Tuint64 espacoLivre;
+  // Tamanho da prealocação de cada arquivo novo (bytes), 0 = desativada
+  Tuint32 tamanhoPrealocacao;
+  // O arquivo aberto foi prealocado? Tamanho logico (cabeçalho + dados) e tamanho ocupado no cartao
+  Tbool prealocado;
+  Tuint32 tamanhoLogico;
+  Tuint32 tamanhoFisico;
+  // O arquivo aberto é MF4? O tamanho do DT acompanha o flush e o arquivo é finalizado ao fechar.
+  // Nesse caso o tamanho logico é mantido tambem sem prealocação
+  Tbool mdf;
+  // Indice aberto (LOG-xxxx.idx) e o seu caminho, vazio se nao houver indice aberto
+  File indice;
+  char caminhoIndice[TAMANHO_MAXIMO_NOME_ARQUIVO];
+}TescritorRegistro;
+
+typedef TescritorRegistro *PTescritorRegistro;
+
+// Buffer de escrita no cartao, preenchido pelo consumidor e escrito pela tarefa de escrita
+typedef struct SbufferEscrita{
+  // Dados do buffer (TAMANHO_BUFFER_ESCRITA bytes)
+  Tuint8 *dados;
+  // Bytes ocupados
+  Tuint32 tamanho;
+  // Bytes que podem ser ocupados, o buffer cheio termina exatamente no fim de um setor do arquivo
+  Tuint32 limite;
+  // Arquivo de registro de destino
+  char caminho[TAMANHO_MAXIMO_NOME_ARQUIVO];
+  // Instante em que o primeiro byte foi colocado no buffer (ms)
+  Tempo inicio;
+  // Bytes do indice do mesmo arquivo (TAMANHO_BUFFER_INDICE), gravados depois dos dados
+  Tuint8 *indice;
+  Tuint32 tamanhoIndice;
+}TbufferEscrita;
+
+typedef TbufferEscrita *PTbufferEscrita;
+
+// Estagio de escrita no cartao: o consumidor preenche um buffer enquanto a tarefa de escrita grava o outro
+typedef struct SescritorCartao{
+  TbufferEscrita buffer[QUANTIDADE_BUFFERS_ESCRITA];
+  // Indices dos buffers cheios (para a tarefa de escrita) e livres (para o consumidor)
+  QueueHandle_t cheios;
+  QueueHandle_t livres;
+  // Buffer sendo preenchido pelo consumidor ou BUFFER_ESCRITA_NENHUM
+  Tuint8 atual;
+  // Arquivo do ultimo texto recebido e bytes dele depois do ultimo setor completo (consumidor)
+  char caminho[TAMANHO_MAXIMO_NOME_ARQUIVO];
+  Tuint32 desalinhamento;
+  // Tempo maximo que um dado pode ficar no buffer antes de ser entregue à tarefa de escrita (ms)
+  Tuint32 tempoMaximo;
+  // Ultimo erro da tarefa de escrita, SUCESSO se nao houve
+  Terro erro;
+  // Estatisticas: buffers gravados e maior tempo de gravação (tarefa de escrita),
+  // vezes que o consumidor esperou por um buffer livre (consumidor)
+  Tuint32 buffersEscritos;
+  Tuint32 latenciaMaxima;
+  Tuint32 esperas;
+}TescritorCartao;
+
+typedef TescritorCartao *PTescritorCartao;
+
+// Sessão HTTP com o servidor (snifferCan_servidor.cpp)
+typedef struct SsessaoServidor{
+  // VERDADEIRO entre o begin e o end do cliente HTTP
+  Tbool aberta;
+  // VERDADEIRO depois que o tipo do conteudo foi adicionado ao cabeçalho da sessão
+  Tbool cabecalho;
+  // Falhas seguidas de requisição e instante (millis) a partir do qual a reconexão é permitida
+  Tuint32 falhasSeguidas;
+  Tempo proximaConexao;
+  // Conexões abertas, um handshake TLS cada (estatistica)
+  Tuint32 conexoes;
+}TsessaoServidor;
+
+typedef TsessaoServidor *PTsessaoServidor;
+
+// Buffer de envio ao servidor, com um ou mais blocos formatados pelo consumidor
+typedef struct SbufferEnvio{
+  // Corpo da requisição (tamanhoBuffer bytes do enviador)
+  Tuint8 *dados;
+  // Bytes ocupados
+  Tuint32 tamanho;
+  // Blocos no buffer, mais de um quando a tarefa de envio esta atrasada
+  Tuint32 blocos;
+  // Fechamento do primeiro bloco do buffer (esp_timer, us), base do atraso do envio
+  Tuint64 inicio;
+}TbufferEnvio;
+
+typedef TbufferEnvio *PTbufferEnvio;
+
+// Estagio de envio ao servidor: o consumidor formata os blocos nos buffers e segue para o cartao,
+// enquanto a tarefa de envio faz as requisições. A rede lenta so atrasa ou descarta os envios
+typedef struct SenviadorServidor{
+  TbufferEnvio buffer[QUANTIDADE_BUFFERS_ENVIO];
+  Tuint32 tamanhoBuffer;
+  // Indices dos buffers cheios (para a tarefa de envio) e livres (para o consumidor)
+  QueueHandle_t cheios;
+  QueueHandle_t livres;
+  // Buffer sendo preenchido pelo consumidor ou BUFFER_ENVIO_NENHUM
+  Tuint8 atual;
+  // Destino das requisições e tipo do conteudo
+  TwifiConfig wifi;
+  char *url;
+  Tbool binario;
+  // FALSO depois que o wifi foi perdido (tarefa de envio)
+  Tbool ativo;
+  // VERDADEIRO enquanto a tarefa de envio trata um buffer
+  Tbool ocupado;
+  // Estatisticas: requisições, blocos enviados, requisições que falharam, maior atraso entre o
+  // fechamento de um bloco e o fim do seu envio (tarefa de envio), blocos descartados por falta de
+  // buffer (consumidor)
+  Tuint32 requisicoes;
+  Tuint32 blocosEnviados;
+  Tuint32 falhas;
+  Tuint32 atrasoMaximo;
+  Tuint32 descartados;
+}TenviadorServidor;
+
+typedef TenviadorServidor *PTenviadorServidor;
+
+// Arena dos buffers de formatação de cada bloco, reservada uma vez na inicialização (somente o consumidor)
+typedef struct SarenaBloco{
+  Tuint8 *memoria;
+  Tuint32 tamanho;
+  // Bytes tomados pelos buffers em uso
+  Tuint32 ocupado;
+  // Estatisticas: maior ocupação, buffers tomados e buffers que nao couberam
+  Tuint32 marcaMaxima;
+  Tuint32 reservas;
+  Tuint32 falhas;
+}TarenaBloco;
+
+typedef TarenaBloco *PTarenaBloco;
+
+// Tamanho do bloco: o consumidor fecha o bloco ao chegar em alvo mensagens ou depois do tempo de
+// enchimento, os dois recalculados a cada envio (somente o consumidor)
+typedef struct StamanhoBloco{
+  // Limites configurados: mensagens e latencia (us)
+  Tuint32 maximo;
+  Tuint32 latencia;
+  // Quantidade de mensagens e tempo (us) que fecham o bloco atual
+  Tuint32 alvo;
+  Tuint32 enchimento;
+  // Medias da vazão depois dos filtros (quadros/s) e do tempo de envio de um bloco (us)
+  Tuint32 quadrosPorSegundo;
+  Tuint32 tempoEnvio;
+}TtamanhoBloco;
+
+typedef TtamanhoBloco *PTtamanhoBloco;
+
+// Identificador no indice do arquivo de registro aberto
+typedef struct SentradaIndice{
+  // Identificador com as flags de tipo (FLAG_QUADRO_EXTENDIDO e FLAG_QUADRO_REMOTO)
+  Tuint32 identificador;
+  // Hora do primeiro e do ultimo quadro (us desde 1970)
+  Tuint64 primeiro;
+  Tuint64 ultimo;
+  // Quadros e baldes de tempo em que aparece
+  Tuint32 quadros;
+  Tuint32 baldes;
+  // Sequencia do ultimo balde em que apareceu
+  Tuint32 sequenciaBalde;
+  // Posição ocupada?
+  Tuint8 ocupada;
+}TentradaIndice;
+
+typedef TentradaIndice *PTentradaIndice;
+
+// Indice esparso do arquivo de registro aberto (formato_indice.h), montado pelo consumidor.
+// Tabela de identificadores: hash de endereçamento aberto com TAMANHO_TABELA_INDICE posições
+typedef struct SindiceRegistro{
+  // Posições da tabela (NULL se nao foi possivel alocar, indice desativado)
+  PTentradaIndice entrada;
+  // Identificadores na tabela e quadros dos que nao couberam
+  Tuint16 quantidade;
+  Tuint32 quadrosForaTabela;
+  // Arquivo de registro indexado, vazio se nenhum
+  char caminho[TAMANHO_MAXIMO_NOME_ARQUIVO];
+  // Bytes do registro e do indice ja entregues ao escritor
+  Tuint32 deslocamento;
+  Tuint32 tamanhoIndice;
+  // Balde aberto: sequencia (0 = nenhum) e numero (hora / LARGURA_BALDE_INDICE)
+  Tuint32 sequenciaBalde;
+  Tuint64 numeroBalde;
+  // Inicio do primeiro e fim do ultimo bloco com quadros do balde
+  Tuint32 inicioBalde;
+  Tuint32 fimBalde;
+  // Hora do primeiro e do ultimo quadro, quadros e flags do balde
+  Tuint64 primeiroBalde;
+  Tuint64 ultimoBalde;
+  Tuint32 quadrosBalde;
+  Tuint8 flagsBalde;
+  // Posições da tabela dos identificadores do balde (MAXIMA_QUANTIDADE_IDS_INDICE)
+  Tuint16 *idsBalde;
+  Tuint16 quantidadeIdsBalde;
+}TindiceRegistro;
+
+typedef TindiceRegistro *PTindiceRegistro;
+
+typedef struct SdescritorSniffer{
+  Tconfiguracao configuracao;
+  TfilaMensagem filaMensagem;
+  TfiltroSoftware filtroSoftware;
+  TregistroMudanca registroMudanca;
+  TtabelaEstatistica estatisticaId;
+  TsaudeBarramento saude;
+  TescritorCartao escritorCartao;
+  TenviadorServidor enviadorServidor;
+  TindiceRegistro indiceRegistro;
+  TarenaBloco arenaBloco;
+}TdescritorSniffer;
+
+typedef TdescritorSniffer *PTdescritorSniffer;
+
+
+typedef struct StabelaTaxas{
+  char descricao[50];
+  TaxaComunicacao taxa;  
+  Tuint32 bitsPorSegundo;
+}TtabelaTaxas;
+
+typedef TtabelaTaxas *PTtabelaTaxas;
+
 #endif // TIPO_H_INCLUDED
\ No newline at end of file
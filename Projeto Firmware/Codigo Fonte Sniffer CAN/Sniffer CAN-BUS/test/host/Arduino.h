@@ -0,0 +1,105 @@
+/**
+ * @file    Arduino.h
+ * @brief   Substituto do Arduino.h para os testes no computador (pio test -e native). Contem somente o
+ *          que os modulos testados usam: tipos e funções do FreeRTOS, tempo, pinos e o Serial. O tempo
+ *          vem do relogio monotonico, os semaforos sao mutex do pthread e os pinos nao fazem nada
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef ARDUINO_HOST_H_INCLUDED
+#define ARDUINO_HOST_H_INCLUDED
+
+/// Inclusões importantes
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+typedef uint8_t byte;
+
+/// Pinos
+#define HIGH            1
+#define LOW             0
+#define INPUT           0
+#define OUTPUT          1
+#define FALLING         2
+#define IRAM_ATTR
+
+static inline void pinMode(uint8_t pino, uint8_t modo){ (void)pino; (void)modo; }
+static inline void digitalWrite(uint8_t pino, uint8_t valor){ (void)pino; (void)valor; }
+static inline int digitalRead(uint8_t pino){ (void)pino; return LOW; }
+
+/// Tempo
+static inline uint64_t host_tempoMicrossegundos(void){
+  struct timespec agora;
+
+  (void)clock_gettime(CLOCK_MONOTONIC, &agora);
+  return (((uint64_t)agora.tv_sec * 1000000ULL) + ((uint64_t)agora.tv_nsec / 1000ULL));
+}
+static inline unsigned long millis(void){ return (unsigned long)(host_tempoMicrossegundos() / 1000ULL); }
+static inline unsigned long micros(void){ return (unsigned long)host_tempoMicrossegundos(); }
+static inline void delay(uint32_t ms){ (void)usleep(ms * 1000U); }
+
+/// FreeRTOS (um tick = 1 ms)
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void *TaskHandle_t;
+typedef void *QueueHandle_t;
+typedef pthread_mutex_t *SemaphoreHandle_t;
+typedef struct{ pthread_mutex_t trava; }portMUX_TYPE;
+
+#define pdTRUE                      1
+#define pdFALSE                     0
+#define portMAX_DELAY               0xFFFFFFFFU
+#define pdMS_TO_TICKS(ms)           ((TickType_t)(ms))
+#define portMUX_INITIALIZER_UNLOCKED  {PTHREAD_MUTEX_INITIALIZER}
+#define portENTER_CRITICAL(mux)     (void)pthread_mutex_lock(&(mux)->trava)
+#define portEXIT_CRITICAL(mux)      (void)pthread_mutex_unlock(&(mux)->trava)
+
+static inline void vTaskDelay(TickType_t ticks){ (void)usleep(ticks * 1000U); }
+
+static inline SemaphoreHandle_t xSemaphoreCreateMutex(void){
+  SemaphoreHandle_t semaforo = (SemaphoreHandle_t)malloc(sizeof(pthread_mutex_t));
+
+  if(semaforo != NULL){
+    (void)pthread_mutex_init(semaforo, NULL);
+  }
+  return semaforo;
+}
+static inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaforo, TickType_t espera){
+  (void)espera;
+  return (pthread_mutex_lock(semaforo) == 0) ? pdTRUE : pdFALSE;
+}
+static inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaforo){
+  return (pthread_mutex_unlock(semaforo) == 0) ? pdTRUE : pdFALSE;
+}
+
+/// Serial, escreve na saida padrão
+class HostSerial{
+public:
+  size_t print(const char *texto){ return (size_t)fputs(texto, stdout); }
+  size_t println(void){ return (size_t)fputs("\r\n", stdout); }
+  size_t println(const char *texto){ return print(texto) + println(); }
+  size_t println(int valor){ return (size_t)printf("%d\r\n", valor); }
+  size_t write(const uint8_t *dados, size_t tamanho){ return fwrite(dados, 1, tamanho, stdout); }
+  size_t printf(const char *formato, ...){
+    va_list argumentos;
+    int escritos;
+
+    va_start(argumentos, formato);
+    escritos = vprintf(formato, argumentos);
+    va_end(argumentos);
+    return (escritos < 0) ? 0 : (size_t)escritos;
+  }
+};
+
+static HostSerial Serial __attribute__((unused));
+
+#endif // ARDUINO_HOST_H_INCLUDED
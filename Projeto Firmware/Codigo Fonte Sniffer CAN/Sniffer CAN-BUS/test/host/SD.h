@@ -0,0 +1,15 @@
+/**
+ * @file    SD.h
+ * @brief   Substituto do SD.h para os testes no computador: o File só aparece como campo em tipos.h
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef SD_HOST_H_INCLUDED
+#define SD_HOST_H_INCLUDED
+
+class File{
+public:
+  operator bool() const { return false; }
+};
+
+#endif // SD_HOST_H_INCLUDED
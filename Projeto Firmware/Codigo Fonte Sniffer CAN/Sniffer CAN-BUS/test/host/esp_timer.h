@@ -0,0 +1,14 @@
+/**
+ * @file    esp_timer.h
+ * @brief   Substituto do esp_timer.h para os testes no computador: o esp_timer é o relogio monotonico
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef ESP_TIMER_HOST_H_INCLUDED
+#define ESP_TIMER_HOST_H_INCLUDED
+
+#include <Arduino.h>
+
+static inline int64_t esp_timer_get_time(void){ return (int64_t)host_tempoMicrossegundos(); }
+
+#endif // ESP_TIMER_HOST_H_INCLUDED
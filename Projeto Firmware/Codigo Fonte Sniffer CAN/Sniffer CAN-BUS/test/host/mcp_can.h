@@ -0,0 +1,17 @@
+/**
+ * @file    mcp_can.h
+ * @brief   Substituto do mcp_can.h para os testes no computador: somente as taxas usadas em tipos.h
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+#ifndef MCP_CAN_HOST_H_INCLUDED
+#define MCP_CAN_HOST_H_INCLUDED
+
+#include <stdint.h>
+
+enum{
+  CAN_4K096BPS, CAN_5KBPS, CAN_10KBPS, CAN_20KBPS, CAN_31K25BPS, CAN_33K3BPS, CAN_40KBPS, CAN_50KBPS,
+  CAN_80KBPS, CAN_100KBPS, CAN_125KBPS, CAN_200KBPS, CAN_250KBPS, CAN_500KBPS, CAN_1000KBPS
+};
+
+#endif // MCP_CAN_HOST_H_INCLUDED
@@ -0,0 +1,596 @@
+/**
+ * @file    test_main.cpp
+ * @brief   Testes da captura (captura_mcp2515.cpp) contra um MCP2515 simulado. O simulado tem os dois
+ *          buffers de recepção com rollover de RXB0 para RXB1, o estouro quando os dois estão cheios,
+ *          o INT em nivel baixo enquanto houver RXnIF e um relogio proprio que anda a cada operação SPI
+ *          e durante a espera. Cada borda de descida do INT notifica a captura, a menos que o teste
+ *          mande perder a borda. O TEC, o REC e o EFLG (com RX1OVR marcado a cada quadro perdido) sao lidos
+ *          pela amostra da saude do barramento, que limpa os bits de estouro.
+ *          Uso: pio test -e native -f test_captura_mcp2515
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include <unity.h>
+#include "captura_mcp2515.h"
+
+// Definições do simulado
+#define MAXIMO_QUADROS_SIMULADOS    4096
+#define TEMPO_BIT_500K              2       // us por bit a 500 kbit/s
+#define CUSTO_STATUS_RX             4       // us de uma instrução RX STATUS a 10 MHz com o overhead do driver
+#define CUSTO_BYTE_SPI              1       // us por byte transferido
+#define CUSTO_MODIFICA_BIT          4
+#define QUANTIDADE_REGISTROS_MCP    0x80
+#define TEMPO_INICIAL_SIMULADO      1000
+#define MAXIMO_CICLOS               100000
+#define DURACAO_MAXIMA_QUADRO       ((67 + 64 + 3) * TEMPO_BIT_500K)   // quadro extendido de 8 bytes
+
+typedef struct SquadroSimulado{
+  Tuint64 chegada;
+  Tuint32 identificador;   // ja com FLAG_QUADRO_EXTENDIDO / FLAG_QUADRO_REMOTO
+  Tuint8 dlc;              // DLC bruto, pode passar de 8
+  Tuint8 dados[TAMANHO_MAX_DADOS_QUADRO_CAN];
+  Tbool perdeBorda;        // a borda causada por este quadro nao notifica a captura
+  Tbool estourou;
+}TquadroSimulado;
+
+typedef struct SmcpSimulado{
+  Tuint64 relogio;
+  TquadroSimulado quadros[MAXIMO_QUADROS_SIMULADOS];
+  Tuint32 quantidade;
+  Tuint32 proximo;
+  Tuint8 rxb[2][MCP2515_TAMANHO_BUFFER_RX];
+  Tbool cheio[2];
+  Tbool intForcado;        // outra fonte de interrupção (erro, wake-up) com os buffers vazios
+  Tbool intAnterior;
+  Tuint32 notificacoes;
+  Tuint64 tempoBorda;
+  Tuint32 bordas;
+  Tuint32 bordasPerdidas;
+  Tuint32 esperasEsgotadas;
+  Tuint32 estouros;
+  Tuint32 leiturasStatus;
+  Tuint32 leiturasDuplas;
+  Tuint8 registros[QUANTIDADE_REGISTROS_MCP];   // TEC, REC e EFLG (os demais nao sao usados pela captura)
+  Tuint32 leiturasRegistros;
+  Tuint32 atrasoAcordar;   // us entre a notificação e a tarefa voltar a rodar (outras tarefas, ISR do WiFi)
+}TmcpSimulado;
+
+static TmcpSimulado sim;
+static TdescritorSniffer desc;
+static TcapturaMCP2515 captura;
+static TmensagemCAN recebidas[MAXIMO_QUADROS_SIMULADOS];
+static Tbool executando;
+
+/**
+ * @brief  Função que atualiza o nivel do INT e gera a borda de descida
+ * @param  quadro: quadro que causou a mudança, NULL se foi uma leitura
+ * @return void
+ */
+static void sim_atualizaInt(const TquadroSimulado *quadro){
+  Tbool nivel = (sim.cheio[0] || sim.cheio[1] || sim.intForcado);
+
+  if(nivel && !sim.intAnterior){
+    sim.bordas ++;
+    if((quadro != NULL) && quadro->perdeBorda){
+      sim.bordasPerdidas ++;
+    }else{
+      // A ISR guarda o instante da borda e notifica a tarefa
+      sim.notificacoes ++;
+      sim.tempoBorda = sim.relogio;
+    }
+  }
+  sim.intAnterior = nivel;
+}
+
+/**
+ * @brief  Função que monta os 13 bytes do buffer de recepção (SIDH, SIDL, EID8, EID0, DLC, D0..D7)
+ * @param  quadro: quadro recebido
+ * @param  buffer: buffer de recepção
+ * @return void
+ */
+static void sim_montaBuffer(const TquadroSimulado *quadro, Tuint8 *buffer){
+  Tuint32 id = (quadro->identificador & MASCARA_ID_EXTENDIDO);
+  Tbool remoto = ((quadro->identificador & FLAG_QUADRO_REMOTO) != 0);
+
+  if(quadro->identificador & FLAG_QUADRO_EXTENDIDO){
+    buffer[0] = (Tuint8)(id >> 21);
+    buffer[1] = (Tuint8)((((id >> 18) & 0x07) << 5) | MCP2515_BIT_EXIDE | ((id >> 16) & 0x03));
+    buffer[2] = (Tuint8)(id >> 8);
+    buffer[3] = (Tuint8)id;
+    buffer[4] = (Tuint8)((quadro->dlc & 0x0F) | (remoto ? MCP2515_BIT_RTR_EXTENDIDO : 0x00));
+  }else{
+    buffer[0] = (Tuint8)(id >> 3);
+    buffer[1] = (Tuint8)(((id & 0x07) << 5) | (remoto ? MCP2515_BIT_SRR : 0x00));
+    buffer[2] = 0x00;
+    buffer[3] = 0x00;
+    buffer[4] = (Tuint8)(quadro->dlc & 0x0F);
+  }
+  (void)memcpy(&buffer[5], quadro->dados, TAMANHO_MAX_DADOS_QUADRO_CAN);
+}
+
+/**
+ * @brief  Função que avança o relogio simulado, recebendo os quadros que chegaram nesse intervalo.
+ *         Como no MCP2515 com BUKT, o quadro vai para RXB0 e, se estiver cheio, para RXB1; com os dois
+ *         cheios o quadro é perdido (EFLG.RX0OVR / RX1OVR)
+ * @param  ate: novo instante do relogio
+ * @return void
+ */
+static void sim_avancaAte(Tuint64 ate){
+  TquadroSimulado *quadro;
+
+  while((sim.proximo < sim.quantidade) && (sim.quadros[sim.proximo].chegada <= ate)){
+    quadro = &sim.quadros[sim.proximo++];
+    if(quadro->chegada > sim.relogio){
+      sim.relogio = quadro->chegada;
+    }
+    if(!sim.cheio[0]){
+      sim_montaBuffer(quadro, sim.rxb[0]);
+      sim.cheio[0] = true;
+    }else if(!sim.cheio[1]){
+      sim_montaBuffer(quadro, sim.rxb[1]);
+      sim.cheio[1] = true;
+    }else{
+      // Com a rolagem, o quadro que nao cabe em RXB1 marca RX1OVR
+      quadro->estourou = true;
+      sim.estouros ++;
+      sim.registros[MCP2515_REG_EFLG] |= MCP2515_EFLG_RX1OVR;
+    }
+    sim_atualizaInt(quadro);
+  }
+  if(ate > sim.relogio){
+    sim.relogio = ate;
+  }
+}
+
+/// Interface do MCP2515 simulado
+static Tuint8 sim_leStatusRX(void){
+  Tuint8 status = ((sim.cheio[0] ? MCP2515_STATUS_RXB0_CHEIO : 0x00) | (sim.cheio[1] ? MCP2515_STATUS_RXB1_CHEIO : 0x00));
+
+  sim.leiturasStatus ++;
+  sim_avancaAte(sim.relogio + CUSTO_STATUS_RX);
+  return status;
+}
+
+static void sim_leBufferRX(Tuint8 instrucao, Tuint8 *buffer, Tuint8 tamanho){
+  Tuint8 i;
+
+  if(instrucao == MCP2515_INSTRUCAO_LE_RXB0){
+    if(tamanho == MCP2515_TAMANHO_LEITURA_RX){
+      sim.leiturasDuplas ++;
+    }
+    for(i=0; i<tamanho; i++){
+      if(i < MCP2515_TAMANHO_BUFFER_RX){
+        buffer[i] = sim.rxb[0][i];
+      }else if(i >= MCP2515_DISTANCIA_RXB0_RXB1){
+        buffer[i] = sim.rxb[1][i - MCP2515_DISTANCIA_RXB0_RXB1];
+      }else{
+        buffer[i] = 0xAA;   // CANSTAT, CANCTRL, RXB1CTRL
+      }
+    }
+  }else{
+    TEST_ASSERT_EQUAL_HEX8(MCP2515_INSTRUCAO_LE_RXB1, instrucao);
+    TEST_ASSERT_EQUAL_UINT8(MCP2515_TAMANHO_BUFFER_RX, tamanho);
+    (void)memcpy(buffer, sim.rxb[1], MCP2515_TAMANHO_BUFFER_RX);
+  }
+  sim_avancaAte(sim.relogio + 2 + (tamanho * CUSTO_BYTE_SPI));
+
+  // O READ RX BUFFER limpa o RXnIF do buffer em que começou quando o CS sobe
+  sim.cheio[(instrucao == MCP2515_INSTRUCAO_LE_RXB0) ? 0 : 1] = false;
+  sim_atualizaInt(NULL);
+}
+
+static void sim_modificaBit(Tuint8 registrador, Tuint8 mascara, Tuint8 valor){
+  sim_avancaAte(sim.relogio + CUSTO_MODIFICA_BIT);
+  // No EFLG somente RX0OVR e RX1OVR aceitam escrita
+  if(registrador == MCP2515_REG_EFLG){
+    mascara &= MCP2515_EFLG_ESTOUROS;
+    sim.registros[MCP2515_REG_EFLG] = ((sim.registros[MCP2515_REG_EFLG] & ~mascara) | (valor & mascara));
+    return;
+  }
+  TEST_ASSERT_EQUAL_HEX8(MCP2515_REG_CANINTF, registrador);
+  if((mascara & MCP2515_FLAG_RX0IF) && !(valor & MCP2515_FLAG_RX0IF)){
+    sim.cheio[0] = false;
+  }
+  if((mascara & MCP2515_FLAG_RX1IF) && !(valor & MCP2515_FLAG_RX1IF)){
+    sim.cheio[1] = false;
+  }
+  sim_atualizaInt(NULL);
+}
+
+static void sim_leRegistros(Tuint8 registrador, Tuint8 *dados, Tuint8 tamanho){
+  Tuint8 i;
+
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(QUANTIDADE_REGISTROS_MCP, (Tuint32)registrador + tamanho);
+  sim.leiturasRegistros ++;
+  sim_avancaAte(sim.relogio + 2 + (tamanho * CUSTO_BYTE_SPI));
+  for(i=0; i<tamanho; i++){
+    dados[i] = sim.registros[registrador + i];
+  }
+}
+
+static Tbool sim_interrupcaoAtiva(void){
+  return (sim.cheio[0] || sim.cheio[1] || sim.intForcado);
+}
+
+static Tuint32 sim_aguardaInterrupcao(Tuint32 tempoMaximo, Tuint64 *tempoBorda){
+  Tuint64 limite = (sim.relogio + ((Tuint64)tempoMaximo * 1000));
+  Tuint32 notificacoes;
+
+  // Bloqueado: o tempo anda ate a proxima notificação ou ate esgotar a espera
+  while((sim.notificacoes == 0) && (sim.proximo < sim.quantidade) && (sim.quadros[sim.proximo].chegada <= limite)){
+    sim_avancaAte(sim.quadros[sim.proximo].chegada);
+  }
+  if(sim.notificacoes == 0){
+    sim_avancaAte(limite);
+    sim.esperasEsgotadas ++;
+    return 0;
+  }
+  notificacoes = sim.notificacoes;
+  sim.notificacoes = 0;
+  *tempoBorda = sim.tempoBorda;
+  sim_avancaAte(sim.relogio + sim.atrasoAcordar);
+  return notificacoes;
+}
+
+static Tuint64 sim_tempo(void){
+  return sim.relogio;
+}
+
+static const TinterfaceMCP2515 mcpSimulado = {
+  sim_leStatusRX,
+  sim_leBufferRX,
+  sim_modificaBit,
+  sim_leRegistros,
+  sim_interrupcaoAtiva,
+  sim_aguardaInterrupcao,
+  sim_tempo
+};
+
+/**
+ * @brief  Função que calcula a duração de um quadro no barramento a 500 kbit/s (sem stuffing, pior caso
+ *         para a captura) incluindo o espaço entre quadros
+ * @param  quadro: quadro simulado
+ * @return duração em us
+ */
+static Tuint64 sim_duracaoQuadro(const TquadroSimulado *quadro){
+  Tuint8 dlc = ((quadro->dlc > TAMANHO_MAX_DADOS_QUADRO_CAN) ? TAMANHO_MAX_DADOS_QUADRO_CAN : quadro->dlc);
+  Tuint32 bits = ((quadro->identificador & FLAG_QUADRO_EXTENDIDO) ? 67 : 47);
+
+  if(!(quadro->identificador & FLAG_QUADRO_REMOTO)){
+    bits += (8 * dlc);
+  }
+  return ((Tuint64)(bits + 3) * TEMPO_BIT_500K);
+}
+
+/**
+ * @brief  Função que agenda uma rajada de quadros encostados no barramento. O numero de sequencia vai
+ *         nos 4 primeiros bytes de dados; os quadros pares são padrão e os impares extendidos
+ * @param  inicio: chegada do primeiro quadro
+ * @param  quantidade: quadros da rajada
+ * @param  perdeBorda: as bordas causadas pelos quadros da rajada nao notificam a captura
+ * @return instante do fim da rajada
+ */
+static Tuint64 sim_agendaRajada(Tuint64 inicio, Tuint32 quantidade, Tbool perdeBorda){
+  TquadroSimulado *quadro;
+  Tuint64 tempo = inicio;
+  Tuint32 i, sequencia;
+
+  for(i=0; i<quantidade; i++){
+    TEST_ASSERT_LESS_THAN_UINT32(MAXIMO_QUADROS_SIMULADOS, sim.quantidade);
+    sequencia = sim.quantidade;
+    quadro = &sim.quadros[sim.quantidade++];
+    (void)memset(quadro, 0x00, sizeof(TquadroSimulado));
+    quadro->identificador = ((sequencia & 1) ? (FLAG_QUADRO_EXTENDIDO | ((0x18DA0000U + sequencia) & MASCARA_ID_EXTENDIDO))
+                                             : (0x100U + (sequencia % 0x600U)));
+    quadro->dlc = TAMANHO_MAX_DADOS_QUADRO_CAN;
+    (void)memcpy(quadro->dados, &sequencia, sizeof(sequencia));
+    quadro->perdeBorda = perdeBorda;
+    // A chegada é o fim do quadro (o MCP2515 move o quadro para o buffer apos o EOF)
+    tempo += sim_duracaoQuadro(quadro);
+    quadro->chegada = tempo;
+  }
+  return tempo;
+}
+
+/**
+ * @brief  Função que executa a captura ate o simulado nao ter mais quadros, nem nos buffers
+ * @return void
+ */
+static void sim_executaCaptura(void){
+  Tuint32 ciclos = 0;
+
+  while((sim.proximo < sim.quantidade) || sim.cheio[0] || sim.cheio[1] || (sim.notificacoes > 0)){
+    TEST_ASSERT_EQUAL(SUCESSO, capturaMCP2515_executa(&captura, &desc, &executando));
+    TEST_ASSERT_LESS_THAN_UINT32_MESSAGE(MAXIMO_CICLOS, ++ciclos, "captura nao drena o simulado");
+  }
+}
+
+/**
+ * @brief  Função que retira da fila tudo o que a captura entregou
+ * @return quantidade de mensagens
+ */
+static Tuint32 sim_retiraFila(void){
+  Tuint32 quantidade = 0;
+
+  TEST_ASSERT_EQUAL(SUCESSO, filaMensagem_desenfileirarLote(&desc.filaMensagem, recebidas,
+                                                            MAXIMO_QUADROS_SIMULADOS, &quantidade));
+  return quantidade;
+}
+
+/**
+ * @brief  Função que confere se as mensagens recebidas são, em ordem, os quadros que nao estouraram,
+ *         e que o tempo de cada uma esta entre a chegada do quadro e a chegada mais a latencia maxima
+ * @param  quantidade: mensagens recebidas
+ * @param  latenciaMaxima: maior atraso aceito no tempo do quadro (us)
+ * @return maior atraso observado (us)
+ */
+static Tuint64 sim_confereEntrega(Tuint32 quantidade, Tuint64 latenciaMaxima){
+  const TquadroSimulado *quadro;
+  Tuint64 maiorAtraso = 0;
+  Tuint32 sequencia, i, esperado = 0;
+
+  for(i=0; i<quantidade; i++){
+    while((esperado < sim.quantidade) && sim.quadros[esperado].estourou){
+      esperado ++;
+    }
+    TEST_ASSERT_LESS_THAN_UINT32(sim.quantidade, esperado);
+    quadro = &sim.quadros[esperado];
+    (void)memcpy(&sequencia, recebidas[i].dados, sizeof(sequencia));
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(esperado, sequencia, "quadro fora de ordem");
+    TEST_ASSERT_EQUAL_HEX32(quadro->identificador, recebidas[i].identificador);
+    TEST_ASSERT_EQUAL_UINT32(TAMANHO_MAX_DADOS_QUADRO_CAN, recebidas[i].tamanho);
+
+    // O relogio simulado nao passa de MASCARA_TEMPO_QUADRO_CAN, entao o tempo da celula é o absoluto
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32_MESSAGE((Tuint32)quadro->chegada, recebidas[i].tempo, "tempo antes da chegada");
+    if((recebidas[i].tempo - quadro->chegada) > maiorAtraso){
+      maiorAtraso = (recebidas[i].tempo - quadro->chegada);
+    }
+    esperado ++;
+  }
+  TEST_ASSERT_LESS_OR_EQUAL_UINT64_MESSAGE(latenciaMaxima, maiorAtraso, "tempo do quadro atrasado demais");
+  return maiorAtraso;
+}
+
+void setUp(void){
+  (void)memset(&sim, 0x00, sizeof(sim));
+  sim.relogio = TEMPO_INICIAL_SIMULADO;
+  (void)memset((void *)&desc, 0x00, sizeof(desc));
+  TEST_ASSERT_EQUAL(SUCESSO, filaMensagem_inicializaFila(&desc.filaMensagem, MAXIMO_QUADROS_SIMULADOS));
+  TEST_ASSERT_EQUAL(SUCESSO, estatisticaId_inicializa(&desc.estatisticaId));
+  saudeBarramento_inicializa(&desc.saude, 500000);
+  capturaMCP2515_inicializa(&captura, &mcpSimulado);
+  executando = true;
+}
+
+void tearDown(void){
+  estatisticaId_finaliza(&desc.estatisticaId);
+  filaMensagem_finalizaFila(&desc.filaMensagem);
+}
+
+/**
+ * @brief  Rajada com o barramento saturado a 500 kbit/s: todos os quadros chegam em ordem, sem estouro,
+ *         e o tempo de cada um fica a no maximo um quadro da chegada
+ */
+static void test_rajadaSaturada(void){
+  Tuint32 quantidade;
+  Tuint64 atraso;
+  char texto[128];
+
+  (void)sim_agendaRajada(TEMPO_INICIAL_SIMULADO, 3000, false);
+  sim_executaCaptura();
+
+  quantidade = sim_retiraFila();
+  TEST_ASSERT_EQUAL_UINT32(0, sim.estouros);
+  TEST_ASSERT_EQUAL_UINT32(3000, quantidade);
+  TEST_ASSERT_EQUAL_UINT32(3000, captura.quadrosCapturados);
+  atraso = sim_confereEntrega(quantidade, DURACAO_MAXIMA_QUADRO);
+
+  (void)snprintf(texto, sizeof(texto), "3000 quadros: %u bordas, %u esperas esgotadas, %u RX STATUS, maior atraso %llu us",
+                 sim.bordas, sim.esperasEsgotadas, sim.leiturasStatus, (unsigned long long)atraso);
+  TEST_MESSAGE(texto);
+}
+
+/**
+ * @brief  Tarefa acordando atrasada com o barramento saturado: os dois buffers enchem e sao lidos na
+ *         mesma janela de chip select, ainda sem estouro e em ordem
+ */
+static void test_acordarAtrasado(void){
+  Tuint32 quantidade;
+  Tuint64 atraso;
+  char texto[128];
+
+  sim.atrasoAcordar = 400;
+  (void)sim_agendaRajada(TEMPO_INICIAL_SIMULADO, 3000, false);
+  sim_executaCaptura();
+
+  quantidade = sim_retiraFila();
+  TEST_ASSERT_EQUAL_UINT32(0, sim.estouros);
+  TEST_ASSERT_EQUAL_UINT32(3000, quantidade);
+  TEST_ASSERT_TRUE(sim.leiturasDuplas > 0);
+  atraso = sim_confereEntrega(quantidade, sim.atrasoAcordar + DURACAO_MAXIMA_QUADRO);
+
+  (void)snprintf(texto, sizeof(texto), "3000 quadros: %u bordas, %u leituras duplas, maior atraso %llu us",
+                 sim.bordas, sim.leiturasDuplas, (unsigned long long)atraso);
+  TEST_MESSAGE(texto);
+}
+
+/**
+ * @brief  Rajadas curtas com as bordas perdidas em metade delas: a espera limitada drena os buffers,
+ *         a captura nao fica parada com o INT em nivel baixo e entregues + estouros = enviados
+ */
+static void test_bordasPerdidas(void){
+  Tuint64 inicio = TEMPO_INICIAL_SIMULADO;
+  Tuint32 quantidade, r;
+
+  for(r=0; r<20; r++){
+    (void)sim_agendaRajada(inicio, 5, ((r & 1) != 0));
+    inicio += 20000;
+  }
+  sim_executaCaptura();
+
+  quantidade = sim_retiraFila();
+  TEST_ASSERT_EQUAL_UINT32(10, sim.bordasPerdidas);
+  TEST_ASSERT_TRUE(sim.esperasEsgotadas >= 10);
+  // Sem a borda, so os dois buffers seguram a rajada ate a espera esgotar: 3 quadros de 5 estouram
+  TEST_ASSERT_EQUAL_UINT32(30, sim.estouros);
+  TEST_ASSERT_EQUAL_UINT32(100, quantidade + sim.estouros);
+  TEST_ASSERT_EQUAL_UINT32(quantidade, captura.quadrosCapturados);
+  TEST_ASSERT_FALSE(sim_interrupcaoAtiva());
+  // Quadros drenados pela espera esgotada levam o instante da leitura, nunca o de uma borda antiga
+  (void)sim_confereEntrega(quantidade, ((Tuint64)TEMPO_MAXIMO_ESPERA_INTERRUPCAO * 1000) + 1000);
+}
+
+/**
+ * @brief  Quadro que chega entre a ultima leitura e a volta ao bloqueio: a borda nova fica pendente e
+ *         a proxima espera retorna na hora, sem esgotar
+ */
+static void test_quadroDuranteDrenagem(void){
+  Tuint32 quantidade;
+
+  // Dois quadros: o segundo chega durante o RX STATUS da drenagem do primeiro
+  (void)sim_agendaRajada(TEMPO_INICIAL_SIMULADO, 1, false);
+  sim.quadros[sim.quantidade] = sim.quadros[0];
+  sim.quadros[sim.quantidade].chegada = (sim.quadros[0].chegada + 2);
+  (void)memcpy(sim.quadros[sim.quantidade].dados, &sim.quantidade, sizeof(sim.quantidade));
+  sim.quantidade ++;
+
+  sim_executaCaptura();
+  quantidade = sim_retiraFila();
+  TEST_ASSERT_EQUAL_UINT32(2, quantidade);
+  TEST_ASSERT_EQUAL_UINT32(0, sim.estouros);
+  TEST_ASSERT_EQUAL_UINT32(0, sim.esperasEsgotadas);
+  (void)sim_confereEntrega(quantidade, 20);
+}
+
+/**
+ * @brief  INT ativo por outra fonte com os buffers vazios: a drenagem sai depois de um RX STATUS, sem
+ *         prender a tarefa em laço
+ */
+static void test_interrupcaoSemMensagem(void){
+  sim.intForcado = true;
+  sim_atualizaInt(NULL);
+
+  TEST_ASSERT_EQUAL(SUCESSO, capturaMCP2515_executa(&captura, &desc, &executando));
+  TEST_ASSERT_EQUAL_UINT32(1, sim.leiturasStatus);
+  TEST_ASSERT_EQUAL_UINT32(0, captura.quadrosCapturados);
+  TEST_ASSERT_EQUAL_UINT32(0, filaMensagem_tamanhoFila(&desc.filaMensagem));
+}
+
+/**
+ * @brief  Decodificação dos buffers: identificador padrão e extendido, RTR nos dois formatos e DLC
+ *         acima de 8 limitado a 8 bytes
+ */
+static void test_decodificacao(void){
+  static const Tuint32 identificadores[] = {
+    0x7FFU,
+    (0x123U | FLAG_QUADRO_REMOTO),
+    (FLAG_QUADRO_EXTENDIDO | 0x1FFFFFFFU),
+    (FLAG_QUADRO_EXTENDIDO | FLAG_QUADRO_REMOTO | 0x00ABCDEFU),
+  };
+  static const Tuint8 dlcs[] = {15, 0, 3, 8};
+  Tuint32 quantidade, i;
+  Tuint64 tempo = TEMPO_INICIAL_SIMULADO;
+
+  for(i=0; i<(sizeof(dlcs) / sizeof(dlcs[0])); i++){
+    (void)memset(&sim.quadros[i], 0x00, sizeof(TquadroSimulado));
+    sim.quadros[i].identificador = identificadores[i];
+    sim.quadros[i].dlc = dlcs[i];
+    (void)memset(sim.quadros[i].dados, (int)(0xA0 + i), TAMANHO_MAX_DADOS_QUADRO_CAN);
+    tempo += 1000;
+    sim.quadros[i].chegada = tempo;
+  }
+  sim.quantidade = i;
+  sim_executaCaptura();
+
+  quantidade = sim_retiraFila();
+  TEST_ASSERT_EQUAL_UINT32(4, quantidade);
+  for(i=0; i<quantidade; i++){
+    TEST_ASSERT_EQUAL_HEX32(identificadores[i], recebidas[i].identificador);
+    TEST_ASSERT_EQUAL_UINT32(((dlcs[i] > 8) ? 8 : dlcs[i]), recebidas[i].tamanho);
+    TEST_ASSERT_EQUAL_HEX8((0xA0 + i), recebidas[i].dados[0]);
+    // Cada quadro chegou sozinho, entao leva o instante exato da borda
+    TEST_ASSERT_EQUAL_UINT32((Tuint32)sim.quadros[i].chegada, recebidas[i].tempo);
+  }
+}
+
+/**
+ * @brief  Fila cheia com eDescartaMaisNova: a captura segue drenando o MCP2515 e a fila conta os descartes
+ */
+static void test_filaCheia(void){
+  TestatisticaFila estatistica;
+
+  filaMensagem_finalizaFila(&desc.filaMensagem);
+  TEST_ASSERT_EQUAL(SUCESSO, filaMensagem_inicializaFila(&desc.filaMensagem, 16));
+  filaMensagem_configuraPolitica(&desc.filaMensagem, eDescartaMaisNova, 0);
+
+  (void)sim_agendaRajada(TEMPO_INICIAL_SIMULADO, 100, false);
+  sim_executaCaptura();
+
+  filaMensagem_obtemEstatistica(&desc.filaMensagem, &estatistica);
+  TEST_ASSERT_EQUAL_UINT32(0, sim.estouros);
+  TEST_ASSERT_EQUAL_UINT32(100, captura.quadrosCapturados);
+  TEST_ASSERT_EQUAL_UINT32(100, estatistica.enfileiradas + estatistica.descartadas);
+  TEST_ASSERT_EQUAL_UINT32(filaMensagem_tamanhoFila(&desc.filaMensagem), estatistica.enfileiradas);
+}
+
+/**
+ * @brief  Amostra da saude depois de quadros perdidos: o RX1OVR conta um estouro, os contadores e o
+ *         estado de erro vem do MCP2515, os bits de estouro sao limpos e os demais bits do EFLG ficam.
+ *         Antes de INTERVALO_AMOSTRA_SAUDE nada é lido, e sem novo estouro a contagem nao muda
+ */
+static void test_amostraSaude(void){
+  TamostraSaude amostra;
+
+  sim.registros[MCP2515_REG_TEC] = 0;
+  sim.registros[MCP2515_REG_TEC + 1] = 130;
+  sim.registros[MCP2515_REG_EFLG] = (MCP2515_EFLG_EWARN | MCP2515_EFLG_RXWAR | MCP2515_EFLG_RXEP);
+
+  // Borda perdida: os dois buffers seguram a rajada e 3 quadros de 5 estouram
+  (void)sim_agendaRajada(TEMPO_INICIAL_SIMULADO, 5, true);
+  sim_executaCaptura();
+  TEST_ASSERT_EQUAL_UINT32(3, sim.estouros);
+  TEST_ASSERT_EQUAL_HEX8((MCP2515_EFLG_EWARN | MCP2515_EFLG_RXWAR | MCP2515_EFLG_RXEP | MCP2515_EFLG_RX1OVR),
+                         sim.registros[MCP2515_REG_EFLG]);
+
+  sim_avancaAte(sim.relogio + INTERVALO_AMOSTRA_SAUDE);
+  capturaMCP2515_amostraSaude(&captura, &desc.saude);
+  saudeBarramento_le(&desc.saude, &amostra);
+  TEST_ASSERT_EQUAL_UINT32(2, sim.leiturasRegistros);
+  TEST_ASSERT_EQUAL_UINT8(0, amostra.tec);
+  TEST_ASSERT_EQUAL_UINT8(130, amostra.rec);
+  TEST_ASSERT_EQUAL_HEX8((MCP2515_EFLG_EWARN | MCP2515_EFLG_RXWAR | MCP2515_EFLG_RXEP | MCP2515_EFLG_RX1OVR), amostra.eflg);
+  TEST_ASSERT_EQUAL(eErroPassivo, amostra.estado);
+  TEST_ASSERT_EQUAL_UINT32(0, amostra.estourosRXB0);
+  TEST_ASSERT_EQUAL_UINT32(1, amostra.estourosRXB1);
+  TEST_ASSERT_EQUAL_HEX8((MCP2515_EFLG_EWARN | MCP2515_EFLG_RXWAR | MCP2515_EFLG_RXEP), sim.registros[MCP2515_REG_EFLG]);
+
+  // Antes do intervalo a amostra nao acessa o MCP2515
+  capturaMCP2515_amostraSaude(&captura, &desc.saude);
+  TEST_ASSERT_EQUAL_UINT32(2, sim.leiturasRegistros);
+
+  // Sem novo estouro o EFLG ja limpo nao conta de novo
+  sim_avancaAte(sim.relogio + INTERVALO_AMOSTRA_SAUDE);
+  capturaMCP2515_amostraSaude(&captura, &desc.saude);
+  saudeBarramento_le(&desc.saude, &amostra);
+  TEST_ASSERT_EQUAL_UINT32(4, sim.leiturasRegistros);
+  TEST_ASSERT_EQUAL_UINT32(1, amostra.estourosRXB1);
+  TEST_ASSERT_EQUAL_HEX8((MCP2515_EFLG_EWARN | MCP2515_EFLG_RXWAR | MCP2515_EFLG_RXEP), amostra.eflg);
+}
+
+int main(int argc, char **argv){
+  (void)argc;
+  (void)argv;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_rajadaSaturada);
+  RUN_TEST(test_acordarAtrasado);
+  RUN_TEST(test_bordasPerdidas);
+  RUN_TEST(test_quadroDuranteDrenagem);
+  RUN_TEST(test_interrupcaoSemMensagem);
+  RUN_TEST(test_decodificacao);
+  RUN_TEST(test_filaCheia);
+  RUN_TEST(test_amostraSaude);
+  return UNITY_END();
+}
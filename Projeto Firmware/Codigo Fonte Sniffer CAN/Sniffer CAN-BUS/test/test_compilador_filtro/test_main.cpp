@@ -0,0 +1,393 @@
+/**
+ * @file    test_main.cpp
+ * @brief   Testes do compilador de filtros (compilador_filtro.cpp). Cada programação calculada é
+ *          conferida contra a aceitação do MCP2515 (mascara e filtros por tipo de quadro): todo
+ *          identificador da lista deve passar e a razão de falsos aceitos medida deve bater com a
+ *          estimativa do compilador. As razões medidas sao mostradas para cada conjunto.
+ *          Uso: pio test -e native -f test_compilador_filtro
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include <unity.h>
+#include "compilador_filtro.h"
+#include "filtro_software.h"
+
+// Definições do teste
+#define TAMANHO_MAXIMO_LISTA_TESTE    2048
+#define TOLERANCIA_RAZAO              0.001f
+#define BITS_ID_PADRAO_TESTE          11
+#define BITS_ID_EXTENDIDO_TESTE       29
+
+typedef struct SmedidaFiltro{
+  double aceitos;
+  double desejados;
+  double falsos;
+  double razao;
+}TmedidaFiltro;
+
+static TprogramacaoFiltro programacao;
+static TfiltroSoftware filtro;
+static char lista[TAMANHO_MAXIMO_LISTA_TESTE];
+static char taxas[TAMANHO_MAXIMO_LISTA_TESTE];
+static Tuint32 semente;
+
+/**
+ * @brief  Função que gera numeros pseudo aleatorios (LCG), repetiveis entre execuções
+ * @return proximo numero
+ */
+static Tuint32 teste_aleatorio(void){
+  semente = ((semente * 1103515245U) + 12345U);
+  return (semente >> 8);
+}
+
+/**
+ * @brief  Função que indica o indice da mascara de um filtro (filtros 0 e 1 na mascara 0, 2 a 5 na 1)
+ * @param  f: indice do filtro
+ * @return indice da mascara
+ */
+static Tuint8 teste_mascaraDoFiltro(Tuint8 f){
+  return ((f < QUANTIDADE_FILTROS_MASCARA_0) ? 0 : 1);
+}
+
+/**
+ * @brief  Função que aplica a programação como o MCP2515: o quadro passa se algum filtro de uma mascara
+ *         do mesmo tipo concordar com o identificador nos bits da mascara
+ * @param  id: identificador
+ * @param  extendido: tipo do quadro
+ * @return VERDADEIRO se o hardware aceita o quadro
+ */
+static Tbool teste_aceitaHardware(Tuint32 id, Tbool extendido){
+  Tuint8 f, m;
+
+  for(f=0; f<MAXIMA_QUANTIDADE_FILTROS; f++){
+    m = teste_mascaraDoFiltro(f);
+    if((programacao.extendido[m] == extendido) &&
+       ((id & programacao.mascara[m]) == (programacao.filtro[f] & programacao.mascara[m]))){
+      return VERDADEIRO;
+    }
+  }
+  return FALSO;
+}
+
+/**
+ * @brief  Função que conta, de forma exata, quantos identificadores de um tipo o hardware aceita.
+ *         Filtros distintos de uma mascara aceitam conjuntos disjuntos; entre as duas mascaras a
+ *         intersecção é descontada (inclusão e exclusão)
+ * @param  extendido: tipo do quadro
+ * @return quantidade de identificadores aceitos
+ */
+static double teste_contaAceitos(Tbool extendido){
+  Tuint32 valor[MAXIMA_QUANTIDADE_MASCARAS][MAXIMA_QUANTIDADE_FILTROS];
+  Tuint8 quantidade[MAXIMA_QUANTIDADE_MASCARAS] = {0, 0};
+  Tuint8 bits = (extendido ? BITS_ID_EXTENDIDO_TESTE : BITS_ID_PADRAO_TESTE);
+  Tuint32 comum;
+  Tuint8 f, m, i, j;
+  Tbool repetido;
+  double total = 0;
+
+  // Valores distintos de cada mascara do tipo pedido
+  for(f=0; f<MAXIMA_QUANTIDADE_FILTROS; f++){
+    m = teste_mascaraDoFiltro(f);
+    if(programacao.extendido[m] != extendido){
+      continue;
+    }
+    repetido = FALSO;
+    for(i=0; i<quantidade[m]; i++){
+      repetido |= (valor[m][i] == (programacao.filtro[f] & programacao.mascara[m]));
+    }
+    if(!repetido){
+      valor[m][quantidade[m]++] = (programacao.filtro[f] & programacao.mascara[m]);
+    }
+  }
+  for(m=0; m<MAXIMA_QUANTIDADE_MASCARAS; m++){
+    total += ((double)quantidade[m] * ldexp(1.0, (bits - __builtin_popcount(programacao.mascara[m]))));
+  }
+
+  // Intersecção entre as duas mascaras
+  comum = (programacao.mascara[0] & programacao.mascara[1]);
+  for(i=0; i<quantidade[0]; i++){
+    for(j=0; j<quantidade[1]; j++){
+      if((valor[0][i] & comum) == (valor[1][j] & comum)){
+        total -= ldexp(1.0, (bits - __builtin_popcount(programacao.mascara[0] | programacao.mascara[1])));
+      }
+    }
+  }
+  return total;
+}
+
+/**
+ * @brief  Função que compila a lista, confere a programação e mede a razão de falsos aceitos
+ *         (identificadores aceitos pelo hardware e descartados pelo filtro de software / aceitos)
+ * @param  idsExtendidos: identificadores extendidos da lista, para conferir que todos passam
+ * @param  quantidadeExtendidos: quantidade de identificadores extendidos
+ * @param  nome: nome do conjunto, para a mensagem
+ * @return medida
+ */
+static TmedidaFiltro teste_compilaEMede(const Tuint32 *idsExtendidos, Tuint32 quantidadeExtendidos, const char *nome){
+  TmedidaFiltro medida;
+  TmensagemCAN mensagem;
+  Tuint32 id, aceitosPadrao = 0;
+  char texto[200];
+
+  TEST_ASSERT_EQUAL(SUCESSO, compiladorFiltro_compila(lista, taxas, &programacao));
+  TEST_ASSERT_TRUE(programacao.valida);
+  TEST_ASSERT_EQUAL(SUCESSO, filtroSoftware_compila(&filtro, lista));
+  (void)memset(&mensagem, 0x00, sizeof(mensagem));
+  (void)memset(&medida, 0x00, sizeof(medida));
+
+  // Padrao: todos os 2048 identificadores
+  for(id=0; id<=MASCARA_ID_PADRAO; id++){
+    mensagem.identificador = id;
+    if(filtroSoftware_aceita(&filtro, &mensagem)){
+      medida.desejados ++;
+      TEST_ASSERT_TRUE_MESSAGE(teste_aceitaHardware(id, FALSO), "identificador padrao desejado rejeitado");
+    }
+    if(teste_aceitaHardware(id, FALSO)){
+      aceitosPadrao ++;
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32((Tuint32)teste_contaAceitos(FALSO), aceitosPadrao);
+
+  // Extendido: os identificadores da lista passam, os aceitos sao contados sem enumerar 2^29
+  for(id=0; id<quantidadeExtendidos; id++){
+    mensagem.identificador = (FLAG_QUADRO_EXTENDIDO | idsExtendidos[id]);
+    TEST_ASSERT_TRUE(filtroSoftware_aceita(&filtro, &mensagem));
+    TEST_ASSERT_TRUE_MESSAGE(teste_aceitaHardware(idsExtendidos[id], VERDADEIRO), "identificador extendido desejado rejeitado");
+  }
+  medida.desejados += quantidadeExtendidos;
+  medida.aceitos = ((double)aceitosPadrao + teste_contaAceitos(VERDADEIRO));
+  medida.falsos = (medida.aceitos - medida.desejados);
+  medida.razao = (medida.falsos / medida.aceitos);
+
+  (void)snprintf(texto, sizeof(texto), "%s: %.0f desejados, %.0f falsos aceitos, razao %.6f (estimada %.6f)",
+                 nome, medida.desejados, medida.falsos, medida.razao, (double)programacao.razaoFalsosAceitos);
+  TEST_MESSAGE(texto);
+  return medida;
+}
+
+/**
+ * @brief  Função que acrescenta um identificador ao fim da lista
+ * @param  destino: lista
+ * @param  formato: formato do identificador ("%03X" padrao, "%08X" extendido)
+ * @param  id: identificador
+ * @return void
+ */
+static void teste_acrescenta(char *destino, const char *formato, Tuint32 id){
+  size_t tamanho = strlen(destino);
+
+  if(tamanho > 0){
+    destino[tamanho++] = ';';
+  }
+  (void)snprintf(&destino[tamanho], (TAMANHO_MAXIMO_LISTA_TESTE - tamanho), formato, id);
+}
+
+void setUp(void){
+  lista[0] = '\0';
+  taxas[0] = '\0';
+  semente = 2026;
+}
+
+void tearDown(void){
+}
+
+/**
+ * @brief  Ate 6 identificadores de um tipo cabem um por filtro: nenhum falso aceito
+ */
+static void test_ateSeisPadrao(void){
+  TmedidaFiltro medida;
+
+  (void)strcpy(lista, "100;1A5;2F0;3C1;555;7E8");
+  medida = teste_compilaEMede(NULL, 0, "6 padrao");
+  TEST_ASSERT_EQUAL_UINT32(0, (Tuint32)medida.falsos);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, programacao.razaoFalsosAceitos);
+}
+
+/**
+ * @brief  Ate 6 identificadores extendidos, um por filtro: nenhum falso aceito
+ */
+static void test_ateSeisExtendido(void){
+  static const Tuint32 ids[] = {0x18DAF110, 0x18DA10F1, 0x0CF00400, 0x18FEF100, 0x1FFFFFFF, 0x00000001};
+  TmedidaFiltro medida;
+  Tuint8 i;
+
+  for(i=0; i<6; i++){
+    teste_acrescenta(lista, "%08X", ids[i]);
+  }
+  medida = teste_compilaEMede(ids, 6, "6 extendido");
+  TEST_ASSERT_EQUAL_UINT32(0, (Tuint32)medida.falsos);
+}
+
+/**
+ * @brief  Coringa padrao (7XX) conta como um grupo de 256 identificadores desejados
+ */
+static void test_coringaPadrao(void){
+  TmedidaFiltro medida;
+
+  (void)strcpy(lista, "7XX;100;200");
+  medida = teste_compilaEMede(NULL, 0, "7XX + 2 padrao");
+  TEST_ASSERT_EQUAL_UINT32(258, (Tuint32)medida.desejados);
+  TEST_ASSERT_EQUAL_UINT32(0, (Tuint32)medida.falsos);
+}
+
+/**
+ * @brief  Mais de 6 identificadores padrao: faixa de diagnostico (7E0..7EF sem 7E9) e 20 aleatorios
+ */
+static void test_maisDeSeisPadrao(void){
+  TmedidaFiltro medida;
+  Tuint32 id;
+
+  for(id=0x7E0; id<=0x7EF; id++){
+    if(id != 0x7E9){
+      teste_acrescenta(lista, "%03X", id);
+    }
+  }
+  medida = teste_compilaEMede(NULL, 0, "15 padrao em faixa");
+  TEST_ASSERT_FLOAT_WITHIN(TOLERANCIA_RAZAO, (float)medida.razao, programacao.razaoFalsosAceitos);
+  // A faixa inteira cabe em poucos filtros: no maximo o 7E9 passa a mais
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(1, (Tuint32)medida.falsos);
+
+  lista[0] = '\0';
+  for(id=0; id<20; id++){
+    teste_acrescenta(lista, "%03X", (teste_aleatorio() & MASCARA_ID_PADRAO));
+  }
+  medida = teste_compilaEMede(NULL, 0, "20 padrao aleatorios");
+  TEST_ASSERT_FLOAT_WITHIN(TOLERANCIA_RAZAO, (float)medida.razao, programacao.razaoFalsosAceitos);
+  TEST_ASSERT_TRUE(medida.razao < 1.0);
+}
+
+/**
+ * @brief  Mais de 6 identificadores extendidos: grupo J1939 (PGNs proximos) e 16 aleatorios
+ */
+static void test_maisDeSeisExtendido(void){
+  Tuint32 ids[16];
+  TmedidaFiltro medida;
+  Tuint8 i;
+
+  for(i=0; i<12; i++){
+    ids[i] = (0x18FEE000 + ((Tuint32)i << 8) + 0x00);
+    teste_acrescenta(lista, "%08X", ids[i]);
+  }
+  medida = teste_compilaEMede(ids, 12, "12 extendido J1939");
+  TEST_ASSERT_FLOAT_WITHIN(TOLERANCIA_RAZAO, (float)medida.razao, programacao.razaoFalsosAceitos);
+
+  lista[0] = '\0';
+  for(i=0; i<16; i++){
+    ids[i] = (teste_aleatorio() & MASCARA_ID_EXTENDIDO);
+    teste_acrescenta(lista, "%08X", ids[i]);
+  }
+  medida = teste_compilaEMede(ids, 16, "16 extendido aleatorios");
+  TEST_ASSERT_FLOAT_WITHIN(TOLERANCIA_RAZAO, (float)medida.razao, programacao.razaoFalsosAceitos);
+}
+
+/**
+ * @brief  Padrao e extendido misturados: cada mascara fica com um tipo
+ */
+static void test_misturado(void){
+  static const Tuint32 ids[] = {0x18DAF110, 0x18DAF111, 0x18DA10F1, 0x0CF00400};
+  TmedidaFiltro medida;
+  Tuint8 i;
+
+  (void)strcpy(lista, "7E0;7E8;100");
+  for(i=0; i<4; i++){
+    teste_acrescenta(lista, "%08X", ids[i]);
+  }
+  medida = teste_compilaEMede(ids, 4, "3 padrao + 4 extendido");
+  TEST_ASSERT_TRUE(programacao.extendido[0] != programacao.extendido[1]);
+  TEST_ASSERT_FLOAT_WITHIN(TOLERANCIA_RAZAO, (float)medida.razao, programacao.razaoFalsosAceitos);
+}
+
+/**
+ * @brief  Função que diz se o identificador ja esta no array
+ * @param  ids: array
+ * @param  quantidade: quantidade de identificadores no array
+ * @param  id: identificador procurado
+ * @return VERDADEIRO se estiver
+ */
+static Tbool teste_contem(const Tuint32 *ids, Tuint32 quantidade, Tuint32 id){
+  Tuint32 i;
+
+  for(i=0; i<quantidade; i++){
+    if(ids[i] == id){
+      return VERDADEIRO;
+    }
+  }
+  return FALSO;
+}
+
+/**
+ * @brief  Com o perfil de taxas do barramento a razão é sobre o trafego: a estimativa deve bater com
+ *         o trafego indesejado medido e nao pode ser pior que a da programação feita sem o perfil
+ */
+static void test_perfilTaxas(void){
+  Tuint32 desejados[10], ruido[40], taxaRuido[40];
+  TmensagemCAN mensagem;
+  double taxaFalsa, razao[2];
+  Tuint32 id, i, bit;
+  Tuint8 passo;
+  char texto[160];
+
+  // 10 identificadores desejados a 10 quadros/s e 40 vizinhos (um bit de diferença) no barramento,
+  // de 1 a 100 quadros/s: sao os que os agrupamentos das mascaras deixam passar
+  for(i=0; i<10; i++){
+    do{
+      id = (teste_aleatorio() & MASCARA_ID_PADRAO);
+    }while(teste_contem(desejados, i, id));
+    desejados[i] = id;
+    teste_acrescenta(lista, "%03X", id);
+  }
+  for(i=0, bit=(i / 10); i<40; i++, bit=(i / 10)){
+    do{
+      id = (desejados[i % 10] ^ (1UL << (bit++ % BITS_ID_PADRAO_TESTE)));
+    }while(teste_contem(desejados, 10, id) || teste_contem(ruido, i, id));
+    ruido[i] = id;
+    taxaRuido[i] = (1 + (teste_aleatorio() % 100));
+  }
+
+  for(passo=0; passo<2; passo++){
+    taxas[0] = '\0';
+    if(passo == 1){
+      for(i=0; i<10; i++){
+        teste_acrescenta(taxas, "%03X=10", desejados[i]);
+      }
+      for(i=0; i<40; i++){
+        teste_acrescenta(taxas, "%03X", ruido[i]);
+        (void)snprintf(&taxas[strlen(taxas)], (TAMANHO_MAXIMO_LISTA_TESTE - strlen(taxas)), "=%u", taxaRuido[i]);
+      }
+    }
+    (void)teste_compilaEMede(NULL, 0, ((passo == 0) ? "10 padrao sem perfil" : "10 padrao com perfil"));
+
+    // Trafego indesejado que o hardware deixa passar
+    (void)memset(&mensagem, 0x00, sizeof(mensagem));
+    taxaFalsa = 0;
+    for(i=0; i<40; i++){
+      mensagem.identificador = ruido[i];
+      TEST_ASSERT_FALSE(filtroSoftware_aceita(&filtro, &mensagem));
+      if(teste_aceitaHardware(ruido[i], FALSO)){
+        taxaFalsa += (double)taxaRuido[i];
+      }
+    }
+    razao[passo] = (taxaFalsa / (taxaFalsa + (10.0 * 10.0)));
+  }
+
+  TEST_ASSERT_FLOAT_WITHIN(TOLERANCIA_RAZAO, (float)razao[1], programacao.razaoFalsosAceitos);
+  TEST_ASSERT_TRUE(razao[1] <= razao[0]);
+  (void)snprintf(texto, sizeof(texto), "trafego falso aceito: razao %.4f sem perfil, %.4f com perfil", razao[0], razao[1]);
+  TEST_MESSAGE(texto);
+}
+
+int main(int argc, char **argv){
+  (void)argc;
+  (void)argv;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_ateSeisPadrao);
+  RUN_TEST(test_ateSeisExtendido);
+  RUN_TEST(test_coringaPadrao);
+  RUN_TEST(test_maisDeSeisPadrao);
+  RUN_TEST(test_maisDeSeisExtendido);
+  RUN_TEST(test_misturado);
+  RUN_TEST(test_perfilTaxas);
+  return UNITY_END();
+}
@@ -0,0 +1,464 @@
+/**
+ * @file    test_main.cpp
+ * @brief   Testes da fila de mensagens (fila_mensagem.cpp) com um produtor e um consumidor em threads
+ *          separadas, como as tarefas de captura e de envio. Confere a ordem das mensagens e a
+ *          contagem das perdidas nas politicas eDescartaMaisAntiga e eDescartaMaisNova, e mede a vazão
+ *          da fila sem trava contra a fila anterior, protegida por mutex. Confere tambem a ampliação
+ *          da fila inicial antes do produtor.
+ *          Uso: pio test -e native -f test_fila_mensagem
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include <unity.h>
+#include <sched.h>
+#include "fila_mensagem.h"
+
+// Definições do teste
+#define TAMANHO_FILA_ESTOURO        64        // fila pequena e consumidor lento: a fila estoura
+#define MENSAGENS_ESTOURO           200000
+#define RAJADA_PRODUTOR             32        // mensagens do produtor entre pausas
+#define PAUSA_PRODUTOR              4         // us, o produtor fica ~2x mais rapido que o consumidor
+#define LOTE_CONSUMIDOR_LENTO       16
+#define PAUSA_CONSUMIDOR_LENTO      4         // us entre os lotes do consumidor lento
+#define TAMANHO_FILA_VAZAO          8192      // TAMANHO_MAXIMO_BUFFER_FILA
+#define MENSAGENS_VAZAO             4000000
+#define TAMANHO_LOTE_CONSUMIDOR     256
+
+typedef struct SconsumidorTeste{
+  PTfilaMensagem fila;
+  Tuint32 lote;
+  Tuint32 pausa;
+  volatile Tbool produtorTerminou;
+  // Resultado
+  Tuint32 consumidas;
+  Tuint32 foraDeOrdem;
+  Tuint32 corrompidas;
+  Tuint32 lacunas;            // mensagens que faltaram entre duas consumidas
+}TconsumidorTeste;
+
+/*
+  Fila anterior, copiada da versão com mutex (contador de ocupação, mutex em cada operação e a
+  mensagem mais antiga sobrescrita quando cheia), somente para a comparação de vazão
+*/
+typedef struct SfilaMutex{
+  Tuint32 capacidadeMax;
+  PTmensagemCAN mensagem;
+  Tuint32 primeiro;
+  Tuint32 ultimo;
+  Tuint32 tamanhoAtual;
+}TfilaMutex;
+
+typedef TfilaMutex *PTfilaMutex;
+
+static SemaphoreHandle_t mutexFila;
+
+static Terro filaMutex_inicializa(PTfilaMutex fila, Tuint32 tamanho){
+  mutexFila = xSemaphoreCreateMutex();
+  fila->capacidadeMax = tamanho;
+  fila->mensagem = (PTmensagemCAN)malloc(sizeof(TmensagemCAN) * tamanho);
+  if((mutexFila == NULL) || (fila->mensagem == NULL)){
+    return ERRO_ALOCACAO_MEMORIA;
+  }
+  fila->primeiro = 0;
+  fila->ultimo = 0;
+  fila->tamanhoAtual = 0;
+  return SUCESSO;
+}
+
+static void filaMutex_finaliza(PTfilaMutex fila){
+  free(fila->mensagem);
+  fila->mensagem = NULL;
+  pthread_mutex_destroy(mutexFila);
+  free(mutexFila);
+}
+
+static Terro filaMutex_enfileirar(PTfilaMutex fila, TmensagemCAN mensagem){
+  xSemaphoreTake(mutexFila, portMAX_DELAY);
+  fila->mensagem[fila->ultimo] = mensagem;
+  if((fila->ultimo + 1) == fila->capacidadeMax){
+    fila->ultimo = 0;
+  }else{
+    fila->ultimo++;
+  }
+  fila->tamanhoAtual ++;
+  if(fila->tamanhoAtual == fila->capacidadeMax){
+    fila->primeiro ++;
+    fila->primeiro %= fila->capacidadeMax;
+    fila->tamanhoAtual = (fila->capacidadeMax - 1);
+  }
+  xSemaphoreGive(mutexFila);
+  return SUCESSO;
+}
+
+static Terro filaMutex_desenfileirar(PTfilaMutex fila, PTmensagemCAN mensagem){
+  Tbool filaVazia;
+
+  xSemaphoreTake(mutexFila, portMAX_DELAY);
+  filaVazia = (fila->tamanhoAtual == 0);
+  xSemaphoreGive(mutexFila);
+  if(filaVazia){
+    return ERRO_FILA_VAZIA;
+  }
+
+  xSemaphoreTake(mutexFila, portMAX_DELAY);
+  (void)memcpy(mensagem, &fila->mensagem[fila->primeiro], sizeof(TmensagemCAN));
+  fila->primeiro ++;
+  if(fila->primeiro == fila->capacidadeMax){
+    fila->primeiro = 0;
+  }
+  fila->tamanhoAtual --;
+  xSemaphoreGive(mutexFila);
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que pausa pelo tempo indicado cedendo a CPU a outra thread (o usleep atrasaria muito
+ *         mais). Com um unico nucleo, as duas threads se alternam nas pausas
+ * @param  tempo: tempo em us
+ * @return void
+ */
+static void teste_pausa(Tuint32 tempo){
+  Tuint64 inicio = host_tempoMicrossegundos();
+
+  while((host_tempoMicrossegundos() - inicio) < tempo){
+    (void)sched_yield();
+  }
+}
+
+/**
+ * @brief  Função que le a ocupação da fila com mutex
+ * @param  fila: fila com mutex
+ * @return mensagens na fila
+ */
+static Tuint32 filaMutex_tamanho(PTfilaMutex fila){
+  Tuint32 tamanho;
+
+  xSemaphoreTake(mutexFila, portMAX_DELAY);
+  tamanho = fila->tamanhoAtual;
+  xSemaphoreGive(mutexFila);
+  return tamanho;
+}
+
+static TfilaMensagem fila;
+static TfilaMutex filaMutex;
+static TconsumidorTeste consumidor;
+
+/**
+ * @brief  Função que preenche a mensagem de numero de sequencia "sequencia". O identificador e os
+ *         dados carregam a sequencia, assim uma copia rasgada pelo produtor é detectada
+ * @param  mensagem: mensagem preenchida
+ * @param  sequencia: numero de sequencia
+ * @return void
+ */
+static void teste_preencheMensagem(PTmensagemCAN mensagem, Tuint32 sequencia){
+  mensagem->identificador = (sequencia & MASCARA_ID_EXTENDIDO);
+  mensagem->tamanho = TAMANHO_MAX_DADOS_QUADRO_CAN;
+  mensagem->tempo = 0;
+  (void)memcpy(&mensagem->dados[0], &sequencia, sizeof(sequencia));
+  (void)memcpy(&mensagem->dados[4], &sequencia, sizeof(sequencia));
+}
+
+/**
+ * @brief  Função que confere um lote consumido: sequencia crescente e mensagem integra
+ * @param  dados: estado do consumidor
+ * @param  lote: mensagens consumidas
+ * @param  quantidade: quantidade de mensagens do lote
+ * @param  anterior: ultima sequencia consumida, 0xFFFFFFFF antes da primeira
+ * @return void
+ */
+static void teste_confereLote(TconsumidorTeste *dados, const TmensagemCAN *lote, Tuint32 quantidade, Tuint32 *anterior){
+  Tuint32 sequencia, copia, i;
+
+  for(i=0; i<quantidade; i++){
+    (void)memcpy(&sequencia, &lote[i].dados[0], sizeof(sequencia));
+    (void)memcpy(&copia, &lote[i].dados[4], sizeof(copia));
+    if((sequencia != copia) || (lote[i].identificador != (sequencia & MASCARA_ID_EXTENDIDO))){
+      dados->corrompidas ++;
+    }
+    if((*anterior != 0xFFFFFFFFU) && (sequencia <= *anterior)){
+      dados->foraDeOrdem ++;
+    }else{
+      dados->lacunas += (sequencia - *anterior - 1);
+    }
+    *anterior = sequencia;
+  }
+  dados->consumidas += quantidade;
+}
+
+/**
+ * @brief  Thread consumidora da fila sem trava (tarefa de envio): retira em lotes ate o produtor
+ *         terminar e a fila esvaziar
+ * @param  argumento: TconsumidorTeste
+ * @return NULL
+ */
+static void *teste_consumidorFila(void *argumento){
+  TconsumidorTeste *dados = (TconsumidorTeste *)argumento;
+  static TmensagemCAN lote[TAMANHO_LOTE_CONSUMIDOR];
+  Tuint32 anterior = 0xFFFFFFFFU;
+  Tuint32 quantidade;
+  Tbool terminou;
+
+  for(;;){
+    terminou = __atomic_load_n(&dados->produtorTerminou, __ATOMIC_ACQUIRE);
+    if(filaMensagem_desenfileirarLote(dados->fila, lote, dados->lote, &quantidade) == SUCESSO){
+      teste_confereLote(dados, lote, quantidade, &anterior);
+      teste_pausa(dados->pausa);
+    }else if(terminou){
+      break;
+    }else{
+      (void)sched_yield();
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief  Thread consumidora da fila com mutex, retirando uma mensagem por vez como a tarefa de envio
+ *         fazia com a fila anterior
+ * @param  argumento: TconsumidorTeste
+ * @return NULL
+ */
+static void *teste_consumidorFilaMutex(void *argumento){
+  TconsumidorTeste *dados = (TconsumidorTeste *)argumento;
+  static TmensagemCAN lote[TAMANHO_LOTE_CONSUMIDOR];
+  Tuint32 anterior = 0xFFFFFFFFU;
+  Tuint32 quantidade;
+  Tbool terminou;
+
+  for(;;){
+    terminou = __atomic_load_n(&dados->produtorTerminou, __ATOMIC_ACQUIRE);
+    quantidade = 0;
+    while((quantidade < TAMANHO_LOTE_CONSUMIDOR) && (filaMutex_desenfileirar(&filaMutex, &lote[quantidade]) == SUCESSO)){
+      quantidade ++;
+    }
+    if(quantidade > 0){
+      teste_confereLote(dados, lote, quantidade, &anterior);
+    }else if(terminou){
+      break;
+    }else{
+      (void)sched_yield();
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief  Função que executa o produtor na thread atual, como a tarefa de captura: reserva a celula,
+ *         escreve a mensagem nela e confirma
+ * @param  quantidade: mensagens produzidas
+ * @param  pausa: pausa a cada RAJADA_PRODUTOR mensagens (us); 0 produz sem pausa e sem perda,
+ *         aguardando espaço na fila
+ * @return void
+ */
+static void teste_produzFila(Tuint32 quantidade, Tuint32 pausa){
+  PTmensagemCAN celula;
+  Terro erro;
+  Tuint32 sequencia;
+
+  for(sequencia=0; sequencia<quantidade; sequencia++){
+    if(pausa == 0){
+      while(filaMensagem_tamanhoFila(&fila) >= fila.capacidadeMax){
+        (void)sched_yield();
+      }
+    }else if((sequencia % RAJADA_PRODUTOR) == 0){
+      teste_pausa(pausa);
+    }
+    erro = filaMensagem_reservaCelula(&fila, &celula);
+    if(erro == ERRO_FILA_CHEIA){
+      continue;
+    }
+    TEST_ASSERT_EQUAL(SUCESSO, erro);
+    teste_preencheMensagem(celula, sequencia);
+    filaMensagem_confirmaCelula(&fila);
+  }
+}
+
+/**
+ * @brief  Função que executa produtor e consumidor da fila sem trava com a politica indicada
+ * @param  politica: politica de estouro
+ * @param  tamanhoFila: capacidade da fila
+ * @param  quantidade: mensagens produzidas
+ * @param  pausaProdutor: pausa do produtor a cada RAJADA_PRODUTOR mensagens (us), 0 sem perda
+ * @param  lote: maximo de mensagens por lote do consumidor
+ * @param  pausaConsumidor: pausa do consumidor entre lotes (us)
+ * @return tempo total em us
+ */
+static Tuint64 teste_executaFila(TpoliticaEstouroFila politica, Tuint32 tamanhoFila, Tuint32 quantidade,
+                                 Tuint32 pausaProdutor, Tuint32 lote, Tuint32 pausaConsumidor){
+  pthread_t thread;
+  Tuint64 inicio;
+
+  TEST_ASSERT_EQUAL(SUCESSO, filaMensagem_inicializaFila(&fila, tamanhoFila));
+  filaMensagem_configuraPolitica(&fila, politica, 0);
+  (void)memset((void *)&consumidor, 0x00, sizeof(consumidor));
+  consumidor.fila = &fila;
+  consumidor.lote = lote;
+  consumidor.pausa = pausaConsumidor;
+
+  inicio = host_tempoMicrossegundos();
+  TEST_ASSERT_EQUAL_INT(0, pthread_create(&thread, NULL, teste_consumidorFila, &consumidor));
+  teste_produzFila(quantidade, pausaProdutor);
+  __atomic_store_n(&consumidor.produtorTerminou, VERDADEIRO, __ATOMIC_RELEASE);
+  TEST_ASSERT_EQUAL_INT(0, pthread_join(thread, NULL));
+  return (host_tempoMicrossegundos() - inicio);
+}
+
+void setUp(void){
+}
+
+void tearDown(void){
+  filaMensagem_finalizaFila(&fila);
+}
+
+/**
+ * @brief  eDescartaMaisAntiga com a fila estourando: o produtor sobrescreve as mais antigas durante
+ *         as copias do consumidor, que continua recebendo as mensagens em ordem e integras, e
+ *         consumidas + sobrescritas = produzidas
+ */
+static void test_descartaMaisAntiga(void){
+  TestatisticaFila estatistica;
+  char texto[160];
+
+  (void)teste_executaFila(eDescartaMaisAntiga, TAMANHO_FILA_ESTOURO, MENSAGENS_ESTOURO,
+                          PAUSA_PRODUTOR, LOTE_CONSUMIDOR_LENTO, PAUSA_CONSUMIDOR_LENTO);
+  filaMensagem_obtemEstatistica(&fila, &estatistica);
+
+  TEST_ASSERT_EQUAL_UINT32(0, consumidor.foraDeOrdem);
+  TEST_ASSERT_EQUAL_UINT32(0, consumidor.corrompidas);
+  TEST_ASSERT_EQUAL_UINT32(MENSAGENS_ESTOURO, estatistica.enfileiradas);
+  TEST_ASSERT_EQUAL_UINT32(0, estatistica.descartadas);
+  TEST_ASSERT_TRUE(estatistica.sobrescritas > 0);
+  TEST_ASSERT_EQUAL_UINT32(MENSAGENS_ESTOURO, consumidor.consumidas + estatistica.sobrescritas);
+  // As mais novas nunca sao sobrescritas, entao toda sobrescrita aparece como lacuna na sequencia
+  TEST_ASSERT_EQUAL_UINT32(estatistica.sobrescritas, consumidor.lacunas);
+  TEST_ASSERT_EQUAL_UINT32(estatistica.sobrescritas, filaMensagem_quantidadePerdida(&fila));
+  TEST_ASSERT_TRUE(estatistica.eventosEstouro > 0);
+  TEST_ASSERT_EQUAL_UINT32(TAMANHO_FILA_ESTOURO, estatistica.marcaMaxima);
+
+  (void)snprintf(texto, sizeof(texto), "%u produzidas: %u consumidas, %u sobrescritas, %u estouros",
+                 MENSAGENS_ESTOURO, consumidor.consumidas, estatistica.sobrescritas, estatistica.eventosEstouro);
+  TEST_MESSAGE(texto);
+}
+
+/**
+ * @brief  eDescartaMaisNova com a fila estourando: as recebidas com a fila cheia sao descartadas,
+ *         as que entraram chegam todas em ordem e consumidas + descartadas = produzidas
+ */
+static void test_descartaMaisNova(void){
+  TestatisticaFila estatistica;
+  char texto[160];
+
+  (void)teste_executaFila(eDescartaMaisNova, TAMANHO_FILA_ESTOURO, MENSAGENS_ESTOURO,
+                          PAUSA_PRODUTOR, LOTE_CONSUMIDOR_LENTO, PAUSA_CONSUMIDOR_LENTO);
+  filaMensagem_obtemEstatistica(&fila, &estatistica);
+
+  TEST_ASSERT_EQUAL_UINT32(0, consumidor.foraDeOrdem);
+  TEST_ASSERT_EQUAL_UINT32(0, consumidor.corrompidas);
+  TEST_ASSERT_EQUAL_UINT32(0, estatistica.sobrescritas);
+  TEST_ASSERT_TRUE(estatistica.descartadas > 0);
+  TEST_ASSERT_EQUAL_UINT32(estatistica.enfileiradas, consumidor.consumidas);
+  TEST_ASSERT_EQUAL_UINT32(MENSAGENS_ESTOURO, consumidor.consumidas + estatistica.descartadas);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(estatistica.descartadas, consumidor.lacunas);
+  TEST_ASSERT_EQUAL_UINT32(estatistica.descartadas, filaMensagem_quantidadePerdida(&fila));
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(TAMANHO_FILA_ESTOURO, estatistica.marcaMaxima);
+
+  (void)snprintf(texto, sizeof(texto), "%u produzidas: %u consumidas, %u descartadas, %u estouros",
+                 MENSAGENS_ESTOURO, consumidor.consumidas, estatistica.descartadas, estatistica.eventosEstouro);
+  TEST_MESSAGE(texto);
+}
+
+/**
+ * @brief  Vazão de ponta a ponta com produtor e consumidor a toda velocidade e sem perda (o produtor
+ *         aguarda espaço quando a fila enche): fila sem trava (celula reservada e lote) contra a fila
+ *         anterior com mutex (copia por valor e uma mensagem por vez). As duas vazões sao mostradas;
+ *         o teste exige que as duas entreguem tudo, em ordem
+ */
+static void test_vazaoContraMutex(void){
+  TestatisticaFila estatistica;
+  pthread_t thread;
+  TmensagemCAN mensagem;
+  Tuint64 tempoSemTrava, tempoMutex, inicio;
+  Tuint32 sequencia;
+  char texto[200];
+
+  // Fila sem trava
+  tempoSemTrava = teste_executaFila(eDescartaMaisAntiga, TAMANHO_FILA_VAZAO, MENSAGENS_VAZAO,
+                                    0, TAMANHO_LOTE_CONSUMIDOR, 0);
+  filaMensagem_obtemEstatistica(&fila, &estatistica);
+  TEST_ASSERT_EQUAL_UINT32(0, consumidor.foraDeOrdem);
+  TEST_ASSERT_EQUAL_UINT32(0, consumidor.corrompidas);
+  TEST_ASSERT_EQUAL_UINT32(0, estatistica.sobrescritas);
+  TEST_ASSERT_EQUAL_UINT32(MENSAGENS_VAZAO, consumidor.consumidas);
+
+  // Fila anterior com mutex, que guarda no maximo (capacidade - 1) mensagens
+  TEST_ASSERT_EQUAL(SUCESSO, filaMutex_inicializa(&filaMutex, TAMANHO_FILA_VAZAO));
+  (void)memset((void *)&consumidor, 0x00, sizeof(consumidor));
+  inicio = host_tempoMicrossegundos();
+  TEST_ASSERT_EQUAL_INT(0, pthread_create(&thread, NULL, teste_consumidorFilaMutex, &consumidor));
+  for(sequencia=0; sequencia<MENSAGENS_VAZAO; sequencia++){
+    while(filaMutex_tamanho(&filaMutex) >= (TAMANHO_FILA_VAZAO - 1)){
+      (void)sched_yield();
+    }
+    teste_preencheMensagem(&mensagem, sequencia);
+    (void)filaMutex_enfileirar(&filaMutex, mensagem);
+  }
+  __atomic_store_n(&consumidor.produtorTerminou, VERDADEIRO, __ATOMIC_RELEASE);
+  TEST_ASSERT_EQUAL_INT(0, pthread_join(thread, NULL));
+  tempoMutex = (host_tempoMicrossegundos() - inicio);
+  filaMutex_finaliza(&filaMutex);
+  TEST_ASSERT_EQUAL_UINT32(0, consumidor.foraDeOrdem);
+  TEST_ASSERT_EQUAL_UINT32(MENSAGENS_VAZAO, consumidor.consumidas);
+
+  (void)snprintf(texto, sizeof(texto), "%u mensagens: sem trava %.1f M/s, com mutex %.1f M/s (%.1fx)",
+                 MENSAGENS_VAZAO, ((double)MENSAGENS_VAZAO / (double)tempoSemTrava),
+                 ((double)MENSAGENS_VAZAO / (double)tempoMutex), ((double)tempoMutex / (double)tempoSemTrava));
+  TEST_MESSAGE(texto);
+}
+
+/**
+ * @brief  Ampliação da fila inicial (TAMANHO_INICIAL_BUFFER_FILA) para TAMANHO_MAXIMO_BUFFER_FILA antes
+ *         do produtor: so aceita uma fila vazia e um tamanho maior potencia de 2, e depois dela a fila
+ *         guarda a capacidade nova inteira, em ordem
+ */
+static void test_ampliaFila(void){
+  TmensagemCAN mensagem;
+  Tuint32 sequencia;
+
+  TEST_ASSERT_EQUAL(SUCESSO, filaMensagem_inicializaFila(&fila, TAMANHO_INICIAL_BUFFER_FILA));
+  filaMensagem_configuraPolitica(&fila, eDescartaMaisNova, 0);
+  TEST_ASSERT_EQUAL(ERRO_GERAL, filaMensagem_ampliaFila(&fila, TAMANHO_INICIAL_BUFFER_FILA));
+  TEST_ASSERT_EQUAL(ERRO_GERAL, filaMensagem_ampliaFila(&fila, (TAMANHO_INICIAL_BUFFER_FILA + TAMANHO_BUFFER_1K)));
+
+  // Com mensagens na fila a troca do array as perderia
+  teste_preencheMensagem(&mensagem, 0);
+  TEST_ASSERT_EQUAL(SUCESSO, filaMensagem_enfileirar(&fila, mensagem));
+  TEST_ASSERT_EQUAL(ERRO_GERAL, filaMensagem_ampliaFila(&fila, TAMANHO_MAXIMO_BUFFER_FILA));
+  TEST_ASSERT_EQUAL(SUCESSO, filaMensagem_desenfileirar(&fila, &mensagem));
+
+  TEST_ASSERT_EQUAL(SUCESSO, filaMensagem_ampliaFila(&fila, TAMANHO_MAXIMO_BUFFER_FILA));
+  TEST_ASSERT_EQUAL_UINT32(TAMANHO_MAXIMO_BUFFER_FILA, fila.capacidadeMax);
+  for(sequencia=0; sequencia<TAMANHO_MAXIMO_BUFFER_FILA; sequencia++){
+    teste_preencheMensagem(&mensagem, sequencia);
+    TEST_ASSERT_EQUAL(SUCESSO, filaMensagem_enfileirar(&fila, mensagem));
+  }
+  TEST_ASSERT_EQUAL(ERRO_FILA_CHEIA, filaMensagem_enfileirar(&fila, mensagem));
+  for(sequencia=0; sequencia<TAMANHO_MAXIMO_BUFFER_FILA; sequencia++){
+    TEST_ASSERT_EQUAL(SUCESSO, filaMensagem_desenfileirar(&fila, &mensagem));
+    TEST_ASSERT_EQUAL_UINT32(sequencia, mensagem.identificador);
+  }
+  TEST_ASSERT_EQUAL(ERRO_FILA_VAZIA, filaMensagem_desenfileirar(&fila, &mensagem));
+}
+
+int main(int argc, char **argv){
+  (void)argc;
+  (void)argv;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_descartaMaisAntiga);
+  RUN_TEST(test_descartaMaisNova);
+  RUN_TEST(test_vazaoContraMutex);
+  RUN_TEST(test_ampliaFila);
+  return UNITY_END();
+}
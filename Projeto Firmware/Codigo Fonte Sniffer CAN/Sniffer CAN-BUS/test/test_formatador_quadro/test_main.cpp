@@ -0,0 +1,345 @@
+/**
+ * @file    test_main.cpp
+ * @brief   Testes do formatador de texto dos quadros (formatador_quadro.cpp): o texto deve ser
+ *          identico, byte a byte, ao do formatador anterior com sprintf("%0.1f") e strcat, no texto
+ *          formatado e no simples, com identificadores padrao e extendidos, DLC de 0 a 8 e intervalos
+ *          abaixo e acima de LIMITE_INTERVALO_INTEIRO_TEXTO. Mede tambem a vazão (quadros/s) dos dois.
+ *          Uso: pio test -e native -f test_formatador_quadro
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include <unity.h>
+#include "formatador_quadro.h"
+
+// Definições do teste
+#define MENSAGENS_BLOCO_TESTE       64
+#define BLOCOS_ALEATORIOS           20000
+#define QUADROS_VAZAO               2000000
+#define TEMPO_INICIAL_TESTE         7000000ULL    // us
+#define TAMANHO_TEXTO_TESTE         (((TAMANHO_MAXIMO_LINHA_FORMATADA + 32) * MENSAGENS_BLOCO_TESTE) + 1)
+
+static TmensagemCAN mensagens[MENSAGENS_BLOCO_TESTE];
+static char textoNovo[TAMANHO_TEXTO_TESTE];
+static char textoAntigo[TAMANHO_TEXTO_TESTE];
+static Tuint32 semente;
+
+void setUp(void){
+  semente = 2024;
+}
+
+void tearDown(void){
+}
+
+/*
+  Formatador anterior, copiado de snifferCanCartao_formataQuadroCANToString (a copia do servidor
+  era igual no texto simples), somente para a comparação do texto e da vazão
+*/
+static Terro formatadorAntigo_formataTexto(char *texto, PTmensagemCAN mensagem,
+                                           Tuint16 quantidade, Tbool formatado,
+                                           Tuint64 tempoReferencia, Tuint64 *tempoAnterior){
+  Tuint16 i,j;
+  Tuint16 ultimaPos;
+  Tuint64 tempoQuadro;
+  char *buffer;
+  Tuint16 tamanhoBuffer = (TAMANHO_MAXIMO_LINHA_TEXTO(formatado) + 32);
+
+  buffer = (char*)malloc(tamanhoBuffer);
+  if(buffer == NULL){
+    return ERRO_ALOCACAO_MEMORIA;
+  }
+
+  for(i=0; i<quantidade; i++){
+    ultimaPos = 0;
+
+    tempoQuadro = (TEMPO_ABSOLUTO_QUADRO(mensagem[i], tempoReferencia) / RESOLUCAO_TEMPO_REGISTRO);
+    if(*tempoAnterior == 0){
+      *tempoAnterior = tempoQuadro;
+    }
+    (void)sprintf(buffer,"%0.1f", (float)((float)((tempoQuadro - *tempoAnterior) * RESOLUCAO_TEMPO_REGISTRO)/1000));
+    *tempoAnterior = tempoQuadro;
+
+    ultimaPos = strlen(buffer);
+
+    if(formatado){
+      for(j=ultimaPos; j< TAMANHO_DEFINIDO_ESPACO_ENTRE_TEMPO_ID; j++){
+        buffer[ultimaPos++] = ' ';
+      }
+    }
+    else{
+      buffer[ultimaPos++] = ';';
+    }
+
+    if(QUADRO_EXTENDIDO(mensagem[i])){
+      buffer[ultimaPos++] = HEX_TO_ASCII(((ID_QUADRO(mensagem[i]) >> 28) & 0x0F));
+      buffer[ultimaPos++] = HEX_TO_ASCII(((ID_QUADRO(mensagem[i]) >> 24) & 0x0F));
+      buffer[ultimaPos++] = HEX_TO_ASCII(((ID_QUADRO(mensagem[i]) >> 20) & 0x0F));
+      buffer[ultimaPos++] = HEX_TO_ASCII(((ID_QUADRO(mensagem[i]) >> 16) & 0x0F));
+      buffer[ultimaPos++] = HEX_TO_ASCII(((ID_QUADRO(mensagem[i]) >> 12) & 0x0F));
+      buffer[ultimaPos++] = HEX_TO_ASCII(((ID_QUADRO(mensagem[i]) >>  8) & 0x0F));
+      buffer[ultimaPos++] = HEX_TO_ASCII(((ID_QUADRO(mensagem[i]) >>  4) & 0x0F));
+      buffer[ultimaPos++] = HEX_TO_ASCII(((ID_QUADRO(mensagem[i]) >>  0) & 0x0F));
+    }
+    else{
+      buffer[ultimaPos++] = HEX_TO_ASCII(((ID_QUADRO(mensagem[i]) >>  8) & 0x0F));
+      buffer[ultimaPos++] = HEX_TO_ASCII(((ID_QUADRO(mensagem[i]) >>  4) & 0x0F));
+      buffer[ultimaPos++] = HEX_TO_ASCII(((ID_QUADRO(mensagem[i]) >>  0) & 0x0F));
+    }
+
+    if(formatado){
+      buffer[ultimaPos++] = ' ';
+      buffer[ultimaPos++] = ' ';
+      buffer[ultimaPos++] = ' ';
+      buffer[ultimaPos++] = ' ';
+      buffer[ultimaPos++] = ' ';
+      buffer[ultimaPos++] = ' ';
+    }else{
+      buffer[ultimaPos++] = ';';
+    }
+
+    buffer[ultimaPos++] = HEX_TO_ASCII(((mensagem[i].tamanho >> 4) & 0x0F));
+    buffer[ultimaPos++] = HEX_TO_ASCII(((mensagem[i].tamanho >> 0) & 0x0F));
+
+    if(formatado){
+      buffer[ultimaPos++] = ' ';
+      buffer[ultimaPos++] = ' ';
+      buffer[ultimaPos++] = ' ';
+    }else{
+      buffer[ultimaPos++] = ';';
+    }
+
+    for(j=0; j<mensagem[i].tamanho; j++){
+      if(formatado){
+        buffer[(3*j)+ultimaPos+0] = HEX_TO_ASCII(((mensagem[i].dados[j] >> 4) & 0x0F));
+        buffer[(3*j)+ultimaPos+1] = HEX_TO_ASCII(((mensagem[i].dados[j] >> 0) & 0x0F));
+        buffer[(3*j)+ultimaPos+2] = ' ';
+      }else{
+        buffer[(2*j)+ultimaPos+0] = HEX_TO_ASCII(((mensagem[i].dados[j] >> 4) & 0x0F));
+        buffer[(2*j)+ultimaPos+1] = HEX_TO_ASCII(((mensagem[i].dados[j] >> 0) & 0x0F));
+      }
+    }
+
+    if(formatado){
+      buffer[(3 *j)+ultimaPos+0] = '\r';
+      buffer[(3 *j)+ultimaPos+1] = '\n';
+      buffer[(3 *j)+ultimaPos+2] = '\0';
+    }else{
+      buffer[(2*j)+ultimaPos+0] = ';';
+      buffer[(2*j)+ultimaPos+1] = '\0';
+    }
+
+    if(PRIMEIRA_INTERACAO){
+      (void)strcpy(texto,buffer);
+    }else{
+      (void)strcat(texto,buffer);
+    }
+  }
+  free(buffer);
+
+  return SUCESSO;
+}
+
+/**
+ * @brief  Função que gera numeros pseudo aleatorios (LCG), a sequencia se repete a cada teste
+ * @return numero de 32 bits
+ */
+static Tuint32 teste_aleatorio(void){
+  semente = ((semente * 1103515245UL) + 12345UL);
+  return ((semente >> 16) | (semente << 16));
+}
+
+/**
+ * @brief  Função que gera um bloco de mensagens aleatorias: metade padrao e metade extendido, DLC
+ *         de 0 a 8 e intervalos de 0 a ~10 s entre as mensagens
+ * @param  quantidade: quantidade de mensagens
+ * @param  tempo: instante da mensagem anterior (us), atualizado
+ * @return void
+ */
+static void teste_geraBloco(Tuint32 quantidade, Tuint64 *tempo){
+  Tuint32 i, j;
+
+  for(i=0; i<quantidade; i++){
+    switch(teste_aleatorio() % 4){
+      case 0:  *tempo += 0; break;                                        // mesmo instante
+      case 1:  *tempo += (teste_aleatorio() % 1000); break;               // menos de 1 ms
+      case 2:  *tempo += (teste_aleatorio() % 100000); break;             // ate 100 ms
+      default: *tempo += (teste_aleatorio() % 10000000); break;           // ate 10 s
+    }
+    if(teste_aleatorio() & 1){
+      mensagens[i].identificador = (FLAG_QUADRO_EXTENDIDO | (teste_aleatorio() & MASCARA_ID_EXTENDIDO));
+    }else{
+      mensagens[i].identificador = (teste_aleatorio() & MASCARA_ID_PADRAO);
+    }
+    mensagens[i].tamanho = (teste_aleatorio() % (TAMANHO_MAX_DADOS_QUADRO_CAN + 1));
+    mensagens[i].tempo = (Tuint32)(*tempo & MASCARA_TEMPO_QUADRO_CAN);
+    for(j=0; j<TAMANHO_MAX_DADOS_QUADRO_CAN; j++){
+      mensagens[i].dados[j] = (Tuint8)teste_aleatorio();
+    }
+  }
+}
+
+/**
+ * @brief  Função que formata o mesmo bloco nos dois formatadores e confere o texto, o tamanho e o
+ *         tempoAnterior atualizado
+ * @param  quantidade: quantidade de mensagens
+ * @param  formatado: estilo do texto
+ * @param  tempoReferencia: instante (esp_timer, us) posterior ao bloco
+ * @param  tempoAnterior: instante da mensagem anterior (decimos de ms), o mesmo para os dois
+ * @return void
+ */
+static void teste_comparaBloco(Tuint32 quantidade, Tbool formatado, Tuint64 tempoReferencia, Tuint64 tempoAnterior){
+  Tuint64 anteriorNovo = tempoAnterior;
+  Tuint64 anteriorAntigo = tempoAnterior;
+  Tuint32 tamanho;
+
+  tamanho = formatadorQuadro_formataTexto(textoNovo, mensagens, quantidade, formatado, tempoReferencia, &anteriorNovo);
+  TEST_ASSERT_EQUAL(SUCESSO, formatadorAntigo_formataTexto(textoAntigo, mensagens, (Tuint16)quantidade, formatado,
+                                                           tempoReferencia, &anteriorAntigo));
+  TEST_ASSERT_EQUAL_STRING(textoAntigo, textoNovo);
+  TEST_ASSERT_EQUAL_UINT32(strlen(textoAntigo), tamanho);
+  TEST_ASSERT_EQUAL_UINT64(anteriorAntigo, anteriorNovo);
+}
+
+/**
+ * @brief  Teste: linhas conhecidas, formatadas e simples, padrao e extendido
+ */
+static void test_linhasConhecidas(void){
+  Tuint64 tempoAnterior = 0;
+  Tuint64 tempoReferencia = (TEMPO_INICIAL_TESTE + 1000000);
+  Tuint32 tamanho;
+
+  (void)memset(mensagens, 0x00, sizeof(mensagens));
+  mensagens[0].identificador = 0x7E8;
+  mensagens[0].tamanho = 8;
+  mensagens[0].tempo = (Tuint32)TEMPO_INICIAL_TESTE;
+  (void)memcpy(mensagens[0].dados, "\x03\x41\x0C\x1A\xF8\x00\xAA\xFF", 8);
+  mensagens[1].identificador = (FLAG_QUADRO_EXTENDIDO | 0x18DAF110);
+  mensagens[1].tamanho = 3;
+  mensagens[1].tempo = (Tuint32)(TEMPO_INICIAL_TESTE + 12345);
+  (void)memcpy(mensagens[1].dados, "\x02\x10\x03", 3);
+  mensagens[2].identificador = 0x00A;
+  mensagens[2].tamanho = 0;
+  mensagens[2].tempo = (Tuint32)(TEMPO_INICIAL_TESTE + 12345 + 250000);
+
+  tamanho = formatadorQuadro_formataTexto(textoNovo, mensagens, 3, VERDADEIRO, tempoReferencia, &tempoAnterior);
+  TEST_ASSERT_EQUAL_STRING(
+    "0.0                 7E8      08   03 41 0C 1A F8 00 AA FF \r\n"
+    "12.3                18DAF110      03   02 10 03 \r\n"
+    "250.0               00A      00   \r\n", textoNovo);
+  TEST_ASSERT_EQUAL_UINT32(strlen(textoNovo), tamanho);
+
+  tempoAnterior = 0;
+  tamanho = formatadorQuadro_formataTexto(textoNovo, mensagens, 3, FALSO, tempoReferencia, &tempoAnterior);
+  TEST_ASSERT_EQUAL_STRING("0.0;7E8;08;03410C1AF800AAFF;12.3;18DAF110;03;021003;250.0;00A;00;;", textoNovo);
+  TEST_ASSERT_EQUAL_UINT32(strlen(textoNovo), tamanho);
+  TEST_ASSERT_EQUAL_UINT64(((TEMPO_INICIAL_TESTE + 12345 + 250000) / RESOLUCAO_TEMPO_REGISTRO), tempoAnterior);
+}
+
+/**
+ * @brief  Teste: blocos aleatorios identicos ao formatador anterior, nos dois estilos
+ */
+static void test_blocosAleatorios(void){
+  Tuint64 tempo = TEMPO_INICIAL_TESTE;
+  Tuint64 tempoAnterior = 0;
+  Tuint64 tempoReferencia;
+  Tuint32 quantidade, bloco;
+
+  for(bloco=0; bloco<BLOCOS_ALEATORIOS; bloco++){
+    quantidade = (1 + (teste_aleatorio() % MENSAGENS_BLOCO_TESTE));
+    teste_geraBloco(quantidade, &tempo);
+    tempoReferencia = (tempo + (teste_aleatorio() % 1000000));
+    teste_comparaBloco(quantidade, VERDADEIRO, tempoReferencia, tempoAnterior);
+    teste_comparaBloco(quantidade, FALSO, tempoReferencia, tempoAnterior);
+    // O proximo bloco continua do ultimo quadro deste
+    tempoAnterior = (TEMPO_ABSOLUTO_QUADRO(mensagens[quantidade - 1], tempoReferencia) / RESOLUCAO_TEMPO_REGISTRO);
+  }
+}
+
+/**
+ * @brief  Teste: intervalos em torno de LIMITE_INTERVALO_INTEIRO_TEXTO e muito longos (captura
+ *         retomada depois de horas), onde o texto continua saindo do sprintf
+ */
+static void test_intervalosLongos(void){
+  const Tuint64 intervalos[] = {
+    0, 1, 9, 10, 99, 12345, 999999, 1000000, 2097151, 2097152, 2097153,
+    (LIMITE_INTERVALO_INTEIRO_TEXTO - 2), (LIMITE_INTERVALO_INTEIRO_TEXTO - 1), LIMITE_INTERVALO_INTEIRO_TEXTO,
+    (LIMITE_INTERVALO_INTEIRO_TEXTO + 1), (LIMITE_INTERVALO_INTEIRO_TEXTO + 3), (LIMITE_INTERVALO_INTEIRO_TEXTO * 2 + 1),
+    16777215, 16777216, 16777217, 36000000ULL, 864000001ULL, 123456789012ULL
+  };
+  Tuint64 tempo = (TEMPO_INICIAL_TESTE + 20000000000000ULL);
+  Tuint64 tempoQuadro;
+  Tuint32 t, i, quantidade;
+
+  for(t=0; t<(sizeof(intervalos) / sizeof(intervalos[0])); t++){
+    for(i=0; i<200; i++){
+      quantidade = (1 + (teste_aleatorio() % 4));
+      teste_geraBloco(quantidade, &tempo);
+      tempoQuadro = (TEMPO_ABSOLUTO_QUADRO(mensagens[0], tempo) / RESOLUCAO_TEMPO_REGISTRO);
+      // A primeira mensagem do bloco fica o intervalo escolhido (mais um pouco) depois do bloco anterior
+      teste_comparaBloco(quantidade, VERDADEIRO, tempo, (tempoQuadro - intervalos[t] - (i % 3)));
+      teste_comparaBloco(quantidade, FALSO, tempo, (tempoQuadro - intervalos[t] - (i % 3)));
+    }
+  }
+}
+
+/**
+ * @brief  Função que mede a vazão de um formatador
+ * @param  antigo: VERDADEIRO para o formatador anterior
+ * @param  formatado: estilo do texto
+ * @return quadros por segundo
+ */
+static double teste_mede(Tbool antigo, Tbool formatado){
+  Tuint64 tempo = TEMPO_INICIAL_TESTE;
+  Tuint64 tempoAnterior = 0;
+  Tuint64 inicio;
+  Tuint32 quadros;
+  volatile Tuint32 soma = 0;
+
+  semente = 77;
+  teste_geraBloco(MENSAGENS_BLOCO_TESTE, &tempo);
+  inicio = host_tempoMicrossegundos();
+  for(quadros=0; quadros<QUADROS_VAZAO; quadros+=MENSAGENS_BLOCO_TESTE){
+    if(antigo){
+      (void)formatadorAntigo_formataTexto(textoAntigo, mensagens, MENSAGENS_BLOCO_TESTE, formatado, tempo, &tempoAnterior);
+      soma += (Tuint8)textoAntigo[0];
+    }else{
+      soma += formatadorQuadro_formataTexto(textoNovo, mensagens, MENSAGENS_BLOCO_TESTE, formatado, tempo, &tempoAnterior);
+    }
+  }
+  return ((1000000.0 * quadros) / (double)(host_tempoMicrossegundos() - inicio + 1));
+}
+
+/**
+ * @brief  Teste: vazão em quadros/s, blocos de 64 quadros, do formatador anterior e do atual
+ */
+static void test_vazao(void){
+  double vazao[2][2];
+  Tuint8 antigo, formatado;
+  char texto[200];
+
+  for(antigo=0; antigo<2; antigo++){
+    for(formatado=0; formatado<2; formatado++){
+      vazao[antigo][formatado] = teste_mede(antigo, formatado);
+    }
+  }
+  (void)snprintf(texto, sizeof(texto),
+    "quadros/s (blocos de %u): simples %.2fM -> %.2fM (%.1fx), formatado %.2fM -> %.2fM (%.1fx)",
+    MENSAGENS_BLOCO_TESTE, (vazao[1][0] / 1e6), (vazao[0][0] / 1e6), (vazao[0][0] / vazao[1][0]),
+    (vazao[1][1] / 1e6), (vazao[0][1] / 1e6), (vazao[0][1] / vazao[1][1]));
+  TEST_MESSAGE(texto);
+  TEST_ASSERT_TRUE(vazao[0][0] > vazao[1][0]);
+  TEST_ASSERT_TRUE(vazao[0][1] > vazao[1][1]);
+}
+
+int main(int argc, char **argv){
+  (void)argc;
+  (void)argv;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_linhasConhecidas);
+  RUN_TEST(test_blocosAleatorios);
+  RUN_TEST(test_intervalosLongos);
+  RUN_TEST(test_vazao);
+  return UNITY_END();
+}
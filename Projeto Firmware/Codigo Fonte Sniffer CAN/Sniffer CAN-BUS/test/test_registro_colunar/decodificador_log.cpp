@@ -0,0 +1,10 @@
+/**
+ * @file    decodificador_log.cpp
+ * @brief   Compila a ferramenta ferramentas/decodificador_log.cpp junto do teste, com o main renomeado,
+ *          para que os arquivos gerados pelo teste sejam lidos exatamente como no computador
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+#define main decodificadorLog_main
+#include "../../ferramentas/decodificador_log.cpp"
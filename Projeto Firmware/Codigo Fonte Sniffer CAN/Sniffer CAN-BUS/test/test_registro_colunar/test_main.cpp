@@ -0,0 +1,449 @@
+/**
+ * @file    test_main.cpp
+ * @brief   Testes de ida e volta do registro colunar (registro_colunar.cpp e compressor_lz.cpp): os
+ *          blocos sao gravados em um arquivo como no cartao e lidos de volta pela ferramenta
+ *          ferramentas/decodificador_log.cpp (saida CSV), que deve devolver todos os quadros e
+ *          marcadores. Mostra o tamanho do arquivo colunar contra o binario e o texto formatado e os
+ *          tempos de codificação e de decodificação.
+ *          Uso: pio test -e native -f test_registro_colunar
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include <unity.h>
+#include "registro_colunar.h"
+#include "registro_binario.h"
+
+// Definições do teste
+#define QUADROS_PERIODICOS          100000    // ~380 s de trafego: o tempo de 28 bits da mensagem da a volta
+#define QUADROS_ALEATORIOS          20000
+#define MENSAGENS_BLOCO_TESTE       1024      // maximo de mensagens de um bloco (padrao)
+#define BLOCO_COM_MARCADORES        3
+#define QUADROS_PERDIDOS_TESTE      5
+#define QUADROS_SUPRIMIDOS_TESTE    7
+#define RELOGIO_TESTE               1760000000000000ULL  // hora (us desde 1970) do instante 0 do esp_timer
+#define TEMPO_INICIAL_TESTE         5000000ULL           // us
+#define TAMANHO_LINHA_CSV           160
+#define TAMANHO_LZ_TESTE            (200 * 1024)
+#define ARQUIVO_COLUNAR_TESTE       "teste_registro_colunar.bin"
+#define ARQUIVO_BINARIO_TESTE       "teste_registro_binario.bin"
+#define ARQUIVO_CSV_TESTE           "teste_registro_colunar.csv"
+#define ARQUIVO_TEXTO_TESTE         "teste_registro_colunar.txt"
+
+// Ferramenta do computador (decodificador_log.cpp deste diretorio)
+int decodificadorLog_main(int argc, char **argv);
+
+// Identificador periodico do trafego simulado
+typedef struct SperiodicoTeste{
+  Tuint32 identificador;
+  Tuint32 periodo;            // us
+  Tuint8 tamanho;
+  Tuint64 proximo;
+  Tuint8 dados[TAMANHO_MAX_DADOS_QUADRO_CAN];
+}TperiodicoTeste;
+
+// Resultado da gravação e da leitura de um arquivo
+typedef struct SmedidaColunar{
+  Tuint32 bytesColunar;
+  Tuint32 bytesBinario;
+  Tuint32 bytesTexto;
+  Tuint32 tempoCodificacao;   // us
+  Tuint32 tempoDecodificacao; // us, a ferramenta inteira (leitura do arquivo e CSV)
+}TmedidaColunar;
+
+static TmensagemCAN mensagens[QUADROS_PERIODICOS];
+static Tuint64 tempos[QUADROS_PERIODICOS];
+static TarenaBloco arena;
+static Tuint8 *dados;
+static Tuint32 semente;
+
+void setUp(void){
+  semente = 12345;
+}
+
+void tearDown(void){
+  (void)remove(ARQUIVO_COLUNAR_TESTE);
+  (void)remove(ARQUIVO_BINARIO_TESTE);
+  (void)remove(ARQUIVO_CSV_TESTE);
+  (void)remove(ARQUIVO_TEXTO_TESTE);
+}
+
+/**
+ * @brief  Função que gera numeros pseudo aleatorios (LCG), a sequencia se repete a cada teste
+ * @return numero de 32 bits
+ */
+static Tuint32 teste_aleatorio(void){
+  semente = ((semente * 1103515245UL) + 12345UL);
+  return ((semente >> 16) | (semente << 16));
+}
+
+/**
+ * @brief  Função que gera trafego periodico: 8 identificadores de 10 ms a 1 s com variação de ate
+ *         50 us, um contador no primeiro byte e sinais que mudam devagar nos seguintes
+ * @param  quantidade: quantidade de quadros
+ * @return void
+ */
+static void teste_geraPeriodico(Tuint32 quantidade){
+  TperiodicoTeste periodicos[] = {
+    {0x0C0,                                10000, 8, 0, {0}},
+    {0x1A0,                                20000, 8, 0, {0}},
+    {0x2F0,                                20000, 6, 0, {0}},
+    {0x3E8,                                50000, 8, 0, {0}},
+    {(FLAG_QUADRO_EXTENDIDO | 0x18FEF100), 50000, 8, 0, {0}},
+    {0x5A5,                               100000, 4, 0, {0}},
+    {(FLAG_QUADRO_REMOTO | 0x6B0),        100000, 0, 0, {0}},
+    {0x7DF,                              1000000, 3, 0, {0}}
+  };
+  Tuint32 quantidadePeriodicos = (sizeof(periodicos) / sizeof(periodicos[0]));
+  PTmensagemCAN mensagem;
+  TperiodicoTeste *proximo;
+  Tuint32 i, p;
+
+  for(p=0; p<quantidadePeriodicos; p++){
+    periodicos[p].proximo = (TEMPO_INICIAL_TESTE + (p * 700));
+  }
+
+  for(i=0; i<quantidade; i++){
+    proximo = &periodicos[0];
+    for(p=1; p<quantidadePeriodicos; p++){
+      if(periodicos[p].proximo < proximo->proximo){
+        proximo = &periodicos[p];
+      }
+    }
+    // Contador e sinais: a cada 16 quadros o segundo byte muda, a cada 64 o terceiro
+    proximo->dados[0] ++;
+    if((proximo->dados[0] & 0x0F) == 0){
+      proximo->dados[1] += (Tuint8)(teste_aleatorio() & 0x03);
+    }
+    if((proximo->dados[0] & 0x3F) == 0){
+      proximo->dados[2] = (Tuint8)teste_aleatorio();
+    }
+
+    mensagem = &mensagens[i];
+    tempos[i] = (proximo->proximo + (teste_aleatorio() % 50));
+    mensagem->identificador = proximo->identificador;
+    mensagem->tamanho = proximo->tamanho;
+    mensagem->tempo = (Tuint32)(tempos[i] & MASCARA_TEMPO_QUADRO_CAN);
+    (void)memcpy(mensagem->dados, proximo->dados, TAMANHO_MAX_DADOS_QUADRO_CAN);
+    proximo->proximo += proximo->periodo;
+  }
+}
+
+/**
+ * @brief  Função que gera trafego aleatorio: identificadores, flags, DLC e dados sem repetição
+ *         (pior caso do compressor)
+ * @param  quantidade: quantidade de quadros
+ * @return void
+ */
+static void teste_geraAleatorio(Tuint32 quantidade){
+  Tuint64 tempo = TEMPO_INICIAL_TESTE;
+  PTmensagemCAN mensagem;
+  Tuint32 i, j;
+
+  for(i=0; i<quantidade; i++){
+    mensagem = &mensagens[i];
+    tempo += (1 + (teste_aleatorio() % 2000));
+    tempos[i] = tempo;
+    if(teste_aleatorio() & 1){
+      mensagem->identificador = (FLAG_QUADRO_EXTENDIDO | (teste_aleatorio() & MASCARA_ID_EXTENDIDO));
+    }else{
+      mensagem->identificador = (teste_aleatorio() & MASCARA_ID_PADRAO);
+    }
+    if((teste_aleatorio() % 16) == 0){
+      mensagem->identificador |= FLAG_QUADRO_REMOTO;
+    }
+    if((teste_aleatorio() % 64) == 0){
+      mensagem->identificador |= FLAG_QUADRO_ERRO;
+    }
+    mensagem->tamanho = (teste_aleatorio() % (TAMANHO_MAX_DADOS_QUADRO_CAN + 1));
+    mensagem->tempo = (Tuint32)(tempo & MASCARA_TEMPO_QUADRO_CAN);
+    for(j=0; j<TAMANHO_MAX_DADOS_QUADRO_CAN; j++){
+      mensagem->dados[j] = (Tuint8)teste_aleatorio();
+    }
+  }
+}
+
+/**
+ * @brief  Função que grava as mensagens em blocos, como a tarefa de envio: um arquivo colunar e o
+ *         mesmo conteudo no formato binario, para a comparação de tamanho
+ * @param  quantidade: quantidade de mensagens
+ * @param  medida: recebe os tamanhos e o tempo de codificação
+ * @return void
+ */
+static void teste_gravaArquivos(Tuint32 quantidade, TmedidaColunar *medida){
+  TblocoMensagens bloco;
+  FILE *colunar = fopen(ARQUIVO_COLUNAR_TESTE, "wb");
+  FILE *binario = fopen(ARQUIVO_BINARIO_TESTE, "wb");
+  Tuint64 tempoColunar = 0;
+  Tuint64 tempoBinario = 0;
+  Tuint32 tamanho, tamanhoBloco;
+  Tuint32 quadros, bytesColunas, bytesComprimidos;
+  Tuint32 i, numeroBloco;
+
+  TEST_ASSERT_NOT_NULL(colunar);
+  TEST_ASSERT_NOT_NULL(binario);
+  (void)memset(medida, 0x00, sizeof(TmedidaColunar));
+  registroColunar_obtemEstatistica(&quadros, &bytesColunas, &bytesComprimidos, &medida->tempoCodificacao);
+
+  for(i=0, numeroBloco=0; i<quantidade; i+=bloco.quantidade, numeroBloco++){
+    (void)memset(&bloco, 0x00, sizeof(bloco));
+    bloco.mensagem = &mensagens[i];
+    bloco.quantidade = (((quantidade - i) < MENSAGENS_BLOCO_TESTE) ? (quantidade - i) : MENSAGENS_BLOCO_TESTE);
+    // O bloco é montado logo depois da sua ultima mensagem
+    bloco.tempoReferencia = (tempos[i + bloco.quantidade - 1] + 1000);
+    bloco.relogioReferencia = (RELOGIO_TESTE + bloco.tempoReferencia);
+    if(numeroBloco == BLOCO_COM_MARCADORES){
+      bloco.quadrosPerdidos = QUADROS_PERDIDOS_TESTE;
+      bloco.quadrosSuprimidos = QUADROS_SUPRIMIDOS_TESTE;
+      bloco.eventoSaude = VERDADEIRO;
+      bloco.saude.estado = eErroAviso;
+      bloco.saude.rec = 100;
+      bloco.saude.eflg = 0x43;
+      bloco.saude.estourosRXB0 = 2;
+      bloco.saude.cargaMinima = 315;
+      bloco.saude.cargaMaxima = 402;
+    }
+
+    // Primeiro bloco: o cabeçalho guarda a hora e o instante da primeira mensagem
+    tamanho = 0;
+    if(i == 0){
+      tempoColunar = tempos[0];
+      tempoBinario = tempos[0];
+      tamanho = registroBinario_formataCabecalho(dados, (RELOGIO_TESTE + tempos[0]), tempos[0]);
+      TEST_ASSERT_EQUAL_UINT32(tamanho, fwrite(dados, 1, tamanho, colunar));
+      TEST_ASSERT_EQUAL_UINT32(tamanho, fwrite(dados, 1, tamanho, binario));
+      medida->bytesColunar += tamanho;
+      medida->bytesBinario += tamanho;
+    }
+
+    TEST_ASSERT_EQUAL(SUCESSO, registroColunar_formataBloco(dados, &tamanhoBloco, &bloco, &tempoColunar, &arena));
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(TAMANHO_MAXIMO_BLOCO_COLUNAR(bloco.quantidade), tamanhoBloco);
+    TEST_ASSERT_EQUAL_UINT32(tamanhoBloco, fwrite(dados, 1, tamanhoBloco, colunar));
+    medida->bytesColunar += tamanhoBloco;
+
+    tamanho = registroBinario_iniciaBloco(dados);
+    if(bloco.quadrosPerdidos > 0){
+      tamanho += registroBinario_formataMarcador(&dados[tamanho], REGISTRO_BINARIO_PERDIDOS, bloco.quadrosPerdidos);
+    }
+    if(bloco.eventoSaude){
+      tamanho += registroBinario_formataSaude(&dados[tamanho], &bloco.saude);
+    }
+    if(bloco.quadrosSuprimidos > 0){
+      tamanho += registroBinario_formataMarcador(&dados[tamanho], REGISTRO_BINARIO_SUPRIMIDOS, bloco.quadrosSuprimidos);
+    }
+    tamanho += registroBinario_formataQuadros(&dados[tamanho], bloco.mensagem, bloco.quantidade,
+                                              bloco.tempoReferencia, &tempoBinario);
+    tamanho = registroBinario_finalizaBloco(dados, tamanho);
+    TEST_ASSERT_EQUAL_UINT32(tamanho, fwrite(dados, 1, tamanho, binario));
+    medida->bytesBinario += tamanho;
+  }
+  (void)fclose(colunar);
+  (void)fclose(binario);
+
+  registroColunar_obtemEstatistica(&quadros, &bytesColunas, &bytesComprimidos, &medida->tempoCodificacao);
+  TEST_ASSERT_EQUAL_UINT32(quantidade, quadros);
+}
+
+/**
+ * @brief  Função que executa a ferramenta de decodificação
+ * @param  opcao: "-c" (CSV) ou "-f" (texto formatado)
+ * @param  saida: arquivo gerado
+ * @return tempo de execução (us)
+ */
+static Tuint32 teste_executaDecodificador(const char *opcao, const char *saida){
+  char *argumentos[] = {(char *)"decodificador_log", (char *)opcao, (char *)ARQUIVO_COLUNAR_TESTE, (char *)saida};
+  Tuint64 inicio = host_tempoMicrossegundos();
+
+  TEST_ASSERT_EQUAL_INT(0, decodificadorLog_main(4, argumentos));
+  return (Tuint32)(host_tempoMicrossegundos() - inicio);
+}
+
+/**
+ * @brief  Função que obtem o tamanho de um arquivo
+ * @param  caminho: arquivo
+ * @return bytes do arquivo
+ */
+static Tuint32 teste_tamanhoArquivo(const char *caminho){
+  FILE *arquivo = fopen(caminho, "rb");
+  long tamanho;
+
+  TEST_ASSERT_NOT_NULL(arquivo);
+  (void)fseek(arquivo, 0, SEEK_END);
+  tamanho = ftell(arquivo);
+  (void)fclose(arquivo);
+  return (Tuint32)tamanho;
+}
+
+/**
+ * @brief  Função que confere o CSV da ferramenta contra as mensagens gravadas: hora (us), identificador,
+ *         flags, DLC e dados de cada quadro, na ordem, e os marcadores do bloco BLOCO_COM_MARCADORES
+ * @param  quantidade: quantidade de mensagens gravadas
+ * @return void
+ */
+static void teste_confereCSV(Tuint32 quantidade){
+  FILE *csv = fopen(ARQUIVO_CSV_TESTE, "rb");
+  char linha[TAMANHO_LINHA_CSV];
+  char hexadecimal[(2 * TAMANHO_MAX_DADOS_QUADRO_CAN) + 1];
+  char esperado[(2 * TAMANHO_MAX_DADOS_QUADRO_CAN) + 1];
+  char texto[TAMANHO_LINHA_CSV * 2];
+  unsigned long long relogio;
+  unsigned int id, extendido, remoto, erro, dlc, valor;
+  Tuint32 perdidos = 0, suprimidos = 0, saude = 0;
+  Tuint32 i = 0, j;
+  PTmensagemCAN mensagem;
+
+  TEST_ASSERT_NOT_NULL(csv);
+  while(fgets(linha, sizeof(linha), csv) != NULL){
+    if(sscanf(linha, "perdidos,,,,,,,,%u", &valor) == 1){
+      TEST_ASSERT_EQUAL_UINT32(QUADROS_PERDIDOS_TESTE, valor);
+      perdidos ++;
+      continue;
+    }
+    if(sscanf(linha, "suprimidos,,,,,,,,%u", &valor) == 1){
+      TEST_ASSERT_EQUAL_UINT32(QUADROS_SUPRIMIDOS_TESTE, valor);
+      suprimidos ++;
+      continue;
+    }
+    if(strncmp(linha, "saude,", 6) == 0){
+      TEST_ASSERT_NOT_NULL(strstr(linha, "AVISO TEC=0 REC=100 EFLG=43 ESTOUROS=2/0 CARGA=31.5-40.2"));
+      saude ++;
+      continue;
+    }
+    hexadecimal[0] = '\0';
+    if(sscanf(linha, "quadro,%llu,%*[^,],%x,%u,%u,%u,%u,%16[0-9A-F]", &relogio, &id, &extendido, &remoto,
+              &erro, &dlc, hexadecimal) < 6){
+      continue;
+    }
+    TEST_ASSERT_LESS_THAN_UINT32(quantidade, i);
+    mensagem = &mensagens[i];
+    for(j=0; j<mensagem->tamanho; j++){
+      (void)sprintf(&esperado[2 * j], "%02X", mensagem->dados[j]);
+    }
+    esperado[2 * mensagem->tamanho] = '\0';
+
+    if((relogio != (RELOGIO_TESTE + tempos[i])) || (id != ID_QUADRO(*mensagem)) ||
+       (extendido != (unsigned int)QUADRO_EXTENDIDO(*mensagem)) || (remoto != (unsigned int)QUADRO_REMOTO(*mensagem)) ||
+       (erro != (unsigned int)QUADRO_ERRO(*mensagem)) || (dlc != mensagem->tamanho) ||
+       (strcmp(hexadecimal, esperado) != 0)){
+      (void)snprintf(texto, sizeof(texto), "quadro %u diferente: %s", i, linha);
+      TEST_FAIL_MESSAGE(texto);
+    }
+    i ++;
+  }
+  (void)fclose(csv);
+
+  TEST_ASSERT_EQUAL_UINT32(quantidade, i);
+  TEST_ASSERT_EQUAL_UINT32(1, perdidos);
+  TEST_ASSERT_EQUAL_UINT32(1, suprimidos);
+  TEST_ASSERT_EQUAL_UINT32(1, saude);
+}
+
+/**
+ * @brief  Função que grava, decodifica, confere e mostra as medidas de um trafego
+ * @param  quantidade: quantidade de mensagens
+ * @param  nome: nome do trafego na mensagem do teste
+ * @param  medida: recebe as medidas
+ * @return void
+ */
+static void teste_idaEVolta(Tuint32 quantidade, const char *nome, TmedidaColunar *medida){
+  char texto[320];
+
+  teste_gravaArquivos(quantidade, medida);
+  TEST_ASSERT_EQUAL_UINT32(medida->bytesColunar, teste_tamanhoArquivo(ARQUIVO_COLUNAR_TESTE));
+
+  medida->tempoDecodificacao = teste_executaDecodificador("-c", ARQUIVO_CSV_TESTE);
+  teste_confereCSV(quantidade);
+
+  (void)teste_executaDecodificador("-f", ARQUIVO_TEXTO_TESTE);
+  medida->bytesTexto = teste_tamanhoArquivo(ARQUIVO_TEXTO_TESTE);
+
+  (void)snprintf(texto, sizeof(texto),
+    "%s: %u quadros | colunar %u bytes (%.2f bytes/quadro) | binario %u bytes (%.2f:1) | "
+    "texto formatado %u bytes (%.2f:1) | codificação %.0f ns/quadro | decodificação (CSV) %.0f ns/quadro",
+    nome, quantidade, medida->bytesColunar, ((double)medida->bytesColunar / quantidade),
+    medida->bytesBinario, ((double)medida->bytesBinario / medida->bytesColunar),
+    medida->bytesTexto, ((double)medida->bytesTexto / medida->bytesColunar),
+    ((1000.0 * medida->tempoCodificacao) / quantidade), ((1000.0 * medida->tempoDecodificacao) / quantidade));
+  TEST_MESSAGE(texto);
+}
+
+/**
+ * @brief  Teste: trafego periodico de ~380 s, com marcadores, volta inteiro e fica menor que o binario
+ */
+static void test_idaEVoltaPeriodico(void){
+  TmedidaColunar medida;
+
+  teste_geraPeriodico(QUADROS_PERIODICOS);
+  teste_idaEVolta(QUADROS_PERIODICOS, "periodico", &medida);
+
+  TEST_ASSERT_LESS_THAN_UINT32(medida.bytesBinario, medida.bytesColunar);
+  TEST_ASSERT_LESS_THAN_UINT32(medida.bytesTexto, medida.bytesColunar);
+}
+
+/**
+ * @brief  Teste: trafego aleatorio (sem nada a comprimir) volta inteiro e respeita o tamanho maximo
+ */
+static void test_idaEVoltaAleatorio(void){
+  TmedidaColunar medida;
+
+  teste_geraAleatorio(QUADROS_ALEATORIOS);
+  teste_idaEVolta(QUADROS_ALEATORIOS, "aleatorio", &medida);
+}
+
+/**
+ * @brief  Teste: compressor LZ de ida e volta em entradas vazias, curtas, repetitivas, com copias alem
+ *         de 64 KiB e aleatorias, sempre dentro de TAMANHO_MAXIMO_COMPRESSOR_LZ
+ */
+static void test_compressorLZ(void){
+  static Tuint32 tabela[TAMANHO_TABELA_COMPRESSOR_LZ];
+  static Tuint8 origem[TAMANHO_LZ_TESTE];
+  static Tuint8 comprimido[TAMANHO_MAXIMO_COMPRESSOR_LZ(TAMANHO_LZ_TESTE)];
+  static Tuint8 volta[TAMANHO_LZ_TESTE];
+  const Tuint32 tamanhos[] = {0, 1, 4, 12, 13, 100, 4096, 70000, TAMANHO_LZ_TESTE};
+  Tuint32 t, i, caso, comprimidos;
+  char texto[96];
+
+  for(caso=0; caso<4; caso++){
+    for(i=0; i<TAMANHO_LZ_TESTE; i++){
+      switch(caso){
+        case 0:  origem[i] = 0; break;                                          // zeros
+        case 1:  origem[i] = (Tuint8)((i % 3) + 'A'); break;                    // periodo curto
+        case 2:  origem[i] = ((i < 65536) ? (Tuint8)teste_aleatorio() : origem[i - 65536]); break; // copia a 64 KiB
+        default: origem[i] = (Tuint8)teste_aleatorio(); break;                  // aleatorio
+      }
+    }
+    for(t=0; t<(sizeof(tamanhos) / sizeof(tamanhos[0])); t++){
+      comprimidos = compressorLZ_comprime(origem, tamanhos[t], comprimido, tabela);
+      TEST_ASSERT_LESS_OR_EQUAL_UINT32(TAMANHO_MAXIMO_COMPRESSOR_LZ(tamanhos[t]), comprimidos);
+      (void)snprintf(texto, sizeof(texto), "caso %u, %u bytes", caso, tamanhos[t]);
+      TEST_ASSERT_EQUAL_INT_MESSAGE((int32_t)tamanhos[t],
+        compressorLZ_descomprime(comprimido, comprimidos, volta, tamanhos[t]), texto);
+      TEST_ASSERT_EQUAL_MEMORY_MESSAGE(origem, volta, tamanhos[t], texto);
+      // Sem espaço para o ultimo byte o bloco é recusado
+      if(tamanhos[t] > 0){
+        TEST_ASSERT_EQUAL_INT_MESSAGE(-1, compressorLZ_descomprime(comprimido, comprimidos, volta, (tamanhos[t] - 1)), texto);
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv){
+  (void)argc;
+  (void)argv;
+
+  // Arena da memoria de trabalho, como a do consumidor, e um buffer para o maior bloco
+  dados = (Tuint8 *)malloc(TAMANHO_CABECALHO_BINARIO + TAMANHO_MAXIMO_BLOCO_COLUNAR(MENSAGENS_BLOCO_TESTE) +
+                           TAMANHO_INICIO_BLOCO_BINARIO + TAMANHO_MAXIMO_MARCADORES_BINARIO +
+                           (TAMANHO_MAXIMO_QUADRO_BINARIO * MENSAGENS_BLOCO_TESTE));
+  if((dados == NULL) || (arenaBloco_inicializa(&arena, TAMANHO_TRABALHO_COLUNAR(MENSAGENS_BLOCO_TESTE)) != SUCESSO)){
+    return 1;
+  }
+
+  UNITY_BEGIN();
+  RUN_TEST(test_idaEVoltaPeriodico);
+  RUN_TEST(test_idaEVoltaAleatorio);
+  RUN_TEST(test_compressorLZ);
+  free(dados);
+  return UNITY_END();
+}
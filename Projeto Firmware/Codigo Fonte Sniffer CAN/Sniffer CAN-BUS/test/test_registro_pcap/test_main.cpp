@@ -0,0 +1,314 @@
+/**
+ * @file    test_main.cpp
+ * @brief   Testes do registro pcap (registro_pcap.cpp): os blocos sao gravados em um arquivo como no
+ *          cartao (cabeçalho somente no primeiro bloco) e lidos de volta por um leitor que segue as
+ *          regras do libpcap para arquivos salvos (sf-pcap.c): cabeçalho lido na ordem do computador,
+ *          magico que indica a ordem dos bytes e a resolução do tempo, versao, snaplen, tipo de
+ *          enlace e caplen/len de cada pacote. O conteudo de cada pacote é lido como a struct
+ *          can_frame do SocketCAN (can_id em ordem de rede, como no LINKTYPE_CAN_SOCKETCAN).
+ *          Uso: pio test -e native -f test_registro_pcap
+ * @author  Emanoel Gomes Santos
+ * @date    Data de Criação: 17/10/2026
+**/
+
+/// Inclusões de bibliotecas importantes
+#include <unity.h>
+#include "registro_pcap.h"
+
+// Valores do libpcap (pcap/pcap.h, sf-pcap.c) e do SocketCAN (linux/can.h)
+#define TCPDUMP_MAGIC               0xA1B2C3D4U
+#define TCPDUMP_MAGIC_TROCADO       0xD4C3B2A1U
+#define NSEC_TCPDUMP_MAGIC          0xA1B23C4DU
+#define PCAP_VERSION_MAJOR          2
+#define PCAP_VERSION_MINOR          4
+#define LT_LINKTYPE(linktype)       ((linktype) & 0x03FFFFFFU)
+#define DLT_CAN_SOCKETCAN           227
+#define CAN_EFF_FLAG_TESTE          0x80000000U
+#define CAN_RTR_FLAG_TESTE          0x40000000U
+#define CAN_ERR_FLAG_TESTE          0x20000000U
+#define CAN_EFF_MASK_TESTE          0x1FFFFFFFU
+#define CAN_SFF_MASK_TESTE          0x000007FFU
+
+#if defined(__linux__)
+#include <linux/can.h>
+static_assert(CAN_EFF_FLAG == CAN_EFF_FLAG_TESTE, "CAN_EFF_FLAG");
+static_assert(CAN_RTR_FLAG == CAN_RTR_FLAG_TESTE, "CAN_RTR_FLAG");
+static_assert(CAN_ERR_FLAG == CAN_ERR_FLAG_TESTE, "CAN_ERR_FLAG");
+static_assert(sizeof(struct can_frame) == TAMANHO_QUADRO_SOCKETCAN, "struct can_frame");
+#endif
+
+// Definições do teste
+#define QUANTIDADE_QUADROS_TESTE    3000
+#define MENSAGENS_BLOCO_TESTE       256
+#define RELOGIO_TESTE               1760000000999000ULL  // hora (us desde 1970) do instante 0 do esp_timer
+#define TEMPO_INICIAL_TESTE         3000000ULL           // us
+#define ARQUIVO_PCAP_TESTE          "teste_registro_pcap.pcap"
+
+// Cabeçalho do arquivo como o libpcap le (struct pcap_file_header)
+typedef struct SarquivoPcapTeste{
+  Tuint32 magic;
+  Tuint16 version_major;
+  Tuint16 version_minor;
+  Tint32 thiszone;
+  Tuint32 sigfigs;
+  Tuint32 snaplen;
+  Tuint32 linktype;
+}TarquivoPcapTeste;
+
+// Cabeçalho de cada pacote no arquivo (struct pcap_sf_pkthdr)
+typedef struct SpacotePcapTeste{
+  Tint32 tv_sec;
+  Tint32 tv_usec;
+  Tuint32 caplen;
+  Tuint32 len;
+}TpacotePcapTeste;
+
+// Quadro lido do arquivo
+typedef struct SquadroLidoTeste{
+  Tuint64 relogio;            // us desde 1970
+  Tuint32 can_id;
+  Tuint8 can_dlc;
+  Tuint8 reservado[3];
+  Tuint8 data[TAMANHO_MAX_DADOS_QUADRO_CAN];
+}TquadroLidoTeste;
+
+static TmensagemCAN mensagens[QUANTIDADE_QUADROS_TESTE];
+static Tuint64 tempos[QUANTIDADE_QUADROS_TESTE];
+static TquadroLidoTeste lidos[QUANTIDADE_QUADROS_TESTE];
+static Tuint8 dados[TAMANHO_CABECALHO_PCAP + (TAMANHO_REGISTRO_PCAP * MENSAGENS_BLOCO_TESTE)];
+static Tuint32 semente;
+
+void setUp(void){
+  semente = 4321;
+}
+
+void tearDown(void){
+  (void)remove(ARQUIVO_PCAP_TESTE);
+}
+
+/**
+ * @brief  Função que gera numeros pseudo aleatorios (LCG), a sequencia se repete a cada teste
+ * @return numero de 32 bits
+ */
+static Tuint32 teste_aleatorio(void){
+  semente = ((semente * 1103515245UL) + 12345UL);
+  return ((semente >> 16) | (semente << 16));
+}
+
+/**
+ * @brief  Função que inverte a ordem dos bytes de 32 bits (arquivo gravado em outra ordem)
+ * @param  valor: valor lido
+ * @return valor na ordem do computador
+ */
+static Tuint32 teste_troca32(Tuint32 valor){
+  return __builtin_bswap32(valor);
+}
+
+/**
+ * @brief  Função que gera os quadros: padrao e extendido, com e sem dados, remotos, de erro e
+ *         intervalos que cruzam os segundos; a cada 10 quadros uma pausa de 1 s, ao todo mais de
+ *         268 s (o tempo de 28 bits da mensagem da a volta)
+ * @return void
+ */
+static void teste_geraQuadros(void){
+  Tuint64 tempo = TEMPO_INICIAL_TESTE;
+  PTmensagemCAN mensagem;
+  Tuint32 i, j;
+
+  for(i=0; i<QUANTIDADE_QUADROS_TESTE; i++){
+    mensagem = &mensagens[i];
+    tempo += ((i % 10) == 9) ? (1000000 + (teste_aleatorio() % 1000)) : (1 + (teste_aleatorio() % 5000));
+    tempos[i] = tempo;
+    switch(i % 6){
+      case 0:  mensagem->identificador = (teste_aleatorio() & MASCARA_ID_PADRAO); break;
+      case 1:  mensagem->identificador = (FLAG_QUADRO_EXTENDIDO | (teste_aleatorio() & MASCARA_ID_EXTENDIDO)); break;
+      case 2:  mensagem->identificador = (FLAG_QUADRO_REMOTO | (teste_aleatorio() & MASCARA_ID_PADRAO)); break;
+      case 3:  mensagem->identificador = (FLAG_QUADRO_EXTENDIDO | FLAG_QUADRO_REMOTO | (teste_aleatorio() & MASCARA_ID_EXTENDIDO)); break;
+      case 4:  mensagem->identificador = (FLAG_QUADRO_ERRO | (teste_aleatorio() & MASCARA_ID_PADRAO)); break;
+      default: mensagem->identificador = (FLAG_QUADRO_EXTENDIDO | MASCARA_ID_EXTENDIDO); break;
+    }
+    mensagem->tamanho = (i % (TAMANHO_MAX_DADOS_QUADRO_CAN + 1));
+    mensagem->tempo = (Tuint32)(tempo & MASCARA_TEMPO_QUADRO_CAN);
+    for(j=0; j<TAMANHO_MAX_DADOS_QUADRO_CAN; j++){
+      mensagem->dados[j] = (Tuint8)teste_aleatorio();
+    }
+  }
+}
+
+/**
+ * @brief  Função que grava os quadros em blocos, como snifferCanRegistro_enviaPcapCartao: o
+ *         cabeçalho do arquivo vai somente no primeiro bloco
+ * @return bytes gravados
+ */
+static Tuint32 teste_gravaArquivo(void){
+  FILE *arquivo = fopen(ARQUIVO_PCAP_TESTE, "wb");
+  Tuint64 tempoReferencia;
+  Tuint32 tamanho, total = 0;
+  Tuint32 i, quantidade;
+
+  TEST_ASSERT_NOT_NULL(arquivo);
+  for(i=0; i<QUANTIDADE_QUADROS_TESTE; i+=quantidade){
+    quantidade = (((QUANTIDADE_QUADROS_TESTE - i) < MENSAGENS_BLOCO_TESTE) ? (QUANTIDADE_QUADROS_TESTE - i) : MENSAGENS_BLOCO_TESTE);
+    // O bloco é montado pouco depois da sua ultima mensagem
+    tempoReferencia = (tempos[i + quantidade - 1] + 2500);
+    tamanho = 0;
+    if(i == 0){
+      tamanho += registroPcap_formataCabecalho(dados);
+    }
+    tamanho += registroPcap_formataQuadros(&dados[tamanho], &mensagens[i], quantidade, tempoReferencia,
+                                           (RELOGIO_TESTE + tempoReferencia));
+    TEST_ASSERT_EQUAL_UINT32(tamanho, fwrite(dados, 1, tamanho, arquivo));
+    total += tamanho;
+  }
+  (void)fclose(arquivo);
+  return total;
+}
+
+/**
+ * @brief  Função que le o arquivo como o libpcap (pcap_open_offline + pcap_next_ex): confere o
+ *         cabeçalho e devolve os quadros
+ * @param  cabecalho: recebe o cabeçalho do arquivo ja na ordem do computador
+ * @param  quantidade: recebe a quantidade de pacotes lidos
+ * @return void
+ */
+static void teste_leArquivo(TarquivoPcapTeste *cabecalho, Tuint32 *quantidade){
+  FILE *arquivo = fopen(ARQUIVO_PCAP_TESTE, "rb");
+  TpacotePcapTeste pacote;
+  Tuint8 conteudo[TAMANHO_QUADRO_SOCKETCAN];
+  TquadroLidoTeste *quadro;
+  Tbool trocado = FALSO;
+  Tuint32 escala = 1;
+  Tuint32 can_id;
+
+  TEST_ASSERT_NOT_NULL(arquivo);
+  TEST_ASSERT_EQUAL_UINT32(1, fread(cabecalho, sizeof(TarquivoPcapTeste), 1, arquivo));
+
+  // O magico indica a ordem dos bytes e a resolução do tempo
+  if((cabecalho->magic == TCPDUMP_MAGIC_TROCADO) || (cabecalho->magic == teste_troca32(NSEC_TCPDUMP_MAGIC))){
+    trocado = VERDADEIRO;
+    cabecalho->magic = teste_troca32(cabecalho->magic);
+    cabecalho->version_major = __builtin_bswap16(cabecalho->version_major);
+    cabecalho->version_minor = __builtin_bswap16(cabecalho->version_minor);
+    cabecalho->thiszone = (Tint32)teste_troca32((Tuint32)cabecalho->thiszone);
+    cabecalho->sigfigs = teste_troca32(cabecalho->sigfigs);
+    cabecalho->snaplen = teste_troca32(cabecalho->snaplen);
+    cabecalho->linktype = teste_troca32(cabecalho->linktype);
+  }
+  TEST_ASSERT_TRUE_MESSAGE((cabecalho->magic == TCPDUMP_MAGIC) || (cabecalho->magic == NSEC_TCPDUMP_MAGIC), "magico pcap");
+  if(cabecalho->magic == NSEC_TCPDUMP_MAGIC){
+    escala = 1000;
+  }
+
+  *quantidade = 0;
+  while(fread(&pacote, sizeof(TpacotePcapTeste), 1, arquivo) == 1){
+    if(trocado){
+      pacote.tv_sec = (Tint32)teste_troca32((Tuint32)pacote.tv_sec);
+      pacote.tv_usec = (Tint32)teste_troca32((Tuint32)pacote.tv_usec);
+      pacote.caplen = teste_troca32(pacote.caplen);
+      pacote.len = teste_troca32(pacote.len);
+    }
+    // Regras do libpcap: caplen nunca passa do snaplen nem do tamanho original
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(cabecalho->snaplen, pacote.caplen);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(pacote.len, pacote.caplen);
+    TEST_ASSERT_EQUAL_UINT32(TAMANHO_QUADRO_SOCKETCAN, pacote.caplen);
+    TEST_ASSERT_LESS_THAN_UINT32(1000000UL * escala, (Tuint32)pacote.tv_usec);
+    TEST_ASSERT_LESS_THAN_UINT32(QUANTIDADE_QUADROS_TESTE, *quantidade);
+    TEST_ASSERT_EQUAL_UINT32(1, fread(conteudo, pacote.caplen, 1, arquivo));
+
+    // struct can_frame: can_id em ordem de rede, can_dlc, 3 bytes reservados e os dados
+    quadro = &lidos[*quantidade];
+    (void)memcpy(&can_id, &conteudo[0], sizeof(can_id));
+    quadro->relogio = (((Tuint64)(Tuint32)pacote.tv_sec * 1000000ULL) + ((Tuint32)pacote.tv_usec / escala));
+    quadro->can_id = __builtin_bswap32(can_id);
+    quadro->can_dlc = conteudo[4];
+    (void)memcpy(quadro->reservado, &conteudo[5], 3);
+    (void)memcpy(quadro->data, &conteudo[8], TAMANHO_MAX_DADOS_QUADRO_CAN);
+    (*quantidade) ++;
+  }
+  (void)fclose(arquivo);
+}
+
+/**
+ * @brief  Teste: o cabeçalho do arquivo é o de um pcap classico com LINKTYPE_CAN_SOCKETCAN
+ */
+static void test_cabecalho(void){
+  Tuint8 bytes[TAMANHO_CABECALHO_PCAP];
+  const Tuint8 esperado[TAMANHO_CABECALHO_PCAP] = {
+    0xD4, 0xC3, 0xB2, 0xA1,  0x02, 0x00,  0x04, 0x00,  0, 0, 0, 0,  0, 0, 0, 0,
+    TAMANHO_QUADRO_SOCKETCAN, 0, 0, 0,  DLT_CAN_SOCKETCAN, 0, 0, 0
+  };
+
+  TEST_ASSERT_EQUAL_UINT32(TAMANHO_CABECALHO_PCAP, registroPcap_formataCabecalho(bytes));
+  TEST_ASSERT_EQUAL_MEMORY(esperado, bytes, TAMANHO_CABECALHO_PCAP);
+
+  // Campos little-endian: o libpcap no x86 e no ARM le o magico sem trocar a ordem
+  TEST_ASSERT_EQUAL_HEX32(TCPDUMP_MAGIC, formatoBinario_leInteiro(&bytes[0], 4));
+  TEST_ASSERT_EQUAL_UINT(PCAP_VERSION_MAJOR, formatoBinario_leInteiro(&bytes[4], 2));
+  TEST_ASSERT_EQUAL_UINT(PCAP_VERSION_MINOR, formatoBinario_leInteiro(&bytes[6], 2));
+  TEST_ASSERT_EQUAL_UINT(DLT_CAN_SOCKETCAN, LT_LINKTYPE(formatoBinario_leInteiro(&bytes[20], 4)));
+}
+
+/**
+ * @brief  Teste: o arquivo gravado em blocos volta pelo leitor com os tempos, os flags do can_id,
+ *         o DLC e os dados de todos os quadros
+ */
+static void test_idaEVolta(void){
+  TarquivoPcapTeste cabecalho;
+  TquadroLidoTeste *quadro;
+  PTmensagemCAN mensagem;
+  Tuint32 tamanho, quantidade, i;
+  Tuint32 flags;
+  Tuint8 vazio[TAMANHO_MAX_DADOS_QUADRO_CAN] = {0};
+  char texto[96];
+
+  teste_geraQuadros();
+  tamanho = teste_gravaArquivo();
+  TEST_ASSERT_EQUAL_UINT32((TAMANHO_CABECALHO_PCAP + (TAMANHO_REGISTRO_PCAP * QUANTIDADE_QUADROS_TESTE)), tamanho);
+
+  teste_leArquivo(&cabecalho, &quantidade);
+  TEST_ASSERT_EQUAL_HEX32(TCPDUMP_MAGIC, cabecalho.magic);
+  TEST_ASSERT_EQUAL_UINT(PCAP_VERSION_MAJOR, cabecalho.version_major);
+  TEST_ASSERT_EQUAL_UINT(PCAP_VERSION_MINOR, cabecalho.version_minor);
+  TEST_ASSERT_EQUAL_INT(0, cabecalho.thiszone);
+  TEST_ASSERT_EQUAL_UINT32(0, cabecalho.sigfigs);
+  TEST_ASSERT_EQUAL_UINT32(TAMANHO_QUADRO_SOCKETCAN, cabecalho.snaplen);
+  TEST_ASSERT_EQUAL_UINT32(DLT_CAN_SOCKETCAN, LT_LINKTYPE(cabecalho.linktype));
+  TEST_ASSERT_EQUAL_UINT32(QUANTIDADE_QUADROS_TESTE, quantidade);
+
+  for(i=0; i<quantidade; i++){
+    quadro = &lidos[i];
+    mensagem = &mensagens[i];
+    (void)snprintf(texto, sizeof(texto), "quadro %u", i);
+
+    TEST_ASSERT_EQUAL_UINT64_MESSAGE((RELOGIO_TESTE + tempos[i]), quadro->relogio, texto);
+
+    // Flags do can_id: EFF, RTR e ERR, e o identificador com a mascara do tipo
+    flags = (quadro->can_id & (CAN_EFF_FLAG_TESTE | CAN_RTR_FLAG_TESTE | CAN_ERR_FLAG_TESTE));
+    TEST_ASSERT_EQUAL_HEX32_MESSAGE(
+      ((QUADRO_EXTENDIDO(*mensagem) ? CAN_EFF_FLAG_TESTE : 0) | (QUADRO_REMOTO(*mensagem) ? CAN_RTR_FLAG_TESTE : 0) |
+       (QUADRO_ERRO(*mensagem) ? CAN_ERR_FLAG_TESTE : 0)), flags, texto);
+    TEST_ASSERT_EQUAL_HEX32_MESSAGE(ID_QUADRO(*mensagem),
+      (quadro->can_id & ((flags & CAN_EFF_FLAG_TESTE) ? CAN_EFF_MASK_TESTE : CAN_SFF_MASK_TESTE)), texto);
+
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(mensagem->tamanho, quadro->can_dlc, texto);
+    TEST_ASSERT_EQUAL_MEMORY_MESSAGE(vazio, quadro->reservado, 3, texto);
+    // Quadro remoto nao tem dados; nos demais os bytes depois do DLC sao zero
+    if(QUADRO_REMOTO(*mensagem)){
+      TEST_ASSERT_EQUAL_MEMORY_MESSAGE(vazio, quadro->data, TAMANHO_MAX_DADOS_QUADRO_CAN, texto);
+    }else{
+      TEST_ASSERT_EQUAL_MEMORY_MESSAGE(mensagem->dados, quadro->data, mensagem->tamanho, texto);
+      TEST_ASSERT_EQUAL_MEMORY_MESSAGE(vazio, &quadro->data[mensagem->tamanho],
+                                       (TAMANHO_MAX_DADOS_QUADRO_CAN - mensagem->tamanho), texto);
+    }
+  }
+}
+
+int main(int argc, char **argv){
+  (void)argc;
+  (void)argv;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_cabecalho);
+  RUN_TEST(test_idaEVolta);
+  return UNITY_END();
+}